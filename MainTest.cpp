@@ -3,7 +3,7 @@
 
 #include "stdlib/Stdlib.h"
 #include "utils/RandomUtils.h"
-//#include "math/EvaluatorTest.cpp"
+#include "tests/math/EvaluatorTest.cpp"
 #include "tests/memory/ChunkMemoryTest.cpp"
 #include "tests/memory/RingMemoryTest.cpp"
 #include "tests/memory/BufferMemoryTest.cpp"
@@ -17,10 +17,38 @@
 #include "tests/utils/MathUtilsTest.cpp"
 #include "tests/utils/UtilsTest.cpp"
 #include "tests/utils/TimeUtilsTest.cpp"
+#include "tests/utils/RegexSimplifiedTest.cpp"
 #include "tests/asset/AssetArchiveTest.cpp"
+#include "tests/localization/LanguageTest.cpp"
+#include "tests/input/InputTest.cpp"
+#include "tests/input/InputRecordingTest.cpp"
+#include "tests/object/MeshTest.cpp"
+#include "tests/gpuapi/ShaderReflectionTest.cpp"
 #include "tests/entity/voxel/VoxelWorldMapTest.cpp"
+#include "tests/entity/voxel/VoxelTerrainTest.cpp"
+#include "tests/entity/voxel/VoxelTest.cpp"
+#include "tests/entity/voxel/VoxelGeneratorTest.cpp"
+#include "tests/models/sampling/poisson/PoissonDiskTest.cpp"
+#include "tests/models/mob/monster/LootTableTest.cpp"
+#include "tests/models/mob/MobStoreTest.cpp"
+#include "tests/models/mob/SecondaryStatsAggregateTest.cpp"
+#include "tests/noise/SimplexNoiseTest.cpp"
+#include "tests/noise/ValueNoiseTest.cpp"
+#include "tests/noise/WorleyNoiseTest.cpp"
 #include "tests/system/DRMTest.cpp"
 #include "tests/image/QoiTest.cpp"
+#include "tests/html/HtmlTemplateCompilerTest.cpp"
+#include "tests/http/HttpRouterTest.cpp"
+#include "tests/network/UDPBatchTest.cpp"
+#include "tests/network/MobStatePacketTest.cpp"
+#include "tests/network/AreaOfInterestTest.cpp"
+#include "tests/serialize/OMSSettingsTest.cpp"
+#include "tests/serialize/WebBinaryTest.cpp"
+
+#if DB_SQLITE
+    #include "tests/database/SqliteDatabaseTest.cpp"
+    #include "tests/database/DatabasePoolTest.cpp"
+#endif
 
 #ifdef UBER_TEST
     #ifdef main
@@ -33,7 +61,7 @@ int main() {
 
     rand_setup();
 
-    //MathEvaluatorTest();
+    MathEvaluatorTest();
     MemoryChunkMemoryTest();
     MemoryRingMemoryTest();
     MemoryBufferMemoryTest();
@@ -47,10 +75,38 @@ int main() {
     UtilsMathUtilsTest();
     UtilsUtilsTest();
     UtilsTimeUtilsTest();
+    UtilsRegexSimplifiedTest();
     AssetArchiveTest();
+    LanguageTest();
+    InputTest();
+    InputRecordingTest();
+    MeshTest();
+    ShaderReflectionTest();
     VoxelWorldMapTest();
+    VoxelTerrainTest();
+    VoxelTest();
+    VoxelGeneratorTest();
+    PoissonDiskTest();
+    LootTableTest();
+    MobStoreTest();
+    SecondaryStatsAggregateTest();
+    SimplexNoiseTest();
+    ValueNoiseTest();
+    WorleyNoiseTest();
     DRMTest();
     QoiTest();
+    HtmlTemplateCompilerTest();
+    HttpRouterTest();
+    UDPBatchTest();
+    MobStatePacketTest();
+    AreaOfInterestTest();
+    OMSSettingsTest();
+    WebBinaryTest();
+
+    #if DB_SQLITE
+        SqliteDatabaseTest();
+        DatabasePoolTest();
+    #endif
 
     TEST_FOOTER();
 
@@ -16,7 +16,7 @@
 #include "AnimationEaseType.h"
 
 FORCE_INLINE
-f32 lerp(f32 a, f32 b, f32 t) NO_EXCEPT
+f32 anim_lerp(f32 a, f32 b, f32 t) NO_EXCEPT
 {
     return a + t * (b - a);
 }
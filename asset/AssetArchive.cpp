@@ -348,6 +348,24 @@ Asset* const asset_archive_asset_load(
 
         // We are directly reading into the correct destination
         file_read(archive->fd, &file, element->start, element->length);
+    } else if (element->type == ASSET_TYPE_LANGUAGE) {
+        /**
+         * Language data is stored uncompressed and already has the final in-memory layout
+         * We read it directly into the asset memory and only reference it (no copy, no per string work)
+         */
+        asset = thrd_ams_reserve_asset(ams, id_str, element->uncompressed + asset_type_size(element->type));
+        asset->official_id = id;
+
+        asset->state |= ASSET_STATE_IN_RAM;
+
+        Language* const language = (Language *) asset->self;
+
+        // @todo Should be async
+        FileBody file = {0};
+        file.content = (byte *) (language + 1);
+        file_read(archive->fd, &file, element->start, element->length);
+
+        language_map(file.content, element->length, language);
     } else {
         /**
          * All other types have asset specific loading
@@ -377,12 +395,22 @@ Asset* const asset_archive_asset_load(
         //              e.g. check TextureAtlas, Font, ...
         //              The reason for this is we don't calculate the exact required size to avoid a pre-parsing of the file
         //              On the other hand would pre-parsing really be that bad?
-        asset = thrd_ams_reserve_asset(ams, id_str, element->uncompressed + asset_type_size(element->type));
+        uint32 asset_size = element->uncompressed;
+        if (element->type == ASSET_TYPE_OBJ) {
+            // The mesh data is quantized, the loaded mesh is larger than the file data
+            // We need the header to calculate the size
+            file_async_wait(archive->fd_async, &file.ov, true);
+            asset_size = (uint32) mesh_data_memory_size(file.content);
+        }
+
+        asset = thrd_ams_reserve_asset(ams, id_str, asset_size + asset_type_size(element->type));
         asset->official_id = id;
 
         asset->state |= ASSET_STATE_IN_RAM;
 
-        file_async_wait(archive->fd_async, &file.ov, true);
+        if (element->type != ASSET_TYPE_OBJ) {
+            file_async_wait(archive->fd_async, &file.ov, true);
+        }
         switch (element->type) {
             case ASSET_TYPE_TEXTURE_ATLAS: {
                 TextureAtlas* const atlas = (TextureAtlas *) asset->self;
@@ -420,13 +448,9 @@ Asset* const asset_archive_asset_load(
                 Mesh* const mesh = (Mesh *) asset->self;
                 mesh->data = (byte *) (mesh + 1);
 
-                mesh_from_data(file.content, mesh);
-            } break;
-            case ASSET_TYPE_LANGUAGE: {
-                Language* const language = (Language *) asset->self;
-                language->data = (byte *) (language + 1);
-
-                language_from_data(file.content, language);
+                const int32 mesh_size = mesh_from_data(file.content, mesh);
+                ASSERT_TRUE((uint32) mesh_size <= asset_size);
+                PSEUDO_USE(mesh_size);
             } break;
             case ASSET_TYPE_FONT: {
                 Font* const font = (Font *) asset->self;
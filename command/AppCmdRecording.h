@@ -0,0 +1,98 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_COMMAND_APP_CMD_RECORDING_H
+#define COMS_COMMAND_APP_CMD_RECORDING_H
+
+#include "../stdlib/Stdlib.h"
+#include "../input/InputRecording.h"
+#include "AppCommand.h"
+
+// Only commands that are fully described by ids can be recorded.
+// Commands that contain pointers (functions, paths, layouts, ...) are only valid in the process that created them.
+//
+// @return false if the command cannot be recorded
+inline
+bool app_cmd_record(InputRecorder* rec, const AppCommand* cmd) NO_EXCEPT
+{
+    byte payload[2 * sizeof(int32)];
+    byte* pos = payload;
+
+    switch (cmd->type) {
+        case CMD_ASSET_ENQUEUE:
+        case CMD_ASSET_LOAD:
+            pos = write_le(pos, cmd->asset_body.asset_id);
+            break;
+        case CMD_FONT_LOAD:
+            pos = write_le(pos, cmd->font_body.asset.asset_id);
+            break;
+        case CMD_TEXTURE_LOAD:
+        case CMD_TEXTURE_ATLAS_LOAD:
+            pos = write_le(pos, cmd->texture_body.asset.asset_id);
+            break;
+        case CMD_AUDIO_PLAY:
+            pos = write_le(pos, cmd->audio_body.mixer_id);
+            pos = write_le(pos, cmd->audio_body.asset.asset_id);
+            break;
+        default:
+            return false;
+    }
+
+    input_record_command(rec, cmd->type, payload, (uint16) (pos - payload));
+
+    return true;
+}
+
+// Re-creates a command recorded by app_cmd_record(), e.g. in the InputReplayCommandFunc
+inline
+bool app_cmd_from_record(AppCommand* cmd, uint8 type, const byte* payload, uint16 size) NO_EXCEPT
+{
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = (AppCommandType) type;
+
+    switch (type) {
+        case CMD_ASSET_ENQUEUE:
+        case CMD_ASSET_LOAD:
+            if (size < sizeof(int32)) {
+                return false;
+            }
+
+            read_le(payload, &cmd->asset_body.asset_id);
+            break;
+        case CMD_FONT_LOAD:
+            if (size < sizeof(int32)) {
+                return false;
+            }
+
+            read_le(payload, &cmd->font_body.asset.asset_id);
+            break;
+        case CMD_TEXTURE_LOAD:
+        case CMD_TEXTURE_ATLAS_LOAD:
+            if (size < sizeof(int32)) {
+                return false;
+            }
+
+            read_le(payload, &cmd->texture_body.asset.asset_id);
+            break;
+        case CMD_AUDIO_PLAY:
+            if (size < 2 * sizeof(int32)) {
+                return false;
+            }
+
+            payload = read_le(payload, &cmd->audio_body.mixer_id);
+            read_le(payload, &cmd->audio_body.asset.asset_id);
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+#endif
@@ -74,8 +74,8 @@ FORCE_INLINE f64 atomic_compare_exchange_strong_relaxed(f64* value, f64 expected
 
     return expected_as_union->f;
 }
-FORCE_INLINE int32 atomic_compare_exchange_strong_relaxed(int32* value, int32 expected, int32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); return *expected; }
-FORCE_INLINE int64 atomic_compare_exchange_strong_relaxed(int64* value, int64 expected, int64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); return *expected; }
+FORCE_INLINE int32 atomic_compare_exchange_strong_relaxed(int32* value, int32 expected, int32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); return expected; }
+FORCE_INLINE int64 atomic_compare_exchange_strong_relaxed(int64* value, int64 expected, int64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); return expected; }
 FORCE_INLINE int8 atomic_fetch_add_relaxed(int8* value, int8 operand) noexcept { return __atomic_add_fetch(value, operand, __ATOMIC_RELAXED); }
 FORCE_INLINE int8 atomic_fetch_sub_relaxed(int8* value, int8 operand) noexcept { return __atomic_sub_fetch(value, operand, __ATOMIC_RELAXED); }
 FORCE_INLINE int16 atomic_fetch_add_relaxed(int16* value, int16 operand) noexcept { ASSERT_STRICT(((uintptr_t) value % 2) == 0); return __atomic_add_fetch(value, operand, __ATOMIC_RELAXED); }
@@ -112,8 +112,8 @@ FORCE_INLINE void atomic_add_relaxed(uint32* value, uint32 increment) noexcept {
 FORCE_INLINE void atomic_sub_relaxed(uint32* value, uint32 decrement) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_sub_fetch(value, decrement, __ATOMIC_RELAXED); }
 FORCE_INLINE void atomic_add_relaxed(uint64* value, uint64 increment) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_add_fetch(value, increment, __ATOMIC_RELAXED); }
 FORCE_INLINE void atomic_sub_relaxed(uint64* value, uint64 decrement) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_sub_fetch(value, decrement, __ATOMIC_RELAXED); }
-FORCE_INLINE uint32 atomic_compare_exchange_strong_relaxed(uint32* value, uint32 expected, uint32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); return *expected; }
-FORCE_INLINE uint64 atomic_compare_exchange_strong_relaxed(uint64* value, uint64 expected, uint64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); return *expected; }
+FORCE_INLINE uint32 atomic_compare_exchange_strong_relaxed(uint32* value, uint32 expected, uint32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); return expected; }
+FORCE_INLINE uint64 atomic_compare_exchange_strong_relaxed(uint64* value, uint64 expected, uint64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); return expected; }
 FORCE_INLINE uint8 atomic_fetch_add_relaxed(uint8* value, uint8 operand) noexcept { return __atomic_add_fetch(value, operand, __ATOMIC_RELAXED); }
 FORCE_INLINE uint8 atomic_fetch_sub_relaxed(uint8* value, uint8 operand) noexcept { return __atomic_sub_fetch(value, operand, __ATOMIC_RELAXED); }
 FORCE_INLINE uint16 atomic_fetch_add_relaxed(uint16* value, uint16 operand) noexcept { ASSERT_STRICT(((uintptr_t) value % 2) == 0); return __atomic_add_fetch(value, operand, __ATOMIC_RELAXED); }
@@ -194,8 +194,8 @@ FORCE_INLINE f64 atomic_compare_exchange_strong_acquire(f64* value, f64 expected
 
     return expected_as_union->f;
 }
-FORCE_INLINE int32 atomic_compare_exchange_strong_acquire(int32* value, int32 expected, int32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return *expected; }
-FORCE_INLINE int64 atomic_compare_exchange_strong_acquire(int64* value, int64 expected, int64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return *expected; }
+FORCE_INLINE int32 atomic_compare_exchange_strong_acquire(int32* value, int32 expected, int32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return expected; }
+FORCE_INLINE int64 atomic_compare_exchange_strong_acquire(int64* value, int64 expected, int64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return expected; }
 FORCE_INLINE int8 atomic_fetch_add_acquire(int8* value, int8 operand) noexcept { return __atomic_add_fetch(value, operand, __ATOMIC_ACQUIRE); }
 FORCE_INLINE int8 atomic_fetch_sub_acquire(int8* value, int8 operand) noexcept { return __atomic_sub_fetch(value, operand, __ATOMIC_ACQUIRE); }
 FORCE_INLINE int16 atomic_fetch_add_acquire(int16* value, int16 operand) noexcept { ASSERT_STRICT(((uintptr_t) value % 2) == 0); return __atomic_add_fetch(value, operand, __ATOMIC_ACQUIRE); }
@@ -232,8 +232,8 @@ FORCE_INLINE void atomic_add_acquire(uint32* value, uint32 increment) noexcept {
 FORCE_INLINE void atomic_sub_acquire(uint32* value, uint32 decrement) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_sub_fetch(value, decrement, __ATOMIC_ACQUIRE); }
 FORCE_INLINE void atomic_add_acquire(uint64* value, uint64 increment) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_add_fetch(value, increment, __ATOMIC_ACQUIRE); }
 FORCE_INLINE void atomic_sub_acquire(uint64* value, uint64 decrement) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_sub_fetch(value, decrement, __ATOMIC_ACQUIRE); }
-FORCE_INLINE uint32 atomic_compare_exchange_strong_acquire(uint32* value, uint32 expected, uint32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return *expected; }
-FORCE_INLINE uint64 atomic_compare_exchange_strong_acquire(uint64* value, uint64 expected, uint64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return *expected; }
+FORCE_INLINE uint32 atomic_compare_exchange_strong_acquire(uint32* value, uint32 expected, uint32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return expected; }
+FORCE_INLINE uint64 atomic_compare_exchange_strong_acquire(uint64* value, uint64 expected, uint64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return expected; }
 FORCE_INLINE uint8 atomic_fetch_add_acquire(uint8* value, uint8 operand) noexcept { return __atomic_add_fetch(value, operand, __ATOMIC_ACQUIRE); }
 FORCE_INLINE uint8 atomic_fetch_sub_acquire(uint8* value, uint8 operand) noexcept { return __atomic_sub_fetch(value, operand, __ATOMIC_ACQUIRE); }
 FORCE_INLINE uint16 atomic_fetch_add_acquire(uint16* value, uint16 operand) noexcept { ASSERT_STRICT(((uintptr_t) value % 2) == 0); return __atomic_add_fetch(value, operand, __ATOMIC_ACQUIRE); }
@@ -319,8 +319,8 @@ FORCE_INLINE f64 atomic_compare_exchange_strong_release(f64* value, f64 expected
 
     return expected_as_union->f;
 }
-FORCE_INLINE int32 atomic_compare_exchange_strong_release(int32* value, int32 expected, int32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELEASE); return *expected; }
-FORCE_INLINE int64 atomic_compare_exchange_strong_release(int64* value, int64 expected, int64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELEASE); return *expected; }
+FORCE_INLINE int32 atomic_compare_exchange_strong_release(int32* value, int32 expected, int32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELEASE); return expected; }
+FORCE_INLINE int64 atomic_compare_exchange_strong_release(int64* value, int64 expected, int64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELEASE); return expected; }
 FORCE_INLINE int8 atomic_fetch_add_release(int8* value, int8 operand) noexcept { return __atomic_add_fetch(value, operand, __ATOMIC_RELEASE); }
 FORCE_INLINE int8 atomic_fetch_sub_release(int8* value, int8 operand) noexcept { return __atomic_sub_fetch(value, operand, __ATOMIC_RELEASE); }
 FORCE_INLINE int16 atomic_fetch_add_release(int16* value, int16 operand) noexcept { ASSERT_STRICT(((uintptr_t) value % 2) == 0); return __atomic_add_fetch(value, operand, __ATOMIC_RELEASE); }
@@ -362,8 +362,8 @@ FORCE_INLINE void atomic_sub_release(uint32* value, uint32 decrement) noexcept {
 FORCE_INLINE void atomic_add_release(uint64* value, uint64 increment) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_add_fetch(value, increment, __ATOMIC_RELEASE); }
 FORCE_INLINE void atomic_sub_release(uint64* value, uint64 decrement) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_sub_fetch(value, decrement, __ATOMIC_RELEASE); }
 // @bug Wrong implementation, see strong_acquire_release
-FORCE_INLINE uint32 atomic_compare_exchange_strong_release(uint32* value, uint32 expected, uint32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED); return *expected; }
-FORCE_INLINE uint64 atomic_compare_exchange_strong_release(uint64* value, uint64 expected, uint64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, expected, &desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED); return *expected; }
+FORCE_INLINE uint32 atomic_compare_exchange_strong_release(uint32* value, uint32 expected, uint32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED); return expected; }
+FORCE_INLINE uint64 atomic_compare_exchange_strong_release(uint64* value, uint64 expected, uint64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED); return expected; }
 FORCE_INLINE uint8 atomic_fetch_add_release(uint8* value, uint8 operand) noexcept { return __atomic_add_fetch(value, operand, __ATOMIC_RELEASE); }
 FORCE_INLINE uint8 atomic_fetch_sub_release(uint8* value, uint8 operand) noexcept { return __atomic_sub_fetch(value, operand, __ATOMIC_RELEASE); }
 FORCE_INLINE uint16 atomic_fetch_add_release(uint16* value, uint16 operand) noexcept { ASSERT_STRICT(((uintptr_t) value % 2) == 0); return __atomic_add_fetch(value, operand, __ATOMIC_RELEASE); }
@@ -449,8 +449,8 @@ FORCE_INLINE f64 atomic_compare_exchange_strong_acquire_release(f64* value, f64
 
     return expected_as_union.f;
 }
-FORCE_INLINE int32 atomic_compare_exchange_strong_acquire_release(int32* value, int32 expected, int32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, &desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); return expected; }
-FORCE_INLINE int64 atomic_compare_exchange_strong_acquire_release(int64* value, int64 expected, int64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, &desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); return expected; }
+FORCE_INLINE int32 atomic_compare_exchange_strong_acquire_release(int32* value, int32 expected, int32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); return expected; }
+FORCE_INLINE int64 atomic_compare_exchange_strong_acquire_release(int64* value, int64 expected, int64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); return expected; }
 FORCE_INLINE int8 atomic_fetch_add_acquire_release(int8* value, int8 operand) noexcept { return __atomic_add_fetch(value, operand, __ATOMIC_SEQ_CST); }
 FORCE_INLINE int8 atomic_fetch_sub_acquire_release(int8* value, int8 operand) noexcept { return __atomic_sub_fetch(value, operand, __ATOMIC_SEQ_CST); }
 FORCE_INLINE int16 atomic_fetch_add_acquire_release(int16* value, int16 operand) noexcept { ASSERT_STRICT(((uintptr_t) value % 2) == 0); return __atomic_add_fetch(value, operand, __ATOMIC_SEQ_CST); }
@@ -487,8 +487,8 @@ FORCE_INLINE void atomic_add_acquire_release(uint32* value, uint32 increment) no
 FORCE_INLINE void atomic_sub_acquire_release(uint32* value, uint32 decrement) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_sub_fetch(value, decrement, __ATOMIC_SEQ_CST); }
 FORCE_INLINE void atomic_add_acquire_release(uint64* value, uint64 increment) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_add_fetch(value, increment, __ATOMIC_SEQ_CST); }
 FORCE_INLINE void atomic_sub_acquire_release(uint64* value, uint64 decrement) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_sub_fetch(value, decrement, __ATOMIC_SEQ_CST); }
-FORCE_INLINE uint32 atomic_compare_exchange_strong_acquire_release(uint32* value, uint32 expected, uint32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, &desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); return expected; }
-FORCE_INLINE uint64 atomic_compare_exchange_strong_acquire_release(uint64* value, uint64 expected, uint64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, &desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); return expected; }
+FORCE_INLINE uint32 atomic_compare_exchange_strong_acquire_release(uint32* value, uint32 expected, uint32 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 4) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); return expected; }
+FORCE_INLINE uint64 atomic_compare_exchange_strong_acquire_release(uint64* value, uint64 expected, uint64 desired) noexcept { ASSERT_STRICT(((uintptr_t) value % 8) == 0); __atomic_compare_exchange_n(value, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); return expected; }
 FORCE_INLINE uint8 atomic_fetch_add_acquire_release(uint8* value, uint8 operand) noexcept { return __atomic_add_fetch(value, operand, __ATOMIC_SEQ_CST); }
 FORCE_INLINE uint8 atomic_fetch_sub_acquire_release(uint8* value, uint8 operand) noexcept { return __atomic_sub_fetch(value, operand, __ATOMIC_SEQ_CST); }
 FORCE_INLINE uint16 atomic_fetch_add_acquire_release(uint16* value, uint16 operand) noexcept { ASSERT_STRICT(((uintptr_t) value % 2) == 0); return __atomic_add_fetch(value, operand, __ATOMIC_SEQ_CST); }
@@ -522,4 +522,7 @@ FORCE_INLINE void atomic_or_acquire_release(int64* value, int64 mask) noexcept {
 // These are much faster and could accomplish what you are doing
 #define atomic_fence_release() __atomic_thread_fence(__ATOMIC_RELEASE)
 
+// Full fence, also orders a store with a later load
+#define atomic_fence_acquire_release() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
 #endif
\ No newline at end of file
@@ -46,6 +46,9 @@
 #define HOT_CODE __attribute__((hot))
 #define COLD_CODE __attribute__((cold))
 
+// Aligned SIMD loads may read past the end of a string (never past a page boundary)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+
 #define DECLARE_SECTION(name)
 #define SECTION_ALLOC(name) __attribute__((section(name), used))
 #define SECTION_START(name) __start_##name
@@ -57,9 +60,9 @@ int32 compiler_find_first_bit_r2l(uint64 mask) NO_EXCEPT
     ASSERT_STRICT(mask);
 
     #ifdef __LITTLE_ENDIAN__
-        return 63 - __builtin_clzll(mask);
-    #else
         return __builtin_ctzll(mask);
+    #else
+        return 63 - __builtin_clzll(mask);
     #endif
 }
 
@@ -93,12 +96,22 @@ int32 compiler_find_first_bit_l2r(uint32 mask) NO_EXCEPT
     ASSERT_STRICT(mask);
 
     #ifdef __LITTLE_ENDIAN__
-        return __builtin_ctz(mask);
-    #else
         return 31 - __builtin_clz(mask);
+    #else
+        return __builtin_ctz(mask);
     #endif
 }
 
+// Full 64 x 64 = 128 bit multiplication, returns the lower 64 bits
+FORCE_INLINE
+uint64 compiler_mul_128(uint64 a, uint64 b, uint64* high) NO_EXCEPT
+{
+    const unsigned __int128 result = (unsigned __int128) a * b;
+    *high = (uint64) (result >> 64);
+
+    return (uint64) result;
+}
+
 #define compiler_is_bit_set_r2l(num, pos) ((bool) ((num) & (1 << (pos))))
 #define compiler_is_bit_set_64_r2l(num, pos) ((bool) ((num) & (1ULL << (pos))))
 
@@ -47,6 +47,9 @@
 #define HOT_CODE __declspec(code_seg(".text$hot"))
 #define COLD_CODE __declspec(code_seg(".text$cold"))
 
+// Aligned SIMD loads may read past the end of a string (never past a page boundary)
+#define NO_SANITIZE_ADDRESS __declspec(no_sanitize_address)
+
 #define DECLARE_SECTION(name) __pragma(section(name, read))
 #define SECTION_ALLOC(name) __declspec(allocate(name)) __declspec(selectany)
 #define SECTION_START(name) __##name##_start
@@ -98,6 +101,19 @@ void compiler_cpuid(uint32 cpu_info[4], int32 function_id, int32 level = 0) NO_E
     __cpuidex((int32 *) cpu_info, function_id, level);
 }
 
+// Full 64 x 64 = 128 bit multiplication, returns the lower 64 bits
+FORCE_INLINE
+uint64 compiler_mul_128(uint64 a, uint64 b, uint64* high) NO_EXCEPT
+{
+    #ifdef __aarch64__
+        *high = __umulh(a, b);
+
+        return a * b;
+    #else
+        return _umul128(a, b, high);
+    #endif
+}
+
 #define compiler_is_bit_set_r2l(num, pos) _bittest(num, pos)
 #define compiler_is_bit_set_64_r2l(num, pos) _bittest64(num, pos)
 
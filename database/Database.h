@@ -19,6 +19,7 @@
 #else
     int32 db_open_maria(void*) { return 0; };
     void db_close_maria(void*) {};
+    bool db_is_alive_maria(void*) { return true; };
 #endif
 
 #if DB_PSQL
@@ -26,6 +27,7 @@
 #else
     int32 db_open_psql(void*) { return 0; };
     void db_close_psql(void*) {};
+    bool db_is_alive_psql(void*) { return true; };
 #endif
 
 #if DB_SQLITE
@@ -33,6 +35,7 @@
 #else
     int32 db_open_sqlite(void*) { return 0; };
     void db_close_sqlite(void*) {};
+    bool db_is_alive_sqlite(void*) { return true; };
 #endif
 
 inline
@@ -79,4 +82,24 @@ void db_close(DatabaseConnection* db)
     }
 }
 
+// Checks if the connection is still usable (e.g. the server didn't close it)
+inline
+bool db_is_alive(DatabaseConnection* db)
+{
+    switch (db->type) {
+        case DB_TYPE_SQLITE:
+            return db_is_alive_sqlite(db);
+        case DB_TYPE_MARIA:
+            return db_is_alive_maria(db);
+        case DB_TYPE_PSQL:
+            return db_is_alive_psql(db);
+        case DB_TYPE_MSSQL:
+            return true;
+        case DB_TYPE_UNKNOWN:
+            return false;
+        default:
+            UNREACHABLE();
+    }
+}
+
 #endif
\ No newline at end of file
@@ -16,11 +16,36 @@
 #include "../log/PerformanceProfiler.h"
 #include "../compiler/CompilerUtils.h"
 #include "../thread/Atomic.h"
+#include "../thread/Thread.h"
 #include "../system/Allocator.h"
+#include "../utils/TimeUtils.h"
 #include "DatabaseConnection.h"
 #include "Database.h"
 #include "../memory/ChunkMemory.cpp"
 
+// Connections that were idle for longer than this are checked before they are handed out
+#define DB_POOL_HEALTH_CHECK_INTERVAL 30000000 // in us
+
+// A thread waiting for a connection
+// The waiter lives on the stack of the waiting thread
+struct DatabasePoolWaiter {
+    DatabasePoolWaiter* next;
+    mutex_cond cond;
+
+    // Set by the releasing thread, -1 = still waiting
+    int32 id;
+};
+
+// Metrics of the pool itself (the same values are also reported to the stats system)
+struct DatabasePoolMetrics {
+    atomic_64 int64 acquired;
+    atomic_64 int64 waited;
+    atomic_64 int64 timeouts;
+    atomic_64 int64 reconnects;
+    atomic_64 int64 wait_time; // in us
+    atomic_64 int64 max_wait_time; // in us
+};
+
 struct DatabasePool {
     // How many connections does this pool support?
     uint8 count;
@@ -28,8 +53,20 @@ struct DatabasePool {
 
     DatabaseConnection* connections;
 
+    // Last time a connection was released (in us), used for the health check
+    uint64* last_used;
+
     // Bitfield showing which connections are free and which are in use
     atomic_64 uint64* free;
+
+    // FIFO queue of threads waiting for a connection
+    // The queue is only touched while holding the mutex
+    mutex mtx;
+    DatabasePoolWaiter* wait_head;
+    DatabasePoolWaiter* wait_tail;
+    atomic_32 int32 waiting;
+
+    DatabasePoolMetrics metrics;
 };
 
 void db_pool_alloc(DatabasePool* const pool, uint8 count) NO_EXCEPT {
@@ -38,12 +75,25 @@ void db_pool_alloc(DatabasePool* const pool, uint8 count) NO_EXCEPT {
     LOG_1("[INFO] Allocating DatabasePool for %d connections", {DATA_TYPE_UINT8, &count});
 
     uint64 size = count * sizeof(DatabaseConnection)
-        + sizeof(uint64) * ceil_div(count, 64) // free
+        + count * sizeof(uint64) // last_used
+        + sizeof(uint64) * ceil_div((int32) count, 64) // free
         + 64 * 2; // overhead for alignment
 
     pool->connections = (DatabaseConnection *) platform_alloc_aligned(size, size, ASSUMED_CACHE_LINE_SIZE);
-    pool->free = (uint64 *) align_up((uintptr_t) (pool->connections + count * sizeof(DatabaseConnection)), 64);
+    pool->last_used = (uint64 *) align_up((uintptr_t) ((byte *) pool->connections + count * sizeof(DatabaseConnection)), 8);
+    pool->free = (uint64 *) align_up((uintptr_t) (pool->last_used + count), 64);
     pool->count = count;
+
+    memset(pool->last_used, 0, count * sizeof(uint64));
+    memset((void *) pool->free, 0, sizeof(uint64) * ceil_div((int32) count, 64));
+
+    // mutex_init() doesn't initialize the futex on every platform
+    memset(&pool->mtx, 0, sizeof(pool->mtx));
+    mutex_init(&pool->mtx, NULL);
+    pool->wait_head = NULL;
+    pool->wait_tail = NULL;
+    pool->waiting = 0;
+    memset(&pool->metrics, 0, sizeof(pool->metrics));
 }
 
 void db_pool_add(
@@ -53,36 +103,229 @@ void db_pool_add(
 {
     db->id = ++pool->pos;
     memcpy(&pool->connections[pool->pos], db, sizeof(DatabaseConnection));
+    pool->last_used[pool->pos] = time_mu();
 }
 
 void db_pool_free(DatabasePool* const pool) NO_EXCEPT {
     LOG_1("[INFO] Freeing DatabasePool");
+    ASSERT_TRUE(!pool->wait_head);
 
     for (int32 i = 0; i < pool->count; ++i) {
         db_close(&pool->connections[i]);
     }
 
+    mutex_destroy(&pool->mtx);
+
     platform_aligned_free((void **) &pool->connections);
+    pool->last_used = NULL;
     pool->free = NULL;
     pool->count = 0;
 }
 
+FORCE_INLINE
+int32 db_pool_reserve(DatabasePool* const pool) NO_EXCEPT
+{
+    return thrd_chunk_reserve_one_atomic(pool->free, pool->count, 0);
+}
+
+// Makes sure the reserved connection is usable before handing it out
+// Only connections that were idle for a long time are checked, the check may require a round trip to the server
+static
+void db_pool_health_check(DatabasePool* const pool, int32 id) NO_EXCEPT
+{
+    if (time_mu() - pool->last_used[id] < DB_POOL_HEALTH_CHECK_INTERVAL) {
+        return;
+    }
+
+    DatabaseConnection* db = &pool->connections[id];
+    if (db_is_alive(db)) {
+        return;
+    }
+
+    LOG_1("[WARNING] Reconnecting database connection %d", {DATA_TYPE_UINT32, &db->id});
+
+    db_close(db);
+    db_open(db);
+
+    atomic_increment_relaxed(&pool->metrics.reconnects);
+    STATS_INCREMENT_DEBUG(DEBUG_COUNTER_DB_POOL_RECONNECT);
+}
+
+// Hands free connections to the waiting threads in FIFO order
+// WARNING: The pool mutex must be locked
+static
+void db_pool_handoff(DatabasePool* const pool) NO_EXCEPT
+{
+    while (pool->wait_head) {
+        const int32 id = db_pool_reserve(pool);
+        if (id < 0) {
+            return;
+        }
+
+        DatabasePoolWaiter* waiter = pool->wait_head;
+        pool->wait_head = waiter->next;
+        if (!pool->wait_head) {
+            pool->wait_tail = NULL;
+        }
+
+        atomic_decrement_acquire_release(&pool->waiting);
+
+        waiter->id = id;
+        coms_pthread_cond_signal(&waiter->cond);
+    }
+}
+
 // Returns free database connection or null if none could be found
-// @todo implement db_pool_get_wait(pool, waittime)
+// This never waits and doesn't skip the queue of waiting threads
 FORCE_INLINE
-const DatabaseConnection* db_pool_get(DatabasePool* const pool) NO_EXCEPT
+DatabaseConnection* db_pool_get(DatabasePool* const pool) NO_EXCEPT
+{
+    if (atomic_get_acquire(&pool->waiting)) {
+        return NULL;
+    }
+
+    const int32 id = db_pool_reserve(pool);
+    if (id < 0) {
+        return NULL;
+    }
+
+    db_pool_health_check(pool, id);
+
+    atomic_increment_relaxed(&pool->metrics.acquired);
+    STATS_INCREMENT_DEBUG(DEBUG_COUNTER_DB_POOL_ACQUIRE);
+
+    return &pool->connections[id];
+}
+
+/**
+ * Returns a free database connection, if none is available the thread waits for one
+ *
+ * Waiting threads are served in FIFO order, a connection that gets released is directly handed to the oldest waiter.
+ *
+ * @param pool      Database pool
+ * @param timeout   Maximum wait time in us
+ *
+ * @return Database connection or NULL if the timeout elapsed
+ */
+DatabaseConnection* db_pool_get_wait(DatabasePool* const pool, uint64 timeout) NO_EXCEPT
 {
-    // @question Why are we not using reserve?
-    int32 id = thrd_chunk_reserve_one(pool->free, (pool->count - 1) / 64, 0);
+    DatabaseConnection* db = db_pool_get(pool);
+    if (db) {
+        return db;
+    }
+
+    const uint64 start = time_mu();
+    const uint64 deadline = start + timeout;
+
+    DatabasePoolWaiter waiter;
+    waiter.next = NULL;
+    waiter.id = -1;
+    coms_pthread_cond_init(&waiter.cond, NULL);
+
+    mutex_lock(&pool->mtx);
+
+    if (pool->wait_tail) {
+        pool->wait_tail->next = &waiter;
+    } else {
+        pool->wait_head = &waiter;
+    }
+    pool->wait_tail = &waiter;
+
+    // The increment must happen before the handoff below
+    // A releasing thread either sees the waiter or we see the released connection
+    // This store -> load ordering (same in db_pool_release) requires a full fence
+    atomic_increment_acquire_release(&pool->waiting);
+    atomic_fence_acquire_release();
+    db_pool_handoff(pool);
+
+    uint64 now = time_mu();
+    while (waiter.id < 0 && now < deadline) {
+        const uint64 remaining = deadline - now;
+
+        timespec ts;
+        ts.tv_sec = (time_t) (remaining / 1000000);
+        ts.tv_nsec = (long) ((remaining % 1000000) * 1000);
+
+        mutex_condimedwait(&waiter.cond, &pool->mtx, &ts);
+        now = time_mu();
+    }
 
-    return id >= 0 ? &pool->connections[id] : NULL;
+    if (waiter.id < 0) {
+        // Timed out -> remove ourselves from the queue
+        DatabasePoolWaiter* prev = NULL;
+        DatabasePoolWaiter* current = pool->wait_head;
+        while (current != &waiter) {
+            prev = current;
+            current = current->next;
+        }
+
+        if (prev) {
+            prev->next = waiter.next;
+        } else {
+            pool->wait_head = waiter.next;
+        }
+
+        if (pool->wait_tail == &waiter) {
+            pool->wait_tail = prev;
+        }
+
+        atomic_decrement_acquire_release(&pool->waiting);
+    }
+
+    mutex_unlock(&pool->mtx);
+    coms_pthread_cond_destroy(&waiter.cond);
+
+    const int64 wait_time = (int64) (now - start);
+    atomic_increment_relaxed(&pool->metrics.waited);
+    atomic_add_relaxed(&pool->metrics.wait_time, wait_time);
+
+    // Atomic max, a concurrent waiter may have stored a larger value in the meantime
+    int64 max_wait_time = atomic_get_relaxed(&pool->metrics.max_wait_time);
+    while (wait_time > max_wait_time) {
+        const int64 old = atomic_compare_exchange_strong_relaxed(&pool->metrics.max_wait_time, max_wait_time, wait_time);
+        if (old == max_wait_time) {
+            break;
+        }
+
+        max_wait_time = old;
+    }
+
+    STATS_INCREMENT_DEBUG(DEBUG_COUNTER_DB_POOL_WAIT);
+    STATS_INCREMENT_BY_DEBUG(DEBUG_COUNTER_DB_POOL_WAIT_TIME, wait_time);
+    STATS_MAX_DEBUG(DEBUG_COUNTER_DB_POOL_MAX_WAIT_TIME, wait_time);
+
+    if (waiter.id < 0) {
+        atomic_increment_relaxed(&pool->metrics.timeouts);
+        STATS_INCREMENT_DEBUG(DEBUG_COUNTER_DB_POOL_TIMEOUT);
+
+        return NULL;
+    }
+
+    db_pool_health_check(pool, waiter.id);
+
+    atomic_increment_relaxed(&pool->metrics.acquired);
+    STATS_INCREMENT_DEBUG(DEBUG_COUNTER_DB_POOL_ACQUIRE);
+
+    return &pool->connections[waiter.id];
 }
 
 // releases the database connection for use
 FORCE_INLINE
 void db_pool_release(DatabasePool* const pool, int32 id) NO_EXCEPT
 {
+    pool->last_used[id] = time_mu();
     thrd_chunk_set_unset_atomic(id, pool->free);
+
+    // Only touch the mutex if someone is waiting
+    // The fence pairs with the one in db_pool_get_wait(), otherwise the load may happen before the release
+    atomic_fence_acquire_release();
+    if (!atomic_get_acquire_release(&pool->waiting)) {
+        return;
+    }
+
+    mutex_lock(&pool->mtx);
+    db_pool_handoff(pool);
+    mutex_unlock(&pool->mtx);
 }
 
-#endif
\ No newline at end of file
+#endif
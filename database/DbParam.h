@@ -37,13 +37,13 @@ struct DbParam {
 };
 
 // Helper macros for cleaner calling syntax
-#define DB_INT8(x) {DB_PARAM_INT8, .int8_val=(x)}
-#define DB_INT16(x) {DB_PARAM_INT16, .int16_val=(x)}
-#define DB_INT32(x) {DB_PARAM_INT32, .int32_val=(x)}
-#define DB_INT64(x) {DB_PARAM_INT64, .int64_val=(x)}
-#define DB_F32(x) {DB_PARAM_F32, .f32_val=(x)}
-#define DB_F64(x) {DB_PARAM_F64, .f64_val=(x)}
-#define DB_TEXT(x) {DB_PARAM_TEXT, .text_val=(x)}
-#define DB_END {DB_PARAM_NULL}
+#define DB_INT8(x) {.type=DB_PARAM_INT8, .int8_val=(x)}
+#define DB_INT16(x) {.type=DB_PARAM_INT16, .int16_val=(x)}
+#define DB_INT32(x) {.type=DB_PARAM_INT32, .int32_val=(x)}
+#define DB_INT64(x) {.type=DB_PARAM_INT64, .int64_val=(x)}
+#define DB_F32(x) {.type=DB_PARAM_F32, .f32_val=(x)}
+#define DB_F64(x) {.type=DB_PARAM_F64, .f64_val=(x)}
+#define DB_TEXT(x) {.type=DB_PARAM_TEXT, .text_val=(x)}
+#define DB_END {.type=DB_PARAM_NULL}
 
 #endif
\ No newline at end of file
@@ -24,8 +24,6 @@ int32 db_open_psql(DatabaseConnection* db)
 {
     ASSERT_TRUE(sizeof(db->con) >= sizeof(pqxx::connection));
 
-    PGconn* db_con = (PGconn *) db->con;
-
     char conninfo[256];
     sprintf_fast(
         conninfo, sizeof(conninfo),
@@ -33,7 +31,9 @@ int32 db_open_psql(DatabaseConnection* db)
         db->host, db->port, db->name, db->user, db->pass
     );
 
-    db_con = PQconnectdb(conninfo);
+    PGconn* db_con = PQconnectdb(conninfo);
+    *((PGconn **) db->con) = db_con;
+
     if (PQstatus(db_con) != CONNECTION_OK) {
         return -1;
     }
@@ -43,10 +43,17 @@ int32 db_open_psql(DatabaseConnection* db)
 
 inline
 void db_close_psql(DatabaseConnection* db) {
-    PQfinish((PGconn *) db->con);
+    PQfinish(*((PGconn **) db->con));
     memset(db->con, 0, sizeof(db->con));
 }
 
+inline
+bool db_is_alive_psql(DatabaseConnection* db) {
+    PGconn* db_con = *((PGconn **) db->con);
+
+    return db_con && PQstatus(db_con) == CONNECTION_OK;
+}
+
 inline
 void* db_prepare_psql(void* con, const char* name, const char* query) {
     PGresult* res = PQprepare((PGconn *) con, name, query, 0, NULL);
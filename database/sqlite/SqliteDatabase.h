@@ -11,6 +11,10 @@
 #define COMS_DATABASE_SQLITE_H
 
 #include "../../stdlib/Stdlib.h"
+#include "../../system/Allocator.h"
+#include "../../log/Log.h"
+#include "../DatabaseConnection.h"
+#include "../DbParam.h"
 
 #if _WIN32
     #include "../../dependencies/sqlite/src/sqlite3.h"
@@ -18,27 +22,418 @@
     #include <sqlite3.h>
 #endif
 
+// Maximum amount of prepared statements per connection
+// The query id is directly used as index into the statement cache -> query ids should be a dense enum
+#ifndef DB_SQLITE_STATEMENT_CACHE_SIZE
+    #define DB_SQLITE_STATEMENT_CACHE_SIZE 128
+#endif
+
+// Bulk inserts are committed in chunks of this many rows to limit the journal size
+#ifndef DB_SQLITE_BATCH_SIZE
+    #define DB_SQLITE_BATCH_SIZE 1024
+#endif
+
+// Stored inside of DatabaseConnection::con
+struct SqliteConnection {
+    sqlite3* db;
+
+    // Prepared statement cache, the index is the query id
+    sqlite3_stmt** statements;
+
+    // Nesting depth of db_transaction_begin_sqlite, only the outermost level creates a real transaction
+    int32 transaction_depth;
+};
+
+FORCE_INLINE
+SqliteConnection* db_con_sqlite(DatabaseConnection* db) NO_EXCEPT
+{
+    return (SqliteConnection *) db->con;
+}
+
 inline
-int32 db_open_sqlite(DatabaseConnection* db)
+int32 db_open_sqlite(DatabaseConnection* db) NO_EXCEPT
 {
-    ASSERT_TRUE(sizeof(db->con) >= sizeof(sqlite3*));
+    static_assert(sizeof(db->con) >= sizeof(SqliteConnection));
 
-    int32 rc;
-    rc = sqlite3_open(db->host, (sqlite3 **) &db->con);
+    SqliteConnection* con = db_con_sqlite(db);
+    memset(con, 0, sizeof(SqliteConnection));
 
-    db->con = rc;
+    // The host is the file path (or ":memory:")
+    int32 rc = sqlite3_open_v2(
+        db->host, &con->db,
+        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+        NULL
+    );
+
+    if (rc != SQLITE_OK) {
+        LOG_1("[ERROR] Couldn't open sqlite database: %s", {DATA_TYPE_CHAR_STR, (void *) sqlite3_errmsg(con->db)});
+
+        // sqlite may allocate a handle even on failure
+        sqlite3_close(con->db);
+        con->db = NULL;
 
-    if (!rc) {
         return -1;
     }
 
+    // WAL allows readers while writing and only syncs on checkpoints
+    // For an in-memory database these pragmas are no-ops
+    sqlite3_exec(con->db, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
+
+    con->statements = (sqlite3_stmt **) platform_alloc_aligned(
+        DB_SQLITE_STATEMENT_CACHE_SIZE * sizeof(sqlite3_stmt *)
+    );
+    memset(con->statements, 0, DB_SQLITE_STATEMENT_CACHE_SIZE * sizeof(sqlite3_stmt *));
+
+    return 1;
+}
+
+inline
+void db_close_sqlite(DatabaseConnection* db) NO_EXCEPT
+{
+    SqliteConnection* con = db_con_sqlite(db);
+
+    if (con->statements) {
+        for (int32 i = 0; i < DB_SQLITE_STATEMENT_CACHE_SIZE; ++i) {
+            // Finalizing NULL is a harmless no-op
+            sqlite3_finalize(con->statements[i]);
+        }
+
+        platform_aligned_free((void **) &con->statements);
+    }
+
+    // Not sqlite3_close_v2, all statements are finalized above -> the close must succeed
+    sqlite3_close(con->db);
+    memset(db->con, 0, sizeof(db->con));
+}
+
+inline
+bool db_is_alive_sqlite(DatabaseConnection* db) NO_EXCEPT
+{
+    // A local database file can't be disconnected
+    return db_con_sqlite(db)->db != NULL;
+}
+
+/**
+ * Returns the prepared statement of a query
+ *
+ * The statement is only compiled on the first call, afterwards the cached statement is reset and returned.
+ *
+ * @param db        Database connection
+ * @param query_id  Application defined query id (< DB_SQLITE_STATEMENT_CACHE_SIZE)
+ * @param query     Sql query, only used on the first call for this query id
+ *
+ * @return Statement or NULL on error
+ */
+sqlite3_stmt* db_prepare_sqlite(DatabaseConnection* db, int32 query_id, const char* query) NO_EXCEPT
+{
+    ASSERT_TRUE(query_id >= 0 && query_id < DB_SQLITE_STATEMENT_CACHE_SIZE);
+
+    SqliteConnection* con = db_con_sqlite(db);
+    sqlite3_stmt* stmt = con->statements[query_id];
+
+    if (stmt) {
+        // Bindings are overwritten anyway when binding the next parameters
+        sqlite3_reset(stmt);
+
+        return stmt;
+    }
+
+    // Persistent tells sqlite that the statement is long lived (avoids using the lookaside memory)
+    if (sqlite3_prepare_v3(con->db, query, -1, SQLITE_PREPARE_PERSISTENT, &stmt, NULL) != SQLITE_OK) {
+        LOG_1("[ERROR] Couldn't prepare sqlite query: %s", {DATA_TYPE_CHAR_STR, (void *) sqlite3_errmsg(con->db)});
+
+        return NULL;
+    }
+
+    con->statements[query_id] = stmt;
+
+    return stmt;
+}
+
+// Removes a query from the statement cache
+inline
+void db_unprepare_sqlite(DatabaseConnection* db, int32 query_id) NO_EXCEPT
+{
+    SqliteConnection* con = db_con_sqlite(db);
+    sqlite3_finalize(con->statements[query_id]);
+    con->statements[query_id] = NULL;
+}
+
+static
+int32 db_bind_sqlite(sqlite3_stmt* stmt, const DbParam* params, int32 param_count) NO_EXCEPT
+{
+    int32 rc = SQLITE_OK;
+
+    // sqlite parameters are 1-indexed
+    for (int32 i = 0; i < param_count && rc == SQLITE_OK; ++i) {
+        switch (params[i].type) {
+            case DB_PARAM_INT8:
+                rc = sqlite3_bind_int(stmt, i + 1, params[i].int8_val);
+                break;
+            case DB_PARAM_INT16:
+                rc = sqlite3_bind_int(stmt, i + 1, params[i].int16_val);
+                break;
+            case DB_PARAM_INT32:
+                rc = sqlite3_bind_int(stmt, i + 1, params[i].int32_val);
+                break;
+            case DB_PARAM_INT64:
+                rc = sqlite3_bind_int64(stmt, i + 1, params[i].int64_val);
+                break;
+            case DB_PARAM_F32:
+                rc = sqlite3_bind_double(stmt, i + 1, params[i].f32_val);
+                break;
+            case DB_PARAM_F64:
+                rc = sqlite3_bind_double(stmt, i + 1, params[i].f64_val);
+                break;
+            case DB_PARAM_TEXT:
+                // SQLITE_STATIC = no copy, the text must stay valid until the statement is stepped
+                rc = sqlite3_bind_text(stmt, i + 1, params[i].text_val, -1, SQLITE_STATIC);
+                break;
+            case DB_PARAM_NULL:
+                rc = sqlite3_bind_null(stmt, i + 1);
+                break;
+            default:
+                UNREACHABLE();
+        }
+    }
+
     return rc;
 }
 
+/**
+ * Executes a query that doesn't return rows (insert, update, delete, ...)
+ *
+ * @return Number of changed rows or -1 on error
+ */
+int32 db_execute_prepared_sqlite(
+    DatabaseConnection* db,
+    int32 query_id,
+    const char* query,
+    const DbParam* params,
+    int32 param_count
+) NO_EXCEPT
+{
+    sqlite3_stmt* stmt = db_prepare_sqlite(db, query_id, query);
+    if (!stmt || db_bind_sqlite(stmt, params, param_count) != SQLITE_OK) {
+        return -1;
+    }
+
+    int32 rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+        LOG_1("[ERROR] Sqlite query failed: %s", {DATA_TYPE_CHAR_STR, (void *) sqlite3_errmsg(db_con_sqlite(db)->db)});
+
+        return -1;
+    }
+
+    return sqlite3_changes(db_con_sqlite(db)->db);
+}
+
+inline
+int32 db_execute_sqlite(DatabaseConnection* db, const char* query) NO_EXCEPT
+{
+    return sqlite3_exec(db_con_sqlite(db)->db, query, NULL, NULL, NULL) == SQLITE_OK ? 1 : -1;
+}
+
+// Transactions can be nested, only the outermost begin/commit pair hits the database
+inline
+int32 db_transaction_begin_sqlite(DatabaseConnection* db) NO_EXCEPT
+{
+    SqliteConnection* con = db_con_sqlite(db);
+    if (con->transaction_depth) {
+        ++con->transaction_depth;
+
+        return 1;
+    }
+
+    // Only count the transaction if it actually started (e.g. BEGIN fails with SQLITE_BUSY)
+    if (db_execute_sqlite(db, "BEGIN IMMEDIATE") < 0) {
+        return -1;
+    }
+
+    con->transaction_depth = 1;
+
+    return 1;
+}
+
+inline
+int32 db_transaction_commit_sqlite(DatabaseConnection* db) NO_EXCEPT
+{
+    SqliteConnection* con = db_con_sqlite(db);
+    ASSERT_TRUE(con->transaction_depth > 0);
+
+    if (--con->transaction_depth) {
+        return 1;
+    }
+
+    return db_execute_sqlite(db, "COMMIT");
+}
+
+inline
+void db_transaction_rollback_sqlite(DatabaseConnection* db) NO_EXCEPT
+{
+    SqliteConnection* con = db_con_sqlite(db);
+    con->transaction_depth = 0;
+
+    db_execute_sqlite(db, "ROLLBACK");
+}
+
+/**
+ * Inserts many rows with the same prepared statement
+ *
+ * Every DB_SQLITE_BATCH_SIZE rows are committed in one transaction.
+ * Without a transaction sqlite would sync the journal for every single row.
+ * If the caller already opened a transaction the rows become part of that transaction.
+ *
+ * @param db                Database connection
+ * @param query_id          Query id of the insert statement
+ * @param query             Insert statement with params_per_row parameters
+ * @param params            Parameters of all rows (row_count * params_per_row)
+ * @param params_per_row    Parameters per row
+ * @param row_count         Rows to insert
+ *
+ * @return Number of inserted rows, on error the current batch is rolled back
+ */
+int32 db_insert_batch_sqlite(
+    DatabaseConnection* db,
+    int32 query_id,
+    const char* query,
+    const DbParam* params,
+    int32 params_per_row,
+    int32 row_count
+) NO_EXCEPT
+{
+    sqlite3_stmt* stmt = db_prepare_sqlite(db, query_id, query);
+    if (!stmt) {
+        return -1;
+    }
+
+    const bool is_nested = db_con_sqlite(db)->transaction_depth > 0;
+
+    int32 inserted = 0;
+    for (int32 batch_start = 0; batch_start < row_count; batch_start += DB_SQLITE_BATCH_SIZE) {
+        const int32 batch_end = OMS_MIN(batch_start + DB_SQLITE_BATCH_SIZE, row_count);
+
+        if (db_transaction_begin_sqlite(db) < 0) {
+            LOG_1("[ERROR] Sqlite batch insert failed: %s", {DATA_TYPE_CHAR_STR, (void *) sqlite3_errmsg(db_con_sqlite(db)->db)});
+
+            return inserted;
+        }
+
+        for (int32 row = batch_start; row < batch_end; ++row) {
+            int32 rc = db_bind_sqlite(stmt, params + row * params_per_row, params_per_row);
+            if (rc == SQLITE_OK) {
+                rc = sqlite3_step(stmt);
+            }
+
+            sqlite3_reset(stmt);
+
+            if (rc != SQLITE_DONE) {
+                LOG_1("[ERROR] Sqlite batch insert failed: %s", {DATA_TYPE_CHAR_STR, (void *) sqlite3_errmsg(db_con_sqlite(db)->db)});
+
+                if (is_nested) {
+                    // The caller owns the transaction and decides what to do
+                    --db_con_sqlite(db)->transaction_depth;
+                } else {
+                    db_transaction_rollback_sqlite(db);
+                }
+
+                return inserted;
+            }
+        }
+
+        db_transaction_commit_sqlite(db);
+        inserted = batch_end;
+    }
+
+    return inserted;
+}
+
+/**
+ * Runs a query that returns rows
+ *
+ * Iterate the rows with db_row_next_sqlite() and read the columns with the db_column_*_sqlite() functions.
+ * The statement must be finished with db_query_end_sqlite().
+ *
+ * @return Statement or NULL on error
+ */
+sqlite3_stmt* db_query_sqlite(
+    DatabaseConnection* db,
+    int32 query_id,
+    const char* query,
+    const DbParam* params,
+    int32 param_count
+) NO_EXCEPT
+{
+    sqlite3_stmt* stmt = db_prepare_sqlite(db, query_id, query);
+    if (!stmt || db_bind_sqlite(stmt, params, param_count) != SQLITE_OK) {
+        return NULL;
+    }
+
+    return stmt;
+}
+
+FORCE_INLINE
+bool db_row_next_sqlite(sqlite3_stmt* stmt) NO_EXCEPT
+{
+    return sqlite3_step(stmt) == SQLITE_ROW;
+}
+
+// Releases the read lock, the statement stays in the cache
+FORCE_INLINE
+void db_query_end_sqlite(sqlite3_stmt* stmt) NO_EXCEPT
+{
+    sqlite3_reset(stmt);
+}
+
+FORCE_INLINE
+int32 db_column_int32_sqlite(sqlite3_stmt* stmt, int32 column) NO_EXCEPT
+{
+    return sqlite3_column_int(stmt, column);
+}
+
+FORCE_INLINE
+int64 db_column_int64_sqlite(sqlite3_stmt* stmt, int32 column) NO_EXCEPT
+{
+    return sqlite3_column_int64(stmt, column);
+}
+
+FORCE_INLINE
+f64 db_column_f64_sqlite(sqlite3_stmt* stmt, int32 column) NO_EXCEPT
+{
+    return sqlite3_column_double(stmt, column);
+}
+
+// Zero-copy access to the column data
+// WARNING: The pointer is only valid until the next db_row_next_sqlite() or db_query_end_sqlite() call
 inline
-void db_close_sqlite(DatabaseConnection* db)
+const char* db_column_text_sqlite(sqlite3_stmt* stmt, int32 column, int32* length = NULL) NO_EXCEPT
 {
-    sqlite3_close((sqlite3 *) db->con);
+    const char* text = (const char *) sqlite3_column_text(stmt, column);
+
+    // Must be called after sqlite3_column_text, otherwise the length may refer to a different encoding
+    if (length) {
+        *length = sqlite3_column_bytes(stmt, column);
+    }
+
+    return text;
 }
 
-#endif
\ No newline at end of file
+// WARNING: The pointer is only valid until the next db_row_next_sqlite() or db_query_end_sqlite() call
+inline
+const byte* db_column_blob_sqlite(sqlite3_stmt* stmt, int32 column, int32* length) NO_EXCEPT
+{
+    const byte* blob = (const byte *) sqlite3_column_blob(stmt, column);
+    *length = sqlite3_column_bytes(stmt, column);
+
+    return blob;
+}
+
+FORCE_INLINE
+bool db_column_is_null_sqlite(sqlite3_stmt* stmt, int32 column) NO_EXCEPT
+{
+    return sqlite3_column_type(stmt, column) == SQLITE_NULL;
+}
+
+#endif
@@ -45,6 +45,13 @@ struct VoxelFace {
     uint8 rotation;
 };
 
+// Compares the members, memcmp would also compare the (uninitialized) padding
+FORCE_INLINE
+bool voxel_face_equals(const VoxelFace* a, const VoxelFace* b) NO_EXCEPT
+{
+    return a->type == b->type && a->rotation == b->rotation;
+}
+
 // Used for greedy meshing
 // This holds temporary information about the Face
 struct VoxelMaskCell {
@@ -52,6 +59,10 @@ struct VoxelMaskCell {
 
     // @performance we probably want this to be outside as a bit field -> much more memory efficient
     bool is_filled;
+
+    // The solid voxel is on the d side (B) of the slice boundary, otherwise on the d - 1 side (A)
+    // Faces with a different orientation must not be merged
+    bool is_front;
 };
 
 // @todo Move to Voxel type enum
@@ -67,16 +78,27 @@ bool voxel_is_solid(int32 type) NO_EXCEPT
 // WARNING: MUST be divisible by 2
 #define VOXEL_CHUNK_SIZE 32
 
+// Max vertices of a chunk mesh, 4 vertices and 6 indices per quad
+// The mesh build stops if a chunk needs more (the remaining faces are dropped)
+// Generated terrain with caves (VoxelTerrain.h, default settings, 1728 chunks of 3 seeds) needs:
+//      avg. ~3,600 vertices
+//      max. ~11,300 vertices
+// This makes the mesh ~290 KB per chunk, reduce it if the terrain is simpler (e.g. no caves)
+#ifndef VOXEL_CHUNK_MESH_VERTICES
+    #define VOXEL_CHUNK_MESH_VERTICES (VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * 12)
+#endif
+
 struct VoxelChunkMesh {
     // Interleaved vertex: position (f323), normal (packed int8x3),
     // type (uint16), rotation (uint8), padding (uint8)
     // Layout kept simple; adjust to your renderer.
     // @question Consider to change some of the types below vectors (vertices and normals at least)
-    v3_f32 vertices[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * 3]; // [num_vertices * 3]
-    uint16 types[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE]; // [num_vertices] // @question not sure i need this information here
-    v3_byte normals[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE]; // [num_vertices * 3]
-    uint8 rotations[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE];// [num_vertices] // @question not sure i need this information here
-    uint32 indices[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * 2]; // [num_vertices * 2]
+    // The per vertex arrays MUST have the same size
+    v3_f32 vertices[VOXEL_CHUNK_MESH_VERTICES]; // [num_vertices * 3]
+    uint16 types[VOXEL_CHUNK_MESH_VERTICES]; // [num_vertices] // @question not sure i need this information here
+    v3_byte normals[VOXEL_CHUNK_MESH_VERTICES]; // [num_vertices * 3]
+    uint8 rotations[VOXEL_CHUNK_MESH_VERTICES];// [num_vertices] // @question not sure i need this information here
+    uint32 indices[VOXEL_CHUNK_MESH_VERTICES / 4 * 6]; // [num_vertices / 4 * 6]
     uint32 num_vertices;
     uint32 num_indices;
     uint32 cap_vertices;
@@ -89,6 +111,7 @@ enum VoxelChunkFlag : byte {
     VOXEL_CHUNK_FLAG_IS_CHANGED = 1 << 1,
     VOXEL_CHUNK_FLAG_IS_INACTIVE = 1 << 2, // not rendered currently
     VOXEL_CHUNK_FLAG_SHOULD_REMOVE = 1 << 3, // shouldn't stay in memory
+    VOXEL_CHUNK_FLAG_IS_GENERATING = 1 << 4, // voxels and mesh are still written by the generator
 };
 
 // CPU-side mesh buffers (triangulated greedy mesh)
@@ -189,7 +212,7 @@ void voxel_chunk_vertex_push(
 ) NO_EXCEPT
 {
     // We currently don't support growing chunks
-    ASSERT_TRUE(chunk->mesh.num_vertices <= VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * 3);
+    ASSERT_TRUE(chunk->mesh.num_vertices < chunk->mesh.cap_vertices);
 
     uint32 i = chunk->mesh.num_vertices++;
 
@@ -209,7 +232,7 @@ void voxel_chunk_quad_push(
     uint32 v0, uint32 v1, uint32 v2, uint32 v3
 ) NO_EXCEPT
 {
-    ASSERT_TRUE(chunk->mesh.num_indices <= chunk->mesh.cap_indices);
+    ASSERT_TRUE(chunk->mesh.num_indices + 6 <= chunk->mesh.cap_indices);
 
     chunk->mesh.indices[chunk->mesh.num_indices + 0] = v0;
     chunk->mesh.indices[chunk->mesh.num_indices + 1] = v2;
@@ -222,4 +245,206 @@ void voxel_chunk_quad_push(
     chunk->mesh.num_indices += 6;
 }
 
+// Builds the greedy mesh of a chunk
+// Only uses the voxels of the chunk itself (outside of the chunk is air)
+// -> can be called for multiple chunks in parallel
+// If the mesh buffers are full the remaining faces are dropped
+void voxel_chunk_mesh_build(VoxelChunk* const chunk) NO_EXCEPT
+{
+    chunk->mesh.num_vertices = 0;
+    chunk->mesh.num_indices = 0;
+
+    // world base (chunk origin in world coordinates)
+    const v3_f32 base = {
+        (f32) chunk->coord.x * (f32) VOXEL_CHUNK_SIZE,
+        (f32) chunk->coord.y * (f32) VOXEL_CHUNK_SIZE,
+        (f32) chunk->coord.z * (f32) VOXEL_CHUNK_SIZE
+    };
+
+    // @bug This is probably using up all our stack memory once we multithread it
+    VoxelMaskCell mask[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE];
+
+    // Build quads between solid/air slabs
+    // x,y,z are the axis 0-2
+    for (int32 axis = 0; axis < 3; ++axis) {
+        int32 u = (axis + 1) % 3;
+        int32 v = (axis + 2) % 3;
+
+        // d = VOXEL_CHUNK_SIZE creates the faces at the upper chunk border
+        for (int32 d = 0; d <= VOXEL_CHUNK_SIZE; ++d) {
+            // Fill mask with faces between slices d - 1 and d along the axis
+            for (int32 j = 0; j < VOXEL_CHUNK_SIZE; ++j) {
+                for (int32 i = 0; i < VOXEL_CHUNK_SIZE; ++i) {
+                    v3_int32 coordA = {0, 0, 0};
+                    v3_int32 coordB = {0, 0, 0};
+
+                    // set u and v components
+                    coordA.vec[u] = i;
+                    coordA.vec[v] = j;
+                    coordB.vec[u] = i;
+                    coordB.vec[v] = j;
+
+                    coordA.vec[axis] = d - 1;
+                    coordB.vec[axis] = d;
+
+                    Voxel a = {0,0}; // default: air
+                    Voxel b = {0,0};
+                    bool a_valid = (coordA.vec[axis] >= 0 && coordA.vec[axis] < VOXEL_CHUNK_SIZE);
+                    bool b_valid = (coordB.vec[axis] >= 0 && coordB.vec[axis] < VOXEL_CHUNK_SIZE);
+
+                    if (a_valid) {
+                        a = voxel_chunk_get(chunk, coordA.x, coordA.y, coordA.z);
+                    }
+                    if (b_valid) {
+                        b = voxel_chunk_get(chunk, coordB.x, coordB.y, coordB.z);
+                    }
+
+                    bool solidA = voxel_is_solid(a.type);
+                    bool solidB = voxel_is_solid(b.type);
+
+                    VoxelMaskCell* m = &mask[j * VOXEL_CHUNK_SIZE + i];
+                    m->is_filled = (solidA != solidB);
+                    if (m->is_filled) {
+                        // face should point toward the solid voxel (front == true => face oriented toward B)
+                        bool front = solidB;
+                        m->is_front = front;
+                        m->face.type = front ? b.type : a.type;
+                        m->face.rotation = front ? b.rotation : a.rotation;
+                    }
+                }
+            }
+
+            // Greedy merge rectangles in the mask
+            for (int32 j = 0; j < VOXEL_CHUNK_SIZE;) {
+                for (int32 i = 0; i < VOXEL_CHUNK_SIZE;) {
+                    const VoxelMaskCell* const cell = &mask[j * VOXEL_CHUNK_SIZE + i];
+                    if (!cell->is_filled) {
+                        ++i;
+                        continue;
+                    }
+
+                    VoxelFace face = cell->face; // copy for comparison
+                    const bool front = cell->is_front;
+
+                    // compute width
+                    int32 width = 1;
+                    while (i + width < VOXEL_CHUNK_SIZE) {
+                        const VoxelMaskCell* const next = &mask[j * VOXEL_CHUNK_SIZE + (i + width)];
+                        if (!next->is_filled || next->is_front != front) break;
+                        if (!voxel_face_equals(&next->face, &face)) break;
+                        ++width;
+                    }
+
+                    // compute height
+                    int32 height = 1;
+                    bool height_done = false;
+                    while (j + height < VOXEL_CHUNK_SIZE && !height_done) {
+                        for (int32 k = 0; k < width; ++k) {
+                            const VoxelMaskCell* const check = &mask[(j + height) * VOXEL_CHUNK_SIZE + (i + k)];
+                            if (!check->is_filled || check->is_front != front || !voxel_face_equals(&check->face, &face)) {
+                                height_done = true;
+                                break;
+                            }
+                        }
+                        if (!height_done) ++height;
+                    }
+
+                    // Build a quad covering [i..i+width-1] x [j..j+height-1] at boundary d
+                    // Determine face normal: axis direction * (+1 or -1).
+                    // If B (d) is solid -> normal points +axis. If A (d-1) is solid -> normal points -axis.
+                    v3_byte normal_int = {0, 0, 0};
+
+                    const int32 normal_sign = front ? 1 : -1;
+                    normal_int.vec[axis] = (byte) normal_sign;
+
+                    // compute the 3 axes vectors for quad positioning in f32:
+                    v3_f32 axisVec = {0.0f, 0.0f, 0.0f};       // offset along axis to the plane
+                    v3_f32 uVec = {0.0f, 0.0f, 0.0f};          // across width (u direction)
+                    v3_f32 vVec = {0.0f, 0.0f, 0.0f};          // across height (v direction)
+
+                    // axisVec: position of the face along axis direction
+                    // The face between the slices d - 1 and d always lies on the plane d, only the winding depends on the normal
+                    axisVec.vec[axis] = (f32) d;
+
+                    // uVec is along u (width), vVec along v (height)
+                    uVec.vec[u] = (f32) width;
+                    vVec.vec[v] = (f32) height;
+
+                    // origin point for quad (lower-left corner in chunk-local coordinates):
+                    // for coordinate mapping: we want the vertex at (u = i, v = j)
+                    v3_f32 origin = base;
+                    origin.vec[u] += (f32) i;
+                    origin.vec[v] += (f32) j;
+                    // origin already accounts for chunk base; add axis position
+                    origin.vec[axis] += axisVec.vec[axis];
+
+                    // We currently don't support growing meshes
+                    if (chunk->mesh.num_vertices + 4 > chunk->mesh.cap_vertices
+                        || chunk->mesh.num_indices + 6 > chunk->mesh.cap_indices
+                    ) {
+                        chunk->flag &= ~VOXEL_CHUNK_FLAG_IS_CHANGED;
+
+                        return;
+                    }
+
+                    // push quad vertices (4 verts). We'll follow a consistent winding based on normal
+                    uint32 vbase = chunk->mesh.num_vertices;
+
+                    // vertex 0: origin
+                    voxel_chunk_vertex_push(chunk, origin, normal_int, &face);
+
+                    // vertex 1: origin + uVec (width direction)
+                    v3_f32 v1 = origin;
+                    v1.vec[u] += uVec.vec[u];
+                    voxel_chunk_vertex_push(chunk, v1, normal_int, &face);
+
+                    // vertex 2: origin + uVec + vVec (width + height)
+                    v3_f32 v2 = v1;
+                    v2.vec[v] += vVec.vec[v];
+                    voxel_chunk_vertex_push(chunk, v2, normal_int, &face);
+
+                    // vertex 3: origin + vVec
+                    v3_f32 v3 = origin;
+                    v3.vec[v] += vVec.vec[v];
+                    voxel_chunk_vertex_push(chunk, v3, normal_int, &face);
+
+                    // Create indices with correct winding: if normal points towards positive axis, winding is 0,1,2,3 otherwise flip
+                    if (normal_sign > 0) {
+                        voxel_chunk_quad_push(chunk, vbase + 0, vbase + 1, vbase + 2, vbase + 3);
+                    } else {
+                        voxel_chunk_quad_push(chunk, vbase + 0, vbase + 3, vbase + 2, vbase + 1);
+                    }
+
+                    // clear mask cells covered by this quad
+                    for (int32 jj = 0; jj < height; ++jj) {
+                        for (int32 ii = 0; ii < width; ++ii) {
+                            mask[(j + jj) * VOXEL_CHUNK_SIZE + (i + ii)].is_filled = false;
+                        }
+                    }
+
+                    // advance i by width
+                    i += width;
+                }
+
+                // Find next j that has any filled cell (skip empty rows)
+                int32 nextj = j + 1;
+                for (; nextj < VOXEL_CHUNK_SIZE; ++nextj) {
+                    bool any = false;
+                    for (int32 ii = 0; ii < VOXEL_CHUNK_SIZE; ++ii) {
+                        if (mask[nextj * VOXEL_CHUNK_SIZE + ii].is_filled) {
+                            any = true;
+                            break;
+                        }
+                    }
+                    if (any) break;
+                }
+
+                j = nextj;
+            }
+        }
+    }
+
+    chunk->flag &= ~VOXEL_CHUNK_FLAG_IS_CHANGED;
+}
+
 #endif
\ No newline at end of file
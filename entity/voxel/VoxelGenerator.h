@@ -0,0 +1,519 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_ENTITY_VOXEL_GENERATOR_H
+#define COMS_ENTITY_VOXEL_GENERATOR_H
+
+#include "../../stdlib/Stdlib.h"
+#include "../../stdlib/GameMathTypes.h"
+#include "../../thread/Atomic.h"
+#include "../../thread/ThreadPool.cpp"
+#include "../../utils/TimeUtils.h"
+
+#include "Voxel.h"
+#include "VoxelTerrain.h"
+#include "VoxelWorldMap.h"
+
+// Streams procedurally generated chunks around the camera into the voxel world
+//
+// Every chunk runs through the stages below, every stage is a separate thread pool job.
+// The main thread re-prioritizes the chunks in every update:
+//      1. Chunks outside of the view distance are canceled (also the ones currently in the pipeline)
+//      2. Finished chunks are uploaded (main thread only)
+//      3. The closest chunks waiting for their next stage are submitted to the thread pool
+// The thread pool queue is FIFO, which is why the prioritization happens by only submitting
+// the closest max_jobs chunks instead of submitting everything at once.
+enum VoxelGeneratorStage : byte {
+    VOXEL_GENERATOR_STAGE_NONE,
+    VOXEL_GENERATOR_STAGE_DENSITY,
+    VOXEL_GENERATOR_STAGE_STRUCTURES,
+    VOXEL_GENERATOR_STAGE_MESH,
+
+    // Runs on the main thread (e.g. GPU upload)
+    VOXEL_GENERATOR_STAGE_UPLOAD,
+};
+
+struct VoxelGenerator;
+
+// Called on the main thread once the chunk is fully generated and meshed
+typedef void (*VoxelGeneratorUploadFunc)(VoxelChunk* chunk, void* data);
+
+struct VoxelGeneratorJob {
+    VoxelGenerator* gen;
+    VoxelChunk* chunk;
+
+    // Element in the DataPool, -1 = the job slot is unused
+    int32 chunk_id;
+
+    // Next stage to run
+    VoxelGeneratorStage stage;
+
+    // Set by the main thread when submitting, reset by the worker when the stage is done
+    // The main thread only touches the chunk if the job is not running
+    atomic_32 int32 is_running;
+
+    // Set by the main thread, the worker skips the stage if set
+    atomic_32 int32 is_canceled;
+
+    int32 solid_count;
+
+    // Distance squared in chunks to the camera chunk
+    int32 dist2;
+};
+
+struct VoxelGeneratorCandidate {
+    int32 dist2;
+
+    // -1 = chunk doesn't exist yet
+    int32 job;
+    v3_int32 coord;
+};
+
+struct VoxelGeneratorStats {
+    // Total amount of uploaded chunks
+    uint32 chunks_generated;
+
+    // Total amount of chunks canceled before they were done
+    uint32 chunks_canceled;
+
+    // Chunks currently in the pipeline
+    int32 chunks_pending;
+};
+
+struct VoxelGenerator {
+    VoxelWorld* world;
+
+    // NULL = all stages run on the calling thread
+    ThreadPool* pool;
+
+    VoxelTerrainSettings settings;
+
+    // Horizontal view distance in chunks
+    int32 view_distance;
+
+    // Vertical range of chunks that get generated
+    int32 chunk_y_min;
+    int32 chunk_y_max;
+
+    // Max thread pool jobs in flight
+    int32 max_jobs;
+
+    // Max uploads per update
+    int32 max_uploads;
+
+    VoxelGeneratorUploadFunc upload;
+    void* upload_data;
+
+    // Chunks in the pipeline
+    int32 job_count;
+    VoxelGeneratorJob* jobs;
+
+    // Used to select the closest max_jobs chunks
+    VoxelGeneratorCandidate* candidates;
+
+    v3_int32 camera_chunk;
+
+    VoxelGeneratorStats stats;
+};
+
+/**
+ * Allocates the job memory from the voxel world memory
+ *
+ * @param job_count Max chunks in the pipeline at the same time (includes the chunks waiting for their next stage)
+ * @param max_jobs  Max thread pool jobs in flight (<= job_count)
+ */
+void voxel_generator_alloc(
+    VoxelGenerator* gen, VoxelWorld* world, ThreadPool* pool,
+    const VoxelTerrainSettings* settings,
+    int32 job_count, int32 max_jobs
+) NO_EXCEPT
+{
+    ASSERT_TRUE(max_jobs <= job_count);
+
+    memset(gen, 0, sizeof(*gen));
+    gen->world = world;
+    gen->pool = pool;
+    gen->settings = *settings;
+    gen->view_distance = 8;
+    gen->chunk_y_min = -1;
+    gen->chunk_y_max = 2;
+    gen->max_jobs = max_jobs;
+    gen->max_uploads = max_jobs;
+
+    gen->job_count = job_count;
+    gen->jobs = (VoxelGeneratorJob *) memory_get(&world->mem, job_count * sizeof(VoxelGeneratorJob), ASSUMED_CACHE_LINE_SIZE);
+    gen->candidates = (VoxelGeneratorCandidate *) memory_get(
+        &world->mem, max_jobs * sizeof(VoxelGeneratorCandidate), sizeof(size_t)
+    );
+
+    for (int32 i = 0; i < job_count; ++i) {
+        gen->jobs[i].gen = gen;
+        gen->jobs[i].chunk_id = -1;
+    }
+}
+
+static inline
+void voxel_generator_stage_run(VoxelGeneratorJob* job) NO_EXCEPT
+{
+    VoxelChunk* const chunk = job->chunk;
+    const VoxelTerrainSettings* const settings = &job->gen->settings;
+
+    switch (job->stage) {
+        case VOXEL_GENERATOR_STAGE_DENSITY: {
+                job->solid_count = voxel_terrain_density(chunk, settings);
+                job->stage = VOXEL_GENERATOR_STAGE_STRUCTURES;
+            } break;
+        case VOXEL_GENERATOR_STAGE_STRUCTURES: {
+                // Structures of the neighboring chunks may reach into air chunks
+                const int32 tree_count = voxel_terrain_structures(chunk, settings);
+
+                if (!job->solid_count && !tree_count) {
+                    chunk->mesh.num_vertices = 0;
+                    chunk->mesh.num_indices = 0;
+                    job->stage = VOXEL_GENERATOR_STAGE_UPLOAD;
+                } else {
+                    job->stage = VOXEL_GENERATOR_STAGE_MESH;
+                }
+            } break;
+        case VOXEL_GENERATOR_STAGE_MESH: {
+                voxel_chunk_mesh_build(chunk);
+                job->stage = VOXEL_GENERATOR_STAGE_UPLOAD;
+            } break;
+        default:
+            UNREACHABLE();
+    }
+}
+
+static
+void thrd_voxel_generator_stage(void* arg) NO_EXCEPT
+{
+    const PoolWorker* worker = (const PoolWorker *) arg;
+    VoxelGeneratorJob* job = (VoxelGeneratorJob *) worker->arg;
+
+    // The chunk left the view distance after submitting the job
+    if (!atomic_get_acquire(&job->is_canceled)) {
+        voxel_generator_stage_run(job);
+    }
+
+    atomic_set_release(&job->is_running, 0);
+}
+
+FORCE_INLINE
+bool voxel_generator_in_range(const VoxelGenerator* gen, const v3_int32& coord) NO_EXCEPT
+{
+    return abs(coord.x - gen->camera_chunk.x) <= gen->view_distance
+        && abs(coord.z - gen->camera_chunk.z) <= gen->view_distance
+        && coord.y >= gen->chunk_y_min && coord.y <= gen->chunk_y_max;
+}
+
+FORCE_INLINE
+int32 voxel_generator_dist2(const VoxelGenerator* gen, const v3_int32& coord) NO_EXCEPT
+{
+    const int32 dx = coord.x - gen->camera_chunk.x;
+    const int32 dy = coord.y - gen->camera_chunk.y;
+    const int32 dz = coord.z - gen->camera_chunk.z;
+
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Only called if the job is not running
+static inline
+void voxel_generator_job_release(VoxelGenerator* gen, VoxelGeneratorJob* job) NO_EXCEPT
+{
+    VoxelWorld* const vw = gen->world;
+
+    voxel_hashmap_remove(&vw->map, job->chunk->coord.x, job->chunk->coord.y, job->chunk->coord.z);
+    chunk_free_element((ChunkMemory *) &vw->chunks, job->chunk_id);
+
+    job->chunk = NULL;
+    job->chunk_id = -1;
+    job->stage = VOXEL_GENERATOR_STAGE_NONE;
+}
+
+// Inserts the candidate sorted by distance, the furthest candidate is dropped if the list is full
+static inline
+void voxel_generator_candidate_insert(
+    VoxelGenerator* gen, int32* count,
+    int32 dist2, int32 job, const v3_int32& coord
+) NO_EXCEPT
+{
+    int32 i = *count;
+    if (i == gen->max_jobs) {
+        if (dist2 >= gen->candidates[i - 1].dist2) {
+            return;
+        }
+
+        --i;
+    } else {
+        ++(*count);
+    }
+
+    for (; i > 0 && gen->candidates[i - 1].dist2 > dist2; --i) {
+        gen->candidates[i] = gen->candidates[i - 1];
+    }
+
+    gen->candidates[i] = {dist2, job, coord};
+}
+
+static inline
+VoxelGeneratorJob* voxel_generator_job_create(VoxelGenerator* gen, const v3_int32& coord) NO_EXCEPT
+{
+    VoxelGeneratorJob* job = NULL;
+    for (int32 i = 0; i < gen->job_count; ++i) {
+        if (gen->jobs[i].chunk_id < 0) {
+            job = &gen->jobs[i];
+            break;
+        }
+    }
+
+    if (!job) {
+        return NULL;
+    }
+
+    VoxelWorld* const vw = gen->world;
+    const int32 chunk_id = pool_reserve(&vw->chunks);
+    if (chunk_id < 0) {
+        return NULL;
+    }
+
+    VoxelChunk* const chunk = (VoxelChunk *) pool_get_element(&vw->chunks, chunk_id);
+    voxel_chunk_init(chunk, coord.x, coord.y, coord.z);
+    chunk->element_count = 1;
+    chunk->flag = VOXEL_CHUNK_FLAG_IS_GENERATING;
+    voxel_hashmap_insert(&vw->map, coord.x, coord.y, coord.z, chunk);
+
+    job->chunk = chunk;
+    job->chunk_id = chunk_id;
+    job->stage = VOXEL_GENERATOR_STAGE_DENSITY;
+    job->is_canceled = 0;
+    job->solid_count = 0;
+
+    return job;
+}
+
+static inline
+void voxel_generator_job_submit(VoxelGenerator* gen, VoxelGeneratorJob* job) NO_EXCEPT
+{
+    if (!gen->pool) {
+        voxel_generator_stage_run(job);
+
+        return;
+    }
+
+    atomic_set_release(&job->is_running, 1);
+
+    const PoolWorker worker = {
+        0, // .id =
+        POOL_WORKER_STATE_WAITING, // .state =
+        true, // .atomic_release =
+        0, // .arg_size =
+        job, // .arg =
+        thrd_voxel_generator_stage, // .func =
+        NULL, // .callback =
+        0, // .mem_size =
+        NULL // .mem =
+    };
+
+    if (!thread_pool_add_work(gen->pool, &worker)) {
+        // Queue is full, we try again in the next update
+        atomic_set_release(&job->is_running, 0);
+    }
+}
+
+/**
+ * Updates the chunk generation based on the camera position
+ *
+ * Must be called from the main thread (e.g. once per frame)
+ *
+ * @return Chunks currently in the pipeline
+ */
+int32 voxel_generator_update(VoxelGenerator* gen, const v3_f32& camera_pos) NO_EXCEPT
+{
+    VoxelWorld* const vw = gen->world;
+
+    gen->camera_chunk = {
+        (int32) floorf(camera_pos.x / VOXEL_CHUNK_SIZE),
+        (int32) floorf(camera_pos.y / VOXEL_CHUNK_SIZE),
+        (int32) floorf(camera_pos.z / VOXEL_CHUNK_SIZE)
+    };
+
+    int32 running_count = 0;
+    int32 upload_count = 0;
+    int32 candidate_count = 0;
+    bool has_free_job = false;
+
+    for (int32 i = 0; i < gen->job_count; ++i) {
+        VoxelGeneratorJob* const job = &gen->jobs[i];
+        if (job->chunk_id < 0) {
+            has_free_job = true;
+            continue;
+        }
+
+        if (!voxel_generator_in_range(gen, job->chunk->coord)) {
+            atomic_set_release(&job->is_canceled, 1);
+        }
+
+        if (atomic_get_acquire(&job->is_running)) {
+            ++running_count;
+            continue;
+        }
+
+        // Either canceled now or while the job was waiting in the queue
+        if (atomic_get_relaxed(&job->is_canceled)) {
+            voxel_generator_job_release(gen, job);
+            ++gen->stats.chunks_canceled;
+            has_free_job = true;
+
+            continue;
+        }
+
+        if (job->stage == VOXEL_GENERATOR_STAGE_UPLOAD) {
+            if (upload_count >= gen->max_uploads) {
+                continue;
+            }
+
+            VoxelChunk* const chunk = job->chunk;
+            if (gen->upload) {
+                gen->upload(chunk, gen->upload_data);
+            }
+
+            // From now on the chunk is handled by the voxel world
+            chunk->flag &= ~VOXEL_CHUNK_FLAG_IS_GENERATING;
+            octnode_insert(&vw->oct_new, chunk, chunk->coord);
+
+            job->chunk = NULL;
+            job->chunk_id = -1;
+            job->stage = VOXEL_GENERATOR_STAGE_NONE;
+
+            ++upload_count;
+            ++gen->stats.chunks_generated;
+            has_free_job = true;
+
+            continue;
+        }
+
+        job->dist2 = voxel_generator_dist2(gen, job->chunk->coord);
+        voxel_generator_candidate_insert(gen, &candidate_count, job->dist2, i, job->chunk->coord);
+    }
+
+    // Find the closest chunks that don't exist yet
+    if (has_free_job) {
+        v3_int32 coord;
+        for (coord.y = gen->chunk_y_min; coord.y <= gen->chunk_y_max; ++coord.y) {
+            for (coord.z = gen->camera_chunk.z - gen->view_distance; coord.z <= gen->camera_chunk.z + gen->view_distance; ++coord.z) {
+                for (coord.x = gen->camera_chunk.x - gen->view_distance; coord.x <= gen->camera_chunk.x + gen->view_distance; ++coord.x) {
+                    const int32 dist2 = voxel_generator_dist2(gen, coord);
+
+                    // Check the distance first, the hash map lookup is more expensive
+                    if (candidate_count == gen->max_jobs && dist2 >= gen->candidates[candidate_count - 1].dist2) {
+                        continue;
+                    }
+
+                    if (voxel_hashmap_get_entry(&vw->map, coord.x, coord.y, coord.z)) {
+                        continue;
+                    }
+
+                    voxel_generator_candidate_insert(gen, &candidate_count, dist2, -1, coord);
+                }
+            }
+        }
+    }
+
+    // Submit the closest chunks
+    const int32 submit_count = OMS_MIN(candidate_count, gen->max_jobs - running_count);
+    for (int32 i = 0; i < submit_count; ++i) {
+        const VoxelGeneratorCandidate* const candidate = &gen->candidates[i];
+
+        VoxelGeneratorJob* const job = candidate->job < 0
+            ? voxel_generator_job_create(gen, candidate->coord)
+            : &gen->jobs[candidate->job];
+
+        // Out of job slots or chunk memory
+        if (!job) {
+            continue;
+        }
+
+        job->dist2 = candidate->dist2;
+        voxel_generator_job_submit(gen, job);
+    }
+
+    int32 pending = 0;
+    for (int32 i = 0; i < gen->job_count; ++i) {
+        pending += gen->jobs[i].chunk_id >= 0;
+    }
+
+    gen->stats.chunks_pending = pending;
+
+    return pending;
+}
+
+/**
+ * Cancels all chunks in the pipeline
+ *
+ * Blocks until all running jobs are done
+ */
+void voxel_generator_free(VoxelGenerator* gen) NO_EXCEPT
+{
+    for (int32 i = 0; i < gen->job_count; ++i) {
+        VoxelGeneratorJob* const job = &gen->jobs[i];
+        if (job->chunk_id < 0) {
+            continue;
+        }
+
+        atomic_set_release(&job->is_canceled, 1);
+        while (atomic_get_acquire(&job->is_running)) {
+            cpu_yield();
+        }
+
+        voxel_generator_job_release(gen, job);
+        ++gen->stats.chunks_canceled;
+    }
+
+    gen->stats.chunks_pending = 0;
+}
+
+struct VoxelGeneratorBenchmarkStats {
+    uint32 chunk_count;
+    uint32 update_count;
+
+    // Wall clock time until all chunks in view distance are generated (microseconds)
+    uint64 time_total;
+
+    f64 chunks_per_second;
+};
+
+/**
+ * Headless benchmark, generates all chunks around a fixed camera position
+ *
+ * The world should be empty and the settings should use a fixed seed, otherwise the results are not comparable
+ */
+void voxel_generator_benchmark(
+    VoxelGenerator* gen,
+    const v3_f32& camera_pos,
+    VoxelGeneratorBenchmarkStats* stats
+) NO_EXCEPT
+{
+    memset(stats, 0, sizeof(*stats));
+
+    const uint32 generated = gen->stats.chunks_generated;
+    const uint64 start = time_mu();
+
+    // The first update always creates work if any chunk is missing
+    while (voxel_generator_update(gen, camera_pos)) {
+        ++stats->update_count;
+    }
+
+    stats->time_total = time_mu() - start;
+    stats->chunk_count = gen->stats.chunks_generated - generated;
+    stats->chunks_per_second = stats->time_total
+        ? (f64) stats->chunk_count * 1000000.0 / (f64) stats->time_total
+        : 0.0;
+}
+
+#endif
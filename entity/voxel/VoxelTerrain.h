@@ -0,0 +1,396 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_ENTITY_VOXEL_TERRAIN_H
+#define COMS_ENTITY_VOXEL_TERRAIN_H
+
+#include "../../stdlib/Stdlib.h"
+#include "../../noise/SimplexNoise.h"
+#include "../../noise/WorleyNoise.h"
+#include "Voxel.h"
+
+// Procedural terrain for voxel chunks
+// Every function only writes into the chunk it is called for and only depends on the world coordinates.
+// This way chunks can be generated in any order and on any thread with identical results.
+
+// The game maps these to the actual voxel types
+enum VoxelTerrainType : uint16 {
+    VOXEL_TERRAIN_TYPE_AIR = 0,
+    VOXEL_TERRAIN_TYPE_STONE,
+    VOXEL_TERRAIN_TYPE_DIRT,
+    VOXEL_TERRAIN_TYPE_GRASS,
+    VOXEL_TERRAIN_TYPE_SAND,
+    VOXEL_TERRAIN_TYPE_SNOW,
+    VOXEL_TERRAIN_TYPE_WOOD,
+    VOXEL_TERRAIN_TYPE_LEAVES,
+};
+
+enum VoxelTerrainBiome : byte {
+    VOXEL_TERRAIN_BIOME_DESERT,
+    VOXEL_TERRAIN_BIOME_PLAINS,
+    VOXEL_TERRAIN_BIOME_FOREST,
+    VOXEL_TERRAIN_BIOME_MOUNTAINS,
+};
+
+struct VoxelTerrainSettings {
+    uint32 seed;
+
+    // Terrain height = base_height + height noise * height_amplitude * biome scale
+    int32 base_height;
+    f32 height_amplitude;
+
+    // Frequency in 1/voxel
+    NoiseFractal height_fractal;
+    f32 biome_frequency;
+
+    // Voxels above this height are snow in the mountains
+    int32 snow_height;
+
+    // Voxels with a cave noise > cave_threshold are carved out
+    f32 cave_frequency;
+    f32 cave_threshold;
+
+    // Chance of a tree per tree cell in a forest
+    f32 tree_density;
+};
+
+struct VoxelTerrainColumn {
+    int32 height;
+    VoxelTerrainBiome biome;
+};
+
+// Trees are anchored in cells of VOXEL_TERRAIN_TREE_CELL x VOXEL_TERRAIN_TREE_CELL voxels (at most one tree per cell)
+#define VOXEL_TERRAIN_TREE_CELL 8
+#define VOXEL_TERRAIN_TREE_RADIUS 2
+#define VOXEL_TERRAIN_TREE_HEIGHT_MIN 4
+#define VOXEL_TERRAIN_TREE_HEIGHT_MAX 7
+
+// Soil thickness above the stone
+#define VOXEL_TERRAIN_SOIL_DEPTH 3
+
+inline
+void voxel_terrain_settings_default(VoxelTerrainSettings* settings, uint32 seed) NO_EXCEPT
+{
+    settings->seed = seed;
+    settings->base_height = 32;
+    settings->height_amplitude = 24.0f;
+    settings->height_fractal = {4, 1.0f / 128.0f, 2.0f, 0.5f};
+    settings->biome_frequency = 1.0f / 512.0f;
+    settings->snow_height = 56;
+    settings->cave_frequency = 1.0f / 24.0f;
+    settings->cave_threshold = 0.55f;
+    settings->tree_density = 0.6f;
+}
+
+// Every noise gets a different integer offset based on the seed
+// Integer offsets keep the sample positions exact in f32, which is required for voxel_terrain_column() to
+// return exactly the same values as the chunk generation
+static inline
+v2_int32 voxel_terrain_noise_offset(uint32 seed, int32 layer) NO_EXCEPT
+{
+    const uint32 h = worley_noise_hash_2d(layer, 0, seed);
+
+    return {(int32) (h & 0x3FFF) - 0x2000, (int32) (h >> 18) - 0x2000};
+}
+
+// Height scale of the terrain based on the biome noise
+// Continuous, otherwise we would get cliffs at the biome borders
+FORCE_INLINE
+f32 voxel_terrain_height_scale(f32 biome_noise) NO_EXCEPT
+{
+    const f32 t = (biome_noise + 1.0f) * 0.5f;
+
+    return 0.25f + 1.75f * t * t;
+}
+
+FORCE_INLINE
+VoxelTerrainBiome voxel_terrain_biome(f32 biome_noise) NO_EXCEPT
+{
+    if (biome_noise < -0.35f) {
+        return VOXEL_TERRAIN_BIOME_DESERT;
+    } else if (biome_noise < 0.0f) {
+        return VOXEL_TERRAIN_BIOME_PLAINS;
+    } else if (biome_noise < 0.4f) {
+        return VOXEL_TERRAIN_BIOME_FOREST;
+    }
+
+    return VOXEL_TERRAIN_BIOME_MOUNTAINS;
+}
+
+FORCE_INLINE
+int32 voxel_terrain_height(const VoxelTerrainSettings* settings, f32 height_noise, f32 biome_noise) NO_EXCEPT
+{
+    return settings->base_height
+        + (int32) floorf(height_noise * settings->height_amplitude * voxel_terrain_height_scale(biome_noise));
+}
+
+/**
+ * Samples the height and biome of a width x height area
+ *
+ * Fills heights[z * width + x] and biomes[z * width + x] for the world column (world_x + x, world_z + z)
+ * The noise positions are integers and the step is 1 (the frequency is applied in the noise)
+ * -> a single column results in exactly the same values as a larger area
+ */
+void voxel_terrain_columns(
+    const VoxelTerrainSettings* settings,
+    int32 world_x, int32 world_z, int32 width, int32 height,
+    int32* __restrict heights, VoxelTerrainBiome* __restrict biomes,
+    f32* __restrict scratch // 2 * width * height
+) NO_EXCEPT
+{
+    f32* height_noise = scratch;
+    f32* biome_noise = scratch + width * height;
+
+    const v2_int32 height_offset = voxel_terrain_noise_offset(settings->seed, 0);
+    simplex_noise_2d_grid(
+        height_noise, width, height,
+        (f32) (world_x + height_offset.x), (f32) (world_z + height_offset.y), 1.0f,
+        &settings->height_fractal
+    );
+
+    const v2_int32 biome_offset = voxel_terrain_noise_offset(settings->seed, 1);
+    const NoiseFractal biome_fractal = {1, settings->biome_frequency, 2.0f, 0.5f};
+    simplex_noise_2d_grid(
+        biome_noise, width, height,
+        (f32) (world_x + biome_offset.x), (f32) (world_z + biome_offset.y), 1.0f,
+        &biome_fractal
+    );
+
+    for (int32 i = 0; i < width * height; ++i) {
+        heights[i] = voxel_terrain_height(settings, height_noise[i], biome_noise[i]);
+        biomes[i] = voxel_terrain_biome(biome_noise[i]);
+    }
+}
+
+inline
+VoxelTerrainColumn voxel_terrain_column(const VoxelTerrainSettings* settings, int32 world_x, int32 world_z) NO_EXCEPT
+{
+    VoxelTerrainColumn column;
+    f32 scratch[2];
+    voxel_terrain_columns(settings, world_x, world_z, 1, 1, &column.height, &column.biome, scratch);
+
+    return column;
+}
+
+static inline
+uint16 voxel_terrain_column_type(
+    const VoxelTerrainSettings* settings, VoxelTerrainBiome biome,
+    int32 world_y, int32 height
+) NO_EXCEPT
+{
+    if (world_y > height) {
+        return VOXEL_TERRAIN_TYPE_AIR;
+    }
+
+    if (biome == VOXEL_TERRAIN_BIOME_DESERT) {
+        return world_y > height - VOXEL_TERRAIN_SOIL_DEPTH ? VOXEL_TERRAIN_TYPE_SAND : VOXEL_TERRAIN_TYPE_STONE;
+    }
+
+    if (biome == VOXEL_TERRAIN_BIOME_MOUNTAINS) {
+        return world_y == height && height >= settings->snow_height ? VOXEL_TERRAIN_TYPE_SNOW : VOXEL_TERRAIN_TYPE_STONE;
+    }
+
+    if (world_y == height) {
+        return VOXEL_TERRAIN_TYPE_GRASS;
+    }
+
+    return world_y > height - VOXEL_TERRAIN_SOIL_DEPTH ? VOXEL_TERRAIN_TYPE_DIRT : VOXEL_TERRAIN_TYPE_STONE;
+}
+
+/**
+ * Density and biome stage: fills all voxels of the chunk with terrain and caves
+ *
+ * @return Number of solid voxels
+ */
+int32 voxel_terrain_density(VoxelChunk* const chunk, const VoxelTerrainSettings* settings) NO_EXCEPT
+{
+    const int32 world_x = chunk->coord.x * VOXEL_CHUNK_SIZE;
+    const int32 world_y = chunk->coord.y * VOXEL_CHUNK_SIZE;
+    const int32 world_z = chunk->coord.z * VOXEL_CHUNK_SIZE;
+
+    int32 heights[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE];
+    VoxelTerrainBiome biomes[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE];
+
+    // Also used for the cave noise of a single z slice (x,y)
+    f32 scratch[2 * VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE];
+
+    voxel_terrain_columns(
+        settings, world_x, world_z, VOXEL_CHUNK_SIZE, VOXEL_CHUNK_SIZE,
+        heights, biomes, scratch
+    );
+
+    int32 max_height = INT32_MIN;
+    for (int32 i = 0; i < VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE; ++i) {
+        max_height = OMS_MAX(max_height, heights[i]);
+    }
+
+    // Completely above the terrain
+    if (world_y > max_height) {
+        memset(chunk->vox, 0, sizeof(chunk->vox));
+
+        return 0;
+    }
+
+    const v2_int32 cave_offset = voxel_terrain_noise_offset(settings->seed, 2);
+    const NoiseFractal cave_fractal = {1, settings->cave_frequency, 2.0f, 0.5f};
+
+    int32 solid_count = 0;
+    for (int32 z = 0; z < VOXEL_CHUNK_SIZE; ++z) {
+        f32* const cave = scratch;
+        simplex_noise_3d_grid(
+            cave, VOXEL_CHUNK_SIZE, VOXEL_CHUNK_SIZE, 1,
+            (f32) (world_x + cave_offset.x), (f32) world_y, (f32) (world_z + z + cave_offset.y), 1.0f,
+            &cave_fractal
+        );
+
+        for (int32 y = 0; y < VOXEL_CHUNK_SIZE; ++y) {
+            Voxel* const row = &chunk->vox[voxel_index_get(0, y, z)];
+
+            for (int32 x = 0; x < VOXEL_CHUNK_SIZE; ++x) {
+                const int32 column = z * VOXEL_CHUNK_SIZE + x;
+                const int32 height = heights[column];
+
+                uint16 type = voxel_terrain_column_type(settings, biomes[column], world_y + y, height);
+
+                // The top layer is never carved, otherwise the structures could float
+                if (type && world_y + y < height && cave[y * VOXEL_CHUNK_SIZE + x] > settings->cave_threshold) {
+                    type = VOXEL_TERRAIN_TYPE_AIR;
+                }
+
+                row[x].type = type;
+                row[x].rotation = 0;
+                solid_count += type != VOXEL_TERRAIN_TYPE_AIR;
+            }
+        }
+    }
+
+    return solid_count;
+}
+
+// Only writes into air (e.g. leaves) or always (e.g. trunk)
+static inline
+void voxel_terrain_structure_set(
+    VoxelChunk* const chunk, const v3_int32& origin,
+    int32 world_x, int32 world_y, int32 world_z,
+    uint16 type, bool only_air
+) NO_EXCEPT
+{
+    const int32 x = world_x - origin.x;
+    const int32 y = world_y - origin.y;
+    const int32 z = world_z - origin.z;
+
+    if ((uint32) x >= (uint32) VOXEL_CHUNK_SIZE
+        || (uint32) y >= (uint32) VOXEL_CHUNK_SIZE
+        || (uint32) z >= (uint32) VOXEL_CHUNK_SIZE
+    ) {
+        return;
+    }
+
+    Voxel* const voxel = &chunk->vox[voxel_index_get(x, y, z)];
+    if (only_air && voxel->type != VOXEL_TERRAIN_TYPE_AIR) {
+        return;
+    }
+
+    voxel->type = type;
+    voxel->rotation = 0;
+}
+
+/**
+ * Structure stage: places the trees overlapping this chunk
+ *
+ * Trees are anchored in tree cells and can reach into the neighboring chunks.
+ * Every chunk evaluates all trees overlapping it (also the ones anchored in other chunks) but only writes into itself.
+ * The trees are always processed in the same global order -> overlapping trees look the same in every chunk.
+ * Requires voxel_terrain_density() to be called first.
+ *
+ * @return Number of trees overlapping the chunk
+ */
+int32 voxel_terrain_structures(VoxelChunk* const chunk, const VoxelTerrainSettings* settings) NO_EXCEPT
+{
+    const v3_int32 origin = {
+        chunk->coord.x * VOXEL_CHUNK_SIZE,
+        chunk->coord.y * VOXEL_CHUNK_SIZE,
+        chunk->coord.z * VOXEL_CHUNK_SIZE
+    };
+
+    const int32 cell_x_start = floor_div(origin.x - VOXEL_TERRAIN_TREE_RADIUS, VOXEL_TERRAIN_TREE_CELL);
+    const int32 cell_z_start = floor_div(origin.z - VOXEL_TERRAIN_TREE_RADIUS, VOXEL_TERRAIN_TREE_CELL);
+    const int32 cell_x_end = floor_div(origin.x + VOXEL_CHUNK_SIZE + VOXEL_TERRAIN_TREE_RADIUS, VOXEL_TERRAIN_TREE_CELL);
+    const int32 cell_z_end = floor_div(origin.z + VOXEL_CHUNK_SIZE + VOXEL_TERRAIN_TREE_RADIUS, VOXEL_TERRAIN_TREE_CELL);
+
+    const uint32 tree_seed = settings->seed ^ 0x5BD1E995;
+    int32 tree_count = 0;
+
+    for (int32 cell_z = cell_z_start; cell_z <= cell_z_end; ++cell_z) {
+        for (int32 cell_x = cell_x_start; cell_x <= cell_x_end; ++cell_x) {
+            const uint32 h = worley_noise_hash_2d(cell_x, cell_z, tree_seed);
+            const f32 chance = (f32) (h & 0xFFFF) * (1.0f / 65536.0f);
+
+            // Cheap rejection before sampling the terrain
+            if (chance >= settings->tree_density) {
+                continue;
+            }
+
+            // Trunks keep a distance of at least 2 voxels to the trunks of the neighboring cells
+            // The canopy may reach into the neighboring cells and chunks
+            const int32 tree_x = cell_x * VOXEL_TERRAIN_TREE_CELL + 1
+                + (int32) ((h >> 16) & 0xFF) % (VOXEL_TERRAIN_TREE_CELL - 2);
+            const int32 tree_z = cell_z * VOXEL_TERRAIN_TREE_CELL + 1
+                + (int32) ((h >> 20) & 0xFF) % (VOXEL_TERRAIN_TREE_CELL - 2);
+            const int32 trunk_height = VOXEL_TERRAIN_TREE_HEIGHT_MIN
+                + (int32) (h >> 28) % (VOXEL_TERRAIN_TREE_HEIGHT_MAX - VOXEL_TERRAIN_TREE_HEIGHT_MIN + 1);
+
+            if (tree_x + VOXEL_TERRAIN_TREE_RADIUS < origin.x || tree_x - VOXEL_TERRAIN_TREE_RADIUS >= origin.x + VOXEL_CHUNK_SIZE
+                || tree_z + VOXEL_TERRAIN_TREE_RADIUS < origin.z || tree_z - VOXEL_TERRAIN_TREE_RADIUS >= origin.z + VOXEL_CHUNK_SIZE
+            ) {
+                continue;
+            }
+
+            const VoxelTerrainColumn column = voxel_terrain_column(settings, tree_x, tree_z);
+
+            // Few trees in the plains, none in the desert and mountains
+            if (column.biome != VOXEL_TERRAIN_BIOME_FOREST
+                && (column.biome != VOXEL_TERRAIN_BIOME_PLAINS || chance >= settings->tree_density * 0.15f)
+            ) {
+                continue;
+            }
+
+            const int32 top = column.height + trunk_height;
+            if (column.height + 1 >= origin.y + VOXEL_CHUNK_SIZE || top + 1 < origin.y) {
+                continue;
+            }
+
+            ++tree_count;
+
+            for (int32 y = column.height + 1; y <= top; ++y) {
+                voxel_terrain_structure_set(chunk, origin, tree_x, y, tree_z, VOXEL_TERRAIN_TYPE_WOOD, false);
+            }
+
+            for (int32 dy = -VOXEL_TERRAIN_TREE_RADIUS; dy <= 1; ++dy) {
+                for (int32 dz = -VOXEL_TERRAIN_TREE_RADIUS; dz <= VOXEL_TERRAIN_TREE_RADIUS; ++dz) {
+                    for (int32 dx = -VOXEL_TERRAIN_TREE_RADIUS; dx <= VOXEL_TERRAIN_TREE_RADIUS; ++dx) {
+                        if (dx * dx + dy * dy + dz * dz > VOXEL_TERRAIN_TREE_RADIUS * VOXEL_TERRAIN_TREE_RADIUS + 1) {
+                            continue;
+                        }
+
+                        voxel_terrain_structure_set(
+                            chunk, origin,
+                            tree_x + dx, top + dy, tree_z + dz,
+                            VOXEL_TERRAIN_TYPE_LEAVES, true
+                        );
+                    }
+                }
+            }
+        }
+    }
+
+    return tree_count;
+}
+
+#endif
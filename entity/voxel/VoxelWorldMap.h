@@ -12,9 +12,10 @@
 
 #include "../../stdlib/Stdlib.h"
 #include "../../stdlib/GameMathTypes.h"
-#include "../../stdlib/HashMap.h"
+#include "../../stdlib/HashMap.cpp"
 #include "../../stdlib/Octree.h"
 #include "../../memory/DataPool.h"
+#include "../../camera/Camera.cpp"
 
 #include "Voxel.h"
 #include "VoxelHashMap.h"
@@ -42,221 +43,12 @@ Voxel voxel_world_map_get(
 
     const VoxelChunk* const chunk = (VoxelChunk *) entry->value;
 
-    return voxel_chunk_get(chunk, x, y, z);
-}
-
-// Builds the greedy mash of a chunk
-// Requires the neighboring chunks
-void voxel_chunk_mesh_build(HashMap* const map, VoxelChunk* const chunk) NO_EXCEPT
-{
-    chunk->mesh.num_vertices = 0;
-    chunk->mesh.num_indices = 0;
-
-    // world base (chunk origin in world coordinates)
-    const v3_f32 base = {
-        (f32) chunk->coord.x * (f32) VOXEL_CHUNK_SIZE,
-        (f32) chunk->coord.y * (f32) VOXEL_CHUNK_SIZE,
-        (f32) chunk->coord.z * (f32) VOXEL_CHUNK_SIZE
-    };
-
-    // @bug This is probably using up all our stack memory once we multithread it
-    VoxelMaskCell mask[VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE];
-
-    // Build quads between solid/air slabs
-    // x,y,z are the axis 0-2
-    for (int32 axis = 0; axis < 3; ++axis) {
-        int32 u = (axis + 1) % 3;
-        int32 v = (axis + 2) % 3;
-
-        v3_int32 du = {0};
-        du.vec[axis] = 1;
-
-        v3_int32 dv = {0};
-        dv.vec[v] = 1;
-
-        v3_int32 duu = {0};
-        duu.vec[u] = 1;
-
-        for (int32 d = -1; d < VOXEL_CHUNK_SIZE; ++d) {
-            // Fill mask with faces between slices d and d + 1 along the axis
-            for (int32 j = 0; j < VOXEL_CHUNK_SIZE; ++j) {
-                for (int32 i = 0; i < VOXEL_CHUNK_SIZE; ++i) {
-                    v3_int32 coordA = {0};
-                    v3_int32 coordB = {0};
-
-                    // set u and v components
-                    coordA.vec[u] = i;
-                    coordA.vec[v] = j;
-                    coordB.vec[u] = i;
-                    coordB.vec[v] = j;
-
-                    coordA.vec[axis] = d - 1;
-                    coordB.vec[axis] = d;
-
-                    Voxel a = {0,0}; // default: air
-                    Voxel b = {0,0};
-                    bool a_valid = (coordA.vec[axis] >= 0 && coordA.vec[axis] < VOXEL_CHUNK_SIZE);
-                    bool b_valid = (coordB.vec[axis] >= 0 && coordB.vec[axis] < VOXEL_CHUNK_SIZE);
-
-                    if (a_valid) {
-                        a = voxel_world_map_get(map, chunk->coord, coordA.x, coordA.y, coordA.z);
-                    }
-                    if (b_valid) {
-                        b = voxel_world_map_get(map, chunk->coord, coordB.x, coordB.y, coordB.z);
-                    }
-
-                    bool solidA = voxel_is_solid(a.type);
-                    bool solidB = voxel_is_solid(b.type);
-
-                    VoxelMaskCell* m = &mask[j * VOXEL_CHUNK_SIZE + i];
-                    m->is_filled = (solidA != solidB);
-                    if (m->is_filled) {
-                        // face should point toward the solid voxel (front == true => face oriented toward B)
-                        bool front = solidB;
-                        m->face.type = front ? b.type : a.type;
-                        m->face.rotation = front ? b.rotation : a.rotation;
-                    } else {
-                        // Clear face contents to avoid accidental memcmp matches
-                        // @performance we can maybe optimize the size of face through padding and then do:
-                        // MEMSET_ZERO_32(&m->face)
-                        memset(&m->face, 0, sizeof(m->face));
-                    }
-                }
-            }
-
-            // Greedy merge rectangles in the mask
-            for (int32 j = 0; j < VOXEL_CHUNK_SIZE;) {
-                for (int32 i = 0; i < VOXEL_CHUNK_SIZE;) {
-                    const VoxelMaskCell* const cell = &mask[j * VOXEL_CHUNK_SIZE + i];
-                    if (!cell->is_filled) {
-                        ++i;
-                        continue;
-                    }
-
-                    VoxelFace face = cell->face; // copy for comparison
-
-                    // compute width
-                    int32 width = 1;
-                    while (i + width < VOXEL_CHUNK_SIZE) {
-                        const VoxelMaskCell* const next = &mask[j * VOXEL_CHUNK_SIZE + (i + width)];
-                        if (!next->is_filled) break;
-                        if (memcmp(&next->face, &face, sizeof(VoxelFace)) != 0) break;
-                        ++width;
-                    }
-
-                    // compute height
-                    int32 height = 1;
-                    bool height_done = false;
-                    while (j + height < VOXEL_CHUNK_SIZE && !height_done) {
-                        for (int32 k = 0; k < width; ++k) {
-                            const VoxelMaskCell* const check = &mask[(j + height) * VOXEL_CHUNK_SIZE + (i + k)];
-                            if (!check->is_filled || memcmp(&check->face, &face, sizeof(VoxelFace)) != 0) {
-                                height_done = true;
-                                break;
-                            }
-                        }
-                        if (!height_done) ++height;
-                    }
-
-                    // Build a quad covering [i..i+width-1] x [j..j+height-1] at boundary d
-                    // Determine face normal: axis direction * (+1 or -1).
-                    // If B (d) is solid -> normal points +axis. If A (d-1) is solid -> normal points -axis.
-                    v3_byte normal_int = {0};
-
-                    bool front = false;
-                    if (d >= 0) {
-                        v3_int32 coordB = {0};
-                        coordB.vec[u] = i;
-                        coordB.vec[v] = j;
-                        coordB.vec[axis] = d;
-
-                        Voxel b = voxel_world_map_get(map, chunk->coord, coordB.x, coordB.y, coordB.z);
-                        front = voxel_is_solid(b.type);
-                    }
-
-                    byte normal_sign = front ? 1 : -1;
-                    normal_int.vec[axis] = normal_sign;
-
-                    // compute the 3 axes vectors for quad positioning in f32:
-                    v3_f32 axisVec = {0.0f, 0.0f, 0.0f};       // offset along axis to the plane
-                    v3_f32 uVec = {0.0f, 0.0f, 0.0f};          // across width (u direction)
-                    v3_f32 vVec = {0.0f, 0.0f, 0.0f};          // across height (v direction)
-
-                    // axisVec: position of the face along axis direction:
-                    // if normal points +axis, face lies at d (the B side), else at d-1 (A side)
-                    f32 planePos = (f32)( (normal_sign > 0) ? d : (d - 1) );
-                    axisVec.vec[axis] = planePos;
-
-                    // uVec is along u (width), vVec along v (height)
-                    uVec.vec[u] = (f32) width;
-                    vVec.vec[v] = (f32) height;
-
-                    // origin point for quad (lower-left corner in chunk-local coordinates):
-                    // for coordinate mapping: we want the vertex at (u = i, v = j)
-                    v3_f32 origin = base;
-                    origin.vec[u] += (f32) i;
-                    origin.vec[v] += (f32) j;
-                    // origin already accounts for chunk base; add axis position
-                    origin.vec[axis] += axisVec.vec[axis];
-
-                    // push quad vertices (4 verts). We'll follow a consistent winding based on normal
-                    uint32 vbase = chunk->mesh.num_vertices;
-
-                    // vertex 0: origin
-                    voxel_chunk_vertex_push(chunk, origin, normal_int, &face);
-
-                    // vertex 1: origin + uVec (width direction)
-                    v3_f32 v1 = origin;
-                    v1.vec[u] += uVec.vec[u];
-                    voxel_chunk_vertex_push(chunk, v1, normal_int, &face);
-
-                    // vertex 2: origin + uVec + vVec (width + height)
-                    v3_f32 v2 = v1;
-                    v2.vec[v] += vVec.vec[v];
-                    voxel_chunk_vertex_push(chunk, v2, normal_int, &face);
-
-                    // vertex 3: origin + vVec
-                    v3_f32 v3 = origin;
-                    v3.vec[v] += vVec.vec[v];
-                    voxel_chunk_vertex_push(chunk, v3, normal_int, &face);
-
-                    // Create indices with correct winding: if normal points towards positive axis, winding is 0,1,2,3 otherwise flip
-                    if (normal_sign > 0) {
-                        voxel_chunk_quad_push(chunk, vbase + 0, vbase + 1, vbase + 2, vbase + 3);
-                    } else {
-                        voxel_chunk_quad_push(chunk, vbase + 0, vbase + 3, vbase + 2, vbase + 1);
-                    }
-
-                    // clear mask cells covered by this quad
-                    for (int32 jj = 0; jj < height; ++jj) {
-                        for (int32 ii = 0; ii < width; ++ii) {
-                            mask[(j + jj) * VOXEL_CHUNK_SIZE + (i + ii)].is_filled = false;
-                        }
-                    }
-
-                    // advance i by width
-                    i += width;
-                }
-
-                // Find next j that has any filled cell (skip empty rows)
-                int32 nextj = j + 1;
-                for (; nextj < VOXEL_CHUNK_SIZE; ++nextj) {
-                    bool any = false;
-                    for (int32 ii = 0; ii < VOXEL_CHUNK_SIZE; ++ii) {
-                        if (mask[nextj * VOXEL_CHUNK_SIZE + ii].is_filled) {
-                            any = true;
-                            break;
-                        }
-                    }
-                    if (any) break;
-                }
-
-                j = nextj;
-            }
-        }
+    // Still written by the generator, the voxels are not valid yet
+    if (chunk->flag & VOXEL_CHUNK_FLAG_IS_GENERATING) {
+        return {0, 0};
     }
 
-    chunk->flag &= ~VOXEL_CHUNK_FLAG_IS_CHANGED;
+    return voxel_chunk_get(chunk, x, y, z);
 }
 
 struct VoxelDrawChunk {
@@ -365,6 +157,11 @@ void voxel_world_update_pos(VoxelWorld* const vw, const v3_int32& pos) NO_EXCEPT
         HashEntry* entry = (HashEntry *) chunk_get_element(&vw->map.buf, chunk_id);
         VoxelChunk* chunk = (VoxelChunk *) entry->value;
 
+        // The generator adds the chunk to the octree once it is done
+        if (chunk->flag & VOXEL_CHUNK_FLAG_IS_GENERATING) {
+            chunk_iterate_continue_n(chunk->element_count);
+        }
+
         // Don't add chunks to be removed or outside of our bounding box
         if (aabb_overlap(vw->oct_new.root->bounds, chunk->bounds)) {
             // @question Do we really want to do this? We might want to keep a chunk recently out of bounding box
@@ -374,7 +171,7 @@ void voxel_world_update_pos(VoxelWorld* const vw, const v3_int32& pos) NO_EXCEPT
         }
 
         if (chunk->flag & VOXEL_CHUNK_FLAG_IS_CHANGED) {
-            voxel_chunk_mesh_build(&vw->map, chunk);
+            voxel_chunk_mesh_build(chunk);
             chunk->flag &= ~VOXEL_CHUNK_FLAG_IS_CHANGED;
         }
 
@@ -404,6 +201,11 @@ void voxel_world_chunk_update(VoxelWorld* vw) NO_EXCEPT
     chunk_iterate_start(&vw->chunks, chunk_id) {
         VoxelChunk* chunk = (VoxelChunk *) chunk_get_element((ChunkMemory *) &vw->chunks, chunk_id);
 
+        // The generator owns the chunk until it is done (including the removal)
+        if (chunk->flag & VOXEL_CHUNK_FLAG_IS_GENERATING) {
+            chunk_iterate_continue_n(chunk->element_count);
+        }
+
         if ((chunk->flag & VOXEL_CHUNK_FLAG_SHOULD_REMOVE)
             || (chunk->flag & VOXEL_CHUNK_FLAG_IS_INACTIVE)
         ) {
@@ -430,7 +232,7 @@ void voxel_world_chunk_update(VoxelWorld* vw) NO_EXCEPT
 
         if (chunk->flag & VOXEL_CHUNK_FLAG_IS_CHANGED) {
             // Rebuild mesh
-            voxel_chunk_mesh_build(&vw->map, chunk);
+            voxel_chunk_mesh_build(chunk);
             chunk->flag &= ~VOXEL_CHUNK_FLAG_IS_CHANGED;
         }
 
@@ -539,19 +539,21 @@ v3_int32 vertex_text_create(
     PROFILE_DEBUG(PROFILE_VERTEX_TEXT_CREATE);
     PSEUDO_USE(rgba);
 
-    int32 length;
-    if (!text || (length = utf8_strlen(text)) < 1) {
+    size_t text_length;
+    if (!text || (text_length = strlen(text)) < 1) {
         return {};
     }
 
-    const bool is_ascii = (int32) strlen(text) == length;
+    // Transcoding all characters at once avoids decoding the text from the start for every character
+    uint32* const codepoints = (uint32 *) memory_get(mem, text_length * sizeof(uint32), alignof(uintptr_t));
+    const int32 length = utf8_to_utf32(text, text_length, codepoints);
 
     // Try to find all the necessary glyphs
     // We use offsets instead of pointer chasing
     // 0x7FFF = offset, 0x8000 = either base (= 0) or extended (= 1)
     int16* const glyphs = (int16*) memory_get(mem, length * sizeof(int16), alignof(uintptr_t));
     for (int32 i = 0; i < length; ++i) {
-        const int32 character = is_ascii ? text[i] : utf8_get_char_at(text, i);
+        const int32 character = (int32) codepoints[i];
 
         // @question Do I even want to handle this in a special way?
         //          This is no longer required if we force \n to be part of the glyph file
@@ -0,0 +1,1075 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_GPUAPI_SHADER_REFLECTION_H
+#define COMS_GPUAPI_SHADER_REFLECTION_H
+
+#include "../stdlib/Stdlib.h"
+#include "../log/Log.h"
+#include "../utils/StringUtils.h"
+#include "ShaderType.h"
+
+// Offline GLSL reflection (asset builder), no gpu api is required
+//
+// Extracts the uniforms, samplers, uniform/storage blocks and vertex attributes of the shader stages of a pipeline.
+// Declarations without explicit location/binding get one assigned,
+// shader_reflection_patch() writes these assignments as layout qualifiers back into the shader source.
+// This way the locations are known before the shader is compiled and the pipeline creation doesn't need any name lookups.
+//
+// Usage:
+//      shader_reflection_parse(&reflection, vertex_source, SHADER_TYPE_VERTEX)
+//      shader_reflection_parse(&reflection, fragment_source, SHADER_TYPE_FRAGMENT)
+//      shader_reflection_finalize(&reflection)
+//      shader_reflection_patch(&reflection, vertex_source, output)     for every stage
+//      shader_reflection_to_data() or shader_reflection_to_header()
+//
+// Only top level declarations are reflected, block members and struct uniforms are not.
+// The patched shaders require GLSL 4.30 (explicit uniform locations), the version is raised if necessary.
+
+#define SHADER_REFLECTION_NAME_LENGTH 32
+#define SHADER_REFLECTION_MAX_VARIABLES 32
+#define SHADER_REFLECTION_DATA_VERSION 1
+
+// Min. version that supports layout(location) for uniforms and layout(binding) for samplers and blocks
+#define SHADER_REFLECTION_PATCH_VERSION 430
+
+enum ShaderReflectionKind : byte {
+    SHADER_REFLECTION_KIND_UNIFORM,
+    SHADER_REFLECTION_KIND_SAMPLER,
+    SHADER_REFLECTION_KIND_UNIFORM_BLOCK,
+    SHADER_REFLECTION_KIND_STORAGE_BLOCK,
+    SHADER_REFLECTION_KIND_ATTRIBUTE,
+};
+
+enum ShaderReflectionType : byte {
+    SHADER_REFLECTION_TYPE_UNKNOWN,
+    SHADER_REFLECTION_TYPE_BOOL,
+    SHADER_REFLECTION_TYPE_INT,
+    SHADER_REFLECTION_TYPE_UINT,
+    SHADER_REFLECTION_TYPE_FLOAT,
+    SHADER_REFLECTION_TYPE_DOUBLE,
+    SHADER_REFLECTION_TYPE_VEC2,
+    SHADER_REFLECTION_TYPE_VEC3,
+    SHADER_REFLECTION_TYPE_VEC4,
+    SHADER_REFLECTION_TYPE_IVEC2,
+    SHADER_REFLECTION_TYPE_IVEC3,
+    SHADER_REFLECTION_TYPE_IVEC4,
+    SHADER_REFLECTION_TYPE_UVEC2,
+    SHADER_REFLECTION_TYPE_UVEC3,
+    SHADER_REFLECTION_TYPE_UVEC4,
+    SHADER_REFLECTION_TYPE_BVEC2,
+    SHADER_REFLECTION_TYPE_BVEC3,
+    SHADER_REFLECTION_TYPE_BVEC4,
+    SHADER_REFLECTION_TYPE_MAT2,
+    SHADER_REFLECTION_TYPE_MAT3,
+    SHADER_REFLECTION_TYPE_MAT4,
+    SHADER_REFLECTION_TYPE_SAMPLER_2D,
+    SHADER_REFLECTION_TYPE_SAMPLER_3D,
+    SHADER_REFLECTION_TYPE_SAMPLER_CUBE,
+    SHADER_REFLECTION_TYPE_SAMPLER_2D_ARRAY,
+    SHADER_REFLECTION_TYPE_SAMPLER_2D_SHADOW,
+    SHADER_REFLECTION_TYPE_SAMPLER_BUFFER,
+    SHADER_REFLECTION_TYPE_SAMPLER_OTHER,
+    SHADER_REFLECTION_TYPE_IMAGE,
+    SHADER_REFLECTION_TYPE_BLOCK,
+};
+
+enum ShaderReflectionFlag : uint16 {
+    SHADER_REFLECTION_FLAG_EXPLICIT_LOCATION = 1 << 0,
+    SHADER_REFLECTION_FLAG_EXPLICIT_BINDING = 1 << 1,
+
+    // The declaration can't be patched (e.g. "uniform float a, b;"), the location must be queried at runtime
+    SHADER_REFLECTION_FLAG_NO_PATCH = 1 << 2,
+};
+
+struct ShaderReflectionVariable {
+    char name[SHADER_REFLECTION_NAME_LENGTH];
+    ShaderReflectionKind kind;
+    ShaderReflectionType type;
+    uint16 array_size;
+
+    // Uniform/attribute location, -1 = unknown (blocks don't have a location)
+    int16 location;
+
+    // Texture unit or block binding, -1 = none
+    int16 binding;
+
+    // Bit field of ShaderType
+    uint16 stages;
+    uint16 flags;
+};
+
+struct ShaderReflection {
+    int32 glsl_version;
+
+    int32 count;
+    ShaderReflectionVariable variables[SHADER_REFLECTION_MAX_VARIABLES];
+};
+
+struct ShaderReflectionTypeInfo {
+    const char* name;
+    ShaderReflectionType type;
+
+    // Vertex attribute locations used by one element
+    byte attribute_locations;
+};
+
+static const ShaderReflectionTypeInfo SHADER_REFLECTION_TYPES[] = {
+    {"bool", SHADER_REFLECTION_TYPE_BOOL, 1},
+    {"int", SHADER_REFLECTION_TYPE_INT, 1},
+    {"uint", SHADER_REFLECTION_TYPE_UINT, 1},
+    {"float", SHADER_REFLECTION_TYPE_FLOAT, 1},
+    {"double", SHADER_REFLECTION_TYPE_DOUBLE, 1},
+    {"vec2", SHADER_REFLECTION_TYPE_VEC2, 1},
+    {"vec3", SHADER_REFLECTION_TYPE_VEC3, 1},
+    {"vec4", SHADER_REFLECTION_TYPE_VEC4, 1},
+    {"ivec2", SHADER_REFLECTION_TYPE_IVEC2, 1},
+    {"ivec3", SHADER_REFLECTION_TYPE_IVEC3, 1},
+    {"ivec4", SHADER_REFLECTION_TYPE_IVEC4, 1},
+    {"uvec2", SHADER_REFLECTION_TYPE_UVEC2, 1},
+    {"uvec3", SHADER_REFLECTION_TYPE_UVEC3, 1},
+    {"uvec4", SHADER_REFLECTION_TYPE_UVEC4, 1},
+    {"bvec2", SHADER_REFLECTION_TYPE_BVEC2, 1},
+    {"bvec3", SHADER_REFLECTION_TYPE_BVEC3, 1},
+    {"bvec4", SHADER_REFLECTION_TYPE_BVEC4, 1},
+    {"mat2", SHADER_REFLECTION_TYPE_MAT2, 2},
+    {"mat3", SHADER_REFLECTION_TYPE_MAT3, 3},
+    {"mat4", SHADER_REFLECTION_TYPE_MAT4, 4},
+    {"sampler2D", SHADER_REFLECTION_TYPE_SAMPLER_2D, 0},
+    {"sampler3D", SHADER_REFLECTION_TYPE_SAMPLER_3D, 0},
+    {"samplerCube", SHADER_REFLECTION_TYPE_SAMPLER_CUBE, 0},
+    {"sampler2DArray", SHADER_REFLECTION_TYPE_SAMPLER_2D_ARRAY, 0},
+    {"sampler2DShadow", SHADER_REFLECTION_TYPE_SAMPLER_2D_SHADOW, 0},
+    {"samplerBuffer", SHADER_REFLECTION_TYPE_SAMPLER_BUFFER, 0},
+};
+
+// Qualifiers that don't change the reflection
+static const char* const SHADER_REFLECTION_QUALIFIERS[] = {
+    "const", "highp", "mediump", "lowp", "flat", "smooth", "noperspective", "centroid", "sample", "patch",
+    "invariant", "precise", "readonly", "writeonly", "coherent", "volatile", "restrict",
+};
+
+struct ShaderReflectionToken {
+    const char* start;
+    int32 length;
+};
+
+FORCE_INLINE
+bool shader_reflection_is_identifier(char c) NO_EXCEPT
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+FORCE_INLINE
+bool shader_reflection_token_is(const ShaderReflectionToken* token, const char* str) NO_EXCEPT
+{
+    return strncmp(token->start, str, token->length) == 0 && str[token->length] == '\0';
+}
+
+// Skips whitespaces and comments
+static
+const char* shader_reflection_skip(const char* pos) NO_EXCEPT
+{
+    while (*pos) {
+        if (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r') {
+            ++pos;
+        } else if (pos[0] == '/' && pos[1] == '/') {
+            while (*pos && *pos != '\n') {
+                ++pos;
+            }
+        } else if (pos[0] == '/' && pos[1] == '*') {
+            pos += 2;
+            while (*pos && !(pos[0] == '*' && pos[1] == '/')) {
+                ++pos;
+            }
+
+            if (*pos) {
+                pos += 2;
+            }
+        } else {
+            break;
+        }
+    }
+
+    return pos;
+}
+
+// Identifiers and numbers are one token, everything else is a single character token
+static
+const char* shader_reflection_next(const char* pos, ShaderReflectionToken* token) NO_EXCEPT
+{
+    pos = shader_reflection_skip(pos);
+    token->start = pos;
+
+    if (shader_reflection_is_identifier(*pos)) {
+        while (shader_reflection_is_identifier(*pos)) {
+            ++pos;
+        }
+    } else if (*pos) {
+        ++pos;
+    }
+
+    token->length = (int32) (pos - token->start);
+
+    return pos;
+}
+
+// Skips to the end of the current statement (; at the current brace level)
+static
+const char* shader_reflection_skip_statement(const char* pos) NO_EXCEPT
+{
+    int32 depth = 0;
+    ShaderReflectionToken token;
+
+    while (*pos) {
+        pos = shader_reflection_next(pos, &token);
+        if (*token.start == '{') {
+            ++depth;
+        } else if (*token.start == '}') {
+            --depth;
+        } else if (*token.start == ';' && depth <= 0) {
+            break;
+        }
+    }
+
+    return pos;
+}
+
+static
+const ShaderReflectionTypeInfo* shader_reflection_type_info(const ShaderReflectionToken* token) NO_EXCEPT
+{
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(SHADER_REFLECTION_TYPES); ++i) {
+        if (shader_reflection_token_is(token, SHADER_REFLECTION_TYPES[i].name)) {
+            return &SHADER_REFLECTION_TYPES[i];
+        }
+    }
+
+    return NULL;
+}
+
+// All remaining opaque types (e.g. isampler2D, image2D)
+static
+ShaderReflectionType shader_reflection_opaque_type(const ShaderReflectionToken* token) NO_EXCEPT
+{
+    const char* name = token->start;
+    int32 length = token->length;
+
+    if (length > 1 && (*name == 'i' || *name == 'u')) {
+        ++name;
+        --length;
+    }
+
+    if (length > 7 && strncmp(name, "sampler", 7) == 0) {
+        return SHADER_REFLECTION_TYPE_SAMPLER_OTHER;
+    }
+
+    if (length > 5 && strncmp(name, "image", 5) == 0) {
+        return SHADER_REFLECTION_TYPE_IMAGE;
+    }
+
+    return SHADER_REFLECTION_TYPE_UNKNOWN;
+}
+
+FORCE_INLINE
+bool shader_reflection_is_opaque(ShaderReflectionType type) NO_EXCEPT
+{
+    return type >= SHADER_REFLECTION_TYPE_SAMPLER_2D && type <= SHADER_REFLECTION_TYPE_IMAGE;
+}
+
+inline
+ShaderReflectionVariable* shader_reflection_find(
+    ShaderReflection* reflection,
+    const char* name,
+    ShaderReflectionKind kind
+) NO_EXCEPT
+{
+    for (int32 i = 0; i < reflection->count; ++i) {
+        ShaderReflectionVariable* var = &reflection->variables[i];
+        if (var->kind == kind && strcmp(var->name, name) == 0) {
+            return var;
+        }
+    }
+
+    return NULL;
+}
+
+// Location/binding of a variable, -1 if not found
+inline
+int32 shader_reflection_location(const ShaderReflection* reflection, const char* name) NO_EXCEPT
+{
+    for (int32 i = 0; i < reflection->count; ++i) {
+        if (strcmp(reflection->variables[i].name, name) == 0) {
+            return reflection->variables[i].location >= 0
+                ? reflection->variables[i].location
+                : reflection->variables[i].binding;
+        }
+    }
+
+    return -1;
+}
+
+// A top level declaration, the positions are needed to patch the source
+struct ShaderReflectionDeclaration {
+    ShaderReflectionKind kind;
+    ShaderReflectionType type;
+    ShaderReflectionToken name;
+    uint16 array_size;
+
+    int16 location;
+    int16 binding;
+    uint16 flags;
+
+    // Start of the declaration
+    const char* start;
+
+    // Position after "layout(", NULL if there is no layout qualifier
+    const char* layout;
+};
+
+// Parses the layout qualifier list, pos is after "layout"
+static
+const char* shader_reflection_parse_layout(const char* pos, ShaderReflectionDeclaration* decl) NO_EXCEPT
+{
+    ShaderReflectionToken token;
+    pos = shader_reflection_next(pos, &token);
+    if (*token.start != '(') {
+        return pos;
+    }
+
+    decl->layout = pos;
+
+    while (*pos) {
+        pos = shader_reflection_next(pos, &token);
+        if (*token.start == ')' || !*token.start) {
+            break;
+        }
+
+        if (!shader_reflection_is_identifier(*token.start)) {
+            continue;
+        }
+
+        const ShaderReflectionToken qualifier = token;
+
+        const char* next = shader_reflection_next(pos, &token);
+        if (*token.start != '=') {
+            continue;
+        }
+
+        pos = shader_reflection_next(next, &token);
+        const int16 value = (int16) str_to_int(token.start);
+
+        if (shader_reflection_token_is(&qualifier, "location")) {
+            decl->location = value;
+            decl->flags |= SHADER_REFLECTION_FLAG_EXPLICIT_LOCATION;
+        } else if (shader_reflection_token_is(&qualifier, "binding")) {
+            decl->binding = value;
+            decl->flags |= SHADER_REFLECTION_FLAG_EXPLICIT_BINDING;
+        }
+    }
+
+    return pos;
+}
+
+// Parses one top level statement
+// @return false if the statement is not a reflected declaration
+static
+bool shader_reflection_parse_declaration(
+    const char** source,
+    ShaderType stage,
+    ShaderReflectionDeclaration* decl
+) NO_EXCEPT
+{
+    const char* pos = shader_reflection_skip(*source);
+
+    memset(decl, 0, sizeof(*decl));
+    decl->start = pos;
+    decl->location = -1;
+    decl->binding = -1;
+    decl->array_size = 1;
+
+    enum { STORAGE_NONE, STORAGE_UNIFORM, STORAGE_BUFFER, STORAGE_IN } storage = STORAGE_NONE;
+
+    ShaderReflectionToken token;
+    while (true) {
+        const char* next = shader_reflection_next(pos, &token);
+
+        if (!*token.start) {
+            *source = next;
+            return false;
+        }
+
+        if (!shader_reflection_is_identifier(*token.start)) {
+            // Functions, statements we don't understand, ...
+            if (*token.start == '{' || *token.start == '(') {
+                // The caller keeps track of the braces
+                *source = pos;
+            } else {
+                *source = *token.start == ';' ? next : shader_reflection_skip_statement(next);
+            }
+
+            return false;
+        }
+
+        pos = next;
+
+        if (shader_reflection_token_is(&token, "layout")) {
+            pos = shader_reflection_parse_layout(pos, decl);
+        } else if (shader_reflection_token_is(&token, "uniform")) {
+            storage = STORAGE_UNIFORM;
+        } else if (shader_reflection_token_is(&token, "buffer")) {
+            storage = STORAGE_BUFFER;
+        } else if (shader_reflection_token_is(&token, "in") || shader_reflection_token_is(&token, "attribute")) {
+            storage = STORAGE_IN;
+        } else if (shader_reflection_token_is(&token, "precision")
+            || shader_reflection_token_is(&token, "struct")
+            || shader_reflection_token_is(&token, "out")
+            || shader_reflection_token_is(&token, "varying")
+        ) {
+            *source = shader_reflection_skip_statement(pos);
+            return false;
+        } else {
+            bool is_qualifier = false;
+            for (int32 i = 0; i < (int32) ARRAY_COUNT(SHADER_REFLECTION_QUALIFIERS); ++i) {
+                if (shader_reflection_token_is(&token, SHADER_REFLECTION_QUALIFIERS[i])) {
+                    is_qualifier = true;
+                    break;
+                }
+            }
+
+            if (!is_qualifier) {
+                // Type
+                break;
+            }
+        }
+    }
+
+    if (storage == STORAGE_NONE || (storage == STORAGE_IN && stage != SHADER_TYPE_VERTEX)) {
+        // Global variable, function, stage input of a later stage, ...
+        // Functions must not be skipped to the next ; since the body would be skipped only partially
+        const char* next = shader_reflection_next(pos, &token);
+        if (shader_reflection_is_identifier(*token.start)) {
+            shader_reflection_next(next, &token);
+            if (*token.start == '(') {
+                *source = next;
+                return false;
+            }
+        }
+
+        *source = shader_reflection_skip_statement(pos);
+        return false;
+    }
+
+    const ShaderReflectionToken type = token;
+
+    pos = shader_reflection_next(pos, &token);
+    if (*token.start == '{') {
+        // Interface block: uniform Name { ... } instance;
+        if (storage == STORAGE_IN) {
+            *source = shader_reflection_skip_statement(pos);
+            return false;
+        }
+
+        decl->kind = storage == STORAGE_UNIFORM ? SHADER_REFLECTION_KIND_UNIFORM_BLOCK : SHADER_REFLECTION_KIND_STORAGE_BLOCK;
+        decl->type = SHADER_REFLECTION_TYPE_BLOCK;
+        decl->name = type;
+
+        int32 depth = 1;
+        while (*pos && depth > 0) {
+            pos = shader_reflection_next(pos, &token);
+            if (*token.start == '{') {
+                ++depth;
+            } else if (*token.start == '}') {
+                --depth;
+            }
+        }
+
+        // Instance arrays
+        const char* end = shader_reflection_skip_statement(pos);
+        const char* bracket = pos;
+        while (bracket < end && *bracket != '[') {
+            ++bracket;
+        }
+
+        if (bracket < end) {
+            decl->array_size = (uint16) OMS_MAX(str_to_int(bracket + 1), (int64) 1);
+        }
+
+        *source = end;
+
+        return true;
+    }
+
+    if (!shader_reflection_is_identifier(*token.start)) {
+        *source = shader_reflection_skip_statement(pos);
+        return false;
+    }
+
+    decl->name = token;
+
+    const ShaderReflectionTypeInfo* info = shader_reflection_type_info(&type);
+    decl->type = info ? info->type : shader_reflection_opaque_type(&type);
+
+    if (storage == STORAGE_IN) {
+        decl->kind = SHADER_REFLECTION_KIND_ATTRIBUTE;
+    } else if (storage == STORAGE_BUFFER) {
+        *source = shader_reflection_skip_statement(pos);
+        return false;
+    } else {
+        decl->kind = shader_reflection_is_opaque(decl->type)
+            ? SHADER_REFLECTION_KIND_SAMPLER
+            : SHADER_REFLECTION_KIND_UNIFORM;
+    }
+
+    pos = shader_reflection_next(pos, &token);
+    if (*token.start == '[') {
+        pos = shader_reflection_next(pos, &token);
+        decl->array_size = (uint16) OMS_MAX(str_to_int(token.start), (int64) 1);
+        pos = shader_reflection_next(pos, &token);
+        pos = shader_reflection_next(pos, &token);
+    }
+
+    if (*token.start != ';') {
+        // e.g. "uniform float a, b;" or an initializer
+        decl->flags |= SHADER_REFLECTION_FLAG_NO_PATCH;
+        pos = shader_reflection_skip_statement(pos);
+    }
+
+    *source = pos;
+
+    return true;
+}
+
+// Called for every reflected top level declaration of a shader source
+typedef void (*ShaderReflectionDeclarationFunc)(const ShaderReflectionDeclaration* decl, void* data);
+
+static
+void shader_reflection_iterate(
+    const char* source,
+    ShaderType stage,
+    ShaderReflectionDeclarationFunc func,
+    void* data,
+    int32* glsl_version
+) NO_EXCEPT
+{
+    const char* pos = source;
+    int32 depth = 0;
+
+    while (*pos) {
+        pos = shader_reflection_skip(pos);
+        if (!*pos) {
+            break;
+        }
+
+        if (*pos == '#') {
+            if (strncmp(pos, "#version", 8) == 0 && glsl_version) {
+                *glsl_version = (int32) str_to_int(shader_reflection_skip(pos + 8));
+            }
+
+            while (*pos && *pos != '\n') {
+                ++pos;
+            }
+
+            continue;
+        }
+
+        if (depth > 0 || *pos == '{' || *pos == '}' || *pos == '(' || *pos == ')') {
+            // Inside of functions (or the parameter list)
+            if (*pos == '{') {
+                ++depth;
+            } else if (*pos == '}') {
+                --depth;
+            }
+
+            ShaderReflectionToken token;
+            pos = shader_reflection_next(pos, &token);
+
+            continue;
+        }
+
+        ShaderReflectionDeclaration decl;
+        if (!shader_reflection_parse_declaration(&pos, stage, &decl)) {
+            continue;
+        }
+
+        func(&decl, data);
+
+        if (!(decl.flags & SHADER_REFLECTION_FLAG_NO_PATCH) || decl.type == SHADER_REFLECTION_TYPE_BLOCK) {
+            continue;
+        }
+
+        // Remaining names of "uniform float a, b[2], c = 1.0;" (commas in initializers are skipped)
+        const char* it = decl.name.start + decl.name.length;
+        int32 nesting = 0;
+        while (it < pos) {
+            ShaderReflectionToken token;
+            it = shader_reflection_next(it, &token);
+
+            if (*token.start == '(' || *token.start == '[') {
+                ++nesting;
+            } else if (*token.start == ')' || *token.start == ']') {
+                --nesting;
+            } else if (*token.start == ',' && nesting == 0) {
+                it = shader_reflection_next(it, &decl.name);
+                if (!shader_reflection_is_identifier(*decl.name.start)) {
+                    break;
+                }
+
+                decl.array_size = 1;
+
+                const char* next = shader_reflection_next(it, &token);
+                if (*token.start == '[') {
+                    next = shader_reflection_next(next, &token);
+                    decl.array_size = (uint16) OMS_MAX(str_to_int(token.start), (int64) 1);
+                    it = shader_reflection_next(next, &token);
+                }
+
+                func(&decl, data);
+            } else if (!*token.start) {
+                break;
+            }
+        }
+    }
+}
+
+struct ShaderReflectionParseData {
+    ShaderReflection* reflection;
+    ShaderType stage;
+};
+
+static
+void shader_reflection_add(const ShaderReflectionDeclaration* decl, void* data) NO_EXCEPT
+{
+    const ShaderReflectionParseData* parse = (const ShaderReflectionParseData *) data;
+    ShaderReflection* reflection = parse->reflection;
+
+    char name[SHADER_REFLECTION_NAME_LENGTH];
+    const int32 length = OMS_MIN(decl->name.length, SHADER_REFLECTION_NAME_LENGTH - 1);
+    memcpy(name, decl->name.start, length);
+    name[length] = '\0';
+
+    ShaderReflectionVariable* var = decl->kind == SHADER_REFLECTION_KIND_ATTRIBUTE
+        ? NULL
+        : shader_reflection_find(reflection, name, decl->kind);
+
+    if (var) {
+        // Same variable in multiple stages, explicit values win
+        if ((decl->flags & SHADER_REFLECTION_FLAG_EXPLICIT_LOCATION)
+            && (var->flags & SHADER_REFLECTION_FLAG_EXPLICIT_LOCATION)
+            && var->location != decl->location
+        ) {
+            LOG_1("[WARNING] Shader reflection: different locations for %s", {DATA_TYPE_CHAR_STR, (void *) name});
+        }
+
+        if (decl->flags & SHADER_REFLECTION_FLAG_EXPLICIT_LOCATION) {
+            var->location = decl->location;
+        }
+
+        if (decl->flags & SHADER_REFLECTION_FLAG_EXPLICIT_BINDING) {
+            var->binding = decl->binding;
+        }
+
+        var->flags |= decl->flags;
+        var->stages |= (uint16) (1 << parse->stage);
+
+        return;
+    }
+
+    if (reflection->count >= SHADER_REFLECTION_MAX_VARIABLES) {
+        LOG_1("[WARNING] Shader reflection: too many variables");
+        return;
+    }
+
+    var = &reflection->variables[reflection->count++];
+    memcpy(var->name, name, length + 1);
+    var->kind = decl->kind;
+    var->type = decl->type;
+    var->array_size = decl->array_size;
+    var->location = (decl->flags & SHADER_REFLECTION_FLAG_EXPLICIT_LOCATION) ? decl->location : -1;
+    var->binding = (decl->flags & SHADER_REFLECTION_FLAG_EXPLICIT_BINDING) ? decl->binding : -1;
+    var->stages = (uint16) (1 << parse->stage);
+    var->flags = decl->flags;
+}
+
+inline
+void shader_reflection_init(ShaderReflection* reflection) NO_EXCEPT
+{
+    memset(reflection, 0, sizeof(*reflection));
+}
+
+// Adds the declarations of a shader stage, call shader_reflection_finalize() after all stages
+void shader_reflection_parse(ShaderReflection* reflection, const char* source, ShaderType stage) NO_EXCEPT
+{
+    ShaderReflectionParseData data = {reflection, stage};
+
+    int32 version = 0;
+    shader_reflection_iterate(source, stage, shader_reflection_add, &data, &version);
+
+    reflection->glsl_version = OMS_MAX(reflection->glsl_version, version);
+}
+
+static
+uint32 shader_reflection_attribute_locations(const ShaderReflectionVariable* var) NO_EXCEPT
+{
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(SHADER_REFLECTION_TYPES); ++i) {
+        if (SHADER_REFLECTION_TYPES[i].type == var->type) {
+            return SHADER_REFLECTION_TYPES[i].attribute_locations * var->array_size;
+        }
+    }
+
+    return var->array_size;
+}
+
+// Finds the first free range of count slots
+static
+int16 shader_reflection_allocate(uint64* used, uint32 count) NO_EXCEPT
+{
+    for (uint32 start = 0; start + count <= 64; ++start) {
+        const uint64 mask = (count >= 64 ? (uint64) -1 : ((1ULL << count) - 1)) << start;
+        if (!(*used & mask)) {
+            *used |= mask;
+            return (int16) start;
+        }
+    }
+
+    LOG_1("[WARNING] Shader reflection: out of locations");
+
+    return -1;
+}
+
+FORCE_INLINE
+void shader_reflection_reserve(uint64* used, int32 start, uint32 count) NO_EXCEPT
+{
+    for (uint32 i = 0; i < count && start + i < 64; ++i) {
+        *used |= 1ULL << (start + i);
+    }
+}
+
+/**
+ * Assigns locations and bindings to all declarations without an explicit one
+ *
+ * Uniforms (incl. samplers) and attributes get locations, samplers and blocks get bindings.
+ * Every kind has its own location/binding space, explicit values are never re-assigned.
+ */
+void shader_reflection_finalize(ShaderReflection* reflection) NO_EXCEPT
+{
+    // Index 0 = uniform locations, 1 = attribute locations, 2 = texture units, 3 = uniform blocks, 4 = storage blocks
+    uint64 used[5] = {};
+
+    for (int32 i = 0; i < reflection->count; ++i) {
+        const ShaderReflectionVariable* var = &reflection->variables[i];
+
+        switch (var->kind) {
+            case SHADER_REFLECTION_KIND_UNIFORM:
+            case SHADER_REFLECTION_KIND_SAMPLER:
+                if (var->location >= 0) {
+                    shader_reflection_reserve(&used[0], var->location, var->array_size);
+                }
+
+                if (var->binding >= 0) {
+                    shader_reflection_reserve(&used[2], var->binding, var->array_size);
+                }
+                break;
+            case SHADER_REFLECTION_KIND_ATTRIBUTE:
+                if (var->location >= 0) {
+                    shader_reflection_reserve(&used[1], var->location, shader_reflection_attribute_locations(var));
+                }
+                break;
+            case SHADER_REFLECTION_KIND_UNIFORM_BLOCK:
+            case SHADER_REFLECTION_KIND_STORAGE_BLOCK:
+                if (var->binding >= 0) {
+                    shader_reflection_reserve(
+                        &used[var->kind == SHADER_REFLECTION_KIND_UNIFORM_BLOCK ? 3 : 4],
+                        var->binding, var->array_size
+                    );
+                }
+                break;
+            default:
+                UNREACHABLE();
+        }
+    }
+
+    for (int32 i = 0; i < reflection->count; ++i) {
+        ShaderReflectionVariable* var = &reflection->variables[i];
+        if (var->flags & SHADER_REFLECTION_FLAG_NO_PATCH) {
+            // Can only be resolved at runtime
+            continue;
+        }
+
+        switch (var->kind) {
+            case SHADER_REFLECTION_KIND_UNIFORM:
+                if (var->location < 0) {
+                    var->location = shader_reflection_allocate(&used[0], var->array_size);
+                }
+                break;
+            case SHADER_REFLECTION_KIND_SAMPLER:
+                if (var->location < 0) {
+                    var->location = shader_reflection_allocate(&used[0], var->array_size);
+                }
+
+                if (var->binding < 0) {
+                    var->binding = shader_reflection_allocate(&used[2], var->array_size);
+                }
+                break;
+            case SHADER_REFLECTION_KIND_ATTRIBUTE:
+                if (var->location < 0) {
+                    var->location = shader_reflection_allocate(&used[1], shader_reflection_attribute_locations(var));
+                }
+                break;
+            case SHADER_REFLECTION_KIND_UNIFORM_BLOCK:
+            case SHADER_REFLECTION_KIND_STORAGE_BLOCK:
+                if (var->binding < 0) {
+                    var->binding = shader_reflection_allocate(
+                        &used[var->kind == SHADER_REFLECTION_KIND_UNIFORM_BLOCK ? 3 : 4],
+                        var->array_size
+                    );
+                }
+                break;
+            default:
+                UNREACHABLE();
+        }
+    }
+}
+
+struct ShaderReflectionPatchData {
+    ShaderReflection* reflection;
+    const char* input;
+    char* output;
+
+    // Input position up to which the input is already copied
+    const char* copied;
+};
+
+static
+void shader_reflection_patch_declaration(const ShaderReflectionDeclaration* decl, void* data) NO_EXCEPT
+{
+    ShaderReflectionPatchData* patch = (ShaderReflectionPatchData *) data;
+    if (decl->flags & SHADER_REFLECTION_FLAG_NO_PATCH) {
+        return;
+    }
+
+    char name[SHADER_REFLECTION_NAME_LENGTH];
+    const int32 length = OMS_MIN(decl->name.length, SHADER_REFLECTION_NAME_LENGTH - 1);
+    memcpy(name, decl->name.start, length);
+    name[length] = '\0';
+
+    const ShaderReflectionVariable* var = shader_reflection_find(patch->reflection, name, decl->kind);
+    if (!var) {
+        return;
+    }
+
+    const bool needs_location = var->location >= 0 && !(decl->flags & SHADER_REFLECTION_FLAG_EXPLICIT_LOCATION);
+    const bool needs_binding = var->binding >= 0 && !(decl->flags & SHADER_REFLECTION_FLAG_EXPLICIT_BINDING);
+    if (!needs_location && !needs_binding) {
+        return;
+    }
+
+    char qualifiers[64];
+    int32 qualifier_length = 0;
+
+    if (needs_location) {
+        qualifier_length += sprintf_fast(qualifiers + qualifier_length, "location = %d", (int32) var->location);
+    }
+
+    if (needs_binding) {
+        qualifier_length += sprintf_fast(
+            qualifiers + qualifier_length,
+            needs_location ? ", binding = %d" : "binding = %d",
+            (int32) var->binding
+        );
+    }
+
+    const char* insert = decl->layout ? decl->layout : decl->start;
+
+    memcpy(patch->output, patch->copied, insert - patch->copied);
+    patch->output += insert - patch->copied;
+    patch->copied = insert;
+
+    patch->output += decl->layout
+        ? sprintf_fast(patch->output, "%s, ", qualifiers)
+        : sprintf_fast(patch->output, "layout(%s) ", qualifiers);
+}
+
+/**
+ * Writes the assigned locations and bindings as layout qualifiers into the shader source
+ *
+ * @param reflection    Finalized reflection
+ * @param input         Shader source of one stage
+ * @param stage         Shader stage
+ * @param output        Patched shader source (strlen(input) + 64 * reflection->count bytes are sufficient)
+ *
+ * @return Length of the output
+ */
+int32 shader_reflection_patch(
+    ShaderReflection* reflection,
+    const char* input,
+    ShaderType stage,
+    char* output
+) NO_EXCEPT
+{
+    ShaderReflectionPatchData data = {reflection, input, output, input};
+
+    // Raise the version if necessary, the rest of the version line (e.g. core) is kept
+    const char* version = strstr(input, "#version");
+    if (version && reflection->glsl_version < SHADER_REFLECTION_PATCH_VERSION) {
+        const char* number = shader_reflection_skip(version + 8);
+        const char* number_end = number;
+        while (*number_end >= '0' && *number_end <= '9') {
+            ++number_end;
+        }
+
+        memcpy(data.output, input, number - input);
+        data.output += number - input;
+        data.output += sprintf_fast(data.output, "%d", SHADER_REFLECTION_PATCH_VERSION);
+        data.copied = number_end;
+    }
+
+    shader_reflection_iterate(input, stage, shader_reflection_patch_declaration, &data, NULL);
+
+    const size_t rest = strlen(data.copied);
+    memcpy(data.output, data.copied, rest + 1);
+    data.output += rest;
+
+    return (int32) (data.output - output);
+}
+
+#define SHADER_REFLECTION_VARIABLE_DATA_SIZE (SHADER_REFLECTION_NAME_LENGTH + 2 * sizeof(byte) + 5 * sizeof(uint16))
+
+FORCE_INLINE
+int32 shader_reflection_data_size(const ShaderReflection* reflection) NO_EXCEPT
+{
+    return (int32) (3 * sizeof(int32) + reflection->count * SHADER_REFLECTION_VARIABLE_DATA_SIZE);
+}
+
+// File layout - binary (little endian)
+//      int32 data version
+//      int32 glsl version
+//      int32 count
+//      Variables: char name[32], byte kind, byte type, uint16 array_size, int16 location, int16 binding,
+//                 uint16 stages, uint16 flags
+int32 shader_reflection_to_data(const ShaderReflection* reflection, byte* data) NO_EXCEPT
+{
+    byte* pos = data;
+    pos = write_le(pos, (int32) SHADER_REFLECTION_DATA_VERSION);
+    pos = write_le(pos, reflection->glsl_version);
+    pos = write_le(pos, reflection->count);
+
+    for (int32 i = 0; i < reflection->count; ++i) {
+        const ShaderReflectionVariable* var = &reflection->variables[i];
+
+        memcpy(pos, var->name, SHADER_REFLECTION_NAME_LENGTH);
+        pos += SHADER_REFLECTION_NAME_LENGTH;
+
+        *pos++ = var->kind;
+        *pos++ = var->type;
+        pos = write_le(pos, var->array_size);
+        pos = write_le(pos, var->location);
+        pos = write_le(pos, var->binding);
+        pos = write_le(pos, var->stages);
+        pos = write_le(pos, var->flags);
+    }
+
+    return (int32) (pos - data);
+}
+
+int32 shader_reflection_from_data(const byte* data, ShaderReflection* reflection) NO_EXCEPT
+{
+    const byte* pos = data;
+
+    int32 version;
+    pos = read_le(pos, &version);
+    if (version != SHADER_REFLECTION_DATA_VERSION) {
+        LOG_1("[WARNING] Invalid shader reflection data");
+        reflection->count = 0;
+
+        return 0;
+    }
+
+    pos = read_le(pos, &reflection->glsl_version);
+    pos = read_le(pos, &reflection->count);
+
+    ASSERT_TRUE(reflection->count <= SHADER_REFLECTION_MAX_VARIABLES);
+    reflection->count = OMS_CLAMP(reflection->count, 0, SHADER_REFLECTION_MAX_VARIABLES);
+
+    for (int32 i = 0; i < reflection->count; ++i) {
+        ShaderReflectionVariable* var = &reflection->variables[i];
+
+        memcpy(var->name, pos, SHADER_REFLECTION_NAME_LENGTH);
+        var->name[SHADER_REFLECTION_NAME_LENGTH - 1] = '\0';
+        pos += SHADER_REFLECTION_NAME_LENGTH;
+
+        var->kind = (ShaderReflectionKind) *pos++;
+        var->type = (ShaderReflectionType) *pos++;
+        pos = read_le(pos, &var->array_size);
+        pos = read_le(pos, &var->location);
+        pos = read_le(pos, &var->binding);
+        pos = read_le(pos, &var->stages);
+        pos = read_le(pos, &var->flags);
+    }
+
+    return (int32) (pos - data);
+}
+
+/**
+ * Creates a C header that contains the reflection as constant (ShaderReflection.h must be included before)
+ *
+ *      static const ShaderReflection <prefix>_reflection = {...};
+ *      #define <PREFIX>_LOCATION_<NAME> / <PREFIX>_BINDING_<NAME>
+ *
+ * @return Length of the header
+ */
+int32 shader_reflection_to_header(const ShaderReflection* reflection, const char* prefix, char* output) NO_EXCEPT
+{
+    char* pos = output;
+
+    char prefix_upper[64];
+    const size_t prefix_length = OMS_MIN(strlen(prefix), sizeof(prefix_upper) - 1);
+    memcpy(prefix_upper, prefix, prefix_length);
+    prefix_upper[prefix_length] = '\0';
+    str_toupper(prefix_upper);
+
+    pos += sprintf_fast(pos, "// Generated by shader_reflection_to_header(), do not modify\n");
+    pos += sprintf_fast(pos, "#pragma once\n#ifndef COMS_SHADER_REFLECTION_%s_H\n#define COMS_SHADER_REFLECTION_%s_H\n\n", prefix_upper, prefix_upper);
+
+    for (int32 i = 0; i < reflection->count; ++i) {
+        const ShaderReflectionVariable* var = &reflection->variables[i];
+
+        char name_upper[SHADER_REFLECTION_NAME_LENGTH];
+        memcpy(name_upper, var->name, SHADER_REFLECTION_NAME_LENGTH);
+        str_toupper(name_upper);
+
+        if (var->location >= 0) {
+            pos += sprintf_fast(pos, "#define %s_LOCATION_%s %d\n", prefix_upper, name_upper, (int32) var->location);
+        }
+
+        if (var->binding >= 0) {
+            pos += sprintf_fast(pos, "#define %s_BINDING_%s %d\n", prefix_upper, name_upper, (int32) var->binding);
+        }
+    }
+
+    pos += sprintf_fast(pos, "\nstatic const ShaderReflection %s_reflection = {\n", prefix);
+    pos += sprintf_fast(pos, "    %d, // glsl_version\n    %d, // count\n    {\n", reflection->glsl_version, reflection->count);
+
+    for (int32 i = 0; i < reflection->count; ++i) {
+        const ShaderReflectionVariable* var = &reflection->variables[i];
+        pos += sprintf_fast(
+            pos,
+            "        {\"%s\", (ShaderReflectionKind) %d, (ShaderReflectionType) %d, %d, %d, %d, %d, %d},\n",
+            var->name,
+            (int32) var->kind, (int32) var->type,
+            (int32) var->array_size, (int32) var->location, (int32) var->binding,
+            (int32) var->stages, (int32) var->flags
+        );
+    }
+
+    pos += sprintf_fast(pos, "    }\n};\n\n#endif\n");
+
+    return (int32) (pos - output);
+}
+
+#endif
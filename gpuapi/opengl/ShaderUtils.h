@@ -19,6 +19,7 @@
 #include "Shader.h"
 #include "Opengl.h"
 #include "../ShaderType.h"
+#include "../ShaderReflection.h"
 #include "../GpuAttributeType.h"
 
 struct OpenglVertexInputAttributeDescription {
@@ -393,7 +394,7 @@ void gpuapi_attribute_setup_static(GpuAttributeType type, const OpenglVertexInpu
     }
 }
 
-// @performance It should be possible to do this at compile time if we manually parse the shader
+// Prefer the ShaderReflection version below, which doesn't need any name lookups
 FORCE_INLINE
 void gpuapi_descriptor_set_layout_create(
     Shader* const __restrict shader,
@@ -407,6 +408,32 @@ void gpuapi_descriptor_set_layout_create(
     }
 }
 
+// Uses the locations of the offline reflection (see shader_reflection_patch())
+// Only uniforms that couldn't be patched are looked up by name
+// The reflection must outlive the shader since the names are only referenced
+inline
+void gpuapi_descriptor_set_layout_create(
+    Shader* const __restrict shader,
+    const ShaderReflection* const __restrict reflection
+) NO_EXCEPT
+{
+    int32 count = 0;
+    for (int32 i = 0; i < reflection->count; ++i) {
+        const ShaderReflectionVariable* var = &reflection->variables[i];
+        if (var->kind != SHADER_REFLECTION_KIND_UNIFORM && var->kind != SHADER_REFLECTION_KIND_SAMPLER) {
+            continue;
+        }
+
+        ASSERT_TRUE(count < ARRAY_COUNT(shader->descriptor_set_layout));
+
+        shader->descriptor_set_layout[count].binding = var->location >= 0
+            ? var->location
+            : glGetUniformLocation(shader->id, var->name);
+        shader->descriptor_set_layout[count].name = var->name;
+        ++count;
+    }
+}
+
 template <unsigned N>
 struct OpenglVertexInputAttributeDescriptionArray
 {
@@ -16,6 +16,7 @@
 #include "../../stdlib/PerfectHashMap.h"
 #include "../../system/FileUtils.cpp"
 #include "../../html/template/HtmlTemplateInterpreter.h"
+#include "../../html/template/HtmlTemplateCompiler.h"
 
 bool html_template_in_control_structure(const char* str, const char** controls, int32 control_length) {
     for (int32 i = 0; i < control_length; ++i) {
@@ -27,9 +28,8 @@ bool html_template_in_control_structure(const char* str, const char** controls,
     return false;
 }
 
-void html_template_build(const FileBody* in, FileBody* out) {
-    // @todo We need to save the size of the template in the out file so we can correctly load the AST which starts afterwards
-
+// Removes irrelevant whitespaces from the template
+void html_template_minify(const FileBody* in, FileBody* out) {
     char* minified = (char *) out->content;
     char* minified_start = minified;
 
@@ -80,6 +80,12 @@ void html_template_build(const FileBody* in, FileBody* out) {
     }
 
     out->size += ((uintptr_t) minified - (uintptr_t) minified_start);
+}
+
+void html_template_build(const FileBody* in, FileBody* out) {
+    // @todo We need to save the size of the template in the out file so we can correctly load the AST which starts afterwards
+    char* minified_start = (char *) out->content;
+    html_template_minify(in, out);
 
     // Now add AST to cache
     HtmlTemplateToken current_token = html_template_token_next((const char**) &minified_start, HTML_TEMPLATE_CONTEXT_FLAG_HTML);
@@ -149,6 +155,37 @@ void html_template_cache_iter(const char* path, va_list args) {
     html_template_cache_load(cache, path, (const char *) file.content);
 }
 
+// Compiles the template to bytecode and stores the program in the cache
+// Rendering a cached template is then only a html_template_render() call without any parsing or string lookups
+void html_template_cache_compile_iter(const char* path, va_list args) {
+    PerfectHashMapRef* cache = va_arg(args, PerfectHashMapRef*);
+    RingMemory* const ring = va_arg(args, RingMemory*);
+
+    char full_path[PATH_MAX_LENGTH];
+    relative_to_absolute(path, full_path);
+
+    FileBody in = {0};
+    file_read(full_path, &in, ring);
+
+    FileBody minified = {
+        .size = 0,
+        .content = memory_get(ring, in.size + 1, ASSUMED_CACHE_LINE_SIZE)
+    };
+
+    html_template_minify(&in, &minified);
+    minified.content[minified.size] = '\0';
+
+    byte* out = memory_get(ring, html_template_program_size_max((int32) minified.size), sizeof(size_t));
+    HtmlTemplateProgram* program = html_template_compile((const char *) minified.content, (int32) minified.size, out, ring);
+    if (!program) {
+        LOG_1("Couldn't compile template %s", {DATA_TYPE_CHAR_STR, (void *) path});
+
+        return;
+    }
+
+    perfect_hashmap_insert(cache, path, (byte *) program, program->size);
+}
+
 void raw_file_cache_iter(const char* path, va_list args) {
     PerfectHashMapRef* cache = va_arg(args, PerfectHashMapRef*);
     RingMemory* const ring = va_arg(args, RingMemory*);
@@ -167,4 +204,10 @@ HtmlTemplateASTNode* html_template_cache_get(const PerfectHashMapRef* cache, con
     return (HtmlTemplateASTNode *) perfect_hashmap_get_value(cache, key);
 }
 
+inline
+const HtmlTemplateProgram* html_template_cache_get_program(const PerfectHashMapRef* cache, const char* key)
+{
+    return (const HtmlTemplateProgram *) perfect_hashmap_get_value(cache, key);
+}
+
 #endif
\ No newline at end of file
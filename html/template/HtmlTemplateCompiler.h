@@ -0,0 +1,682 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_HTML_TEMPLATE_COMPILER_H
+#define COMS_HTML_TEMPLATE_COMPILER_H
+
+#include "../../stdlib/Stdlib.h"
+#include "../../utils/StringUtils.h"
+#include "../../memory/RingMemory.cpp"
+#include "HtmlTemplateLexer.h"
+#include "HtmlTemplateInterpreter.h"
+
+// The compiler translates a (minified) template directly from the token stream into bytecode.
+// All variables are resolved to slot indices at compile time, the renderer never sees a variable name.
+//
+// Supported syntax inside of <? ?>:
+//      = expr;                         outputs the expression (also <?= expr ?>)
+//      name = expr; name += expr; ...  assignment (also ++, --)
+//      if (expr) { } elseif (expr) { } else { }
+//      while (expr) { }
+//      for (name = expr; expr; name += expr) { }
+// Blocks may be interrupted by html e.g. <? if (a > 1) { ?> <b>big</b> <? } ?>
+
+#define HTML_TEMPLATE_MAX_SLOTS 64
+#define HTML_TEMPLATE_SLOT_NAME_LENGTH 32
+
+// Value stack of the renderer, deeper expressions are rejected by the compiler
+#define HTML_TEMPLATE_VM_STACK_SIZE 32
+
+enum HtmlTemplateOpCode : byte {
+    HTML_TEMPLATE_OP_HALT,
+    HTML_TEMPLATE_OP_EMIT_TEXT, // a = string offset, b = length
+    HTML_TEMPLATE_OP_EMIT_VALUE, // pops value and outputs it
+    HTML_TEMPLATE_OP_PUSH_CONST, // a = constant index
+    HTML_TEMPLATE_OP_PUSH_STRING, // a = string offset, b = length
+    HTML_TEMPLATE_OP_LOAD, // a = slot
+    HTML_TEMPLATE_OP_STORE, // a = slot, pops value
+    HTML_TEMPLATE_OP_ADD,
+    HTML_TEMPLATE_OP_SUB,
+    HTML_TEMPLATE_OP_MUL,
+    HTML_TEMPLATE_OP_DIV,
+    HTML_TEMPLATE_OP_NEG,
+    HTML_TEMPLATE_OP_NOT,
+    HTML_TEMPLATE_OP_EQUALS,
+    HTML_TEMPLATE_OP_UNEQUAL,
+    HTML_TEMPLATE_OP_GREATER,
+    HTML_TEMPLATE_OP_GREATER_EQUAL,
+    HTML_TEMPLATE_OP_LESSER,
+    HTML_TEMPLATE_OP_LESSER_EQUAL,
+    HTML_TEMPLATE_OP_JUMP, // a = instruction index
+    HTML_TEMPLATE_OP_JUMP_IF_FALSE, // a = instruction index, pops value
+};
+
+struct HtmlTemplateInstruction {
+    HtmlTemplateOpCode op;
+    int32 a;
+    int32 b;
+};
+
+// The program is a single relocatable memory block (only offsets, no pointers)
+// This allows us to store it directly in the template cache or in a file
+// Layout:
+//      HtmlTemplateProgram
+//      HtmlTemplateValue[constant_count] (no strings, strings are PUSH_STRING ops)
+//      HtmlTemplateInstruction[instruction_count]
+//      char[slot_count][HTML_TEMPLATE_SLOT_NAME_LENGTH]
+//      char[string_size]
+struct HtmlTemplateProgram {
+    // Total size of the program incl. this header, always a multiple of 8
+    uint32 size;
+
+    uint32 instruction_count;
+    uint32 constant_count;
+    uint32 slot_count;
+    uint32 string_size;
+
+    // Maximum value stack depth required by the program
+    uint32 stack_size;
+
+    uint32 constant_offset;
+    uint32 instruction_offset;
+    uint32 slot_offset;
+    uint32 string_offset;
+};
+
+struct HtmlTemplateCompiler {
+    const char* input;
+    HtmlTemplateToken token;
+    HtmlTemplateContextFlag context_flag;
+
+    HtmlTemplateInstruction* instructions;
+    int32 instruction_count;
+    int32 instruction_capacity;
+
+    HtmlTemplateValue* constants;
+    int32 constant_count;
+    int32 constant_capacity;
+
+    char* strings;
+    int32 string_size;
+    int32 string_capacity;
+
+    char slot_names[HTML_TEMPLATE_MAX_SLOTS][HTML_TEMPLATE_SLOT_NAME_LENGTH];
+    int32 slot_count;
+
+    // Text emits must not be merged across a jump target
+    int32 merge_barrier;
+
+    int32 stack_depth;
+    int32 stack_size;
+
+    bool error;
+};
+
+FORCE_INLINE
+const HtmlTemplateValue* html_template_program_constants(const HtmlTemplateProgram* program) {
+    return (const HtmlTemplateValue *) ((const byte *) program + program->constant_offset);
+}
+
+FORCE_INLINE
+const HtmlTemplateInstruction* html_template_program_instructions(const HtmlTemplateProgram* program) {
+    return (const HtmlTemplateInstruction *) ((const byte *) program + program->instruction_offset);
+}
+
+FORCE_INLINE
+const char* html_template_program_strings(const HtmlTemplateProgram* program) {
+    return (const char *) program + program->string_offset;
+}
+
+// Slots are bound once by the caller, rendering only works with the slot index
+inline
+int32 html_template_program_slot(const HtmlTemplateProgram* program, const char* name) {
+    const char* slot_names = (const char *) program + program->slot_offset;
+    for (uint32 i = 0; i < program->slot_count; ++i) {
+        if (strcmp(slot_names + i * HTML_TEMPLATE_SLOT_NAME_LENGTH, name) == 0) {
+            return (int32) i;
+        }
+    }
+
+    return -1;
+}
+
+static inline
+void html_template_compiler_next(HtmlTemplateCompiler* compiler) {
+    compiler->token = html_template_token_next(&compiler->input, compiler->context_flag);
+
+    // The lexer doesn't know about the context, we have to switch it based on the code markers
+    if (compiler->token.type == TOKEN_CODE_START) {
+        compiler->context_flag = HTML_TEMPLATE_CONTEXT_FLAG_TEMPLATE;
+    } else if (compiler->token.type == TOKEN_CODE_END) {
+        compiler->context_flag = HTML_TEMPLATE_CONTEXT_FLAG_HTML;
+    }
+}
+
+static inline
+void html_template_compiler_expect(HtmlTemplateCompiler* compiler, HtmlTemplateTokenType type) {
+    if (compiler->token.type != type) {
+        LOG_1("Template compile error: unexpected token %d", {DATA_TYPE_INT32, &compiler->token.type});
+        compiler->error = true;
+
+        return;
+    }
+
+    html_template_compiler_next(compiler);
+}
+
+static inline
+int32 html_template_compiler_emit(HtmlTemplateCompiler* compiler, HtmlTemplateOpCode op, int32 a = 0, int32 b = 0) {
+    if (compiler->instruction_count >= compiler->instruction_capacity) {
+        compiler->error = true;
+
+        return compiler->instruction_count - 1;
+    }
+
+    switch (op) {
+        case HTML_TEMPLATE_OP_PUSH_CONST:
+        case HTML_TEMPLATE_OP_PUSH_STRING:
+        case HTML_TEMPLATE_OP_LOAD: {
+            ++compiler->stack_depth;
+            compiler->stack_size = OMS_MAX(compiler->stack_size, compiler->stack_depth);
+        } break;
+        case HTML_TEMPLATE_OP_EMIT_VALUE:
+        case HTML_TEMPLATE_OP_STORE:
+        case HTML_TEMPLATE_OP_JUMP_IF_FALSE:
+        case HTML_TEMPLATE_OP_ADD:
+        case HTML_TEMPLATE_OP_SUB:
+        case HTML_TEMPLATE_OP_MUL:
+        case HTML_TEMPLATE_OP_DIV:
+        case HTML_TEMPLATE_OP_EQUALS:
+        case HTML_TEMPLATE_OP_UNEQUAL:
+        case HTML_TEMPLATE_OP_GREATER:
+        case HTML_TEMPLATE_OP_GREATER_EQUAL:
+        case HTML_TEMPLATE_OP_LESSER:
+        case HTML_TEMPLATE_OP_LESSER_EQUAL:
+            --compiler->stack_depth;
+            break;
+        default: {}
+    }
+
+    HtmlTemplateInstruction* instr = &compiler->instructions[compiler->instruction_count];
+    instr->op = op;
+    instr->a = a;
+    instr->b = b;
+
+    return compiler->instruction_count++;
+}
+
+// Marks the current position as jump target and returns it
+static inline
+int32 html_template_compiler_label(HtmlTemplateCompiler* compiler) {
+    compiler->merge_barrier = compiler->instruction_count;
+
+    return compiler->instruction_count;
+}
+
+static inline
+void html_template_compiler_patch(HtmlTemplateCompiler* compiler, int32 instruction) {
+    compiler->instructions[instruction].a = html_template_compiler_label(compiler);
+}
+
+static inline
+int32 html_template_compiler_string(HtmlTemplateCompiler* compiler, const char* str, int32 length) {
+    if (compiler->string_size + length > compiler->string_capacity) {
+        compiler->error = true;
+
+        return 0;
+    }
+
+    int32 offset = compiler->string_size;
+    memcpy(compiler->strings + offset, str, length);
+    compiler->string_size += length;
+
+    return offset;
+}
+
+static
+void html_template_compiler_text(HtmlTemplateCompiler* compiler, const char* str, int32 length) {
+    if (length <= 0) {
+        return;
+    }
+
+    // Consecutive static html (e.g. separated by code that didn't output anything) becomes a single emit
+    if (compiler->instruction_count > compiler->merge_barrier) {
+        HtmlTemplateInstruction* last = &compiler->instructions[compiler->instruction_count - 1];
+        if (last->op == HTML_TEMPLATE_OP_EMIT_TEXT
+            && last->a + last->b == compiler->string_size
+        ) {
+            html_template_compiler_string(compiler, str, length);
+            last->b += length;
+
+            return;
+        }
+    }
+
+    int32 offset = html_template_compiler_string(compiler, str, length);
+    html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_EMIT_TEXT, offset, length);
+}
+
+static
+int32 html_template_compiler_slot(HtmlTemplateCompiler* compiler, const HtmlTemplateToken* token) {
+    // Linear search is fine, this only happens once per variable occurrence at compile time
+    for (int32 i = 0; i < compiler->slot_count; ++i) {
+        if (html_template_token_is(token, compiler->slot_names[i])) {
+            return i;
+        }
+    }
+
+    if (compiler->slot_count >= HTML_TEMPLATE_MAX_SLOTS
+        || token->length >= HTML_TEMPLATE_SLOT_NAME_LENGTH
+    ) {
+        compiler->error = true;
+
+        return 0;
+    }
+
+    char* name = compiler->slot_names[compiler->slot_count];
+    memcpy(name, token->value, token->length);
+    name[token->length] = '\0';
+
+    return compiler->slot_count++;
+}
+
+static
+void html_template_compiler_constant(HtmlTemplateCompiler* compiler, HtmlTemplateValue value) {
+    if (compiler->constant_count >= compiler->constant_capacity) {
+        compiler->error = true;
+
+        return;
+    }
+
+    compiler->constants[compiler->constant_count] = value;
+    html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_PUSH_CONST, compiler->constant_count);
+    ++compiler->constant_count;
+}
+
+static void html_template_compile_expression(HtmlTemplateCompiler* compiler);
+
+static
+void html_template_compile_primary(HtmlTemplateCompiler* compiler) {
+    HtmlTemplateValue value = {};
+
+    switch (compiler->token.type) {
+        case TOKEN_INTEGER64: {
+            value.type = VALUE_INTEGER64;
+            value.int64Value = str_to_int(compiler->token.value);
+            html_template_compiler_constant(compiler, value);
+            html_template_compiler_next(compiler);
+        } break;
+        case TOKEN_FLOAT64: {
+            value.type = VALUE_FLOAT64;
+            value.f64Value = strtod(compiler->token.value, NULL);
+            html_template_compiler_constant(compiler, value);
+            html_template_compiler_next(compiler);
+        } break;
+        case TOKEN_BOOL: {
+            value.type = VALUE_BOOL;
+            value.boolValue = html_template_token_is(&compiler->token, "true");
+            html_template_compiler_constant(compiler, value);
+            html_template_compiler_next(compiler);
+        } break;
+        case TOKEN_STRING: {
+            int32 offset = html_template_compiler_string(compiler, compiler->token.value, (int32) compiler->token.length);
+            html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_PUSH_STRING, offset, (int32) compiler->token.length);
+            html_template_compiler_next(compiler);
+        } break;
+        case TOKEN_IDENTIFIER: {
+            html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_LOAD, html_template_compiler_slot(compiler, &compiler->token));
+            html_template_compiler_next(compiler);
+        } break;
+        case TOKEN_LPAREN: {
+            html_template_compiler_next(compiler);
+            html_template_compile_expression(compiler);
+            html_template_compiler_expect(compiler, TOKEN_RPAREN);
+        } break;
+        case TOKEN_MINUS: {
+            html_template_compiler_next(compiler);
+            html_template_compile_primary(compiler);
+            html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_NEG);
+        } break;
+        case TOKEN_EXCLAMATION: {
+            html_template_compiler_next(compiler);
+            html_template_compile_primary(compiler);
+            html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_NOT);
+        } break;
+        default: {
+            compiler->error = true;
+            html_template_compiler_next(compiler);
+        }
+    }
+}
+
+static
+void html_template_compile_term(HtmlTemplateCompiler* compiler) {
+    html_template_compile_primary(compiler);
+
+    while (!compiler->error
+        && (compiler->token.type == TOKEN_MULTIPLY || compiler->token.type == TOKEN_DIVIDE)
+    ) {
+        HtmlTemplateOpCode op = compiler->token.type == TOKEN_MULTIPLY ? HTML_TEMPLATE_OP_MUL : HTML_TEMPLATE_OP_DIV;
+        html_template_compiler_next(compiler);
+        html_template_compile_primary(compiler);
+        html_template_compiler_emit(compiler, op);
+    }
+}
+
+static
+void html_template_compile_sum(HtmlTemplateCompiler* compiler) {
+    html_template_compile_term(compiler);
+
+    while (!compiler->error
+        && (compiler->token.type == TOKEN_PLUS || compiler->token.type == TOKEN_MINUS)
+    ) {
+        HtmlTemplateOpCode op = compiler->token.type == TOKEN_PLUS ? HTML_TEMPLATE_OP_ADD : HTML_TEMPLATE_OP_SUB;
+        html_template_compiler_next(compiler);
+        html_template_compile_term(compiler);
+        html_template_compiler_emit(compiler, op);
+    }
+}
+
+static
+void html_template_compile_expression(HtmlTemplateCompiler* compiler) {
+    html_template_compile_sum(compiler);
+
+    HtmlTemplateOpCode op;
+    switch (compiler->token.type) {
+        case TOKEN_EQUALS: op = HTML_TEMPLATE_OP_EQUALS; break;
+        case TOKEN_UNEQUAL: op = HTML_TEMPLATE_OP_UNEQUAL; break;
+        case TOKEN_GREATER: op = HTML_TEMPLATE_OP_GREATER; break;
+        case TOKEN_GREATER_EQUAL: op = HTML_TEMPLATE_OP_GREATER_EQUAL; break;
+        case TOKEN_LESSER: op = HTML_TEMPLATE_OP_LESSER; break;
+        case TOKEN_LESSER_EQUAL: op = HTML_TEMPLATE_OP_LESSER_EQUAL; break;
+        default: return;
+    }
+
+    html_template_compiler_next(compiler);
+    html_template_compile_sum(compiler);
+    html_template_compiler_emit(compiler, op);
+}
+
+// name = expr, name += expr, name++, ++name, ...
+static
+void html_template_compile_assignment(HtmlTemplateCompiler* compiler) {
+    HtmlTemplateTokenType type = compiler->token.type;
+    if (type == TOKEN_INCREMENT || type == TOKEN_DECREMENT) {
+        html_template_compiler_next(compiler);
+    }
+
+    int32 slot = html_template_compiler_slot(compiler, &compiler->token);
+    html_template_compiler_expect(compiler, TOKEN_IDENTIFIER);
+
+    if (type != TOKEN_INCREMENT && type != TOKEN_DECREMENT) {
+        type = compiler->token.type;
+        html_template_compiler_next(compiler);
+    }
+
+    if (type == TOKEN_ASSIGN) {
+        html_template_compile_expression(compiler);
+        html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_STORE, slot);
+
+        return;
+    }
+
+    HtmlTemplateOpCode op;
+    switch (type) {
+        case TOKEN_INCREMENT:
+        case TOKEN_ADD_ASSIGN: op = HTML_TEMPLATE_OP_ADD; break;
+        case TOKEN_DECREMENT:
+        case TOKEN_SUBTRACT_ASSIGN: op = HTML_TEMPLATE_OP_SUB; break;
+        case TOKEN_MULTIPLY_ASSIGN: op = HTML_TEMPLATE_OP_MUL; break;
+        case TOKEN_DIVIDE_ASSIGN: op = HTML_TEMPLATE_OP_DIV; break;
+        default: {
+            compiler->error = true;
+
+            return;
+        }
+    }
+
+    html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_LOAD, slot);
+
+    if (type == TOKEN_INCREMENT || type == TOKEN_DECREMENT) {
+        HtmlTemplateValue one = {};
+        one.type = VALUE_INTEGER64;
+        one.int64Value = 1;
+        html_template_compiler_constant(compiler, one);
+    } else {
+        html_template_compile_expression(compiler);
+    }
+
+    html_template_compiler_emit(compiler, op);
+    html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_STORE, slot);
+}
+
+static void html_template_compile_block(HtmlTemplateCompiler* compiler);
+
+static
+void html_template_compile_body(HtmlTemplateCompiler* compiler) {
+    html_template_compiler_expect(compiler, TOKEN_LBRACE);
+    html_template_compile_block(compiler);
+    html_template_compiler_expect(compiler, TOKEN_RBRACE);
+}
+
+static
+void html_template_compile_if(HtmlTemplateCompiler* compiler) {
+    html_template_compiler_next(compiler); // Consume 'if' or 'elseif'
+    html_template_compiler_expect(compiler, TOKEN_LPAREN);
+    html_template_compile_expression(compiler);
+    html_template_compiler_expect(compiler, TOKEN_RPAREN);
+
+    int32 jump_false = html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_JUMP_IF_FALSE);
+    html_template_compile_body(compiler);
+
+    if (compiler->token.type != TOKEN_ELSEIF && compiler->token.type != TOKEN_ELSE) {
+        html_template_compiler_patch(compiler, jump_false);
+
+        return;
+    }
+
+    int32 jump_end = html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_JUMP);
+    html_template_compiler_patch(compiler, jump_false);
+
+    if (compiler->token.type == TOKEN_ELSEIF) {
+        html_template_compile_if(compiler);
+    } else {
+        html_template_compiler_next(compiler); // Consume 'else'
+        html_template_compile_body(compiler);
+    }
+
+    html_template_compiler_patch(compiler, jump_end);
+}
+
+static
+void html_template_compile_while(HtmlTemplateCompiler* compiler) {
+    html_template_compiler_next(compiler); // Consume 'while'
+
+    int32 loop_start = html_template_compiler_label(compiler);
+    html_template_compiler_expect(compiler, TOKEN_LPAREN);
+    html_template_compile_expression(compiler);
+    html_template_compiler_expect(compiler, TOKEN_RPAREN);
+
+    int32 jump_end = html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_JUMP_IF_FALSE);
+    html_template_compile_body(compiler);
+    html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_JUMP, loop_start);
+    html_template_compiler_patch(compiler, jump_end);
+}
+
+static
+void html_template_compile_for(HtmlTemplateCompiler* compiler) {
+    html_template_compiler_next(compiler); // Consume 'for'
+    html_template_compiler_expect(compiler, TOKEN_LPAREN);
+    html_template_compile_assignment(compiler);
+    html_template_compiler_expect(compiler, TOKEN_SEMICOLON);
+
+    // The update is written before the body but executed after it
+    //      cond: <condition> JUMP_IF_FALSE end; JUMP body
+    //      update: <update> JUMP cond
+    //      body: <body> JUMP update
+    //      end:
+    int32 loop_condition = html_template_compiler_label(compiler);
+    html_template_compile_expression(compiler);
+    html_template_compiler_expect(compiler, TOKEN_SEMICOLON);
+    int32 jump_end = html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_JUMP_IF_FALSE);
+    int32 jump_body = html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_JUMP);
+
+    int32 loop_update = html_template_compiler_label(compiler);
+    html_template_compile_assignment(compiler);
+    html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_JUMP, loop_condition);
+    html_template_compiler_expect(compiler, TOKEN_RPAREN);
+
+    html_template_compiler_patch(compiler, jump_body);
+    html_template_compile_body(compiler);
+    html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_JUMP, loop_update);
+    html_template_compiler_patch(compiler, jump_end);
+}
+
+static
+void html_template_compile_block(HtmlTemplateCompiler* compiler) {
+    while (!compiler->error) {
+        switch (compiler->token.type) {
+            case TOKEN_EOF:
+            case TOKEN_RBRACE:
+                return;
+            case TOKEN_HTML: {
+                html_template_compiler_text(compiler, compiler->token.value, (int32) compiler->token.length);
+                html_template_compiler_next(compiler);
+            } break;
+            case TOKEN_CODE_START:
+            case TOKEN_CODE_END:
+            case TOKEN_SEMICOLON:
+                html_template_compiler_next(compiler);
+                break;
+            case TOKEN_ASSIGN: {
+                // Output statement <?= expr ?>
+                html_template_compiler_next(compiler);
+                html_template_compile_expression(compiler);
+                html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_EMIT_VALUE);
+            } break;
+            case TOKEN_IDENTIFIER:
+            case TOKEN_INCREMENT:
+            case TOKEN_DECREMENT:
+                html_template_compile_assignment(compiler);
+                break;
+            case TOKEN_IF:
+                html_template_compile_if(compiler);
+                break;
+            case TOKEN_WHILE:
+                html_template_compile_while(compiler);
+                break;
+            case TOKEN_FOR:
+                html_template_compile_for(compiler);
+                break;
+            default: {
+                LOG_1("Template compile error: unsupported token %d", {DATA_TYPE_INT32, &compiler->token.type});
+                compiler->error = true;
+            }
+        }
+    }
+}
+
+// Upper bound of the program size for a template of a certain length
+// Every token creates at most 3 instructions and a token is at least 1 char long
+inline
+int64 html_template_program_size_max(int32 template_length) {
+    return sizeof(HtmlTemplateProgram)
+        + (template_length + 1) * sizeof(HtmlTemplateValue)
+        + (template_length * 3 + 1) * sizeof(HtmlTemplateInstruction)
+        + HTML_TEMPLATE_MAX_SLOTS * HTML_TEMPLATE_SLOT_NAME_LENGTH
+        + template_length
+        + 8;
+}
+
+/**
+ * Compiles a template into a relocatable program
+ *
+ * @param str       Template (ideally minified, see html_template_build)
+ * @param length    Template length
+ * @param out       Output memory, must be at least html_template_program_size_max() large and 8 byte aligned
+ * @param ring      Temporary memory for the compilation
+ *
+ * @return Program or NULL on failure
+ */
+HtmlTemplateProgram* html_template_compile(const char* str, int32 length, byte* out, RingMemory* const ring)
+{
+    HtmlTemplateCompiler* compiler = (HtmlTemplateCompiler *) memory_get(ring, sizeof(HtmlTemplateCompiler), sizeof(size_t));
+    memset(compiler, 0, sizeof(HtmlTemplateCompiler));
+
+    compiler->instruction_capacity = length * 3 + 1;
+    compiler->instructions = (HtmlTemplateInstruction *) memory_get(
+        ring,
+        compiler->instruction_capacity * sizeof(HtmlTemplateInstruction),
+        sizeof(size_t)
+    );
+
+    compiler->constant_capacity = length + 1;
+    compiler->constants = (HtmlTemplateValue *) memory_get(
+        ring,
+        compiler->constant_capacity * sizeof(HtmlTemplateValue),
+        sizeof(size_t)
+    );
+
+    compiler->string_capacity = length;
+    compiler->strings = (char *) memory_get(ring, compiler->string_capacity + 1, sizeof(size_t));
+
+    compiler->input = str;
+    compiler->context_flag = HTML_TEMPLATE_CONTEXT_FLAG_HTML;
+    html_template_compiler_next(compiler);
+
+    html_template_compile_block(compiler);
+    if (compiler->token.type != TOKEN_EOF) {
+        // Unbalanced '}'
+        compiler->error = true;
+    }
+
+    html_template_compiler_emit(compiler, HTML_TEMPLATE_OP_HALT);
+
+    if (compiler->stack_size > HTML_TEMPLATE_VM_STACK_SIZE) {
+        LOG_1("Template compile error: expression too deep (%d)", {DATA_TYPE_INT32, &compiler->stack_size});
+        compiler->error = true;
+    }
+
+    if (compiler->error) {
+        LOG_1("Template compilation failed");
+
+        return NULL;
+    }
+
+    HtmlTemplateProgram* program = (HtmlTemplateProgram *) out;
+    program->instruction_count = compiler->instruction_count;
+    program->constant_count = compiler->constant_count;
+    program->slot_count = compiler->slot_count;
+    program->string_size = compiler->string_size;
+    program->stack_size = compiler->stack_size;
+
+    uint32 offset = (uint32) align_up(sizeof(HtmlTemplateProgram), sizeof(HtmlTemplateValue));
+    program->constant_offset = offset;
+    offset += compiler->constant_count * sizeof(HtmlTemplateValue);
+
+    program->instruction_offset = offset;
+    offset += compiler->instruction_count * sizeof(HtmlTemplateInstruction);
+
+    program->slot_offset = offset;
+    offset += compiler->slot_count * HTML_TEMPLATE_SLOT_NAME_LENGTH;
+
+    program->string_offset = offset;
+    offset += compiler->string_size;
+
+    program->size = (uint32) align_up(offset, 8);
+
+    memcpy(out + program->constant_offset, compiler->constants, compiler->constant_count * sizeof(HtmlTemplateValue));
+    memcpy(out + program->instruction_offset, compiler->instructions, compiler->instruction_count * sizeof(HtmlTemplateInstruction));
+    memcpy(out + program->slot_offset, compiler->slot_names, compiler->slot_count * HTML_TEMPLATE_SLOT_NAME_LENGTH);
+    memcpy(out + program->string_offset, compiler->strings, compiler->string_size);
+
+    return program;
+}
+
+#endif
@@ -84,8 +84,19 @@ enum HtmlTemplateContextFlag {
     HTML_TEMPLATE_CONTEXT_FLAG_TEMPLATE,
 };
 
+static inline
+bool html_template_token_is(const HtmlTemplateToken* token, const char* keyword) {
+    // Tokens point into the template and are not null terminated
+    size_t length = str_length(keyword);
+
+    return token->length == length && memcmp(token->value, keyword, length) == 0;
+}
+
 HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateContextFlag context_flag) {
-    str_skip_empty(input);
+    // Whitespace is only irrelevant inside of template code, html text must be preserved as is
+    if (context_flag == HTML_TEMPLATE_CONTEXT_FLAG_TEMPLATE) {
+        str_skip_empty(input);
+    }
 
     HtmlTemplateToken token = { TOKEN_HTML, *input, 0 };
     if (**input == '\0') {
@@ -120,10 +131,10 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
         if (**input == '"') {
             ++(*input);
         }
-    } else if (str_is_num(**input)) {
+    } else if (isdigit(**input)) {
         token.type = TOKEN_INTEGER64;
 
-        while (str_is_num(**input) || **input == '.') {
+        while (isdigit(**input) || **input == '.') {
             if (**input == '.') {
                 token.type = TOKEN_FLOAT64;
             }
@@ -131,32 +142,34 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
             ++(*input);
             ++token.length;
         }
-    } else if (str_is_alpha(**input)) {
-        while (str_is_alphanum(**input)) {
+    } else if (isalpha(**input) || **input == '_') {
+        while (isalnum(**input) || **input == '_') {
             ++(*input);
             ++token.length;
         }
 
-        if (strcmp(token.value, "if") == 0) {
+        if (html_template_token_is(&token, "if")) {
             token.type = TOKEN_IF;
-        } else if (strcmp(token.value, "endif") == 0) {
+        } else if (html_template_token_is(&token, "endif")) {
             token.type = TOKEN_ENDIF;
-        } else if (strcmp(token.value, "elseif") == 0) {
+        } else if (html_template_token_is(&token, "elseif")) {
             token.type = TOKEN_ELSEIF;
-        } else if (strcmp(token.value, "else") == 0) {
+        } else if (html_template_token_is(&token, "else")) {
             token.type = TOKEN_ELSE;
-        } else if (strcmp(token.value, "for") == 0) {
+        } else if (html_template_token_is(&token, "for")) {
             token.type = TOKEN_FOR;
-        } else if (strcmp(token.value, "endfor") == 0) {
+        } else if (html_template_token_is(&token, "endfor")) {
             token.type = TOKEN_ENDFOR;
-        } else if (strcmp(token.value, "while") == 0) {
+        } else if (html_template_token_is(&token, "while")) {
             token.type = TOKEN_WHILE;
-        } else if (strcmp(token.value, "endwhile") == 0) {
+        } else if (html_template_token_is(&token, "endwhile")) {
             token.type = TOKEN_ENDWHILE;
-        } else if (strcmp(token.value, "foreach") == 0) {
+        } else if (html_template_token_is(&token, "foreach")) {
             token.type = TOKEN_FOREACH;
-        } else if (strcmp(token.value, "endforeach") == 0) {
+        } else if (html_template_token_is(&token, "endforeach")) {
             token.type = TOKEN_ENDFOREACH;
+        } else if (html_template_token_is(&token, "true") || html_template_token_is(&token, "false")) {
+            token.type = TOKEN_BOOL;
         } else {
             token.type = TOKEN_IDENTIFIER;
         }
@@ -165,7 +178,7 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
 
         switch (**input) {
             case '=': {
-                if (*input[1] == '=') {
+                if ((*input)[1] == '=') {
                     token.type = TOKEN_EQUALS;
                     token.length = 2;
                     ++(*input);
@@ -174,7 +187,7 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
                 }
             } break;
             case '!': {
-                if (*input[1] == '=') {
+                if ((*input)[1] == '=') {
                     token.type = TOKEN_UNEQUAL;
                     token.length = 2;
                     ++(*input);
@@ -184,7 +197,7 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
             } break;
             case ':': token.type = TOKEN_COLON; break;
             case '?': {
-                if (*input[1] == '>') {
+                if ((*input)[1] == '>') {
                     token.type = TOKEN_CODE_END;
                     token.length = 2;
                     ++(*input);
@@ -193,7 +206,7 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
                 }
             } break;
             case '>': {
-                if (*input[1] == '=') {
+                if ((*input)[1] == '=') {
                     token.type = TOKEN_GREATER_EQUAL;
                     token.length = 2;
                     ++(*input);
@@ -202,7 +215,7 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
                 }
             } break;
             case '<': {
-                if (*input[1] == '=') {
+                if ((*input)[1] == '=') {
                     token.type = TOKEN_LESSER_EQUAL;
                     token.length = 2;
                     ++(*input);
@@ -211,11 +224,11 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
                 }
             } break;
             case '+': {
-                if (*input[1] == '=') {
+                if ((*input)[1] == '=') {
                     token.type = TOKEN_ADD_ASSIGN;
                     token.length = 2;
                     ++(*input);
-                } else if (*input[1] == '+') {
+                } else if ((*input)[1] == '+') {
                     token.type = TOKEN_INCREMENT;
                     token.length = 2;
                     ++(*input);
@@ -224,11 +237,11 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
                 }
             } break;
             case '-': {
-                if (*input[1] == '=') {
+                if ((*input)[1] == '=') {
                     token.type = TOKEN_SUBTRACT_ASSIGN;
                     token.length = 2;
                     ++(*input);
-                } else if (*input[1] == '-') {
+                } else if ((*input)[1] == '-') {
                     token.type = TOKEN_DECREMENT;
                     token.length = 2;
                     ++(*input);
@@ -237,7 +250,7 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
                 }
             } break;
             case '*': {
-                if (*input[1] == '=') {
+                if ((*input)[1] == '=') {
                     token.type = TOKEN_MULTIPLY_ASSIGN;
                     token.length = 2;
                     ++(*input);
@@ -246,7 +259,7 @@ HtmlTemplateToken html_template_token_next(const char** input, HtmlTemplateConte
                 }
              } break;
             case '/': {
-                if (*input[1] == '=') {
+                if ((*input)[1] == '=') {
                     token.type = TOKEN_DIVIDE_ASSIGN;
                     token.length = 2;
                     ++(*input);
@@ -0,0 +1,250 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_HTML_TEMPLATE_VM_H
+#define COMS_HTML_TEMPLATE_VM_H
+
+#include "../../stdlib/Stdlib.h"
+#include "../../utils/StringUtils.h"
+#include "HtmlTemplateCompiler.h"
+
+static inline
+bool html_template_value_is_true(const HtmlTemplateValue* value) {
+    switch (value->type) {
+        case VALUE_BOOL: return value->boolValue;
+        case VALUE_INTEGER64: return value->int64Value != 0;
+        case VALUE_FLOAT64: return value->f64Value != 0.0;
+        case VALUE_STRING: return value->value_length > 0;
+        default: UNREACHABLE();
+    }
+}
+
+FORCE_INLINE
+f64 html_template_value_to_f64(const HtmlTemplateValue* value) {
+    return value->type == VALUE_FLOAT64 ? value->f64Value : (f64) value->int64Value;
+}
+
+static inline
+void html_template_value_arithmetic(HtmlTemplateValue* left, const HtmlTemplateValue* right, HtmlTemplateOpCode op) {
+    if (left->type == VALUE_FLOAT64 || right->type == VALUE_FLOAT64) {
+        f64 a = html_template_value_to_f64(left);
+        f64 b = html_template_value_to_f64(right);
+
+        left->type = VALUE_FLOAT64;
+        switch (op) {
+            case HTML_TEMPLATE_OP_ADD: left->f64Value = a + b; break;
+            case HTML_TEMPLATE_OP_SUB: left->f64Value = a - b; break;
+            case HTML_TEMPLATE_OP_MUL: left->f64Value = a * b; break;
+            case HTML_TEMPLATE_OP_DIV: left->f64Value = a / b; break;
+            default: UNREACHABLE();
+        }
+
+        return;
+    }
+
+    // Bools are treated as integers, strings are not supported in arithmetic
+    int64 a = left->type == VALUE_BOOL ? left->boolValue : left->int64Value;
+    int64 b = right->type == VALUE_BOOL ? right->boolValue : right->int64Value;
+
+    left->type = VALUE_INTEGER64;
+    switch (op) {
+        case HTML_TEMPLATE_OP_ADD: left->int64Value = a + b; break;
+        case HTML_TEMPLATE_OP_SUB: left->int64Value = a - b; break;
+        case HTML_TEMPLATE_OP_MUL: left->int64Value = a * b; break;
+        case HTML_TEMPLATE_OP_DIV: left->int64Value = b == 0 ? 0 : a / b; break;
+        default: UNREACHABLE();
+    }
+}
+
+static inline
+bool html_template_value_compare(const HtmlTemplateValue* left, const HtmlTemplateValue* right, HtmlTemplateOpCode op) {
+    if (left->type == VALUE_STRING && right->type == VALUE_STRING) {
+        bool equal = left->value_length == right->value_length
+            && memcmp(left->ptrValue, right->ptrValue, left->value_length) == 0;
+
+        return op == HTML_TEMPLATE_OP_EQUALS ? equal : (op == HTML_TEMPLATE_OP_UNEQUAL && !equal);
+    }
+
+    f64 a;
+    f64 b;
+    if (left->type == VALUE_FLOAT64 || right->type == VALUE_FLOAT64) {
+        a = html_template_value_to_f64(left);
+        b = html_template_value_to_f64(right);
+    } else {
+        int64 ia = left->type == VALUE_BOOL ? left->boolValue : left->int64Value;
+        int64 ib = right->type == VALUE_BOOL ? right->boolValue : right->int64Value;
+
+        switch (op) {
+            case HTML_TEMPLATE_OP_EQUALS: return ia == ib;
+            case HTML_TEMPLATE_OP_UNEQUAL: return ia != ib;
+            case HTML_TEMPLATE_OP_GREATER: return ia > ib;
+            case HTML_TEMPLATE_OP_GREATER_EQUAL: return ia >= ib;
+            case HTML_TEMPLATE_OP_LESSER: return ia < ib;
+            case HTML_TEMPLATE_OP_LESSER_EQUAL: return ia <= ib;
+            default: UNREACHABLE();
+        }
+    }
+
+    switch (op) {
+        case HTML_TEMPLATE_OP_EQUALS: return a == b;
+        case HTML_TEMPLATE_OP_UNEQUAL: return a != b;
+        case HTML_TEMPLATE_OP_GREATER: return a > b;
+        case HTML_TEMPLATE_OP_GREATER_EQUAL: return a >= b;
+        case HTML_TEMPLATE_OP_LESSER: return a < b;
+        case HTML_TEMPLATE_OP_LESSER_EQUAL: return a <= b;
+        default: UNREACHABLE();
+    }
+}
+
+static inline
+int32 html_template_value_output(const HtmlTemplateValue* value, char* buffer, int32 buffer_size) {
+    if (buffer_size <= 0) {
+        return 0;
+    }
+
+    // Numbers are written to a temp buffer first and truncated like any other text
+    char number[32];
+    int32 length;
+
+    switch (value->type) {
+        case VALUE_BOOL: {
+            if (value->boolValue) {
+                *buffer = '1';
+
+                return 1;
+            }
+
+            return 0;
+        }
+        case VALUE_INTEGER64:
+            length = int_to_str(value->int64Value, number);
+            break;
+        case VALUE_FLOAT64:
+            length = float_to_str(value->f64Value, number);
+            break;
+        case VALUE_STRING: {
+            length = OMS_MIN(value->value_length, buffer_size);
+            memcpy(buffer, value->ptrValue, length);
+
+            return length;
+        }
+        default: UNREACHABLE();
+    }
+
+    length = OMS_MIN(length, buffer_size);
+    memcpy(buffer, number, length);
+
+    return length;
+}
+
+/**
+ * Renders a compiled template
+ *
+ * @param program       Compiled template
+ * @param slots         Variables (program->slot_count), use html_template_program_slot() to find the slot of a variable.
+ *                      The template may modify the slots (assignments)
+ * @param buffer        Output buffer
+ * @param buffer_size   Output buffer size
+ *
+ * @return Output length (the output is not null terminated)
+ */
+int32 html_template_render(
+    const HtmlTemplateProgram* __restrict program,
+    HtmlTemplateValue* __restrict slots,
+    char* __restrict buffer,
+    int32 buffer_size
+) {
+    ASSERT_TRUE(program->stack_size <= HTML_TEMPLATE_VM_STACK_SIZE);
+
+    const HtmlTemplateInstruction* instructions = html_template_program_instructions(program);
+    const HtmlTemplateValue* constants = html_template_program_constants(program);
+    const char* strings = html_template_program_strings(program);
+
+    HtmlTemplateValue stack[HTML_TEMPLATE_VM_STACK_SIZE];
+    int32 sp = 0;
+    int32 out = 0;
+
+    const HtmlTemplateInstruction* ip = instructions;
+    while (true) {
+        const HtmlTemplateInstruction* instr = ip++;
+
+        switch (instr->op) {
+            case HTML_TEMPLATE_OP_HALT:
+                return out;
+            case HTML_TEMPLATE_OP_EMIT_TEXT: {
+                int32 length = OMS_MIN(instr->b, buffer_size - out);
+                memcpy(buffer + out, strings + instr->a, length);
+                out += length;
+            } break;
+            case HTML_TEMPLATE_OP_EMIT_VALUE: {
+                --sp;
+                out += html_template_value_output(&stack[sp], buffer + out, buffer_size - out);
+            } break;
+            case HTML_TEMPLATE_OP_PUSH_CONST:
+                stack[sp++] = constants[instr->a];
+                break;
+            case HTML_TEMPLATE_OP_PUSH_STRING: {
+                stack[sp].type = VALUE_STRING;
+                stack[sp].ptrValue = strings + instr->a;
+                stack[sp].value_length = instr->b;
+                ++sp;
+            } break;
+            case HTML_TEMPLATE_OP_LOAD:
+                stack[sp++] = slots[instr->a];
+                break;
+            case HTML_TEMPLATE_OP_STORE:
+                slots[instr->a] = stack[--sp];
+                break;
+            case HTML_TEMPLATE_OP_ADD:
+            case HTML_TEMPLATE_OP_SUB:
+            case HTML_TEMPLATE_OP_MUL:
+            case HTML_TEMPLATE_OP_DIV: {
+                --sp;
+                html_template_value_arithmetic(&stack[sp - 1], &stack[sp], instr->op);
+            } break;
+            case HTML_TEMPLATE_OP_NEG: {
+                HtmlTemplateValue* value = &stack[sp - 1];
+                if (value->type == VALUE_FLOAT64) {
+                    value->f64Value = -value->f64Value;
+                } else if (value->type == VALUE_INTEGER64) {
+                    value->int64Value = -value->int64Value;
+                }
+            } break;
+            case HTML_TEMPLATE_OP_NOT: {
+                HtmlTemplateValue* value = &stack[sp - 1];
+                value->boolValue = !html_template_value_is_true(value);
+                value->type = VALUE_BOOL;
+            } break;
+            case HTML_TEMPLATE_OP_EQUALS:
+            case HTML_TEMPLATE_OP_UNEQUAL:
+            case HTML_TEMPLATE_OP_GREATER:
+            case HTML_TEMPLATE_OP_GREATER_EQUAL:
+            case HTML_TEMPLATE_OP_LESSER:
+            case HTML_TEMPLATE_OP_LESSER_EQUAL: {
+                --sp;
+                bool result = html_template_value_compare(&stack[sp - 1], &stack[sp], instr->op);
+                stack[sp - 1].type = VALUE_BOOL;
+                stack[sp - 1].boolValue = result;
+            } break;
+            case HTML_TEMPLATE_OP_JUMP:
+                ip = instructions + instr->a;
+                break;
+            case HTML_TEMPLATE_OP_JUMP_IF_FALSE: {
+                --sp;
+                if (!html_template_value_is_true(&stack[sp])) {
+                    ip = instructions + instr->a;
+                }
+            } break;
+            default:
+                UNREACHABLE();
+        }
+    }
+}
+
+#endif
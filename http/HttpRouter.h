@@ -18,6 +18,12 @@
 
 #define HTTP_ROUTE_SEGMENT_LENGTH 32
 
+// Distinct regex segments that are compiled only once (power of 2, at most 3/4 are used)
+// Additional patterns still work but are compiled on every request
+#ifndef HTTP_ROUTER_REGEX_CACHE_SIZE
+    #define HTTP_ROUTER_REGEX_CACHE_SIZE 64
+#endif
+
 struct HttpRouteNode {
     char segment[HTTP_ROUTE_SEGMENT_LENGTH];
 
@@ -48,20 +54,30 @@ struct HttpRouter {
 
     uint32 route_detail_count;
     uint32 route_detail_capacity;
+
+    // Compiled regex segments, every pattern is compiled on its first use
+    RegexCache* regex_cache;
 };
 
 void http_router_init(HttpRouter* router, uint32 route_count, BufferMemory* const buf, int32 alignment = sizeof(size_t)) {
     // We expect 3 path components per route
     // If more are required, we will increase the memory later
-    router->nodes = (HttpRouteNode *) memory_get(buf, route_count * 3 * sizeof(HttpRouteNode), alignment, true);
+    router->nodes = (HttpRouteNode *) memory_get(buf, route_count * 3 * sizeof(HttpRouteNode), alignment);
     router->node_capacity = route_count * 3;
     router->node_count = 0;
 
     // We expect at least one route detail per route
     // On average it is probably more like 1.x but if we need more we will increase as required later
-    router->route_details = (HttpRouteDetails *) memory_get(buf, route_count  * sizeof(HttpRouteDetails), alignment, true);
+    router->route_details = (HttpRouteDetails *) memory_get(buf, route_count  * sizeof(HttpRouteDetails), alignment);
     router->route_detail_capacity = route_count;
     router->route_detail_count = 0;
+
+    router->regex_cache = (RegexCache *) memory_get(buf, sizeof(RegexCache), alignment);
+    regex_cache_init(
+        router->regex_cache,
+        HTTP_ROUTER_REGEX_CACHE_SIZE,
+        memory_get(buf, regex_cache_size(HTTP_ROUTER_REGEX_CACHE_SIZE), alignment)
+    );
 }
 
 /**
@@ -93,7 +109,7 @@ void http_router_find_iter(
     for (uint32 i = 0; i < node->children_count; ++i) {
         HttpRouteNode* test_node = &router->nodes[node->children_offset + i];
         if ((!test_node->is_regex && strcmp(test_node->segment, uri_segments) == 0)
-            || (test_node->is_regex && regex_simplified_validate(test_node->segment, uri_segments))
+            || (test_node->is_regex && regex_simplified_validate(test_node->segment, uri_segments, router->regex_cache))
         ) {
             if (uri_segment_index < uri_segment_count && test_node->children_count) {
                 // We have more in our uri path AND more child nodes
@@ -129,7 +145,7 @@ void http_router_find_iter(
                 if (test_node->is_regex) {
                     bool is_valid = true;
                     for (int32 j = uri_segment_index + 1; j < uri_segment_count; ++j) {
-                        if (!regex_simplified_validate(test_node->segment, uri_segments)) {
+                        if (!regex_simplified_validate(test_node->segment, uri_segments, router->regex_cache)) {
                             is_valid = false;
                             break;
                         }
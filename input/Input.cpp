@@ -25,7 +25,9 @@
 FORCE_INLINE CONSTEXPR
 size_t input_memory_size(uint8 count) NO_EXCEPT
 {
-    return count * sizeof(Hotkey) * 2;
+    return count * sizeof(Hotkey) * 2
+        + count * sizeof(HotkeyChord) * 2
+        + count * sizeof(uint16) * 2;
 }
 
 // count = count of possible hotkeys
@@ -36,9 +38,13 @@ void input_init(Input* const input, uint8 count, BufferMemory* const buf) NO_EXC
 
     const size_t hotkey_size = input_memory_size(input->hotkey_count);
 
-    input->input_mapping1 = (Hotkey *) memory_get(buf, hotkey_size, alignof(Hotkey));
+    input->input_mapping1 = (Hotkey *) memory_get(buf, hotkey_size, alignof(HotkeyChord));
     input->input_mapping2 = input->input_mapping1 + input->hotkey_count;
 
+    input->hotkey_index.chords = (HotkeyChord *) (input->input_mapping2 + input->hotkey_count);
+    input->hotkey_index.candidates = (uint16 *) (input->hotkey_index.chords + input->hotkey_count * 2);
+    memset(input->hotkey_index.key_offsets, 0, sizeof(input->hotkey_index.key_offsets));
+
     // This clears both mapping1 and mapping2
     memset(input->input_mapping1, 0, hotkey_size);
 
@@ -51,6 +57,7 @@ FORCE_INLINE
 void input_mapping_reset(Input* const input) NO_EXCEPT {
     // This clears both mapping1 and mapping2
     memset(input->input_mapping1, 0, input_memory_size(input->hotkey_count));
+    memset(input->hotkey_index.key_offsets, 0, sizeof(input->hotkey_index.key_offsets));
     memset(&input->state, 0, sizeof(input->state));
 }
 
@@ -195,6 +202,82 @@ input_add_hotkey(
     memcpy(&mapping[hotkey], key, sizeof(*key));
 }
 
+// Keyboard keys = 0-255, mouse keys = 256-383, controller keys = 384-511
+FORCE_INLINE
+int32 input_key_bit(uint16 scan_code) NO_EXCEPT
+{
+    if (scan_code & INPUT_CONTROLLER_PREFIX) {
+        return 384 + (scan_code & 0x7F);
+    } else if (scan_code & INPUT_KEYBOARD_PREFIX) {
+        return scan_code & 0xFF;
+    }
+
+    return 256 + (scan_code & 0x7F);
+}
+
+/**
+ * Builds the key -> hotkey index from input_mapping1 and input_mapping2
+ *
+ * Must be called after changing the mappings
+ */
+void input_hotkey_index_build(Input* const input) NO_EXCEPT
+{
+    HotkeyIndex* const index = &input->hotkey_index;
+    const int32 chord_count = input->hotkey_count * 2;
+
+    // The key used for the index, -1 = not indexed
+    int16 index_keys[2 * 256];
+    memset(index->key_offsets, 0, sizeof(index->key_offsets));
+
+    for (int32 i = 0; i < chord_count; ++i) {
+        const Hotkey* const hotkey = i < input->hotkey_count
+            ? &input->input_mapping1[i]
+            : &input->input_mapping2[i - input->hotkey_count];
+
+        HotkeyChord* const chord = &index->chords[i];
+        chord->key_count = 0;
+        chord->key_state = hotkey->key_state;
+        index_keys[i] = -1;
+
+        bool is_valid = true;
+        for (int32 j = 0; j < MAX_HOTKEY_COMBINATION; ++j) {
+            if (hotkey->scan_codes[j] == 0) {
+                continue;
+            }
+
+            // @todo Negative scan codes (= any of the keys) are not supported
+            if (hotkey->scan_codes[j] < 0) {
+                is_valid = false;
+                break;
+            }
+
+            chord->key_bits[chord->key_count++] = (int16) input_key_bit((uint16) hotkey->scan_codes[j]);
+        }
+
+        if (!is_valid || !chord->key_count) {
+            chord->key_count = 0;
+            continue;
+        }
+
+        index_keys[i] = chord->key_bits[0];
+        ++index->key_offsets[index_keys[i] + 1];
+    }
+
+    // Prefix sum -> offsets
+    for (int32 bit = 0; bit < INPUT_KEY_BITS; ++bit) {
+        index->key_offsets[bit + 1] += index->key_offsets[bit];
+    }
+
+    uint16 fill[INPUT_KEY_BITS];
+    memcpy(fill, index->key_offsets, sizeof(fill));
+
+    for (int32 i = 0; i < chord_count; ++i) {
+        if (index_keys[i] >= 0) {
+            index->candidates[fill[index_keys[i]]++] = (uint16) i;
+        }
+    }
+}
+
 FORCE_INLINE HOT_CODE
 bool hotkey_is_active(const uint16* const active_hotkeys, uint16 hotkey) NO_EXCEPT
 {
@@ -243,7 +326,19 @@ void input_set_state(
         if (!free_state && key->scan_code == 0) {
             free_state = key;
         } else if (key->scan_code == new_key->scan_code) {
-            key->key_state = new_key->key_state;
+            if (new_key->key_state == KEY_PRESS_TYPE_PRESSED) {
+                if (key->key_state == KEY_PRESS_TYPE_RELEASED) {
+                    // Pressed again before the released state got cleaned up
+                    key->tap_count = new_key->time - key->time_down <= INPUT_DOUBLE_TAP_DURATION * 1000 ? 2 : 1;
+                    key->time_down = new_key->time;
+                    key->key_state = KEY_PRESS_TYPE_PRESSED;
+                }
+
+                // Otherwise it is a repeated key event, the key keeps its state (e.g. held) and its time_down
+            } else {
+                key->key_state = new_key->key_state;
+            }
+
             key->value += new_key->value;
             key->time = new_key->time;
 
@@ -256,6 +351,8 @@ void input_set_state(
     }
 
     memcpy(free_state, new_key, sizeof(*new_key));
+    free_state->time_down = new_key->time;
+    free_state->tap_count = 0;
 }
 
 // Controllers are a little bit special
@@ -338,14 +435,96 @@ void input_set_controller_state(Input* input, ControllerInput* controller, uint6
     input->general_states |= INPUT_STATE_GENERAL_BUTTON_CHANGE;
 }
 
+FORCE_INLINE
+bool input_key_bits_contain(const uint64* const bits, const HotkeyChord* const chord) NO_EXCEPT
+{
+    for (int32 i = 0; i < chord->key_count; ++i) {
+        if (!(bits[chord->key_bits[i] >> 6] & (1ULL << (chord->key_bits[i] & 63)))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Are all keys of chord a also part of chord b
+FORCE_INLINE
+bool hotkey_chord_is_subset(const HotkeyChord* const a, const HotkeyChord* const b) NO_EXCEPT
+{
+    for (int32 i = 0; i < a->key_count; ++i) {
+        int32 j = 0;
+        while (j < b->key_count && b->key_bits[j] != a->key_bits[i]) {
+            ++j;
+        }
+
+        if (j >= b->key_count) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Sets the tap_count of newly pressed keys based on the recently released keys
+static inline
+void input_key_taps_evaluate(InputState* const state) NO_EXCEPT
+{
+    for (int32 i = 0; i < MAX_KEY_PRESSES; ++i) {
+        InputKey* const key = &state->active_keys[i];
+        if (!key->scan_code || key->tap_count) {
+            continue;
+        }
+
+        key->tap_count = 1;
+        for (int32 j = 0; j < MAX_KEY_PRESSES; ++j) {
+            InputKeyTap* const tap = &state->recent_taps[j];
+            if (tap->scan_code == key->scan_code
+                && key->time_down - tap->time_down <= INPUT_DOUBLE_TAP_DURATION * 1000
+            ) {
+                key->tap_count = 2;
+
+                // A tap can only be used once, otherwise a triple tap would be two double taps
+                tap->scan_code = 0;
+                break;
+            }
+        }
+    }
+}
+
+// Remembers the released keys for the double tap detection
+static inline
+void input_key_taps_record(InputState* const state) NO_EXCEPT
+{
+    for (int32 i = 0; i < MAX_KEY_PRESSES; ++i) {
+        const InputKey* const key = &state->active_keys[i];
+        if (!key->scan_code || key->key_state != KEY_PRESS_TYPE_RELEASED || key->tap_count == 2) {
+            continue;
+        }
+
+        InputKeyTap* const tap = &state->recent_taps[state->recent_tap_index];
+        tap->scan_code = key->scan_code;
+        tap->time_down = key->time_down;
+
+        state->recent_tap_index = (state->recent_tap_index + 1) % MAX_KEY_PRESSES;
+    }
+}
+
+/**
+ * Finds the active hotkeys
+ *
+ * The matching uses the key -> hotkey index, only the hotkeys of the active keys are checked.
+ * If multiple hotkeys match, the hotkey with the most keys wins (e.g. alt+1 suppresses 1).
+ *
+ * @param input Input
+ * @param time  Current time in microseconds (used for the held state)
+ */
 HOT_CODE
-void input_hotkey_state(Input* const input) NO_EXCEPT
+void input_hotkey_state(Input* const input, uint64 time) NO_EXCEPT
 {
     // @performance Can't we have a input state that checks if we even have to check the input?
     // careful even no active keys may require a minor update because we need to set it to inactive
 
-    // @todo implement _HELD state based on time
-    // @bug Maybe we then need to check if it is still held down through a poll event to avoid bugs when tabbing etc.
+    // @bug Maybe we need to check if a held key is still held down through a poll event to avoid bugs when tabbing etc.
 
     InputState* const state = &input->state;
     memset(state->active_hotkeys, 0, sizeof(uint16) * MAX_KEY_PRESSES);
@@ -433,36 +612,119 @@ void input_hotkey_state(Input* const input) NO_EXCEPT
         }
     }
 
-    int32 active_hotkeys = 0;
+    input_key_taps_evaluate(state);
 
-    // Check every mapping
-    for (int32 i = 0; i < 2; ++i) {
-        const Hotkey* const mapping = i == 0 ? input->input_mapping1 : input->input_mapping2;
+    // Key bitsets, one bit per key (see input_key_bit())
+    uint64 bits_down[INPUT_KEY_BITS / 64] = {0};
+    uint64 bits_held[INPUT_KEY_BITS / 64] = {0};
+    uint64 bits_released[INPUT_KEY_BITS / 64] = {0};
+    uint64 bits_tapped[INPUT_KEY_BITS / 64] = {0};
 
-        // Check all possible hotkeys if all of their required keys are active
-        for (int16 hotkey_idx = 1; hotkey_idx <= input->hotkey_count; ++hotkey_idx) {
-            // We only support a limited amount of active hotkeys
-            if (active_hotkeys >= MAX_KEY_PRESSES) { UNLIKELY
-                i = 2;
-                break;
+    for (int32 i = 0; i < MAX_KEY_PRESSES; ++i) {
+        InputKey* const key = &state_active_keys[i];
+        if (!key->scan_code) {
+            continue;
+        }
+
+        const int32 bit = input_key_bit(key->scan_code);
+        const uint64 mask = 1ULL << (bit & 63);
+
+        if (key->key_state == KEY_PRESS_TYPE_RELEASED) {
+            bits_released[bit >> 6] |= mask;
+            continue;
+        }
+
+        if (key->key_state == KEY_PRESS_TYPE_PRESSED
+            && time - key->time_down >= INPUT_LONG_PRESS_DURATION * 1000
+        ) {
+            key->key_state = KEY_PRESS_TYPE_HELD;
+        }
+
+        bits_down[bit >> 6] |= mask;
+
+        if (key->key_state == KEY_PRESS_TYPE_HELD) {
+            bits_held[bit >> 6] |= mask;
+        }
+
+        if (key->tap_count == 2) {
+            bits_tapped[bit >> 6] |= mask;
+        }
+    }
+
+    const HotkeyIndex* const index = &input->hotkey_index;
+
+    // Chords that match the current key state (index into index->chords)
+    uint16 matches[MAX_KEY_PRESSES * 8];
+    int32 match_count = 0;
+
+    for (int32 i = 0; i < MAX_KEY_PRESSES; ++i) {
+        if (!state_active_keys[i].scan_code) {
+            continue;
+        }
+
+        const int32 bit = input_key_bit(state_active_keys[i].scan_code);
+        for (int32 c = index->key_offsets[bit]; c < index->key_offsets[bit + 1]; ++c) {
+            const HotkeyChord* const chord = &index->chords[index->candidates[c]];
+
+            bool is_match;
+            switch (chord->key_state) {
+                case KEY_PRESS_TYPE_PRESSED:
+                    is_match = input_key_bits_contain(bits_down, chord);
+                    break;
+                case KEY_PRESS_TYPE_HELD:
+                    is_match = input_key_bits_contain(bits_held, chord);
+                    break;
+                case KEY_PRESS_TYPE_RELEASED:
+                    is_match = input_key_bits_contain(bits_released, chord);
+                    break;
+                case KEY_PRESS_TYPE_DOUBLE_TAPPED: {
+                    is_match = input_key_bits_contain(bits_down, chord);
+
+                    // At least one of the keys must be double tapped
+                    bool is_tapped = false;
+                    for (int32 k = 0; k < chord->key_count; ++k) {
+                        is_tapped |= (bits_tapped[chord->key_bits[k] >> 6] >> (chord->key_bits[k] & 63)) & 1;
+                    }
+
+                    is_match &= is_tapped;
+                } break;
+                default:
+                    is_match = false;
             }
 
-            if (hotkey_is_active(state->active_hotkeys, hotkey_idx)
-                || !hotkey_keys_are_active(state->active_keys, mapping, hotkey_idx)
-            ) {
-                // Hotkey already active, we don't need to check if it needs to be activated
-                // Or not all keys for the hotkey are pressed or the KeyPressType is not the same
-                continue;
+            if (is_match && match_count < (int32) ARRAY_COUNT(matches)) {
+                matches[match_count++] = index->candidates[c];
+            }
+        }
+    }
+
+    // Longest chord wins, e.g. there might be a hotkey for 1 and one for alt+1
+    // In this case only the hotkey for alt+1 should be triggered
+    int32 active_hotkeys = 0;
+    for (int32 i = 0; i < match_count && active_hotkeys < MAX_KEY_PRESSES; ++i) {
+        const HotkeyChord* const chord = &index->chords[matches[i]];
+
+        bool is_suppressed = false;
+        for (int32 j = 0; j < match_count; ++j) {
+            const HotkeyChord* const other = &index->chords[matches[j]];
+            if (other->key_count > chord->key_count && hotkey_chord_is_subset(chord, other)) {
+                is_suppressed = true;
+                break;
             }
+        }
 
-            state->active_hotkeys[active_hotkeys++] = hotkey_idx;
+        // Hotkey enums start at 1
+        const uint16 hotkey = (uint16) (matches[i] % input->hotkey_count + 1);
+        if (is_suppressed || hotkey_is_active(state->active_hotkeys, hotkey)) {
+            continue;
         }
+
+        state->active_hotkeys[active_hotkeys++] = hotkey;
     }
 
+    input_key_taps_record(state);
     input_clean_state(state->active_keys);
 
-    // @bug how to handle priority? e.g. there might be a hotkey for 1 and one for alt+1
-    //      in this case only the hotkey for alt+1 should be triggered
     // @bug how to handle other conditions besides buttons pressed together? some hotkeys are only available in certain situations
     // @bug how to handle values (e.g. stick may or may not set the x/y or dx/dy in some situations)
     // @bug how to allow rebinding/swapping of left and right stick? (maybe create handful of events e.g. set dx/dy that fire based on the input?)
@@ -39,6 +39,13 @@ enum InputType : byte {
 // @todo This should probably be a setting
 #define INPUT_LONG_PRESS_DURATION 250
 
+// Max time between two presses of the same key to count as double tap (ms)
+// @todo This should probably be a setting
+#define INPUT_DOUBLE_TAP_DURATION 250
+
+// Every key (keyboard, mouse, controller) has a bit in the key bitsets, see input_key_bit()
+#define INPUT_KEY_BITS 512
+
 enum InputMouseAction {
     INPUT_MOUSE_BUTTON_1 = 1,
     INPUT_MOUSE_BUTTON_2 = 2,
@@ -83,6 +90,9 @@ enum KeyPressType : byte {
     KEY_PRESS_TYPE_PRESSED,
     KEY_PRESS_TYPE_HELD,
     KEY_PRESS_TYPE_RELEASED,
+
+    // Only used by hotkeys, the key was pressed twice within INPUT_DOUBLE_TAP_DURATION
+    KEY_PRESS_TYPE_DOUBLE_TAPPED,
 };
 
 // This is probably never used but serves as a general idea how to handle input context
@@ -123,6 +133,40 @@ struct InputKey {
     bool is_processed;
     int16 value; // e.g. stick/trigger keys have additional values
     uint64 time; // when was this action performed (useful to decide if key state is held vs pressed)
+
+    // When was the key pressed down, other than time this is not updated by repeated key events
+    uint64 time_down;
+
+    // 0 = not evaluated yet, 1 = single press, 2 = double tap
+    byte tap_count;
+};
+
+// Press of a key that got released already, used for the double tap detection
+struct InputKeyTap {
+    uint16 scan_code;
+    uint64 time_down;
+};
+
+// Pre-computed hotkey for the matching
+struct HotkeyChord {
+    // Bit index of the required keys, see input_key_bit()
+    int16 key_bits[MAX_HOTKEY_COMBINATION];
+    byte key_count;
+    KeyPressType key_state;
+};
+
+// Inverted index key -> hotkeys
+// Every hotkey is only stored for one of its keys, since a hotkey can only be active if all of its keys are active.
+// This way the matching only depends on the amount of active keys and not on the amount of hotkeys
+struct HotkeyIndex {
+    // candidates[key_offsets[bit]] to candidates[key_offsets[bit + 1]] are the hotkeys of a key
+    uint16 key_offsets[INPUT_KEY_BITS + 1];
+
+    // Index into the chords array: index < hotkey_count = input_mapping1, else input_mapping2
+    uint16* candidates;
+
+    // 2 * hotkey_count, one chord per mapping
+    HotkeyChord* chords;
 };
 
 // @question Maybe we should also add a third key_down array for controllers and some special controller functions here to just handle everything in one struct
@@ -136,6 +180,10 @@ struct InputState {
     // Active keys
     alignas(8) InputKey active_keys[MAX_KEY_PRESSES];
 
+    // Recently released keys (ring)
+    InputKeyTap recent_taps[MAX_KEY_PRESSES];
+    int32 recent_tap_index;
+
     // Usually used by controllers
     // E.g. index 0 = primary stick or mouse, index 1 = secondary stick, index 2 = thumb trackpad
     int16 dx[3];
@@ -211,6 +259,9 @@ struct Input {
     Hotkey* input_mapping1;
     Hotkey* input_mapping2;
 
+    // Needs to be re-built with input_hotkey_index_build() after changing the mappings
+    HotkeyIndex hotkey_index;
+
     // This contains a full list off REFERENCES to hotkey events
     // The length of this array is the exact amount of possible hotkeys
     // It doesn't hold the actual event but a REFERENCE to it
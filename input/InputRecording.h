@@ -0,0 +1,417 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_INPUT_RECORDING_H
+#define COMS_INPUT_RECORDING_H
+
+#include "../stdlib/Stdlib.h"
+#include "../log/Log.h"
+#include "../system/Allocator.h"
+#include "../utils/TimeUtils.h"
+#include "Input.cpp"
+
+// Records the input of a session and plays it back frame by frame
+// The replay feeds the exact same key events, pointer states and commands with the exact same timestamps into the input.
+// This makes it possible to run the same session headless in different builds and compare the timings.
+//
+// File layout - binary (little endian)
+//      uint32 magic
+//      uint16 version
+//      uint16 reserved
+//      uint64 start time (microseconds)
+//      Records until INPUT_RECORD_END, every record starts with the InputRecordType:
+//          FRAME       uint32 dt, byte general_states                      (ends a frame)
+//          KEY         uint16 scan_code, uint16 virtual_code, byte key_state, int16 value, uint32 dt
+//          POINTER     byte index, int16 x, int16 y, int16 dx, int16 dy    (only if changed)
+//          COMMAND     byte type, uint16 size, byte payload[size]
+//
+// All dt values are relative to the previous frame, the records of a frame come before its FRAME record.
+#define INPUT_RECORDING_MAGIC 0x49534D4F // OMSI
+#define INPUT_RECORDING_VERSION 1
+#define INPUT_RECORDING_HEADER_SIZE 16
+
+enum InputRecordType : byte {
+    INPUT_RECORD_END,
+    INPUT_RECORD_FRAME,
+    INPUT_RECORD_KEY,
+    INPUT_RECORD_POINTER,
+    INPUT_RECORD_COMMAND,
+};
+
+struct InputRecorder {
+    byte* data;
+    size_t size;
+    size_t capacity;
+
+    // Time of the previous frame
+    uint64 frame_time;
+
+    // Last recorded pointer state
+    int16 x[3];
+    int16 y[3];
+    int16 dx[3];
+    int16 dy[3];
+
+    // The capacity was exceeded, the recording stops at the last complete frame
+    bool is_full;
+};
+
+struct InputReplay {
+    const byte* data;
+    size_t size;
+    size_t pos;
+
+    uint64 frame_time;
+    uint32 frame_count;
+};
+
+/**
+ * Called for every recorded command during the replay
+ *
+ * @param void* data General data to pass to the command function
+ * @param uint8 type Command type (e.g. AppCommandType)
+ */
+typedef void (*InputReplayCommandFunc)(void* data, uint8 type, const byte* payload, uint16 size);
+
+// Runs one frame of the application, input already contains the state of this frame
+typedef void (*InputReplayFrameFunc)(void* data, Input* input, uint64 time);
+
+struct InputReplayStats {
+    uint32 frame_count;
+
+    // Wall clock time of the frames (microseconds)
+    uint64 time_total;
+    uint64 time_min;
+    uint64 time_max;
+};
+
+inline
+void input_recorder_alloc(InputRecorder* rec, size_t capacity, uint64 time) NO_EXCEPT
+{
+    ASSERT_TRUE(capacity > INPUT_RECORDING_HEADER_SIZE + 1);
+
+    memset(rec, 0, sizeof(*rec));
+    rec->data = (byte *) platform_alloc_aligned(capacity, capacity, 64);
+    rec->capacity = capacity;
+    rec->frame_time = time;
+
+    byte* pos = rec->data;
+    pos = write_le(pos, (uint32) INPUT_RECORDING_MAGIC);
+    pos = write_le(pos, (uint16) INPUT_RECORDING_VERSION);
+    pos = write_le(pos, (uint16) 0);
+    write_le(pos, time);
+
+    rec->size = INPUT_RECORDING_HEADER_SIZE;
+
+    // The end marker is always written, this way the data is a valid recording at any point in time
+    rec->data[rec->size] = INPUT_RECORD_END;
+}
+
+inline
+void input_recorder_free(InputRecorder* rec) NO_EXCEPT
+{
+    platform_aligned_free((void **) &rec->data);
+    rec->size = 0;
+    rec->capacity = 0;
+}
+
+// Size of the recording including the end marker (= size to write to a file)
+FORCE_INLINE
+size_t input_recording_size(const InputRecorder* rec) NO_EXCEPT
+{
+    return rec->size + 1;
+}
+
+static inline
+byte* input_record_reserve(InputRecorder* rec, size_t size) NO_EXCEPT
+{
+    // + 1 for the end marker
+    if (rec->is_full || rec->size + size + 1 > rec->capacity) { UNLIKELY
+        if (!rec->is_full) {
+            LOG_1("[WARNING] Input recording is full");
+        }
+
+        rec->is_full = true;
+
+        return NULL;
+    }
+
+    byte* pos = rec->data + rec->size;
+    rec->size += size;
+    rec->data[rec->size] = INPUT_RECORD_END;
+
+    return pos;
+}
+
+FORCE_INLINE
+uint32 input_record_dt(uint64 frame_time, uint64 time) NO_EXCEPT
+{
+    return time <= frame_time ? 0 : (uint32) OMS_MIN(time - frame_time, (uint64) 0xFFFFFFFF);
+}
+
+// Has to be called for every key that is passed to input_set_state()
+inline
+void input_record_key(InputRecorder* rec, const InputKey* key) NO_EXCEPT
+{
+    byte* pos = input_record_reserve(rec, 12);
+    if (!pos) {
+        return;
+    }
+
+    *pos++ = INPUT_RECORD_KEY;
+    pos = write_le(pos, key->scan_code);
+    pos = write_le(pos, key->virtual_code);
+    *pos++ = key->key_state;
+    pos = write_le(pos, key->value);
+    write_le(pos, input_record_dt(rec->frame_time, key->time));
+}
+
+// Records a command that must be re-issued during the replay (e.g. an AppCommand, see app_cmd_record())
+inline
+void input_record_command(InputRecorder* rec, uint8 type, const void* payload, uint16 size) NO_EXCEPT
+{
+    byte* pos = input_record_reserve(rec, 4 + size);
+    if (!pos) {
+        return;
+    }
+
+    *pos++ = INPUT_RECORD_COMMAND;
+    *pos++ = type;
+    pos = write_le(pos, size);
+    memcpy(pos, payload, size);
+}
+
+/**
+ * Ends the frame
+ *
+ * Must be called once per frame before input_hotkey_state()
+ *
+ * @param rec   Recorder
+ * @param input Input after all input events of this frame got handled
+ * @param time  Frame time (same time as used for input_hotkey_state())
+ */
+void input_record_frame(InputRecorder* rec, const Input* input, uint64 time) NO_EXCEPT
+{
+    const InputState* const state = &input->state;
+
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(state->x); ++i) {
+        if (state->x[i] == rec->x[i] && state->y[i] == rec->y[i]
+            && state->dx[i] == rec->dx[i] && state->dy[i] == rec->dy[i]
+        ) {
+            continue;
+        }
+
+        byte* pos = input_record_reserve(rec, 10);
+        if (!pos) {
+            return;
+        }
+
+        *pos++ = INPUT_RECORD_POINTER;
+        *pos++ = (byte) i;
+        pos = write_le(pos, state->x[i]);
+        pos = write_le(pos, state->y[i]);
+        pos = write_le(pos, state->dx[i]);
+        write_le(pos, state->dy[i]);
+
+        rec->x[i] = state->x[i];
+        rec->y[i] = state->y[i];
+        rec->dx[i] = state->dx[i];
+        rec->dy[i] = state->dy[i];
+    }
+
+    byte* pos = input_record_reserve(rec, 6);
+    if (!pos) {
+        return;
+    }
+
+    *pos++ = INPUT_RECORD_FRAME;
+    pos = write_le(pos, input_record_dt(rec->frame_time, time));
+    *pos = input->general_states;
+
+    rec->frame_time = time;
+}
+
+// The data is only referenced and must outlive the replay (e.g. memory mapped file)
+inline
+bool input_replay_init(InputReplay* replay, const byte* data, size_t size) NO_EXCEPT
+{
+    memset(replay, 0, sizeof(*replay));
+
+    uint32 magic;
+    uint16 version;
+
+    if (!data || size < INPUT_RECORDING_HEADER_SIZE + 1
+        || (read_le(data, &magic), magic != INPUT_RECORDING_MAGIC)
+        || (read_le(data + sizeof(uint32), &version), version != INPUT_RECORDING_VERSION)
+    ) {
+        LOG_1("[WARNING] Invalid input recording");
+        return false;
+    }
+
+    read_le(data + 8, &replay->frame_time);
+
+    replay->data = data;
+    replay->size = size;
+    replay->pos = INPUT_RECORDING_HEADER_SIZE;
+
+    return true;
+}
+
+/**
+ * Applies the next recorded frame to the input
+ *
+ * @param replay    Replay
+ * @param input     Input that receives the key events and pointer state
+ * @param time      Frame time, use this time for input_hotkey_state() and the frame update
+ * @param cmd_func  Called for every recorded command (can be NULL)
+ * @param data      Passed to cmd_func
+ *
+ * @return false if there is no further frame
+ */
+bool input_replay_frame(
+    InputReplay* replay,
+    Input* input,
+    uint64* time,
+    InputReplayCommandFunc cmd_func = NULL,
+    void* data = NULL
+) NO_EXCEPT
+{
+    const byte* const end = replay->data + replay->size;
+
+    while (replay->pos < replay->size) {
+        const byte* pos = replay->data + replay->pos;
+        const InputRecordType type = (InputRecordType) *pos++;
+
+        switch (type) {
+            case INPUT_RECORD_END:
+                return false;
+            case INPUT_RECORD_FRAME: {
+                if (end - pos < 5) {
+                    goto TRUNCATED;
+                }
+
+                uint32 dt;
+                pos = read_le(pos, &dt);
+
+                input->general_states = *pos++;
+
+                replay->frame_time += dt;
+                replay->pos = pos - replay->data;
+                ++replay->frame_count;
+
+                *time = replay->frame_time;
+
+                return true;
+            }
+            case INPUT_RECORD_KEY: {
+                if (end - pos < 11) {
+                    goto TRUNCATED;
+                }
+
+                InputKey key = {};
+                pos = read_le(pos, &key.scan_code);
+                pos = read_le(pos, &key.virtual_code);
+                key.key_state = (KeyPressType) *pos++;
+                pos = read_le(pos, &key.value);
+
+                uint32 dt;
+                pos = read_le(pos, &dt);
+                key.time = replay->frame_time + dt;
+
+                input_set_state(input->state.active_keys, &key);
+            } break;
+            case INPUT_RECORD_POINTER: {
+                if (end - pos < 9 || *pos >= (int32) ARRAY_COUNT(input->state.x)) {
+                    goto TRUNCATED;
+                }
+
+                const int32 i = *pos++;
+                pos = read_le(pos, &input->state.x[i]);
+                pos = read_le(pos, &input->state.y[i]);
+                pos = read_le(pos, &input->state.dx[i]);
+                pos = read_le(pos, &input->state.dy[i]);
+            } break;
+            case INPUT_RECORD_COMMAND: {
+                if (end - pos < 3) {
+                    goto TRUNCATED;
+                }
+
+                const uint8 cmd_type = *pos++;
+
+                uint16 size;
+                pos = read_le(pos, &size);
+
+                if (end - pos < size) {
+                    goto TRUNCATED;
+                }
+
+                if (cmd_func) {
+                    cmd_func(data, cmd_type, pos, size);
+                }
+
+                pos += size;
+            } break;
+            default:
+                goto TRUNCATED;
+        }
+
+        replay->pos = pos - replay->data;
+    }
+
+    return false;
+
+    TRUNCATED:
+    LOG_1("[WARNING] Corrupted input recording");
+    replay->pos = replay->size;
+
+    return false;
+}
+
+/**
+ * Headless replay driver, runs all recorded frames as fast as possible
+ *
+ * Every frame: recorded input -> input_hotkey_state() -> frame_func
+ * The time passed to the application is the recorded time, only the stats use the wall clock.
+ */
+void input_replay_run(
+    InputReplay* replay,
+    Input* input,
+    InputReplayFrameFunc frame_func,
+    InputReplayCommandFunc cmd_func,
+    void* data,
+    InputReplayStats* stats
+) NO_EXCEPT
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->time_min = (uint64) -1;
+
+    uint64 time;
+    while (true) {
+        const uint64 start = time_mu();
+
+        if (!input_replay_frame(replay, input, &time, cmd_func, data)) {
+            break;
+        }
+
+        input_hotkey_state(input, time);
+        frame_func(data, input, time);
+
+        const uint64 duration = time_mu() - start;
+        stats->time_total += duration;
+        stats->time_min = OMS_MIN(stats->time_min, duration);
+        stats->time_max = OMS_MAX(stats->time_max, duration);
+        ++stats->frame_count;
+    }
+
+    if (!stats->frame_count) {
+        stats->time_min = 0;
+    }
+}
+
+#endif
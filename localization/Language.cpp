@@ -5,8 +5,120 @@
 #include "../stdlib/Stdlib.h"
 #include "../memory/RingMemory.cpp"
 #include "../system/FileUtils.cpp"
+#include "../hash/GeneralHash.h"
 #include "Language.h"
 
+#define LANGUAGE_HEADER_SIZE (2 * sizeof(int32))
+
+FORCE_INLINE
+int32 language_data_size(const Language* language) NO_EXCEPT
+{
+    return (int32) (LANGUAGE_HEADER_SIZE
+        + language->count * sizeof(uint32)
+        + language->size
+    );
+}
+
+// Max size of the binary data created from a text file of a certain length
+FORCE_INLINE
+int32 language_data_size_max(int32 count, size_t txt_length) NO_EXCEPT
+{
+    return (int32) (LANGUAGE_HEADER_SIZE + count * sizeof(uint32) + txt_length + 1);
+}
+
+static inline
+void language_bind(Language* language, byte* data) NO_EXCEPT
+{
+    language->data = data;
+    language->offsets = (const uint32 *) (data + LANGUAGE_HEADER_SIZE);
+    language->strings = (const char *) (language->offsets + language->count);
+}
+
+/**
+ * Creates the binary language data from a text file
+ *
+ * Text elements are separated by an empty line ("\n\n"), a single "\n" is part of the text element
+ *
+ * @param language  Language, language->data must have language_data_size_max() bytes available
+ * @param txt       Text file content
+ * @param length    Text length
+ * @param ring      Temp memory for the de-duplication
+ */
+void language_from_txt(
+    Language* language,
+    const char* txt,
+    size_t length,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    // Ignore the new line at the end of the file
+    if (length && txt[length - 1] == '\n') {
+        --length;
+    }
+
+    // count elements
+    int32 count = 1;
+    for (size_t i = 0; i + 1 < length; ++i) {
+        if (txt[i] == '\n' && txt[i + 1] == '\n') {
+            ++count;
+            ++i;
+        }
+    }
+
+    language->count = count;
+
+    // Temporarily bind for writing
+    byte* const data = language->data;
+    uint32* const offsets = (uint32 *) (data + LANGUAGE_HEADER_SIZE);
+    char* const strings = (char *) (offsets + count);
+
+    // Hash table of the unique strings (string offsets), used for the de-duplication
+    const int32 table_size = (int32) align_up(count * 2, 64);
+    int32* table = (int32 *) memory_get(ring, table_size * sizeof(int32), sizeof(int32));
+    memset(table, -1, table_size * sizeof(int32));
+
+    uint32 size = 0;
+    size_t start = 0;
+
+    for (int32 i = 0; i < count; ++i) {
+        size_t end = start;
+        while (end < length && !(txt[end] == '\n' && end + 1 < length && txt[end + 1] == '\n')) {
+            ++end;
+        }
+
+        const size_t str_length = end - start;
+        const uint64 hash = hash_murmur3_64(txt + start, str_length);
+
+        int32 slot = (int32) (hash % table_size);
+        while (table[slot] >= 0
+            && (strncmp(strings + table[slot], txt + start, str_length) != 0
+                || strings[table[slot] + str_length] != '\0')
+        ) {
+            slot = (slot + 1) % table_size;
+        }
+
+        if (table[slot] < 0) {
+            memcpy(strings + size, txt + start, str_length);
+            strings[size + str_length] = '\0';
+
+            table[slot] = (int32) size;
+            size += (uint32) str_length + 1;
+        }
+
+        offsets[i] = (uint32) table[slot];
+
+        // We have to move by 2 since every text element is separated by 2 \n
+        start = end + 2;
+    }
+
+    language->size = (int32) size;
+
+    write_le(data, language->count);
+    write_le(data + sizeof(int32), language->size);
+
+    language_bind(language, data);
+}
+
 void language_from_file_txt(
     Language* language,
     const char* path,
@@ -17,55 +129,64 @@ void language_from_file_txt(
     file_read(path, &file, ring);
     ASSERT_TRUE(file.size);
 
-    // count elements
-    language->count = 1;
-    int32 len = 0;
+    language_from_txt(language, (const char *) file.content, file.size, ring);
+}
+
+/**
+ * References the binary language data without copying it
+ *
+ * The data can be a memory mapped file region or the asset archive memory and must outlive the language.
+ * The offsets are used as they are, which is why this is only possible on little endian systems.
+ *
+ * @return Size of the language data or 0 if the data is invalid
+ */
+int32 language_map(
+    const byte* data,
+    size_t length,
+    Language* language
+) NO_EXCEPT
+{
+    #if !_WIN32 && !__LITTLE_ENDIAN__
+        // @todo Implement, we would have to copy and swap the offsets
+        return 0;
+    #endif
 
-    byte* data = file.content;
+    if (!data || length < LANGUAGE_HEADER_SIZE) {
+        LOG_1("[WARNING] No language data provided to load");
+        return 0;
+    }
 
-    while (data[len] != '\0') {
-        if (data[len] == '\n' && data[len + 1] == '\n') {
-            ++language->count;
-            data[len] = '\0';
-            ++len;
-        }
+    read_le(data, &language->count);
+    read_le(data + sizeof(int32), &language->size);
 
-        ++len;
+    if (language->count < 0 || language->size < 0
+        || LANGUAGE_HEADER_SIZE + (uint64) language->count * sizeof(uint32) + language->size > length
+        || ((uintptr_t) data & (sizeof(uint32) - 1))
+    ) {
+        LOG_1("[WARNING] Invalid language data");
+        return 0;
     }
 
-    language->size = len;
-    language->lang = (char **) language->data;
-    memcpy(language->data + language->count * sizeof(char *), data, len);
-
-    // First element = 0
-    // @question can we use offsets instead of pointers?
-    char** pos = language->lang;
-    *pos++ = (char *) data;
-
-    for (int i = 1; i < len - 1; ++i) {
-        if (data[i] == '\0') {
-            // We have to move by 2 since every text element is separated by 2 \n
-            // 1 \n is a valid char for a single text element
-            // @performance This also means that we have one additional byte for
-            // every text element even in the binary version.
-            *pos++ = (char *) &data[i + 2];
+    language_bind(language, (byte *) data);
+
+    // Every string must start and end inside the string data
+    if (language->count && (!language->size || language->strings[language->size - 1] != '\0')) {
+        LOG_1("[WARNING] Invalid language data");
+        return 0;
+    }
+
+    for (int32 i = 0; i < language->count; ++i) {
+        if (language->offsets[i] >= (uint32) language->size) {
+            LOG_1("[WARNING] Invalid language data");
+            return 0;
         }
     }
-}
 
-FORCE_INLINE
-int32 language_data_size(const Language* language) NO_EXCEPT
-{
-    return (int32) (language->size
-        + sizeof(language->count)
-        + sizeof(language->size)
-        + language->count * sizeof(uint32)
-    );
+    return language_data_size(language);
 }
 
-// File layout - binary
-// offsets for start of strings
-// actual string data
+// Copies the binary data into language->data
+// This is a single memcpy, the offsets remain offsets
 int32 language_from_data(
     const byte* data,
     Language* language
@@ -78,29 +199,19 @@ int32 language_from_data(
 
     LOG_3("[INFO] Load language");
 
-    const byte* pos = data;
+    read_le(data, &language->count);
+    read_le(data + sizeof(int32), &language->size);
 
-    pos = read_le(pos, &language->count);
-    pos = read_le(pos, &language->size);
+    memcpy(language->data, data, language_data_size(language));
 
-    language->lang = (char **) language->data;
-    char** pos_lang = language->lang;
-
-    const byte* const start = language->data;
-
-    // Load pointers/offsets
-    for (int32 i = 0; i < language->count; ++i) {
-        uint32 offset;
-        pos = read_le(pos, &offset);
-
-        *pos_lang++ = (char *) (start + offset);
-    }
+    #if !_WIN32 && !__LITTLE_ENDIAN__
+        uint32* offsets = (uint32 *) (language->data + LANGUAGE_HEADER_SIZE);
+        for (int32 i = 0; i < language->count; ++i) {
+            offsets[i] = SWAP_ENDIAN_LITTLE(offsets[i]);
+        }
+    #endif
 
-    memcpy(
-        language->data + language->count * sizeof(uint32),
-        pos,
-        language->size
-    );
+    language_bind(language, language->data);
 
     return language_data_size(language);
 }
@@ -115,21 +226,13 @@ int32 language_to_data(
     pos = write_le(pos, language->count);
     pos = write_le(pos, language->size);
 
-    const byte* const start = pos;
-
-    // Save pointers
     for (int32 i = 0; i < language->count; ++i) {
-        pos = write_le(pos, (uint32) ((uintptr_t) pos - (uintptr_t) start));
+        pos = write_le(pos, language->offsets[i]);
     }
 
-    // Save actual strings
-    memcpy(
-        pos,
-        language->data + language->count * sizeof(uint32),
-        language->size
-    );
+    memcpy(pos, language->strings, language->size);
 
     return language_data_size(language);
 }
 
-#endif
\ No newline at end of file
+#endif
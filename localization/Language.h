@@ -4,19 +4,60 @@
 
 #include "../stdlib/Stdlib.h"
 
-#define LANGUAGE_VERSION 1
+#define LANGUAGE_VERSION 2
 
+// File layout - binary (little endian)
+//      int32 count
+//      int32 size                  size of the string pool
+//      uint32 offsets[count]       offset of every string into the string pool
+//      char strings[size]          null terminated strings, identical strings are only stored once
+//
+// The struct only references the binary data, it doesn't matter if the data is a copy or a memory mapped file
 // Size is limited to 4GB
 struct Language {
-    // WARNING: the actual start of data is data -= sizeof(Language); see file loading below
-    // The reason for this is we store the Language struct in the beginning of the data/file
+    // Start of the binary data (including the header)
     byte* data;
 
     int32 count;
     int32 size;
 
-    // @performance Consider to use offsets instead of pointers
-    char** lang;
+    const uint32* offsets;
+    const char* strings;
 };
 
-#endif
\ No newline at end of file
+FORCE_INLINE
+const char* language_string(const Language* language, int32 id) NO_EXCEPT
+{
+    ASSERT_TRUE(id >= 0 && id < language->count);
+
+    return language->strings + language->offsets[id];
+}
+
+// The UI only stores string ids and resolves them through the active language
+// -> switching the language is a pointer swap, cached ids remain valid.
+// Caches that depend on the text content (e.g. text layout) compare the version to find out if they are outdated.
+struct LanguageState {
+    const Language* active;
+    uint32 version;
+};
+
+inline
+void language_activate(LanguageState* state, const Language* language) NO_EXCEPT
+{
+    state->active = language;
+    ++state->version;
+}
+
+// Unknown ids (e.g. the new language is missing strings) return an empty string instead of failing
+FORCE_INLINE
+const char* language_text(const LanguageState* state, int32 id) NO_EXCEPT
+{
+    const Language* language = state->active;
+    if (!language || id < 0 || id >= language->count) { UNLIKELY
+        return "";
+    }
+
+    return language->strings + language->offsets[id];
+}
+
+#endif
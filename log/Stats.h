@@ -38,6 +38,14 @@
         // Asset information
         DEBUG_COUNTER_AUDIO_COUNT,
 
+        // Database pool
+        DEBUG_COUNTER_DB_POOL_ACQUIRE,
+        DEBUG_COUNTER_DB_POOL_WAIT,
+        DEBUG_COUNTER_DB_POOL_TIMEOUT,
+        DEBUG_COUNTER_DB_POOL_RECONNECT,
+        DEBUG_COUNTER_DB_POOL_WAIT_TIME, // in us
+        DEBUG_COUNTER_DB_POOL_MAX_WAIT_TIME, // in us
+
         // Used to describe the open handles
         DEBUG_COUNTER_FILE_HANDLE_COUNT,
         DEBUG_COUNTER_LIB_HANDLE_COUNT,
@@ -12,319 +12,562 @@
 
 #include "../stdlib/Stdlib.h"
 #include "../utils/StringUtils.h"
+#include "../stdlib/Simd.h"
 
 #define EVALUATOR_MAX_STACK_SIZE 16
 
-// Stack for operators
-struct EvaluatorOperatorStack {
-    char items[EVALUATOR_MAX_STACK_SIZE];
-    int32 top;
+// Expressions are compiled to RPN bytecode, variables are bound to slots.
+// For formulas that are evaluated many times (skill formulas, stat scaling)
+// compile the expression once and only run the program:
+//
+//      const char* slots[] = {"level", "str"};
+//      EvaluatorProgram program;
+//      evaluator_compile(&program, "level * 2 + max(str, 10)", ARRAY_COUNT(slots), slots);
+//
+//      f32 values[] = {10, 12};
+//      f32 result = evaluator_run(&program, values);
+//
+//      // SoA input: inputs[slot][i]
+//      evaluator_run_batch(&program, inputs, results, count);
+
+#define EVALUATOR_PROGRAM_MAX_INSTRUCTIONS 128
+#define EVALUATOR_PROGRAM_MAX_CONSTANTS 32
+#define EVALUATOR_PROGRAM_MAX_SLOTS 16
+
+// Elements per block in evaluator_run_batch()
+#define EVALUATOR_BATCH_BLOCK 64
+
+enum EvaluatorOpcode : byte {
+    EVALUATOR_OP_CONST,
+    EVALUATOR_OP_SLOT,
+    EVALUATOR_OP_ADD,
+    EVALUATOR_OP_SUB,
+    EVALUATOR_OP_MUL,
+    EVALUATOR_OP_DIV,
+    EVALUATOR_OP_NEG,
+    EVALUATOR_OP_MIN,
+    EVALUATOR_OP_MAX,
+    EVALUATOR_OP_SQRT,
+    EVALUATOR_OP_ABS,
 };
 
-// Stack for values
-struct EvaluatorValueStack {
-    f32 items[EVALUATOR_MAX_STACK_SIZE];
-    int32 top;
-};
+struct EvaluatorInstruction {
+    EvaluatorOpcode op;
 
-struct EvaluatorVariable {
-    char name[8];
-    f32 value;
+    // Constant index or slot index
+    uint16 arg;
 };
 
-// Stack operations
-void evaluator_push_operator(EvaluatorOperatorStack* stack, char op) {
-    if (stack->top >= EVALUATOR_MAX_STACK_SIZE - 1) {
-        return;
-    }
-
-    stack->items[++stack->top] = op;
-}
+// RPN bytecode
+struct EvaluatorProgram {
+    EvaluatorInstruction code[EVALUATOR_PROGRAM_MAX_INSTRUCTIONS];
+    int32 code_length;
 
-char evaluator_pop_operator(EvaluatorOperatorStack* stack) {
-    ASSERT_TRUE(stack->top >= 0);
+    f32 constants[EVALUATOR_PROGRAM_MAX_CONSTANTS];
+    int32 constant_count;
 
-    return stack->items[stack->top--];
-}
+    int32 slot_count;
 
-char evaluator_peek_operator(EvaluatorOperatorStack* stack) {
-    if (stack->top < 0) {
-        return '\0';
-    }
-
-    return stack->items[stack->top];
-}
+    // Max stack depth during the execution
+    int32 stack_size;
+};
 
-void evaluator_push_value(EvaluatorValueStack* stack, f32 value) {
-    if (stack->top >= EVALUATOR_MAX_STACK_SIZE - 1) {
-        return;
-    }
+struct EvaluatorCompiler {
+    const char* pos;
+    EvaluatorProgram* program;
 
-    stack->items[++stack->top] = value;
-}
+    int32 slot_count;
+    const char* const* slot_names;
 
-f32 evaluator_pop_value(EvaluatorValueStack* stack) {
-    ASSERT_TRUE(stack->top >= 0);
+    int32 depth;
+    bool error;
+};
 
-    return stack->items[stack->top--];
+static inline
+void evaluator_compiler_skip_whitespace(EvaluatorCompiler* compiler) NO_EXCEPT
+{
+    while (*compiler->pos == ' ' || *compiler->pos == '\t') {
+        ++compiler->pos;
+    }
 }
 
-// Precedence of operators
-int32 evaluator_precedence(char op) {
+static inline
+int32 evaluator_opcode_arity(EvaluatorOpcode op) NO_EXCEPT
+{
     switch (op) {
-        case '+':
-        case '-':
+        case EVALUATOR_OP_CONST:
+        case EVALUATOR_OP_SLOT:
+            return 0;
+        case EVALUATOR_OP_NEG:
+        case EVALUATOR_OP_SQRT:
+        case EVALUATOR_OP_ABS:
             return 1;
-        case '*':
-        case '/':
-            return 2;
-        case 'u': // Unary minus
-            return 3;
         default:
-            return 0;
+            return 2;
     }
 }
 
-// Apply an operator to one or two values
-f32 evaluator_apply_operator(char op, f32 a, f32 b) {
+static inline
+f32 evaluator_opcode_apply(EvaluatorOpcode op, f32 a, f32 b) NO_EXCEPT
+{
     switch (op) {
-        case '+':
+        case EVALUATOR_OP_ADD:
             return a + b;
-        case '-':
+        case EVALUATOR_OP_SUB:
             return a - b;
-        case '*':
+        case EVALUATOR_OP_MUL:
             return a * b;
-        case '/':
+        case EVALUATOR_OP_DIV:
             return a / b;
-        case 'u': // Unary minus
+        case EVALUATOR_OP_NEG:
             return -a;
-        default: {
+        case EVALUATOR_OP_MIN:
+            return a < b ? a : b;
+        case EVALUATOR_OP_MAX:
+            return a > b ? a : b;
+        case EVALUATOR_OP_SQRT:
+            return sqrtf(a);
+        case EVALUATOR_OP_ABS:
+            return fabsf(a);
+        default:
             UNREACHABLE();
-        }
     }
 }
 
-f32 evaluator_evaluate_function(const char* name, const char* args);
-
-// Shunting-yard algorithm to evaluate the expression
-f32 evaluator_evaluate_expression(const char* expr) {
-    EvaluatorOperatorStack operators = { {} /*.items = */, -1 /*.top = */ };
-    EvaluatorValueStack values = { {} /*.items = */, -1 /*.top = */ };
-
-    const char* ptr = expr;
-    while (*ptr) {
-        if (isdigit(*ptr) || *ptr == '.') {
-            // Parse number
-            const char* end;
-            f32 value = str_to_float(ptr, &end);
-            evaluator_push_value(&values, value);
-            ptr = end;
-        } else if (isalpha(*ptr)) {
-            // Parse function
-            const char* start = ptr;
-            while (isalnum(*ptr)) {
-                ++ptr;
-            }
+static
+void evaluator_compiler_emit(EvaluatorCompiler* compiler, EvaluatorOpcode op, uint16 arg = 0) NO_EXCEPT
+{
+    EvaluatorProgram* program = compiler->program;
+    const int32 arity = evaluator_opcode_arity(op);
+
+    // Constant folding, operations on constants are evaluated during the compilation
+    if (arity > 0
+        && program->code_length >= arity
+        && program->code[program->code_length - 1].op == EVALUATOR_OP_CONST
+        && (arity == 1 || program->code[program->code_length - 2].op == EVALUATOR_OP_CONST)
+    ) {
+        EvaluatorInstruction* first = &program->code[program->code_length - arity];
+        const f32 a = program->constants[first->arg];
+        const f32 b = arity == 2 ? program->constants[program->code[program->code_length - 1].arg] : 0.0f;
+
+        program->constants[first->arg] = evaluator_opcode_apply(op, a, b);
+
+        // The second constant is always the last one in the constant pool
+        program->code_length -= arity - 1;
+        program->constant_count -= arity - 1;
+        compiler->depth -= arity - 1;
 
-            ASSERT_TRUE(*ptr == '(');
+        return;
+    }
 
-            ++ptr;
-            const char* args_start = ptr;
-            int32 depth = 1;
-            while (*ptr && depth > 0) {
-                if (*ptr == '(') {
-                    ++depth;
-                } else if (*ptr == ')') {
-                    --depth;
-                }
+    if (program->code_length >= EVALUATOR_PROGRAM_MAX_INSTRUCTIONS) {
+        compiler->error = true;
 
-                ++ptr;
-            }
+        return;
+    }
 
-            ASSERT_TRUE(depth == 0);
-
-            char name[32];
-            memcpy(name, start, ptr - start);
-            name[ptr - start] = '\0';
-
-            char args[128];
-            memcpy(args, args_start, ptr - args_start);
-            args[ptr - args_start] = '\0';
-
-            f32 result = evaluator_evaluate_function(name, args);
-            evaluator_push_value(&values, result);
-        } else if (*ptr == '(') {
-            // Open parenthesis
-            evaluator_push_operator(&operators, *ptr);
-            ++ptr;
-        } else if (*ptr == ')') {
-            // Close parenthesis
-            while (evaluator_peek_operator(&operators) != '(') {
-                char op = evaluator_pop_operator(&operators);
-                f32 b = evaluator_pop_value(&values);
-                if (op == 'u') {
-                    evaluator_push_value(&values, evaluator_apply_operator(op, b, 0));
-                } else {
-                    f32 a = evaluator_pop_value(&values);
-                    evaluator_push_value(&values, evaluator_apply_operator(op, a, b));
-                }
-            }
+    program->code[program->code_length++] = {op, arg};
 
-            evaluator_pop_operator(&operators); // Remove '('
-            ++ptr;
-        } else if (strchr("+-*/", *ptr)) {
-            // Operator
-            char op = *ptr;
-            // Check if the operator is unary
-            if (op == '-' && (ptr == expr || *(ptr - 1) == '(' || strchr("+-*/", *(ptr - 1)))) {
-                op = 'u'; // Unary minus
-            }
+    compiler->depth += arity == 0 ? 1 : 1 - arity;
+    if (compiler->depth > program->stack_size) {
+        program->stack_size = compiler->depth;
+    }
 
-            while (evaluator_precedence(evaluator_peek_operator(&operators)) >= evaluator_precedence(op)) {
-                char top_op = evaluator_pop_operator(&operators);
-                f32 b = evaluator_pop_value(&values);
-                if (top_op == 'u') {
-                    evaluator_push_value(&values, evaluator_apply_operator(top_op, b, 0));
-                } else {
-                    f32 a = evaluator_pop_value(&values);
-                    evaluator_push_value(&values, evaluator_apply_operator(top_op, a, b));
-                }
-            }
+    if (program->stack_size > EVALUATOR_MAX_STACK_SIZE) {
+        compiler->error = true;
+    }
+}
 
-            evaluator_push_operator(&operators, op);
-            ++ptr;
-        } else {
-            UNREACHABLE();
+static
+void evaluator_compiler_emit_constant(EvaluatorCompiler* compiler, f32 value) NO_EXCEPT
+{
+    EvaluatorProgram* program = compiler->program;
+    if (program->constant_count >= EVALUATOR_PROGRAM_MAX_CONSTANTS) {
+        compiler->error = true;
+
+        return;
+    }
+
+    program->constants[program->constant_count] = value;
+    evaluator_compiler_emit(compiler, EVALUATOR_OP_CONST, (uint16) program->constant_count++);
+}
+
+static void evaluator_compile_expression(EvaluatorCompiler* compiler) NO_EXCEPT;
+
+// number | function(args) | variable | (expression)
+static
+void evaluator_compile_primary(EvaluatorCompiler* compiler) NO_EXCEPT
+{
+    evaluator_compiler_skip_whitespace(compiler);
+
+    const char* ptr = compiler->pos;
+    if (isdigit(*ptr) || *ptr == '.') {
+        const char* end;
+        evaluator_compiler_emit_constant(compiler, str_to_float(ptr, &end));
+        compiler->pos = end;
+
+        return;
+    }
+
+    if (*ptr == '(') {
+        ++compiler->pos;
+        evaluator_compile_expression(compiler);
+        evaluator_compiler_skip_whitespace(compiler);
+
+        if (*compiler->pos != ')') {
+            compiler->error = true;
+
+            return;
+        }
+
+        ++compiler->pos;
+
+        return;
+    }
+
+    if (!isalpha(*ptr)) {
+        compiler->error = true;
+
+        return;
+    }
+
+    while (isalnum(*compiler->pos) || *compiler->pos == '_') {
+        ++compiler->pos;
+    }
+
+    const int32 length = (int32) (compiler->pos - ptr);
+
+    evaluator_compiler_skip_whitespace(compiler);
+    if (*compiler->pos != '(') {
+        // Variable -> slot
+        for (int32 i = 0; i < compiler->slot_count; ++i) {
+            if (strncmp(ptr, compiler->slot_names[i], length) == 0
+                && compiler->slot_names[i][length] == '\0'
+            ) {
+                evaluator_compiler_emit(compiler, EVALUATOR_OP_SLOT, (uint16) i);
+
+                return;
+            }
         }
+
+        // Unknown variable
+        compiler->error = true;
+
+        return;
     }
 
-    // Process remaining operators
-    while (operators.top >= 0) {
-        char op = evaluator_pop_operator(&operators);
-        f32 b = evaluator_pop_value(&values);
-        if (op == 'u') {
-            evaluator_push_value(&values, evaluator_apply_operator(op, b, 0));
-        } else {
-            f32 a = evaluator_pop_value(&values);
-            evaluator_push_value(&values, evaluator_apply_operator(op, a, b));
+    EvaluatorOpcode op;
+    int32 arg_count;
+    if (length == 3 && strncmp(ptr, "min", 3) == 0) {
+        op = EVALUATOR_OP_MIN;
+        arg_count = 2;
+    } else if (length == 3 && strncmp(ptr, "max", 3) == 0) {
+        op = EVALUATOR_OP_MAX;
+        arg_count = 2;
+    } else if (length == 4 && strncmp(ptr, "sqrt", 4) == 0) {
+        op = EVALUATOR_OP_SQRT;
+        arg_count = 1;
+    } else if (length == 3 && strncmp(ptr, "abs", 3) == 0) {
+        op = EVALUATOR_OP_ABS;
+        arg_count = 1;
+    } else {
+        // Unknown function
+        compiler->error = true;
+
+        return;
+    }
+
+    ++compiler->pos;
+    for (int32 i = 0; i < arg_count; ++i) {
+        evaluator_compile_expression(compiler);
+        evaluator_compiler_skip_whitespace(compiler);
+
+        if (*compiler->pos != (i == arg_count - 1 ? ')' : ',')) {
+            compiler->error = true;
+
+            return;
         }
+
+        ++compiler->pos;
+    }
+
+    evaluator_compiler_emit(compiler, op);
+}
+
+// The precedence is defined by the compile functions, from high to low:
+//      primary -> unary minus (this function) -> * / (term) -> + - (expression)
+// e.g. -a * b is compiled as (-a) * b
+static
+void evaluator_compile_unary(EvaluatorCompiler* compiler) NO_EXCEPT
+{
+    evaluator_compiler_skip_whitespace(compiler);
+
+    if (*compiler->pos == '-') {
+        ++compiler->pos;
+        evaluator_compile_unary(compiler);
+        evaluator_compiler_emit(compiler, EVALUATOR_OP_NEG);
+
+        return;
     }
 
-    return evaluator_pop_value(&values);
+    evaluator_compile_primary(compiler);
 }
 
-// Evaluate built-in functions
-f32 evaluator_evaluate_function(const char* name, const char* args) {
-    if (strcmp(name, "min") == 0) {
-        const char* comma = strchr(args, ',');
-        if (!comma) {
-            return 0.0; // Invalid function call (min requires at least two arguments)
+static
+void evaluator_compile_term(EvaluatorCompiler* compiler) NO_EXCEPT
+{
+    evaluator_compile_unary(compiler);
+
+    while (!compiler->error) {
+        evaluator_compiler_skip_whitespace(compiler);
+
+        const char op = *compiler->pos;
+        if (op != '*' && op != '/') {
+            break;
         }
 
-        // Split the arguments into two expressions
-        char arg1[64], arg2[64];
-        memcpy(arg1, args, comma - args);
-        arg1[comma - args] = '\0';
-        strcpy(arg2, comma + 1);
-
-        // Recursively evaluate the arguments
-        const f32 val1 = evaluator_evaluate_expression(arg1);
-        const f32 val2 = evaluator_evaluate_expression(arg2);
-
-        return (val1 < val2) ? val1 : val2; // Return the minimum value
-    } else if (strcmp(name, "max") == 0) {
-        const char* comma = strchr(args, ',');
-        if (!comma) {
-            return 0.0; // Invalid function call (min requires at least two arguments)
+        ++compiler->pos;
+        evaluator_compile_unary(compiler);
+        evaluator_compiler_emit(compiler, op == '*' ? EVALUATOR_OP_MUL : EVALUATOR_OP_DIV);
+    }
+}
+
+static
+void evaluator_compile_expression(EvaluatorCompiler* compiler) NO_EXCEPT
+{
+    evaluator_compile_term(compiler);
+
+    while (!compiler->error) {
+        evaluator_compiler_skip_whitespace(compiler);
+
+        const char op = *compiler->pos;
+        if (op != '+' && op != '-') {
+            break;
         }
 
-        // Split the arguments into two expressions
-        char arg1[64], arg2[64];
-        memcpy(arg1, args, comma - args);
-        arg1[comma - args] = '\0';
-        strcpy(arg2, comma + 1);
-
-        // Recursively evaluate the arguments
-        const f32 val1 = evaluator_evaluate_expression(arg1);
-        const f32 val2 = evaluator_evaluate_expression(arg2);
-
-        return (val1 > val2) ? val1 : val2; // Return the maximum value
-    } else if (strcmp(name, "sqrt") == 0) {
-        // Evaluate the single argument
-        f32 val = evaluator_evaluate_expression(args);
-        return intrin_sqrt_f32(val); // Return the square root
-    } else if (strcmp(name, "abs") == 0) {
-        // Evaluate the single argument
-        f32 val = evaluator_evaluate_expression(args);
-        return fabsf(val); // Return the absolute value
+        ++compiler->pos;
+        evaluator_compile_term(compiler);
+        evaluator_compiler_emit(compiler, op == '+' ? EVALUATOR_OP_ADD : EVALUATOR_OP_SUB);
     }
+}
 
-    // Handle unknown functions (you can add more functions as needed)
-    return 0.0;
+/**
+ * Compiles an expression to RPN bytecode
+ *
+ * @param program       Compiled program
+ * @param expr          Expression (operators: + - * / unary -, functions: min, max, sqrt, abs)
+ * @param slot_count    Number of variables
+ * @param slot_names    Variable names, the index is the slot used in evaluator_run()
+ *
+ * @return false on syntax errors, unknown variables/functions or if the program exceeds the limits
+ */
+bool evaluator_compile(
+    EvaluatorProgram* program,
+    const char* expr,
+    int32 slot_count = 0, const char* const* slot_names = NULL
+) NO_EXCEPT
+{
+    ASSERT_TRUE(slot_count <= EVALUATOR_PROGRAM_MAX_SLOTS);
+
+    program->code_length = 0;
+    program->constant_count = 0;
+    program->slot_count = slot_count;
+    program->stack_size = 0;
+
+    EvaluatorCompiler compiler = {};
+    compiler.pos = expr;
+    compiler.program = program;
+    compiler.slot_count = slot_count;
+    compiler.slot_names = slot_names;
+
+    evaluator_compile_expression(&compiler);
+    evaluator_compiler_skip_whitespace(&compiler);
+
+    if (compiler.error || *compiler.pos != '\0' || compiler.depth != 1) {
+        program->code_length = 0;
+
+        return false;
+    }
+
+    return true;
 }
 
-f32 evaluator_evaluate(const char* expr, int32 variable_count = 0, const EvaluatorVariable* variables = NULL) {
-    ASSERT_TRUE(strlen(expr) > 0);
+/**
+ * Runs a compiled program
+ *
+ * @param program   Compiled program
+ * @param slots     Variable values (program->slot_count values)
+ */
+f32 evaluator_run(const EvaluatorProgram* program, const f32* slots = NULL) NO_EXCEPT
+{
+    f32 stack[EVALUATOR_MAX_STACK_SIZE];
+    int32 top = -1;
+
+    for (int32 i = 0; i < program->code_length; ++i) {
+        const EvaluatorInstruction instr = program->code[i];
+        switch (instr.op) {
+            case EVALUATOR_OP_CONST:
+                stack[++top] = program->constants[instr.arg];
+                break;
+            case EVALUATOR_OP_SLOT:
+                stack[++top] = slots[instr.arg];
+                break;
+            case EVALUATOR_OP_NEG:
+            case EVALUATOR_OP_SQRT:
+            case EVALUATOR_OP_ABS:
+                stack[top] = evaluator_opcode_apply(instr.op, stack[top], 0.0f);
+                break;
+            default:
+                --top;
+                stack[top] = evaluator_opcode_apply(instr.op, stack[top], stack[top + 1]);
+        }
+    }
 
-    // Handle variables
-    char expr_internal[1024];
-    char* dest = expr_internal;
+    return stack[0];
+}
 
-    if (variable_count) {
-        while (*expr != '\0') {
-            // Skip none-alpha values
-            while (!isalpha(*expr) && *expr != '\0') {
-                if (*expr != ' ') {
-                    *dest++ = *expr;
+/**
+ * Runs a compiled program for many inputs
+ *
+ * The program is executed for a block of elements per instruction,
+ * which keeps the dispatch overhead away from the SIMD loops.
+ *
+ * @param program   Compiled program
+ * @param slots     Variable values as SoA: slots[slot][element]
+ * @param out       Results (count values)
+ * @param count     Number of elements
+ */
+void evaluator_run_batch(
+    const EvaluatorProgram* program,
+    const f32* const* slots,
+    f32* out, int32 count
+) NO_EXCEPT
+{
+    alignas(64) f32 stack[EVALUATOR_MAX_STACK_SIZE][EVALUATOR_BATCH_BLOCK];
+
+    #if defined(__AVX2__)
+        const int32 lanes = 8;
+    #elif defined(__SSE4_2__)
+        const int32 lanes = 4;
+    #else
+        const int32 lanes = 1;
+    #endif
+
+    for (int32 offset = 0; offset < count; offset += EVALUATOR_BATCH_BLOCK) {
+        const int32 n = OMS_MIN(EVALUATOR_BATCH_BLOCK, count - offset);
+
+        // The stack rows are padded to full vectors, only loads and stores care about n
+        const int32 n_vec = (int32) align_up(n, lanes);
+        int32 top = -1;
+
+        for (int32 i = 0; i < program->code_length; ++i) {
+            const EvaluatorInstruction instr = program->code[i];
+
+            if (instr.op == EVALUATOR_OP_CONST) {
+                f32* dst = stack[++top];
+                const f32 value = program->constants[instr.arg];
+                for (int32 j = 0; j < n_vec; ++j) {
+                    dst[j] = value;
                 }
 
-                ++expr;
-            }
+                continue;
+            } else if (instr.op == EVALUATOR_OP_SLOT) {
+                f32* dst = stack[++top];
+                memcpy(dst, slots[instr.arg] + offset, n * sizeof(f32));
+                for (int32 j = n; j < n_vec; ++j) {
+                    dst[j] = 0.0f;
+                }
 
-            if (*expr == '\0') {
-                break;
+                continue;
             }
 
-            // Potential variable name
-            bool found_variable = false;
-            for (int32 i = 0; i < variable_count; ++i) {
-                size_t len = strlen(variables[i].name);
-
-                // Check if string is variable (must be followed by none-alpha value = string mustn't continue)
-                if (strncmp(expr, variables[i].name, len) == 0
-                    && !isalnum(expr[len]) && expr[len] != '('
-                ) {
-                    // Replace variable with value
-                    dest += float_to_str(variables[i].value, dest, 4);
-                    expr += len;
-                    found_variable = true;
-                    break;
-                }
-            }
+            const int32 arity = evaluator_opcode_arity(instr.op);
+            top -= arity - 1;
 
-            if (!found_variable) {
-                // If no variable is found we must skip the entire alpha string,
-                // otherwise a substring may match a variable name later on
-                while (isalnum(*expr)) {
-                    *dest++ = *expr++;
+            f32* a = stack[top];
+            const f32* b = stack[top + 1];
+
+            int32 j = 0;
+
+            #if defined(__AVX2__)
+                const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+
+                for (; j < n_vec; j += 8) {
+                    const __m256 va = _mm256_load_ps(a + j);
+                    __m256 r;
+
+                    switch (instr.op) {
+                        case EVALUATOR_OP_ADD: r = _mm256_add_ps(va, _mm256_load_ps(b + j)); break;
+                        case EVALUATOR_OP_SUB: r = _mm256_sub_ps(va, _mm256_load_ps(b + j)); break;
+                        case EVALUATOR_OP_MUL: r = _mm256_mul_ps(va, _mm256_load_ps(b + j)); break;
+                        case EVALUATOR_OP_DIV: r = _mm256_div_ps(va, _mm256_load_ps(b + j)); break;
+                        case EVALUATOR_OP_MIN: r = _mm256_min_ps(va, _mm256_load_ps(b + j)); break;
+                        case EVALUATOR_OP_MAX: r = _mm256_max_ps(va, _mm256_load_ps(b + j)); break;
+                        case EVALUATOR_OP_NEG: r = _mm256_xor_ps(va, sign_mask); break;
+                        case EVALUATOR_OP_SQRT: r = _mm256_sqrt_ps(va); break;
+                        case EVALUATOR_OP_ABS: r = _mm256_andnot_ps(sign_mask, va); break;
+                        default: UNREACHABLE();
+                    }
+
+                    _mm256_store_ps(a + j, r);
                 }
+            #elif defined(__SSE4_2__)
+                const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+                for (; j < n_vec; j += 4) {
+                    const __m128 va = _mm_load_ps(a + j);
+                    __m128 r;
+
+                    switch (instr.op) {
+                        case EVALUATOR_OP_ADD: r = _mm_add_ps(va, _mm_load_ps(b + j)); break;
+                        case EVALUATOR_OP_SUB: r = _mm_sub_ps(va, _mm_load_ps(b + j)); break;
+                        case EVALUATOR_OP_MUL: r = _mm_mul_ps(va, _mm_load_ps(b + j)); break;
+                        case EVALUATOR_OP_DIV: r = _mm_div_ps(va, _mm_load_ps(b + j)); break;
+                        case EVALUATOR_OP_MIN: r = _mm_min_ps(va, _mm_load_ps(b + j)); break;
+                        case EVALUATOR_OP_MAX: r = _mm_max_ps(va, _mm_load_ps(b + j)); break;
+                        case EVALUATOR_OP_NEG: r = _mm_xor_ps(va, sign_mask); break;
+                        case EVALUATOR_OP_SQRT: r = _mm_sqrt_ps(va); break;
+                        case EVALUATOR_OP_ABS: r = _mm_andnot_ps(sign_mask, va); break;
+                        default: UNREACHABLE();
+                    }
+
+                    _mm_store_ps(a + j, r);
+                }
+            #endif
+
+            for (; j < n_vec; ++j) {
+                a[j] = evaluator_opcode_apply(instr.op, a[j], arity == 2 ? b[j] : 0.0f);
             }
         }
+
+        memcpy(out + offset, stack[0], n * sizeof(f32));
     }
+}
 
-    // Copy remaining / or entire string over to internal expression
-    // We also ignore all whitespaces here for simplified handling later on
-    while (*expr != '\0') {
-        if (*expr != ' ') {
-            *dest++ = *expr;
-        }
+struct EvaluatorVariable {
+    char name[8];
+    f32 value;
+};
+
+// One-off evaluation, compiles the expression on every call
+f32 evaluator_evaluate(const char* expr, int32 variable_count = 0, const EvaluatorVariable* variables = NULL) NO_EXCEPT
+{
+    ASSERT_TRUE(strlen(expr) > 0);
+    ASSERT_TRUE(variable_count <= EVALUATOR_PROGRAM_MAX_SLOTS);
 
-        ++expr;
+    const char* names[EVALUATOR_PROGRAM_MAX_SLOTS];
+    f32 values[EVALUATOR_PROGRAM_MAX_SLOTS];
+    for (int32 i = 0; i < variable_count; ++i) {
+        names[i] = variables[i].name;
+        values[i] = variables[i].value;
     }
 
-    *dest = '\0';
+    EvaluatorProgram program;
+    if (!evaluator_compile(&program, expr, variable_count, names)) {
+        return 0.0f;
+    }
 
-    return evaluator_evaluate_expression(expr_internal);
+    return evaluator_run(&program, values);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -13,7 +13,11 @@
 
 #include "../../stdlib/Stdlib.h"
 
-// @todo Implement poisson disc sampling for 2d and sphere
+// Blue noise point sets are created with poisson disk sampling (models/sampling/poisson/PoissonDisk.h):
+//      2D:                 poisson_disk_bridson()
+//      2D importance:      poisson_disk_bridson_importance()
+//      Sphere:             poisson_disk_bridson_sphere()
+// The sampler is not included here since it depends on the ThreadPool and RingMemory
 // https://observablehq.com/@jrus/bridson-fork/2
 // https://observablehq.com/@jrus/spheredisksample
 
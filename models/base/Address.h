@@ -52,7 +52,7 @@ CONSTEXPR WebBinaryValue LocationSchemaStruct[] = {
     WEB_BINARY_FIELD(Location, city),
     WEB_BINARY_FIELD(Location, address),
     WEB_BINARY_FIELD(Location, state),
-    WEB_BINARY_FIELD_WITH_SCHEMA(Location, geo, GeoLocationSchema)
+    WEB_BINARY_FIELD_WITH_SCHEMA(Location, geo, GeoLocationSchemaStruct)
     //WEB_BINARY_FIELD(Location, country),
     //WEB_BINARY_FIELD(Location, type)
 };
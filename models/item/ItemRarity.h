@@ -29,7 +29,7 @@ union RarityDropChance {
         f32 purple;
         f32 red;
         f32 black;
-    }
+    };
 };
 
 union RarityDropCount {
@@ -44,7 +44,7 @@ union RarityDropCount {
         v2_int8 purple;
         v2_int8 red;
         v2_int8 black;
-    }
+    };
 };
 
 struct OpenWorldRarityDropList {
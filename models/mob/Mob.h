@@ -17,7 +17,7 @@
 
 #include "MobState.h"
 
-// @todo consider to create 3 mob state arrays instead and have every array ordered in the same way
+// The render interpolation of many mobs should use the SoA MobStore (see MobStore.h)
 
 struct Mob {
     byte category;
@@ -0,0 +1,514 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_MODELS_MOB_STORE_H
+#define COMS_MODELS_MOB_STORE_H
+
+#include "../../stdlib/Stdlib.h"
+#include "MobState.h"
+
+/**
+ * SoA storage of the mob states used for rendering
+ *
+ * Every array is ordered in the same way, index i of every array belongs to the same mob.
+ * This allows us to interpolate many mobs at once with SIMD.
+ *
+ * The store only keeps the two latest snapshots received from the server (state1 = older, state2 = newer).
+ * The interpolated state is never stored, it is directly written into the render instance buffer.
+ */
+
+struct MobStoreState {
+    f32* t;
+
+    f32* x;
+    f32* y;
+    f32* z;
+
+    // Orientation quaternion
+    f32* qx;
+    f32* qy;
+    f32* qz;
+    f32* qw;
+
+    f32* scale;
+};
+
+struct MobStore {
+    int32 count;
+    int32 capacity;
+
+    uint32* ids;
+
+    MobStoreState state1;
+    MobStoreState state2;
+};
+
+// Per instance data of the mob renderer
+// Row major 3x4 model matrix (the last row is always 0, 0, 0, 1)
+struct MobRenderInstance {
+    f32 model[12];
+};
+
+// Arrays per mob: ids + 2 states
+#define MOB_STORE_ARRAYS (1 + 2 * (sizeof(MobStoreState) / sizeof(f32*)))
+
+// The capacity is a multiple of 16 -> every array is 64 byte aligned
+FORCE_INLINE
+int32 mob_store_capacity(int32 capacity) NO_EXCEPT
+{
+    return (capacity + 15) & ~15;
+}
+
+inline
+int64 mob_store_size(int32 capacity) NO_EXCEPT
+{
+    return (int64) MOB_STORE_ARRAYS * mob_store_capacity(capacity) * sizeof(f32);
+}
+
+static inline
+byte* mob_store_state_init(MobStoreState* state, int32 capacity, byte* buf) NO_EXCEPT
+{
+    f32** arrays = (f32 **) state;
+    for (int32 i = 0; i < (int32) (sizeof(MobStoreState) / sizeof(f32*)); ++i) {
+        arrays[i] = (f32 *) buf;
+        buf += capacity * sizeof(f32);
+    }
+
+    return buf;
+}
+
+/**
+ * Initializes the store
+ *
+ * @param store     Mob store
+ * @param capacity  Max mob count
+ * @param buf       Memory (see mob_store_size()), should be 64 byte aligned
+ */
+inline
+void mob_store_init(MobStore* store, int32 capacity, byte* buf) NO_EXCEPT
+{
+    capacity = mob_store_capacity(capacity);
+
+    store->count = 0;
+    store->capacity = capacity;
+
+    store->ids = (uint32 *) buf;
+    buf += capacity * sizeof(uint32);
+
+    buf = mob_store_state_init(&store->state1, capacity, buf);
+    mob_store_state_init(&store->state2, capacity, buf);
+}
+
+static inline
+void mob_store_state_set(MobStoreState* state, int32 index, const MobState* mob_state, f32 scale) NO_EXCEPT
+{
+    state->t[index] = mob_state->t;
+
+    state->x[index] = mob_state->location.position.x;
+    state->y[index] = mob_state->location.position.y;
+    state->z[index] = mob_state->location.position.z;
+
+    state->qx[index] = mob_state->location.orientation.x;
+    state->qy[index] = mob_state->location.orientation.y;
+    state->qz[index] = mob_state->location.orientation.z;
+    state->qw[index] = mob_state->location.orientation.w;
+
+    state->scale[index] = scale;
+}
+
+static inline
+void mob_store_state_copy(MobStoreState* state, int32 dest, int32 src) NO_EXCEPT
+{
+    f32** arrays = (f32 **) state;
+    for (int32 i = 0; i < (int32) (sizeof(MobStoreState) / sizeof(f32*)); ++i) {
+        arrays[i][dest] = arrays[i][src];
+    }
+}
+
+/**
+ * Adds a mob
+ *
+ * Both snapshots are initialized with the same state
+ *
+ * @return Index of the mob or -1 if the store is full
+ */
+inline
+int32 mob_store_add(MobStore* store, uint32 id, const MobState* state, f32 scale = 1.0f) NO_EXCEPT
+{
+    if (store->count >= store->capacity) {
+        return -1;
+    }
+
+    const int32 index = store->count++;
+    store->ids[index] = id;
+
+    mob_store_state_set(&store->state1, index, state, scale);
+    mob_store_state_set(&store->state2, index, state, scale);
+
+    return index;
+}
+
+// Removes a mob, the last mob is moved into its place
+inline
+void mob_store_remove(MobStore* store, int32 index) NO_EXCEPT
+{
+    ASSERT_TRUE(index >= 0 && index < store->count);
+
+    const int32 last = --store->count;
+    if (index == last) {
+        return;
+    }
+
+    store->ids[index] = store->ids[last];
+    mob_store_state_copy(&store->state1, index, last);
+    mob_store_state_copy(&store->state2, index, last);
+}
+
+// A new snapshot was received, the previous newest snapshot becomes the older one
+inline
+void mob_store_push(MobStore* store, int32 index, const MobState* state, f32 scale = 1.0f) NO_EXCEPT
+{
+    // state1 <- state2
+    f32** dest = (f32 **) &store->state1;
+    f32** src = (f32 **) &store->state2;
+    for (int32 i = 0; i < (int32) (sizeof(MobStoreState) / sizeof(f32*)); ++i) {
+        dest[i][index] = src[i][index];
+    }
+
+    mob_store_state_set(&store->state2, index, state, scale);
+}
+
+/**
+ * Interpolates a single mob (same math as mob_interpolate)
+ *
+ * The rotation uses nlerp along the shortest path, the snapshots are close enough that slerp makes no visible difference.
+ */
+static inline
+void mob_store_interpolate_scalar(
+    const MobStore* const __restrict store, f32 time, int32 index,
+    MobRenderInstance* const __restrict instance
+) NO_EXCEPT
+{
+    const MobStoreState* s1 = &store->state1;
+    const MobStoreState* s2 = &store->state2;
+
+    const f32 t1 = oms_clamp(s2->t[index] - s1->t[index], 0.1f, 1.0f);
+    const f32 p = oms_clamp((time - s2->t[index]) / t1, 0.0f, 1.0f);
+
+    const f32 x = s1->x[index] + (s2->x[index] - s1->x[index]) * p;
+    const f32 y = s1->y[index] + (s2->y[index] - s1->y[index]) * p;
+    const f32 z = s1->z[index] + (s2->z[index] - s1->z[index]) * p;
+    const f32 scale = s1->scale[index] + (s2->scale[index] - s1->scale[index]) * p;
+
+    // q and -q are the same rotation -> use the shorter path
+    const f32 dot = s1->qx[index] * s2->qx[index] + s1->qy[index] * s2->qy[index]
+        + s1->qz[index] * s2->qz[index] + s1->qw[index] * s2->qw[index];
+    const f32 sign = dot < 0.0f ? -1.0f : 1.0f;
+
+    f32 qx = s1->qx[index] + (s2->qx[index] * sign - s1->qx[index]) * p;
+    f32 qy = s1->qy[index] + (s2->qy[index] * sign - s1->qy[index]) * p;
+    f32 qz = s1->qz[index] + (s2->qz[index] * sign - s1->qz[index]) * p;
+    f32 qw = s1->qw[index] + (s2->qw[index] * sign - s1->qw[index]) * p;
+
+    // The scale is folded into the normalization (rotation matrix * scale uses 2 * scale / |q|^2)
+    const f32 len2 = qx * qx + qy * qy + qz * qz + qw * qw;
+    const f32 s = 2.0f / len2;
+
+    const f32 xx = qx * qx * s; const f32 yy = qy * qy * s; const f32 zz = qz * qz * s;
+    const f32 xy = qx * qy * s; const f32 xz = qx * qz * s; const f32 yz = qy * qz * s;
+    const f32 wx = qw * qx * s; const f32 wy = qw * qy * s; const f32 wz = qw * qz * s;
+
+    f32* m = instance->model;
+    m[0] = (1.0f - (yy + zz)) * scale; m[1] = (xy - wz) * scale;          m[2] = (xz + wy) * scale;           m[3] = x;
+    m[4] = (xy + wz) * scale;          m[5] = (1.0f - (xx + zz)) * scale; m[6] = (yz - wx) * scale;           m[7] = y;
+    m[8] = (xz - wy) * scale;          m[9] = (yz + wx) * scale;          m[10] = (1.0f - (xx + yy)) * scale; m[11] = z;
+}
+
+#ifdef __AVX2__
+    FORCE_INLINE
+    __m256 mob_store_load_8(const f32* array, const int32* indices, int32 i) NO_EXCEPT
+    {
+        return indices
+            ? _mm256_i32gather_ps(array, _mm256_loadu_si256((const __m256i *) (indices + i)), 4)
+            : _mm256_loadu_ps(array + i);
+    }
+
+    FORCE_INLINE
+    __m256 mob_store_lerp_8(__m256 a, __m256 b, __m256 p) NO_EXCEPT
+    {
+        return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), p));
+    }
+
+    // Transposes the row of 8 instances (a, b, c, d are the 4 columns of the row)
+    FORCE_INLINE
+    void mob_store_write_row_8(MobRenderInstance* out, int32 row, __m256 a, __m256 b, __m256 c, __m256 d) NO_EXCEPT
+    {
+        const __m256 t0 = _mm256_unpacklo_ps(a, b);
+        const __m256 t1 = _mm256_unpackhi_ps(a, b);
+        const __m256 t2 = _mm256_unpacklo_ps(c, d);
+        const __m256 t3 = _mm256_unpackhi_ps(c, d);
+
+        // Low half = instance i, high half = instance i + 4
+        const __m256 r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+        _mm_storeu_ps(out[0].model + 4 * row, _mm256_castps256_ps128(r0));
+        _mm_storeu_ps(out[1].model + 4 * row, _mm256_castps256_ps128(r1));
+        _mm_storeu_ps(out[2].model + 4 * row, _mm256_castps256_ps128(r2));
+        _mm_storeu_ps(out[3].model + 4 * row, _mm256_castps256_ps128(r3));
+        _mm_storeu_ps(out[4].model + 4 * row, _mm256_extractf128_ps(r0, 1));
+        _mm_storeu_ps(out[5].model + 4 * row, _mm256_extractf128_ps(r1, 1));
+        _mm_storeu_ps(out[6].model + 4 * row, _mm256_extractf128_ps(r2, 1));
+        _mm_storeu_ps(out[7].model + 4 * row, _mm256_extractf128_ps(r3, 1));
+    }
+#endif
+
+#ifdef __SSE4_2__
+    FORCE_INLINE
+    __m128 mob_store_load_4(const f32* array, const int32* indices, int32 i) NO_EXCEPT
+    {
+        // No gather instruction before AVX2
+        return indices
+            ? _mm_setr_ps(array[indices[i]], array[indices[i + 1]], array[indices[i + 2]], array[indices[i + 3]])
+            : _mm_loadu_ps(array + i);
+    }
+
+    FORCE_INLINE
+    __m128 mob_store_lerp_4(__m128 a, __m128 b, __m128 p) NO_EXCEPT
+    {
+        return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), p));
+    }
+
+    FORCE_INLINE
+    void mob_store_write_row_4(MobRenderInstance* out, int32 row, __m128 a, __m128 b, __m128 c, __m128 d) NO_EXCEPT
+    {
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+
+        _mm_storeu_ps(out[0].model + 4 * row, a);
+        _mm_storeu_ps(out[1].model + 4 * row, b);
+        _mm_storeu_ps(out[2].model + 4 * row, c);
+        _mm_storeu_ps(out[3].model + 4 * row, d);
+    }
+#endif
+
+/**
+ * Interpolates the mobs and writes their model matrices into the render instance buffer
+ *
+ * @param store     Mob store
+ * @param time      Render time
+ * @param indices   Mob indices to interpolate (e.g. the visible mobs), NULL = the first count mobs
+ * @param count     Number of mobs to interpolate
+ * @param instances Render instances (count), instance i belongs to indices[i]
+ * @param steps     Max SIMD width (1 = scalar)
+ */
+inline
+void mob_store_interpolate(
+    const MobStore* const __restrict store, f32 time,
+    const int32* const __restrict indices, int32 count,
+    MobRenderInstance* const __restrict instances,
+    int32 steps = 8
+) NO_EXCEPT
+{
+    const MobStoreState* s1 = &store->state1;
+    const MobStoreState* s2 = &store->state2;
+    PSEUDO_USE(s1);
+    PSEUDO_USE(s2);
+    PSEUDO_USE(steps);
+
+    int32 i = 0;
+
+    #ifdef __AVX2__
+        if (steps >= 8) {
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 two = _mm256_set1_ps(2.0f);
+            const __m256 min_dt = _mm256_set1_ps(0.1f);
+            const __m256 time_8 = _mm256_set1_ps(time);
+            const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+
+            for (; i + 8 <= count; i += 8) {
+                const __m256 t1 = mob_store_load_8(s1->t, indices, i);
+                const __m256 t2 = mob_store_load_8(s2->t, indices, i);
+
+                const __m256 dt = _mm256_max_ps(_mm256_min_ps(_mm256_sub_ps(t2, t1), one), min_dt);
+                const __m256 p = _mm256_max_ps(_mm256_min_ps(_mm256_div_ps(_mm256_sub_ps(time_8, t2), dt), one), zero);
+
+                const __m256 x = mob_store_lerp_8(mob_store_load_8(s1->x, indices, i), mob_store_load_8(s2->x, indices, i), p);
+                const __m256 y = mob_store_lerp_8(mob_store_load_8(s1->y, indices, i), mob_store_load_8(s2->y, indices, i), p);
+                const __m256 z = mob_store_lerp_8(mob_store_load_8(s1->z, indices, i), mob_store_load_8(s2->z, indices, i), p);
+                const __m256 scale = mob_store_lerp_8(
+                    mob_store_load_8(s1->scale, indices, i), mob_store_load_8(s2->scale, indices, i), p
+                );
+
+                const __m256 ax = mob_store_load_8(s1->qx, indices, i);
+                const __m256 ay = mob_store_load_8(s1->qy, indices, i);
+                const __m256 az = mob_store_load_8(s1->qz, indices, i);
+                const __m256 aw = mob_store_load_8(s1->qw, indices, i);
+                __m256 bx = mob_store_load_8(s2->qx, indices, i);
+                __m256 by = mob_store_load_8(s2->qy, indices, i);
+                __m256 bz = mob_store_load_8(s2->qz, indices, i);
+                __m256 bw = mob_store_load_8(s2->qw, indices, i);
+
+                // Shortest path: flip the sign of b if the dot product is negative
+                const __m256 dot = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)),
+                    _mm256_add_ps(_mm256_mul_ps(az, bz), _mm256_mul_ps(aw, bw))
+                );
+                const __m256 flip = _mm256_and_ps(_mm256_cmp_ps(dot, zero, _CMP_LT_OQ), sign_bit);
+                bx = _mm256_xor_ps(bx, flip);
+                by = _mm256_xor_ps(by, flip);
+                bz = _mm256_xor_ps(bz, flip);
+                bw = _mm256_xor_ps(bw, flip);
+
+                const __m256 qx = mob_store_lerp_8(ax, bx, p);
+                const __m256 qy = mob_store_lerp_8(ay, by, p);
+                const __m256 qz = mob_store_lerp_8(az, bz, p);
+                const __m256 qw = mob_store_lerp_8(aw, bw, p);
+
+                const __m256 len2 = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(qx, qx), _mm256_mul_ps(qy, qy)),
+                    _mm256_add_ps(_mm256_mul_ps(qz, qz), _mm256_mul_ps(qw, qw))
+                );
+                const __m256 s = _mm256_div_ps(two, len2);
+
+                const __m256 qxs = _mm256_mul_ps(qx, s);
+                const __m256 qys = _mm256_mul_ps(qy, s);
+                const __m256 qzs = _mm256_mul_ps(qz, s);
+
+                const __m256 xx = _mm256_mul_ps(qx, qxs);
+                const __m256 yy = _mm256_mul_ps(qy, qys);
+                const __m256 zz = _mm256_mul_ps(qz, qzs);
+                const __m256 xy = _mm256_mul_ps(qx, qys);
+                const __m256 xz = _mm256_mul_ps(qx, qzs);
+                const __m256 yz = _mm256_mul_ps(qy, qzs);
+                const __m256 wx = _mm256_mul_ps(qw, qxs);
+                const __m256 wy = _mm256_mul_ps(qw, qys);
+                const __m256 wz = _mm256_mul_ps(qw, qzs);
+
+                MobRenderInstance* out = instances + i;
+                mob_store_write_row_8(out, 0,
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), scale),
+                    _mm256_mul_ps(_mm256_sub_ps(xy, wz), scale),
+                    _mm256_mul_ps(_mm256_add_ps(xz, wy), scale),
+                    x
+                );
+                mob_store_write_row_8(out, 1,
+                    _mm256_mul_ps(_mm256_add_ps(xy, wz), scale),
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), scale),
+                    _mm256_mul_ps(_mm256_sub_ps(yz, wx), scale),
+                    y
+                );
+                mob_store_write_row_8(out, 2,
+                    _mm256_mul_ps(_mm256_sub_ps(xz, wy), scale),
+                    _mm256_mul_ps(_mm256_add_ps(yz, wx), scale),
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), scale),
+                    z
+                );
+            }
+        }
+    #endif
+
+    #ifdef __SSE4_2__
+        if (steps >= 4) {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 two = _mm_set1_ps(2.0f);
+            const __m128 min_dt = _mm_set1_ps(0.1f);
+            const __m128 time_4 = _mm_set1_ps(time);
+            const __m128 sign_bit = _mm_set1_ps(-0.0f);
+
+            for (; i + 4 <= count; i += 4) {
+                const __m128 t1 = mob_store_load_4(s1->t, indices, i);
+                const __m128 t2 = mob_store_load_4(s2->t, indices, i);
+
+                const __m128 dt = _mm_max_ps(_mm_min_ps(_mm_sub_ps(t2, t1), one), min_dt);
+                const __m128 p = _mm_max_ps(_mm_min_ps(_mm_div_ps(_mm_sub_ps(time_4, t2), dt), one), zero);
+
+                const __m128 x = mob_store_lerp_4(mob_store_load_4(s1->x, indices, i), mob_store_load_4(s2->x, indices, i), p);
+                const __m128 y = mob_store_lerp_4(mob_store_load_4(s1->y, indices, i), mob_store_load_4(s2->y, indices, i), p);
+                const __m128 z = mob_store_lerp_4(mob_store_load_4(s1->z, indices, i), mob_store_load_4(s2->z, indices, i), p);
+                const __m128 scale = mob_store_lerp_4(
+                    mob_store_load_4(s1->scale, indices, i), mob_store_load_4(s2->scale, indices, i), p
+                );
+
+                const __m128 ax = mob_store_load_4(s1->qx, indices, i);
+                const __m128 ay = mob_store_load_4(s1->qy, indices, i);
+                const __m128 az = mob_store_load_4(s1->qz, indices, i);
+                const __m128 aw = mob_store_load_4(s1->qw, indices, i);
+                __m128 bx = mob_store_load_4(s2->qx, indices, i);
+                __m128 by = mob_store_load_4(s2->qy, indices, i);
+                __m128 bz = mob_store_load_4(s2->qz, indices, i);
+                __m128 bw = mob_store_load_4(s2->qw, indices, i);
+
+                const __m128 dot = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                    _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw))
+                );
+                const __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), sign_bit);
+                bx = _mm_xor_ps(bx, flip);
+                by = _mm_xor_ps(by, flip);
+                bz = _mm_xor_ps(bz, flip);
+                bw = _mm_xor_ps(bw, flip);
+
+                const __m128 qx = mob_store_lerp_4(ax, bx, p);
+                const __m128 qy = mob_store_lerp_4(ay, by, p);
+                const __m128 qz = mob_store_lerp_4(az, bz, p);
+                const __m128 qw = mob_store_lerp_4(aw, bw, p);
+
+                const __m128 len2 = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)),
+                    _mm_add_ps(_mm_mul_ps(qz, qz), _mm_mul_ps(qw, qw))
+                );
+                const __m128 s = _mm_div_ps(two, len2);
+
+                const __m128 qxs = _mm_mul_ps(qx, s);
+                const __m128 qys = _mm_mul_ps(qy, s);
+                const __m128 qzs = _mm_mul_ps(qz, s);
+
+                const __m128 xx = _mm_mul_ps(qx, qxs);
+                const __m128 yy = _mm_mul_ps(qy, qys);
+                const __m128 zz = _mm_mul_ps(qz, qzs);
+                const __m128 xy = _mm_mul_ps(qx, qys);
+                const __m128 xz = _mm_mul_ps(qx, qzs);
+                const __m128 yz = _mm_mul_ps(qy, qzs);
+                const __m128 wx = _mm_mul_ps(qw, qxs);
+                const __m128 wy = _mm_mul_ps(qw, qys);
+                const __m128 wz = _mm_mul_ps(qw, qzs);
+
+                MobRenderInstance* out = instances + i;
+                mob_store_write_row_4(out, 0,
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scale),
+                    _mm_mul_ps(_mm_sub_ps(xy, wz), scale),
+                    _mm_mul_ps(_mm_add_ps(xz, wy), scale),
+                    x
+                );
+                mob_store_write_row_4(out, 1,
+                    _mm_mul_ps(_mm_add_ps(xy, wz), scale),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scale),
+                    _mm_mul_ps(_mm_sub_ps(yz, wx), scale),
+                    y
+                );
+                mob_store_write_row_4(out, 2,
+                    _mm_mul_ps(_mm_sub_ps(xz, wy), scale),
+                    _mm_mul_ps(_mm_add_ps(yz, wx), scale),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scale),
+                    z
+                );
+            }
+        }
+    #endif
+
+    for (; i < count; ++i) {
+        mob_store_interpolate_scalar(store, time, indices ? indices[i] : i, &instances[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,377 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_MODELS_MOB_SECONDARY_STATS_AGGREGATE_H
+#define COMS_MODELS_MOB_SECONDARY_STATS_AGGREGATE_H
+
+#include "../../stdlib/Stdlib.h"
+#include "../../compiler/CompilerUtils.h"
+#include "SecondaryStatsPoints.h"
+
+/**
+ * Incremental aggregation of the secondary stats of a mob
+ *
+ * Every stat contribution (equipment, buffs, skills, ...) is a source that occupies one slot.
+ * A source contains an additive and a multiplicative (percent points) vector of all secondary stats.
+ *
+ *      result = min((base + sum(add)) * (100 + sum(mul)) / 100, cap)
+ *
+ * All sums saturate at 0xFFFF.
+ *
+ * The stats are handled in blocks of 16 (= one AVX2 register).
+ * Every source knows which blocks it modifies and every mob knows which blocks are dirty.
+ * Changing a source only recomputes the blocks modified by that source and mobs without changes are skipped.
+ */
+
+static_assert(sizeof(SecondaryStatsPoints) == SECONDARY_STAT_SIZE * sizeof(uint16));
+
+#define SECONDARY_STATS_BLOCK_SIZE 16
+#define SECONDARY_STATS_BLOCK_COUNT ((SECONDARY_STAT_SIZE + SECONDARY_STATS_BLOCK_SIZE - 1) / SECONDARY_STATS_BLOCK_SIZE)
+#define SECONDARY_STATS_LANES (SECONDARY_STATS_BLOCK_COUNT * SECONDARY_STATS_BLOCK_SIZE)
+
+// Max sources per mob (bit mask)
+#define SECONDARY_STATS_SOURCE_MAX 32
+
+// Percent points
+#define SECONDARY_STATS_MUL_BASE 100
+
+// Dense stat vector, the lanes after SECONDARY_STAT_SIZE are always 0
+struct SecondaryStatsVector {
+    alignas(32) uint16 stats[SECONDARY_STATS_LANES];
+};
+
+struct SecondaryStatsSource {
+    SecondaryStatsVector add;
+    SecondaryStatsVector mul;
+
+    // Blocks modified by this source
+    uint32 blocks;
+};
+
+struct SecondaryStatsAggregate {
+    // Active source slots
+    uint32 active;
+
+    // Blocks that need to be recomputed
+    uint32 dirty;
+
+    int32 source_count;
+    SecondaryStatsSource* sources;
+
+    SecondaryStatsVector base;
+
+    // Aggregated stats, can be used as SecondaryStatsPoints (see secondary_stats_points())
+    SecondaryStatsVector result;
+};
+
+/**
+ * Creates a dense vector from the stat points
+ *
+ * @param vec       Stat vector
+ * @param points    Stat points (NULL = all 0)
+ *
+ * @return Blocks that contain non-zero stats
+ */
+inline
+uint32 secondary_stats_vector(SecondaryStatsVector* vec, const SecondaryStatsPoints* points) NO_EXCEPT
+{
+    memset(vec->stats, 0, sizeof(vec->stats));
+    if (!points) {
+        return 0;
+    }
+
+    memcpy(vec->stats, points, sizeof(SecondaryStatsPoints));
+
+    uint32 blocks = 0;
+    for (int32 i = 0; i < SECONDARY_STAT_SIZE; ++i) {
+        blocks |= ((uint32) (vec->stats[i] != 0)) << (i / SECONDARY_STATS_BLOCK_SIZE);
+    }
+
+    return blocks;
+}
+
+FORCE_INLINE
+const SecondaryStatsPoints* secondary_stats_points(const SecondaryStatsAggregate* agg) NO_EXCEPT
+{
+    return (const SecondaryStatsPoints *) agg->result.stats;
+}
+
+inline
+int64 secondary_stats_aggregate_size(int32 source_count) NO_EXCEPT
+{
+    return (int64) source_count * sizeof(SecondaryStatsSource);
+}
+
+/**
+ * Initializes the aggregate of a mob
+ *
+ * @param agg           Aggregate
+ * @param base          Base stats of the mob
+ * @param source_count  Source slots (max SECONDARY_STATS_SOURCE_MAX)
+ * @param buf           Memory (see secondary_stats_aggregate_size())
+ */
+inline
+void secondary_stats_aggregate_init(
+    SecondaryStatsAggregate* agg, const SecondaryStatsPoints* base,
+    int32 source_count, byte* buf
+) NO_EXCEPT
+{
+    ASSERT_TRUE(source_count <= SECONDARY_STATS_SOURCE_MAX);
+
+    agg->active = 0;
+    agg->source_count = source_count;
+    agg->sources = (SecondaryStatsSource *) buf;
+
+    secondary_stats_vector(&agg->base, base);
+    memset(&agg->result, 0, sizeof(agg->result));
+
+    agg->dirty = (1U << SECONDARY_STATS_BLOCK_COUNT) - 1;
+}
+
+inline
+void secondary_stats_base_set(SecondaryStatsAggregate* agg, const SecondaryStatsPoints* base) NO_EXCEPT
+{
+    uint32 blocks = 0;
+    for (int32 i = 0; i < SECONDARY_STAT_SIZE; ++i) {
+        blocks |= ((uint32) (agg->base.stats[i] != ((const uint16 *) base)[i])) << (i / SECONDARY_STATS_BLOCK_SIZE);
+    }
+
+    secondary_stats_vector(&agg->base, base);
+    agg->dirty |= blocks;
+}
+
+/**
+ * Sets the contribution of a source (e.g. equipping an item, applying a buff)
+ *
+ * @param agg   Aggregate
+ * @param slot  Source slot
+ * @param add   Additive stats (NULL = none)
+ * @param mul   Multiplicative stats in percent points (NULL = none)
+ */
+inline
+void secondary_stats_source_set(
+    SecondaryStatsAggregate* agg, int32 slot,
+    const SecondaryStatsPoints* add, const SecondaryStatsPoints* mul
+) NO_EXCEPT
+{
+    ASSERT_TRUE(slot >= 0 && slot < agg->source_count);
+
+    SecondaryStatsSource* source = &agg->sources[slot];
+
+    // The blocks of the old contribution must be recomputed as well
+    if (agg->active & (1U << slot)) {
+        agg->dirty |= source->blocks;
+    }
+
+    source->blocks = secondary_stats_vector(&source->add, add) | secondary_stats_vector(&source->mul, mul);
+
+    agg->active |= 1U << slot;
+    agg->dirty |= source->blocks;
+}
+
+// Removes a source (e.g. a buff expired)
+inline
+void secondary_stats_source_remove(SecondaryStatsAggregate* agg, int32 slot) NO_EXCEPT
+{
+    ASSERT_TRUE(slot >= 0 && slot < agg->source_count);
+
+    if (!(agg->active & (1U << slot))) {
+        return;
+    }
+
+    agg->active &= ~(1U << slot);
+    agg->dirty |= agg->sources[slot].blocks;
+}
+
+static inline
+void secondary_stats_block_scalar(
+    SecondaryStatsAggregate* agg, int32 block, const SecondaryStatsVector* caps
+) NO_EXCEPT
+{
+    const int32 start = block * SECONDARY_STATS_BLOCK_SIZE;
+
+    for (int32 i = start; i < start + SECONDARY_STATS_BLOCK_SIZE; ++i) {
+        uint32 add = agg->base.stats[i];
+        uint32 mul = 0;
+
+        uint32 active = agg->active;
+        while (active) {
+            const int32 slot = compiler_find_first_bit_r2l(active);
+            active &= active - 1;
+
+            add += agg->sources[slot].add.stats[i];
+            mul += agg->sources[slot].mul.stats[i];
+        }
+
+        add = oms_min(add, 0xFFFFU);
+        const uint32 factor = oms_min(mul + SECONDARY_STATS_MUL_BASE, 0xFFFFU);
+
+        uint32 value = oms_min(add * factor, 0xFFFFU * SECONDARY_STATS_MUL_BASE) / SECONDARY_STATS_MUL_BASE;
+        if (caps) {
+            value = oms_min(value, (uint32) caps->stats[i]);
+        }
+
+        agg->result.stats[i] = (uint16) value;
+    }
+}
+
+#ifdef __AVX2__
+    // (add * factor) / 100 for 8 lanes
+    // The product is clamped to 0xFFFF * 100 < 2^24 which makes the f32 division exact enough to truncate
+    FORCE_INLINE
+    __m256i secondary_stats_mul_8(__m128i add, __m128i factor) NO_EXCEPT
+    {
+        __m256i prod = _mm256_mullo_epi32(_mm256_cvtepu16_epi32(add), _mm256_cvtepu16_epi32(factor));
+        prod = _mm256_min_epu32(prod, _mm256_set1_epi32(0xFFFF * SECONDARY_STATS_MUL_BASE));
+
+        return _mm256_cvttps_epi32(
+            _mm256_div_ps(_mm256_cvtepi32_ps(prod), _mm256_set1_ps((f32) SECONDARY_STATS_MUL_BASE))
+        );
+    }
+#endif
+
+#ifdef __SSE4_2__
+    FORCE_INLINE
+    __m128i secondary_stats_mul_4(__m128i add, __m128i factor) NO_EXCEPT
+    {
+        __m128i prod = _mm_mullo_epi32(_mm_cvtepu16_epi32(add), _mm_cvtepu16_epi32(factor));
+        prod = _mm_min_epu32(prod, _mm_set1_epi32(0xFFFF * SECONDARY_STATS_MUL_BASE));
+
+        return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(prod), _mm_set1_ps((f32) SECONDARY_STATS_MUL_BASE)));
+    }
+#endif
+
+/**
+ * Recomputes the dirty blocks of a mob
+ *
+ * @param agg   Aggregate
+ * @param caps  Max value per stat (NULL = no caps)
+ * @param steps Max SIMD width (1 = scalar)
+ *
+ * @return True if something was recomputed
+ */
+inline
+bool secondary_stats_update(
+    SecondaryStatsAggregate* agg, const SecondaryStatsVector* caps = NULL,
+    int32 steps = 8
+) NO_EXCEPT
+{
+    if (!agg->dirty) {
+        return false;
+    }
+
+    PSEUDO_USE(steps);
+
+    uint32 dirty = agg->dirty;
+    agg->dirty = 0;
+
+    while (dirty) {
+        const int32 block = compiler_find_first_bit_r2l(dirty);
+        dirty &= dirty - 1;
+
+        const int32 start = block * SECONDARY_STATS_BLOCK_SIZE;
+        const uint32 block_bit = 1U << block;
+
+        #ifdef __AVX2__
+            if (steps >= 8) {
+                __m256i add = _mm256_loadu_si256((const __m256i *) (agg->base.stats + start));
+                __m256i mul = _mm256_setzero_si256();
+
+                uint32 active = agg->active;
+                while (active) {
+                    const SecondaryStatsSource* source = &agg->sources[compiler_find_first_bit_r2l(active)];
+                    active &= active - 1;
+
+                    if (!(source->blocks & block_bit)) {
+                        continue;
+                    }
+
+                    add = _mm256_adds_epu16(add, _mm256_loadu_si256((const __m256i *) (source->add.stats + start)));
+                    mul = _mm256_adds_epu16(mul, _mm256_loadu_si256((const __m256i *) (source->mul.stats + start)));
+                }
+
+                const __m256i factor = _mm256_adds_epu16(mul, _mm256_set1_epi16(SECONDARY_STATS_MUL_BASE));
+
+                const __m256i lo = secondary_stats_mul_8(_mm256_castsi256_si128(add), _mm256_castsi256_si128(factor));
+                const __m256i hi = secondary_stats_mul_8(_mm256_extracti128_si256(add, 1), _mm256_extracti128_si256(factor, 1));
+
+                // packus works per 128 bit lane -> restore the order
+                __m256i result = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+                if (caps) {
+                    result = _mm256_min_epu16(result, _mm256_loadu_si256((const __m256i *) (caps->stats + start)));
+                }
+
+                _mm256_storeu_si256((__m256i *) (agg->result.stats + start), result);
+
+                continue;
+            }
+        #endif
+
+        #ifdef __SSE4_2__
+            if (steps >= 4) {
+                for (int32 i = start; i < start + SECONDARY_STATS_BLOCK_SIZE; i += 8) {
+                    __m128i add = _mm_loadu_si128((const __m128i *) (agg->base.stats + i));
+                    __m128i mul = _mm_setzero_si128();
+
+                    uint32 active = agg->active;
+                    while (active) {
+                        const SecondaryStatsSource* source = &agg->sources[compiler_find_first_bit_r2l(active)];
+                        active &= active - 1;
+
+                        if (!(source->blocks & block_bit)) {
+                            continue;
+                        }
+
+                        add = _mm_adds_epu16(add, _mm_loadu_si128((const __m128i *) (source->add.stats + i)));
+                        mul = _mm_adds_epu16(mul, _mm_loadu_si128((const __m128i *) (source->mul.stats + i)));
+                    }
+
+                    const __m128i factor = _mm_adds_epu16(mul, _mm_set1_epi16(SECONDARY_STATS_MUL_BASE));
+
+                    __m128i result = _mm_packus_epi32(
+                        secondary_stats_mul_4(add, factor),
+                        secondary_stats_mul_4(_mm_srli_si128(add, 8), _mm_srli_si128(factor, 8))
+                    );
+                    if (caps) {
+                        result = _mm_min_epu16(result, _mm_loadu_si128((const __m128i *) (caps->stats + i)));
+                    }
+
+                    _mm_storeu_si128((__m128i *) (agg->result.stats + i), result);
+                }
+
+                continue;
+            }
+        #endif
+
+        secondary_stats_block_scalar(agg, block, caps);
+    }
+
+    return true;
+}
+
+/**
+ * Recomputes all mobs with changed sources
+ *
+ * @return Number of recomputed mobs
+ */
+inline
+int32 secondary_stats_update_all(
+    SecondaryStatsAggregate* aggs, int32 count,
+    const SecondaryStatsVector* caps = NULL, int32 steps = 8
+) NO_EXCEPT
+{
+    int32 updated = 0;
+    for (int32 i = 0; i < count; ++i) {
+        updated += secondary_stats_update(&aggs[i], caps, steps);
+    }
+
+    return updated;
+}
+
+#endif
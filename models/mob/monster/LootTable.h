@@ -16,6 +16,29 @@
 #include "Drop.h"
 #include "../../item/ItemRarity.h"
 
+#define LOOT_ALIAS_MAX_COLUMNS 2048
+
+// Draws are processed in blocks of this size by the batched rolls
+#define LOOT_BATCH_SIZE 256
+
+/**
+ * Vose alias table
+ *
+ * Every draw takes one column and either returns the column itself or the alias of the column.
+ * The column count is padded to a power of 2 so that the column is just a bit mask of a random number.
+ * Padding columns have a threshold of 0 and always return their alias.
+ */
+struct LootAliasTable {
+    // Always a power of 2
+    int32 column_count;
+
+    // Probability (scaled by 2^31) that a column returns itself
+    int32* thresholds;
+
+    // Returned if the threshold is not met
+    int32* aliases;
+};
+
 // Loot tables are 2-layered
 //      1. basic item selection
 //      2. only if defined individual drop distributions
@@ -25,6 +48,19 @@ struct LootTable {
     uint64* items;
     int32 item_count;
 
+    // Drop chance of every item
+    // The remaining probability (if any) is "no drop"
+    f32* item_chances;
+
+    // Min/max quantity of every item (NULL = always 1)
+    v2_int32* item_quantities;
+
+    // Chance that the table comes into effect at all
+    f32 table_chance;
+
+    // Precompiled item_chances, see loot_table_compile()
+    LootAliasTable alias;
+
     RarityDropChance item_drop_chances;
     RarityDropCount item_drop_count;
 
@@ -48,65 +84,518 @@ struct LootTable {
     v2_int16 xp;
 };
 
-// 1. check if table comes into effect
-// 2. check if max item drop count is exceeded
-void loot_table_drop(const LootTable* table, Drop* drop, uint32 counter = 0)
+FORCE_INLINE
+int32 loot_alias_column_count(int32 outcome_count) NO_EXCEPT
 {
-    f32 rand = rand_fast_percent();
-    if (counter >= table->item_max_count
-        || rand > table->table_chance
-    ) {
-        drop = NULL;
-        return;
+    int32 columns = 1;
+    while (columns < outcome_count) {
+        columns <<= 1;
+    }
+
+    return columns;
+}
+
+// Memory required by loot_table_compile()
+inline
+int64 loot_table_alias_size(int32 item_count) NO_EXCEPT
+{
+    // +1 for the "no drop" outcome
+    return 2LL * loot_alias_column_count(item_count + 1) * sizeof(int32);
+}
+
+/**
+ * Builds the alias table from arbitrary weights (Vose)
+ *
+ * @param alias     Alias table
+ * @param weights   Outcome weights (don't have to sum up to 1)
+ * @param count     Outcome count
+ * @param buf       Memory for the table (2 * columns * sizeof(int32))
+ */
+void loot_alias_create(
+    LootAliasTable* const __restrict alias,
+    const f64* const __restrict weights,
+    int32 count,
+    byte* __restrict buf
+) NO_EXCEPT
+{
+    ASSERT_TRUE(count > 0);
+
+    const int32 columns = loot_alias_column_count(count);
+    ASSERT_TRUE(columns <= LOOT_ALIAS_MAX_COLUMNS);
+
+    alias->column_count = columns;
+    alias->thresholds = (int32 *) buf;
+    alias->aliases = (int32 *) (buf + columns * sizeof(int32));
+
+    f64 total = 0.0;
+    for (int32 i = 0; i < count; ++i) {
+        total += weights[i];
     }
 
-    f32 range_value = 0;
-    int32 i = 0;
-    for (i = 0; i < table->table_size; ++i) {
-        range_value += table->item_drop_chances[i];
+    // Probabilities scaled by the column count -> the average column has a probability of 1
+    f64 p[LOOT_ALIAS_MAX_COLUMNS];
+    int32 small[LOOT_ALIAS_MAX_COLUMNS];
+    int32 large[LOOT_ALIAS_MAX_COLUMNS];
+    int32 small_count = 0;
+    int32 large_count = 0;
 
-        if (range_value < rand) {
-            drop->item = table->items[i];
-            break;
+    int32 first_outcome = 0;
+    while (first_outcome < count - 1 && weights[first_outcome] <= 0.0) {
+        ++first_outcome;
+    }
+
+    for (int32 i = 0; i < columns; ++i) {
+        p[i] = i < count && total > 0.0 ? weights[i] * columns / total : 0.0;
+        alias->aliases[i] = i;
+
+        if (p[i] < 1.0) {
+            small[small_count++] = i;
+        } else {
+            large[large_count++] = i;
         }
     }
 
-    if (i >= table->table_size) {
-        drop = NULL;
-        return;
+    while (small_count > 0 && large_count > 0) {
+        const int32 s = small[--small_count];
+        const int32 l = large[--large_count];
+
+        alias->thresholds[s] = (int32) (p[s] * 2147483648.0);
+        alias->aliases[s] = l;
+
+        p[l] = (p[l] + p[s]) - 1.0;
+        if (p[l] < 1.0) {
+            small[small_count++] = l;
+        } else {
+            large[large_count++] = l;
+        }
     }
 
+    while (large_count > 0) {
+        alias->thresholds[large[--large_count]] = MAX_INT32;
+    }
+
+    while (small_count > 0) {
+        const int32 s = small[--small_count];
+
+        // Only reachable through numerical errors, a column without probability must never return itself
+        alias->thresholds[s] = p[s] > 0.0 ? MAX_INT32 : 0;
+        alias->aliases[s] = p[s] > 0.0 ? s : first_outcome;
+    }
+}
+
+/**
+ * Precompiles the item chances into an alias table
+ *
+ * The outcome item_count represents "no drop" and has the remaining probability of the item chances.
+ * If the item chances sum up to more than 1 they are normalized.
+ *
+ * @param table Loot table
+ * @param buf   Memory for the alias table (see loot_table_alias_size())
+ */
+void loot_table_compile(LootTable* const __restrict table, byte* __restrict buf) NO_EXCEPT
+{
+    ASSERT_TRUE(table->item_count + 1 <= LOOT_ALIAS_MAX_COLUMNS);
+
+    f64 weights[LOOT_ALIAS_MAX_COLUMNS];
+    f64 total = 0.0;
+    for (int32 i = 0; i < table->item_count; ++i) {
+        weights[i] = table->item_chances[i];
+        total += weights[i];
+    }
+
+    weights[table->item_count] = total < 1.0 ? 1.0 - total : 0.0;
+
+    loot_alias_create(&table->alias, weights, table->item_count + 1, buf);
+}
+
+/////////////////////////////////////////////////////////////
+// Seeded rolls
+//
+// The random numbers are a hash of (seed, kill, stream) instead of a sequential rng state.
+// This makes every roll reproducible on its own (e.g. audit logs only need the seed and kill index)
+// and the results don't depend on batching or SIMD width.
+//
+// Streams:
+//      2 * roll        alias column
+//      2 * roll + 1    alias threshold
+//      2^31 + roll     quantity
+//      2^32 - 1        table chance
+/////////////////////////////////////////////////////////////
+
+#define LOOT_STREAM_QUANTITY 0x80000000U
+#define LOOT_STREAM_TABLE 0xFFFFFFFFU
+
+// Integer hash (lowbias32)
+FORCE_INLINE
+uint32 loot_hash(uint32 x) NO_EXCEPT
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+
+    return x;
+}
+
+// Random base of a kill, all streams of the kill are derived from it
+FORCE_INLINE
+uint32 loot_kill_base(uint64 seed, uint32 kill) NO_EXCEPT
+{
+    return loot_hash(loot_hash(kill ^ (uint32) seed) + (uint32) (seed >> 32));
+}
+
+FORCE_INLINE
+uint32 loot_rand(uint32 base, uint32 stream) NO_EXCEPT
+{
+    return loot_hash(base + stream * 0x9E3779B9U);
+}
+
+FORCE_INLINE
+int32 loot_alias_sample(const LootAliasTable* alias, uint32 r_column, uint32 r_threshold) NO_EXCEPT
+{
+    const int32 column = (int32) (r_column & (uint32) (alias->column_count - 1));
+
+    return (int32) (r_threshold >> 1) < alias->thresholds[column] ? column : alias->aliases[column];
+}
+
+// Fills the drop of an outcome, returns false for "no drop"
+FORCE_INLINE
+bool loot_table_drop_fill(const LootTable* table, int32 outcome, uint32 base, uint32 roll, Drop* drop) NO_EXCEPT
+{
+    if (outcome >= table->item_count) {
+        drop->item = 0;
+        drop->quantity = 0;
+
+        return false;
+    }
+
+    drop->item = table->items[outcome];
     drop->quantity = 1;
-    if (table->item_max_drop_count[i] > 1) {
-        rand = rand_fast_percent();
-        drop->quantity = OMS_MAX(table->item_min_drop_count[i], (int) ((f32) table->item_max_count * rand));
+
+    if (table->item_quantities) {
+        const v2_int32 quantity = table->item_quantities[outcome];
+        const uint32 span = (uint32) (quantity.y - quantity.x + 1);
+        const uint32 r = loot_rand(base, LOOT_STREAM_QUANTITY + roll);
+
+        drop->quantity = (uint32) quantity.x + (uint32) (((uint64) r * span) >> 32);
+    }
+
+    return true;
+}
+
+FORCE_INLINE
+bool loot_table_is_active(const LootTable* table, uint32 base) NO_EXCEPT
+{
+    return (f32) (loot_rand(base, LOOT_STREAM_TABLE) >> 8) * (1.0f / 16777216.0f) < table->table_chance;
+}
+
+/**
+ * Rolls the drops of a single kill
+ *
+ * @param table         Compiled loot table
+ * @param seed          Seed
+ * @param kill          Kill index (e.g. a running kill counter)
+ * @param roll_count    Rolls per kill
+ * @param drops         Drops (roll_count), empty drops have a quantity of 0
+ *
+ * @return Number of non-empty drops
+ */
+int32 loot_table_roll(
+    const LootTable* const __restrict table,
+    uint64 seed, uint32 kill, int32 roll_count,
+    Drop* const __restrict drops
+) NO_EXCEPT
+{
+    const uint32 base = loot_kill_base(seed, kill);
+    const bool is_active = loot_table_is_active(table, base);
+
+    int32 drop_count = 0;
+    for (int32 i = 0; i < roll_count; ++i) {
+        const int32 outcome = is_active
+            ? loot_alias_sample(&table->alias, loot_rand(base, 2 * i), loot_rand(base, 2 * i + 1))
+            : table->item_count;
+
+        drop_count += loot_table_drop_fill(table, outcome, base, i, &drops[i]);
+    }
+
+    return drop_count;
+}
+
+#ifdef __AVX2__
+    // Vector version of loot_hash()
+    FORCE_INLINE
+    __m256i loot_hash_8(__m256i x) NO_EXCEPT
+    {
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+        x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7FEB352D));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+        x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int32) 0x846CA68B));
+
+        return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    }
+#endif
+
+#ifdef __SSE4_2__
+    FORCE_INLINE
+    __m128i loot_hash_4(__m128i x) NO_EXCEPT
+    {
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+        x = _mm_mullo_epi32(x, _mm_set1_epi32(0x7FEB352D));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+        x = _mm_mullo_epi32(x, _mm_set1_epi32((int32) 0x846CA68B));
+
+        return _mm_xor_si128(x, _mm_srli_epi32(x, 16));
     }
+#endif
+
+/**
+ * Samples the alias outcomes of the draws [start, start + count) of the kills [first_kill, ...)
+ *
+ * Draw j belongs to kill first_kill + j / roll_count and is roll j % roll_count of that kill.
+ * Returns the number of draws handled, the caller handles the remaining draws.
+ */
+static inline
+int32 loot_alias_sample_batch(
+    const LootAliasTable* const __restrict alias,
+    uint64 seed, uint32 first_kill, int32 roll_count,
+    int32 start, int32 count,
+    int32* const __restrict outcomes,
+    int32 steps
+) NO_EXCEPT
+{
+    PSEUDO_USE(alias);
+    PSEUDO_USE(seed);
+    PSEUDO_USE(first_kill);
+    PSEUDO_USE(roll_count);
+    PSEUDO_USE(start);
+    PSEUDO_USE(outcomes);
+    PSEUDO_USE(steps);
+
+    #ifdef __AVX2__
+        if (steps >= 8 && count >= 8) {
+            // The kill/roll of every lane is advanced incrementally to avoid divisions
+            alignas(32) int32 kills[8];
+            alignas(32) int32 rolls[8];
+            for (int32 i = 0; i < 8; ++i) {
+                kills[i] = (start + i) / roll_count;
+                rolls[i] = (start + i) % roll_count;
+            }
+
+            __m256i kill = _mm256_load_si256((const __m256i *) kills);
+            __m256i roll = _mm256_load_si256((const __m256i *) rolls);
+
+            const __m256i kill_step = _mm256_set1_epi32(8 / roll_count);
+            const __m256i roll_step = _mm256_set1_epi32(8 % roll_count);
+            const __m256i roll_max = _mm256_set1_epi32(roll_count - 1);
+            const __m256i roll_count_8 = _mm256_set1_epi32(roll_count);
+            const __m256i one = _mm256_set1_epi32(1);
+
+            const __m256i seed_lo = _mm256_set1_epi32((int32) (uint32) seed);
+            const __m256i seed_hi = _mm256_set1_epi32((int32) (uint32) (seed >> 32));
+            const __m256i kill_offset = _mm256_set1_epi32((int32) first_kill);
+            const __m256i golden = _mm256_set1_epi32((int32) 0x9E3779B9);
+            const __m256i column_mask = _mm256_set1_epi32(alias->column_count - 1);
+
+            int32 i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256i base = loot_hash_8(_mm256_add_epi32(
+                    loot_hash_8(_mm256_xor_si256(_mm256_add_epi32(kill, kill_offset), seed_lo)),
+                    seed_hi
+                ));
+
+                const __m256i stream = _mm256_add_epi32(roll, roll);
+                const __m256i r_column = loot_hash_8(_mm256_add_epi32(base, _mm256_mullo_epi32(stream, golden)));
+                const __m256i r_threshold = loot_hash_8(_mm256_add_epi32(
+                    base, _mm256_mullo_epi32(_mm256_add_epi32(stream, one), golden)
+                ));
+
+                const __m256i column = _mm256_and_si256(r_column, column_mask);
+                const __m256i threshold = _mm256_i32gather_epi32(alias->thresholds, column, 4);
+                const __m256i other = _mm256_i32gather_epi32(alias->aliases, column, 4);
+
+                const __m256i is_column = _mm256_cmpgt_epi32(threshold, _mm256_srli_epi32(r_threshold, 1));
+                _mm256_storeu_si256((__m256i *) (outcomes + i), _mm256_blendv_epi8(other, column, is_column));
+
+                // Next 8 draws
+                kill = _mm256_add_epi32(kill, kill_step);
+                roll = _mm256_add_epi32(roll, roll_step);
+
+                const __m256i wrap = _mm256_cmpgt_epi32(roll, roll_max);
+                roll = _mm256_sub_epi32(roll, _mm256_and_si256(wrap, roll_count_8));
+                kill = _mm256_sub_epi32(kill, wrap);
+            }
+
+            return i;
+        }
+    #endif
+
+    #ifdef __SSE4_2__
+        if (steps >= 4 && count >= 4) {
+            alignas(16) int32 kills[4];
+            alignas(16) int32 rolls[4];
+            for (int32 i = 0; i < 4; ++i) {
+                kills[i] = (start + i) / roll_count;
+                rolls[i] = (start + i) % roll_count;
+            }
+
+            __m128i kill = _mm_load_si128((const __m128i *) kills);
+            __m128i roll = _mm_load_si128((const __m128i *) rolls);
+
+            const __m128i kill_step = _mm_set1_epi32(4 / roll_count);
+            const __m128i roll_step = _mm_set1_epi32(4 % roll_count);
+            const __m128i roll_max = _mm_set1_epi32(roll_count - 1);
+            const __m128i roll_count_4 = _mm_set1_epi32(roll_count);
+            const __m128i one = _mm_set1_epi32(1);
+
+            const __m128i seed_lo = _mm_set1_epi32((int32) (uint32) seed);
+            const __m128i seed_hi = _mm_set1_epi32((int32) (uint32) (seed >> 32));
+            const __m128i kill_offset = _mm_set1_epi32((int32) first_kill);
+            const __m128i golden = _mm_set1_epi32((int32) 0x9E3779B9);
+            const __m128i column_mask = _mm_set1_epi32(alias->column_count - 1);
+
+            alignas(16) int32 columns[4];
+            alignas(16) int32 thresholds[4];
+
+            int32 i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128i base = loot_hash_4(_mm_add_epi32(
+                    loot_hash_4(_mm_xor_si128(_mm_add_epi32(kill, kill_offset), seed_lo)),
+                    seed_hi
+                ));
+
+                const __m128i stream = _mm_add_epi32(roll, roll);
+                const __m128i r_column = loot_hash_4(_mm_add_epi32(base, _mm_mullo_epi32(stream, golden)));
+                const __m128i r_threshold = loot_hash_4(_mm_add_epi32(
+                    base, _mm_mullo_epi32(_mm_add_epi32(stream, one), golden)
+                ));
+
+                // No gather instruction before AVX2
+                _mm_store_si128((__m128i *) columns, _mm_and_si128(r_column, column_mask));
+                _mm_store_si128((__m128i *) thresholds, _mm_srli_epi32(r_threshold, 1));
+
+                for (int32 j = 0; j < 4; ++j) {
+                    outcomes[i + j] = thresholds[j] < alias->thresholds[columns[j]]
+                        ? columns[j]
+                        : alias->aliases[columns[j]];
+                }
+
+                kill = _mm_add_epi32(kill, kill_step);
+                roll = _mm_add_epi32(roll, roll_step);
+
+                const __m128i wrap = _mm_cmpgt_epi32(roll, roll_max);
+                roll = _mm_sub_epi32(roll, _mm_and_si128(wrap, roll_count_4));
+                kill = _mm_sub_epi32(kill, wrap);
+            }
+
+            return i;
+        }
+    #endif
+
+    return 0;
+}
+
+/**
+ * Rolls the drops of many kills at once (e.g. boss kills or AoE farming)
+ *
+ * The result is identical to calling loot_table_roll() for every kill.
+ *
+ * @param table         Compiled loot table
+ * @param seed          Seed
+ * @param first_kill    Kill index of the first kill
+ * @param kill_count    Number of kills
+ * @param roll_count    Rolls per kill
+ * @param drops         Drops (kill_count * roll_count), kill by kill, empty drops have a quantity of 0
+ * @param steps         Max SIMD width (1 = scalar)
+ *
+ * @return Number of non-empty drops
+ */
+int32 loot_table_roll_batch(
+    const LootTable* const __restrict table,
+    uint64 seed, uint32 first_kill, int32 kill_count, int32 roll_count,
+    Drop* const __restrict drops,
+    int32 steps = 8
+) NO_EXCEPT
+{
+    ASSERT_TRUE(roll_count > 0 && roll_count < (int32) (LOOT_STREAM_QUANTITY / 2));
+
+    const int32 total = kill_count * roll_count;
+    int32 outcomes[LOOT_BATCH_SIZE];
+
+    int32 drop_count = 0;
+    int32 kill = 0;
+    int32 roll = 0;
+    uint32 base = loot_kill_base(seed, first_kill);
+    bool is_active = loot_table_is_active(table, base);
+
+    for (int32 start = 0; start < total; start += LOOT_BATCH_SIZE) {
+        const int32 count = OMS_MIN(LOOT_BATCH_SIZE, total - start);
+        const int32 simd_count = loot_alias_sample_batch(
+            &table->alias, seed, first_kill, roll_count, start, count, outcomes, steps
+        );
+
+        // The table chance and quantities are only rolled once per kill/drop -> not worth vectorizing
+        for (int32 i = 0; i < count; ++i) {
+            if (roll == roll_count) {
+                roll = 0;
+                ++kill;
+
+                base = loot_kill_base(seed, first_kill + kill);
+                is_active = loot_table_is_active(table, base);
+            }
+
+            int32 outcome = table->item_count;
+            if (is_active) {
+                outcome = i < simd_count
+                    ? outcomes[i]
+                    : loot_alias_sample(&table->alias, loot_rand(base, 2 * roll), loot_rand(base, 2 * roll + 1));
+            }
+
+            drop_count += loot_table_drop_fill(table, outcome, base, roll, &drops[start + i]);
+            ++roll;
+        }
+    }
+
+    return drop_count;
+}
+
+// Unseeded single drop, uses the thread local rng
+// @return false if nothing dropped
+bool loot_table_drop(const LootTable* table, Drop* drop) NO_EXCEPT
+{
+    if (rand_fast_percent() >= table->table_chance) {
+        return false;
+    }
+
+    const int32 outcome = loot_alias_sample(&table->alias, rand_fast_32(), rand_fast_32());
+
+    return loot_table_drop_fill(table, outcome, rand_fast_32(), 0, drop);
 }
 
 uint64 loot_table_drop_gold(const LootTable* table)
 {
-    if (table->gold_max_count == 0) {
+    if (table->gold.y == 0) {
         return 0;
     }
 
     f32 rand = rand_fast_percent();
-    if (rand > table->table_chance) {
+    if (rand > table->gold_drop_probability) {
         return 0;
     }
 
-    return OMS_MAX(table->gold_min_count, (uint64) ((f32) table->gold_max_count * rand));
+    return OMS_MAX(table->gold.x, (int32) ((f32) table->gold.y * rand));
 
     // WARNING: This is mathematically WRONG!
     //      The expected value of the version above is higher than what you would actually expect
     //      The correct version would be the one below (although slower)
     /*
     uint32 r = rand();
-    if (r > table->table_chance * RAND_MAX) {
+    if (r > table->gold_drop_probability * RAND_MAX) {
         return 0;
     }
 
-    return (r % (table->gold_max_count - table->gold_min_count + 1)) + table->gold_min_count;
+    return (r % (table->gold.y - table->gold.x + 1)) + table->gold.x;
     */
 }
 
-#endif
\ No newline at end of file
+#endif
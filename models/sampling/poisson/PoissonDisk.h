@@ -11,333 +11,726 @@
 #define COMS_MODELS_SAMPLING_POISSON_DISK_H
 
 #include "../../../stdlib/Stdlib.h"
+#include "../../../stdlib/Simd.h"
 #include "../../../memory/RingMemory.cpp"
+#include "../../../thread/ThreadPool.cpp"
+#include "../../../utils/RandomUtils.h"
+
+/**
+ * Bridson poisson disk sampling (blue noise point sets, e.g. vegetation and spawn placement)
+ *
+ * The domain is covered by a grid with a cell size of r_min / sqrt(2) -> every cell holds at most one point.
+ * The grid is stored as SoA (x, y, r) and padded on all sides, this way the neighbor test of a candidate
+ * is a few unaligned SIMD loads per grid row without any bounds checks (empty cells are far away).
+ *
+ * The grid is split into tiles that are processed in 4 phases (2x2 coloring of the tiles).
+ * Tiles of the same phase are at least one tile apart and only write into their own cells,
+ * which allows to run them in parallel. Every tile is seeded with the already existing points
+ * of its neighbors, which fills the tile borders seamlessly.
+ *
+ * Every tile has its own rng state derived from the seed,
+ * the result is the same for a given seed no matter how many threads are used.
+ */
+
+// Sentinel position of empty cells, far enough away to never conflict (and small enough to not overflow on squaring)
+#define POISSON_DISK_EMPTY 1.0e18f
+
+// Minimum tile size in cells
+#define POISSON_DISK_TILE_CELLS 32
+
+// Candidates that are generated at once
+#define POISSON_DISK_BATCH 8
+
+// Padding to the right of every grid row for the SIMD loads
+#define POISSON_DISK_SIMD_PADDING 8
+
+/**
+ * Importance of a position (must be thread safe if a thread pool is used)
+ *
+ * @return 0.0 - 1.0 where 1.0 uses r_min and 0.0 uses r_max as minimum distance
+ */
+typedef f32 (*PoissonDiskImportanceFunc)(f32 x, f32 y, void* data);
+
+struct PoissonDiskSampler {
+    // Grid (incl. padding), r is only used for importance sampling
+    f32* grid_x;
+    f32* grid_y;
+    f32* grid_r;
+
+    int32 grid_width;
+    int32 grid_height;
+    int32 stride;
+
+    // Padding cells on the left and top side of the grid
+    int32 padding;
+
+    f32 cell_size;
+    f32 inv_cell_size;
+
+    f32 width;
+    f32 height;
+    f32 r_min;
+    f32 r_max;
+    int32 k;
+    uint64 seed;
+
+    PoissonDiskImportanceFunc importance;
+    void* importance_data;
+
+    // Cells to check around a candidate
+    int32 window;
+
+    int32 tile_cells;
+    int32 tiles_x;
+    int32 tiles_y;
+
+    // Active list per tile, active_capacity elements per tile
+    int32* active;
+    int32 active_capacity;
+};
+
+struct PoissonDiskTileArg {
+    PoissonDiskSampler* sampler;
+    int32 tile;
+};
 
 // Calculates the amount of max points to generate
-size_t poisson_disk_bridson_cap(f64 width, f64 height, f64 r)
+// Upper bound based on the hexagonal packing (2 / (sqrt(3) * r^2) points per area), incl. the border
+inline
+int32 poisson_disk_bridson_cap(f32 width, f32 height, f32 r) NO_EXCEPT
 {
-    const f64 area = width * height;
-    const f64 approx_num = area / (OMS_PI_F32 * r * r);
+    const f32 area = (width + r) * (height + r);
 
-    return (size_t) (approx_num * 1.6 + 16.0);
+    return (int32) (area * 1.1547f / (r * r)) + 16;
 }
 
-/*
-* poisson_disk_bridson
-* - width, height : sampling rectangle size [0,width) x [0,height)
-* - r : minimum distance between points
-* - k : number of attempts per active sample (typical 30)
-* - returns number of samples generated
-*
-* Implementation notes for performance:
-* - grid cell size = r / intrin_sqrt_f64(2). Each occupied cell has at most one sample.
-* - grid stored as int32 array of indices into points array; -1 means empty.
-* - active list stored as int32 array used as stack with random removal implementation (swap-with-last)
-*/
-size_t poisson_disk_bridson(
-    f64 width, f64 height, f64 r, int32 k,
-    int32 points_size, v2_f64* __restrict out_points,
-    RingMemory* const __restrict ring
-) {
-    const f64 cell_size = r * OMS_INV_SQRT_2_F64;
-    const int32 grid_w = (int32) ceil(width / cell_size);
-    const int32 grid_h = (int32) ceil(height / cell_size);
-    const size_t grid_size = (size_t) grid_w * (size_t) grid_h;
+// Independent rng state per tile (splitmix64 finalizer)
+static inline
+uint64 poisson_disk_rng_state(uint64 seed, int32 index) NO_EXCEPT
+{
+    uint64 x = seed + 0x9E3779B97F4A7C15ULL * (uint64) (index + 1);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
 
-    int32* grid = (int32*) memory_get(ring, grid_size * sizeof(int32), sizeof(size_t));
-    for (size_t i = 0; i < grid_size; ++i) {
-        grid[i] = -1;
+    // The rng gets stuck at 0
+    return x ? x : 0x9E3779B97F4A7C15ULL;
+}
+
+FORCE_INLINE
+int32 poisson_disk_rand_index(uint64* state, int32 count) NO_EXCEPT
+{
+    return (int32) (((rand_fast(state) >> 32) * (uint64) count) >> 32);
+}
+
+// Two random f32 in [0, 1) from one rng call
+FORCE_INLINE
+void poisson_disk_rand2(uint64* state, f32* a, f32* b) NO_EXCEPT
+{
+    const uint64 x = rand_fast(state);
+    *a = (f32) (x >> 40) * (1.0f / 16777216.0f);
+    *b = (f32) ((x >> 8) & 0xFFFFFF) * (1.0f / 16777216.0f);
+}
+
+FORCE_INLINE
+int32 poisson_disk_cell_index(const PoissonDiskSampler* sampler, int32 cx, int32 cy) NO_EXCEPT
+{
+    return (cy + sampler->padding) * sampler->stride + cx + sampler->padding;
+}
+
+FORCE_INLINE
+f32 poisson_disk_radius(const PoissonDiskSampler* sampler, f32 x, f32 y) NO_EXCEPT
+{
+    if (!sampler->importance) {
+        return sampler->r_min;
     }
 
-    size_t cap = points_size; //poisson_disk_bridson_points(width, height, r);
+    const f32 importance = oms_clamp(sampler->importance(x, y, sampler->importance_data), 0.0f, 1.0f);
+
+    return sampler->r_max + (sampler->r_min - sampler->r_max) * importance;
+}
+
+/**
+ * Checks count consecutive cells of a grid row for points closer than max(r, r_cell)
+ *
+ * Reads up to POISSON_DISK_SIMD_PADDING - 1 cells after count (covered by the grid padding)
+ */
+static inline
+bool poisson_disk_row_conflict(
+    const f32* __restrict xs, const f32* __restrict ys, const f32* __restrict rs,
+    int32 count, f32 x, f32 y, f32 r
+) NO_EXCEPT
+{
+    int32 i = 0;
+
+    #if defined(__AVX2__)
+        const __m256 vx = _mm256_set1_ps(x);
+        const __m256 vy = _mm256_set1_ps(y);
+        const __m256 vr = _mm256_set1_ps(r);
+
+        for (; i < count; i += 8) {
+            const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vx);
+            const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vy);
+            const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            const __m256 rr = rs ? _mm256_max_ps(_mm256_loadu_ps(rs + i), vr) : vr;
+
+            int32 mask = _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_mul_ps(rr, rr), _CMP_LT_OQ));
+            if (count - i < 8) {
+                mask &= (1 << (count - i)) - 1;
+            }
 
-    v2_f64* points = (v2_f64 *) memory_get(ring, cap * sizeof(v2_f64));
-    int32* active = (int32 *) memory_get(ring, cap * sizeof(int32));
-    memset(active, 0, cap * sizeof(int32));
+            if (mask) {
+                return true;
+            }
+        }
+    #elif defined(__SSE4_2__)
+        const __m128 vx = _mm_set1_ps(x);
+        const __m128 vy = _mm_set1_ps(y);
+        const __m128 vr = _mm_set1_ps(r);
+
+        for (; i < count; i += 4) {
+            const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), vx);
+            const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), vy);
+            const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            const __m128 rr = rs ? _mm_max_ps(_mm_loadu_ps(rs + i), vr) : vr;
+
+            int32 mask = _mm_movemask_ps(_mm_cmplt_ps(d2, _mm_mul_ps(rr, rr)));
+            if (count - i < 4) {
+                mask &= (1 << (count - i)) - 1;
+            }
 
-    size_t points_count = 0;
-    size_t active_count = 0;
+            if (mask) {
+                return true;
+            }
+        }
+    #else
+        for (; i < count; ++i) {
+            const f32 dx = xs[i] - x;
+            const f32 dy = ys[i] - y;
+            const f32 rr = rs ? oms_max(rs[i], r) : r;
+
+            if (dx * dx + dy * dy < rr * rr) {
+                return true;
+            }
+        }
+    #endif
 
-    while (active_count > 0) {
-        // choose a random active index: uniform in [0, active_count)
-        size_t rand_pos = (size_t) (rand_uniform01() * (f64) active_count);
+    return false;
+}
 
-        if (rand_pos >= active_count) {
-            rand_pos = active_count - 1;
+static inline
+bool poisson_disk_is_free(const PoissonDiskSampler* sampler, f32 x, f32 y, f32 r) NO_EXCEPT
+{
+    const int32 cx = (int32) (x * sampler->inv_cell_size);
+    const int32 cy = (int32) (y * sampler->inv_cell_size);
+    const int32 n = sampler->window;
+
+    for (int32 dy = -n; dy <= n; ++dy) {
+        const int32 index = poisson_disk_cell_index(sampler, cx - n, cy + dy);
+
+        if (poisson_disk_row_conflict(
+                sampler->grid_x + index, sampler->grid_y + index,
+                sampler->grid_r ? sampler->grid_r + index : NULL,
+                2 * n + 1, x, y, r
+            )
+        ) {
+            return false;
         }
+    }
 
-        int32 active_idx = active[rand_pos];
-        f64 ax = points[active_idx].x;
-        f64 ay = points[active_idx].y;
+    return true;
+}
 
-        int32 found = 0;
-        for (int32 attempt = 0; attempt < k; ++attempt) {
-            /**
-            * sample radius uniformly in [r, 2r) with area correction: use intrin_sqrt_f64(u)
-            * sample angle uniformly in [0, 2pi)
-            */
-            f64 u = rand_uniform01();
+FORCE_INLINE
+int32 poisson_disk_insert(PoissonDiskSampler* sampler, f32 x, f32 y, f32 r) NO_EXCEPT
+{
+    const int32 index = poisson_disk_cell_index(
+        sampler,
+        (int32) (x * sampler->inv_cell_size),
+        (int32) (y * sampler->inv_cell_size)
+    );
+
+    sampler->grid_x[index] = x;
+    sampler->grid_y[index] = y;
+    if (sampler->grid_r) {
+        sampler->grid_r[index] = r;
+    }
 
-            // in [r, 2r) biased appropriately
-            // @performance we could pre-compute sqrt(u) in batches of 4/8
-            // because we need this multiple times anyways
-            f64 radius = r + r * intrin_sqrt_f64(u);
+    return index;
+}
 
-            f64 theta = OMS_TWO_PI_F32 * rand_uniform01();
+// Runs bridson for one tile, only creates points inside of the tile
+static
+void poisson_disk_tile(PoissonDiskSampler* sampler, int32 tile) NO_EXCEPT
+{
+    const int32 tx = tile % sampler->tiles_x;
+    const int32 ty = tile / sampler->tiles_x;
+
+    const int32 cx0 = tx * sampler->tile_cells;
+    const int32 cy0 = ty * sampler->tile_cells;
+    const int32 cx1 = OMS_MIN(cx0 + sampler->tile_cells, sampler->grid_width);
+    const int32 cy1 = OMS_MIN(cy0 + sampler->tile_cells, sampler->grid_height);
+
+    const f32 min_x = (f32) cx0 * sampler->cell_size;
+    const f32 min_y = (f32) cy0 * sampler->cell_size;
+    const f32 max_x = oms_min((f32) cx1 * sampler->cell_size, sampler->width);
+    const f32 max_y = oms_min((f32) cy1 * sampler->cell_size, sampler->height);
+
+    // The tile is checked by cell index, the same way the cell of a point is calculated
+    #define POISSON_DISK_IN_TILE(x, y) ((x) >= 0.0f && (y) >= 0.0f \
+        && (x) < sampler->width && (y) < sampler->height \
+        && (int32) ((x) * sampler->inv_cell_size) >= cx0 && (int32) ((x) * sampler->inv_cell_size) < cx1 \
+        && (int32) ((y) * sampler->inv_cell_size) >= cy0 && (int32) ((y) * sampler->inv_cell_size) < cy1)
+
+    uint64 rng = poisson_disk_rng_state(sampler->seed, tile);
+
+    int32* active = sampler->active + (size_t) tile * sampler->active_capacity;
+    int32 active_count = 0;
+
+    // Seed with the points of the already processed neighbor tiles that can reach into this tile
+    const int32 reach = 2 * sampler->window;
+    const int32 sx0 = OMS_MAX(cx0 - reach, 0);
+    const int32 sy0 = OMS_MAX(cy0 - reach, 0);
+    const int32 sx1 = OMS_MIN(cx1 + reach, sampler->grid_width);
+    const int32 sy1 = OMS_MIN(cy1 + reach, sampler->grid_height);
+
+    for (int32 cy = sy0; cy < sy1; ++cy) {
+        for (int32 cx = sx0; cx < sx1; ++cx) {
+            const int32 index = poisson_disk_cell_index(sampler, cx, cy);
+            if (sampler->grid_x[index] != POISSON_DISK_EMPTY) {
+                active[active_count++] = index;
+            }
+        }
+    }
 
-            f64 s, c;
-            SINCOS(theta, s, c);
+    // Random start point if no neighbor reaches into this tile
+    for (int32 attempt = 0; attempt < sampler->k && !active_count; ++attempt) {
+        f32 u, v;
+        poisson_disk_rand2(&rng, &u, &v);
 
-            f64 nx = ax + radius * c;
-            f64 ny = ay + radius * s;
+        const f32 x = min_x + u * (max_x - min_x);
+        const f32 y = min_y + v * (max_y - min_y);
+        if (!POISSON_DISK_IN_TILE(x, y)) {
+            continue;
+        }
 
-            // reject if outside domain
-            if (nx < 0.0 || nx >= width || ny < 0.0 || ny >= height)
-                continue;
+        const f32 r = poisson_disk_radius(sampler, x, y);
+        if (poisson_disk_is_free(sampler, x, y, r)) {
+            active[active_count++] = poisson_disk_insert(sampler, x, y, r);
+        }
+    }
 
-            /**
-             * check neighbors fast via grid
-             * compute candidate's cell
-             */
-            int32 cgx = (int32) (nx / cell_size);
-            int32 cgy = (int32) (ny / cell_size);
+    f32 cand_x[POISSON_DISK_BATCH];
+    f32 cand_y[POISSON_DISK_BATCH];
 
-            if (cgx < 0) {
-                cgx = 0;
-            }
+    while (active_count > 0) {
+        const int32 pos = poisson_disk_rand_index(&rng, active_count);
+        const int32 index = active[pos];
+
+        const f32 ax = sampler->grid_x[index];
+        const f32 ay = sampler->grid_y[index];
+        const f32 ar = sampler->grid_r ? sampler->grid_r[index] : sampler->r_min;
+
+        bool found = false;
+        int32 attempts = 0;
+        while (attempts < sampler->k && !found) {
+            // Candidates are uniformly distributed in the annulus [r, 2r), created by rejection sampling in the square
+            // Only candidates in the annulus count as attempt
+            int32 batch = 0;
+            for (int32 i = 0; i < POISSON_DISK_BATCH; ++i) {
+                f32 u, v;
+                poisson_disk_rand2(&rng, &u, &v);
+
+                const f32 dx = (u * 4.0f - 2.0f) * ar;
+                const f32 dy = (v * 4.0f - 2.0f) * ar;
+                const f32 d2 = dx * dx + dy * dy;
+
+                const f32 x = ax + dx;
+                const f32 y = ay + dy;
+
+                if (d2 < ar * ar || d2 >= 4.0f * ar * ar) {
+                    continue;
+                }
 
-            if (cgx >= grid_w) {
-                cgx = grid_w - 1;
-            }
+                ++attempts;
+                if (!POISSON_DISK_IN_TILE(x, y)) {
+                    continue;
+                }
 
-            if (cgy < 0) {
-                cgy = 0;
+                cand_x[batch] = x;
+                cand_y[batch] = y;
+                ++batch;
             }
 
-            if (cgy >= grid_h) {
-                cgy = grid_h - 1;
-            }
+            for (int32 i = 0; i < batch; ++i) {
+                const f32 r = poisson_disk_radius(sampler, cand_x[i], cand_y[i]);
 
-            /* Check nearby cells for conflicts; uses macro that jumps to REJECTED label on violation */
-            int32 min_gx = (int32) oms_floor(((nx) - r) / cell_size);
-            int32 max_gx = (int32) oms_floor(((nx) + r) / cell_size);
-            int32 min_gy = (int32) oms_floor(((ny) - r) / cell_size);
-            int32 max_gy = (int32) oms_floor(((ny) + r) / cell_size);
+                if (poisson_disk_is_free(sampler, cand_x[i], cand_y[i], r)) {
+                    active[active_count++] = poisson_disk_insert(sampler, cand_x[i], cand_y[i], r);
+                    found = true;
 
-            if (min_gx < 0) {
-                min_gx = 0;
+                    break;
+                }
             }
+        }
 
-            if (max_gx >= grid_w) {
-                max_gx = grid_w - 1;
-            }
+        if (!found) {
+            active[pos] = active[--active_count];
+        }
+    }
 
-            if (min_gy < 0) {
-                min_gy = 0;
-            }
+    #undef POISSON_DISK_IN_TILE
+}
 
-            if (max_gy >= grid_h) {
-                max_gy = grid_h - 1;
+static
+void thrd_poisson_disk_tile(void* arg) NO_EXCEPT
+{
+    const PoolWorker* job = (const PoolWorker *) arg;
+    const PoissonDiskTileArg* tile = (const PoissonDiskTileArg *) job->arg;
+
+    poisson_disk_tile(tile->sampler, tile->tile);
+}
+
+static
+void poisson_disk_sampler_init(
+    PoissonDiskSampler* sampler,
+    f32 width, f32 height, f32 r_min, f32 r_max, int32 k, uint64 seed,
+    PoissonDiskImportanceFunc importance, void* importance_data,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    memset(sampler, 0, sizeof(*sampler));
+
+    sampler->width = width;
+    sampler->height = height;
+    sampler->r_min = r_min;
+    sampler->r_max = oms_max(r_min, r_max);
+    sampler->k = k;
+    sampler->seed = seed;
+    sampler->importance = importance;
+    sampler->importance_data = importance_data;
+
+    sampler->cell_size = r_min * OMS_INV_SQRT_2_F32;
+    sampler->inv_cell_size = 1.0f / sampler->cell_size;
+    sampler->grid_width = OMS_MAX((int32) ceilf(width * sampler->inv_cell_size), 1);
+    sampler->grid_height = OMS_MAX((int32) ceilf(height * sampler->inv_cell_size), 1);
+
+    sampler->window = (int32) ceilf(sampler->r_max * sampler->inv_cell_size);
+    sampler->padding = sampler->window;
+    sampler->stride = sampler->grid_width + 2 * sampler->window + POISSON_DISK_SIMD_PADDING;
+
+    const size_t grid_size = (size_t) sampler->stride * (sampler->grid_height + 2 * sampler->window);
+
+    sampler->grid_x = (f32 *) memory_get(ring, grid_size * sizeof(f32), 64);
+    sampler->grid_y = (f32 *) memory_get(ring, grid_size * sizeof(f32), 64);
+    if (importance) {
+        sampler->grid_r = (f32 *) memory_get(ring, grid_size * sizeof(f32), 64);
+        memset(sampler->grid_r, 0, grid_size * sizeof(f32));
+    }
+
+    for (size_t i = 0; i < grid_size; ++i) {
+        sampler->grid_x[i] = POISSON_DISK_EMPTY;
+        sampler->grid_y[i] = POISSON_DISK_EMPTY;
+    }
+
+    // The neighbor seeding reads up to 2 * window cells into the neighbor tiles,
+    // which must not reach a tile of the same phase
+    sampler->tile_cells = OMS_MAX(POISSON_DISK_TILE_CELLS, 2 * (2 * sampler->window) + 1);
+    sampler->tiles_x = (sampler->grid_width + sampler->tile_cells - 1) / sampler->tile_cells;
+    sampler->tiles_y = (sampler->grid_height + sampler->tile_cells - 1) / sampler->tile_cells;
+
+    const int32 active_cells = sampler->tile_cells + 4 * sampler->window;
+    sampler->active_capacity = active_cells * active_cells;
+    sampler->active = (int32 *) memory_get(
+        ring,
+        (size_t) sampler->tiles_x * sampler->tiles_y * sampler->active_capacity * sizeof(int32),
+        64
+    );
+}
+
+static
+void poisson_disk_sampler_run(PoissonDiskSampler* sampler, RingMemory* const ring, ThreadPool* pool) NO_EXCEPT
+{
+    const int32 tile_count = sampler->tiles_x * sampler->tiles_y;
+
+    PoissonDiskTileArg* args = NULL;
+    if (pool) {
+        args = (PoissonDiskTileArg *) memory_get(ring, tile_count * sizeof(PoissonDiskTileArg));
+    }
+
+    for (int32 phase = 0; phase < 4; ++phase) {
+        PoolWorker* jobs[64];
+        int32 job_count = 0;
+
+        for (int32 tile = 0; tile < tile_count; ++tile) {
+            const int32 tx = tile % sampler->tiles_x;
+            const int32 ty = tile / sampler->tiles_x;
+
+            if ((tx & 1) + 2 * (ty & 1) != phase) {
+                continue;
             }
 
-            int32 too_close = 0;
-            for (int32 gj = min_gy; gj <= max_gy && !too_close; ++gj) {
-                size_t base = (size_t)gj * grid_w;
-                for (int32 gi = min_gx; gi <= max_gx; ++gi) {
-                    int32 idx = grid[base + gi];
-                    if (idx != -1) {
-                        f64 dx = points[idx].x - nx;
-                        f64 dy = points[idx].y - ny;
-                        if ((dx * dx + dy*dy) < (r * r)) {
-                            too_close = 1;
-                            break;
-                        }
-                    }
-                }
+            if (!pool) {
+                poisson_disk_tile(sampler, tile);
+                continue;
             }
 
-            if (too_close) {
+            args[tile] = { sampler, tile };
+
+            const PoolWorker job = {
+                0, // .id =
+                POOL_WORKER_STATE_WAITING, // .state =
+                true, // .atomic_release =
+                0, // .arg_size =
+                &args[tile], // .arg =
+                thrd_poisson_disk_tile, // .func =
+                NULL, // .callback =
+                0, // .mem_size =
+                NULL // .mem =
+            };
+
+            PoolWorker* const worker = thread_pool_add_work(pool, &job);
+            if (!worker) {
+                // The queue is full -> we do the work ourselves
+                poisson_disk_tile(sampler, tile);
                 continue;
             }
 
-            if (points_count >= cap) {
-                // We don't allow more points than defined by the user
-                return points_count;
+            jobs[job_count++] = worker;
 
-                // No conflict — accept point
-                /*
-                // @todo: Ideally we don't want this to happen
-                ASSERT_TRUE(points_count < cap);
+            if (job_count == ARRAY_COUNT(jobs)) {
+                thread_pool_join(jobs, job_count);
+                job_count = 0;
+            }
+        }
 
-                size_t newcap = cap * 2;
+        // The next phase reads the points of this phase
+        if (job_count) {
+            thread_pool_join(jobs, job_count);
+        }
+    }
+}
 
-                active = (int32 *) ring_grow_memory(ring, active, newcap * sizeof(int32));
-                points = (v2_f64 *) ring_grow_memory(ring, points, newcap * sizeof(v2_f64));
-                memset(active + cap, 0, (newcap - cap) * sizeof(int32));
+// Collects the points in grid order (deterministic, independent of the processing order)
+static
+int32 poisson_disk_sampler_points(const PoissonDiskSampler* sampler, v2_f32* out_points, int32 points_size) NO_EXCEPT
+{
+    int32 count = 0;
 
-                cap = newcap;
+    for (int32 cy = 0; cy < sampler->grid_height; ++cy) {
+        const int32 row = poisson_disk_cell_index(sampler, 0, cy);
 
-                // grid stays same
-                */
+        for (int32 cx = 0; cx < sampler->grid_width && count < points_size; ++cx) {
+            if (sampler->grid_x[row + cx] == POISSON_DISK_EMPTY) {
+                continue;
             }
 
-            points[points_count].x = nx;
-            points[points_count].y = ny;
-            size_t cidx = (size_t)cgy * grid_w + cgx;
-            grid[cidx] = (int32) points_count;
-            active[active_count++] = (int32) points_count;
-            ++points_count;
-            found = 1;
-
-            break;
-        }
-
-        if (!found) {
-            // remove active_idx from active list by swapping with last element
-            active[rand_pos] = active[active_count - 1];
-            --active_count;
+            out_points[count].x = sampler->grid_x[row + cx];
+            out_points[count].y = sampler->grid_y[row + cx];
+            ++count;
         }
     }
 
-    return points_count;
+    return count;
+}
+
+/**
+ * poisson_disk_bridson
+ *
+ * @param width         Sampling rectangle [0, width) x [0, height)
+ * @param height        Sampling rectangle
+ * @param r             Minimum distance between points
+ * @param k             Attempts per active sample (typical 30)
+ * @param seed          Same seed -> same points
+ * @param points_size   Capacity of out_points (see poisson_disk_bridson_cap)
+ * @param out_points    Points in row order of the grid
+ * @param ring          Temporary memory
+ * @param pool          Optional thread pool for the tile processing
+ *
+ * @return Number of points generated
+ */
+int32 poisson_disk_bridson(
+    f32 width, f32 height, f32 r, int32 k, uint64 seed,
+    int32 points_size, v2_f32* __restrict out_points,
+    RingMemory* const __restrict ring,
+    ThreadPool* pool = NULL
+) NO_EXCEPT
+{
+    PoissonDiskSampler sampler;
+    poisson_disk_sampler_init(&sampler, width, height, r, r, k, seed, NULL, NULL, ring);
+    poisson_disk_sampler_run(&sampler, ring, pool);
+
+    return poisson_disk_sampler_points(&sampler, out_points, points_size);
 }
 
 // This function returns samples based on an importance function
 // The importance function could even use a input image / shadow map for this
 // This would allow to generate more sample points based on focus points
-size_t poisson_disk_bridson_importance(
-    f64 width, f64 height, f64 r, int32 k,
-    int32 points_size, v2_f64* __restrict out_points,
+// The minimum distance between two points is the larger radius of both points
+int32 poisson_disk_bridson_importance(
+    f32 width, f32 height, f32 r_min, f32 r_max, int32 k, uint64 seed,
+    int32 points_size, v2_f32* __restrict out_points,
     RingMemory* const __restrict ring,
-    ImportanceFn importance, void *userdata,
-    f64 max_importance
-) {
-    /* sanity clamp for provided bounds */
-    if (max_importance < 1e-6) max_importance = 1.0;
-
-    /* cell size uses the *smallest* local radius = r / intrin_sqrt_f64(max_importance) */
-    const f64 min_local_r = r / intrin_sqrt_f64(max_importance);
-    const f64 cell_size = min_local_r * OMS_INV_SQRT_2_F64;
-    const int32 grid_w = (int32) ceil(width / cell_size);
-    const int32 grid_h = (int32) ceil(height / cell_size);
-    const size_t grid_size = (size_t) grid_w * (size_t) grid_h;
-
-    int32* grid = (int32*) memory_get(ring, grid_size * sizeof(int32), sizeof(size_t));
-    if (!grid) return 0;
-    for (size_t i = 0; i < grid_size; ++i) grid[i] = -1;
-
-    size_t cap = (size_t) points_size;
-
-    v2_f64* points = out_points; /* already provided by caller */
-    int32* active = (int32*) memory_get(ring, cap * sizeof(int32), sizeof(int32));
-    if (!active) return 0;
-    memset(active, 0, cap * sizeof(int32));
-
-    size_t points_count = 0;
-    size_t active_count = 0;
-
-    /* small clamp to avoid divide by zero or insanely large local radii */
-    const f64 min_importance_clamp = 1e-6;
-
-    /* --- create first sample uniformly --- */
-    {
-        f64 x0 = rand_uniform01() * width;
-        f64 y0 = rand_uniform01() * height;
-
-        /* accept immediately (no neighbor conflict yet) */
-        points[points_count].x = x0;
-        points[points_count].y = y0;
-
-        int32 gx = (int32) (x0 / cell_size);
-        int32 gy = (int32) (y0 / cell_size);
-        if (gx < 0) gx = 0; if (gx >= grid_w) gx = grid_w - 1;
-        if (gy < 0) gy = 0; if (gy >= grid_h) gy = grid_h - 1;
-        size_t gidx = (size_t)gy * grid_w + gx;
-        grid[gidx] = (int32) points_count;
-
-        active[active_count++] = (int32) points_count;
-        ++points_count;
+    PoissonDiskImportanceFunc importance, void* userdata,
+    ThreadPool* pool = NULL
+) NO_EXCEPT
+{
+    PoissonDiskSampler sampler;
+    poisson_disk_sampler_init(&sampler, width, height, r_min, r_max, k, seed, importance, userdata, ring);
+    poisson_disk_sampler_run(&sampler, ring, pool);
+
+    return poisson_disk_sampler_points(&sampler, out_points, points_size);
+}
+
+FORCE_INLINE
+uint32 poisson_disk_sphere_hash(int32 x, int32 y, int32 z) NO_EXCEPT
+{
+    return ((uint32) x * 73856093U) ^ ((uint32) y * 19349663U) ^ ((uint32) z * 83492791U);
+}
+
+FORCE_INLINE
+int32* poisson_disk_sphere_slot(
+    int32* table, const int32* keys, uint32 mask,
+    int32 x, int32 y, int32 z
+) NO_EXCEPT
+{
+    uint32 slot = poisson_disk_sphere_hash(x, y, z) & mask;
+    while (table[slot] >= 0
+        && (keys[slot * 3] != x || keys[slot * 3 + 1] != y || keys[slot * 3 + 2] != z)
+    ) {
+        slot = (slot + 1) & mask;
     }
 
-    while (active_count > 0) {
-        size_t rand_pos = (size_t) (rand_uniform01() * (f64) active_count);
-        if (rand_pos >= active_count) rand_pos = active_count - 1;
+    return &table[slot];
+}
+
+static inline
+void poisson_disk_sphere_insert(
+    int32* table, int32* keys, uint32 mask, f32 inv_cell_size,
+    v3_f32 p, int32 index
+) NO_EXCEPT
+{
+    const int32 gx = (int32) floorf(p.x * inv_cell_size);
+    const int32 gy = (int32) floorf(p.y * inv_cell_size);
+    const int32 gz = (int32) floorf(p.z * inv_cell_size);
 
-        int32 active_idx = active[rand_pos];
-        f64 ax = points[active_idx].x;
-        f64 ay = points[active_idx].y;
+    int32* slot = poisson_disk_sphere_slot(table, keys, mask, gx, gy, gz);
+    *slot = index;
+
+    keys[(slot - table) * 3] = gx;
+    keys[(slot - table) * 3 + 1] = gy;
+    keys[(slot - table) * 3 + 2] = gz;
+}
+
+/**
+ * Poisson disk sampling on the unit sphere
+ *
+ * A dense 3D grid would mostly be empty, instead the occupied cells (chord / sqrt(3)) are stored in a hash table
+ *
+ * @param r Minimum angular distance between points (radians), scale the points for other sphere sizes
+ *
+ * @return Number of points generated
+ */
+int32 poisson_disk_bridson_sphere(
+    f32 r, int32 k, uint64 seed,
+    int32 points_size, v3_f32* __restrict out_points,
+    RingMemory* const __restrict ring
+) NO_EXCEPT
+{
+    if (points_size <= 0) {
+        return 0;
+    }
 
-        int32 found = 0;
+    const f32 chord = 2.0f * sinf(r * 0.5f);
+    const f32 chord2 = chord * chord;
+    const f32 inv_cell_size = sqrtf(3.0f) / chord;
+
+    // Load factor <= 0.5
+    uint32 capacity = 16;
+    while (capacity < (uint32) points_size * 2) {
+        capacity <<= 1;
+    }
+
+    const uint32 mask = capacity - 1;
+
+    int32* table = (int32 *) memory_get(ring, capacity * sizeof(int32), 64);
+    int32* keys = (int32 *) memory_get(ring, capacity * 3 * sizeof(int32), 64);
+    int32* active = (int32 *) memory_get(ring, points_size * sizeof(int32), 64);
+    memset(table, 0xFF, capacity * sizeof(int32));
+
+    uint64 rng = poisson_disk_rng_state(seed, 0);
+
+    // Uniform start point
+    f32 u, v;
+    poisson_disk_rand2(&rng, &u, &v);
+
+    const f32 z0 = 2.0f * u - 1.0f;
+    const f32 ring_r = sqrtf(oms_max(0.0f, 1.0f - z0 * z0));
+
+    f32 s, c;
+    SINCOSF(OMS_TWO_PI_F32 * v, s, c);
+    out_points[0] = { ring_r * c, ring_r * s, z0 };
+
+    poisson_disk_sphere_insert(table, keys, mask, inv_cell_size, out_points[0], 0);
+
+    int32 count = 1;
+    int32 active_count = 0;
+    active[active_count++] = 0;
+
+    while (active_count > 0 && count < points_size) {
+        const int32 pos = poisson_disk_rand_index(&rng, active_count);
+        const v3_f32 p = out_points[active[pos]];
+
+        // Tangent frame of p
+        v3_f32 t = fabsf(p.x) < 0.9f
+            ? v3_f32{0.0f, -p.z, p.y}
+            : v3_f32{p.z, 0.0f, -p.x};
+
+        const f32 t_len = 1.0f / sqrtf(t.x * t.x + t.y * t.y + t.z * t.z);
+        t.x *= t_len; t.y *= t_len; t.z *= t_len;
+
+        const v3_f32 b = {
+            p.y * t.z - p.z * t.y,
+            p.z * t.x - p.x * t.z,
+            p.x * t.y - p.y * t.x
+        };
+
+        bool found = false;
         for (int32 attempt = 0; attempt < k; ++attempt) {
-            /* sample radius and angle (area-corrected) */
-            f64 u = rand_uniform01();
-            f64 radius = r + r * intrin_sqrt_f64(u); /* in [r, 2r) like original */
-            f64 theta = OMS_TWO_PI_F32 * rand_uniform01();
-            f64 s, c; SINCOS(theta, s, c);
-            f64 nx = ax + radius * c;
-            f64 ny = ay + radius * s;
-
-            if (nx < 0.0 || nx >= width || ny < 0.0 || ny >= height) {
-                continue;
-            }
+            poisson_disk_rand2(&rng, &u, &v);
+
+            // Geodesic distance in [r, 2r), area corrected
+            const f32 d = r * sqrtf(1.0f + 3.0f * u);
+
+            f32 sd, cd, st, ct;
+            SINCOSF(d, sd, cd);
+            SINCOSF(OMS_TWO_PI_F32 * v, st, ct);
+
+            const v3_f32 q = {
+                p.x * cd + (t.x * ct + b.x * st) * sd,
+                p.y * cd + (t.y * ct + b.y * st) * sd,
+                p.z * cd + (t.z * ct + b.z * st) * sd
+            };
+
+            const int32 gx = (int32) floorf(q.x * inv_cell_size);
+            const int32 gy = (int32) floorf(q.y * inv_cell_size);
+            const int32 gz = (int32) floorf(q.z * inv_cell_size);
+
+            bool too_close = false;
+            for (int32 dz = -2; dz <= 2 && !too_close; ++dz) {
+                for (int32 dy = -2; dy <= 2 && !too_close; ++dy) {
+                    for (int32 dx = -2; dx <= 2; ++dx) {
+                        const int32 index = *poisson_disk_sphere_slot(table, keys, mask, gx + dx, gy + dy, gz + dz);
+                        if (index < 0) {
+                            continue;
+                        }
+
+                        const f32 ex = out_points[index].x - q.x;
+                        const f32 ey = out_points[index].y - q.y;
+                        const f32 ez = out_points[index].z - q.z;
 
-            /* clamp candidate importance */
-            f64 w_cand = importance ? importance(nx, ny, userdata) : 1.0;
-            if (w_cand < min_importance_clamp) w_cand = min_importance_clamp;
-            if (w_cand > max_importance) w_cand = max_importance;
-
-            /* candidate's local radius used as guide (conservative mapping) */
-            f64 local_r_cand = r / intrin_sqrt_f64(w_cand);
-
-            /* find candidate's cell (clamp) */
-            int32 cgx = (int32) (nx / cell_size);
-            int32 cgy = (int32) (ny / cell_size);
-            if (cgx < 0) cgx = 0;
-            if (cgx >= grid_w) cgx = grid_w - 1;
-            if (cgy < 0) cgy = 0;
-            if (cgy >= grid_h) cgy = grid_h - 1;
-
-            /* compute neighborhood window in cells to check.
-               conservative radius: use candidate's local radius rounded up to cells,
-               but also ensure at least one-cell radius to catch neighbors that might have
-               larger local radii. Because grid cell_size is derived from the smallest
-               local radius (densest region) this remains safe and reasonably small. */
-            int32 cell_radius = (int32) ceil(local_r_cand / cell_size);
-            if (cell_radius < 1) cell_radius = 1;
-            /* also clamp to a small max to avoid huge sweeps; in practice importance maps should be bounded */
-            const int32 MAX_CELL_RADIUS = 8;
-            if (cell_radius > MAX_CELL_RADIUS) cell_radius = MAX_CELL_RADIUS;
-
-            int32 min_gx = cgx - cell_radius;
-            int32 max_gx = cgx + cell_radius;
-            int32 min_gy = cgy - cell_radius;
-            int32 max_gy = cgy + cell_radius;
-
-            if (min_gx < 0) min_gx = 0;
-            if (min_gy < 0) min_gy = 0;
-            if (max_gx >= grid_w) max_gx = grid_w - 1;
-            if (max_gy >= grid_h) max_gy = grid_h - 1;
-
-            // neighbor check
-            int32 too_close = 0;
-            for (int32 gj = min_gy; gj <= max_gy && !too_close; ++gj) {
-                size_t base = (size_t) gj * grid_w;
-                for (int32 gi = min_gx; gi <= max_gx; ++gi) {
-                    int32 idx = grid[base + gi];
-                    if (idx != -1) {
-                        /* neighbor position */
-                        f64 dx = points[idx].x - nx;
-                        f64 dy = points[idx].y - ny;
-                        /* neighbor importance and local radius (clamped) */
-                        f64 w_nei = importance ? importance(points[idx].x, points[idx].y, userdata) : 1.0;
-                        if (w_nei < min_importance_clamp) w_nei = min_importance_clamp;
-                        if (w_nei > max_importance) w_nei = max_importance;
-                        f64 local_r_nei = r / intrin_sqrt_f64(w_nei);
-
-                        /* conservative combined distance: use max(local_r_cand, local_r_nei) */
-                        f64 forbid_r = (local_r_cand > local_r_nei) ? local_r_cand : local_r_nei;
-                        if ((dx * dx + dy * dy) < (forbid_r * forbid_r)) {
-                            too_close = 1;
+                        if (ex * ex + ey * ey + ez * ez < chord2) {
+                            too_close = true;
                             break;
                         }
                     }
@@ -348,30 +741,21 @@ size_t poisson_disk_bridson_importance(
                 continue;
             }
 
-            // if buffer full, return early (user requested fixed capacity)
-            if (points_count >= cap) {
-                return points_count;
-            }
+            out_points[count] = q;
+            poisson_disk_sphere_insert(table, keys, mask, inv_cell_size, q, count);
+
+            active[active_count++] = count++;
+            found = true;
 
-            // accept candidate
-            points[points_count].x = nx;
-            points[points_count].y = ny;
-            size_t cidx = (size_t) cgy * grid_w + cgx;
-            grid[cidx] = (int32) points_count;
-            active[active_count++] = (int32) points_count;
-            ++points_count;
-            found = 1;
             break;
         }
 
         if (!found) {
-            // remove active_idx from active list by swapping with last element
-            active[rand_pos] = active[active_count - 1];
-            --active_count;
+            active[pos] = active[--active_count];
         }
     }
 
-    return points_count;
+    return count;
 }
 
-#endif
\ No newline at end of file
+#endif
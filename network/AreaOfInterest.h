@@ -0,0 +1,423 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_NETWORK_AREA_OF_INTEREST_H
+#define COMS_NETWORK_AREA_OF_INTEREST_H
+
+#include "../stdlib/Stdlib.h"
+#include "../system/Allocator.h"
+#include "../log/Log.h"
+
+// Decides which entities are relevant for which client (= which mob updates are sent to which player)
+// The entities are stored in a uniform grid on the x/z plane.
+// Updating a client only visits the grid cells in its view radius and its previous relevance set
+// -> the cost depends on the nearby entities and not on the total amount of entities
+//
+// Server tick:
+//      aoi_entity_move()       for every entity that moved (O(1))
+//      aoi_client_update()     for every client -> enter/leave events
+//      client->relevant        entities to send to the client
+
+#define AOI_INVALID_CELL -1
+
+enum AoiEventType : byte {
+    AOI_EVENT_ENTER,
+    AOI_EVENT_LEAVE,
+};
+
+struct AoiEvent {
+    int32 entity;
+    AoiEventType type;
+};
+
+struct AoiClient {
+    v3_f32 position;
+
+    // An entity becomes relevant inside of the view radius
+    // It only stops being relevant outside of view radius + hysteresis, this avoids enter/leave flickering at the border
+    f32 view_radius;
+    f32 hysteresis;
+
+    // Relevance set as list and bitfield (for O(1) lookup)
+    int32* relevant;
+    int32 relevant_count;
+    uint64* relevant_bits;
+
+    // Scratch list for the update
+    int32* relevant_next;
+};
+
+struct AreaOfInterest {
+    v3_f32 origin;
+    f32 cell_size;
+    int32 cells_x;
+    int32 cells_z;
+
+    // First entity of every cell
+    int32* cells;
+
+    // Intrusive doubly linked lists of the entities in a cell
+    int32* next;
+    int32* prev;
+    int32* entity_cell;
+    v3_f32* entity_position;
+    int32 entity_capacity;
+
+    // Entities that were found during the current client update (always cleared after the update)
+    uint64* seen_bits;
+
+    AoiClient* clients;
+    int32 client_capacity;
+
+    byte* memory;
+};
+
+/**
+ * Allocates the area of interest grid
+ *
+ * @param aoi               Area of interest
+ * @param origin            Smallest world position covered by the grid
+ * @param cell_size         Cell size, should be in the range of the view radius (a client visits (2 * radius / cell_size + 1)^2 cells)
+ * @param cells_x           Cells in x direction
+ * @param cells_z           Cells in z direction
+ * @param entity_capacity   Max entity id + 1
+ * @param client_capacity   Max client id + 1
+ */
+void aoi_alloc(
+    AreaOfInterest* aoi,
+    v3_f32 origin, f32 cell_size,
+    int32 cells_x, int32 cells_z,
+    int32 entity_capacity,
+    int32 client_capacity
+) NO_EXCEPT
+{
+    const int32 bit_elements = (entity_capacity + 63) / 64;
+    const uint64 size = sizeof(int32) * cells_x * cells_z
+        + sizeof(int32) * entity_capacity * 3 // next, prev, entity_cell
+        + sizeof(v3_f32) * entity_capacity
+        + sizeof(uint64) * bit_elements
+        + sizeof(AoiClient) * client_capacity
+        + client_capacity * (sizeof(int32) * entity_capacity * 2 + sizeof(uint64) * bit_elements)
+        + 64 * (8 + client_capacity * 3); // overhead for alignment
+
+    aoi->memory = (byte *) platform_alloc_aligned(size, size, ASSUMED_CACHE_LINE_SIZE);
+    memset(aoi->memory, 0, size);
+
+    aoi->origin = origin;
+    aoi->cell_size = cell_size;
+    aoi->cells_x = cells_x;
+    aoi->cells_z = cells_z;
+    aoi->entity_capacity = entity_capacity;
+    aoi->client_capacity = client_capacity;
+
+    byte* pos = aoi->memory;
+    aoi->cells = (int32 *) pos;
+    pos = (byte *) align_up((uintptr_t) (aoi->cells + cells_x * cells_z), 64);
+
+    aoi->next = (int32 *) pos;
+    pos = (byte *) align_up((uintptr_t) (aoi->next + entity_capacity), 64);
+
+    aoi->prev = (int32 *) pos;
+    pos = (byte *) align_up((uintptr_t) (aoi->prev + entity_capacity), 64);
+
+    aoi->entity_cell = (int32 *) pos;
+    pos = (byte *) align_up((uintptr_t) (aoi->entity_cell + entity_capacity), 64);
+
+    aoi->entity_position = (v3_f32 *) pos;
+    pos = (byte *) align_up((uintptr_t) (aoi->entity_position + entity_capacity), 64);
+
+    aoi->seen_bits = (uint64 *) pos;
+    pos = (byte *) align_up((uintptr_t) (aoi->seen_bits + bit_elements), 64);
+
+    aoi->clients = (AoiClient *) pos;
+    pos = (byte *) align_up((uintptr_t) (aoi->clients + client_capacity), 64);
+
+    for (int32 i = 0; i < client_capacity; ++i) {
+        AoiClient* client = &aoi->clients[i];
+
+        client->relevant = (int32 *) pos;
+        pos = (byte *) align_up((uintptr_t) (client->relevant + entity_capacity), 64);
+
+        client->relevant_next = (int32 *) pos;
+        pos = (byte *) align_up((uintptr_t) (client->relevant_next + entity_capacity), 64);
+
+        client->relevant_bits = (uint64 *) pos;
+        pos = (byte *) align_up((uintptr_t) (client->relevant_bits + bit_elements), 64);
+    }
+
+    for (int32 i = 0; i < cells_x * cells_z; ++i) {
+        aoi->cells[i] = -1;
+    }
+
+    for (int32 i = 0; i < entity_capacity; ++i) {
+        aoi->entity_cell[i] = AOI_INVALID_CELL;
+    }
+
+    LOG_1("[INFO] Allocated AreaOfInterest: %n B", {DATA_TYPE_UINT64, (void *) &size});
+}
+
+inline
+void aoi_free(AreaOfInterest* aoi) NO_EXCEPT
+{
+    platform_aligned_free((void **) &aoi->memory);
+    aoi->cells = NULL;
+    aoi->clients = NULL;
+}
+
+FORCE_INLINE
+int32 aoi_cell_coord(f32 value, f32 origin, f32 cell_size, int32 cells) NO_EXCEPT
+{
+    const int32 coord = (int32) ((value - origin) / cell_size);
+
+    return OMS_CLAMP(coord, 0, cells - 1);
+}
+
+// Positions outside of the grid are clamped to the border cells
+FORCE_INLINE
+int32 aoi_cell(const AreaOfInterest* aoi, v3_f32 position) NO_EXCEPT
+{
+    return aoi_cell_coord(position.z, aoi->origin.z, aoi->cell_size, aoi->cells_z) * aoi->cells_x
+        + aoi_cell_coord(position.x, aoi->origin.x, aoi->cell_size, aoi->cells_x);
+}
+
+static inline
+void aoi_cell_unlink(AreaOfInterest* aoi, int32 entity) NO_EXCEPT
+{
+    const int32 prev = aoi->prev[entity];
+    const int32 next = aoi->next[entity];
+
+    if (prev >= 0) {
+        aoi->next[prev] = next;
+    } else {
+        aoi->cells[aoi->entity_cell[entity]] = next;
+    }
+
+    if (next >= 0) {
+        aoi->prev[next] = prev;
+    }
+}
+
+static inline
+void aoi_cell_link(AreaOfInterest* aoi, int32 entity, int32 cell) NO_EXCEPT
+{
+    const int32 head = aoi->cells[cell];
+
+    aoi->prev[entity] = -1;
+    aoi->next[entity] = head;
+    if (head >= 0) {
+        aoi->prev[head] = entity;
+    }
+
+    aoi->cells[cell] = entity;
+    aoi->entity_cell[entity] = cell;
+}
+
+inline
+void aoi_entity_add(AreaOfInterest* aoi, int32 entity, v3_f32 position) NO_EXCEPT
+{
+    ASSERT_TRUE(entity >= 0 && entity < aoi->entity_capacity);
+    ASSERT_TRUE(aoi->entity_cell[entity] == AOI_INVALID_CELL);
+
+    aoi->entity_position[entity] = position;
+    aoi_cell_link(aoi, entity, aoi_cell(aoi, position));
+}
+
+// Clients that had this entity in their relevance set get a leave event on their next update
+// WARNING: Don't reuse the entity id before all clients were updated
+inline
+void aoi_entity_remove(AreaOfInterest* aoi, int32 entity) NO_EXCEPT
+{
+    if (aoi->entity_cell[entity] == AOI_INVALID_CELL) {
+        return;
+    }
+
+    aoi_cell_unlink(aoi, entity);
+    aoi->entity_cell[entity] = AOI_INVALID_CELL;
+}
+
+// Only touches the cell lists if the entity changed its cell
+// Entities that were never added or already removed are ignored
+inline
+void aoi_entity_move(AreaOfInterest* aoi, int32 entity, v3_f32 position) NO_EXCEPT
+{
+    if (aoi->entity_cell[entity] == AOI_INVALID_CELL) {
+        return;
+    }
+
+    aoi->entity_position[entity] = position;
+
+    const int32 cell = aoi_cell(aoi, position);
+    if (cell == aoi->entity_cell[entity]) {
+        return;
+    }
+
+    aoi_cell_unlink(aoi, entity);
+    aoi_cell_link(aoi, entity, cell);
+}
+
+inline
+void aoi_client_set(AreaOfInterest* aoi, int32 client_id, v3_f32 position, f32 view_radius, f32 hysteresis = 0.0f) NO_EXCEPT
+{
+    AoiClient* client = &aoi->clients[client_id];
+    client->position = position;
+    client->view_radius = view_radius;
+    client->hysteresis = hysteresis;
+}
+
+// Clears the relevance set without creating leave events (e.g. client disconnected)
+inline
+void aoi_client_reset(AreaOfInterest* aoi, int32 client_id) NO_EXCEPT
+{
+    AoiClient* client = &aoi->clients[client_id];
+
+    for (int32 i = 0; i < client->relevant_count; ++i) {
+        const int32 entity = client->relevant[i];
+        client->relevant_bits[entity / 64] &= ~(1ULL << (entity & 63));
+    }
+
+    client->relevant_count = 0;
+}
+
+FORCE_INLINE
+bool aoi_client_is_relevant(const AreaOfInterest* aoi, int32 client_id, int32 entity) NO_EXCEPT
+{
+    return aoi->clients[client_id].relevant_bits[entity / 64] & (1ULL << (entity & 63));
+}
+
+// Worst case amount of events of the next aoi_client_update() call
+FORCE_INLINE
+int32 aoi_client_events_max(const AreaOfInterest* aoi, int32 client_id) NO_EXCEPT
+{
+    return aoi->clients[client_id].relevant_count + aoi->entity_capacity;
+}
+
+/**
+ * Rebuilds the relevance set of a client
+ *
+ * @param aoi           Area of interest
+ * @param client_id     Client
+ * @param events        Enter/leave events (may be NULL), see aoi_client_events_max()
+ *
+ * @return Amount of events
+ */
+int32 aoi_client_update(AreaOfInterest* aoi, int32 client_id, AoiEvent* events) NO_EXCEPT
+{
+    AoiClient* client = &aoi->clients[client_id];
+
+    const f32 enter_radius_sq = client->view_radius * client->view_radius;
+    const f32 leave_radius = client->view_radius + client->hysteresis;
+    const f32 leave_radius_sq = leave_radius * leave_radius;
+
+    const int32 min_x = aoi_cell_coord(client->position.x - leave_radius, aoi->origin.x, aoi->cell_size, aoi->cells_x);
+    const int32 max_x = aoi_cell_coord(client->position.x + leave_radius, aoi->origin.x, aoi->cell_size, aoi->cells_x);
+    const int32 min_z = aoi_cell_coord(client->position.z - leave_radius, aoi->origin.z, aoi->cell_size, aoi->cells_z);
+    const int32 max_z = aoi_cell_coord(client->position.z + leave_radius, aoi->origin.z, aoi->cell_size, aoi->cells_z);
+
+    int32 event_count = 0;
+    int32 next_count = 0;
+
+    // Collect the entities in range
+    for (int32 z = min_z; z <= max_z; ++z) {
+        for (int32 x = min_x; x <= max_x; ++x) {
+            for (int32 entity = aoi->cells[z * aoi->cells_x + x]; entity >= 0; entity = aoi->next[entity]) {
+                const v3_f32 pos = aoi->entity_position[entity];
+                const f32 dx = pos.x - client->position.x;
+                const f32 dz = pos.z - client->position.z;
+                const f32 dist_sq = dx * dx + dz * dz;
+
+                const uint64 mask = 1ULL << (entity & 63);
+                const bool was_relevant = client->relevant_bits[entity / 64] & mask;
+
+                if (dist_sq > (was_relevant ? leave_radius_sq : enter_radius_sq)) {
+                    continue;
+                }
+
+                client->relevant_next[next_count++] = entity;
+                aoi->seen_bits[entity / 64] |= mask;
+
+                if (!was_relevant) {
+                    client->relevant_bits[entity / 64] |= mask;
+
+                    if (events) {
+                        events[event_count] = {entity, AOI_EVENT_ENTER};
+                    }
+                    ++event_count;
+                }
+            }
+        }
+    }
+
+    // Entities of the previous set that were not found anymore
+    for (int32 i = 0; i < client->relevant_count; ++i) {
+        const int32 entity = client->relevant[i];
+        const uint64 mask = 1ULL << (entity & 63);
+
+        if (aoi->seen_bits[entity / 64] & mask) {
+            continue;
+        }
+
+        client->relevant_bits[entity / 64] &= ~mask;
+
+        if (events) {
+            events[event_count] = {entity, AOI_EVENT_LEAVE};
+        }
+        ++event_count;
+    }
+
+    // Only clear the bits we set -> cost stays independent of the entity capacity
+    for (int32 i = 0; i < next_count; ++i) {
+        const int32 entity = client->relevant_next[i];
+        aoi->seen_bits[entity / 64] &= ~(1ULL << (entity & 63));
+    }
+
+    int32* temp = client->relevant;
+    client->relevant = client->relevant_next;
+    client->relevant_next = temp;
+    client->relevant_count = next_count;
+
+    return event_count;
+}
+
+/**
+ * Finds all entities in a radius (e.g. to broadcast a one time event like an explosion)
+ *
+ * @return Amount of entities found (at most max_count are written)
+ */
+int32 aoi_query(const AreaOfInterest* aoi, v3_f32 position, f32 radius, int32* out, int32 max_count) NO_EXCEPT
+{
+    const f32 radius_sq = radius * radius;
+
+    const int32 min_x = aoi_cell_coord(position.x - radius, aoi->origin.x, aoi->cell_size, aoi->cells_x);
+    const int32 max_x = aoi_cell_coord(position.x + radius, aoi->origin.x, aoi->cell_size, aoi->cells_x);
+    const int32 min_z = aoi_cell_coord(position.z - radius, aoi->origin.z, aoi->cell_size, aoi->cells_z);
+    const int32 max_z = aoi_cell_coord(position.z + radius, aoi->origin.z, aoi->cell_size, aoi->cells_z);
+
+    int32 count = 0;
+    for (int32 z = min_z; z <= max_z; ++z) {
+        for (int32 x = min_x; x <= max_x; ++x) {
+            for (int32 entity = aoi->cells[z * aoi->cells_x + x]; entity >= 0; entity = aoi->next[entity]) {
+                const f32 dx = aoi->entity_position[entity].x - position.x;
+                const f32 dz = aoi->entity_position[entity].z - position.z;
+
+                if (dx * dx + dz * dz > radius_sq) {
+                    continue;
+                }
+
+                if (count < max_count) {
+                    out[count] = entity;
+                }
+                ++count;
+            }
+        }
+    }
+
+    return count;
+}
+
+#endif
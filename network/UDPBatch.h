@@ -0,0 +1,25 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_NETWORK_UDP_BATCH_H
+#define COMS_NETWORK_UDP_BATCH_H
+
+// Batched udp receive/send, multiple datagrams per syscall
+// Typical server loop:
+//      udp_batch_receive()         -> handle udp_batch_packet(0..length)
+//      udp_batch_send_get/commit() -> for every outgoing packet of the tick
+//      udp_batch_send_flush()
+
+#if _WIN32
+    #include "../platform/win32/network/UDPBatch.h"
+#elif __linux__
+    #include "../platform/linux/network/UDPBatch.h"
+#endif
+
+#endif
@@ -5,23 +5,39 @@
 #include <stdio.h>
 
 #include "../../../stdlib/Stdlib.h"
+#include "../../../utils/BitUtils.h"
+#include "../../../system/Allocator.h"
+
+// Mob states are sent as bit-packed delta against the last snapshot the client acknowledged
+//      Server: mob_state_quantize() -> mob_state_encode(baseline = acked snapshot) -> store in history
+//      Client: mob_state_decode(baseline = same snapshot from its own history) -> store in history -> ack
+// If the acknowledged snapshot is no longer in the history the server sends a full snapshot (no baseline)
+
+// How many snapshots are remembered per client (must be a power of 2)
+#ifndef MOB_STATE_HISTORY
+    #define MOB_STATE_HISTORY 32
+#endif
+
+static_assert((MOB_STATE_HISTORY & (MOB_STATE_HISTORY - 1)) == 0);
 
 struct MobStatePacketSnapshot {
     byte* data;
 };
 
+// Game side representation
 struct MobStatePacketSnapshotUnpacked {
     uint32 mob_id;
     byte mob_type;
     uint32 chunk;
 
-    f16 x;
-    f16 y;
-    f16 z;
+    // Position relative to the chunk
+    f32 x;
+    f32 y;
+    f32 z;
 
-    f16 roll;
-    f16 pitch;
-    f16 yaw;
+    f32 roll;
+    f32 pitch;
+    f32 yaw;
 
     uint32 state_flag;
 
@@ -32,22 +48,598 @@ struct MobStatePacketDelta {
     byte* data;
 };
 
-struct MobStatePacketDeltaUnpacked {
+// Defines how many bits are used for the different fields
+// Both sides must use the same quantization
+struct MobStateQuantization {
+    // Position range (relative to the chunk)
+    f32 position_min;
+    f32 position_max;
+
+    // Bits per position axis, the precision is (max - min) / 2^bits
+    byte position_bits;
+
+    // Bits of a position delta (incl. sign), larger deltas send the full position
+    byte position_delta_bits;
+
+    // Bits per angle, the angle range is always one full rotation
+    byte rotation_bits;
+
+    // Only the lower state_bits of the state flag are sent
+    byte state_bits;
+};
+
+// Wire representation, only these values are compared and encoded
+struct MobStateQuantized {
     uint32 mob_id;
-    byte mob_type;
     uint32 chunk;
+    uint32 position[3];
+    uint32 state_flag;
+    uint16 rotation[3];
+    byte mob_type;
+};
 
-    f16 x;
-    f16 y;
-    f16 z;
+enum MobStateField : byte {
+    MOB_STATE_FIELD_CHUNK = 1 << 0,
+    MOB_STATE_FIELD_POSITION = 1 << 1,
+    MOB_STATE_FIELD_ROTATION = 1 << 2,
+    MOB_STATE_FIELD_STATE = 1 << 3,
+};
 
-    f16 roll;
-    f16 pitch;
-    f16 yaw;
+#define MOB_STATE_FIELD_COUNT 4
+#define MOB_STATE_FIELD_ALL 0x0F
 
-    uint32 state_flag;
+// A snapshot that was sent (server) or received (client)
+// The states are sorted by mob id
+struct MobStateSnapshotRecord {
+    uint16 sequence;
+    bool is_valid;
+    int32 count;
+    MobStateQuantized* states;
+};
 
-    uint64 time;
+// Snapshot history of a single client
+struct MobStateHistory {
+    MobStateSnapshotRecord records[MOB_STATE_HISTORY];
+
+    // Max mobs per snapshot
+    int32 capacity;
+
+    // Server: last sequence the client acknowledged
+    uint16 acked_sequence;
+    bool has_ack;
+
+    MobStateQuantized* memory;
 };
 
-#endif
\ No newline at end of file
+// The bit counts are used as shift amounts, e.g. 1 << (position_delta_bits - 1) and 1U << position_bits
+FORCE_INLINE
+bool mob_state_quantization_is_valid(const MobStateQuantization* quant) NO_EXCEPT
+{
+    return quant->position_max > quant->position_min
+        && quant->position_bits >= 1 && quant->position_bits <= 31
+        && quant->position_delta_bits >= 1 && quant->position_delta_bits <= 31
+        && quant->rotation_bits >= 1 && quant->rotation_bits <= 16
+        && quant->state_bits <= 32;
+}
+
+inline
+void mob_state_quantization_init(
+    MobStateQuantization* quant,
+    f32 position_min, f32 position_max,
+    byte position_bits, byte position_delta_bits,
+    byte rotation_bits, byte state_bits
+) NO_EXCEPT
+{
+    quant->position_min = position_min;
+    quant->position_max = position_max;
+    quant->position_bits = position_bits;
+    quant->position_delta_bits = position_delta_bits;
+    quant->rotation_bits = rotation_bits;
+    quant->state_bits = state_bits;
+
+    ASSERT_TRUE(mob_state_quantization_is_valid(quant));
+}
+
+// Wrap around safe sequence comparison
+FORCE_INLINE
+bool mob_state_sequence_newer(uint16 a, uint16 b) NO_EXCEPT
+{
+    return (int16) (a - b) > 0;
+}
+
+inline
+uint32 mob_state_quantize_position(f32 value, const MobStateQuantization* quant) NO_EXCEPT
+{
+    const uint32 max_value = (1U << quant->position_bits) - 1;
+    const f32 t = (value - quant->position_min) / (quant->position_max - quant->position_min);
+
+    if (t <= 0.0f) {
+        return 0;
+    } else if (t >= 1.0f) {
+        return max_value;
+    }
+
+    return (uint32) (t * max_value + 0.5f);
+}
+
+FORCE_INLINE
+f32 mob_state_dequantize_position(uint32 value, const MobStateQuantization* quant) NO_EXCEPT
+{
+    const uint32 max_value = (1U << quant->position_bits) - 1;
+
+    return quant->position_min + (quant->position_max - quant->position_min) * ((f32) value / (f32) max_value);
+}
+
+inline
+uint16 mob_state_quantize_angle(f32 angle, const MobStateQuantization* quant) NO_EXCEPT
+{
+    // Normalize to [0, 2pi)
+    angle -= OMS_TWO_PI_F32 * floorf(angle / OMS_TWO_PI_F32);
+
+    const uint32 steps = 1U << quant->rotation_bits;
+
+    return (uint16) (((uint32) (angle * (steps / OMS_TWO_PI_F32) + 0.5f)) & (steps - 1));
+}
+
+FORCE_INLINE
+f32 mob_state_dequantize_angle(uint16 value, const MobStateQuantization* quant) NO_EXCEPT
+{
+    return (f32) value * (OMS_TWO_PI_F32 / (1U << quant->rotation_bits));
+}
+
+inline
+void mob_state_quantize(
+    const MobStatePacketSnapshotUnpacked* __restrict state,
+    MobStateQuantized* __restrict out,
+    const MobStateQuantization* __restrict quant
+) NO_EXCEPT
+{
+    out->mob_id = state->mob_id;
+    out->mob_type = state->mob_type;
+    out->chunk = state->chunk;
+
+    out->position[0] = mob_state_quantize_position(state->x, quant);
+    out->position[1] = mob_state_quantize_position(state->y, quant);
+    out->position[2] = mob_state_quantize_position(state->z, quant);
+
+    out->rotation[0] = mob_state_quantize_angle(state->roll, quant);
+    out->rotation[1] = mob_state_quantize_angle(state->pitch, quant);
+    out->rotation[2] = mob_state_quantize_angle(state->yaw, quant);
+
+    out->state_flag = quant->state_bits >= 32
+        ? state->state_flag
+        : state->state_flag & ((1U << quant->state_bits) - 1);
+}
+
+inline
+void mob_state_dequantize(
+    const MobStateQuantized* __restrict state,
+    MobStatePacketSnapshotUnpacked* __restrict out,
+    const MobStateQuantization* __restrict quant
+) NO_EXCEPT
+{
+    out->mob_id = state->mob_id;
+    out->mob_type = state->mob_type;
+    out->chunk = state->chunk;
+
+    out->x = mob_state_dequantize_position(state->position[0], quant);
+    out->y = mob_state_dequantize_position(state->position[1], quant);
+    out->z = mob_state_dequantize_position(state->position[2], quant);
+
+    out->roll = mob_state_dequantize_angle(state->rotation[0], quant);
+    out->pitch = mob_state_dequantize_angle(state->rotation[1], quant);
+    out->yaw = mob_state_dequantize_angle(state->rotation[2], quant);
+
+    out->state_flag = state->state_flag;
+}
+
+inline
+void mob_state_history_alloc(MobStateHistory* history, int32 capacity) NO_EXCEPT
+{
+    history->memory = (MobStateQuantized *) platform_alloc_aligned(
+        MOB_STATE_HISTORY * capacity * sizeof(MobStateQuantized)
+    );
+
+    history->capacity = capacity;
+    history->acked_sequence = 0;
+    history->has_ack = false;
+
+    for (int32 i = 0; i < MOB_STATE_HISTORY; ++i) {
+        history->records[i].is_valid = false;
+        history->records[i].count = 0;
+        history->records[i].states = history->memory + i * capacity;
+    }
+}
+
+inline
+void mob_state_history_free(MobStateHistory* history) NO_EXCEPT
+{
+    platform_aligned_free((void **) &history->memory);
+}
+
+// Returns the snapshot with that sequence or NULL if it was already overwritten
+inline
+const MobStateSnapshotRecord* mob_state_history_get(const MobStateHistory* history, uint16 sequence) NO_EXCEPT
+{
+    const MobStateSnapshotRecord* record = &history->records[sequence & (MOB_STATE_HISTORY - 1)];
+
+    return record->is_valid && record->sequence == sequence ? record : NULL;
+}
+
+// Reserves the record for a new snapshot, the caller fills states and count
+inline
+MobStateSnapshotRecord* mob_state_history_push(MobStateHistory* history, uint16 sequence) NO_EXCEPT
+{
+    MobStateSnapshotRecord* record = &history->records[sequence & (MOB_STATE_HISTORY - 1)];
+    record->sequence = sequence;
+    record->is_valid = true;
+    record->count = 0;
+
+    return record;
+}
+
+// Server: remembers the snapshot that was just sent
+// WARNING: Call after mob_state_encode(), the record may be the one of the baseline
+inline
+void mob_state_history_store(
+    MobStateHistory* __restrict history,
+    uint16 sequence,
+    const MobStateQuantized* __restrict states,
+    int32 count
+) NO_EXCEPT
+{
+    ASSERT_TRUE(count <= history->capacity);
+
+    MobStateSnapshotRecord* record = mob_state_history_push(history, sequence);
+    memcpy(record->states, states, count * sizeof(MobStateQuantized));
+    record->count = count;
+}
+
+// Server: the client acknowledged a snapshot, only newer acks move the baseline
+inline
+void mob_state_history_ack(MobStateHistory* history, uint16 sequence) NO_EXCEPT
+{
+    if (!history->has_ack || mob_state_sequence_newer(sequence, history->acked_sequence)) {
+        history->acked_sequence = sequence;
+        history->has_ack = true;
+    }
+}
+
+// Server: baseline for the next snapshot or NULL if a full snapshot must be sent
+FORCE_INLINE
+const MobStateSnapshotRecord* mob_state_history_baseline(const MobStateHistory* history) NO_EXCEPT
+{
+    return history->has_ack ? mob_state_history_get(history, history->acked_sequence) : NULL;
+}
+
+// Small unsigned values are common (e.g. mob id gaps), 6 bits store the bit length of the value
+static inline
+void mob_state_write_varbits(BitWriter* writer, uint32 value) NO_EXCEPT
+{
+    const int32 bits = value ? compiler_find_first_bit_l2r(value) + 1 : 0;
+    bits_write(writer, bits, 6);
+    if (bits) {
+        bits_write(writer, value, bits);
+    }
+}
+
+static inline
+uint32 mob_state_read_varbits(BitReader* reader) NO_EXCEPT
+{
+    const int32 bits = bits_read(reader, 6);
+    if (bits > 32) {
+        // Corrupted packet
+        reader->overflow = true;
+
+        return 0;
+    }
+
+    return bits ? bits_read(reader, bits) : 0;
+}
+
+static inline
+void mob_state_write_position(
+    BitWriter* writer,
+    const uint32* position,
+    const uint32* base,
+    const MobStateQuantization* quant
+) NO_EXCEPT
+{
+    const int32 delta_limit = 1 << (quant->position_delta_bits - 1);
+
+    for (int32 i = 0; i < 3; ++i) {
+        const int32 delta = base ? (int32) (position[i] - base[i]) : delta_limit;
+
+        if (delta > -delta_limit && delta < delta_limit) {
+            bits_write_bool(writer, true);
+            bits_write(writer, (uint32) (delta + delta_limit), quant->position_delta_bits);
+        } else {
+            bits_write_bool(writer, false);
+            bits_write(writer, position[i], quant->position_bits);
+        }
+    }
+}
+
+static inline
+void mob_state_read_position(
+    BitReader* reader,
+    uint32* position,
+    const uint32* base,
+    const MobStateQuantization* quant
+) NO_EXCEPT
+{
+    const int32 delta_limit = 1 << (quant->position_delta_bits - 1);
+
+    for (int32 i = 0; i < 3; ++i) {
+        if (bits_read_bool(reader)) {
+            // A delta without base can only come from a corrupted packet, the position is garbage anyway
+            const int32 delta = (int32) bits_read(reader, quant->position_delta_bits) - delta_limit;
+            position[i] = (base ? base[i] : 0) + delta;
+        } else {
+            position[i] = bits_read(reader, quant->position_bits);
+        }
+    }
+}
+
+static inline
+byte mob_state_changed_fields(const MobStateQuantized* state, const MobStateQuantized* base) NO_EXCEPT
+{
+    byte fields = 0;
+    if (state->chunk != base->chunk) {
+        fields |= MOB_STATE_FIELD_CHUNK;
+    }
+
+    if (state->position[0] != base->position[0]
+        || state->position[1] != base->position[1]
+        || state->position[2] != base->position[2]
+    ) {
+        fields |= MOB_STATE_FIELD_POSITION;
+    }
+
+    if (state->rotation[0] != base->rotation[0]
+        || state->rotation[1] != base->rotation[1]
+        || state->rotation[2] != base->rotation[2]
+    ) {
+        fields |= MOB_STATE_FIELD_ROTATION;
+    }
+
+    if (state->state_flag != base->state_flag) {
+        fields |= MOB_STATE_FIELD_STATE;
+    }
+
+    return fields;
+}
+
+/**
+ * Creates a delta snapshot
+ *
+ * Layout:
+ *      sequence (16), has baseline (1), baseline sequence (16), mob count (varbits)
+ *      per mob:
+ *          id: 1 bit "previous id + 1" or varbits id gap
+ *          known mob: changed (1), if changed field mask (4) + changed fields
+ *          new mob: mob type (8) + all fields
+ * Mobs of the baseline that are not part of the snapshot are removed on the client.
+ *
+ * @param states    Current mob states (sorted by mob id)
+ * @param count     Amount of states
+ * @param baseline  Snapshot acknowledged by the client (NULL = full snapshot)
+ * @param sequence  Sequence of this snapshot
+ * @param quant     Quantization
+ * @param out       Output buffer
+ * @param out_size  Output buffer size
+ *
+ * @return Packet size in bytes or -1 if the buffer is too small
+ */
+int32 mob_state_encode(
+    const MobStateQuantized* __restrict states,
+    int32 count,
+    const MobStateSnapshotRecord* __restrict baseline,
+    uint16 sequence,
+    const MobStateQuantization* __restrict quant,
+    byte* __restrict out,
+    int32 out_size
+) NO_EXCEPT
+{
+    ASSERT_TRUE(mob_state_quantization_is_valid(quant));
+
+    BitWriter writer;
+    bits_writer_init(&writer, out, out_size);
+
+    bits_write(&writer, sequence, 16);
+    bits_write_bool(&writer, baseline != NULL);
+    if (baseline) {
+        bits_write(&writer, baseline->sequence, 16);
+    }
+
+    mob_state_write_varbits(&writer, count);
+
+    int32 base_index = 0;
+    uint32 prev_id = 0;
+
+    for (int32 i = 0; i < count; ++i) {
+        const MobStateQuantized* state = &states[i];
+        ASSERT_TRUE(i == 0 || state->mob_id > prev_id);
+
+        // The first mob always stores its full id
+        const bool is_next_id = i > 0 && state->mob_id == prev_id + 1;
+        if (i > 0) {
+            bits_write_bool(&writer, is_next_id);
+        }
+
+        if (!is_next_id) {
+            mob_state_write_varbits(&writer, state->mob_id - prev_id);
+        }
+        prev_id = state->mob_id;
+
+        // Both lists are sorted -> merge walk
+        const MobStateQuantized* base = NULL;
+        if (baseline) {
+            while (base_index < baseline->count && baseline->states[base_index].mob_id < state->mob_id) {
+                ++base_index;
+            }
+
+            if (base_index < baseline->count && baseline->states[base_index].mob_id == state->mob_id) {
+                base = &baseline->states[base_index];
+            }
+        }
+
+        byte fields = MOB_STATE_FIELD_ALL;
+        if (base) {
+            fields = mob_state_changed_fields(state, base);
+            bits_write_bool(&writer, fields != 0);
+
+            if (!fields) {
+                continue;
+            }
+
+            bits_write(&writer, fields, MOB_STATE_FIELD_COUNT);
+        } else {
+            bits_write(&writer, state->mob_type, 8);
+        }
+
+        if (fields & MOB_STATE_FIELD_CHUNK) {
+            bits_write(&writer, state->chunk, 32);
+        }
+
+        if (fields & MOB_STATE_FIELD_POSITION) {
+            mob_state_write_position(&writer, state->position, base ? base->position : NULL, quant);
+        }
+
+        if (fields & MOB_STATE_FIELD_ROTATION) {
+            bits_write(&writer, state->rotation[0], quant->rotation_bits);
+            bits_write(&writer, state->rotation[1], quant->rotation_bits);
+            bits_write(&writer, state->rotation[2], quant->rotation_bits);
+        }
+
+        if (fields & MOB_STATE_FIELD_STATE) {
+            bits_write(&writer, state->state_flag, quant->state_bits);
+        }
+    }
+
+    const int32 size = bits_write_flush(&writer);
+
+    return writer.overflow ? -1 : size;
+}
+
+// Reads the sequence numbers without decoding the packet
+// Required to find the baseline in the history before calling mob_state_decode()
+inline
+void mob_state_decode_header(
+    const byte* data, int32 size,
+    uint16* sequence, bool* has_baseline, uint16* baseline_sequence
+) NO_EXCEPT
+{
+    BitReader reader;
+    bits_reader_init(&reader, data, size);
+
+    *sequence = (uint16) bits_read(&reader, 16);
+    *has_baseline = bits_read_bool(&reader);
+    *baseline_sequence = *has_baseline ? (uint16) bits_read(&reader, 16) : 0;
+}
+
+/**
+ * Decodes a delta snapshot
+ *
+ * @param data      Packet data
+ * @param size      Packet size
+ * @param baseline  Snapshot referenced by the packet (see mob_state_decode_header)
+ * @param quant     Quantization
+ * @param out       Snapshot record to fill (e.g. from mob_state_history_push), must not be the baseline
+ *
+ * @return Amount of mob states or -1 if the packet is invalid
+ */
+int32 mob_state_decode(
+    const byte* __restrict data,
+    int32 size,
+    const MobStateSnapshotRecord* __restrict baseline,
+    const MobStateQuantization* __restrict quant,
+    MobStateSnapshotRecord* __restrict out,
+    int32 capacity
+) NO_EXCEPT
+{
+    ASSERT_TRUE(mob_state_quantization_is_valid(quant));
+
+    BitReader reader;
+    bits_reader_init(&reader, data, size);
+
+    out->sequence = (uint16) bits_read(&reader, 16);
+    const bool has_baseline = bits_read_bool(&reader);
+    if (has_baseline) {
+        const uint16 baseline_sequence = (uint16) bits_read(&reader, 16);
+        if (!baseline || baseline->sequence != baseline_sequence) {
+            return -1;
+        }
+    } else {
+        baseline = NULL;
+    }
+
+    const int32 count = (int32) mob_state_read_varbits(&reader);
+    if (count > capacity) {
+        return -1;
+    }
+
+    int32 base_index = 0;
+    uint32 prev_id = 0;
+
+    for (int32 i = 0; i < count; ++i) {
+        MobStateQuantized* state = &out->states[i];
+
+        state->mob_id = (i > 0 && bits_read_bool(&reader))
+            ? prev_id + 1
+            : prev_id + mob_state_read_varbits(&reader);
+        prev_id = state->mob_id;
+
+        const MobStateQuantized* base = NULL;
+        if (baseline) {
+            while (base_index < baseline->count && baseline->states[base_index].mob_id < state->mob_id) {
+                ++base_index;
+            }
+
+            if (base_index < baseline->count && baseline->states[base_index].mob_id == state->mob_id) {
+                base = &baseline->states[base_index];
+            }
+        }
+
+        byte fields = MOB_STATE_FIELD_ALL;
+        if (base) {
+            *state = *base;
+
+            if (!bits_read_bool(&reader)) {
+                continue;
+            }
+
+            fields = (byte) bits_read(&reader, MOB_STATE_FIELD_COUNT);
+        } else {
+            state->mob_type = (byte) bits_read(&reader, 8);
+        }
+
+        if (fields & MOB_STATE_FIELD_CHUNK) {
+            state->chunk = bits_read(&reader, 32);
+        }
+
+        if (fields & MOB_STATE_FIELD_POSITION) {
+            mob_state_read_position(&reader, state->position, base ? base->position : NULL, quant);
+        }
+
+        if (fields & MOB_STATE_FIELD_ROTATION) {
+            state->rotation[0] = (uint16) bits_read(&reader, quant->rotation_bits);
+            state->rotation[1] = (uint16) bits_read(&reader, quant->rotation_bits);
+            state->rotation[2] = (uint16) bits_read(&reader, quant->rotation_bits);
+        }
+
+        if (fields & MOB_STATE_FIELD_STATE) {
+            state->state_flag = bits_read(&reader, quant->state_bits);
+        }
+    }
+
+    if (reader.overflow) {
+        return -1;
+    }
+
+    out->count = count;
+
+    return count;
+}
+
+#endif
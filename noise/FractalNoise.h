@@ -12,5 +12,72 @@
 #define COMS_NOISE_FRACTAL_H
 
 #include <stdio.h>
+#include "../stdlib/Stdlib.h"
+
+// Fractal brownian motion (fBm): sum of octaves with increasing frequency and decreasing amplitude
+// The sum is normalized by the sum of the amplitudes, this way it stays in the range of the underlying noise
+struct NoiseFractal {
+    int32 octaves;
+
+    // Frequency of the first octave
+    f32 frequency;
+
+    // Frequency multiplier per octave (usually 2.0)
+    f32 lacunarity;
+
+    // Amplitude multiplier per octave (usually 0.5)
+    f32 gain;
+};
+
+// Single octave, used if no fractal settings are provided
+static const NoiseFractal NOISE_FRACTAL_NONE = {1, 1.0f, 2.0f, 0.5f};
+
+// Amplitude of the first octave so that the amplitudes sum up to 1.0
+inline
+f32 noise_fractal_amplitude(const NoiseFractal* fractal) NO_EXCEPT
+{
+    f32 sum = 0.0f;
+    f32 amplitude = 1.0f;
+    for (int32 i = 0; i < fractal->octaves; ++i) {
+        sum += amplitude;
+        amplitude *= fractal->gain;
+    }
+
+    return sum > 0.0f ? 1.0f / sum : 0.0f;
+}
+
+typedef double (*NoiseFunc2D)(double x, double y);
+typedef double (*NoiseFunc3D)(double x, double y, double z);
+
+// Scalar reference, use the *_grid functions of the respective noise for larger areas
+double fractal_noise_2d(NoiseFunc2D noise, double x, double y, const NoiseFractal* fractal) NO_EXCEPT
+{
+    double sum = 0.0;
+    double frequency = fractal->frequency;
+    double amplitude = noise_fractal_amplitude(fractal);
+
+    for (int32 i = 0; i < fractal->octaves; ++i) {
+        sum += amplitude * noise(x * frequency, y * frequency);
+        frequency *= fractal->lacunarity;
+        amplitude *= fractal->gain;
+    }
+
+    return sum;
+}
+
+double fractal_noise_3d(NoiseFunc3D noise, double x, double y, double z, const NoiseFractal* fractal) NO_EXCEPT
+{
+    double sum = 0.0;
+    double frequency = fractal->frequency;
+    double amplitude = noise_fractal_amplitude(fractal);
+
+    for (int32 i = 0; i < fractal->octaves; ++i) {
+        sum += amplitude * noise(x * frequency, y * frequency, z * frequency);
+        frequency *= fractal->lacunarity;
+        amplitude *= fractal->gain;
+    }
+
+    return sum;
+}
 
 #endif
\ No newline at end of file
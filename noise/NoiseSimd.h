@@ -0,0 +1,298 @@
+/**
+ * Jingga
+ *
+ * @package   Utils
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_NOISE_SIMD_H
+#define COMS_NOISE_SIMD_H
+
+#include "../stdlib/Stdlib.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE4_2__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+// Lanes for the batched noise kernels
+// The kernels are written once against these functions and use the widest available instruction set.
+// Comparisons return 0/1 integers, this way they can directly be used as cell offsets.
+// Integer math wraps around on overflow like the SIMD instructions (used by hashes).
+// The noise kernels mostly consist of gathers, selects and float/int conversions,
+// which the f32_4/f32_8/f32_16 wrappers don't provide.
+
+#if defined(__AVX512F__)
+    #define NOISE_LANES 16
+
+    typedef __m512 noise_f32;
+    typedef __m512i noise_i32;
+
+    FORCE_INLINE noise_f32 noise_set_f32(f32 v) NO_EXCEPT { return _mm512_set1_ps(v); }
+    FORCE_INLINE noise_i32 noise_set_i32(int32 v) NO_EXCEPT { return _mm512_set1_epi32(v); }
+    FORCE_INLINE noise_f32 noise_ramp() NO_EXCEPT
+    {
+        return _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+            8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+    }
+    FORCE_INLINE void noise_store(f32* dst, noise_f32 a) NO_EXCEPT { _mm512_storeu_ps(dst, a); }
+
+    FORCE_INLINE noise_f32 noise_add(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm512_add_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_sub(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm512_sub_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_mul(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm512_mul_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_max(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm512_max_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_min(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm512_min_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_sqrt(noise_f32 a) NO_EXCEPT { return _mm512_sqrt_ps(a); }
+    FORCE_INLINE noise_f32 noise_floor(noise_f32 a) NO_EXCEPT { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+
+    FORCE_INLINE noise_i32 noise_to_i32(noise_f32 a) NO_EXCEPT { return _mm512_cvttps_epi32(a); }
+    FORCE_INLINE noise_f32 noise_to_f32(noise_i32 a) NO_EXCEPT { return _mm512_cvtepi32_ps(a); }
+
+    FORCE_INLINE noise_i32 noise_add_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm512_add_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_sub_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm512_sub_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_mul_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm512_mullo_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_and_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm512_and_si512(a, b); }
+    FORCE_INLINE noise_i32 noise_or_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm512_or_si512(a, b); }
+    FORCE_INLINE noise_i32 noise_xor_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm512_xor_si512(a, b); }
+    FORCE_INLINE noise_i32 noise_srl_i32(noise_i32 a, int32 shift) NO_EXCEPT { return _mm512_srl_epi32(a, _mm_cvtsi32_si128(shift)); }
+
+    FORCE_INLINE noise_i32 noise_ge(noise_f32 a, noise_f32 b) NO_EXCEPT
+    {
+        return _mm512_maskz_mov_epi32(_mm512_cmp_ps_mask(a, b, _CMP_GE_OQ), _mm512_set1_epi32(1));
+    }
+
+    FORCE_INLINE noise_i32 noise_gt(noise_f32 a, noise_f32 b) NO_EXCEPT
+    {
+        return _mm512_maskz_mov_epi32(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), _mm512_set1_epi32(1));
+    }
+
+    FORCE_INLINE noise_i32 noise_gather_i32(const int32* table, noise_i32 index) NO_EXCEPT { return _mm512_i32gather_epi32(index, table, 4); }
+    FORCE_INLINE noise_f32 noise_gather_f32(const f32* table, noise_i32 index) NO_EXCEPT { return _mm512_i32gather_ps(index, table, 4); }
+#elif defined(__AVX2__)
+    #define NOISE_LANES 8
+
+    typedef __m256 noise_f32;
+    typedef __m256i noise_i32;
+
+    FORCE_INLINE noise_f32 noise_set_f32(f32 v) NO_EXCEPT { return _mm256_set1_ps(v); }
+    FORCE_INLINE noise_i32 noise_set_i32(int32 v) NO_EXCEPT { return _mm256_set1_epi32(v); }
+    FORCE_INLINE noise_f32 noise_ramp() NO_EXCEPT { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+    FORCE_INLINE void noise_store(f32* dst, noise_f32 a) NO_EXCEPT { _mm256_storeu_ps(dst, a); }
+
+    FORCE_INLINE noise_f32 noise_add(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm256_add_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_sub(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm256_sub_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_mul(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm256_mul_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_max(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm256_max_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_min(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm256_min_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_sqrt(noise_f32 a) NO_EXCEPT { return _mm256_sqrt_ps(a); }
+    FORCE_INLINE noise_f32 noise_floor(noise_f32 a) NO_EXCEPT { return _mm256_floor_ps(a); }
+
+    FORCE_INLINE noise_i32 noise_to_i32(noise_f32 a) NO_EXCEPT { return _mm256_cvttps_epi32(a); }
+    FORCE_INLINE noise_f32 noise_to_f32(noise_i32 a) NO_EXCEPT { return _mm256_cvtepi32_ps(a); }
+
+    FORCE_INLINE noise_i32 noise_add_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm256_add_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_sub_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm256_sub_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_mul_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm256_mullo_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_and_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm256_and_si256(a, b); }
+    FORCE_INLINE noise_i32 noise_or_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm256_or_si256(a, b); }
+    FORCE_INLINE noise_i32 noise_xor_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm256_xor_si256(a, b); }
+    FORCE_INLINE noise_i32 noise_srl_i32(noise_i32 a, int32 shift) NO_EXCEPT { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(shift)); }
+
+    FORCE_INLINE noise_i32 noise_ge(noise_f32 a, noise_f32 b) NO_EXCEPT
+    {
+        return _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GE_OQ)), _mm256_set1_epi32(1));
+    }
+
+    FORCE_INLINE noise_i32 noise_gt(noise_f32 a, noise_f32 b) NO_EXCEPT
+    {
+        return _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)), _mm256_set1_epi32(1));
+    }
+
+    FORCE_INLINE noise_i32 noise_gather_i32(const int32* table, noise_i32 index) NO_EXCEPT { return _mm256_i32gather_epi32(table, index, 4); }
+    FORCE_INLINE noise_f32 noise_gather_f32(const f32* table, noise_i32 index) NO_EXCEPT { return _mm256_i32gather_ps(table, index, 4); }
+#elif defined(__SSE4_2__)
+    #define NOISE_LANES 4
+
+    typedef __m128 noise_f32;
+    typedef __m128i noise_i32;
+
+    FORCE_INLINE noise_f32 noise_set_f32(f32 v) NO_EXCEPT { return _mm_set1_ps(v); }
+    FORCE_INLINE noise_i32 noise_set_i32(int32 v) NO_EXCEPT { return _mm_set1_epi32(v); }
+    FORCE_INLINE noise_f32 noise_ramp() NO_EXCEPT { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+    FORCE_INLINE void noise_store(f32* dst, noise_f32 a) NO_EXCEPT { _mm_storeu_ps(dst, a); }
+
+    FORCE_INLINE noise_f32 noise_add(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm_add_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_sub(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm_sub_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_mul(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm_mul_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_max(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm_max_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_min(noise_f32 a, noise_f32 b) NO_EXCEPT { return _mm_min_ps(a, b); }
+    FORCE_INLINE noise_f32 noise_sqrt(noise_f32 a) NO_EXCEPT { return _mm_sqrt_ps(a); }
+    FORCE_INLINE noise_f32 noise_floor(noise_f32 a) NO_EXCEPT { return _mm_floor_ps(a); }
+
+    FORCE_INLINE noise_i32 noise_to_i32(noise_f32 a) NO_EXCEPT { return _mm_cvttps_epi32(a); }
+    FORCE_INLINE noise_f32 noise_to_f32(noise_i32 a) NO_EXCEPT { return _mm_cvtepi32_ps(a); }
+
+    FORCE_INLINE noise_i32 noise_add_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm_add_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_sub_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm_sub_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_mul_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm_mullo_epi32(a, b); }
+    FORCE_INLINE noise_i32 noise_and_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm_and_si128(a, b); }
+    FORCE_INLINE noise_i32 noise_or_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm_or_si128(a, b); }
+    FORCE_INLINE noise_i32 noise_xor_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return _mm_xor_si128(a, b); }
+    FORCE_INLINE noise_i32 noise_srl_i32(noise_i32 a, int32 shift) NO_EXCEPT { return _mm_srl_epi32(a, _mm_cvtsi32_si128(shift)); }
+
+    FORCE_INLINE noise_i32 noise_ge(noise_f32 a, noise_f32 b) NO_EXCEPT
+    {
+        return _mm_and_si128(_mm_castps_si128(_mm_cmpge_ps(a, b)), _mm_set1_epi32(1));
+    }
+
+    FORCE_INLINE noise_i32 noise_gt(noise_f32 a, noise_f32 b) NO_EXCEPT
+    {
+        return _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(a, b)), _mm_set1_epi32(1));
+    }
+
+    // No gather instruction before AVX2
+    FORCE_INLINE noise_i32 noise_gather_i32(const int32* table, noise_i32 index) NO_EXCEPT
+    {
+        alignas(16) int32 i[4];
+        _mm_store_si128((__m128i *) i, index);
+
+        return _mm_setr_epi32(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+    }
+
+    FORCE_INLINE noise_f32 noise_gather_f32(const f32* table, noise_i32 index) NO_EXCEPT
+    {
+        alignas(16) int32 i[4];
+        _mm_store_si128((__m128i *) i, index);
+
+        return _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+    }
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+    #define NOISE_LANES 4
+
+    typedef float32x4_t noise_f32;
+    typedef int32x4_t noise_i32;
+
+    FORCE_INLINE noise_f32 noise_set_f32(f32 v) NO_EXCEPT { return vdupq_n_f32(v); }
+    FORCE_INLINE noise_i32 noise_set_i32(int32 v) NO_EXCEPT { return vdupq_n_s32(v); }
+    FORCE_INLINE noise_f32 noise_ramp() NO_EXCEPT
+    {
+        const f32 ramp[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+        return vld1q_f32(ramp);
+    }
+    FORCE_INLINE void noise_store(f32* dst, noise_f32 a) NO_EXCEPT { vst1q_f32(dst, a); }
+
+    FORCE_INLINE noise_f32 noise_add(noise_f32 a, noise_f32 b) NO_EXCEPT { return vaddq_f32(a, b); }
+    FORCE_INLINE noise_f32 noise_sub(noise_f32 a, noise_f32 b) NO_EXCEPT { return vsubq_f32(a, b); }
+    FORCE_INLINE noise_f32 noise_mul(noise_f32 a, noise_f32 b) NO_EXCEPT { return vmulq_f32(a, b); }
+    FORCE_INLINE noise_f32 noise_max(noise_f32 a, noise_f32 b) NO_EXCEPT { return vmaxq_f32(a, b); }
+    FORCE_INLINE noise_f32 noise_min(noise_f32 a, noise_f32 b) NO_EXCEPT { return vminq_f32(a, b); }
+    FORCE_INLINE noise_f32 noise_sqrt(noise_f32 a) NO_EXCEPT { return vsqrtq_f32(a); }
+    FORCE_INLINE noise_f32 noise_floor(noise_f32 a) NO_EXCEPT { return vrndmq_f32(a); }
+
+    FORCE_INLINE noise_i32 noise_to_i32(noise_f32 a) NO_EXCEPT { return vcvtq_s32_f32(a); }
+    FORCE_INLINE noise_f32 noise_to_f32(noise_i32 a) NO_EXCEPT { return vcvtq_f32_s32(a); }
+
+    FORCE_INLINE noise_i32 noise_add_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return vaddq_s32(a, b); }
+    FORCE_INLINE noise_i32 noise_sub_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return vsubq_s32(a, b); }
+    FORCE_INLINE noise_i32 noise_mul_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return vmulq_s32(a, b); }
+    FORCE_INLINE noise_i32 noise_and_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return vandq_s32(a, b); }
+    FORCE_INLINE noise_i32 noise_or_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return vorrq_s32(a, b); }
+    FORCE_INLINE noise_i32 noise_xor_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return veorq_s32(a, b); }
+    FORCE_INLINE noise_i32 noise_srl_i32(noise_i32 a, int32 shift) NO_EXCEPT
+    {
+        return vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(a), vdupq_n_s32(-shift)));
+    }
+
+    FORCE_INLINE noise_i32 noise_ge(noise_f32 a, noise_f32 b) NO_EXCEPT
+    {
+        return vandq_s32(vreinterpretq_s32_u32(vcgeq_f32(a, b)), vdupq_n_s32(1));
+    }
+
+    FORCE_INLINE noise_i32 noise_gt(noise_f32 a, noise_f32 b) NO_EXCEPT
+    {
+        return vandq_s32(vreinterpretq_s32_u32(vcgtq_f32(a, b)), vdupq_n_s32(1));
+    }
+
+    FORCE_INLINE noise_i32 noise_gather_i32(const int32* table, noise_i32 index) NO_EXCEPT
+    {
+        int32 i[4];
+        vst1q_s32(i, index);
+
+        const int32 v[4] = {table[i[0]], table[i[1]], table[i[2]], table[i[3]]};
+        return vld1q_s32(v);
+    }
+
+    FORCE_INLINE noise_f32 noise_gather_f32(const f32* table, noise_i32 index) NO_EXCEPT
+    {
+        int32 i[4];
+        vst1q_s32(i, index);
+
+        const f32 v[4] = {table[i[0]], table[i[1]], table[i[2]], table[i[3]]};
+        return vld1q_f32(v);
+    }
+#else
+    #define NOISE_LANES 1
+
+    typedef f32 noise_f32;
+    typedef int32 noise_i32;
+
+    FORCE_INLINE noise_f32 noise_set_f32(f32 v) NO_EXCEPT { return v; }
+    FORCE_INLINE noise_i32 noise_set_i32(int32 v) NO_EXCEPT { return v; }
+    FORCE_INLINE noise_f32 noise_ramp() NO_EXCEPT { return 0.0f; }
+    FORCE_INLINE void noise_store(f32* dst, noise_f32 a) NO_EXCEPT { *dst = a; }
+
+    FORCE_INLINE noise_f32 noise_add(noise_f32 a, noise_f32 b) NO_EXCEPT { return a + b; }
+    FORCE_INLINE noise_f32 noise_sub(noise_f32 a, noise_f32 b) NO_EXCEPT { return a - b; }
+    FORCE_INLINE noise_f32 noise_mul(noise_f32 a, noise_f32 b) NO_EXCEPT { return a * b; }
+    FORCE_INLINE noise_f32 noise_max(noise_f32 a, noise_f32 b) NO_EXCEPT { return a > b ? a : b; }
+    FORCE_INLINE noise_f32 noise_min(noise_f32 a, noise_f32 b) NO_EXCEPT { return a < b ? a : b; }
+    FORCE_INLINE noise_f32 noise_sqrt(noise_f32 a) NO_EXCEPT { return sqrtf(a); }
+    FORCE_INLINE noise_f32 noise_floor(noise_f32 a) NO_EXCEPT { return floorf(a); }
+
+    FORCE_INLINE noise_i32 noise_to_i32(noise_f32 a) NO_EXCEPT { return (int32) a; }
+    FORCE_INLINE noise_f32 noise_to_f32(noise_i32 a) NO_EXCEPT { return (f32) a; }
+
+    FORCE_INLINE noise_i32 noise_add_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return (int32) ((uint32) a + (uint32) b); }
+    FORCE_INLINE noise_i32 noise_sub_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return (int32) ((uint32) a - (uint32) b); }
+    FORCE_INLINE noise_i32 noise_mul_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return (int32) ((uint32) a * (uint32) b); }
+    FORCE_INLINE noise_i32 noise_and_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return a & b; }
+    FORCE_INLINE noise_i32 noise_or_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return a | b; }
+    FORCE_INLINE noise_i32 noise_xor_i32(noise_i32 a, noise_i32 b) NO_EXCEPT { return a ^ b; }
+    FORCE_INLINE noise_i32 noise_srl_i32(noise_i32 a, int32 shift) NO_EXCEPT { return (int32) ((uint32) a >> shift); }
+
+    FORCE_INLINE noise_i32 noise_ge(noise_f32 a, noise_f32 b) NO_EXCEPT { return a >= b; }
+    FORCE_INLINE noise_i32 noise_gt(noise_f32 a, noise_f32 b) NO_EXCEPT { return a > b; }
+
+    FORCE_INLINE noise_i32 noise_gather_i32(const int32* table, noise_i32 index) NO_EXCEPT { return table[index]; }
+    FORCE_INLINE noise_f32 noise_gather_f32(const f32* table, noise_i32 index) NO_EXCEPT { return table[index]; }
+#endif
+
+// Stores the first count lanes (count may be larger than NOISE_LANES)
+FORCE_INLINE
+void noise_store_partial(f32* dst, noise_f32 a, int32 count) NO_EXCEPT
+{
+    if (count >= NOISE_LANES) {
+        noise_store(dst, a);
+        return;
+    }
+
+    f32 tmp[NOISE_LANES];
+    noise_store(tmp, a);
+    memcpy(dst, tmp, count * sizeof(f32));
+}
+
+// x + (offset + lane) * step
+FORCE_INLINE
+noise_f32 noise_lane_positions(f32 x, int32 offset, f32 step) NO_EXCEPT
+{
+    return noise_add(
+        noise_set_f32(x),
+        noise_mul(noise_add(noise_set_f32((f32) offset), noise_ramp()), noise_set_f32(step))
+    );
+}
+
+#endif
@@ -12,16 +12,55 @@
 #define COMS_NOISE_SIMPLEX_H
 
 #include <stdio.h>
+#include "../stdlib/Stdlib.h"
+#include "NoiseSimd.h"
+#include "FractalNoise.h"
 
 #define SIMPLEX_NOISE_F2 0.5 * (sqrt(3.0) - 1.0)
 #define SIMPLEX_NOISE_G2 (3.0 - sqrt(3.0)) / 6.0
-
-static const int perm[512] = {
-    151,160,137,91,90,15,
-    131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,
-
-    151,160,137,91,90,15,
-    131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,
+#define SIMPLEX_NOISE_F3 (1.0 / 3.0)
+#define SIMPLEX_NOISE_G3 (1.0 / 6.0)
+
+#define SIMPLEX_NOISE_F2_F32 0.36602540378f
+#define SIMPLEX_NOISE_G2_F32 0.21132486540f
+#define SIMPLEX_NOISE_F3_F32 (1.0f / 3.0f)
+#define SIMPLEX_NOISE_G3_F32 (1.0f / 6.0f)
+
+// Ken Perlin's reference permutation, repeated to avoid wrapping the index
+static const int32 perm[512] = {
+    151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225,
+    140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23, 190, 6, 148,
+    247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32,
+    57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175,
+    74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122,
+    60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54,
+    65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169,
+    200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64,
+    52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212,
+    207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42, 223, 183, 170, 213,
+    119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
+    129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104,
+    218, 246, 97, 228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241,
+    81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157,
+    184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93,
+    222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180,
+
+    151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225,
+    140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23, 190, 6, 148,
+    247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32,
+    57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175,
+    74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122,
+    60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54,
+    65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169,
+    200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64,
+    52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212,
+    207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42, 223, 183, 170, 213,
+    119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
+    129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104,
+    218, 246, 97, 228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241,
+    81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157,
+    184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93,
+    222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180,
 };
 
 static const int grad3_2[12][2] = {
@@ -36,6 +75,11 @@ static const int grad3_3[12][3] = {
     {0,1,1}, {0,-1,1}, {0,1,-1}, {0,-1,-1}
 };
 
+// grad3_2 and grad3_3 as SoA for the gathers (the x and y components are the same for 2D and 3D)
+static const f32 SIMPLEX_NOISE_GRAD_X[12] = {1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0};
+static const f32 SIMPLEX_NOISE_GRAD_Y[12] = {1, 1, -1, -1, 0, 0, 0, 0, 1, -1, 1, -1};
+static const f32 SIMPLEX_NOISE_GRAD_Z[12] = {0, 0, 0, 0, 1, 1, -1, -1, 1, 1, -1, -1};
+
 static inline double simplex_noise_dot2(const int32* g, double x, double y) {
     return g[0] * x + g[1] * y;
 }
@@ -117,12 +161,12 @@ double simplex_noise_3d(double x, double y, double z) {
     double n0, n1, n2, n3; // Noise contributions from the four corners
 
     // Skew the input space to determine which simplex cell we're in
-    double s = (x + y + z) * SIMPLEX_NOISE_F2; // Skew factor for 3D
+    double s = (x + y + z) * SIMPLEX_NOISE_F3; // Skew factor for 3D
     int i = floor(x + s);
     int j = floor(y + s);
     int k = floor(z + s);
 
-    double t = (i + j + k) * SIMPLEX_NOISE_G2;
+    double t = (i + j + k) * SIMPLEX_NOISE_G3;
     double X0 = i - t; // Unskew the cell origin back to (x, y, z) space
     double Y0 = j - t;
     double Z0 = k - t;
@@ -160,17 +204,17 @@ double simplex_noise_3d(double x, double y, double z) {
     }
 
     // Offsets for second corner in (x, y, z) unskewed coords
-    double x1 = x0 - i1 + SIMPLEX_NOISE_G2;
-    double y1 = y0 - j1 + SIMPLEX_NOISE_G2;
-    double z1 = z0 - k1 + SIMPLEX_NOISE_G2;
+    double x1 = x0 - i1 + SIMPLEX_NOISE_G3;
+    double y1 = y0 - j1 + SIMPLEX_NOISE_G3;
+    double z1 = z0 - k1 + SIMPLEX_NOISE_G3;
     // Offsets for third corner in (x, y, z) unskewed coords
-    double x2 = x0 - i2 + 2.0 * SIMPLEX_NOISE_G2;
-    double y2 = y0 - j2 + 2.0 * SIMPLEX_NOISE_G2;
-    double z2 = z0 - k2 + 2.0 * SIMPLEX_NOISE_G2;
+    double x2 = x0 - i2 + 2.0 * SIMPLEX_NOISE_G3;
+    double y2 = y0 - j2 + 2.0 * SIMPLEX_NOISE_G3;
+    double z2 = z0 - k2 + 2.0 * SIMPLEX_NOISE_G3;
     // Offsets for last corner in (x, y, z) unskewed coords
-    double x3 = x0 - 1.0 + 3.0 * SIMPLEX_NOISE_G2;
-    double y3 = y0 - 1.0 + 3.0 * SIMPLEX_NOISE_G2;
-    double z3 = z0 - 1.0 + 3.0 * SIMPLEX_NOISE_G2;
+    double x3 = x0 - 1.0 + 3.0 * SIMPLEX_NOISE_G3;
+    double y3 = y0 - 1.0 + 3.0 * SIMPLEX_NOISE_G3;
+    double z3 = z0 - 1.0 + 3.0 * SIMPLEX_NOISE_G3;
 
     // Work out the hashed gradient indices of the four simplex corners
     int ii = i & 255;
@@ -219,4 +263,269 @@ double simplex_noise_3d(double x, double y, double z) {
     return 32.0 * (n0 + n1 + n2 + n3);
 }
 
+FORCE_INLINE
+noise_i32 simplex_noise_mod12(noise_i32 v) NO_EXCEPT
+{
+    // v is in [0, 255], the + 0.5 keeps multiples of 12 away from the rounding edge
+    const noise_i32 q = noise_to_i32(
+        noise_mul(noise_add(noise_to_f32(v), noise_set_f32(0.5f)), noise_set_f32(1.0f / 12.0f))
+    );
+
+    return noise_sub_i32(v, noise_mul_i32(q, noise_set_i32(12)));
+}
+
+FORCE_INLINE
+noise_f32 simplex_noise_corner_2d(noise_f32 x, noise_f32 y, noise_i32 gi) NO_EXCEPT
+{
+    noise_f32 t = noise_sub(noise_sub(noise_set_f32(0.5f), noise_mul(x, x)), noise_mul(y, y));
+    t = noise_max(t, noise_set_f32(0.0f));
+    t = noise_mul(t, t);
+
+    const noise_f32 dot = noise_add(
+        noise_mul(noise_gather_f32(SIMPLEX_NOISE_GRAD_X, gi), x),
+        noise_mul(noise_gather_f32(SIMPLEX_NOISE_GRAD_Y, gi), y)
+    );
+
+    return noise_mul(noise_mul(t, t), dot);
+}
+
+FORCE_INLINE
+noise_f32 simplex_noise_corner_3d(noise_f32 x, noise_f32 y, noise_f32 z, noise_i32 gi) NO_EXCEPT
+{
+    noise_f32 t = noise_sub(
+        noise_sub(noise_sub(noise_set_f32(0.6f), noise_mul(x, x)), noise_mul(y, y)),
+        noise_mul(z, z)
+    );
+    t = noise_max(t, noise_set_f32(0.0f));
+    t = noise_mul(t, t);
+
+    const noise_f32 dot = noise_add(
+        noise_add(
+            noise_mul(noise_gather_f32(SIMPLEX_NOISE_GRAD_X, gi), x),
+            noise_mul(noise_gather_f32(SIMPLEX_NOISE_GRAD_Y, gi), y)
+        ),
+        noise_mul(noise_gather_f32(SIMPLEX_NOISE_GRAD_Z, gi), z)
+    );
+
+    return noise_mul(noise_mul(t, t), dot);
+}
+
+// Same algorithm as simplex_noise_2d() for NOISE_LANES points at once (f32)
+// The branches are replaced by 0/1 cell offsets and clamping the corner weights to 0
+static inline
+noise_f32 simplex_noise_2d_lanes(noise_f32 x, noise_f32 y) NO_EXCEPT
+{
+    const noise_f32 g2 = noise_set_f32(SIMPLEX_NOISE_G2_F32);
+    const noise_i32 one = noise_set_i32(1);
+    const noise_i32 mask = noise_set_i32(255);
+
+    const noise_f32 s = noise_mul(noise_add(x, y), noise_set_f32(SIMPLEX_NOISE_F2_F32));
+    const noise_f32 i = noise_floor(noise_add(x, s));
+    const noise_f32 j = noise_floor(noise_add(y, s));
+
+    const noise_f32 t = noise_mul(noise_add(i, j), g2);
+    const noise_f32 x0 = noise_sub(x, noise_sub(i, t));
+    const noise_f32 y0 = noise_sub(y, noise_sub(j, t));
+
+    const noise_i32 i1 = noise_gt(x0, y0);
+    const noise_i32 j1 = noise_xor_i32(i1, one);
+
+    const noise_f32 x1 = noise_add(noise_sub(x0, noise_to_f32(i1)), g2);
+    const noise_f32 y1 = noise_add(noise_sub(y0, noise_to_f32(j1)), g2);
+    const noise_f32 x2 = noise_add(x0, noise_set_f32(-1.0f + 2.0f * SIMPLEX_NOISE_G2_F32));
+    const noise_f32 y2 = noise_add(y0, noise_set_f32(-1.0f + 2.0f * SIMPLEX_NOISE_G2_F32));
+
+    const noise_i32 ii = noise_and_i32(noise_to_i32(i), mask);
+    const noise_i32 jj = noise_and_i32(noise_to_i32(j), mask);
+
+    const noise_i32 gi0 = simplex_noise_mod12(noise_gather_i32(perm,
+        noise_add_i32(ii, noise_gather_i32(perm, jj))
+    ));
+    const noise_i32 gi1 = simplex_noise_mod12(noise_gather_i32(perm,
+        noise_add_i32(noise_add_i32(ii, i1), noise_gather_i32(perm, noise_add_i32(jj, j1)))
+    ));
+    const noise_i32 gi2 = simplex_noise_mod12(noise_gather_i32(perm,
+        noise_add_i32(noise_add_i32(ii, one), noise_gather_i32(perm, noise_add_i32(jj, one)))
+    ));
+
+    const noise_f32 n = noise_add(
+        noise_add(simplex_noise_corner_2d(x0, y0, gi0), simplex_noise_corner_2d(x1, y1, gi1)),
+        simplex_noise_corner_2d(x2, y2, gi2)
+    );
+
+    return noise_mul(n, noise_set_f32(70.0f));
+}
+
+FORCE_INLINE
+noise_i32 simplex_noise_hash_3d(noise_i32 ii, noise_i32 jj, noise_i32 kk) NO_EXCEPT
+{
+    return simplex_noise_mod12(noise_gather_i32(perm,
+        noise_add_i32(ii, noise_gather_i32(perm,
+            noise_add_i32(jj, noise_gather_i32(perm, kk))
+        ))
+    ));
+}
+
+// Same algorithm as simplex_noise_3d() for NOISE_LANES points at once (f32)
+static inline
+noise_f32 simplex_noise_3d_lanes(noise_f32 x, noise_f32 y, noise_f32 z) NO_EXCEPT
+{
+    const noise_f32 g3 = noise_set_f32(SIMPLEX_NOISE_G3_F32);
+    const noise_i32 one = noise_set_i32(1);
+    const noise_i32 mask = noise_set_i32(255);
+
+    const noise_f32 s = noise_mul(noise_add(noise_add(x, y), z), noise_set_f32(SIMPLEX_NOISE_F3_F32));
+    const noise_f32 i = noise_floor(noise_add(x, s));
+    const noise_f32 j = noise_floor(noise_add(y, s));
+    const noise_f32 k = noise_floor(noise_add(z, s));
+
+    const noise_f32 t = noise_mul(noise_add(noise_add(i, j), k), g3);
+    const noise_f32 x0 = noise_sub(x, noise_sub(i, t));
+    const noise_f32 y0 = noise_sub(y, noise_sub(j, t));
+    const noise_f32 z0 = noise_sub(z, noise_sub(k, t));
+
+    // Branchless version of the simplex selection in simplex_noise_3d()
+    const noise_i32 x_ge_y = noise_ge(x0, y0);
+    const noise_i32 y_ge_z = noise_ge(y0, z0);
+    const noise_i32 x_ge_z = noise_ge(x0, z0);
+    const noise_i32 x_lt_y = noise_xor_i32(x_ge_y, one);
+    const noise_i32 y_lt_z = noise_xor_i32(y_ge_z, one);
+    const noise_i32 x_lt_z = noise_xor_i32(x_ge_z, one);
+
+    const noise_i32 i1 = noise_and_i32(x_ge_y, x_ge_z);
+    const noise_i32 j1 = noise_and_i32(x_lt_y, y_ge_z);
+    const noise_i32 k1 = noise_and_i32(x_lt_z, y_lt_z);
+    const noise_i32 i2 = noise_or_i32(x_ge_y, x_ge_z);
+    const noise_i32 j2 = noise_or_i32(x_lt_y, y_ge_z);
+    const noise_i32 k2 = noise_xor_i32(noise_and_i32(x_ge_z, y_ge_z), one);
+
+    const noise_f32 x1 = noise_add(noise_sub(x0, noise_to_f32(i1)), g3);
+    const noise_f32 y1 = noise_add(noise_sub(y0, noise_to_f32(j1)), g3);
+    const noise_f32 z1 = noise_add(noise_sub(z0, noise_to_f32(k1)), g3);
+
+    const noise_f32 g3_2 = noise_set_f32(2.0f * SIMPLEX_NOISE_G3_F32);
+    const noise_f32 x2 = noise_add(noise_sub(x0, noise_to_f32(i2)), g3_2);
+    const noise_f32 y2 = noise_add(noise_sub(y0, noise_to_f32(j2)), g3_2);
+    const noise_f32 z2 = noise_add(noise_sub(z0, noise_to_f32(k2)), g3_2);
+
+    const noise_f32 g3_3 = noise_set_f32(-1.0f + 3.0f * SIMPLEX_NOISE_G3_F32);
+    const noise_f32 x3 = noise_add(x0, g3_3);
+    const noise_f32 y3 = noise_add(y0, g3_3);
+    const noise_f32 z3 = noise_add(z0, g3_3);
+
+    const noise_i32 ii = noise_and_i32(noise_to_i32(i), mask);
+    const noise_i32 jj = noise_and_i32(noise_to_i32(j), mask);
+    const noise_i32 kk = noise_and_i32(noise_to_i32(k), mask);
+
+    const noise_i32 gi0 = simplex_noise_hash_3d(ii, jj, kk);
+    const noise_i32 gi1 = simplex_noise_hash_3d(noise_add_i32(ii, i1), noise_add_i32(jj, j1), noise_add_i32(kk, k1));
+    const noise_i32 gi2 = simplex_noise_hash_3d(noise_add_i32(ii, i2), noise_add_i32(jj, j2), noise_add_i32(kk, k2));
+    const noise_i32 gi3 = simplex_noise_hash_3d(noise_add_i32(ii, one), noise_add_i32(jj, one), noise_add_i32(kk, one));
+
+    const noise_f32 n = noise_add(
+        noise_add(simplex_noise_corner_3d(x0, y0, z0, gi0), simplex_noise_corner_3d(x1, y1, z1, gi1)),
+        noise_add(simplex_noise_corner_3d(x2, y2, z2, gi2), simplex_noise_corner_3d(x3, y3, z3, gi3))
+    );
+
+    return noise_mul(n, noise_set_f32(32.0f));
+}
+
+/**
+ * Fills a 2D grid with (fractal) simplex noise
+ *
+ * The sample position of out[row * width + col] is (x + col * step, y + row * step)
+ * The octaves are accumulated in registers, every value is only written once.
+ *
+ * @param fractal fBm settings, NULL = single octave
+ */
+void simplex_noise_2d_grid(
+    f32* __restrict out, int32 width, int32 height,
+    f32 x, f32 y, f32 step,
+    const NoiseFractal* fractal = NULL
+) NO_EXCEPT
+{
+    if (!fractal) {
+        fractal = &NOISE_FRACTAL_NONE;
+    }
+
+    const f32 amplitude_start = noise_fractal_amplitude(fractal);
+
+    for (int32 row = 0; row < height; ++row) {
+        const f32 py = y + (f32) row * step;
+        f32* out_row = out + (size_t) row * width;
+
+        for (int32 col = 0; col < width; col += NOISE_LANES) {
+            const noise_f32 px = noise_lane_positions(x, col, step);
+
+            noise_f32 sum = noise_set_f32(0.0f);
+            f32 frequency = fractal->frequency;
+            f32 amplitude = amplitude_start;
+
+            for (int32 octave = 0; octave < fractal->octaves; ++octave) {
+                const noise_f32 n = simplex_noise_2d_lanes(
+                    noise_mul(px, noise_set_f32(frequency)),
+                    noise_set_f32(py * frequency)
+                );
+
+                sum = noise_add(sum, noise_mul(n, noise_set_f32(amplitude)));
+                frequency *= fractal->lacunarity;
+                amplitude *= fractal->gain;
+            }
+
+            noise_store_partial(out_row + col, sum, width - col);
+        }
+    }
+}
+
+/**
+ * Fills a 3D grid with (fractal) simplex noise (e.g. voxel density)
+ *
+ * The sample position of out[(layer * height + row) * width + col] is (x + col * step, y + row * step, z + layer * step)
+ *
+ * @param fractal fBm settings, NULL = single octave
+ */
+void simplex_noise_3d_grid(
+    f32* __restrict out, int32 width, int32 height, int32 depth,
+    f32 x, f32 y, f32 z, f32 step,
+    const NoiseFractal* fractal = NULL
+) NO_EXCEPT
+{
+    if (!fractal) {
+        fractal = &NOISE_FRACTAL_NONE;
+    }
+
+    const f32 amplitude_start = noise_fractal_amplitude(fractal);
+
+    for (int32 layer = 0; layer < depth; ++layer) {
+        const f32 pz = z + (f32) layer * step;
+
+        for (int32 row = 0; row < height; ++row) {
+            const f32 py = y + (f32) row * step;
+            f32* out_row = out + ((size_t) layer * height + row) * width;
+
+            for (int32 col = 0; col < width; col += NOISE_LANES) {
+                const noise_f32 px = noise_lane_positions(x, col, step);
+
+                noise_f32 sum = noise_set_f32(0.0f);
+                f32 frequency = fractal->frequency;
+                f32 amplitude = amplitude_start;
+
+                for (int32 octave = 0; octave < fractal->octaves; ++octave) {
+                    const noise_f32 n = simplex_noise_3d_lanes(
+                        noise_mul(px, noise_set_f32(frequency)),
+                        noise_set_f32(py * frequency),
+                        noise_set_f32(pz * frequency)
+                    );
+
+                    sum = noise_add(sum, noise_mul(n, noise_set_f32(amplitude)));
+                    frequency *= fractal->lacunarity;
+                    amplitude *= fractal->gain;
+                }
+
+                noise_store_partial(out_row + col, sum, width - col);
+            }
+        }
+    }
+}
+
 #endif
\ No newline at end of file
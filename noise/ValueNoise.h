@@ -14,7 +14,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "../stdlib/Stdlib.h"
 #include "../animation/Animation.h"
+#include "NoiseSimd.h"
+#include "FractalNoise.h"
 
 // Initialize the grid with random values
 void initialize_value_noise_2d(float* grid, int grid_size) {
@@ -29,56 +32,59 @@ void initialize_value_noise_3d(float* grid, int rows, int cols, int depth) {
     }
 }
 
-// @todo whenever we actually need this and we want to iterate over all x,y,z of a grid we will NOT iterate value_noise_2d.
-//      this would be way to slow!!!
-//      Instead we need to implement a simd version that performs the algorithm in value_noise_2d with a step size of 16/8/4
+// Wraps the cell coordinate into [0, size)
+inline
+int value_noise_wrap(int v, int size) {
+    v %= size;
 
-float value_noise_2d(float* grid, float x, float y, int rows, int cols) {
-    int grid_size = rows * cols;
+    return v < 0 ? v + size : v;
+}
 
+// grid has the size rows * cols and is stored row major (y * cols + x)
+// Use value_noise_2d_grid() to fill larger areas
+float value_noise_2d(const float* grid, float x, float y, int rows, int cols) {
     // Calculate grid cell coordinates
-    int x0 = (int) floor(x) % grid_size;
-    int y0 = (int) floor(y) % grid_size;
-    int x1 = (x0 + 1) % grid_size;
-    int y1 = (y0 + 1) % grid_size;
+    int x0 = value_noise_wrap((int) floorf(x), cols);
+    int y0 = value_noise_wrap((int) floorf(y), rows);
+    int x1 = (x0 + 1) % cols;
+    int y1 = (y0 + 1) % rows;
 
     // Calculate interpolation weights
-    float tx = x - floor(x);
-    float ty = y - floor(y);
+    float tx = x - floorf(x);
+    float ty = y - floorf(y);
 
     // Smooth the weights using smoothstep function
     tx = smoothstep(tx);
     ty = smoothstep(ty);
 
     // Interpolate the four corner values
-    float v00 = grid[y0 * rows + x0];
-    float v10 = grid[y0 * rows + x1];
-    float v01 = grid[y1 * rows + x0];
-    float v11 = grid[y1 * rows + x1];
+    float v00 = grid[y0 * cols + x0];
+    float v10 = grid[y0 * cols + x1];
+    float v01 = grid[y1 * cols + x0];
+    float v11 = grid[y1 * cols + x1];
 
     // Interpolate along x direction
-    float v0 = lerp(v00, v10, tx);
-    float v1 = lerp(v01, v11, tx);
+    float v0 = anim_lerp(v00, v10, tx);
+    float v1 = anim_lerp(v01, v11, tx);
 
     // Interpolate along y direction and return the final noise value
-    return lerp(v0, v1, ty);
+    return anim_lerp(v0, v1, ty);
 }
 
-float value_noise_3d(float* grid, float x, float y, float z, int rows, int cols, int depth) {
-    int grid_size = rows * cols * depth;
-
+// grid has the size rows * cols * depth and is stored as (z * rows + y) * cols + x
+float value_noise_3d(const float* grid, float x, float y, float z, int rows, int cols, int depth) {
     // Calculate grid cell coordinates
-    int x0 = (int) floor(x) % grid_size;
-    int y0 = (int) floor(y) % grid_size;
-    int z0 = (int) floor(z) % grid_size;
-    int x1 = (x0 + 1) % grid_size;
-    int y1 = (y0 + 1) % grid_size;
-    int z1 = (z0 + 1) % grid_size;
+    int x0 = value_noise_wrap((int) floorf(x), cols);
+    int y0 = value_noise_wrap((int) floorf(y), rows);
+    int z0 = value_noise_wrap((int) floorf(z), depth);
+    int x1 = (x0 + 1) % cols;
+    int y1 = (y0 + 1) % rows;
+    int z1 = (z0 + 1) % depth;
 
     // Calculate interpolation weights
-    float tx = x - floor(x);
-    float ty = y - floor(y);
-    float tz = z - floor(z);
+    float tx = x - floorf(x);
+    float ty = y - floorf(y);
+    float tz = z - floorf(z);
 
     // Smooth the weights using smoothstep function
     tx = smoothstep(tx);
@@ -86,27 +92,121 @@ float value_noise_3d(float* grid, float x, float y, float z, int rows, int cols,
     tz = smoothstep(tz);
 
     // Interpolate the eight corner values
-    float v000 = grid[(y0 * rows + x0) * cols + z0];
-    float v100 = grid[(y0 * rows + x1) * cols + z0];
-    float v010 = grid[(y1 * rows + x0) * cols + z0];
-    float v110 = grid[(y1 * rows + x1) * cols + z0];
-    float v001 = grid[(y0 * rows + x0) * cols + z1];
-    float v101 = grid[(y0 * rows + x1) * cols + z1];
-    float v011 = grid[(y1 * rows + x0) * cols + z1];
-    float v111 = grid[(y1 * rows + x1) * cols + z1];
+    float v000 = grid[(z0 * rows + y0) * cols + x0];
+    float v100 = grid[(z0 * rows + y0) * cols + x1];
+    float v010 = grid[(z0 * rows + y1) * cols + x0];
+    float v110 = grid[(z0 * rows + y1) * cols + x1];
+    float v001 = grid[(z1 * rows + y0) * cols + x0];
+    float v101 = grid[(z1 * rows + y0) * cols + x1];
+    float v011 = grid[(z1 * rows + y1) * cols + x0];
+    float v111 = grid[(z1 * rows + y1) * cols + x1];
 
     // Interpolate along x direction
-    float v00 = lerp(v000, v100, tx);
-    float v10 = lerp(v010, v110, tx);
-    float v01 = lerp(v001, v101, tx);
-    float v11 = lerp(v011, v111, tx);
+    float v00 = anim_lerp(v000, v100, tx);
+    float v10 = anim_lerp(v010, v110, tx);
+    float v01 = anim_lerp(v001, v101, tx);
+    float v11 = anim_lerp(v011, v111, tx);
 
     // Interpolate along y direction
-    float v0 = lerp(v00, v10, ty);
-    float v1 = lerp(v01, v11, ty);
+    float v0 = anim_lerp(v00, v10, ty);
+    float v1 = anim_lerp(v01, v11, ty);
 
     // Interpolate along z direction and return the final noise value
-    return lerp(v0, v1, tz);
+    return anim_lerp(v0, v1, tz);
+}
+
+// Wraps the integer valued cell coordinate v into [0, size)
+// The + 0.5 keeps the division away from the rounding edge
+FORCE_INLINE
+noise_f32 value_noise_wrap_lanes(noise_f32 v, f32 size) NO_EXCEPT
+{
+    const noise_f32 q = noise_floor(
+        noise_mul(noise_add(v, noise_set_f32(0.5f)), noise_set_f32(1.0f / size))
+    );
+
+    return noise_sub(v, noise_mul(q, noise_set_f32(size)));
+}
+
+// Same algorithm as value_noise_2d() for NOISE_LANES points at once
+// The row (y) is the same for all lanes, only the x positions differ
+static inline
+noise_f32 value_noise_2d_lanes(const f32* grid, noise_f32 x, f32 y, int32 rows, int32 cols) NO_EXCEPT
+{
+    const noise_f32 x_floor = noise_floor(x);
+    const noise_f32 x0 = value_noise_wrap_lanes(x_floor, (f32) cols);
+    noise_f32 x1 = noise_add(x0, noise_set_f32(1.0f));
+    x1 = noise_sub(x1, noise_mul(noise_to_f32(noise_ge(x1, noise_set_f32((f32) cols))), noise_set_f32((f32) cols)));
+
+    const int32 y_floor = (int32) floorf(y);
+    const int32 y0 = value_noise_wrap(y_floor, rows);
+    const int32 y1 = (y0 + 1) % rows;
+
+    noise_f32 tx = noise_sub(x, x_floor);
+    tx = noise_mul(noise_mul(tx, tx), noise_sub(noise_set_f32(3.0f), noise_add(tx, tx)));
+    const noise_f32 ty = noise_set_f32(smoothstep(y - (f32) y_floor));
+
+    const noise_i32 ix0 = noise_to_i32(x0);
+    const noise_i32 ix1 = noise_to_i32(x1);
+
+    const f32* row0 = grid + y0 * cols;
+    const f32* row1 = grid + y1 * cols;
+
+    const noise_f32 v00 = noise_gather_f32(row0, ix0);
+    const noise_f32 v10 = noise_gather_f32(row0, ix1);
+    const noise_f32 v01 = noise_gather_f32(row1, ix0);
+    const noise_f32 v11 = noise_gather_f32(row1, ix1);
+
+    const noise_f32 v0 = noise_add(v00, noise_mul(tx, noise_sub(v10, v00)));
+    const noise_f32 v1 = noise_add(v01, noise_mul(tx, noise_sub(v11, v01)));
+
+    return noise_add(v0, noise_mul(ty, noise_sub(v1, v0)));
+}
+
+/**
+ * Fills a 2D grid with (fractal) value noise
+ *
+ * The sample position of out[row * width + col] is (x + col * step, y + row * step)
+ *
+ * @param grid      Random values (see initialize_value_noise_2d()), rows * cols
+ * @param fractal   fBm settings, NULL = single octave
+ */
+void value_noise_2d_grid(
+    f32* __restrict out, int32 width, int32 height,
+    const f32* __restrict grid, int32 rows, int32 cols,
+    f32 x, f32 y, f32 step,
+    const NoiseFractal* fractal = NULL
+) NO_EXCEPT
+{
+    if (!fractal) {
+        fractal = &NOISE_FRACTAL_NONE;
+    }
+
+    const f32 amplitude_start = noise_fractal_amplitude(fractal);
+
+    for (int32 row = 0; row < height; ++row) {
+        const f32 py = y + (f32) row * step;
+        f32* out_row = out + (size_t) row * width;
+
+        for (int32 col = 0; col < width; col += NOISE_LANES) {
+            const noise_f32 px = noise_lane_positions(x, col, step);
+
+            noise_f32 sum = noise_set_f32(0.0f);
+            f32 frequency = fractal->frequency;
+            f32 amplitude = amplitude_start;
+
+            for (int32 octave = 0; octave < fractal->octaves; ++octave) {
+                const noise_f32 n = value_noise_2d_lanes(
+                    grid, noise_mul(px, noise_set_f32(frequency)), py * frequency, rows, cols
+                );
+
+                sum = noise_add(sum, noise_mul(n, noise_set_f32(amplitude)));
+                frequency *= fractal->lacunarity;
+                amplitude *= fractal->gain;
+            }
+
+            noise_store_partial(out_row + col, sum, width - col);
+        }
+    }
 }
 
 #endif
\ No newline at end of file
@@ -14,21 +14,113 @@
 #include <stdlib.h>
 
 #include "../stdlib/Stdlib.h"
+#include "NoiseSimd.h"
 
-#define WORLEY_FEATURE_POINTS 4
+// Every cell of the unit grid has exactly one feature point at a hashed position inside the cell.
+// This way only the 3x3 (3x3x3) neighborhood needs to be checked and no point table is required.
+// The jitter limits how far a point can be away from the cell center.
+// With these values no point outside of the neighborhood can be closer than the point of the own cell -> F1 is exact.
+// F2 may very rarely be too large, which is not visible.
+#define WORLEY_NOISE_JITTER_2D 0.65f
+#define WORLEY_NOISE_JITTER_3D 0.46f
 
-void generate_feature_points_2d(v2_f32* points, int feature_points, int rows, int cols) {
-    for (int i = 0; i < rows * cols * feature_points; ++i) {
-        points[i].x = (float) rand() / RAND_MAX;
-        points[i].y = (float) rand() / RAND_MAX;
+enum WorleyNoiseOutput {
+    WORLEY_NOISE_F1,
+    WORLEY_NOISE_F2,
+    WORLEY_NOISE_F2_F1,
+};
+
+struct WorleyNoiseDistance {
+    // Distance to the closest feature point
+    f32 f1;
+
+    // Distance to the second closest feature point
+    f32 f2;
+};
+
+#define WORLEY_NOISE_HASH_X 0x27D4EB2D
+#define WORLEY_NOISE_HASH_Y 0x165667B1
+#define WORLEY_NOISE_HASH_Z 0x9E3779B1
+#define WORLEY_NOISE_MIX_1 0x7FEB352D
+#define WORLEY_NOISE_MIX_2 0x846CA68B
+
+// Converts the upper/lower 16 bit of a hash to [0, 1)
+#define WORLEY_NOISE_HASH_SCALE (1.0f / 65536.0f)
+
+// Offset of the feature point inside the cell for a hash value in [0, 65535]
+#define WORLEY_NOISE_OFFSET(h, jitter) (0.5f * (1.0f - (jitter)) + (f32) (h) * (WORLEY_NOISE_HASH_SCALE * (jitter)))
+
+FORCE_INLINE
+uint32 worley_noise_mix(uint32 h) NO_EXCEPT
+{
+    h ^= h >> 16;
+    h *= WORLEY_NOISE_MIX_1;
+    h ^= h >> 15;
+    h *= WORLEY_NOISE_MIX_2;
+    h ^= h >> 16;
+
+    return h;
+}
+
+FORCE_INLINE
+uint32 worley_noise_hash_2d(int32 x, int32 y, uint32 seed) NO_EXCEPT
+{
+    return worley_noise_mix(seed ^ ((uint32) x * WORLEY_NOISE_HASH_X) ^ ((uint32) y * WORLEY_NOISE_HASH_Y));
+}
+
+FORCE_INLINE
+uint32 worley_noise_hash_3d(int32 x, int32 y, int32 z, uint32 seed) NO_EXCEPT
+{
+    return worley_noise_mix(
+        seed ^ ((uint32) x * WORLEY_NOISE_HASH_X) ^ ((uint32) y * WORLEY_NOISE_HASH_Y) ^ ((uint32) z * WORLEY_NOISE_HASH_Z)
+    );
+}
+
+// Feature point of a cell relative to the cell origin
+FORCE_INLINE
+v2_f32 worley_noise_point_2d(int32 x, int32 y, uint32 seed) NO_EXCEPT
+{
+    const uint32 h = worley_noise_hash_2d(x, y, seed);
+
+    return {
+        WORLEY_NOISE_OFFSET(h & 0xFFFF, WORLEY_NOISE_JITTER_2D),
+        WORLEY_NOISE_OFFSET(h >> 16, WORLEY_NOISE_JITTER_2D)
+    };
+}
+
+FORCE_INLINE
+v3_f32 worley_noise_point_3d(int32 x, int32 y, int32 z, uint32 seed) NO_EXCEPT
+{
+    // The z coordinate uses a second hash, 16 bit per coordinate
+    const uint32 h = worley_noise_hash_3d(x, y, z, seed);
+    const uint32 h2 = worley_noise_mix(h);
+
+    return {
+        WORLEY_NOISE_OFFSET(h & 0xFFFF, WORLEY_NOISE_JITTER_3D),
+        WORLEY_NOISE_OFFSET(h >> 16, WORLEY_NOISE_JITTER_3D),
+        WORLEY_NOISE_OFFSET(h2 & 0xFFFF, WORLEY_NOISE_JITTER_3D)
+    };
+}
+
+FORCE_INLINE
+void worley_noise_insert(WorleyNoiseDistance* dist, f32 dist_squared) NO_EXCEPT
+{
+    if (dist_squared < dist->f1) {
+        dist->f2 = dist->f1;
+        dist->f1 = dist_squared;
+    } else if (dist_squared < dist->f2) {
+        dist->f2 = dist_squared;
     }
 }
 
-void generate_feature_points_3d(v3_f32* points, int feature_points, int rows, int cols, int depth) {
-    for (int i = 0; i < rows * cols * depth * feature_points; ++i) {
-        points[i].x = (float) rand() / RAND_MAX;
-        points[i].y = (float) rand() / RAND_MAX;
-        points[i].z = (float) rand() / RAND_MAX;
+FORCE_INLINE
+f32 worley_noise_output(const WorleyNoiseDistance* dist, WorleyNoiseOutput output) NO_EXCEPT
+{
+    switch (output) {
+        case WORLEY_NOISE_F1: return dist->f1;
+        case WORLEY_NOISE_F2: return dist->f2;
+        case WORLEY_NOISE_F2_F1: return dist->f2 - dist->f1;
+        default: UNREACHABLE();
     }
 }
 
@@ -40,79 +132,252 @@ float distance_squared_3d(float x1, float y1, float z1, float x2, float y2, floa
     return (x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1) + (z2 - z1) * (z2 - z1);
 }
 
-float worley_noise_2d(v2_f32* points, int feature_points, float x, float y, int rows, int cols) {
-    int grid_size = rows * cols;
+// Use worley_noise_2d_grid() to fill larger areas
+WorleyNoiseDistance worley_noise_2d(f32 x, f32 y, uint32 seed) NO_EXCEPT
+{
+    const f32 cell_xf = floorf(x);
+    const f32 cell_yf = floorf(y);
+    const int32 cell_x = (int32) cell_xf;
+    const int32 cell_y = (int32) cell_yf;
 
-    int cell_x = (int) floor(x);
-    int cell_y = (int) floor(y);
+    // Position relative to the cell, the feature points are also stored relative to the cell
+    const f32 fx = x - cell_xf;
+    const f32 fy = y - cell_yf;
 
-    float min_dist_squared = INFINITY;
+    WorleyNoiseDistance dist = {INFINITY, INFINITY};
 
     // Check the surrounding cells and the current cell
-    for (int i = -1; i <= 1; ++i) {
-        for (int j = -1; j <= 1; ++j) {
-            int neighbor_x = cell_x + i;
-            int neighbor_y = cell_y + j;
-
-            // Ensure the neighboring cell is within bounds
-            if (neighbor_x < 0 || neighbor_x >= cols
-                || neighbor_y < 0 || neighbor_y >= rows
-            ) {
-                continue;
-            }
+    for (int32 j = -1; j <= 1; ++j) {
+        for (int32 i = -1; i <= 1; ++i) {
+            const v2_f32 p = worley_noise_point_2d(cell_x + i, cell_y + j, seed);
+            worley_noise_insert(&dist, distance_squared_2d(fx, fy, (f32) i + p.x, (f32) j + p.y));
+        }
+    }
+
+    dist.f1 = sqrtf(dist.f1);
+    dist.f2 = sqrtf(dist.f2);
+
+    return dist;
+}
+
+WorleyNoiseDistance worley_noise_3d(f32 x, f32 y, f32 z, uint32 seed) NO_EXCEPT
+{
+    const f32 cell_xf = floorf(x);
+    const f32 cell_yf = floorf(y);
+    const f32 cell_zf = floorf(z);
+    const int32 cell_x = (int32) cell_xf;
+    const int32 cell_y = (int32) cell_yf;
+    const int32 cell_z = (int32) cell_zf;
+
+    const f32 fx = x - cell_xf;
+    const f32 fy = y - cell_yf;
+    const f32 fz = z - cell_zf;
 
-            for (int p = 0; p < feature_points; p++) {
-                v2_f32 fp = points[(neighbor_y * rows + neighbor_x) * cols + p];
-                float dist_squared = distance_squared_2d(x, y, fp.x, fp.y);
+    WorleyNoiseDistance dist = {INFINITY, INFINITY};
 
-                if (dist_squared < min_dist_squared) {
-                    min_dist_squared = dist_squared;
-                }
+    for (int32 k = -1; k <= 1; ++k) {
+        for (int32 j = -1; j <= 1; ++j) {
+            for (int32 i = -1; i <= 1; ++i) {
+                const v3_f32 p = worley_noise_point_3d(cell_x + i, cell_y + j, cell_z + k, seed);
+                worley_noise_insert(
+                    &dist,
+                    distance_squared_3d(fx, fy, fz, (f32) i + p.x, (f32) j + p.y, (f32) k + p.z)
+                );
             }
         }
     }
 
-    return intrin_sqrt_f32(min_dist_squared);
+    dist.f1 = sqrtf(dist.f1);
+    dist.f2 = sqrtf(dist.f2);
+
+    return dist;
 }
 
-float worley_noise_3d(v3_f32* points, int feature_points, float x, float y, float z, int rows, int cols, int depth) {
-    int grid_size = rows * cols * depth;
+FORCE_INLINE
+noise_i32 worley_noise_mix_lanes(noise_i32 h) NO_EXCEPT
+{
+    h = noise_xor_i32(h, noise_srl_i32(h, 16));
+    h = noise_mul_i32(h, noise_set_i32((int32) WORLEY_NOISE_MIX_1));
+    h = noise_xor_i32(h, noise_srl_i32(h, 15));
+    h = noise_mul_i32(h, noise_set_i32((int32) WORLEY_NOISE_MIX_2));
+    h = noise_xor_i32(h, noise_srl_i32(h, 16));
 
-    int cell_x = (int) floor(x);
-    int cell_y = (int) floor(y);
-    int cell_z = (int) floor(z);
+    return h;
+}
 
-    float min_dist_squared = INFINITY;
+// Keeps the two smallest squared distances
+FORCE_INLINE
+void worley_noise_insert_lanes(noise_f32* f1, noise_f32* f2, noise_f32 dist_squared) NO_EXCEPT
+{
+    *f2 = noise_min(*f2, noise_max(*f1, dist_squared));
+    *f1 = noise_min(*f1, dist_squared);
+}
 
-    // Check the surrounding cells and the current cell
-    for (int i = -1; i <= 1; i++) {
-        for (int j = -1; j <= 1; j++) {
-            for (int k = -1; k <= 1; k++) {
-                int neighbor_x = cell_x + i;
-                int neighbor_y = cell_y + j;
-                int neighbor_z = cell_z + k;
-
-                // Ensure the neighboring cell is within bounds
-                if (neighbor_x < 0 || neighbor_x >= cols
-                    || neighbor_y < 0 || neighbor_y >= rows
-                    || neighbor_z < 0 || neighbor_z >= depth
-                ) {
-                    continue;
-                }
-
-                for (int p = 0; p < feature_points; ++p) {
-                    v3_f32 fp = points[((neighbor_y * rows + neighbor_x) * cols + neighbor_z) * depth + p];
-                    float dist_squared = distance_squared_3d(x, y, z, fp.x, fp.y, fp.z);
-
-                    if (dist_squared < min_dist_squared) {
-                        min_dist_squared = dist_squared;
-                    }
-                }
+FORCE_INLINE
+noise_f32 worley_noise_output_lanes(noise_f32 f1, noise_f32 f2, WorleyNoiseOutput output) NO_EXCEPT
+{
+    switch (output) {
+        case WORLEY_NOISE_F1: return noise_sqrt(f1);
+        case WORLEY_NOISE_F2: return noise_sqrt(f2);
+        case WORLEY_NOISE_F2_F1: return noise_sub(noise_sqrt(f2), noise_sqrt(f1));
+        default: UNREACHABLE();
+    }
+}
+
+// Same algorithm as worley_noise_2d() for NOISE_LANES points in the same row
+static inline
+noise_f32 worley_noise_2d_lanes(noise_f32 x, f32 y, uint32 seed, WorleyNoiseOutput output) NO_EXCEPT
+{
+    const noise_f32 cell_xf = noise_floor(x);
+    const noise_i32 cell_x = noise_to_i32(cell_xf);
+    const noise_f32 fx = noise_sub(x, cell_xf);
+
+    const f32 cell_yf = floorf(y);
+    const int32 cell_y = (int32) cell_yf;
+    const f32 fy = y - cell_yf;
+
+    const noise_i32 low_mask = noise_set_i32(0xFFFF);
+    const noise_f32 scale = noise_set_f32(WORLEY_NOISE_HASH_SCALE * WORLEY_NOISE_JITTER_2D);
+    const f32 bias = 0.5f * (1.0f - WORLEY_NOISE_JITTER_2D);
+
+    noise_f32 f1 = noise_set_f32(INFINITY);
+    noise_f32 f2 = noise_set_f32(INFINITY);
+
+    for (int32 j = -1; j <= 1; ++j) {
+        // The y part of the hash is the same for all lanes
+        const noise_i32 hash_y = noise_set_i32((int32) (seed ^ ((uint32) (cell_y + j) * WORLEY_NOISE_HASH_Y)));
+
+        for (int32 i = -1; i <= 1; ++i) {
+            const noise_i32 h = worley_noise_mix_lanes(noise_xor_i32(
+                hash_y,
+                noise_mul_i32(noise_add_i32(cell_x, noise_set_i32(i)), noise_set_i32(WORLEY_NOISE_HASH_X))
+            ));
+
+            const noise_f32 px = noise_add(
+                noise_set_f32((f32) i + bias),
+                noise_mul(noise_to_f32(noise_and_i32(h, low_mask)), scale)
+            );
+            const noise_f32 py = noise_add(
+                noise_set_f32((f32) j + bias),
+                noise_mul(noise_to_f32(noise_srl_i32(h, 16)), scale)
+            );
+
+            const noise_f32 dx = noise_sub(px, fx);
+            const noise_f32 dy = noise_sub(py, noise_set_f32(fy));
+
+            worley_noise_insert_lanes(&f1, &f2, noise_add(noise_mul(dx, dx), noise_mul(dy, dy)));
+        }
+    }
+
+    return worley_noise_output_lanes(f1, f2, output);
+}
+
+// Same algorithm as worley_noise_3d() for NOISE_LANES points in the same row
+static inline
+noise_f32 worley_noise_3d_lanes(noise_f32 x, f32 y, f32 z, uint32 seed, WorleyNoiseOutput output) NO_EXCEPT
+{
+    const noise_f32 cell_xf = noise_floor(x);
+    const noise_i32 cell_x = noise_to_i32(cell_xf);
+    const noise_f32 fx = noise_sub(x, cell_xf);
+
+    const f32 cell_yf = floorf(y);
+    const f32 cell_zf = floorf(z);
+    const int32 cell_y = (int32) cell_yf;
+    const int32 cell_z = (int32) cell_zf;
+    const f32 fy = y - cell_yf;
+    const f32 fz = z - cell_zf;
+
+    const noise_i32 low_mask = noise_set_i32(0xFFFF);
+    const noise_f32 scale = noise_set_f32(WORLEY_NOISE_HASH_SCALE * WORLEY_NOISE_JITTER_3D);
+    const f32 bias = 0.5f * (1.0f - WORLEY_NOISE_JITTER_3D);
+
+    noise_f32 f1 = noise_set_f32(INFINITY);
+    noise_f32 f2 = noise_set_f32(INFINITY);
+
+    for (int32 k = -1; k <= 1; ++k) {
+        for (int32 j = -1; j <= 1; ++j) {
+            const noise_i32 hash_yz = noise_set_i32((int32) (
+                seed ^ ((uint32) (cell_y + j) * WORLEY_NOISE_HASH_Y) ^ ((uint32) (cell_z + k) * WORLEY_NOISE_HASH_Z)
+            ));
+
+            for (int32 i = -1; i <= 1; ++i) {
+                const noise_i32 h = worley_noise_mix_lanes(noise_xor_i32(
+                    hash_yz,
+                    noise_mul_i32(noise_add_i32(cell_x, noise_set_i32(i)), noise_set_i32(WORLEY_NOISE_HASH_X))
+                ));
+                const noise_i32 h2 = worley_noise_mix_lanes(h);
+
+                const noise_f32 dx = noise_sub(
+                    noise_add(noise_set_f32((f32) i + bias), noise_mul(noise_to_f32(noise_and_i32(h, low_mask)), scale)),
+                    fx
+                );
+                const noise_f32 dy = noise_sub(
+                    noise_add(noise_set_f32((f32) j + bias), noise_mul(noise_to_f32(noise_srl_i32(h, 16)), scale)),
+                    noise_set_f32(fy)
+                );
+                const noise_f32 dz = noise_sub(
+                    noise_add(noise_set_f32((f32) k + bias), noise_mul(noise_to_f32(noise_and_i32(h2, low_mask)), scale)),
+                    noise_set_f32(fz)
+                );
+
+                worley_noise_insert_lanes(
+                    &f1, &f2,
+                    noise_add(noise_add(noise_mul(dx, dx), noise_mul(dy, dy)), noise_mul(dz, dz))
+                );
             }
         }
     }
 
-    return sqrt(min_dist_squared);
+    return worley_noise_output_lanes(f1, f2, output);
+}
+
+/**
+ * Fills a 2D grid with worley noise (e.g. cellular textures, biome maps)
+ *
+ * The sample position of out[row * width + col] is (x + col * step, y + row * step)
+ * The feature point density is 1 per unit square, use step to scale the pattern
+ */
+void worley_noise_2d_grid(
+    f32* __restrict out, int32 width, int32 height,
+    f32 x, f32 y, f32 step,
+    uint32 seed, WorleyNoiseOutput output = WORLEY_NOISE_F1
+) NO_EXCEPT
+{
+    for (int32 row = 0; row < height; ++row) {
+        const f32 py = y + (f32) row * step;
+        f32* out_row = out + (size_t) row * width;
+
+        for (int32 col = 0; col < width; col += NOISE_LANES) {
+            const noise_f32 px = noise_lane_positions(x, col, step);
+            noise_store_partial(out_row + col, worley_noise_2d_lanes(px, py, seed, output), width - col);
+        }
+    }
+}
+
+/**
+ * Fills a 3D grid with worley noise
+ *
+ * The sample position of out[(layer * height + row) * width + col] is (x + col * step, y + row * step, z + layer * step)
+ */
+void worley_noise_3d_grid(
+    f32* __restrict out, int32 width, int32 height, int32 depth,
+    f32 x, f32 y, f32 z, f32 step,
+    uint32 seed, WorleyNoiseOutput output = WORLEY_NOISE_F1
+) NO_EXCEPT
+{
+    for (int32 layer = 0; layer < depth; ++layer) {
+        const f32 pz = z + (f32) layer * step;
+
+        for (int32 row = 0; row < height; ++row) {
+            const f32 py = y + (f32) row * step;
+            f32* out_row = out + ((size_t) layer * height + row) * width;
+
+            for (int32 col = 0; col < width; col += NOISE_LANES) {
+                const noise_f32 px = noise_lane_positions(x, col, step);
+                noise_store_partial(out_row + col, worley_noise_3d_lanes(px, py, pz, seed, output), width - col);
+            }
+        }
+    }
 }
 
 #endif
\ No newline at end of file
@@ -40,23 +40,48 @@ void mesh_from_file_txt(
 
     mesh->vertices = (f32 *) mesh->data;
 
-    // @todo The temp memory reservation is bad, once the file format is really finalized we need to change this.
-    //  We can't just assume these sizes
+    // Count the elements to only reserve the temp memory we actually need
+    int32 max_vertex_count = 0;
+    int32 max_normal_count = 0;
+    int32 max_tex_coord_count = 0;
+    int32 max_face_count = 0;
+
+    for (const char* line = pos; *line != '\0';) {
+        while (*line == ' ' || *line == '\t') {
+            ++line;
+        }
+
+        if (line[0] == 'v' && line[1] == ' ') {
+            ++max_vertex_count;
+        } else if (line[0] == 'v' && line[1] == 'n') {
+            ++max_normal_count;
+        } else if (line[0] == 'v' && line[1] == 't') {
+            ++max_tex_coord_count;
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            ++max_face_count;
+        }
+
+        str_move_to(&line, '\n');
+        if (*line == '\n') {
+            ++line;
+        }
+    }
+
     int32 vertex_count = 0;
-    f32* vertices = (f32 *) memory_get(ring, 500000 * sizeof(f32));
+    f32* vertices = (f32 *) memory_get(ring, (max_vertex_count * 3 + 1) * sizeof(f32));
+    f32* colors = (f32 *) memory_get(ring, (max_vertex_count * 4 + 1) * sizeof(f32));
 
     int32 normal_count = 0;
-    f32* normals = (f32 *) memory_get(ring, 500000 * sizeof(f32));
+    f32* normals = (f32 *) memory_get(ring, (max_normal_count * 3 + 1) * sizeof(f32));
 
     int32 tex_coord_count = 0;
-    f32* tex_coords = (f32 *) memory_get(ring, 500000 * sizeof(f32));
-
-    //int32 color_count = 0;
-    // f32* colors = (f32 *) memory_get(ring, 500000 * sizeof(f32));
+    f32* tex_coords = (f32 *) memory_get(ring, (max_tex_coord_count * 2 + 1) * sizeof(f32));
 
     int32 face_type = VERTEX_TYPE_POSITION;
     int32 face_count = 0;
-    int32* faces = (int32 *) memory_get(ring, 500000 * sizeof(int32));
+
+    // 3 blocks per face and up to 3 elements per block (v/vt/vn)
+    int32* faces = (int32 *) memory_get(ring, (max_face_count * 9 + 1) * sizeof(int32));
 
     uint32 temp_color_count = 0;
 
@@ -142,19 +167,15 @@ void mesh_from_file_txt(
                     // has color information
                     // @todo Move to own case statement // 'co'
                     if (*pos != '\n' && pos[1] != ' ' && pos[1] != '\n') {
-                        if (vertex_count == 0) {
-                            mesh->vertex_type |= VERTEX_TYPE_COLOR;
-                        }
-
-                        vertices[vertex_count * 12 + 8] = str_to_float(pos, &pos); ++pos;
-                        vertices[vertex_count * 12 + 9] = str_to_float(pos, &pos); ++pos;
-                        vertices[vertex_count * 12 + 10] = str_to_float(pos, &pos); ++pos;
+                        colors[vertex_count * 4 + 0] = str_to_float(pos, &pos); ++pos;
+                        colors[vertex_count * 4 + 1] = str_to_float(pos, &pos); ++pos;
+                        colors[vertex_count * 4 + 2] = str_to_float(pos, &pos); ++pos;
 
                         // handle optional alpha [a]
                         if (*pos != '\n' && pos[1] != ' ' && pos[1] != '\n') {
-                            vertices[vertex_count * 12 + 11] = str_to_float(pos, &pos); ++pos;
+                            colors[vertex_count * 4 + 3] = str_to_float(pos, &pos); ++pos;
                         } else {
-                            vertices[vertex_count * 12 + 11] = 1.0f;
+                            colors[vertex_count * 4 + 3] = 1.0f;
                         }
 
                         ++temp_color_count;
@@ -334,6 +355,13 @@ void mesh_from_file_txt(
     }
 
     mesh->vertex_type = face_type;
+    mesh->index_count = 0;
+
+    // Colors are part of the vertex definition ('v x y z r g b [a]') and are only used if every vertex has one
+    if (vertex_count > 0 && temp_color_count == (uint32) vertex_count) {
+        mesh->vertex_type |= VERTEX_TYPE_COLOR;
+    }
+    mesh->lod_count = 0;
 
     // Populate the vertex data based on the face data
     if (face_count > 0) {
@@ -354,9 +382,9 @@ void mesh_from_file_txt(
             ++face_size;
         }
 
+        // The color uses the position index, it has no face element
         if (mesh->vertex_type & VERTEX_TYPE_COLOR) {
             vertex_size += 4;
-            ++face_size;
         }
 
         mesh->vertex_count = face_count * 3;
@@ -393,6 +421,23 @@ void mesh_from_file_txt(
                     2 * sizeof(f32)
                 );
             }
+
+            // The color is always the last attribute
+            if (mesh->vertex_type & VERTEX_TYPE_COLOR) {
+                memcpy(
+                    mesh->data + (i * vertex_size + vertex_size - 4) * sizeof(f32),
+                    &colors[faces[i * face_size] * 4],
+                    4 * sizeof(f32)
+                );
+            }
+        }
+    } else if (mesh->vertex_type & VERTEX_TYPE_COLOR) {
+        // No face data -> just output the vertices with their colors
+        mesh->vertex_count = vertex_count;
+
+        for (int32 i = 0; i < vertex_count; ++i) {
+            memcpy(mesh->vertices + i * 7, vertices + i * 3, 3 * sizeof(f32));
+            memcpy(mesh->vertices + i * 7 + 3, colors + i * 4, 4 * sizeof(f32));
         }
     } else {
         // No face data -> just output the vertices
@@ -410,13 +455,206 @@ enum MeshLoadingRestriction {
     MESH_LOADING_RESTRICTION_EVERYTHING = 31
 };
 
-// @todo sometimes we don't care about some data, we should have an option which defines which data should be loaded
-//      this can improve performance for algorithms on this. e.g.:
-//      on the server side we only care about the vertex positions for collision (no normals, no color, ...)
+#define MESH_HEADER_SIZE (5 * sizeof(int32) + 6 * sizeof(f32))
+#define MESH_LOD_DATA_SIZE (2 * sizeof(uint32) + sizeof(f32))
+
+// Offset in f32 of an attribute in the interleaved vertex
+FORCE_INLINE
+int32 mesh_attribute_offset(uint32 vertex_type, VertexType attribute) NO_EXCEPT
+{
+    return mesh_vertex_size(vertex_type & (attribute - 1));
+}
+
+// Size of the attribute streams in the binary data
+static inline
+size_t mesh_stream_size(uint32 vertex_type, uint32 vertex_count) NO_EXCEPT
+{
+    size_t size = 0;
+    if (vertex_type & VERTEX_TYPE_POSITION) {
+        size += align_up(vertex_count * 3 * sizeof(uint16), 4);
+    }
+
+    if (vertex_type & VERTEX_TYPE_NORMAL) {
+        size += align_up(vertex_count * 2 * sizeof(int8), 4);
+    }
+
+    if (vertex_type & VERTEX_TYPE_TEXTURE_COORD) {
+        size += align_up(vertex_count * 2 * sizeof(uint16), 4);
+    }
+
+    if (vertex_type & VERTEX_TYPE_COLOR) {
+        size += vertex_count * 4 * sizeof(uint8);
+    }
+
+    return size;
+}
+
+FORCE_INLINE
+size_t mesh_index_size(uint32 vertex_count) NO_EXCEPT
+{
+    return vertex_count <= 65536 ? sizeof(uint16) : sizeof(uint32);
+}
+
+// Size of mesh->data required by mesh_from_data()
+FORCE_INLINE
+size_t mesh_memory_size(uint32 vertex_type, uint32 vertex_count, uint32 index_count) NO_EXCEPT
+{
+    return mesh_vertex_size(vertex_type) * sizeof(f32) * vertex_count + index_count * sizeof(uint32);
+}
+
+/**
+ * Size of mesh->data required by mesh_from_data() for this binary mesh data
+ *
+ * Only the header is read. The binary data is quantized, the size of the loaded mesh is therefore larger than the data
+ */
+static inline
+size_t mesh_data_memory_size(
+    const byte* data,
+    int32 load_format = MESH_LOADING_RESTRICTION_EVERYTHING
+) NO_EXCEPT
+{
+    int32 version;
+    uint32 vertex_type;
+    uint32 vertex_count;
+    data = read_le(data, &version);
+    data = read_le(data, &vertex_type);
+    data = read_le(data, &vertex_count);
+
+    if (version == 1) {
+        return mesh_memory_size(vertex_type, vertex_count, 0);
+    }
+
+    uint32 index_count;
+    read_le(data, &index_count);
+
+    return mesh_memory_size(
+        vertex_type & load_format,
+        vertex_count,
+        (load_format & MESH_LOADING_RESTRICTION_FACES) ? index_count : 0
+    );
+}
+
+static inline
+uint16 mesh_f32_to_f16(f32 value) NO_EXCEPT
+{
+    uint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint32 sign = (bits >> 16) & 0x8000;
+    const int32 exponent = (int32) ((bits >> 23) & 0xFF) - 127 + 15;
+    uint32 mantissa = bits & 0x7FFFFF;
+
+    if (((bits >> 23) & 0xFF) == 0xFF) {
+        // inf/nan
+        return (uint16) (sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    } else if (exponent >= 31) {
+        // Too large -> inf
+        return (uint16) (sign | 0x7C00);
+    } else if (exponent <= 0) {
+        if (exponent < -10) {
+            // Too small -> 0
+            return (uint16) sign;
+        }
+
+        // Subnormal
+        mantissa |= 0x800000;
+        const int32 shift = 14 - exponent;
+
+        return (uint16) (sign | ((mantissa >> shift) + ((mantissa >> (shift - 1)) & 1)));
+    }
+
+    // Rounding may carry into the exponent which is the correct result
+    return (uint16) ((sign | ((uint32) exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
+
+static inline
+f32 mesh_f16_to_f32(uint16 value) NO_EXCEPT
+{
+    const uint32 sign = (uint32) (value & 0x8000) << 16;
+    int32 exponent = (value >> 10) & 0x1F;
+    uint32 mantissa = value & 0x3FF;
+
+    uint32 bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Subnormal -> normalize
+            exponent = 1;
+            while (!(mantissa & 0x400)) {
+                mantissa <<= 1;
+                --exponent;
+            }
+
+            bits = sign | ((uint32) (exponent + 112) << 23) | ((mantissa & 0x3FF) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((uint32) (exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    f32 result;
+    memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+// Octahedral normal encoding
+static inline
+void mesh_normal_encode(const f32* __restrict normal, int8* __restrict out) NO_EXCEPT
+{
+    const f32 l1 = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+    const f32 inv_l1 = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+
+    f32 x = normal[0] * inv_l1;
+    f32 y = normal[1] * inv_l1;
+
+    // Fold the lower hemisphere
+    if (normal[2] < 0.0f) {
+        const f32 tx = x;
+        x = (1.0f - fabsf(y)) * (tx >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - fabsf(tx)) * (y >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    out[0] = (int8) roundf(x * 127.0f);
+    out[1] = (int8) roundf(y * 127.0f);
+}
+
+static inline
+void mesh_normal_decode(const int8* __restrict in, f32* __restrict normal) NO_EXCEPT
+{
+    f32 x = oms_max((f32) in[0] / 127.0f, -1.0f);
+    f32 y = oms_max((f32) in[1] / 127.0f, -1.0f);
+    const f32 z = 1.0f - fabsf(x) - fabsf(y);
+
+    // Unfold the lower hemisphere
+    const f32 t = oms_max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    const f32 inv_length = 1.0f / sqrtf(x * x + y * y + z * z);
+    normal[0] = x * inv_length;
+    normal[1] = y * inv_length;
+    normal[2] = z * inv_length;
+}
+
+/**
+ * Loads the binary mesh data into mesh->data
+ *
+ * The attributes are de-quantized into interleaved f32 vertices followed by the uint32 indices
+ * WARNING: mesh needs to have mesh_data_memory_size() reserved and assigned to data
+ *
+ * @param data          Binary mesh data
+ * @param mesh          Mesh
+ * @param load_format   Attributes to load (MeshLoadingRestriction), e.g. the server only needs the positions for collision
+ *
+ * @return Bytes used in mesh->data
+ */
 int32 mesh_from_data(
     const byte* data,
     Mesh* mesh,
-    //int32 load_format = MESH_LOADING_RESTRICTION_EVERYTHING,
+    int32 load_format = MESH_LOADING_RESTRICTION_EVERYTHING,
     MAYBE_UNUSED int32 steps = 8
 )
 {
@@ -430,69 +668,185 @@ int32 mesh_from_data(
     const byte* pos = data;
 
     int32 version;
+    uint32 vertex_type;
     pos = read_le(pos, &version);
-    pos = read_le(pos, &mesh->vertex_type);
+    pos = read_le(pos, &vertex_type);
     pos = read_le(pos, &mesh->vertex_count);
 
-    int32 vertex_size = 0;
-    if (mesh->vertex_type & VERTEX_TYPE_POSITION) {
-        vertex_size += 3;
+    mesh->vertices = (f32 *) mesh->data;
+
+    if (version == 1) {
+        // Legacy format: flat f32 vertices without indices, the load format is ignored
+        mesh->vertex_type = vertex_type;
+        mesh->index_count = 0;
+        mesh->indices = NULL;
+        mesh->lod_count = 0;
+
+        const int32 offset = (int32) (sizeof(f32) * mesh_vertex_size(vertex_type) * mesh->vertex_count);
+        if (mesh->vertex_count > 0) {
+            memcpy(mesh->data, pos, offset);
+        }
+
+        SWAP_ENDIAN_LITTLE_SIMD(
+            (int32 *) mesh->data,
+            (int32 *) mesh->data,
+            offset / 4, // everything is 4 bytes -> easy to swap
+            steps
+        );
+        PSEUDO_USE(steps);
+
+        return offset;
     }
 
-    if (mesh->vertex_type & VERTEX_TYPE_NORMAL) {
-        vertex_size += 3;
+    uint32 index_count;
+    pos = read_le(pos, &index_count);
+
+    uint32 lod_count;
+    pos = read_le(pos, &lod_count);
+
+    f32 position_min[3];
+    f32 position_scale[3];
+    for (int32 i = 0; i < 3; ++i) {
+        pos = read_le(pos, &position_min[i]);
     }
 
-    if (mesh->vertex_type & VERTEX_TYPE_TEXTURE_COORD) {
-        vertex_size += 2;
+    for (int32 i = 0; i < 3; ++i) {
+        pos = read_le(pos, &position_scale[i]);
+        position_scale[i] /= 65535.0f;
     }
 
-    if (mesh->vertex_type & VERTEX_TYPE_COLOR) {
-        vertex_size += 4;
+    ASSERT_TRUE(lod_count <= MESH_LOD_MAX);
+    mesh->lod_count = 0;
+
+    for (uint32 i = 0; i < lod_count; ++i) {
+        MeshLod lod;
+        pos = read_le(pos, &lod.index_offset);
+        pos = read_le(pos, &lod.index_count);
+        pos = read_le(pos, &lod.error);
+
+        if (i < MESH_LOD_MAX) {
+            mesh->lods[mesh->lod_count++] = lod;
+        }
     }
 
-    int32 offset = 0;
-    if (mesh->vertex_count > 0) {
-        memcpy(mesh->data, pos, sizeof(f32) * vertex_size * mesh->vertex_count);
-        mesh->vertices = (f32 *) mesh->data;
+    mesh->vertex_type = vertex_type & load_format;
+
+    const uint32 vertex_count = mesh->vertex_count;
+    const int32 vertex_size = mesh_vertex_size(mesh->vertex_type);
+    f32* const vertices = mesh->vertices;
+
+    if (vertex_type & VERTEX_TYPE_POSITION) {
+        if (mesh->vertex_type & VERTEX_TYPE_POSITION) {
+            const int32 offset = mesh_attribute_offset(mesh->vertex_type, VERTEX_TYPE_POSITION);
+            const byte* stream = pos;
+
+            for (uint32 i = 0; i < vertex_count; ++i) {
+                f32* const vertex = vertices + i * vertex_size + offset;
+
+                uint16 q[3];
+                stream = read_le(stream, &q[0]);
+                stream = read_le(stream, &q[1]);
+                stream = read_le(stream, &q[2]);
 
-        pos += sizeof(f32) * vertex_size * mesh->vertex_count;
-        offset += sizeof(f32) * vertex_size * mesh->vertex_count;
+                vertex[0] = position_min[0] + (f32) q[0] * position_scale[0];
+                vertex[1] = position_min[1] + (f32) q[1] * position_scale[1];
+                vertex[2] = position_min[2] + (f32) q[2] * position_scale[2];
+            }
+        }
+
+        pos += align_up(vertex_count * 3 * sizeof(uint16), 4);
     }
 
-    /*
-    #if defined(OPENGL)
+    if (vertex_type & VERTEX_TYPE_NORMAL) {
         if (mesh->vertex_type & VERTEX_TYPE_NORMAL) {
-            for (int i = 0; i < mesh->vertex_count; ++i) {
-                mesh->vertices[i * vertex_size + 3] *= -1;
-                mesh->vertices[i * vertex_size + 3 + 1] *= -1;
-                mesh->vertices[i * vertex_size + 3 + 2] *= -1;
+            const int32 offset = mesh_attribute_offset(mesh->vertex_type, VERTEX_TYPE_NORMAL);
+            const int8* stream = (const int8 *) pos;
+
+            for (uint32 i = 0; i < vertex_count; ++i) {
+                mesh_normal_decode(stream + i * 2, vertices + i * vertex_size + offset);
             }
         }
-    #endif
-    */
 
-    SWAP_ENDIAN_LITTLE_SIMD(
-        (int32 *) mesh->data,
-        (int32 *) mesh->data,
-        offset / 4, // everything is 4 bytes -> easy to swap
-        steps
-    );
-    PSEUDO_USE(steps);
+        pos += align_up(vertex_count * 2 * sizeof(int8), 4);
+    }
+
+    if (vertex_type & VERTEX_TYPE_TEXTURE_COORD) {
+        if (mesh->vertex_type & VERTEX_TYPE_TEXTURE_COORD) {
+            const int32 offset = mesh_attribute_offset(mesh->vertex_type, VERTEX_TYPE_TEXTURE_COORD);
+            const byte* stream = pos;
+
+            for (uint32 i = 0; i < vertex_count; ++i) {
+                f32* const vertex = vertices + i * vertex_size + offset;
+                for (int32 j = 0; j < 2; ++j) {
+                    uint16 h;
+                    stream = read_le(stream, &h);
+                    vertex[j] = mesh_f16_to_f32(h);
+                }
+            }
+        }
+
+        pos += align_up(vertex_count * 2 * sizeof(uint16), 4);
+    }
+
+    if (vertex_type & VERTEX_TYPE_COLOR) {
+        if (mesh->vertex_type & VERTEX_TYPE_COLOR) {
+            const int32 offset = mesh_attribute_offset(mesh->vertex_type, VERTEX_TYPE_COLOR);
+
+            for (uint32 i = 0; i < vertex_count; ++i) {
+                f32* const vertex = vertices + i * vertex_size + offset;
+                for (int32 j = 0; j < 4; ++j) {
+                    vertex[j] = (f32) pos[i * 4 + j] / 255.0f;
+                }
+            }
+        }
+
+        pos += vertex_count * 4 * sizeof(uint8);
+    }
 
-    return offset;
+    if (!(load_format & MESH_LOADING_RESTRICTION_FACES)) {
+        index_count = 0;
+        mesh->lod_count = 0;
+    }
+
+    mesh->index_count = index_count;
+    mesh->indices = (uint32 *) (vertices + vertex_count * vertex_size);
+
+    if (mesh_index_size(vertex_count) == sizeof(uint16)) {
+        for (uint32 i = 0; i < index_count; ++i) {
+            uint16 index;
+            pos = read_le(pos, &index);
+            mesh->indices[i] = index;
+        }
+    } else {
+        for (uint32 i = 0; i < index_count; ++i) {
+            pos = read_le(pos, &mesh->indices[i]);
+        }
+    }
+
+    return (int32) mesh_memory_size(mesh->vertex_type, vertex_count, index_count);
 }
 
-// @bug this is wrong, since it is the max size
-// We would have to check the vertex format to calculate the actual size
-int32 mesh_data_size(const Mesh* mesh)
+// Size of the binary data created by mesh_to_data()
+int32 mesh_data_size(const Mesh* mesh, uint32 vertex_save_format = VERTEX_TYPE_ALL)
 {
-    return sizeof(int32)
-        + sizeof(mesh->vertex_type)
-        + sizeof(mesh->vertex_count)
-        + 12 * sizeof(f32) * mesh->vertex_count; // 12 is the maximum value
+    return (int32) (MESH_HEADER_SIZE
+        + mesh->lod_count * MESH_LOD_DATA_SIZE
+        + mesh_stream_size(mesh->vertex_type & vertex_save_format, mesh->vertex_count)
+        + mesh->index_count * mesh_index_size(mesh->vertex_count)
+    );
 }
 
+/**
+ * Creates the binary mesh data with quantized attributes
+ *
+ * Meshes should be indexed and optimized before (see mesh_optimize())
+ *
+ * @param mesh                  Mesh with interleaved f32 vertices
+ * @param data                  Output, must have mesh_data_size() bytes available
+ * @param vertex_save_format    Attributes to save (VertexType)
+ *
+ * @return Size of the binary data
+ */
 int32 mesh_to_data(
     const Mesh* mesh,
     byte* data,
@@ -502,75 +856,123 @@ int32 mesh_to_data(
 {
     byte* pos = data;
 
-    const int32 version = MESH_VERSION;
-    memcpy(pos, &version, sizeof(version));
-    pos += sizeof(version);
-
-    // vertices
-    if (vertex_save_format == VERTEX_TYPE_ALL) {
-        vertex_save_format = mesh->vertex_type;
-    }
-
-    memcpy(pos, &vertex_save_format, sizeof(vertex_save_format));
-    pos += sizeof(vertex_save_format);
+    const uint32 vertex_type = mesh->vertex_type & vertex_save_format;
+    const uint32 vertex_count = mesh->vertex_count;
+    const int32 vertex_size = mesh_vertex_size(mesh->vertex_type);
+    const f32* const vertices = mesh->vertices;
+
+    pos = write_le(pos, (int32) MESH_VERSION);
+    pos = write_le(pos, vertex_type);
+    pos = write_le(pos, vertex_count);
+    pos = write_le(pos, mesh->index_count);
+    pos = write_le(pos, mesh->lod_count);
+
+    // Position bounds for the quantization
+    f32 position_min[3] = {0.0f, 0.0f, 0.0f};
+    f32 position_extent[3] = {0.0f, 0.0f, 0.0f};
+
+    if ((vertex_type & VERTEX_TYPE_POSITION) && vertex_count) {
+        f32 position_max[3];
+        for (int32 j = 0; j < 3; ++j) {
+            position_min[j] = position_max[j] = vertices[j];
+        }
 
-    memcpy(pos, &mesh->vertex_count, sizeof(mesh->vertex_count));
-    pos += sizeof(mesh->vertex_count);
+        for (uint32 i = 1; i < vertex_count; ++i) {
+            for (int32 j = 0; j < 3; ++j) {
+                position_min[j] = oms_min(position_min[j], vertices[i * vertex_size + j]);
+                position_max[j] = oms_max(position_max[j], vertices[i * vertex_size + j]);
+            }
+        }
 
-    // vertices
-    int32 vertex_size = 0;
-    if (mesh->vertex_type & VERTEX_TYPE_POSITION) {
-        vertex_size += 3;
+        for (int32 j = 0; j < 3; ++j) {
+            position_extent[j] = position_max[j] - position_min[j];
+        }
     }
 
-    if (mesh->vertex_type & VERTEX_TYPE_NORMAL) {
-        vertex_size += 3;
+    for (int32 j = 0; j < 3; ++j) {
+        pos = write_le(pos, position_min[j]);
     }
 
-    if (mesh->vertex_type & VERTEX_TYPE_TEXTURE_COORD) {
-        vertex_size += 2;
+    for (int32 j = 0; j < 3; ++j) {
+        pos = write_le(pos, position_extent[j]);
     }
 
-    if (mesh->vertex_type & VERTEX_TYPE_COLOR) {
-        vertex_size += 4;
+    for (uint32 i = 0; i < mesh->lod_count; ++i) {
+        pos = write_le(pos, mesh->lods[i].index_offset);
+        pos = write_le(pos, mesh->lods[i].index_count);
+        pos = write_le(pos, mesh->lods[i].error);
     }
 
-    int32 out_vertex_size = 0;
-    if (vertex_save_format & VERTEX_TYPE_POSITION) {
-        out_vertex_size += 3;
-    }
+    if (vertex_type & VERTEX_TYPE_POSITION) {
+        const int32 offset = mesh_attribute_offset(mesh->vertex_type, VERTEX_TYPE_POSITION);
+        byte* const start = pos;
+
+        for (uint32 i = 0; i < vertex_count; ++i) {
+            const f32* const vertex = vertices + i * vertex_size + offset;
+            for (int32 j = 0; j < 3; ++j) {
+                const f32 normalized = position_extent[j] > 0.0f
+                    ? (vertex[j] - position_min[j]) / position_extent[j]
+                    : 0.0f;
+
+                pos = write_le(pos, (uint16) oms_clamp(roundf(normalized * 65535.0f), 0.0f, 65535.0f));
+            }
+        }
 
-    if (vertex_save_format & VERTEX_TYPE_NORMAL) {
-        out_vertex_size += 3;
+        memset(pos, 0, align_up(pos - start, 4) - (pos - start));
+        pos = start + align_up(pos - start, 4);
     }
 
-    if (vertex_save_format & VERTEX_TYPE_TEXTURE_COORD) {
-        out_vertex_size += 2;
+    if (vertex_type & VERTEX_TYPE_NORMAL) {
+        const int32 offset = mesh_attribute_offset(mesh->vertex_type, VERTEX_TYPE_NORMAL);
+        byte* const start = pos;
+
+        for (uint32 i = 0; i < vertex_count; ++i) {
+            mesh_normal_encode(vertices + i * vertex_size + offset, (int8 *) pos);
+            pos += 2;
+        }
+
+        memset(pos, 0, align_up(pos - start, 4) - (pos - start));
+        pos = start + align_up(pos - start, 4);
     }
 
-    if (vertex_save_format & VERTEX_TYPE_COLOR) {
-        out_vertex_size += 4;
+    if (vertex_type & VERTEX_TYPE_TEXTURE_COORD) {
+        const int32 offset = mesh_attribute_offset(mesh->vertex_type, VERTEX_TYPE_TEXTURE_COORD);
+        byte* const start = pos;
+
+        for (uint32 i = 0; i < vertex_count; ++i) {
+            const f32* const vertex = vertices + i * vertex_size + offset;
+            pos = write_le(pos, mesh_f32_to_f16(vertex[0]));
+            pos = write_le(pos, mesh_f32_to_f16(vertex[1]));
+        }
+
+        memset(pos, 0, align_up(pos - start, 4) - (pos - start));
+        pos = start + align_up(pos - start, 4);
     }
 
-    if ((mesh->vertex_type == VERTEX_TYPE_ALL && vertex_save_format == VERTEX_TYPE_ALL)
-        || (mesh->vertex_type == vertex_save_format)
-    ) {
-        // data is the same as in the array
-        memcpy(pos, mesh->vertices, vertex_size * sizeof(f32) * mesh->vertex_count);
-        pos += vertex_size * sizeof(f32) * mesh->vertex_count;
+    if (vertex_type & VERTEX_TYPE_COLOR) {
+        const int32 offset = mesh_attribute_offset(mesh->vertex_type, VERTEX_TYPE_COLOR);
+
+        for (uint32 i = 0; i < vertex_count; ++i) {
+            const f32* const vertex = vertices + i * vertex_size + offset;
+            for (int32 j = 0; j < 4; ++j) {
+                *pos++ = (uint8) oms_clamp(roundf(vertex[j] * 255.0f), 0.0f, 255.0f);
+            }
+        }
     }
 
-    const int32 size = (int32) (pos - data);
+    if (mesh_index_size(vertex_count) == sizeof(uint16)) {
+        for (uint32 i = 0; i < mesh->index_count; ++i) {
+            pos = write_le(pos, (uint16) mesh->indices[i]);
+        }
+    } else {
+        for (uint32 i = 0; i < mesh->index_count; ++i) {
+            pos = write_le(pos, mesh->indices[i]);
+        }
+    }
 
-    SWAP_ENDIAN_LITTLE_SIMD(
-        (int32 *) data,
-        (int32 *) data,
-        size / 4, // everything in here is 4 bytes -> easy to swap
-        steps
-    );
     PSEUDO_USE(steps);
 
-    return size;
+    return (int32) (pos - data);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -11,8 +11,44 @@
 #define COMS_OBJECT_MESH_H
 
 #include "../stdlib/Stdlib.h"
-
-#define MESH_VERSION 1
+#include "Vertex.h"
+
+#define MESH_VERSION 2
+
+// File layout - binary (little endian)
+//      int32 version
+//      uint32 vertex_type
+//      uint32 vertex_count
+//      uint32 index_count                      indices of all LODs
+//      uint32 lod_count
+//      f32 position_min[3]
+//      f32 position_extent[3]
+//      MeshLod lods[lod_count]                 uint32 index_offset, uint32 index_count, f32 error
+//      Attribute streams (every stream starts 4 byte aligned), only the attributes of vertex_type are stored:
+//          uint16 positions[vertex_count * 3]  unorm quantized in the position bounds
+//          int8 normals[vertex_count * 2]      octahedral encoded snorm
+//          uint16 tex_coords[vertex_count * 2] half floats
+//          uint8 colors[vertex_count * 4]      unorm
+//      uint16/uint32 indices[index_count]      uint16 if vertex_count <= 65536
+//
+// The attributes are stored as separate streams, this allows to only load the attributes that are needed.
+// Version 1 files contain only the header (version, vertex_type, vertex_count) followed by flat f32 vertices.
+//
+// All LODs share the same vertices, every LOD is a range in the index buffer (LOD 0 = full detail)
+
+#define MESH_LOD_MAX 8
+
+// A coarser LOD is only selected once its projected error is this much below the threshold
+// This avoids LOD popping back and forth if the distance changes only slightly
+#define MESH_LOD_HYSTERESIS 0.25f
+
+struct MeshLod {
+    uint32 index_offset;
+    uint32 index_count;
+
+    // Max. geometric deviation from the full detail mesh in object space
+    f32 error;
+};
 
 // @todo how to handle different objects and groups?
 //      maybe make a mesh hold other meshes?
@@ -38,6 +74,10 @@ struct Mesh {
     uint32 index_count; // can mean only position or combination of position, normal, tex, ...
     uint32* indices;
 
+    // 0 = not indexed
+    uint32 lod_count;
+    MeshLod lods[MESH_LOD_MAX];
+
     // @todo this only works if you have sub meshes e.g. one for body, one for hat, one for weapon etc.
     uint32 vertex_ref;
     uint32 vao;
@@ -66,4 +106,72 @@ struct Mesh {
     Mesh* meshes;
 };
 
+// Vertex size in f32 of the interleaved vertices
+FORCE_INLINE
+int32 mesh_vertex_size(uint32 vertex_type) NO_EXCEPT
+{
+    return ((vertex_type & VERTEX_TYPE_POSITION) ? 3 : 0)
+        + ((vertex_type & VERTEX_TYPE_NORMAL) ? 3 : 0)
+        + ((vertex_type & VERTEX_TYPE_TEXTURE_COORD) ? 2 : 0)
+        + ((vertex_type & VERTEX_TYPE_COLOR) ? 4 : 0);
+}
+
+// Converts object space sizes at distance 1 into pixels
+FORCE_INLINE
+f32 mesh_lod_projection_scale(f32 fov_y, f32 screen_height) NO_EXCEPT
+{
+    return screen_height / (2.0f * tanf(fov_y * 0.5f));
+}
+
+/**
+ * Selects the coarsest LOD whose error is not visible on screen
+ *
+ * The projected error is the size of the LOD error in pixels at the given distance.
+ * Switching to a coarser LOD requires the projected error to be clearly below the threshold (see MESH_LOD_HYSTERESIS)
+ *
+ * @param mesh              Mesh
+ * @param distance          Distance between camera and mesh (object space units)
+ * @param projection_scale  See mesh_lod_projection_scale() (should include the object scale)
+ * @param threshold         Max. allowed error in pixels (e.g. 1.0)
+ * @param current_lod       LOD used in the previous frame
+ *
+ * @return LOD index
+ */
+inline
+int32 mesh_lod_select(
+    const Mesh* mesh,
+    f32 distance,
+    f32 projection_scale,
+    f32 threshold,
+    int32 current_lod
+) NO_EXCEPT
+{
+    if (mesh->lod_count < 2 || distance <= 0.0f) {
+        return 0;
+    }
+
+    const f32 scale = projection_scale / distance;
+    int32 lod = OMS_CLAMP(current_lod, 0, (int32) mesh->lod_count - 1);
+
+    // The errors increase monotonically with the LOD
+    while (lod > 0 && mesh->lods[lod].error * scale > threshold) {
+        --lod;
+    }
+
+    const f32 coarse_threshold = threshold * (1.0f - MESH_LOD_HYSTERESIS);
+    while (lod + 1 < (int32) mesh->lod_count && mesh->lods[lod + 1].error * scale <= coarse_threshold) {
+        ++lod;
+    }
+
+    return lod;
+}
+
+FORCE_INLINE
+const uint32* mesh_lod_indices(const Mesh* mesh, int32 lod, uint32* index_count) NO_EXCEPT
+{
+    *index_count = mesh->lods[lod].index_count;
+
+    return mesh->indices + mesh->lods[lod].index_offset;
+}
+
 #endif
\ No newline at end of file
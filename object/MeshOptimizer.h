@@ -0,0 +1,1010 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_OBJECT_MESH_OPTIMIZER_H
+#define COMS_OBJECT_MESH_OPTIMIZER_H
+
+#include "../stdlib/Stdlib.h"
+#include "../memory/RingMemory.cpp"
+#include "../hash/GeneralHash.h"
+#include "../sort/Sort.h"
+#include "Mesh.h"
+
+// Offline mesh optimization (asset builder), all temp memory comes from the ring memory
+//
+// Pipeline (see mesh_optimize()):
+//      1. Vertex de-duplication + index buffer
+//      2. Post-transform vertex cache order (Forsyth)
+//      3. Overdraw order (clusters sorted front to back from the outside)
+//      4. Vertex fetch order (vertices sorted by first use)
+
+// Cache size used for the vertex cache optimization, the score doesn't depend much on the actual hardware cache size
+#define MESH_VERTEX_CACHE_SIZE 32
+
+// Cache size used to split the triangles into clusters for the overdraw optimization
+#define MESH_OVERDRAW_CACHE_SIZE 16
+
+/**
+ * Removes duplicate vertices and creates the index buffer
+ *
+ * The vertices are compared binary (e.g. -0.0 != 0.0)
+ *
+ * @param vertices      Interleaved vertices, the unique vertices are compacted in place
+ * @param vertex_count  Vertex count
+ * @param vertex_size   Vertex size in f32
+ * @param indices       Output indices (vertex_count elements)
+ * @param ring          Temp memory
+ *
+ * @return Unique vertex count
+ */
+uint32 mesh_index_vertices(
+    f32* const vertices,
+    uint32 vertex_count,
+    int32 vertex_size,
+    uint32* const indices,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    const size_t stride = vertex_size * sizeof(f32);
+
+    uint32 table_size = 64;
+    while (table_size < vertex_count * 2) {
+        table_size <<= 1;
+    }
+
+    // Index of the unique vertex, -1 = empty
+    int32* table = (int32 *) memory_get(ring, table_size * sizeof(int32), sizeof(int32));
+    memset(table, -1, table_size * sizeof(int32));
+
+    uint32 unique_count = 0;
+    for (uint32 i = 0; i < vertex_count; ++i) {
+        const f32* const vertex = vertices + i * vertex_size;
+
+        uint32 slot = (uint32) hash_murmur3_64(vertex, stride) & (table_size - 1);
+        while (table[slot] >= 0 && memcmp(vertices + table[slot] * vertex_size, vertex, stride) != 0) {
+            slot = (slot + 1) & (table_size - 1);
+        }
+
+        if (table[slot] < 0) {
+            // The unique vertices are always at a position <= i -> compaction in place is safe
+            if (unique_count != i) {
+                memcpy(vertices + unique_count * vertex_size, vertex, stride);
+            }
+
+            table[slot] = (int32) unique_count++;
+        }
+
+        indices[i] = (uint32) table[slot];
+    }
+
+    return unique_count;
+}
+
+// Average cache miss ratio = vertex shader invocations per triangle for a FIFO cache
+// 3.0 = worst case, 0.5 = best case for large regular grids
+f32 mesh_vertex_cache_acmr(
+    const uint32* const indices,
+    uint32 index_count,
+    uint32 vertex_count,
+    uint32 cache_size,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    if (index_count < 3) {
+        return 0.0f;
+    }
+
+    uint32* timestamps = (uint32 *) memory_get(ring, vertex_count * sizeof(uint32), sizeof(uint32));
+    memset(timestamps, 0, vertex_count * sizeof(uint32));
+
+    uint32 timestamp = cache_size + 1;
+    uint32 misses = 0;
+
+    for (uint32 i = 0; i < index_count; ++i) {
+        const uint32 v = indices[i];
+        if (timestamp - timestamps[v] > cache_size) {
+            timestamps[v] = timestamp++;
+            ++misses;
+        }
+    }
+
+    return (f32) misses / (f32) (index_count / 3);
+}
+
+// Vertex score based on the cache position and the amount of triangles that still need the vertex
+static inline
+f32 mesh_vertex_score(int32 cache_position, uint32 live_triangles) NO_EXCEPT
+{
+    if (live_triangles == 0) {
+        return -1.0f;
+    }
+
+    f32 score = 0.0f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            // The last triangle, we don't want to favor it too much otherwise we create strips
+            score = 0.75f;
+        } else {
+            const f32 s = 1.0f - (f32) (cache_position - 3) / (f32) (MESH_VERTEX_CACHE_SIZE - 3);
+            score = s * sqrtf(s);
+        }
+    }
+
+    // Vertices with few triangles left should be finished first to avoid them later being isolated
+    return score + 2.0f / sqrtf((f32) live_triangles);
+}
+
+/**
+ * Re-orders the triangles to improve the post-transform vertex cache hit rate
+ *
+ * Linear-speed vertex cache optimization (Tom Forsyth)
+ */
+void mesh_optimize_vertex_cache(
+    uint32* const indices,
+    uint32 index_count,
+    uint32 vertex_count,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    const uint32 triangle_count = index_count / 3;
+    if (triangle_count < 2) {
+        return;
+    }
+
+    uint32* offsets = (uint32 *) memory_get(ring, (vertex_count + 1) * sizeof(uint32), sizeof(uint32));
+    uint32* live = (uint32 *) memory_get(ring, vertex_count * sizeof(uint32), sizeof(uint32));
+    uint32* adjacency = (uint32 *) memory_get(ring, index_count * sizeof(uint32), sizeof(uint32));
+    int32* cache_positions = (int32 *) memory_get(ring, vertex_count * sizeof(int32), sizeof(int32));
+    f32* vertex_scores = (f32 *) memory_get(ring, vertex_count * sizeof(f32), sizeof(f32));
+    f32* triangle_scores = (f32 *) memory_get(ring, triangle_count * sizeof(f32), sizeof(f32));
+    bool* emitted = (bool *) memory_get(ring, triangle_count * sizeof(bool), sizeof(bool));
+    uint32* output = (uint32 *) memory_get(ring, index_count * sizeof(uint32), sizeof(uint32));
+
+    // Vertex -> triangles
+    memset(live, 0, vertex_count * sizeof(uint32));
+    for (uint32 i = 0; i < triangle_count * 3; ++i) {
+        ++live[indices[i]];
+    }
+
+    offsets[0] = 0;
+    for (uint32 v = 0; v < vertex_count; ++v) {
+        offsets[v + 1] = offsets[v] + live[v];
+        live[v] = 0;
+    }
+
+    for (uint32 t = 0; t < triangle_count; ++t) {
+        for (int32 k = 0; k < 3; ++k) {
+            const uint32 v = indices[t * 3 + k];
+            adjacency[offsets[v] + live[v]++] = t;
+        }
+    }
+
+    for (uint32 v = 0; v < vertex_count; ++v) {
+        cache_positions[v] = -1;
+        vertex_scores[v] = mesh_vertex_score(-1, live[v]);
+    }
+
+    int32 best = -1;
+    f32 best_score = -1.0f;
+    for (uint32 t = 0; t < triangle_count; ++t) {
+        triangle_scores[t] = vertex_scores[indices[t * 3]]
+            + vertex_scores[indices[t * 3 + 1]]
+            + vertex_scores[indices[t * 3 + 2]];
+
+        if (triangle_scores[t] > best_score) {
+            best_score = triangle_scores[t];
+            best = (int32) t;
+        }
+    }
+
+    memset(emitted, 0, triangle_count * sizeof(bool));
+
+    uint32 cache[MESH_VERTEX_CACHE_SIZE + 3];
+    int32 cache_count = 0;
+
+    // Fallback if no triangle in the cache is left
+    uint32 cursor = 0;
+
+    for (uint32 out = 0; out < triangle_count; ++out) {
+        if (best < 0) {
+            while (emitted[cursor]) {
+                ++cursor;
+            }
+
+            best = (int32) cursor;
+        }
+
+        const uint32* const triangle = indices + best * 3;
+        memcpy(output + out * 3, triangle, 3 * sizeof(uint32));
+        emitted[best] = true;
+
+        // Remove the triangle from the live triangles of its vertices
+        for (int32 k = 0; k < 3; ++k) {
+            const uint32 v = triangle[k];
+            uint32* const list = adjacency + offsets[v];
+
+            for (uint32 i = 0; i < live[v]; ++i) {
+                if (list[i] == (uint32) best) {
+                    list[i] = list[live[v] - 1];
+                    break;
+                }
+            }
+
+            --live[v];
+        }
+
+        // New cache = triangle vertices + previous cache without them
+        uint32 new_cache[MESH_VERTEX_CACHE_SIZE + 3];
+        int32 new_count = 0;
+
+        for (int32 k = 0; k < 3; ++k) {
+            new_cache[new_count++] = triangle[k];
+        }
+
+        for (int32 i = 0; i < cache_count; ++i) {
+            const uint32 v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                new_cache[new_count++] = v;
+            }
+        }
+
+        // Update the scores of all vertices that changed their cache position (incl. the evicted ones)
+        for (int32 i = 0; i < new_count; ++i) {
+            const uint32 v = new_cache[i];
+            cache_positions[v] = i < MESH_VERTEX_CACHE_SIZE ? i : -1;
+            vertex_scores[v] = mesh_vertex_score(cache_positions[v], live[v]);
+        }
+
+        // Only triangles of the updated vertices can change their score
+        best = -1;
+        best_score = -1.0f;
+
+        for (int32 i = 0; i < new_count; ++i) {
+            const uint32 v = new_cache[i];
+            const uint32* const list = adjacency + offsets[v];
+
+            for (uint32 j = 0; j < live[v]; ++j) {
+                const uint32 t = list[j];
+                triangle_scores[t] = vertex_scores[indices[t * 3]]
+                    + vertex_scores[indices[t * 3 + 1]]
+                    + vertex_scores[indices[t * 3 + 2]];
+
+                if (triangle_scores[t] > best_score) {
+                    best_score = triangle_scores[t];
+                    best = (int32) t;
+                }
+            }
+        }
+
+        cache_count = OMS_MIN(new_count, MESH_VERTEX_CACHE_SIZE);
+        memcpy(cache, new_cache, cache_count * sizeof(uint32));
+    }
+
+    memcpy(indices, output, triangle_count * 3 * sizeof(uint32));
+}
+
+struct MeshCluster {
+    f32 sort_key;
+    uint32 start;
+    uint32 count;
+};
+
+static
+int32 mesh_cluster_compare(const void* __restrict a, const void* __restrict b) NO_EXCEPT
+{
+    const f32 ka = ((const MeshCluster *) a)->sort_key;
+    const f32 kb = ((const MeshCluster *) b)->sort_key;
+
+    // Descending
+    return (ka < kb) - (ka > kb);
+}
+
+/**
+ * Re-orders the triangle clusters to reduce overdraw
+ *
+ * Should run after mesh_optimize_vertex_cache().
+ * The triangles are split into clusters at the points where the vertex cache is cold anyway (all 3 vertices miss).
+ * Only the clusters are re-ordered which keeps most of the vertex cache efficiency.
+ * Clusters that face outwards are drawn first since they are most likely to occlude other clusters.
+ *
+ * @param vertex_size   Vertex size in f32, the position must be the first element of a vertex
+ */
+void mesh_optimize_overdraw(
+    uint32* const indices,
+    uint32 index_count,
+    const f32* const vertices,
+    uint32 vertex_count,
+    int32 vertex_size,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    const uint32 triangle_count = index_count / 3;
+    if (triangle_count < 2) {
+        return;
+    }
+
+    // Split into clusters
+    uint32* timestamps = (uint32 *) memory_get(ring, vertex_count * sizeof(uint32), sizeof(uint32));
+    memset(timestamps, 0, vertex_count * sizeof(uint32));
+
+    MeshCluster* clusters = (MeshCluster *) memory_get(ring, triangle_count * sizeof(MeshCluster), sizeof(f32));
+    uint32 cluster_count = 0;
+
+    uint32 timestamp = MESH_OVERDRAW_CACHE_SIZE + 1;
+    for (uint32 t = 0; t < triangle_count; ++t) {
+        int32 misses = 0;
+        for (int32 k = 0; k < 3; ++k) {
+            const uint32 v = indices[t * 3 + k];
+            if (timestamp - timestamps[v] > MESH_OVERDRAW_CACHE_SIZE) {
+                timestamps[v] = timestamp++;
+                ++misses;
+            }
+        }
+
+        if (t == 0 || misses == 3) {
+            clusters[cluster_count].start = t;
+            clusters[cluster_count].count = 0;
+            ++cluster_count;
+        }
+
+        ++clusters[cluster_count - 1].count;
+    }
+
+    if (cluster_count < 2) {
+        return;
+    }
+
+    // Mesh center
+    v3_f32 mesh_center = {};
+    f32 mesh_area = 0.0f;
+
+    for (uint32 t = 0; t < triangle_count; ++t) {
+        const f32* const p0 = vertices + indices[t * 3] * vertex_size;
+        const f32* const p1 = vertices + indices[t * 3 + 1] * vertex_size;
+        const f32* const p2 = vertices + indices[t * 3 + 2] * vertex_size;
+
+        const v3_f32 e1 = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        const v3_f32 e2 = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        const v3_f32 n = {e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x};
+        const f32 area = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+
+        mesh_center.x += (p0[0] + p1[0] + p2[0]) * area;
+        mesh_center.y += (p0[1] + p1[1] + p2[1]) * area;
+        mesh_center.z += (p0[2] + p1[2] + p2[2]) * area;
+        mesh_area += area;
+    }
+
+    const f32 inv_mesh_area = mesh_area > 0.0f ? 1.0f / (3.0f * mesh_area) : 0.0f;
+    mesh_center.x *= inv_mesh_area;
+    mesh_center.y *= inv_mesh_area;
+    mesh_center.z *= inv_mesh_area;
+
+    // Cluster sort key = how much does the cluster face away from the mesh center
+    for (uint32 c = 0; c < cluster_count; ++c) {
+        v3_f32 center = {};
+        v3_f32 normal = {};
+        f32 cluster_area = 0.0f;
+
+        for (uint32 t = clusters[c].start; t < clusters[c].start + clusters[c].count; ++t) {
+            const f32* const p0 = vertices + indices[t * 3] * vertex_size;
+            const f32* const p1 = vertices + indices[t * 3 + 1] * vertex_size;
+            const f32* const p2 = vertices + indices[t * 3 + 2] * vertex_size;
+
+            const v3_f32 e1 = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            const v3_f32 e2 = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+            // Not normalized -> area weighted
+            const v3_f32 n = {e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x};
+            const f32 area = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+
+            center.x += (p0[0] + p1[0] + p2[0]) * area;
+            center.y += (p0[1] + p1[1] + p2[1]) * area;
+            center.z += (p0[2] + p1[2] + p2[2]) * area;
+
+            normal.x += n.x;
+            normal.y += n.y;
+            normal.z += n.z;
+
+            cluster_area += area;
+        }
+
+        const f32 inv_area = cluster_area > 0.0f ? 1.0f / (3.0f * cluster_area) : 0.0f;
+        center.x = center.x * inv_area - mesh_center.x;
+        center.y = center.y * inv_area - mesh_center.y;
+        center.z = center.z * inv_area - mesh_center.z;
+
+        const f32 normal_length = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        const f32 inv_normal_length = normal_length > 0.0f ? 1.0f / normal_length : 0.0f;
+
+        clusters[c].sort_key = (center.x * normal.x + center.y * normal.y + center.z * normal.z) * inv_normal_length;
+    }
+
+    sort_introsort(clusters, cluster_count, sizeof(MeshCluster), mesh_cluster_compare);
+
+    uint32* output = (uint32 *) memory_get(ring, index_count * sizeof(uint32), sizeof(uint32));
+    uint32* out = output;
+
+    for (uint32 c = 0; c < cluster_count; ++c) {
+        memcpy(out, indices + clusters[c].start * 3, clusters[c].count * 3 * sizeof(uint32));
+        out += clusters[c].count * 3;
+    }
+
+    memcpy(indices, output, triangle_count * 3 * sizeof(uint32));
+}
+
+/**
+ * Re-orders the vertices in the order of their first use to improve the vertex fetch locality
+ *
+ * Unreferenced vertices are removed
+ *
+ * @return New vertex count
+ */
+uint32 mesh_optimize_vertex_fetch(
+    f32* const vertices,
+    uint32 vertex_count,
+    int32 vertex_size,
+    uint32* const indices,
+    uint32 index_count,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    const size_t stride = vertex_size * sizeof(f32);
+
+    uint32* remap = (uint32 *) memory_get(ring, vertex_count * sizeof(uint32), sizeof(uint32));
+    memset(remap, 0xFF, vertex_count * sizeof(uint32));
+
+    f32* output = (f32 *) memory_get(ring, vertex_count * stride, sizeof(f32));
+
+    uint32 new_count = 0;
+    for (uint32 i = 0; i < index_count; ++i) {
+        const uint32 v = indices[i];
+        if (remap[v] == 0xFFFFFFFF) {
+            memcpy(output + new_count * vertex_size, vertices + v * vertex_size, stride);
+            remap[v] = new_count++;
+        }
+
+        indices[i] = remap[v];
+    }
+
+    memcpy(vertices, output, new_count * stride);
+
+    return new_count;
+}
+
+/**
+ * Runs the full optimization pipeline on a mesh with flat vertices (e.g. created by mesh_from_file_txt())
+ *
+ * WARNING: mesh->data must have space for the vertices AND vertex_count indices
+ *          The indices are stored in mesh->data after the unique vertices
+ */
+void mesh_optimize(Mesh* const mesh, RingMemory* const ring) NO_EXCEPT
+{
+    const int32 vertex_size = mesh_vertex_size(mesh->vertex_type);
+    if (!mesh->vertex_count || mesh->index_count) {
+        // Already indexed
+        return;
+    }
+
+    mesh->vertices = (f32 *) mesh->data;
+
+    uint32* indices = (uint32 *) memory_get(ring, mesh->vertex_count * sizeof(uint32), sizeof(uint32));
+    const uint32 index_count = mesh->vertex_count - mesh->vertex_count % 3;
+
+    uint32 vertex_count = mesh_index_vertices(mesh->vertices, mesh->vertex_count, vertex_size, indices, ring);
+
+    mesh_optimize_vertex_cache(indices, index_count, vertex_count, ring);
+    mesh_optimize_overdraw(indices, index_count, mesh->vertices, vertex_count, vertex_size, ring);
+    vertex_count = mesh_optimize_vertex_fetch(mesh->vertices, vertex_count, vertex_size, indices, index_count, ring);
+
+    mesh->vertex_count = vertex_count;
+    mesh->index_count = index_count;
+    mesh->indices = (uint32 *) (mesh->vertices + vertex_count * vertex_size);
+    memcpy(mesh->indices, indices, index_count * sizeof(uint32));
+
+    mesh->lod_count = 1;
+    mesh->lods[0] = {0, index_count, 0.0f};
+}
+
+// Symmetric 4x4 error quadric of the plane equation (a, b, c, d)
+// The quadric is weighted by the triangle area
+struct MeshQuadric {
+    f32 a2, ab, ac, ad;
+    f32 b2, bc, bd;
+    f32 c2, cd;
+    f32 d2;
+
+    f32 weight;
+};
+
+static inline
+void mesh_quadric_add(MeshQuadric* __restrict q, const MeshQuadric* __restrict other) NO_EXCEPT
+{
+    q->a2 += other->a2; q->ab += other->ab; q->ac += other->ac; q->ad += other->ad;
+    q->b2 += other->b2; q->bc += other->bc; q->bd += other->bd;
+    q->c2 += other->c2; q->cd += other->cd;
+    q->d2 += other->d2;
+    q->weight += other->weight;
+}
+
+// Squared distance of the point to the planes of the quadric (area weighted average)
+static inline
+f32 mesh_quadric_error(const MeshQuadric* q, const f32* p) NO_EXCEPT
+{
+    const f32 x = p[0];
+    const f32 y = p[1];
+    const f32 z = p[2];
+
+    const f32 error = q->a2 * x * x + 2.0f * q->ab * x * y + 2.0f * q->ac * x * z + 2.0f * q->ad * x
+        + q->b2 * y * y + 2.0f * q->bc * y * z + 2.0f * q->bd * y
+        + q->c2 * z * z + 2.0f * q->cd * z
+        + q->d2;
+
+    return q->weight > 0.0f ? oms_max(error, 0.0f) / q->weight : 0.0f;
+}
+
+// Not normalized, the length is 2 * area
+static inline
+void mesh_triangle_normal(const f32* p0, const f32* p1, const f32* p2, f32* n) NO_EXCEPT
+{
+    const f32 e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    const f32 e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+struct MeshCollapse {
+    f32 error;
+
+    // from is moved onto to
+    uint32 from;
+    uint32 to;
+};
+
+static
+int32 mesh_collapse_compare(const void* __restrict a, const void* __restrict b) NO_EXCEPT
+{
+    const f32 ea = ((const MeshCollapse *) a)->error;
+    const f32 eb = ((const MeshCollapse *) b)->error;
+
+    return (ea > eb) - (ea < eb);
+}
+
+// Would moving vertex from onto the position of to flip (or collapse) the triangle or create a sliver
+static inline
+bool mesh_collapse_flips(
+    const f32* const vertices, int32 vertex_size,
+    const uint32* tri, uint32 from, uint32 to
+) NO_EXCEPT
+{
+    f32 before[3][3];
+    f32 after[3][3];
+
+    for (int32 k = 0; k < 3; ++k) {
+        const f32* p = vertices + tri[k] * vertex_size;
+        const f32* q = tri[k] == from ? vertices + to * vertex_size : p;
+
+        memcpy(before[k], p, sizeof(before[k]));
+        memcpy(after[k], q, sizeof(after[k]));
+    }
+
+    f32 n0[3];
+    f32 n1[3];
+    mesh_triangle_normal(before[0], before[1], before[2], n0);
+    mesh_triangle_normal(after[0], after[1], after[2], n1);
+
+    const f32 length0 = sqrtf(n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]);
+    const f32 length1 = sqrtf(n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]);
+    const f32 dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+
+    // The normal must not rotate more than ~75 degrees
+    if (length1 <= 1e-6f || dot <= 0.25f * length0 * length1) {
+        return true;
+    }
+
+    // The new triangle must not become a sliver (unless it already was one)
+    // quality = 2 * sqrt(3) * |n| / sum(edge^2), 1.0 = equilateral
+    f32 edges0 = 0.0f;
+    f32 edges1 = 0.0f;
+    for (int32 k = 0; k < 3; ++k) {
+        for (int32 j = 0; j < 3; ++j) {
+            const f32 d0 = before[k][j] - before[(k + 1) % 3][j];
+            const f32 d1 = after[k][j] - after[(k + 1) % 3][j];
+
+            edges0 += d0 * d0;
+            edges1 += d1 * d1;
+        }
+    }
+
+    const f32 quality0 = 3.4641016f * length0 / edges0;
+    const f32 quality1 = 3.4641016f * length1 / edges1;
+
+    return quality1 < 0.05f && quality1 < quality0;
+}
+
+/**
+ * Simplifies the mesh with quadric error edge collapses
+ *
+ * Vertices are only moved onto other existing vertices (no new vertices are created).
+ * Border vertices and vertices on attribute seams (same position, different attributes) are locked,
+ * this way the simplified mesh has no cracks and no texture distortions along the seams.
+ *
+ * @param destination   Output indices (index_count elements)
+ * @param indices       Input indices
+ * @param index_count   Index count
+ * @param vertices      Interleaved vertices, the position must be the first element of a vertex
+ * @param vertex_count  Vertex count
+ * @param vertex_size   Vertex size in f32
+ * @param target_count  Desired index count
+ * @param max_error     Max. allowed geometric deviation in object space
+ * @param result_error  Output of the max. geometric deviation of the result
+ * @param ring          Temp memory
+ *
+ * @return Index count of the simplified mesh (>= target_count if max_error was reached first)
+ */
+uint32 mesh_simplify(
+    uint32* const destination,
+    const uint32* const indices,
+    uint32 index_count,
+    const f32* const vertices,
+    uint32 vertex_count,
+    int32 vertex_size,
+    uint32 target_count,
+    f32 max_error,
+    f32* result_error,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    memcpy(destination, indices, index_count * sizeof(uint32));
+    *result_error = 0.0f;
+
+    // Position remap: all vertices with the same position point to the same (first) vertex
+    uint32* position_id = (uint32 *) memory_get(ring, vertex_count * sizeof(uint32), sizeof(uint32));
+    byte* wedge_count = (byte *) memory_get(ring, vertex_count, 4);
+    memset(wedge_count, 0, vertex_count);
+
+    {
+        uint32 table_size = 64;
+        while (table_size < vertex_count * 2) {
+            table_size <<= 1;
+        }
+
+        int32* table = (int32 *) memory_get(ring, table_size * sizeof(int32), sizeof(int32));
+        memset(table, -1, table_size * sizeof(int32));
+
+        const size_t position_size = 3 * sizeof(f32);
+        for (uint32 i = 0; i < vertex_count; ++i) {
+            const f32* const p = vertices + i * vertex_size;
+
+            uint32 slot = (uint32) hash_murmur3_64(p, position_size) & (table_size - 1);
+            while (table[slot] >= 0 && memcmp(vertices + table[slot] * vertex_size, p, position_size) != 0) {
+                slot = (slot + 1) & (table_size - 1);
+            }
+
+            if (table[slot] < 0) {
+                table[slot] = (int32) i;
+            }
+
+            position_id[i] = (uint32) table[slot];
+            wedge_count[position_id[i]] = (byte) OMS_MIN(wedge_count[position_id[i]] + 1, 255);
+        }
+    }
+
+    // Locked vertices are never moved
+    // A vertex is on the border if one of its edges has no opposite edge (compared by position)
+    byte* locked = (byte *) memory_get(ring, vertex_count, 4);
+    memset(locked, 0, vertex_count);
+
+    {
+        uint32 table_size = 64;
+        while (table_size < index_count * 2) {
+            table_size <<= 1;
+        }
+
+        // Directed edges by position id
+        uint64* edges = (uint64 *) memory_get(ring, table_size * sizeof(uint64), sizeof(uint64));
+        memset(edges, 0xFF, table_size * sizeof(uint64));
+
+        for (uint32 i = 0; i < index_count; ++i) {
+            const uint32 a = position_id[indices[i]];
+            const uint32 b = position_id[indices[i - i % 3 + (i + 1) % 3]];
+            const uint64 key = ((uint64) a << 32) | b;
+
+            uint32 slot = (uint32) hash_murmur3_64(&key, sizeof(key)) & (table_size - 1);
+            while (edges[slot] != 0xFFFFFFFFFFFFFFFF && edges[slot] != key) {
+                slot = (slot + 1) & (table_size - 1);
+            }
+
+            edges[slot] = key;
+        }
+
+        for (uint32 i = 0; i < index_count; ++i) {
+            const uint32 a = position_id[indices[i]];
+            const uint32 b = position_id[indices[i - i % 3 + (i + 1) % 3]];
+            const uint64 key = ((uint64) b << 32) | a;
+
+            uint32 slot = (uint32) hash_murmur3_64(&key, sizeof(key)) & (table_size - 1);
+            while (edges[slot] != 0xFFFFFFFFFFFFFFFF && edges[slot] != key) {
+                slot = (slot + 1) & (table_size - 1);
+            }
+
+            if (edges[slot] != key) {
+                locked[a] = 1;
+                locked[b] = 1;
+            }
+        }
+
+        for (uint32 i = 0; i < vertex_count; ++i) {
+            // The lock is stored on the position id
+            locked[i] = locked[position_id[i]] || wedge_count[position_id[i]] > 1;
+        }
+    }
+
+    // Quadrics are accumulated per position
+    MeshQuadric* quadrics = (MeshQuadric *) memory_get(ring, vertex_count * sizeof(MeshQuadric), sizeof(f32));
+    memset(quadrics, 0, vertex_count * sizeof(MeshQuadric));
+
+    for (uint32 i = 0; i < index_count; i += 3) {
+        const f32* p0 = vertices + indices[i] * vertex_size;
+        const f32* p1 = vertices + indices[i + 1] * vertex_size;
+        const f32* p2 = vertices + indices[i + 2] * vertex_size;
+
+        f32 n[3];
+        mesh_triangle_normal(p0, p1, p2, n);
+
+        const f32 length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length <= 0.0f) {
+            continue;
+        }
+
+        // |cross| = 2 * area
+        const f32 area = length * 0.5f;
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+
+        const f32 d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+
+        const MeshQuadric q = {
+            n[0] * n[0] * area, n[0] * n[1] * area, n[0] * n[2] * area, n[0] * d * area,
+            n[1] * n[1] * area, n[1] * n[2] * area, n[1] * d * area,
+            n[2] * n[2] * area, n[2] * d * area,
+            d * d * area,
+            area
+        };
+
+        for (int32 k = 0; k < 3; ++k) {
+            mesh_quadric_add(&quadrics[position_id[indices[i + k]]], &q);
+        }
+    }
+
+    // Vertex -> triangle adjacency (CSR), rebuilt after every pass
+    uint32* adjacency_offsets = (uint32 *) memory_get(ring, (vertex_count + 1) * sizeof(uint32), sizeof(uint32));
+    uint32* adjacency = (uint32 *) memory_get(ring, index_count * sizeof(uint32), sizeof(uint32));
+
+    MeshCollapse* collapses = (MeshCollapse *) memory_get(ring, index_count * sizeof(MeshCollapse), sizeof(f32));
+
+    // Vertices already used by a collapse in the current pass
+    byte* touched = (byte *) memory_get(ring, vertex_count, 4);
+
+    const f32 max_error_sq = max_error * max_error;
+    f32 result_error_sq = 0.0f;
+    uint32 count = index_count;
+
+    while (count > target_count) {
+        // Index count at the start of this pass, the collapses only reduce count but don't move any triangle
+        const uint32 previous_count = count;
+
+        // Build adjacency
+        memset(adjacency_offsets, 0, (vertex_count + 1) * sizeof(uint32));
+        for (uint32 i = 0; i < count; ++i) {
+            ++adjacency_offsets[destination[i]];
+        }
+
+        uint32 sum = 0;
+        for (uint32 i = 0; i < vertex_count; ++i) {
+            const uint32 triangles = adjacency_offsets[i];
+            adjacency_offsets[i] = sum;
+            sum += triangles;
+        }
+
+        for (uint32 i = 0; i < count; ++i) {
+            adjacency[adjacency_offsets[destination[i]]++] = i / 3;
+        }
+
+        // The offsets got moved to the end of every list = start of the next list
+        for (uint32 i = vertex_count; i > 0; --i) {
+            adjacency_offsets[i] = adjacency_offsets[i - 1];
+        }
+
+        adjacency_offsets[0] = 0;
+
+        // Collect the collapse candidates, every edge in the cheaper (allowed) direction
+        uint32 collapse_count = 0;
+        for (uint32 i = 0; i < count; ++i) {
+            const uint32 a = destination[i];
+            const uint32 b = destination[i - i % 3 + (i + 1) % 3];
+
+            // Every interior edge exists twice, only use one
+            if (position_id[a] > position_id[b] && !locked[a] && !locked[b]) {
+                continue;
+            }
+
+            if (locked[a] && locked[b]) {
+                continue;
+            }
+
+            MeshQuadric q = quadrics[position_id[a]];
+            mesh_quadric_add(&q, &quadrics[position_id[b]]);
+
+            const f32 error_ab = locked[a] ? 0.0f : mesh_quadric_error(&q, vertices + b * vertex_size);
+            const f32 error_ba = locked[b] ? 0.0f : mesh_quadric_error(&q, vertices + a * vertex_size);
+
+            collapses[collapse_count++] = !locked[a] && (locked[b] || error_ab <= error_ba)
+                ? MeshCollapse{error_ab, a, b}
+                : MeshCollapse{error_ba, b, a};
+        }
+
+        if (!collapse_count) {
+            break;
+        }
+
+        sort_introsort(collapses, collapse_count, sizeof(MeshCollapse), mesh_collapse_compare);
+
+        memset(touched, 0, vertex_count);
+
+        // Don't remove too many triangles in one pass, the errors are based on the state before the pass
+        const uint32 pass_target = target_count + (count - target_count) / 2;
+        uint32 pass_collapses = 0;
+
+        for (uint32 c = 0; c < collapse_count && count > pass_target; ++c) {
+            const MeshCollapse* collapse = &collapses[c];
+            if (collapse->error > max_error_sq) {
+                break;
+            }
+
+            const uint32 from = collapse->from;
+            const uint32 to = collapse->to;
+            if (touched[from] || touched[to]) {
+                continue;
+            }
+
+            // Reject collapses that flip triangles
+            bool is_valid = true;
+            for (uint32 t = adjacency_offsets[from]; t < adjacency_offsets[from + 1] && is_valid; ++t) {
+                const uint32* tri = destination + adjacency[t] * 3;
+                if (tri[0] == to || tri[1] == to || tri[2] == to
+                    || tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]
+                ) {
+                    continue;
+                }
+
+                is_valid = !mesh_collapse_flips(vertices, vertex_size, tri, from, to);
+            }
+
+            if (!is_valid) {
+                continue;
+            }
+
+            for (uint32 t = adjacency_offsets[from]; t < adjacency_offsets[from + 1]; ++t) {
+                uint32* tri = destination + adjacency[t] * 3;
+                if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+                    // Already removed by a previous collapse in this pass
+                    continue;
+                }
+
+                for (int32 k = 0; k < 3; ++k) {
+                    if (tri[k] == from) {
+                        tri[k] = to;
+                    }
+                }
+
+                if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+                    count -= 3;
+                }
+            }
+
+            mesh_quadric_add(&quadrics[position_id[to]], &quadrics[position_id[from]]);
+            result_error_sq = oms_max(result_error_sq, collapse->error);
+
+            touched[from] = 1;
+            touched[to] = 1;
+            ++pass_collapses;
+        }
+
+        if (!pass_collapses) {
+            break;
+        }
+
+        // Remove the degenerated triangles
+        uint32 write = 0;
+        for (uint32 i = 0; i < previous_count; i += 3) {
+            const uint32* tri = destination + i;
+            if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+                continue;
+            }
+
+            destination[write] = tri[0];
+            destination[write + 1] = tri[1];
+            destination[write + 2] = tri[2];
+            write += 3;
+        }
+
+        count = write;
+    }
+
+    *result_error = sqrtf(result_error_sq);
+
+    return count;
+}
+
+/**
+ * Generates the LOD chain of an optimized mesh (see mesh_optimize())
+ *
+ * Every LOD has reduction * triangles of the previous LOD.
+ * The LOD index ranges are appended to mesh->indices and optimized for the vertex cache.
+ * The chain stops early if the mesh can't be simplified any further.
+ *
+ * WARNING: mesh->data must have space for index_count / (1 - reduction) indices (e.g. 2x for reduction = 0.5)
+ *
+ * @param mesh      Mesh with a single LOD
+ * @param lod_count Desired LOD count (including LOD 0)
+ * @param reduction Triangle ratio between consecutive LODs
+ * @param max_error Max. geometric deviation of the coarsest LOD (object space)
+ * @param ring      Temp memory
+ */
+void mesh_lod_generate(
+    Mesh* const mesh,
+    int32 lod_count,
+    f32 reduction,
+    f32 max_error,
+    RingMemory* const ring
+) NO_EXCEPT
+{
+    ASSERT_TRUE(mesh->lod_count == 1);
+
+    lod_count = OMS_MIN(lod_count, MESH_LOD_MAX);
+    const int32 vertex_size = mesh_vertex_size(mesh->vertex_type);
+
+    uint32* lod_indices = (uint32 *) memory_get(ring, mesh->lods[0].index_count * sizeof(uint32), sizeof(uint32));
+
+    for (int32 i = 1; i < lod_count; ++i) {
+        const MeshLod* previous = &mesh->lods[i - 1];
+        const uint32 target_count = (uint32) ((f32) (previous->index_count / 3) * reduction) * 3;
+
+        f32 error;
+        const uint32 count = mesh_simplify(
+            lod_indices,
+            mesh->indices + previous->index_offset, previous->index_count,
+            mesh->vertices, mesh->vertex_count, vertex_size,
+            target_count, max_error - previous->error, &error,
+            ring
+        );
+
+        // Not worth an additional LOD (or the error budget is used up)
+        if (count == 0 || count >= previous->index_count - previous->index_count / 8) {
+            break;
+        }
+
+        mesh_optimize_vertex_cache(lod_indices, count, mesh->vertex_count, ring);
+
+        MeshLod* lod = &mesh->lods[mesh->lod_count++];
+        lod->index_offset = previous->index_offset + previous->index_count;
+        lod->index_count = count;
+
+        // The error of a LOD is relative to the previous LOD -> accumulate to get the error to LOD 0
+        lod->error = previous->error + error;
+
+        memcpy(mesh->indices + lod->index_offset, lod_indices, count * sizeof(uint32));
+        mesh->index_count = lod->index_offset + count;
+    }
+}
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "../../../stdlib/Stdlib.h"
 #include "../../../network/SocketConnection.h"
+#include "Socket.h"
 
 inline
 bool socket_non_blocking(SocketConnection* con)
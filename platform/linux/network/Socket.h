@@ -11,6 +11,7 @@
 #define COMS_PLATFORM_LINUX_NETWORK_SOCKET_H
 
 #include "../../../stdlib/Stdlib.h"
+#include "../../../utils/StringUtils.h"
 
 #include <netdb.h>
 #include <sys/types.h>
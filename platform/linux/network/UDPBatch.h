@@ -0,0 +1,415 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_PLATFORM_LINUX_NETWORK_UDP_BATCH_H
+#define COMS_PLATFORM_LINUX_NETWORK_UDP_BATCH_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "../../../stdlib/Stdlib.h"
+#include "../../../system/Allocator.h"
+#include "../../../log/Log.h"
+#include "../../../log/Stats.h"
+#include "../../../network/SocketConnection.h"
+
+// Older headers don't define the segmentation offload options
+#ifndef SOL_UDP
+    #define SOL_UDP 17
+#endif
+
+#ifndef UDP_SEGMENT
+    #define UDP_SEGMENT 103
+#endif
+
+#ifndef UDP_GRO
+    #define UDP_GRO 104
+#endif
+
+// Kernel limit of segments per GSO send
+#define UDP_BATCH_MAX_SEGMENTS 64
+
+enum UDPBatchFlag : int32 {
+    // Consecutive datagrams to the same destination are sent as one GSO message
+    UDP_BATCH_FLAG_GSO = 1 << 0,
+
+    // The kernel may coalesce received datagrams of the same flow into one buffer
+    // WARNING: packet_size must be large enough for the coalesced data (up to 64 KB)
+    UDP_BATCH_FLAG_GRO = 1 << 1,
+};
+
+/**
+ * Ring of datagram slots used for batched receiving or sending
+ *
+ * Every slot has its own packet buffer, iovec, address and control buffer.
+ * The slot arrays are index aligned -> slot i uses msgs[i], iovs[i], addrs[i] etc.
+ *
+ * Receiving: Every udp_batch_receive() call fills the next batch_size slots of the ring,
+ *      the received data stays valid until the ring wraps around.
+ * Sending: Slots are filled with udp_batch_send_get()/udp_batch_send_commit() and sent with udp_batch_send_flush()
+ */
+struct UDPBatch {
+    mmsghdr* msgs;
+    iovec* iovs;
+    sockaddr_in6* addrs;
+    byte* control;
+    byte* packets;
+
+    // Total amount of slots in the ring
+    int32 slot_count;
+
+    // Max datagrams per syscall
+    int32 batch_size;
+
+    // Size of a single packet buffer
+    int32 packet_size;
+
+    // First slot of the current batch
+    int32 pos;
+
+    // Datagrams in the current batch
+    int32 length;
+
+    int32 flags;
+};
+
+// Control buffer size per slot, large enough for the UDP_SEGMENT and UDP_GRO cmsg
+#define UDP_BATCH_CONTROL_SIZE CMSG_SPACE(sizeof(int32))
+
+/**
+ * Allocates the batch ring
+ *
+ * @param batch         Batch
+ * @param batch_size    Max datagrams per syscall
+ * @param batch_count   Amount of batches in the ring
+ * @param packet_size   Max size of a datagram (MTU or larger if GRO is used)
+ * @param flags         UDPBatchFlag
+ */
+void udp_batch_alloc(
+    UDPBatch* const batch,
+    int32 batch_size,
+    int32 batch_count,
+    int32 packet_size,
+    int32 flags = 0
+) NO_EXCEPT
+{
+    ASSERT_TRUE(batch_size > 0 && batch_count > 0);
+    ASSERT_TRUE(batch_size <= IOV_MAX);
+
+    const int32 slot_count = batch_size * batch_count;
+    packet_size = align_up(packet_size, 64);
+
+    const uint64 size = slot_count * (
+            sizeof(mmsghdr)
+            + sizeof(iovec)
+            + sizeof(sockaddr_in6)
+            + UDP_BATCH_CONTROL_SIZE
+            + packet_size
+        )
+        + 64 * 5; // overhead for alignment
+
+    batch->packets = (byte *) platform_alloc_aligned(size, size, ASSUMED_CACHE_LINE_SIZE);
+    batch->msgs = (mmsghdr *) align_up((uintptr_t) (batch->packets + slot_count * packet_size), 64);
+    batch->iovs = (iovec *) align_up((uintptr_t) (batch->msgs + slot_count), 64);
+    batch->addrs = (sockaddr_in6 *) align_up((uintptr_t) (batch->iovs + slot_count), 64);
+    batch->control = (byte *) align_up((uintptr_t) (batch->addrs + slot_count), 64);
+
+    batch->slot_count = slot_count;
+    batch->batch_size = batch_size;
+    batch->packet_size = packet_size;
+    batch->pos = 0;
+    batch->length = 0;
+    batch->flags = flags;
+
+    memset(batch->msgs, 0, slot_count * sizeof(mmsghdr));
+
+    // The iovecs never change their buffer, only their length
+    for (int32 i = 0; i < slot_count; ++i) {
+        batch->iovs[i].iov_base = batch->packets + i * packet_size;
+        batch->iovs[i].iov_len = packet_size;
+    }
+
+    LOG_1("[INFO] Allocated UDPBatch: %n B", {DATA_TYPE_UINT64, (void *) &size});
+}
+
+inline
+void udp_batch_free(UDPBatch* const batch) NO_EXCEPT
+{
+    platform_aligned_free((void **) &batch->packets);
+    batch->msgs = NULL;
+    batch->iovs = NULL;
+    batch->addrs = NULL;
+    batch->control = NULL;
+    batch->slot_count = 0;
+}
+
+// Enables receive offload on the socket, returns false if the kernel doesn't support it (< 5.0)
+inline
+bool socket_udp_gro(SocketConnection* con) NO_EXCEPT
+{
+    int32 opt = 1;
+
+    return setsockopt(con->sd, SOL_UDP, UDP_GRO, &opt, sizeof(opt)) == 0;
+}
+
+// Checks if the kernel supports send offload (>= 4.18)
+inline
+bool socket_udp_gso_supported(SocketConnection* con) NO_EXCEPT
+{
+    int32 opt = 0;
+
+    return setsockopt(con->sd, SOL_UDP, UDP_SEGMENT, &opt, sizeof(opt)) == 0;
+}
+
+FORCE_INLINE
+byte* udp_batch_packet(const UDPBatch* batch, int32 index) NO_EXCEPT
+{
+    return batch->packets + ((batch->pos + index) % batch->slot_count) * batch->packet_size;
+}
+
+// Length of a received datagram
+FORCE_INLINE
+int32 udp_batch_packet_length(const UDPBatch* batch, int32 index) NO_EXCEPT
+{
+    return (int32) batch->msgs[(batch->pos + index) % batch->slot_count].msg_len;
+}
+
+FORCE_INLINE
+const sockaddr_in6* udp_batch_packet_addr(const UDPBatch* batch, int32 index) NO_EXCEPT
+{
+    return &batch->addrs[(batch->pos + index) % batch->slot_count];
+}
+
+/**
+ * Returns the segment size of a received datagram
+ *
+ * If GRO coalesced multiple datagrams into one buffer, the datagrams are split at this size (the last one may be shorter).
+ * Without GRO the segment size is the packet length.
+ */
+int32 udp_batch_packet_segment_size(const UDPBatch* batch, int32 index) NO_EXCEPT
+{
+    const mmsghdr* msg = &batch->msgs[(batch->pos + index) % batch->slot_count];
+
+    if (batch->flags & UDP_BATCH_FLAG_GRO) {
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg->msg_hdr); cmsg; cmsg = CMSG_NXTHDR((msghdr *) &msg->msg_hdr, cmsg)) {
+            if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                return *((int32 *) CMSG_DATA(cmsg));
+            }
+        }
+    }
+
+    return (int32) msg->msg_len;
+}
+
+/**
+ * Receives up to batch_size datagrams with a single syscall
+ *
+ * The previous batch stays valid until the ring wraps around
+ * (e.g. with 4 batches in the ring the data of the last 3 calls can still be accessed)
+ *
+ * @return Amount of received datagrams, 0 if there is no data, -1 on error
+ */
+int32 udp_batch_receive(SocketConnection* con, UDPBatch* batch) NO_EXCEPT
+{
+    // Advance to the next window of the ring
+    batch->pos = (batch->pos + batch->batch_size) % batch->slot_count;
+    batch->length = 0;
+
+    mmsghdr* msgs = batch->msgs + batch->pos;
+    const int32 end = batch->pos + batch->batch_size;
+
+    for (int32 i = batch->pos; i < end; ++i) {
+        msghdr* hdr = &batch->msgs[i].msg_hdr;
+        hdr->msg_name = &batch->addrs[i];
+        hdr->msg_namelen = sizeof(sockaddr_in6);
+        hdr->msg_iov = &batch->iovs[i];
+        hdr->msg_iovlen = 1;
+        batch->iovs[i].iov_len = batch->packet_size;
+
+        if (batch->flags & UDP_BATCH_FLAG_GRO) {
+            hdr->msg_control = batch->control + i * UDP_BATCH_CONTROL_SIZE;
+            hdr->msg_controllen = UDP_BATCH_CONTROL_SIZE;
+        } else {
+            hdr->msg_control = NULL;
+            hdr->msg_controllen = 0;
+        }
+    }
+
+    const int32 received = recvmmsg(con->sd, msgs, batch->batch_size, MSG_DONTWAIT, NULL);
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+
+        LOG_1("[ERROR] recvmmsg failed");
+
+        return -1;
+    }
+
+    batch->length = received;
+    STATS_INCREMENT_BY_DEBUG(DEBUG_COUNTER_NETWORK_IN_COUNT, received);
+
+    return received;
+}
+
+/**
+ * Returns the packet buffer of the next free send slot
+ *
+ * The datagram is only queued after calling udp_batch_send_commit()
+ *
+ * @return Packet buffer (packet_size bytes) or NULL if the batch is full and needs to be flushed
+ */
+inline
+byte* udp_batch_send_get(UDPBatch* batch, const sockaddr_in6* dest) NO_EXCEPT
+{
+    if (batch->length >= batch->slot_count) {
+        return NULL;
+    }
+
+    const int32 slot = batch->length;
+    memcpy(&batch->addrs[slot], dest, sizeof(sockaddr_in6));
+
+    return batch->packets + slot * batch->packet_size;
+}
+
+FORCE_INLINE
+void udp_batch_send_commit(UDPBatch* batch, int32 length) NO_EXCEPT
+{
+    ASSERT_TRUE(length <= batch->packet_size);
+
+    batch->iovs[batch->length].iov_len = length;
+    ++batch->length;
+}
+
+// Convenience function if the data is not created directly in the send buffer
+inline
+bool udp_batch_send_add(UDPBatch* batch, const sockaddr_in6* dest, const byte* data, int32 length) NO_EXCEPT
+{
+    byte* packet = udp_batch_send_get(batch, dest);
+    if (!packet) {
+        return false;
+    }
+
+    memcpy(packet, data, length);
+    udp_batch_send_commit(batch, length);
+
+    return true;
+}
+
+FORCE_INLINE
+bool udp_batch_same_destination(const sockaddr_in6* a, const sockaddr_in6* b) NO_EXCEPT
+{
+    return a->sin6_port == b->sin6_port
+        && memcmp(&a->sin6_addr, &b->sin6_addr, sizeof(a->sin6_addr)) == 0;
+}
+
+// Builds the message headers for all queued datagrams
+// With GSO consecutive datagrams to the same destination with the same size are merged into one message
+// (only the last datagram of such a run may be shorter)
+static
+int32 udp_batch_send_prepare(UDPBatch* batch) NO_EXCEPT
+{
+    const bool use_gso = batch->flags & UDP_BATCH_FLAG_GSO;
+
+    int32 msg_count = 0;
+    int32 i = 0;
+    while (i < batch->length) {
+        int32 run = 1;
+        const size_t segment_size = batch->iovs[i].iov_len;
+
+        if (use_gso) {
+            while (i + run < batch->length
+                && run < UDP_BATCH_MAX_SEGMENTS
+                && batch->iovs[i + run - 1].iov_len == segment_size
+                && udp_batch_same_destination(&batch->addrs[i], &batch->addrs[i + run])
+                && batch->iovs[i + run].iov_len <= segment_size
+            ) {
+                ++run;
+            }
+        }
+
+        // msg_count <= i -> we only overwrite message headers we don't need anymore
+        msghdr* hdr = &batch->msgs[msg_count].msg_hdr;
+        hdr->msg_name = &batch->addrs[i];
+        hdr->msg_namelen = sizeof(sockaddr_in6);
+        hdr->msg_iov = &batch->iovs[i];
+        hdr->msg_iovlen = run;
+        hdr->msg_flags = 0;
+
+        if (run > 1) {
+            hdr->msg_control = batch->control + msg_count * UDP_BATCH_CONTROL_SIZE;
+            hdr->msg_controllen = CMSG_SPACE(sizeof(uint16));
+
+            cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16));
+            *((uint16 *) CMSG_DATA(cmsg)) = (uint16) segment_size;
+        } else {
+            hdr->msg_control = NULL;
+            hdr->msg_controllen = 0;
+        }
+
+        ++msg_count;
+        i += run;
+    }
+
+    return msg_count;
+}
+
+/**
+ * Sends all queued datagrams with as few syscalls as possible
+ *
+ * Datagrams that can't be sent because the socket buffer is full are dropped (same as with any other udp send).
+ *
+ * @return Amount of sent datagrams or -1 on error
+ */
+int32 udp_batch_send_flush(SocketConnection* con, UDPBatch* batch) NO_EXCEPT
+{
+    if (!batch->length) {
+        return 0;
+    }
+
+    const int32 msg_count = udp_batch_send_prepare(batch);
+
+    int32 sent_msgs = 0;
+    int32 sent = 0;
+    while (sent_msgs < msg_count) {
+        const int32 count = OMS_MIN(msg_count - sent_msgs, batch->batch_size);
+        const int32 rc = sendmmsg(con->sd, batch->msgs + sent_msgs, count, MSG_DONTWAIT);
+
+        if (rc <= 0) {
+            if (rc < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_1("[ERROR] sendmmsg failed");
+                batch->length = 0;
+
+                return -1;
+            }
+
+            break;
+        }
+
+        for (int32 i = sent_msgs; i < sent_msgs + rc; ++i) {
+            sent += (int32) batch->msgs[i].msg_hdr.msg_iovlen;
+        }
+
+        sent_msgs += rc;
+    }
+
+    STATS_INCREMENT_BY_DEBUG(DEBUG_COUNTER_NETWORK_OUT_COUNT, sent);
+    batch->length = 0;
+
+    return sent;
+}
+
+#endif
@@ -14,6 +14,7 @@
 #include <unistd.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <errno.h>
 #include <linux/futex.h>
 #include <sys/syscall.h>
 #include <sched.h>
@@ -98,18 +99,21 @@ int32 coms_pthread_cond_destroy(mutex_cond* cond) NO_EXCEPT
     return cond == NULL ? 1 : 0;
 }
 
+// The timeout is relative (same as on Windows), NULL = infinite
+// Returns 1 if the timeout elapsed
 inline
-int32 mutex_condimedwait(mutex_cond* __restrict cond, mutex* __restrict mutex, const struct timespec*) NO_EXCEPT
+int32 mutex_condimedwait(mutex_cond* __restrict cond, mutex* __restrict mutex, const struct timespec* timeout) NO_EXCEPT
 {
     ASSERT_TRUE(cond);
     ASSERT_TRUE(mutex);
 
     int32 oldval = atomic_get_acquire(&cond->futex);
     mutex_unlock(mutex);
-    futex_wait(&cond->futex, oldval);
+    const long rc = futex_wait_timeout(&cond->futex, oldval, timeout);
+    const bool timed_out = rc == -1 && errno == ETIMEDOUT;
     mutex_lock(mutex);
 
-    return 0;
+    return timed_out ? 1 : 0;
 }
 
 FORCE_INLINE
@@ -48,6 +48,9 @@ struct coms_pthread_t {
 #define futex_wait(futex, val) syscall(SYS_futex, futex, FUTEX_WAIT, val, NULL, NULL, 0)
 #define futex_wake(futex, n) syscall(SYS_futex, futex, FUTEX_WAKE, n, NULL, NULL, 0)
 
+// The timeout is relative (FUTEX_WAIT), NULL = infinite
+#define futex_wait_timeout(futex, val, timeout) syscall(SYS_futex, futex, FUTEX_WAIT, val, timeout, NULL, 0)
+
 #define mutex_init(a, b) ((void) 0)
 #define mutex_destroy(a, b) ((void) 0)
 
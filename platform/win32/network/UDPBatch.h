@@ -0,0 +1,217 @@
+/**
+ * Jingga
+ *
+ * @copyright Jingga
+ * @license   OMS License 2.0
+ * @version   1.0.0
+ * @link      https://jingga.app
+ */
+#pragma once
+#ifndef COMS_PLATFORM_WIN32_NETWORK_UDP_BATCH_H
+#define COMS_PLATFORM_WIN32_NETWORK_UDP_BATCH_H
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "../../../stdlib/Stdlib.h"
+#include "../../../system/Allocator.h"
+#include "../../../log/Log.h"
+#include "../../../log/Stats.h"
+#include "../../../network/SocketConnection.h"
+
+// Windows has no recvmmsg/sendmmsg
+// This implementation provides the same interface but still needs one syscall per datagram
+// @performance Consider to use Registered I/O (RIO) which allows real batching
+// @todo Implement USO/URO (UDP_SEND_MSG_SIZE, UDP_RECV_MAX_COALESCED_SIZE)
+
+enum UDPBatchFlag : int32 {
+    UDP_BATCH_FLAG_GSO = 1 << 0,
+    UDP_BATCH_FLAG_GRO = 1 << 1,
+};
+
+struct UDPBatch {
+    int32* lengths;
+    sockaddr_in6* addrs;
+    byte* packets;
+
+    int32 slot_count;
+    int32 batch_size;
+    int32 packet_size;
+    int32 pos;
+    int32 length;
+    int32 flags;
+};
+
+void udp_batch_alloc(
+    UDPBatch* const batch,
+    int32 batch_size,
+    int32 batch_count,
+    int32 packet_size,
+    int32 flags = 0
+) NO_EXCEPT
+{
+    ASSERT_TRUE(batch_size > 0 && batch_count > 0);
+
+    const int32 slot_count = batch_size * batch_count;
+    packet_size = align_up(packet_size, 64);
+
+    const uint64 size = slot_count * (sizeof(int32) + sizeof(sockaddr_in6) + packet_size)
+        + 64 * 3; // overhead for alignment
+
+    batch->packets = (byte *) platform_alloc_aligned(size, size, ASSUMED_CACHE_LINE_SIZE);
+    batch->addrs = (sockaddr_in6 *) align_up((uintptr_t) (batch->packets + slot_count * packet_size), 64);
+    batch->lengths = (int32 *) align_up((uintptr_t) (batch->addrs + slot_count), 64);
+
+    batch->slot_count = slot_count;
+    batch->batch_size = batch_size;
+    batch->packet_size = packet_size;
+    batch->pos = 0;
+    batch->length = 0;
+    batch->flags = flags;
+}
+
+inline
+void udp_batch_free(UDPBatch* const batch) NO_EXCEPT
+{
+    platform_aligned_free((void **) &batch->packets);
+    batch->addrs = NULL;
+    batch->lengths = NULL;
+    batch->slot_count = 0;
+}
+
+inline
+bool socket_udp_gro(SocketConnection*) NO_EXCEPT
+{
+    return false;
+}
+
+inline
+bool socket_udp_gso_supported(SocketConnection*) NO_EXCEPT
+{
+    return false;
+}
+
+FORCE_INLINE
+byte* udp_batch_packet(const UDPBatch* batch, int32 index) NO_EXCEPT
+{
+    return batch->packets + ((batch->pos + index) % batch->slot_count) * batch->packet_size;
+}
+
+FORCE_INLINE
+int32 udp_batch_packet_length(const UDPBatch* batch, int32 index) NO_EXCEPT
+{
+    return batch->lengths[(batch->pos + index) % batch->slot_count];
+}
+
+FORCE_INLINE
+const sockaddr_in6* udp_batch_packet_addr(const UDPBatch* batch, int32 index) NO_EXCEPT
+{
+    return &batch->addrs[(batch->pos + index) % batch->slot_count];
+}
+
+FORCE_INLINE
+int32 udp_batch_packet_segment_size(const UDPBatch* batch, int32 index) NO_EXCEPT
+{
+    return udp_batch_packet_length(batch, index);
+}
+
+int32 udp_batch_receive(SocketConnection* con, UDPBatch* batch) NO_EXCEPT
+{
+    batch->pos = (batch->pos + batch->batch_size) % batch->slot_count;
+    batch->length = 0;
+
+    for (int32 i = batch->pos; i < batch->pos + batch->batch_size; ++i) {
+        int32 addr_length = sizeof(sockaddr_in6);
+        const int32 rc = recvfrom(
+            con->sd,
+            (char *) (batch->packets + i * batch->packet_size), batch->packet_size,
+            0,
+            (sockaddr *) &batch->addrs[i], &addr_length
+        );
+
+        if (rc == SOCKET_ERROR) {
+            if (WSAGetLastError() == WSAEWOULDBLOCK) {
+                break;
+            }
+
+            LOG_1("[ERROR] recvfrom failed");
+
+            return -1;
+        }
+
+        batch->lengths[i] = rc;
+        ++batch->length;
+    }
+
+    STATS_INCREMENT_BY_DEBUG(DEBUG_COUNTER_NETWORK_IN_COUNT, batch->length);
+
+    return batch->length;
+}
+
+inline
+byte* udp_batch_send_get(UDPBatch* batch, const sockaddr_in6* dest) NO_EXCEPT
+{
+    if (batch->length >= batch->slot_count) {
+        return NULL;
+    }
+
+    memcpy(&batch->addrs[batch->length], dest, sizeof(sockaddr_in6));
+
+    return batch->packets + batch->length * batch->packet_size;
+}
+
+FORCE_INLINE
+void udp_batch_send_commit(UDPBatch* batch, int32 length) NO_EXCEPT
+{
+    ASSERT_TRUE(length <= batch->packet_size);
+
+    batch->lengths[batch->length] = length;
+    ++batch->length;
+}
+
+inline
+bool udp_batch_send_add(UDPBatch* batch, const sockaddr_in6* dest, const byte* data, int32 length) NO_EXCEPT
+{
+    byte* packet = udp_batch_send_get(batch, dest);
+    if (!packet) {
+        return false;
+    }
+
+    memcpy(packet, data, length);
+    udp_batch_send_commit(batch, length);
+
+    return true;
+}
+
+int32 udp_batch_send_flush(SocketConnection* con, UDPBatch* batch) NO_EXCEPT
+{
+    int32 sent = 0;
+    for (int32 i = 0; i < batch->length; ++i) {
+        const int32 rc = sendto(
+            con->sd,
+            (const char *) (batch->packets + i * batch->packet_size), batch->lengths[i],
+            0,
+            (const sockaddr *) &batch->addrs[i], sizeof(sockaddr_in6)
+        );
+
+        if (rc == SOCKET_ERROR) {
+            if (WSAGetLastError() == WSAEWOULDBLOCK) {
+                break;
+            }
+
+            LOG_1("[ERROR] sendto failed");
+            batch->length = 0;
+
+            return -1;
+        }
+
+        ++sent;
+    }
+
+    STATS_INCREMENT_BY_DEBUG(DEBUG_COUNTER_NETWORK_OUT_COUNT, sent);
+    batch->length = 0;
+
+    return sent;
+}
+
+#endif
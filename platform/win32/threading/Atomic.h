@@ -867,4 +867,7 @@ FORCE_INLINE void atomic_or_acquire_release(int64* value, int64 mask) NO_EXCEPT
 // These are much faster and could accomplish what you are doing
 #define atomic_fence_release() MemoryBarrier();
 
+// Full fence, also orders a store with a later load
+#define atomic_fence_acquire_release() MemoryBarrier();
+
 #endif
@@ -11,6 +11,8 @@
 #define COMS_SERIALIZE_OMSSETTINGS_H
 
 #include "../stdlib/Stdlib.h"
+#include "../utils/StringUtils.h"
+#include "../hash/GeneralHash.h"
 
 struct SettingsMatch {
     const char* name;
@@ -30,6 +32,208 @@ struct SettingsMatch {
  * {"key_forward.context", DATA_TYPE_UINT8, offsetof(InputSettings, key_forward) + offsetof(Hotkey, context), 1},
  */
 
+// Characters that end a setting name in the settings file
+#define SETTINGS_NAME_DELIMITER "\r\n\t :[{"
+
+#define SETTINGS_HASH_MAX_COUNT 4096
+
+// Max amount of names per bucket, buckets are small since we have 2 names per bucket on average
+#define SETTINGS_HASH_MAX_BUCKET_SIZE 32
+
+/**
+ * Minimal perfect hash from a setting name to its SettingsMatch index (hash and displace)
+ *
+ * The names are distributed into buckets.
+ * Every bucket has a pilot value which moves all of its names into free slots of the table.
+ * Since the table has exactly one slot per setting, the lookup is one hash + one name comparison.
+ */
+struct SettingsHashMap {
+    const SettingsMatch* match;
+    int32 match_count;
+    int32 bucket_count;
+
+    // One pilot per bucket
+    uint16* pilots;
+
+    // Slot -> match index
+    int16* indices;
+
+    // Avoids strlen() of the match names during the lookup
+    uint8* name_lengths;
+};
+
+FORCE_INLINE
+uint64 settings_hash_name(const char* name, int32 length) NO_EXCEPT
+{
+    // FNV-1a
+    uint64 hash = 14695981039346656037ULL;
+    for (int32 i = 0; i < length; ++i) {
+        hash ^= (byte) name[i];
+        hash *= 1099511628211ULL;
+    }
+
+    // The upper bits of FNV-1a are badly mixed for similar names (e.g. setting_1, setting_2)
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+FORCE_INLINE
+int32 settings_hash_bucket(uint64 hash, int32 bucket_count) NO_EXCEPT
+{
+    return (int32) ((hash >> 32) % (uint32) bucket_count);
+}
+
+FORCE_INLINE
+int32 settings_hash_slot(uint64 hash, uint32 pilot, int32 match_count) NO_EXCEPT
+{
+    return (int32) (hash_downscale_64(hash ^ (pilot * 0x9E3779B97F4A7C15ULL)) % (uint32) match_count);
+}
+
+// Calculates how large the hash map data will be
+FORCE_INLINE
+int64 settings_hash_size(int32 match_count) NO_EXCEPT
+{
+    const int32 bucket_count = (match_count + 1) / 2;
+
+    return bucket_count * sizeof(uint16)
+        + match_count * sizeof(int16)
+        + match_count * sizeof(uint8);
+}
+
+/**
+ * Creates the perfect hash for a settings definition
+ *
+ * This only needs to be done once at startup, the settings definitions don't change
+ *
+ * @param hm          Hash map to create
+ * @param match       Settings definitions
+ * @param match_count Amount of settings definitions
+ * @param buf         Memory for the hash map (see settings_hash_size())
+ *
+ * @return False if no perfect hash could be found (e.g. duplicate names)
+ */
+bool settings_hash_create(
+    SettingsHashMap* const __restrict hm,
+    const SettingsMatch* const __restrict match,
+    int32 match_count,
+    byte* __restrict buf
+) NO_EXCEPT
+{
+    ASSERT_TRUE(match_count > 0 && match_count <= SETTINGS_HASH_MAX_COUNT);
+
+    hm->match = match;
+    hm->match_count = match_count;
+    hm->bucket_count = (match_count + 1) / 2;
+
+    hm->pilots = (uint16 *) buf;
+    buf += hm->bucket_count * sizeof(uint16);
+
+    hm->indices = (int16 *) buf;
+    buf += match_count * sizeof(int16);
+
+    hm->name_lengths = buf;
+
+    uint64 hashes[SETTINGS_HASH_MAX_COUNT];
+    int16 bucket_sizes[SETTINGS_HASH_MAX_COUNT];
+
+    memset(bucket_sizes, 0, hm->bucket_count * sizeof(int16));
+    memset(hm->indices, -1, match_count * sizeof(int16));
+
+    int32 max_bucket_size = 0;
+    for (int32 i = 0; i < match_count; ++i) {
+        const int32 length = (int32) strlen(match[i].name);
+        ASSERT_TRUE(length > 0 && length < 256);
+
+        hm->name_lengths[i] = (uint8) length;
+        hashes[i] = settings_hash_name(match[i].name, length);
+
+        const int32 bucket = settings_hash_bucket(hashes[i], hm->bucket_count);
+        max_bucket_size = OMS_MAX(max_bucket_size, (int32) ++bucket_sizes[bucket]);
+    }
+
+    if (max_bucket_size > SETTINGS_HASH_MAX_BUCKET_SIZE) {
+        return false;
+    }
+
+    // Large buckets are placed first since they are the hardest to fit into the free slots
+    for (int32 size = max_bucket_size; size > 0; --size) {
+        for (int32 bucket = 0; bucket < hm->bucket_count; ++bucket) {
+            if (bucket_sizes[bucket] != size) {
+                continue;
+            }
+
+            int32 bucket_elements[SETTINGS_HASH_MAX_BUCKET_SIZE];
+            int32 element_count = 0;
+            for (int32 i = 0; i < match_count; ++i) {
+                if (settings_hash_bucket(hashes[i], hm->bucket_count) == bucket) {
+                    bucket_elements[element_count++] = i;
+                }
+            }
+
+            // Find a pilot that moves all names of this bucket into distinct free slots
+            int32 slots[SETTINGS_HASH_MAX_BUCKET_SIZE];
+            bool is_placed = false;
+
+            for (uint32 pilot = 0; pilot <= 0xFFFF && !is_placed; ++pilot) {
+                is_placed = true;
+
+                for (int32 i = 0; i < element_count; ++i) {
+                    slots[i] = settings_hash_slot(hashes[bucket_elements[i]], pilot, match_count);
+
+                    bool is_taken = hm->indices[slots[i]] >= 0;
+                    for (int32 j = 0; j < i && !is_taken; ++j) {
+                        is_taken = slots[j] == slots[i];
+                    }
+
+                    if (is_taken) {
+                        is_placed = false;
+                        break;
+                    }
+                }
+
+                if (is_placed) {
+                    hm->pilots[bucket] = (uint16) pilot;
+                    for (int32 i = 0; i < element_count; ++i) {
+                        hm->indices[slots[i]] = (int16) bucket_elements[i];
+                    }
+                }
+            }
+
+            if (!is_placed) {
+                LOG_1("[ERROR] Couldn't create settings hash");
+
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Finds the settings definition for a setting name
+ *
+ * @param hm     Settings hash map
+ * @param name   Setting name (doesn't need to be null terminated)
+ * @param length Name length
+ *
+ * @return Index of the settings definition or -1 if the name is unknown
+ */
+FORCE_INLINE
+int32 settings_hash_find(const SettingsHashMap* const __restrict hm, const char* __restrict name, int32 length) NO_EXCEPT
+{
+    const uint64 hash = settings_hash_name(name, length);
+    const uint32 pilot = hm->pilots[settings_hash_bucket(hash, hm->bucket_count)];
+    const int32 index = hm->indices[settings_hash_slot(hash, pilot, hm->match_count)];
+
+    return hm->name_lengths[index] == length && memcmp(hm->match[index].name, name, length) == 0
+        ? index
+        : -1;
+}
+
 static inline
 char* settings_save_name(
     const SettingsMatch* const __restrict match,
@@ -39,7 +243,17 @@ char* settings_save_name(
     out += str_copy(out, match->name);
 
     switch (match->type) {
+        case DATA_TYPE_BOOL_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_INT8_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_INT16_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_INT32_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_INT64_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_UINT8_ARRAY: FALLTHROUGH;
         case DATA_TYPE_UINT16_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_UINT32_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_UINT64_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_F32_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_F64_ARRAY: FALLTHROUGH;
         case DATA_TYPE_V4_F32_ARRAY: {
             *out++ = '[';
             *out++ = ']';
@@ -95,19 +309,44 @@ char* settings_save_value(
             out += int_to_str((int64) *((uint64 *) member), out);
         } break;
         case DATA_TYPE_F32: {
-            out += float_to_str((f64) *((f32 *) member), out);
+            // Loading the saved value returns the identical float
+            out += float_to_str_shortest(*((f32 *) member), out);
         } break;
         case DATA_TYPE_F64: {
             out += float_to_str((f64) *((f64 *) member), out);
         } break;
 
         // Array data
-        case DATA_TYPE_UINT16_ARRAY: {
+        case DATA_TYPE_BOOL_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_INT8_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_INT16_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_INT32_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_INT64_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_UINT8_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_UINT16_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_UINT32_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_UINT64_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_F32_ARRAY: FALLTHROUGH;
+        case DATA_TYPE_F64_ARRAY: {
+            // The array types have the same order as the scalar types
+            static const int32 element_sizes[] = {
+                sizeof(bool),
+                sizeof(int8), sizeof(int16), sizeof(int32), sizeof(int64),
+                sizeof(uint8), sizeof(uint16), sizeof(uint32), sizeof(uint64),
+                sizeof(f32), sizeof(f64)
+            };
+
+            // handles name[] 1 1 0 1 0
+            SettingsMatch element = match[match_index];
+            element.type = (DataType) (element.type - DATA_TYPE_BOOL_ARRAY + DATA_TYPE_BOOL);
+
             for (int32 j = 0; j < match[match_index].count; ++j) {
-                out += sprintf_fast(
-                    out, "%d\n",
-                    (int32) *((uint16 *) member)
-                );
+                if (j > 0) {
+                    *out++ = ' ';
+                }
+
+                out = settings_save_value(settings_data, &element, 0, out);
+                element.offset += element_sizes[element.type - DATA_TYPE_BOOL];
             }
         } break;
 
@@ -139,16 +378,16 @@ char* settings_save_value(
         } break;
         case DATA_TYPE_CHAR_STR: {
             if (match[match_index].count > 1) {
-                str_copy_to_eol((const char *) member, out, match[match_index].count);
+                out += str_copy_to_eol((const char *) member, out, match[match_index].count);
             } else {
-                str_copy_to_eol((const char *) member, out);
+                out += str_copy_to_eol((const char *) member, out);
             }
         } break;
         case DATA_TYPE_WCHAR_STR: {
             char temp[256];
-            wchar_to_char(out, (const wchar_t *) member);
+            wchar_to_char(temp, (const wchar_t *) member);
 
-            str_copy_to_eol((const char *) temp, out);
+            out += str_copy_to_eol((const char *) temp, out);
         } break;
         case DATA_TYPE_STRUCT: {
             --out;
@@ -171,54 +410,47 @@ size_t settings_save(
     const void* const __restrict settings_data,
     const char* __restrict in,
     char* __restrict out, size_t out_length,
-    const SettingsMatch* const __restrict match,
-    int32 match_count
+    const SettingsHashMap* const __restrict hm
 )  NO_EXCEPT
 {
-    char line[2048];
-    char setting[64];
-
     const byte* const settings = (const byte *) settings_data;
     const char* const start = out;
 
-    int32 offset;
     while (*in && out_length - (out - start) > 128) {
-        if (in[0] == '/' && in[1] == '/') {
-            offset = str_copy_to_eol(in, out);
-            in += offset;
-            out += offset;
+        const char* line = in;
+        str_move_to((const char**) &in, '\n');
 
-            *out = '\n';
-            ++out;
+        // Comments are never settings
+        int32 match_index = -1;
+        if (line[0] != '/' || line[1] != '/') {
+            const char* name_end = line;
+            str_move_to(&name_end, SETTINGS_NAME_DELIMITER);
 
-            continue;
+            match_index = settings_hash_find(hm, line, (int32) (name_end - line));
         }
 
-        in += str_copy_to_eol(in, line, sizeof(line) - 1);
-        sscanf_fast(line, "%s ", setting, 63);
-
-        bool found = false;
-
-        for (int32 i = 0; i < match_count; ++i) {
-            if (strcmp(line, match[i].name) == 0) {
-                out = settings_save_name(&match[i], out);
-                out = settings_save_value(settings, match, i, out);
-
-                // Newline after settings line output
-                *out++ = '\n';
-
-                found = true;
+        if (match_index >= 0) {
+            out = settings_save_name(&hm->match[match_index], out);
+            out = settings_save_value(settings, hm->match, match_index, out);
+        } else {
+            // Couldn't find any match -> just copy old line
+            // The line length is unbounded, it must fit including the newline
+            const size_t line_length = (size_t) (in - line);
+            if (line_length >= out_length - (out - start)) {
+                LOG_1("[WARNING] Settings output buffer too small");
                 break;
             }
-        }
 
-        if (found) {
-            continue;
+            memcpy(out, line, line_length);
+            out += line_length;
         }
 
-        // Couldn't find any match -> just copy old values
-        out += str_copy_to_eol(line, out);
+        // Newline after settings line output
         *out++ = '\n';
+
+        if (*in == '\n') {
+            ++in;
+        }
     }
 
     return (size_t) (out - start);
@@ -624,8 +856,7 @@ const char* settings_load_value(
 void settings_load(
     void* const __restrict settings_data,
     const char* __restrict data,
-    const SettingsMatch* const __restrict match,
-    int32 match_count
+    const SettingsHashMap* const __restrict hm
 ) NO_EXCEPT
 {
     const char* name;
@@ -645,7 +876,8 @@ void settings_load(
 
         // Get name
         name = data;
-        str_move_to(&data, "\r\n\t :[{");
+        str_move_to((const char**) &data, SETTINGS_NAME_DELIMITER);
+        const int32 name_length = (int32) (data - name);
 
         // Move to value
         str_skip_whitespace(&data);
@@ -655,13 +887,9 @@ void settings_load(
             continue;
         }
 
-        for (int32 i = 0; i < match_count; ++i) {
-            // @performance calculating strlen every time is stupid
-            if (strncmp(name, match[i].name, strlen(match[i].name)) == 0) {
-                data = settings_load_value(settings, data, match, i);
-
-                break;
-            }
+        const int32 match_index = settings_hash_find(hm, name, name_length);
+        if (match_index >= 0) {
+            data = settings_load_value(settings, data, hm->match, match_index);
         }
 
         // After parsing a line we move to the next line
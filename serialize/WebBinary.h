@@ -12,89 +12,659 @@
 
 #include <string.h>
 #include "../stdlib/Stdlib.h"
-#include "../utils/StringUtils.h"
-#include "../compiler/TypeName.h"
+
+/**
+ * Compile time schemas for structs
+ *
+ * A schema is a CONSTEXPR array of WebBinaryValue created with the WEB_BINARY_FIELD* macros.
+ * The readers/writers are instantiated per schema and every field is resolved at compile time.
+ * As a result there is no per-field branching at runtime.
+ *
+ * Wire format:
+ *      The fields are written in schema order without padding.
+ *      Fixed fields are stored as they are in memory (little endian).
+ *          As long as only fixed fields precede a field it has a constant wire offset and can be read in place.
+ *      Varint fields are stored as LEB128, signed types are zigzag encoded.
+ *      Delta fields are stored as zigzag LEB128 of the difference to the same field of a previous struct.
+ *          The difference wraps around in the field width.
+ *
+ * Only integer fields may use varint or delta encoding.
+ */
+
+enum WebBinaryEncoding : byte {
+    WEB_BINARY_ENCODING_FIXED,
+    WEB_BINARY_ENCODING_VARINT,
+    WEB_BINARY_ENCODING_DELTA,
+};
 
 struct WebBinaryValue {
     const char* name;
-    const char* type;
-    const char* nested_schema = NULL;
+    DataType type;
+    WebBinaryEncoding encoding;
+
+    // Offset and size of the field in the struct
+    uint32 offset;
+    uint32 size;
+
+    const WebBinaryValue* nested_schema = NULL;
+    int32 nested_count = 0;
 };
 
-CONSTEXPR
-void web_binary_copy(char* dest, int32 src) {
-    for (size_t i = 0; i < sizeof(int32); ++i) {
-        dest[i] = static_cast<char>(src >> (8 * i));
+// Maps the field types to the DataType of the schema
+template<typename T>
+struct WebBinaryType { static CONSTEXPR DataType type = DATA_TYPE_STRUCT; };
+
+template<> struct WebBinaryType<bool> { static CONSTEXPR DataType type = DATA_TYPE_BOOL; };
+template<> struct WebBinaryType<int8> { static CONSTEXPR DataType type = DATA_TYPE_INT8; };
+template<> struct WebBinaryType<int16> { static CONSTEXPR DataType type = DATA_TYPE_INT16; };
+template<> struct WebBinaryType<int32> { static CONSTEXPR DataType type = DATA_TYPE_INT32; };
+template<> struct WebBinaryType<int64> { static CONSTEXPR DataType type = DATA_TYPE_INT64; };
+template<> struct WebBinaryType<uint8> { static CONSTEXPR DataType type = DATA_TYPE_UINT8; };
+template<> struct WebBinaryType<uint16> { static CONSTEXPR DataType type = DATA_TYPE_UINT16; };
+template<> struct WebBinaryType<uint32> { static CONSTEXPR DataType type = DATA_TYPE_UINT32; };
+template<> struct WebBinaryType<uint64> { static CONSTEXPR DataType type = DATA_TYPE_UINT64; };
+template<> struct WebBinaryType<f32> { static CONSTEXPR DataType type = DATA_TYPE_F32; };
+template<> struct WebBinaryType<f64> { static CONSTEXPR DataType type = DATA_TYPE_F64; };
+template<> struct WebBinaryType<char> { static CONSTEXPR DataType type = DATA_TYPE_CHAR; };
+
+template<size_t N>
+struct WebBinaryType<char[N]> { static CONSTEXPR DataType type = DATA_TYPE_CHAR_STR; };
+
+template<typename T, size_t N>
+struct WebBinaryType<T[N]> {
+    static CONSTEXPR DataType type = WebBinaryType<T>::type >= DATA_TYPE_BOOL && WebBinaryType<T>::type <= DATA_TYPE_F64
+        ? (DataType) (WebBinaryType<T>::type + (DATA_TYPE_BOOL_ARRAY - DATA_TYPE_BOOL))
+        : DATA_TYPE_BYTE_ARRAY;
+};
+
+#define WEB_BINARY_FIELD_ENCODED(StructType, Field, Encoding) \
+    { \
+        #Field, \
+        WebBinaryType<decltype(StructType::Field)>::type, \
+        (Encoding), \
+        (uint32) offsetof(StructType, Field), \
+        (uint32) sizeof(StructType::Field) \
     }
+
+#define WEB_BINARY_FIELD(StructType, Field) \
+    WEB_BINARY_FIELD_ENCODED(StructType, Field, WEB_BINARY_ENCODING_FIXED)
+
+#define WEB_BINARY_FIELD_WITH_SCHEMA(StructType, Field, Schema) \
+    { \
+        #Field, \
+        DATA_TYPE_STRUCT, \
+        WEB_BINARY_ENCODING_FIXED, \
+        (uint32) offsetof(StructType, Field), \
+        (uint32) sizeof(StructType::Field), \
+        (Schema), \
+        (int32) ARRAY_COUNT(Schema) \
+    }
+
+CONSTEXPR inline
+bool web_binary_is_integer(DataType type) NO_EXCEPT
+{
+    return type >= DATA_TYPE_INT8 && type <= DATA_TYPE_UINT64;
 }
 
-template<const WebBinaryValue* binary_struct, int32 count>
-CONSTEXPR int32 web_binary_schema_size() {
+CONSTEXPR inline
+bool web_binary_is_signed(DataType type) NO_EXCEPT
+{
+    return type >= DATA_TYPE_INT8 && type <= DATA_TYPE_INT64;
+}
+
+// Max bytes of a LEB128 encoded integer of the given byte size
+CONSTEXPR inline
+int32 web_binary_varint_max_size(uint32 size) NO_EXCEPT
+{
+    return (int32) ((size * 8 + 6) / 7);
+}
+
+/**
+ * Checks if the schema can be used for reading and writing
+ *
+ * @param schema    Schema fields
+ * @param count     Field count
+ *
+ * @return true if every varint/delta field is an integer and every nested schema is valid
+ */
+CONSTEXPR inline
+bool web_binary_schema_is_valid(const WebBinaryValue* schema, int32 count) NO_EXCEPT
+{
+    for (int32 i = 0; i < count; ++i) {
+        if (schema[i].encoding != WEB_BINARY_ENCODING_FIXED && !web_binary_is_integer(schema[i].type)) {
+            return false;
+        }
+
+        if (schema[i].nested_schema && !web_binary_schema_is_valid(schema[i].nested_schema, schema[i].nested_count)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+CONSTEXPR inline
+bool web_binary_schema_has_delta(const WebBinaryValue* schema, int32 count) NO_EXCEPT
+{
+    for (int32 i = 0; i < count; ++i) {
+        if (schema[i].encoding == WEB_BINARY_ENCODING_DELTA
+            || (schema[i].nested_schema && web_binary_schema_has_delta(schema[i].nested_schema, schema[i].nested_count))
+        ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Checks if the field has a constant size on the wire
+CONSTEXPR inline
+bool web_binary_field_is_fixed(const WebBinaryValue* field) NO_EXCEPT
+{
+    if (field->nested_schema) {
+        for (int32 i = 0; i < field->nested_count; ++i) {
+            if (!web_binary_field_is_fixed(&field->nested_schema[i])) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    return field->encoding == WEB_BINARY_ENCODING_FIXED;
+}
+
+// Wire size of a fixed field or the max wire size of a varint/delta field
+CONSTEXPR inline
+int32 web_binary_field_max_size(const WebBinaryValue* field) NO_EXCEPT
+{
+    if (field->nested_schema) {
+        int32 size = 0;
+        for (int32 i = 0; i < field->nested_count; ++i) {
+            size += web_binary_field_max_size(&field->nested_schema[i]);
+        }
+
+        return size;
+    }
+
+    return field->encoding == WEB_BINARY_ENCODING_FIXED
+        ? (int32) field->size
+        : web_binary_varint_max_size(field->size);
+}
+
+/**
+ * Max size of a serialized struct
+ *
+ * @param schema    Schema fields
+ * @param count     Field count
+ *
+ * @return Max size in bytes
+ */
+CONSTEXPR inline
+int32 web_binary_max_size(const WebBinaryValue* schema, int32 count) NO_EXCEPT
+{
     int32 size = 0;
     for (int32 i = 0; i < count; ++i) {
-        size += strlen(binary_struct[i].name) + 1;
-        size += strlen(binary_struct[i].type) + 1;
+        size += web_binary_field_max_size(&schema[i]);
+    }
 
-        // Add size for nested schema if present
-        if (binary_struct[i].nested_schema) {
-            size += strlen(binary_struct[i].nested_schema) + 1;
-        } else {
-            size += 1; // Empty string for no nested schema
+    return size;
+}
+
+/**
+ * Wire offset of a field
+ *
+ * @param schema    Schema fields
+ * @param index     Field index
+ *
+ * @return Wire offset or -1 if a preceding field has a variable size
+ */
+CONSTEXPR inline
+int32 web_binary_wire_offset(const WebBinaryValue* schema, int32 index) NO_EXCEPT
+{
+    int32 offset = 0;
+    for (int32 i = 0; i < index; ++i) {
+        if (!web_binary_field_is_fixed(&schema[i])) {
+            return -1;
+        }
+
+        offset += web_binary_field_max_size(&schema[i]);
+    }
+
+    return offset;
+}
+
+/**
+ * Checks if the wire format is identical to the memory layout of the struct
+ *
+ * In that case reading/writing is a single memcpy and the data can be used in place
+ *
+ * @param schema        Schema fields
+ * @param count         Field count
+ * @param struct_size   sizeof() of the struct
+ *
+ * @return true if the struct has no padding and only fixed fields in declaration order
+ */
+CONSTEXPR inline
+bool web_binary_is_memory_layout(const WebBinaryValue* schema, int32 count, uint32 struct_size) NO_EXCEPT
+{
+    uint32 offset = 0;
+    for (int32 i = 0; i < count; ++i) {
+        if (schema[i].offset != offset
+            || !web_binary_field_is_fixed(&schema[i])
+            || (schema[i].nested_schema
+                && !web_binary_is_memory_layout(schema[i].nested_schema, schema[i].nested_count, schema[i].size)
+            )
+        ) {
+            return false;
+        }
+
+        offset += schema[i].size;
+    }
+
+    return offset == struct_size;
+}
+
+// FNV-1a over a single byte
+CONSTEXPR inline
+uint64 web_binary_hash_byte(uint64 hash, byte value) NO_EXCEPT
+{
+    return (hash ^ value) * 1099511628211ULL;
+}
+
+/**
+ * Hash of the schema used for version checks
+ *
+ * Any change to the field names, types, encodings, sizes or order changes the hash.
+ * The struct offsets are not part of the hash since they are not part of the wire format.
+ *
+ * @param schema    Schema fields
+ * @param count     Field count
+ * @param hash      Initial hash (used for nested schemas)
+ *
+ * @return Schema hash
+ */
+CONSTEXPR inline
+uint64 web_binary_schema_hash(
+    const WebBinaryValue* schema, int32 count,
+    uint64 hash = 14695981039346656037ULL
+) NO_EXCEPT
+{
+    for (int32 i = 0; i < count; ++i) {
+        for (const char* name = schema[i].name; *name; ++name) {
+            hash = web_binary_hash_byte(hash, (byte) *name);
+        }
+
+        hash = web_binary_hash_byte(hash, 0);
+        hash = web_binary_hash_byte(hash, (byte) schema[i].type);
+        hash = web_binary_hash_byte(hash, (byte) schema[i].encoding);
+
+        for (int32 j = 0; j < 4; ++j) {
+            hash = web_binary_hash_byte(hash, (byte) (schema[i].size >> (8 * j)));
+        }
+
+        if (schema[i].nested_schema) {
+            hash = web_binary_schema_hash(schema[i].nested_schema, schema[i].nested_count, hash);
+        }
+
+        // Field separator, otherwise a nested schema could collide with flattened fields
+        hash = web_binary_hash_byte(hash, 0xFF);
+    }
+
+    return hash;
+}
+
+/////////////////////////////////////////////////////////////
+// Schema description
+//
+// Used by other clients (e.g. web) to decode the data. Layout:
+//      uint64 hash, int32 count, count * field
+//      field = name\0, uint8 type, uint8 encoding, uint32 size, [int32 count, count * field] for nested schemas
+// All integers are little endian.
+/////////////////////////////////////////////////////////////
+
+CONSTEXPR inline
+int32 web_binary_schema_fields_size(const WebBinaryValue* schema, int32 count) NO_EXCEPT
+{
+    int32 size = sizeof(int32);
+    for (int32 i = 0; i < count; ++i) {
+        const char* name = schema[i].name;
+        while (*name++) {
+            ++size;
+        }
+
+        size += 1 + 2 * sizeof(byte) + sizeof(uint32);
+
+        if (schema[i].nested_schema) {
+            size += web_binary_schema_fields_size(schema[i].nested_schema, schema[i].nested_count);
         }
     }
 
     return size;
 }
 
+CONSTEXPR inline
+char* web_binary_copy(char* dest, uint64 src, int32 size) NO_EXCEPT
+{
+    for (int32 i = 0; i < size; ++i) {
+        dest[i] = (char) (src >> (8 * i));
+    }
+
+    return dest + size;
+}
+
+CONSTEXPR inline
+char* web_binary_schema_fields(char* buffer, const WebBinaryValue* schema, int32 count) NO_EXCEPT
+{
+    buffer = web_binary_copy(buffer, (uint64) count, sizeof(int32));
+
+    for (int32 i = 0; i < count; ++i) {
+        const char* name = schema[i].name;
+        while (*name) {
+            *buffer++ = *name++;
+        }
+
+        *buffer++ = '\0';
+        *buffer++ = (char) schema[i].type;
+        *buffer++ = (char) schema[i].encoding;
+        buffer = web_binary_copy(buffer, schema[i].size, sizeof(uint32));
+
+        if (schema[i].nested_schema) {
+            buffer = web_binary_schema_fields(buffer, schema[i].nested_schema, schema[i].nested_count);
+        }
+    }
+
+    return buffer;
+}
+
 template<size_t N>
 struct WebBinarySchema {
     char data[N];
     CONSTEXPR WebBinarySchema() : data{} {}
     CONSTEXPR const char* c_str() const { return data; }
+    CONSTEXPR int32 size() const { return (int32) N; }
 };
 
 template<const WebBinaryValue* binary_struct, int32 count>
 CONSTEXPR auto web_binary_schema() {
-    CONSTEXPR int32 size = web_binary_schema_size<binary_struct, count>();
+    CONSTEXPR int32 size = sizeof(uint64) + web_binary_schema_fields_size(binary_struct, count);
     WebBinarySchema<size> schema;
 
-    char* buffer = schema.data;
-    for (int32 i = 0; i < count; ++i) {
-        str_copy(buffer, binary_struct[i].name);
-        buffer += strlen(binary_struct[i].name) + 1;
+    char* buffer = web_binary_copy(schema.data, web_binary_schema_hash(binary_struct, count), sizeof(uint64));
+    web_binary_schema_fields(buffer, binary_struct, count);
 
-        str_copy(buffer, binary_struct[i].type);
-        buffer += strlen(binary_struct[i].type) + 1;
+    return schema;
+}
 
-        // Write nested schema if present
-        if (binary_struct[i].nested_schema) {
-            str_copy(buffer, binary_struct[i].nested_schema);
-            buffer += strlen(binary_struct[i].nested_schema) + 1;
-        } else {
-            *buffer++ = '\0'; // Empty string
+/////////////////////////////////////////////////////////////
+// Reading/writing
+/////////////////////////////////////////////////////////////
+
+inline
+byte* web_binary_varint_write(byte* out, uint64 value) NO_EXCEPT
+{
+    while (value >= 0x80) {
+        *out++ = (byte) (value | 0x80);
+        value >>= 7;
+    }
+
+    *out++ = (byte) value;
+
+    return out;
+}
+
+// max_bytes limits the loop for corrupted data
+inline
+const byte* web_binary_varint_read(const byte* data, uint64* value, int32 max_bytes) NO_EXCEPT
+{
+    uint64 result = 0;
+    int32 shift = 0;
+
+    for (int32 i = 0; i < max_bytes; ++i) {
+        const byte b = *data++;
+        result |= ((uint64) (b & 0x7F)) << shift;
+        shift += 7;
+
+        if (b < 0x80) {
+            break;
         }
+    }
 
-        web_binary_copy(buffer, binary_struct[i].offset);
-        buffer += sizeof(int32);
+    *value = result;
+
+    return data;
+}
 
-        web_binary_copy(buffer, binary_struct[i].length);
-        buffer += sizeof(int32);
+FORCE_INLINE
+uint64 web_binary_zigzag_encode(int64 value) NO_EXCEPT
+{
+    return ((uint64) value << 1) ^ (uint64) (value >> 63);
+}
+
+FORCE_INLINE
+int64 web_binary_zigzag_decode(uint64 value) NO_EXCEPT
+{
+    return (int64) (value >> 1) ^ -((int64) (value & 1));
+}
+
+// Loads an integer field as 64 bit value (sign extended for signed types)
+template<uint32 size, bool is_signed>
+FORCE_INLINE
+uint64 web_binary_load_int(const byte* src) NO_EXCEPT
+{
+    IF_CONSTEXPR(size == 1) {
+        return is_signed ? (uint64) *((const int8 *) src) : *src;
+    } else IF_CONSTEXPR(size == 2) {
+        return is_signed ? (uint64) *((const int16 *) src) : *((const uint16 *) src);
+    } else IF_CONSTEXPR(size == 4) {
+        return is_signed ? (uint64) *((const int32 *) src) : *((const uint32 *) src);
+    } else {
+        return *((const uint64 *) src);
     }
+}
 
-    return schema;
+template<uint32 size>
+FORCE_INLINE
+void web_binary_store_int(byte* dest, uint64 value) NO_EXCEPT
+{
+    IF_CONSTEXPR(size == 1) {
+        *dest = (byte) value;
+    } else IF_CONSTEXPR(size == 2) {
+        *((uint16 *) dest) = (uint16) value;
+    } else IF_CONSTEXPR(size == 4) {
+        *((uint32 *) dest) = (uint32) value;
+    } else {
+        *((uint64 *) dest) = value;
+    }
 }
 
-#define WEB_BINARY_FIELD(StructType, Field) \
-    { \
-        #Field, \
-        GetTypeName<decltype(StructType::Field)>() \
+// The delta is calculated in the field width, this way a wrap around stays a small delta
+template<uint32 size>
+FORCE_INLINE
+int64 web_binary_sign_extend(uint64 value) NO_EXCEPT
+{
+    return (int64) (value << (64 - 8 * size)) >> (64 - 8 * size);
+}
+
+template<const WebBinaryValue* schema, int32 count, int32 i = 0>
+FORCE_INLINE
+byte* web_binary_write_fields(byte* out, const byte* in, const byte* prev) NO_EXCEPT
+{
+    IF_CONSTEXPR(i < count) {
+        CONSTEXPR WebBinaryValue field = schema[i];
+
+        IF_CONSTEXPR(field.nested_schema != NULL) {
+            out = web_binary_write_fields<field.nested_schema, field.nested_count>(
+                out, in + field.offset,
+                web_binary_schema_has_delta(field.nested_schema, field.nested_count) ? prev + field.offset : NULL
+            );
+        } else IF_CONSTEXPR(field.encoding == WEB_BINARY_ENCODING_FIXED) {
+            memcpy(out, in + field.offset, field.size);
+            out += field.size;
+        } else IF_CONSTEXPR(field.encoding == WEB_BINARY_ENCODING_VARINT) {
+            const uint64 value = web_binary_load_int<field.size, web_binary_is_signed(field.type)>(in + field.offset);
+            out = web_binary_varint_write(
+                out,
+                web_binary_is_signed(field.type) ? web_binary_zigzag_encode((int64) value) : value
+            );
+        } else {
+            const uint64 value = web_binary_load_int<field.size, web_binary_is_signed(field.type)>(in + field.offset);
+            const uint64 base = web_binary_load_int<field.size, web_binary_is_signed(field.type)>(prev + field.offset);
+            out = web_binary_varint_write(out, web_binary_zigzag_encode(web_binary_sign_extend<field.size>(value - base)));
+        }
+
+        return web_binary_write_fields<schema, count, i + 1>(out, in, prev);
+    } else {
+        return out;
     }
+}
 
-#define WEB_BINARY_FIELD_WITH_SCHEMA(StructType, Field, Schema) \
-    { \
-        #Field, \
-        GetTypeName<decltype(StructType::Field)>(), \
-        Schema.c_str() \
+template<const WebBinaryValue* schema, int32 count, int32 i = 0>
+FORCE_INLINE
+const byte* web_binary_read_fields(const byte* data, byte* out, const byte* prev) NO_EXCEPT
+{
+    IF_CONSTEXPR(i < count) {
+        CONSTEXPR WebBinaryValue field = schema[i];
+
+        IF_CONSTEXPR(field.nested_schema != NULL) {
+            data = web_binary_read_fields<field.nested_schema, field.nested_count>(
+                data, out + field.offset,
+                web_binary_schema_has_delta(field.nested_schema, field.nested_count) ? prev + field.offset : NULL
+            );
+        } else IF_CONSTEXPR(field.encoding == WEB_BINARY_ENCODING_FIXED) {
+            memcpy(out + field.offset, data, field.size);
+            data += field.size;
+        } else IF_CONSTEXPR(field.encoding == WEB_BINARY_ENCODING_VARINT) {
+            uint64 value;
+            data = web_binary_varint_read(data, &value, web_binary_varint_max_size(field.size));
+            web_binary_store_int<field.size>(
+                out + field.offset,
+                web_binary_is_signed(field.type) ? (uint64) web_binary_zigzag_decode(value) : value
+            );
+        } else {
+            uint64 value;
+            data = web_binary_varint_read(data, &value, web_binary_varint_max_size(field.size));
+
+            const uint64 base = web_binary_load_int<field.size, web_binary_is_signed(field.type)>(prev + field.offset);
+            web_binary_store_int<field.size>(out + field.offset, base + (uint64) web_binary_zigzag_decode(value));
+        }
+
+        return web_binary_read_fields<schema, count, i + 1>(data, out, prev);
+    } else {
+        return data;
     }
+}
+
+/**
+ * Serializes a struct
+ *
+ * @param out   Output buffer (at least web_binary_max_size() bytes)
+ * @param in    Struct to serialize
+ * @param prev  Base struct of the delta fields (e.g. the previously sent struct or a zeroed struct)
+ *
+ * @return Bytes written
+ */
+template<const WebBinaryValue* schema, int32 count, typename T>
+inline
+int32 web_binary_write(byte* out, const T* in, const T* prev = NULL) NO_EXCEPT
+{
+    static_assert(web_binary_schema_is_valid(schema, count), "Only integer fields can be varint/delta encoded");
+
+    IF_CONSTEXPR(web_binary_is_memory_layout(schema, count, sizeof(T))) {
+        memcpy(out, in, sizeof(T));
+
+        return (int32) sizeof(T);
+    } else {
+        IF_CONSTEXPR(web_binary_schema_has_delta(schema, count)) {
+            ASSERT_TRUE(prev);
+        }
+
+        return (int32) (web_binary_write_fields<schema, count>(out, (const byte *) in, (const byte *) prev) - out);
+    }
+}
+
+/**
+ * Deserializes a struct
+ *
+ * @param data      Serialized data
+ * @param length    Length of the available data
+ * @param out       Struct to fill
+ * @param prev      Base struct of the delta fields (same as used by web_binary_write)
+ *
+ * @return Bytes read or -1 if the data is truncated
+ */
+template<const WebBinaryValue* schema, int32 count, typename T>
+inline
+int32 web_binary_read(const byte* data, int32 length, T* out, const T* prev = NULL) NO_EXCEPT
+{
+    static_assert(web_binary_schema_is_valid(schema, count), "Only integer fields can be varint/delta encoded");
+    CONSTEXPR int32 max_size = web_binary_max_size(schema, count);
+
+    IF_CONSTEXPR(web_binary_is_memory_layout(schema, count, sizeof(T))) {
+        if (length < (int32) sizeof(T)) {
+            return -1;
+        }
+
+        memcpy(out, data, sizeof(T));
+
+        return (int32) sizeof(T);
+    } else {
+        IF_CONSTEXPR(web_binary_schema_has_delta(schema, count)) {
+            ASSERT_TRUE(prev);
+        }
+
+        // Short data is decoded from a padded copy so that the fields never need bounds checks
+        byte padded[max_size];
+        const byte* start = data;
+        if (length < max_size) {
+            memset(padded, 0, sizeof(padded));
+            memcpy(padded, data, OMS_MAX(length, 0));
+            start = padded;
+        }
+
+        const int32 read = (int32) (web_binary_read_fields<schema, count>(start, (byte *) out, (const byte *) prev) - start);
+
+        return read <= length ? read : -1;
+    }
+}
+
+/**
+ * Pointer to a field in serialized data (zero copy)
+ *
+ * Only available for fields that are preceded by fixed fields.
+ * The pointer may be unaligned.
+ *
+ * @param data  Serialized data
+ *
+ * @return Pointer to the field in the serialized data
+ */
+template<const WebBinaryValue* schema, int32 index>
+FORCE_INLINE
+const byte* web_binary_field(const byte* data) NO_EXCEPT
+{
+    static_assert(web_binary_wire_offset(schema, index) >= 0, "Field has no constant wire offset");
+    static_assert(schema[index].encoding == WEB_BINARY_ENCODING_FIXED, "Field is not stored in place");
+
+    return data + web_binary_wire_offset(schema, index);
+}
+
+/**
+ * Reads a fixed field directly from serialized data
+ *
+ * @param data  Serialized data
+ *
+ * @return Field value
+ */
+template<const WebBinaryValue* schema, int32 index, typename T>
+FORCE_INLINE
+T web_binary_get(const byte* data) NO_EXCEPT
+{
+    static_assert(sizeof(T) == schema[index].size, "Type doesn't match the field size");
+
+    T value;
+    memcpy(&value, web_binary_field<schema, index>(data), sizeof(T));
+
+    return value;
+}
 
-#endif
\ No newline at end of file
+#endif
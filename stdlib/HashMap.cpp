@@ -536,25 +536,36 @@ HashEntry* hashmap_get_entry(HashMap* const __restrict hm, const char* __restric
 void hashmap_remove(HashMap* const __restrict hm, const char* __restrict key) NO_EXCEPT
 {
     const int32 index = hm->hash_function((void *) key) % hm->buf.capacity;
+    if (chunk_is_free(&hm->buf, index)) {
+        return;
+    }
 
     HashEntry* entry = (HashEntry *) chunk_get_element(&hm->buf, index);
     HashEntry* prev = NULL;
 
     str_move_to_pos(&key, -HASH_MAP_MAX_KEY_LENGTH);
 
+    // Element of the current chain entry
+    int32 element = index;
+
     while (entry) {
         if (strcmp(entry->key, key) == 0) {
             if (prev) {
                 prev->next = entry->next;
+            } else if (entry->next) {
+                // The chain must still start at index -> the next chain entry takes its place
+                element = entry->next - 1;
+                memcpy(entry, chunk_get_element(&hm->buf, element), hm->buf.chunk_size);
             }
 
-            chunk_free_element(&hm->buf, index);
+            chunk_free_element(&hm->buf, element);
 
             return;
         }
 
         prev = entry;
-        entry = entry->next ? (HashEntry *) chunk_get_element(&hm->buf, entry->next - 1) : NULL;
+        element = entry->next - 1;
+        entry = entry->next ? (HashEntry *) chunk_get_element(&hm->buf, element) : NULL;
     }
 }
 
@@ -792,7 +803,7 @@ HashEntryKeyInt32* hashmap_get_entry(HashMap* const hm, uint32 key) NO_EXCEPT
             return entry;
         }
 
-        entry = (HashEntryKeyInt32 *) chunk_get_element(&hm->buf, entry->next - 1);
+        entry = entry->next ? (HashEntryKeyInt32 *) chunk_get_element(&hm->buf, entry->next - 1) : NULL;
     }
 
     return NULL;
@@ -804,23 +815,34 @@ HashEntryKeyInt32* hashmap_get_entry(HashMap* const hm, uint32 key) NO_EXCEPT
 void hashmap_remove(HashMap* const hm, uint32 key) NO_EXCEPT
 {
     const int32 index = hm->hash_function((void *) &key) % hm->buf.capacity;
+    if (chunk_is_free(&hm->buf, index)) {
+        return;
+    }
 
     HashEntryKeyInt32* entry = (HashEntryKeyInt32 *) chunk_get_element(&hm->buf, index);
     HashEntryKeyInt32* prev = NULL;
 
+    // Element of the current chain entry
+    int32 element = index;
+
     while (entry) {
         if (entry->key == key) {
             if (prev) {
                 prev->next = entry->next;
+            } else if (entry->next) {
+                // The chain must still start at index -> the next chain entry takes its place
+                element = entry->next - 1;
+                memcpy(entry, chunk_get_element(&hm->buf, element), hm->buf.chunk_size);
             }
 
-            chunk_free_element(&hm->buf, index);
+            chunk_free_element(&hm->buf, element);
 
             return;
         }
 
         prev = entry;
-        entry = (HashEntryKeyInt32 *) chunk_get_element(&hm->buf, entry->next - 1);
+        element = entry->next - 1;
+        entry = entry->next ? (HashEntryKeyInt32 *) chunk_get_element(&hm->buf, element) : NULL;
     }
 }
 
@@ -1057,7 +1079,7 @@ HashEntryKeyInt64* hashmap_get_entry(HashMap* const hm, uint64 key) NO_EXCEPT
             return entry;
         }
 
-        entry = (HashEntryKeyInt64 *) chunk_get_element(&hm->buf, entry->next - 1);
+        entry = entry->next ? (HashEntryKeyInt64 *) chunk_get_element(&hm->buf, entry->next - 1) : NULL;
     }
 
     return NULL;
@@ -1069,23 +1091,34 @@ HashEntryKeyInt64* hashmap_get_entry(HashMap* const hm, uint64 key) NO_EXCEPT
 void hashmap_remove(HashMap* const hm, uint64 key) NO_EXCEPT
 {
     const int32 index = hm->hash_function((void *) key) % hm->buf.capacity;
+    if (chunk_is_free(&hm->buf, index)) {
+        return;
+    }
 
     HashEntryKeyInt64* entry = (HashEntryKeyInt64 *) chunk_get_element(&hm->buf, index);
     HashEntryKeyInt64* prev = NULL;
 
+    // Element of the current chain entry
+    int32 element = index;
+
     while (entry) {
         if (entry->key == key) {
             if (prev) {
                 prev->next = entry->next;
+            } else if (entry->next) {
+                // The chain must still start at index -> the next chain entry takes its place
+                element = entry->next - 1;
+                memcpy(entry, chunk_get_element(&hm->buf, element), hm->buf.chunk_size);
             }
 
-            chunk_free_element(&hm->buf, index);
+            chunk_free_element(&hm->buf, element);
 
             return;
         }
 
         prev = entry;
-        entry = (HashEntryKeyInt64 *) chunk_get_element(&hm->buf, entry->next - 1);
+        element = entry->next - 1;
+        entry = entry->next ? (HashEntryKeyInt64 *) chunk_get_element(&hm->buf, element) : NULL;
     }
 }
 
@@ -255,6 +255,21 @@ f64 endian_swap(f64 val) NO_EXCEPT
  * However, that is undefined if the buffer at that position isn't correctly aligned and only memcpy handles that correctly
  * If we are sure that the buffer is aligned we could of course use the above mentioned method which should be faster
  */
+FORCE_INLINE
+byte* write_le(byte* p, uint16 v) NO_EXCEPT
+{
+    SWAP_ENDIAN_LITTLE_SELF(v);
+    memcpy(p, &v, sizeof(v));
+
+    return p + sizeof(v);
+}
+
+FORCE_INLINE
+byte* write_le(byte* p, int16 v) NO_EXCEPT
+{
+    return write_le(p, (uint16)v);
+}
+
 FORCE_INLINE
 byte* write_le(byte* p, uint32 v) NO_EXCEPT
 {
@@ -303,6 +318,26 @@ byte* write_le(byte* p, f64 v) NO_EXCEPT
     return write_le(p, bits);
 }
 
+FORCE_INLINE
+const byte* read_le(const byte* __restrict p, uint16* __restrict out) NO_EXCEPT
+{
+    uint16 v;
+    memcpy(&v, p, sizeof(v));
+    *out = SWAP_ENDIAN_LITTLE(v);
+
+    return p + sizeof(v);
+}
+
+FORCE_INLINE
+const byte* read_le(const byte* __restrict p, int16* __restrict out) NO_EXCEPT
+{
+    uint16 v;
+    p = read_le(p, &v);
+    *out = (int16)v;
+
+    return p;
+}
+
 FORCE_INLINE
 const byte* read_le(const byte* __restrict p, uint32* __restrict out) NO_EXCEPT
 {
@@ -153,23 +153,23 @@ void octnode_insert(Octree* const tree, const void* data, const v3_int32& node_c
     while (!node->is_leaf) {
         node->has_data = true;
 
-        const int32 child_index = octree_child_index_from_coord(node->coord, node_coord);
+        // The children split the node at its center
+        const v3_int32 center = aabb_center(node->bounds);
+        const int32 child_index = octree_child_index_from_coord(center, node_coord);
         if (node->child[child_index] == NULL) {
-            const v3_int32 center = aabb_center(node->bounds);
             node->child[child_index] = octnode_child_create(tree);
             node->child[child_index]->bounds = octnode_child_aabb_compute(node->bounds, center, child_index);
             node->child[child_index]->coord = octnode_child_anchor_compute(node->bounds.min, center, child_index);
-        }
 
-        if (node->child[child_index]->bounds.max.x - node->child[child_index]->bounds.min.x <= tree->leaf_size) {
-            node->data = data;
+            // The smallest node size is reached, this is where the data goes
+            node->child[child_index]->is_leaf = node->child[child_index]->bounds.max.x - node->child[child_index]->bounds.min.x <= tree->leaf_size;
         }
 
         node = node->child[child_index];
     }
 
-    node->is_leaf = true;
     node->has_data = true;
+    node->data = data;
 }
 
 // Removes node and all children
@@ -233,7 +233,7 @@ bool octnode_remove_recursive(OctNode* const node, const v3_int32& coord) NO_EXC
     }
 
     // Find which child to descend into, if the current node is not the correct final destination
-    const int32 child_index = octree_child_index_from_coord(node->coord, coord);
+    const int32 child_index = octree_child_index_from_coord(aabb_center(node->bounds), coord);
     OctNode* child = node->child[child_index];
     if (!child) {
         return false;
@@ -284,7 +284,7 @@ bool octnode_remove_recursive(OctNode* const node, const void* const data, const
     }
 
     // Find which child to descend into, if the current node is not the correct final destination
-    const int32 child_index = octree_child_index_from_coord(node->coord, data_coord);
+    const int32 child_index = octree_child_index_from_coord(aabb_center(node->bounds), data_coord);
     OctNode* child = node->child[child_index];
     if (!child) {
         return false;
@@ -0,0 +1,191 @@
+#include "../TestFramework.h"
+#include "../../database/DatabasePool.h"
+
+#define DB_POOL_TEST_WAITERS 3
+
+struct DatabasePoolTestWaiter {
+    DatabasePool* pool;
+    int32 index;
+    int32 id;
+};
+
+// Order in which the waiting threads received their connection
+static int32 _db_pool_test_order[DB_POOL_TEST_WAITERS];
+static int32 _db_pool_test_served;
+
+static void db_pool_test_create(DatabasePool* pool, uint8 count) {
+    *pool = {};
+    db_pool_alloc(pool, count);
+
+    for (int32 i = 0; i < count; ++i) {
+        DatabaseConnection db = {};
+        db.type = DB_TYPE_SQLITE;
+        db.host = ":memory:";
+
+        TEST_EQUALS(db_open(&db), 1);
+        db_pool_add(pool, &db);
+    }
+}
+
+static THREAD_RETURN db_pool_test_waiter(void* arg) {
+    DatabasePoolTestWaiter* waiter = (DatabasePoolTestWaiter *) arg;
+
+    DatabaseConnection* db = db_pool_get_wait(waiter->pool, 10000000);
+    waiter->id = db ? (int32) db->id : -1;
+
+    // Only one connection exists -> only one thread at a time can get here
+    _db_pool_test_order[atomic_get_acquire(&_db_pool_test_served)] = waiter->index;
+    atomic_increment_release(&_db_pool_test_served);
+
+    return 0;
+}
+
+static void db_pool_test_wait_until(int32* value, int32 expected) {
+    for (int32 i = 0; i < 10000 && atomic_get_acquire(value) != expected; ++i) {
+        usleep(1000);
+    }
+}
+
+static void test_db_pool_get_release() {
+    DatabasePool pool;
+    db_pool_test_create(&pool, 2);
+
+    DatabaseConnection* db1 = db_pool_get(&pool);
+    DatabaseConnection* db2 = db_pool_get(&pool);
+    TEST_TRUE(db1 != NULL);
+    TEST_TRUE(db2 != NULL);
+    TEST_TRUE(db1 != db2);
+    TEST_TRUE(db_pool_get(&pool) == NULL);
+
+    db_pool_release(&pool, db1->id);
+    TEST_EQUALS(db_pool_get(&pool), db1);
+    TEST_EQUALS(pool.metrics.acquired, 3);
+
+    db_pool_release(&pool, db1->id);
+    db_pool_release(&pool, db2->id);
+    db_pool_free(&pool);
+}
+
+static void test_db_pool_get_wait_timeout() {
+    DatabasePool pool;
+    db_pool_test_create(&pool, 1);
+
+    DatabaseConnection* db = db_pool_get(&pool);
+    TEST_TRUE(db != NULL);
+
+    TEST_TRUE(db_pool_get_wait(&pool, 20000) == NULL);
+    TEST_EQUALS(pool.metrics.timeouts, 1);
+    TEST_EQUALS(pool.metrics.waited, 1);
+    TEST_TRUE(pool.metrics.max_wait_time >= 20000);
+
+    // The timed out thread removed itself from the queue
+    TEST_EQUALS(pool.waiting, 0);
+    TEST_TRUE(pool.wait_head == NULL);
+    TEST_TRUE(pool.wait_tail == NULL);
+
+    db_pool_release(&pool, db->id);
+    TEST_EQUALS(db_pool_get_wait(&pool, 20000), db);
+
+    db_pool_release(&pool, db->id);
+    db_pool_free(&pool);
+}
+
+static void test_db_pool_get_wait_fifo() {
+    DatabasePool pool;
+    db_pool_test_create(&pool, 1);
+
+    DatabaseConnection* db = db_pool_get(&pool);
+    TEST_TRUE(db != NULL);
+
+    _db_pool_test_served = 0;
+
+    // The threads are started one after another, every thread must be queued before the next one starts
+    coms_pthread_t threads[DB_POOL_TEST_WAITERS];
+    DatabasePoolTestWaiter waiters[DB_POOL_TEST_WAITERS];
+    for (int32 i = 0; i < DB_POOL_TEST_WAITERS; ++i) {
+        waiters[i] = {&pool, i, -2};
+        coms_pthread_create(&threads[i], NULL, db_pool_test_waiter, &waiters[i]);
+        db_pool_test_wait_until(&pool.waiting, i + 1);
+    }
+
+    TEST_EQUALS(pool.waiting, DB_POOL_TEST_WAITERS);
+
+    bool is_handed_off = true;
+    // Every waiter keeps the connection, the main thread releases it on its behalf
+    for (int32 i = 0; i < DB_POOL_TEST_WAITERS; ++i) {
+        db_pool_release(&pool, db->id);
+
+        // The released connection went directly to the oldest waiter and never became free
+        is_handed_off &= (pool.free[0] & 1ULL) != 0;
+        is_handed_off &= db_pool_get(&pool) == NULL;
+
+        db_pool_test_wait_until(&_db_pool_test_served, i + 1);
+    }
+
+    TEST_TRUE(is_handed_off);
+    TEST_EQUALS(_db_pool_test_served, DB_POOL_TEST_WAITERS);
+    TEST_EQUALS(pool.waiting, 0);
+
+    for (int32 i = 0; i < DB_POOL_TEST_WAITERS; ++i) {
+        coms_pthread_join(threads[i], NULL);
+
+        TEST_EQUALS(_db_pool_test_order[i], i);
+        TEST_EQUALS(waiters[i].id, (int32) db->id);
+    }
+
+    TEST_EQUALS(pool.metrics.timeouts, 0);
+    TEST_EQUALS(pool.metrics.waited, DB_POOL_TEST_WAITERS);
+
+    // The last waiter still holds the connection
+    db_pool_release(&pool, db->id);
+    TEST_EQUALS(db_pool_get(&pool), db);
+
+    db_pool_release(&pool, db->id);
+    db_pool_free(&pool);
+}
+
+static void test_db_pool_reconnect() {
+    DatabasePool pool;
+    db_pool_test_create(&pool, 1);
+
+    // Connection lost while idle
+    db_close(&pool.connections[0]);
+    TEST_FALSE(db_is_alive(&pool.connections[0]));
+
+    // Recently used connections aren't checked
+    DatabaseConnection* db = db_pool_get(&pool);
+    TEST_FALSE(db_is_alive(db));
+    TEST_EQUALS(pool.metrics.reconnects, 0);
+    db_pool_release(&pool, db->id);
+
+    pool.last_used[0] = time_mu() - DB_POOL_HEALTH_CHECK_INTERVAL;
+
+    db = db_pool_get(&pool);
+    TEST_TRUE(db != NULL);
+    TEST_TRUE(db_is_alive(db));
+    TEST_EQUALS(pool.metrics.reconnects, 1);
+    TEST_EQUALS(db_execute_sqlite(db, "CREATE TABLE item (id INTEGER PRIMARY KEY)"), 1);
+
+    db_pool_release(&pool, db->id);
+    db_pool_free(&pool);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main DatabasePoolTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_db_pool_get_release);
+    TEST_RUN(test_db_pool_get_wait_timeout);
+    TEST_RUN(test_db_pool_get_wait_fifo);
+    TEST_RUN(test_db_pool_reconnect);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include "../TestFramework.h"
+#include "../../database/sqlite/SqliteDatabase.h"
+
+enum SqliteTestQuery {
+    SQLITE_TEST_QUERY_INSERT,
+    SQLITE_TEST_QUERY_SELECT,
+    SQLITE_TEST_QUERY_COUNT,
+};
+
+static void sqlite_test_open(DatabaseConnection* db) {
+    memset(db, 0, sizeof(DatabaseConnection));
+    db->type = DB_TYPE_SQLITE;
+    db->host = ":memory:";
+
+    TEST_EQUALS(db_open_sqlite(db), 1);
+    TEST_EQUALS(db_execute_sqlite(db, "CREATE TABLE item (id INTEGER PRIMARY KEY, name TEXT, value REAL)"), 1);
+}
+
+static void test_db_open_close_sqlite() {
+    DatabaseConnection db;
+    sqlite_test_open(&db);
+    TEST_TRUE(db_is_alive_sqlite(&db));
+
+    db_close_sqlite(&db);
+    TEST_FALSE(db_is_alive_sqlite(&db));
+}
+
+static void test_db_prepare_sqlite_cache() {
+    DatabaseConnection db;
+    sqlite_test_open(&db);
+
+    const char* query = "INSERT INTO item (id, name, value) VALUES (?, ?, ?)";
+    sqlite3_stmt* stmt = db_prepare_sqlite(&db, SQLITE_TEST_QUERY_INSERT, query);
+    TEST_TRUE(stmt != NULL);
+
+    // The second call must return the cached statement
+    TEST_EQUALS(db_prepare_sqlite(&db, SQLITE_TEST_QUERY_INSERT, query), stmt);
+
+    DbParam params[] = {DB_INT32(1), DB_TEXT("sword"), DB_F64(2.5)};
+    TEST_EQUALS(db_execute_prepared_sqlite(&db, SQLITE_TEST_QUERY_INSERT, query, params, ARRAY_COUNT(params)), 1);
+
+    // Duplicate primary key
+    TEST_EQUALS(db_execute_prepared_sqlite(&db, SQLITE_TEST_QUERY_INSERT, query, params, ARRAY_COUNT(params)), -1);
+
+    db_close_sqlite(&db);
+}
+
+static void test_db_insert_batch_sqlite() {
+    DatabaseConnection db;
+    sqlite_test_open(&db);
+
+    // More rows than one batch
+    const int32 row_count = DB_SQLITE_BATCH_SIZE * 2 + 10;
+    DbParam* params = (DbParam *) calloc(row_count * 3, sizeof(DbParam));
+    for (int32 i = 0; i < row_count; ++i) {
+        params[i * 3 + 0].type = DB_PARAM_INT32;
+        params[i * 3 + 0].int32_val = i;
+        params[i * 3 + 1].type = DB_PARAM_TEXT;
+        params[i * 3 + 1].text_val = "item";
+        params[i * 3 + 2].type = DB_PARAM_F64;
+        params[i * 3 + 2].f64_val = i * 0.5;
+    }
+
+    TEST_EQUALS(
+        db_insert_batch_sqlite(
+            &db, SQLITE_TEST_QUERY_INSERT,
+            "INSERT INTO item (id, name, value) VALUES (?, ?, ?)",
+            params, 3, row_count
+        ),
+        row_count
+    );
+    TEST_EQUALS(db_con_sqlite(&db)->transaction_depth, 0);
+
+    sqlite3_stmt* stmt = db_query_sqlite(&db, SQLITE_TEST_QUERY_COUNT, "SELECT COUNT(*), SUM(value) FROM item", NULL, 0);
+    TEST_TRUE(db_row_next_sqlite(stmt));
+    TEST_EQUALS(db_column_int32_sqlite(stmt, 0), row_count);
+    TEST_EQUALS(db_column_f64_sqlite(stmt, 1), (row_count - 1) * row_count * 0.25);
+    db_query_end_sqlite(stmt);
+
+    // A failing row rolls back its batch
+    params[0].int32_val = row_count;
+    params[3].int32_val = row_count;
+    TEST_EQUALS(
+        db_insert_batch_sqlite(
+            &db, SQLITE_TEST_QUERY_INSERT,
+            "INSERT INTO item (id, name, value) VALUES (?, ?, ?)",
+            params, 3, 2
+        ),
+        0
+    );
+    TEST_EQUALS(db_con_sqlite(&db)->transaction_depth, 0);
+
+    stmt = db_query_sqlite(&db, SQLITE_TEST_QUERY_COUNT, NULL, NULL, 0);
+    TEST_TRUE(db_row_next_sqlite(stmt));
+    TEST_EQUALS(db_column_int32_sqlite(stmt, 0), row_count);
+    db_query_end_sqlite(stmt);
+
+    free(params);
+    db_close_sqlite(&db);
+}
+
+static void test_db_transaction_sqlite() {
+    DatabaseConnection db;
+    sqlite_test_open(&db);
+
+    TEST_EQUALS(db_transaction_begin_sqlite(&db), 1);
+    TEST_EQUALS(db_transaction_begin_sqlite(&db), 1);
+    TEST_EQUALS(db_con_sqlite(&db)->transaction_depth, 2);
+
+    TEST_EQUALS(db_transaction_commit_sqlite(&db), 1);
+    TEST_EQUALS(db_transaction_commit_sqlite(&db), 1);
+    TEST_EQUALS(db_con_sqlite(&db)->transaction_depth, 0);
+
+    // A failing BEGIN (here: a transaction started outside of the helpers) isn't counted
+    TEST_EQUALS(db_execute_sqlite(&db, "BEGIN"), 1);
+    TEST_EQUALS(db_transaction_begin_sqlite(&db), -1);
+    TEST_EQUALS(db_con_sqlite(&db)->transaction_depth, 0);
+    TEST_EQUALS(db_execute_sqlite(&db, "COMMIT"), 1);
+
+    // The next begin starts a real transaction again
+    TEST_EQUALS(db_transaction_begin_sqlite(&db), 1);
+    TEST_EQUALS(db_con_sqlite(&db)->transaction_depth, 1);
+    TEST_FALSE(sqlite3_get_autocommit(db_con_sqlite(&db)->db));
+    TEST_EQUALS(db_transaction_commit_sqlite(&db), 1);
+
+    db_close_sqlite(&db);
+}
+
+static void test_db_query_sqlite() {
+    DatabaseConnection db;
+    sqlite_test_open(&db);
+
+    DbParam params[] = {
+        DB_INT32(1), DB_TEXT("sword"), DB_F64(1.0),
+        DB_INT32(2), DB_TEXT("shield"), DB_F64(2.0),
+        DB_INT32(3), DB_TEXT("bow"), DB_F64(3.0),
+    };
+    db_insert_batch_sqlite(
+        &db, SQLITE_TEST_QUERY_INSERT,
+        "INSERT INTO item (id, name, value) VALUES (?, ?, ?)",
+        params, 3, 3
+    );
+
+    DbParam where[] = {DB_F64(1.5)};
+    sqlite3_stmt* stmt = db_query_sqlite(
+        &db, SQLITE_TEST_QUERY_SELECT,
+        "SELECT id, name FROM item WHERE value > ? ORDER BY id",
+        where, ARRAY_COUNT(where)
+    );
+
+    int32 length;
+    TEST_TRUE(db_row_next_sqlite(stmt));
+    TEST_EQUALS(db_column_int64_sqlite(stmt, 0), 2);
+    const char* name = db_column_text_sqlite(stmt, 1, &length);
+    TEST_EQUALS(length, 6);
+    TEST_EQUALS(memcmp(name, "shield", 6), 0);
+
+    TEST_TRUE(db_row_next_sqlite(stmt));
+    TEST_EQUALS(db_column_int64_sqlite(stmt, 0), 3);
+    TEST_FALSE(db_column_is_null_sqlite(stmt, 1));
+
+    TEST_FALSE(db_row_next_sqlite(stmt));
+    db_query_end_sqlite(stmt);
+
+    db_close_sqlite(&db);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main SqliteDatabaseTest
+#endif
+
+int main() {
+    TEST_INIT(50);
+
+    TEST_RUN(test_db_open_close_sqlite);
+    TEST_RUN(test_db_prepare_sqlite_cache);
+    TEST_RUN(test_db_insert_batch_sqlite);
+    TEST_RUN(test_db_transaction_sqlite);
+    TEST_RUN(test_db_query_sqlite);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include "../../TestFramework.h"
+#include "../../../entity/voxel/VoxelGenerator.h"
+
+#define VOXEL_GENERATOR_TEST_SEED 1337
+
+struct VoxelGeneratorTestUploads {
+    int32 count;
+    v3_int32 coords[32];
+};
+
+static void voxel_generator_test_upload(VoxelChunk* chunk, void* data) {
+    VoxelGeneratorTestUploads* uploads = (VoxelGeneratorTestUploads *) data;
+    uploads->coords[uploads->count++] = chunk->coord;
+}
+
+// Generates the 3x1x3 chunks around the camera chunk
+static void voxel_generator_test_create(VoxelWorld* vw, VoxelGenerator* gen, ThreadPool* pool, int32 chunk_count) {
+    memset(vw, 0, sizeof(*vw));
+    voxel_world_alloc(vw, {0, 0, 0}, chunk_count);
+
+    VoxelTerrainSettings settings;
+    voxel_terrain_settings_default(&settings, VOXEL_GENERATOR_TEST_SEED);
+
+    voxel_generator_alloc(gen, vw, pool, &settings, 8, 4);
+    gen->view_distance = 1;
+    gen->chunk_y_min = 0;
+    gen->chunk_y_max = 0;
+}
+
+static int32 voxel_generator_test_job_count(const VoxelGenerator* gen) {
+    int32 count = 0;
+    for (int32 i = 0; i < gen->job_count; ++i) {
+        count += gen->jobs[i].chunk_id >= 0;
+    }
+
+    return count;
+}
+
+// Only the closest max_jobs chunks are in the pipeline
+static void test_voxel_generator_priority() {
+    VoxelWorld vw;
+    VoxelGenerator gen;
+    voxel_generator_test_create(&vw, &gen, NULL, 16);
+
+    TEST_EQUALS(voxel_generator_update(&gen, {16.0f, 16.0f, 16.0f}), 4);
+    TEST_EQUALS(voxel_generator_test_job_count(&gen), 4);
+
+    bool is_closest = true;
+    for (int32 i = 0; i < gen.job_count; ++i) {
+        if (gen.jobs[i].chunk_id >= 0) {
+            is_closest &= gen.jobs[i].dist2 <= 1;
+        }
+    }
+
+    TEST_TRUE(is_closest);
+    TEST_TRUE(voxel_world_chunk_get(&vw.map, 0, 0, 0) != NULL);
+    TEST_TRUE(voxel_world_chunk_get(&vw.map, 1, 0, 1) == NULL);
+
+    // The chunks are not visible to the world until they are uploaded
+    TEST_EQUALS(voxel_world_map_get(&vw.map, {0, 0, 0}, 0, 0, 0).type, 0);
+
+    voxel_generator_free(&gen);
+    voxel_world_free(&vw);
+}
+
+static void test_voxel_generator_upload() {
+    VoxelWorld vw;
+    VoxelGenerator gen;
+    voxel_generator_test_create(&vw, &gen, NULL, 16);
+
+    VoxelGeneratorTestUploads uploads = {};
+    gen.upload = voxel_generator_test_upload;
+    gen.upload_data = &uploads;
+    gen.max_uploads = 1;
+
+    bool is_limited = true;
+    int32 pending;
+    do {
+        const int32 before = uploads.count;
+        pending = voxel_generator_update(&gen, {16.0f, 16.0f, 16.0f});
+        is_limited &= uploads.count - before <= 1;
+    } while (pending);
+
+    TEST_TRUE(is_limited);
+    TEST_EQUALS(uploads.count, 9);
+    TEST_EQUALS(gen.stats.chunks_generated, 9);
+    TEST_EQUALS(gen.stats.chunks_canceled, 0);
+
+    bool is_generated = true;
+    for (int32 z = -1; z <= 1; ++z) {
+        for (int32 x = -1; x <= 1; ++x) {
+            const VoxelChunk* chunk = voxel_world_chunk_get(&vw.map, x, 0, z);
+            is_generated &= chunk && !(chunk->flag & VOXEL_CHUNK_FLAG_IS_GENERATING);
+        }
+    }
+
+    TEST_TRUE(is_generated);
+
+    // Nothing left to do
+    TEST_EQUALS(voxel_generator_update(&gen, {16.0f, 16.0f, 16.0f}), 0);
+    TEST_EQUALS(uploads.count, 9);
+
+    voxel_generator_free(&gen);
+    voxel_world_free(&vw);
+}
+
+// Chunks that leave the view distance are removed from the pipeline and their memory is reused
+static void test_voxel_generator_cancel() {
+    VoxelWorld vw;
+    VoxelGenerator gen;
+
+    // Not enough chunk memory for the canceled and the new chunks
+    voxel_generator_test_create(&vw, &gen, NULL, 12);
+
+    TEST_EQUALS(voxel_generator_update(&gen, {16.0f, 16.0f, 16.0f}), 4);
+
+    const v3_f32 camera = {100.0f * VOXEL_CHUNK_SIZE + 16.0f, 16.0f, 16.0f};
+    voxel_generator_update(&gen, camera);
+
+    TEST_EQUALS(gen.stats.chunks_canceled, 4);
+    TEST_TRUE(voxel_world_chunk_get(&vw.map, 0, 0, 0) == NULL);
+    TEST_TRUE(voxel_world_chunk_get(&vw.map, 100, 0, 0) != NULL);
+
+    while (voxel_generator_update(&gen, camera)) {}
+
+    TEST_EQUALS(gen.stats.chunks_generated, 9);
+    TEST_EQUALS(gen.stats.chunks_canceled, 4);
+
+    voxel_generator_free(&gen);
+    voxel_world_free(&vw);
+}
+
+// The result doesn't depend on the thread pool
+static void test_voxel_generator_thread_pool() {
+    ThreadPool pool = {};
+    thread_pool_alloc(&pool, 4, 64);
+
+    VoxelWorld vw;
+    VoxelGenerator gen;
+    voxel_generator_test_create(&vw, &gen, &pool, 16);
+
+    while (voxel_generator_update(&gen, {16.0f, 16.0f, 16.0f})) {}
+    TEST_EQUALS(gen.stats.chunks_generated, 9);
+
+    VoxelChunk* expected = (VoxelChunk *) calloc(1, sizeof(VoxelChunk));
+
+    bool is_same = true;
+    for (int32 z = -1; z <= 1; ++z) {
+        for (int32 x = -1; x <= 1; ++x) {
+            memset(expected, 0, sizeof(VoxelChunk));
+            voxel_chunk_init(expected, x, 0, z);
+            voxel_terrain_density(expected, &gen.settings);
+            voxel_terrain_structures(expected, &gen.settings);
+
+            const VoxelChunk* chunk = voxel_world_chunk_get(&vw.map, x, 0, z);
+            is_same &= chunk && memcmp(chunk->vox, expected->vox, sizeof(expected->vox)) == 0;
+        }
+    }
+
+    TEST_TRUE(is_same);
+
+    free(expected);
+    voxel_generator_free(&gen);
+    voxel_world_free(&vw);
+    thread_pool_destroy(&pool);
+}
+
+static void test_voxel_generator_benchmark() {
+    VoxelWorld vw;
+    VoxelGenerator gen;
+    voxel_generator_test_create(&vw, &gen, NULL, 16);
+
+    VoxelGeneratorBenchmarkStats stats;
+    voxel_generator_benchmark(&gen, {16.0f, 16.0f, 16.0f}, &stats);
+
+    TEST_EQUALS(stats.chunk_count, 9);
+    TEST_TRUE(stats.update_count > 0);
+    TEST_TRUE(stats.chunks_per_second >= 0.0);
+
+    voxel_generator_free(&gen);
+    voxel_world_free(&vw);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main VoxelGeneratorTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_voxel_generator_priority);
+    TEST_RUN(test_voxel_generator_upload);
+    TEST_RUN(test_voxel_generator_cancel);
+    TEST_RUN(test_voxel_generator_thread_pool);
+    TEST_RUN(test_voxel_generator_benchmark);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
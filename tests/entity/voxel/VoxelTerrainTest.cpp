@@ -0,0 +1,244 @@
+#include "../../TestFramework.h"
+#include "../../../entity/voxel/VoxelTerrain.h"
+
+#define VOXEL_TERRAIN_TEST_SEED 1337
+
+// Region of 3x2x3 chunks used for the seam tests
+#define VOXEL_TERRAIN_TEST_REGION_X (3 * VOXEL_CHUNK_SIZE)
+#define VOXEL_TERRAIN_TEST_REGION_Y (2 * VOXEL_CHUNK_SIZE)
+#define VOXEL_TERRAIN_TEST_REGION_Z (3 * VOXEL_CHUNK_SIZE)
+
+static void voxel_terrain_test_generate(VoxelChunk* chunk, const VoxelTerrainSettings* settings, int32 x, int32 y, int32 z) {
+    voxel_chunk_init(chunk, x, y, z);
+    voxel_terrain_density(chunk, settings);
+    voxel_terrain_structures(chunk, settings);
+}
+
+// Finds a forest column, otherwise there are no trees to test
+static v2_int32 voxel_terrain_test_forest(const VoxelTerrainSettings* settings) {
+    for (int32 z = 0; z < 64 * 64; z += 64) {
+        for (int32 x = 0; x < 64 * 64; x += 64) {
+            if (voxel_terrain_column(settings, x, z).biome == VOXEL_TERRAIN_BIOME_FOREST) {
+                return {x, z};
+            }
+        }
+    }
+
+    return {0, 0};
+}
+
+static void test_voxel_terrain_deterministic() {
+    VoxelTerrainSettings settings;
+    voxel_terrain_settings_default(&settings, VOXEL_TERRAIN_TEST_SEED);
+
+    VoxelChunk* a = (VoxelChunk *) calloc(1, sizeof(VoxelChunk));
+    VoxelChunk* b = (VoxelChunk *) calloc(1, sizeof(VoxelChunk));
+
+    voxel_terrain_test_generate(a, &settings, 3, 1, -2);
+    voxel_terrain_test_generate(b, &settings, 3, 1, -2);
+    TEST_EQUALS(memcmp(a->vox, b->vox, sizeof(a->vox)), 0);
+
+    // Different seed -> different terrain
+    voxel_terrain_settings_default(&settings, VOXEL_TERRAIN_TEST_SEED + 1);
+    voxel_terrain_test_generate(b, &settings, 3, 1, -2);
+    TEST_NOT_EQUALS(memcmp(a->vox, b->vox, sizeof(a->vox)), 0);
+
+    free(a);
+    free(b);
+}
+
+static void test_voxel_terrain_density() {
+    VoxelTerrainSettings settings;
+    voxel_terrain_settings_default(&settings, VOXEL_TERRAIN_TEST_SEED);
+
+    VoxelChunk* chunk = (VoxelChunk *) calloc(1, sizeof(VoxelChunk));
+
+    // Far above the terrain
+    voxel_chunk_init(chunk, 0, 10, 0);
+    TEST_EQUALS(voxel_terrain_density(chunk, &settings), 0);
+
+    // Far below the terrain there are only stone and caves
+    voxel_chunk_init(chunk, 0, -2, 0);
+    const int32 solid_count = voxel_terrain_density(chunk, &settings);
+    TEST_TRUE(solid_count > 0);
+    TEST_TRUE(solid_count < VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE);
+
+    // The chunk matches the column heights
+    const int32 cy = floor_div(voxel_terrain_column(&settings, 16, 16).height, VOXEL_CHUNK_SIZE);
+    voxel_terrain_test_generate(chunk, &settings, 0, cy, 0);
+
+    bool is_valid = true;
+    for (int32 z = 0; z < VOXEL_CHUNK_SIZE; ++z) {
+        for (int32 x = 0; x < VOXEL_CHUNK_SIZE; ++x) {
+            const int32 height = voxel_terrain_column(&settings, x, z).height;
+
+            for (int32 y = 0; y < VOXEL_CHUNK_SIZE; ++y) {
+                const int32 world_y = cy * VOXEL_CHUNK_SIZE + y;
+                const uint16 type = voxel_chunk_get(chunk, x, y, z).type;
+
+                if (world_y == height) {
+                    is_valid &= type != VOXEL_TERRAIN_TYPE_AIR;
+                } else if (world_y > height) {
+                    is_valid &= type == VOXEL_TERRAIN_TYPE_AIR
+                        || type == VOXEL_TERRAIN_TYPE_WOOD
+                        || type == VOXEL_TERRAIN_TYPE_LEAVES;
+                }
+            }
+        }
+    }
+
+    TEST_TRUE(is_valid);
+
+    free(chunk);
+}
+
+static void test_voxel_terrain_seams() {
+    VoxelTerrainSettings settings;
+    voxel_terrain_settings_default(&settings, VOXEL_TERRAIN_TEST_SEED);
+    settings.tree_density = 1.0f;
+
+    const v2_int32 forest = voxel_terrain_test_forest(&settings);
+    const int32 cx = floor_div(forest.x, VOXEL_CHUNK_SIZE) - 1;
+    const int32 cz = floor_div(forest.y, VOXEL_CHUNK_SIZE) - 1;
+    const int32 cy = floor_div(voxel_terrain_column(&settings, forest.x, forest.y).height, VOXEL_CHUNK_SIZE);
+
+    VoxelChunk* chunk = (VoxelChunk *) calloc(1, sizeof(VoxelChunk));
+    uint16* region = (uint16 *) calloc(
+        VOXEL_TERRAIN_TEST_REGION_X * VOXEL_TERRAIN_TEST_REGION_Y * VOXEL_TERRAIN_TEST_REGION_Z,
+        sizeof(uint16)
+    );
+
+    // Every chunk is generated independently
+    int32 tree_count = 0;
+    for (int32 z = 0; z < 3; ++z) {
+        for (int32 y = 0; y < 2; ++y) {
+            for (int32 x = 0; x < 3; ++x) {
+                voxel_chunk_init(chunk, cx + x, cy + y, cz + z);
+                voxel_terrain_density(chunk, &settings);
+                tree_count += voxel_terrain_structures(chunk, &settings);
+
+                for (int32 i = 0; i < VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE; ++i) {
+                    const int32 rx = x * VOXEL_CHUNK_SIZE + i % VOXEL_CHUNK_SIZE;
+                    const int32 ry = y * VOXEL_CHUNK_SIZE + (i / VOXEL_CHUNK_SIZE) % VOXEL_CHUNK_SIZE;
+                    const int32 rz = z * VOXEL_CHUNK_SIZE + i / (VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE);
+
+                    region[(rz * VOXEL_TERRAIN_TEST_REGION_Y + ry) * VOXEL_TERRAIN_TEST_REGION_X + rx] = chunk->vox[i].type;
+                }
+            }
+        }
+    }
+
+    TEST_TRUE(tree_count > 0);
+
+    #define VOXEL_TERRAIN_TEST_REGION_GET(x, y, z) \
+        region[((z) * VOXEL_TERRAIN_TEST_REGION_Y + (y)) * VOXEL_TERRAIN_TEST_REGION_X + (x)]
+
+    // Every tree top in the center column of chunks must have leaves on all sides
+    // If a neighboring chunk didn't place the leaves of a tree anchored in another chunk we would find air
+    int32 top_count = 0;
+    bool is_valid = true;
+    for (int32 z = VOXEL_CHUNK_SIZE; z < 2 * VOXEL_CHUNK_SIZE; ++z) {
+        for (int32 y = 0; y < VOXEL_TERRAIN_TEST_REGION_Y - 1; ++y) {
+            for (int32 x = VOXEL_CHUNK_SIZE; x < 2 * VOXEL_CHUNK_SIZE; ++x) {
+                if (VOXEL_TERRAIN_TEST_REGION_GET(x, y, z) != VOXEL_TERRAIN_TYPE_WOOD
+                    || VOXEL_TERRAIN_TEST_REGION_GET(x, y + 1, z) == VOXEL_TERRAIN_TYPE_WOOD
+                ) {
+                    continue;
+                }
+
+                ++top_count;
+                is_valid &= VOXEL_TERRAIN_TEST_REGION_GET(x, y + 1, z) != VOXEL_TERRAIN_TYPE_AIR;
+                is_valid &= VOXEL_TERRAIN_TEST_REGION_GET(x + VOXEL_TERRAIN_TREE_RADIUS, y, z) != VOXEL_TERRAIN_TYPE_AIR;
+                is_valid &= VOXEL_TERRAIN_TEST_REGION_GET(x - VOXEL_TERRAIN_TREE_RADIUS, y, z) != VOXEL_TERRAIN_TYPE_AIR;
+                is_valid &= VOXEL_TERRAIN_TEST_REGION_GET(x, y, z + VOXEL_TERRAIN_TREE_RADIUS) != VOXEL_TERRAIN_TYPE_AIR;
+                is_valid &= VOXEL_TERRAIN_TEST_REGION_GET(x, y, z - VOXEL_TERRAIN_TREE_RADIUS) != VOXEL_TERRAIN_TYPE_AIR;
+            }
+        }
+    }
+
+    TEST_TRUE(top_count > 0);
+    TEST_TRUE(is_valid);
+
+    // Every leaf in the center column of chunks belongs to a trunk, even if the trunk is in another chunk
+    is_valid = true;
+    for (int32 z = VOXEL_CHUNK_SIZE; z < 2 * VOXEL_CHUNK_SIZE; ++z) {
+        for (int32 y = 0; y < VOXEL_TERRAIN_TEST_REGION_Y; ++y) {
+            for (int32 x = VOXEL_CHUNK_SIZE; x < 2 * VOXEL_CHUNK_SIZE; ++x) {
+                if (VOXEL_TERRAIN_TEST_REGION_GET(x, y, z) != VOXEL_TERRAIN_TYPE_LEAVES) {
+                    continue;
+                }
+
+                bool has_trunk = false;
+                for (int32 dz = -VOXEL_TERRAIN_TREE_RADIUS; dz <= VOXEL_TERRAIN_TREE_RADIUS && !has_trunk; ++dz) {
+                    for (int32 dx = -VOXEL_TERRAIN_TREE_RADIUS; dx <= VOXEL_TERRAIN_TREE_RADIUS && !has_trunk; ++dx) {
+                        for (int32 dy = -1; dy <= VOXEL_TERRAIN_TREE_RADIUS && !has_trunk; ++dy) {
+                            const int32 ry = y + dy;
+                            if (ry < 0 || ry >= VOXEL_TERRAIN_TEST_REGION_Y) {
+                                continue;
+                            }
+
+                            has_trunk = VOXEL_TERRAIN_TEST_REGION_GET(x + dx, ry, z + dz) == VOXEL_TERRAIN_TYPE_WOOD;
+                        }
+                    }
+                }
+
+                is_valid &= has_trunk;
+            }
+        }
+    }
+
+    TEST_TRUE(is_valid);
+
+    #undef VOXEL_TERRAIN_TEST_REGION_GET
+
+    free(region);
+    free(chunk);
+}
+
+#if PERFORMANCE_TEST
+static void _voxel_terrain_density(MAYBE_UNUSED volatile void* val) {
+    static VoxelChunk chunk;
+    VoxelTerrainSettings settings;
+    voxel_terrain_settings_default(&settings, VOXEL_TERRAIN_TEST_SEED);
+
+    voxel_chunk_init(&chunk, 0, 0, 0);
+    voxel_terrain_density(&chunk, &settings);
+}
+
+static void _voxel_terrain_structures(MAYBE_UNUSED volatile void* val) {
+    static VoxelChunk chunk;
+    VoxelTerrainSettings settings;
+    voxel_terrain_settings_default(&settings, VOXEL_TERRAIN_TEST_SEED);
+
+    voxel_chunk_init(&chunk, 0, 0, 0);
+    voxel_terrain_structures(&chunk, &settings);
+}
+
+static void test_voxel_terrain_performance() {
+    // Structures are expected to be much cheaper than the density sampling
+    COMPARE_FUNCTION_TEST_TIME(_voxel_terrain_structures, _voxel_terrain_density, 50.0);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main VoxelTerrainTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_voxel_terrain_deterministic);
+    TEST_RUN(test_voxel_terrain_density);
+    TEST_RUN(test_voxel_terrain_seams);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_voxel_terrain_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
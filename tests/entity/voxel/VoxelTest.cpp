@@ -0,0 +1,126 @@
+#include "../../TestFramework.h"
+#include "../../../entity/voxel/Voxel.h"
+
+// Checks that every triangle of the mesh faces away from the voxel center (x, y, z) + 0.5
+static bool voxel_test_mesh_faces_outside(const VoxelChunk* chunk, int32 x, int32 y, int32 z) {
+    const v3_f32 center = {
+        chunk->coord.x * VOXEL_CHUNK_SIZE + x + 0.5f,
+        chunk->coord.y * VOXEL_CHUNK_SIZE + y + 0.5f,
+        chunk->coord.z * VOXEL_CHUNK_SIZE + z + 0.5f
+    };
+
+    bool is_valid = true;
+    for (uint32 i = 0; i < chunk->mesh.num_indices; i += 3) {
+        const v3_f32 a = chunk->mesh.vertices[chunk->mesh.indices[i]];
+        const v3_f32 b = chunk->mesh.vertices[chunk->mesh.indices[i + 1]];
+        const v3_f32 c = chunk->mesh.vertices[chunk->mesh.indices[i + 2]];
+
+        const v3_f32 ab = {b.x - a.x, b.y - a.y, b.z - a.z};
+        const v3_f32 ac = {c.x - a.x, c.y - a.y, c.z - a.z};
+        const v3_f32 n = {
+            ab.y * ac.z - ab.z * ac.y,
+            ab.z * ac.x - ab.x * ac.z,
+            ab.x * ac.y - ab.y * ac.x
+        };
+
+        const v3_f32 out = {
+            (a.x + b.x + c.x) / 3.0f - center.x,
+            (a.y + b.y + c.y) / 3.0f - center.y,
+            (a.z + b.z + c.z) / 3.0f - center.z
+        };
+
+        is_valid &= n.x * out.x + n.y * out.y + n.z * out.z > 0.0f;
+    }
+
+    return is_valid;
+}
+
+static void test_voxel_chunk_mesh_single() {
+    VoxelChunk* chunk = (VoxelChunk *) calloc(1, sizeof(VoxelChunk));
+    voxel_chunk_init(chunk, 1, 0, -1);
+
+    voxel_chunk_set(chunk, 5, 6, 7, {1, 0});
+    voxel_chunk_mesh_build(chunk);
+
+    // 6 quads
+    TEST_EQUALS(chunk->mesh.num_vertices, 6 * 4);
+    TEST_EQUALS(chunk->mesh.num_indices, 6 * 6);
+    TEST_FALSE(chunk->flag & VOXEL_CHUNK_FLAG_IS_CHANGED);
+
+    // All faces lie on the voxel bounds
+    bool is_inside = true;
+    for (uint32 i = 0; i < chunk->mesh.num_vertices; ++i) {
+        const v3_f32 p = chunk->mesh.vertices[i];
+        is_inside &= p.x >= VOXEL_CHUNK_SIZE + 5.0f && p.x <= VOXEL_CHUNK_SIZE + 6.0f;
+        is_inside &= p.y >= 6.0f && p.y <= 7.0f;
+        is_inside &= p.z >= -VOXEL_CHUNK_SIZE + 7.0f && p.z <= -VOXEL_CHUNK_SIZE + 8.0f;
+    }
+
+    TEST_TRUE(is_inside);
+    TEST_TRUE(voxel_test_mesh_faces_outside(chunk, 5, 6, 7));
+
+    free(chunk);
+}
+
+// The z = 5 plane has the lower face of the first voxel next to the upper face of the second voxel
+// These faces have a different orientation and must not be merged
+static void test_voxel_chunk_mesh_orientation() {
+    VoxelChunk* chunk = (VoxelChunk *) calloc(1, sizeof(VoxelChunk));
+    voxel_chunk_init(chunk, 0, 0, 0);
+
+    voxel_chunk_set(chunk, 5, 5, 5, {1, 0});
+    voxel_chunk_set(chunk, 6, 5, 4, {1, 0});
+    voxel_chunk_mesh_build(chunk);
+
+    TEST_EQUALS(chunk->mesh.num_vertices, 12 * 4);
+    TEST_EQUALS(chunk->mesh.num_indices, 12 * 6);
+
+    free(chunk);
+}
+
+// The faces at the upper chunk border must be created as well
+static void test_voxel_chunk_mesh_border() {
+    VoxelChunk* chunk = (VoxelChunk *) calloc(1, sizeof(VoxelChunk));
+    voxel_chunk_init(chunk, 0, 0, 0);
+
+    const int32 last = VOXEL_CHUNK_SIZE - 1;
+    voxel_chunk_set(chunk, last, last, last, {1, 0});
+    voxel_chunk_mesh_build(chunk);
+
+    TEST_EQUALS(chunk->mesh.num_vertices, 6 * 4);
+    TEST_EQUALS(chunk->mesh.num_indices, 6 * 6);
+    TEST_TRUE(voxel_test_mesh_faces_outside(chunk, last, last, last));
+
+    // A full chunk is a single box -> 1 quad per side
+    for (int32 z = 0; z < VOXEL_CHUNK_SIZE; ++z) {
+        for (int32 y = 0; y < VOXEL_CHUNK_SIZE; ++y) {
+            for (int32 x = 0; x < VOXEL_CHUNK_SIZE; ++x) {
+                voxel_chunk_set(chunk, x, y, z, {1, 0});
+            }
+        }
+    }
+
+    voxel_chunk_mesh_build(chunk);
+    TEST_EQUALS(chunk->mesh.num_vertices, 6 * 4);
+
+    free(chunk);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main VoxelTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_voxel_chunk_mesh_single);
+    TEST_RUN(test_voxel_chunk_mesh_orientation);
+    TEST_RUN(test_voxel_chunk_mesh_border);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "../TestFramework.h"
+#include "../../gpuapi/ShaderReflection.h"
+
+static const char _shader_reflection_vertex[] =
+    "#version 330 core\n"
+    "// uniform float commented_out;\n"
+    "layout(location = 0) in vec3 position;\n"
+    "in vec2 tex_coord;\n"
+    "in mat4 instance_transform;\n"
+    "\n"
+    "uniform mat4 projection;\n"
+    "layout(location = 2) uniform mat4 view;\n"
+    "/* uniform vec4 also_commented_out; */\n"
+    "layout(std140) uniform Camera {\n"
+    "    vec4 camera_position;\n"
+    "} camera;\n"
+    "\n"
+    "out vec2 uv;\n"
+    "\n"
+    "vec4 transform(vec3 p) {\n"
+    "    return projection * view * instance_transform * vec4(p, 1.0);\n"
+    "}\n"
+    "\n"
+    "void main() {\n"
+    "    uv = tex_coord;\n"
+    "    gl_Position = transform(position);\n"
+    "}\n";
+
+static const char _shader_reflection_fragment[] =
+    "#version 330 core\n"
+    "in vec2 uv;\n"
+    "out vec4 color;\n"
+    "\n"
+    "uniform mat4 projection;\n"
+    "uniform sampler2D textures[2];\n"
+    "layout(binding = 0) uniform sampler2D shadow_map;\n"
+    "uniform highp float time;\n"
+    "uniform vec4 tint, fog;\n"
+    "layout(std430, binding = 1) buffer Lights { vec4 lights[]; };\n"
+    "\n"
+    "void main() {\n"
+    "    if (time > 0.0) { color = texture(textures[0], uv) * tint; }\n"
+    "    else { color = texture(shadow_map, uv) * fog; }\n"
+    "}\n";
+
+static void shader_reflection_test_create(ShaderReflection* reflection) {
+    shader_reflection_init(reflection);
+    shader_reflection_parse(reflection, _shader_reflection_vertex, SHADER_TYPE_VERTEX);
+    shader_reflection_parse(reflection, _shader_reflection_fragment, SHADER_TYPE_FRAGMENT);
+    shader_reflection_finalize(reflection);
+}
+
+static void test_shader_reflection_parse() {
+    ShaderReflection reflection;
+    shader_reflection_test_create(&reflection);
+
+    TEST_EQUALS(reflection.glsl_version, 330);
+    TEST_EQUALS(reflection.count, 12);
+
+    // Attributes, mat4 uses 4 locations
+    const ShaderReflectionVariable* var = shader_reflection_find(&reflection, "position", SHADER_REFLECTION_KIND_ATTRIBUTE);
+    TEST_TRUE(var && var->location == 0 && var->type == SHADER_REFLECTION_TYPE_VEC3);
+
+    var = shader_reflection_find(&reflection, "tex_coord", SHADER_REFLECTION_KIND_ATTRIBUTE);
+    TEST_TRUE(var && var->location == 1);
+
+    var = shader_reflection_find(&reflection, "instance_transform", SHADER_REFLECTION_KIND_ATTRIBUTE);
+    TEST_TRUE(var && var->location == 2 && var->type == SHADER_REFLECTION_TYPE_MAT4);
+
+    // Stage inputs of the fragment shader are not attributes
+    TEST_FALSE(shader_reflection_find(&reflection, "uv", SHADER_REFLECTION_KIND_ATTRIBUTE));
+    TEST_FALSE(shader_reflection_find(&reflection, "commented_out", SHADER_REFLECTION_KIND_UNIFORM));
+    TEST_FALSE(shader_reflection_find(&reflection, "also_commented_out", SHADER_REFLECTION_KIND_UNIFORM));
+    TEST_FALSE(shader_reflection_find(&reflection, "camera_position", SHADER_REFLECTION_KIND_UNIFORM));
+
+    // Explicit locations are never re-assigned, location 2 is taken by view
+    var = shader_reflection_find(&reflection, "view", SHADER_REFLECTION_KIND_UNIFORM);
+    TEST_TRUE(var && var->location == 2 && (var->flags & SHADER_REFLECTION_FLAG_EXPLICIT_LOCATION));
+
+    // Used in both stages
+    var = shader_reflection_find(&reflection, "projection", SHADER_REFLECTION_KIND_UNIFORM);
+    TEST_TRUE(var && var->location == 0);
+    TEST_EQUALS(var->stages, (1 << SHADER_TYPE_VERTEX) | (1 << SHADER_TYPE_FRAGMENT));
+
+    // Arrays use multiple locations and texture units, unit 0 is taken by the shadow map
+    var = shader_reflection_find(&reflection, "textures", SHADER_REFLECTION_KIND_SAMPLER);
+    TEST_TRUE(var && var->array_size == 2 && var->location == 3 && var->binding == 1);
+
+    var = shader_reflection_find(&reflection, "shadow_map", SHADER_REFLECTION_KIND_SAMPLER);
+    TEST_TRUE(var && var->location == 1 && var->binding == 0);
+
+    var = shader_reflection_find(&reflection, "time", SHADER_REFLECTION_KIND_UNIFORM);
+    TEST_TRUE(var && var->location == 5 && var->type == SHADER_REFLECTION_TYPE_FLOAT);
+
+    // Multiple declarations in one statement can't be patched
+    var = shader_reflection_find(&reflection, "tint", SHADER_REFLECTION_KIND_UNIFORM);
+    TEST_TRUE(var && var->location == -1 && (var->flags & SHADER_REFLECTION_FLAG_NO_PATCH));
+
+    var = shader_reflection_find(&reflection, "fog", SHADER_REFLECTION_KIND_UNIFORM);
+    TEST_TRUE(var && var->location == -1 && var->type == SHADER_REFLECTION_TYPE_VEC4);
+
+    // Blocks
+    var = shader_reflection_find(&reflection, "Camera", SHADER_REFLECTION_KIND_UNIFORM_BLOCK);
+    TEST_TRUE(var && var->binding == 0 && var->location == -1);
+
+    var = shader_reflection_find(&reflection, "Lights", SHADER_REFLECTION_KIND_STORAGE_BLOCK);
+    TEST_TRUE(var && var->binding == 1);
+
+    TEST_EQUALS(shader_reflection_location(&reflection, "time"), 5);
+    TEST_EQUALS(shader_reflection_location(&reflection, "Camera"), 0);
+    TEST_EQUALS(shader_reflection_location(&reflection, "unknown"), -1);
+}
+
+static void test_shader_reflection_patch() {
+    ShaderReflection reflection;
+    shader_reflection_test_create(&reflection);
+
+    char output[4096];
+    shader_reflection_patch(&reflection, _shader_reflection_vertex, SHADER_TYPE_VERTEX, output);
+
+    TEST_TRUE(str_contains(output, "#version 430 core\n"));
+    TEST_TRUE(str_contains(output, "layout(location = 0) in vec3 position;"));
+    TEST_TRUE(str_contains(output, "layout(location = 1) in vec2 tex_coord;"));
+    TEST_TRUE(str_contains(output, "layout(location = 2) in mat4 instance_transform;"));
+    TEST_TRUE(str_contains(output, "layout(location = 0) uniform mat4 projection;"));
+    TEST_TRUE(str_contains(output, "layout(location = 2) uniform mat4 view;"));
+    TEST_TRUE(str_contains(output, "layout(binding = 0, std140) uniform Camera {"));
+    TEST_TRUE(str_contains(output, "// uniform float commented_out;"));
+    TEST_TRUE(str_contains(output, "    return projection * view * instance_transform * vec4(p, 1.0);\n"));
+
+    shader_reflection_patch(&reflection, _shader_reflection_fragment, SHADER_TYPE_FRAGMENT, output);
+
+    TEST_TRUE(str_contains(output, "\nin vec2 uv;"));
+    TEST_TRUE(str_contains(output, "layout(location = 3, binding = 1) uniform sampler2D textures[2];"));
+    TEST_TRUE(str_contains(output, "layout(location = 1, binding = 0) uniform sampler2D shadow_map;"));
+    TEST_TRUE(str_contains(output, "layout(location = 5) uniform highp float time;"));
+    TEST_TRUE(str_contains(output, "\nuniform vec4 tint, fog;"));
+    TEST_TRUE(str_contains(output, "layout(std430, binding = 1) buffer Lights"));
+
+    // Patching a patched shader doesn't change it anymore
+    ShaderReflection patched;
+    shader_reflection_init(&patched);
+    shader_reflection_parse(&patched, output, SHADER_TYPE_FRAGMENT);
+    shader_reflection_finalize(&patched);
+
+    char output2[4096];
+    shader_reflection_patch(&patched, output, SHADER_TYPE_FRAGMENT, output2);
+    TEST_EQUALS(strcmp(output, output2), 0);
+}
+
+static void test_shader_reflection_data() {
+    ShaderReflection reflection;
+    shader_reflection_test_create(&reflection);
+
+    byte data[2048];
+    const int32 size = shader_reflection_to_data(&reflection, data);
+    TEST_EQUALS(size, shader_reflection_data_size(&reflection));
+
+    ShaderReflection loaded;
+    TEST_EQUALS(shader_reflection_from_data(data, &loaded), size);
+    TEST_EQUALS(loaded.glsl_version, reflection.glsl_version);
+    TEST_EQUALS(loaded.count, reflection.count);
+
+    bool is_equal = true;
+    for (int32 i = 0; i < reflection.count; ++i) {
+        const ShaderReflectionVariable* a = &reflection.variables[i];
+        const ShaderReflectionVariable* b = &loaded.variables[i];
+
+        is_equal &= strcmp(a->name, b->name) == 0
+            && a->kind == b->kind && a->type == b->type && a->array_size == b->array_size
+            && a->location == b->location && a->binding == b->binding
+            && a->stages == b->stages && a->flags == b->flags;
+    }
+
+    TEST_TRUE(is_equal);
+}
+
+static void test_shader_reflection_header() {
+    ShaderReflection reflection;
+    shader_reflection_test_create(&reflection);
+
+    char header[8192];
+    shader_reflection_to_header(&reflection, "ui_shader", header);
+
+    TEST_TRUE(str_contains(header, "#define UI_SHADER_LOCATION_PROJECTION 0\n"));
+    TEST_TRUE(str_contains(header, "#define UI_SHADER_LOCATION_TIME 5\n"));
+    TEST_TRUE(str_contains(header, "#define UI_SHADER_BINDING_TEXTURES 1\n"));
+    TEST_TRUE(str_contains(header, "#define UI_SHADER_BINDING_CAMERA 0\n"));
+    TEST_FALSE(str_contains(header, "UI_SHADER_LOCATION_TINT"));
+    TEST_FALSE(str_contains(header, "UI_SHADER_LOCATION_FOG"));
+    TEST_TRUE(str_contains(header, "static const ShaderReflection ui_shader_reflection = {\n"));
+    TEST_TRUE(str_contains(header, "{\"view\", (ShaderReflectionKind) 0, (ShaderReflectionType) 20, 1, 2, -1, 2, 1},"));
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main ShaderReflectionTest
+#endif
+
+int main() {
+    TEST_INIT(100);
+
+    TEST_RUN(test_shader_reflection_parse);
+    TEST_RUN(test_shader_reflection_patch);
+    TEST_RUN(test_shader_reflection_data);
+    TEST_RUN(test_shader_reflection_header);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
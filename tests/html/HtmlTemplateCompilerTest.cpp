@@ -0,0 +1,176 @@
+#include "../TestFramework.h"
+#include "../../memory/RingMemory.cpp"
+#include "../../html/template/HtmlTemplateCompiler.h"
+#include "../../html/template/HtmlTemplateVM.h"
+
+static void test_html_template_compile_text() {
+    RingMemory ring = {};
+    ring_alloc(&ring, 64 * KILOBYTE, 64 * KILOBYTE, 64);
+
+    const char* tpl = "<a>b<? ; ?>c</a>";
+    byte* out = memory_get(&ring, html_template_program_size_max((int32) str_length(tpl)), sizeof(size_t));
+    HtmlTemplateProgram* program = html_template_compile(tpl, (int32) str_length(tpl), out, &ring);
+
+    TEST_TRUE(program != NULL);
+
+    // Static text is merged into a single emit + halt
+    TEST_EQUALS(program->instruction_count, 2);
+    TEST_EQUALS(program->slot_count, 0);
+
+    char buffer[64];
+    int32 length = html_template_render(program, NULL, buffer, sizeof(buffer));
+    TEST_EQUALS(length, 9);
+    TEST_EQUALS(memcmp(buffer, "<a>bc</a>", 9), 0);
+
+    ring_free(&ring);
+}
+
+static void test_html_template_render_loop() {
+    RingMemory ring = {};
+    ring_alloc(&ring, 64 * KILOBYTE, 64 * KILOBYTE, 64);
+
+    const char* tpl = "<ul><? for (i = 0; i < n; ++i) { ?><li><?= i * 2 ?></li><? } ?></ul>";
+    byte* out = memory_get(&ring, html_template_program_size_max((int32) str_length(tpl)), sizeof(size_t));
+    HtmlTemplateProgram* program = html_template_compile(tpl, (int32) str_length(tpl), out, &ring);
+
+    TEST_TRUE(program != NULL);
+    TEST_EQUALS(program->slot_count, 2);
+
+    HtmlTemplateValue slots[2] = {};
+    int32 n = html_template_program_slot(program, "n");
+    TEST_EQUALS(n, 1);
+
+    slots[n].type = VALUE_INTEGER64;
+    slots[n].int64Value = 3;
+
+    char buffer[128];
+    int32 length = html_template_render(program, slots, buffer, sizeof(buffer));
+    TEST_EQUALS(length, (int32) str_length("<ul><li>0</li><li>2</li><li>4</li></ul>"));
+    TEST_EQUALS(memcmp(buffer, "<ul><li>0</li><li>2</li><li>4</li></ul>", length), 0);
+
+    ring_free(&ring);
+}
+
+static void test_html_template_render_if() {
+    RingMemory ring = {};
+    ring_alloc(&ring, 64 * KILOBYTE, 64 * KILOBYTE, 64);
+
+    const char* tpl = "<? if (name == \"bob\") { ?>hi<? } elseif (n > 2) { ?>many<? } else { ?>few<? } ?>";
+    byte* out = memory_get(&ring, html_template_program_size_max((int32) str_length(tpl)), sizeof(size_t));
+    HtmlTemplateProgram* program = html_template_compile(tpl, (int32) str_length(tpl), out, &ring);
+
+    TEST_TRUE(program != NULL);
+
+    HtmlTemplateValue slots[2] = {};
+    int32 name = html_template_program_slot(program, "name");
+    int32 n = html_template_program_slot(program, "n");
+
+    slots[name].type = VALUE_STRING;
+    slots[name].ptrValue = "bob";
+    slots[name].value_length = 3;
+    slots[n].type = VALUE_INTEGER64;
+    slots[n].int64Value = 3;
+
+    char buffer[16];
+    TEST_EQUALS(html_template_render(program, slots, buffer, sizeof(buffer)), 2);
+    TEST_EQUALS(memcmp(buffer, "hi", 2), 0);
+
+    slots[name].value_length = 2;
+    TEST_EQUALS(html_template_render(program, slots, buffer, sizeof(buffer)), 4);
+    TEST_EQUALS(memcmp(buffer, "many", 4), 0);
+
+    slots[n].int64Value = 1;
+    TEST_EQUALS(html_template_render(program, slots, buffer, sizeof(buffer)), 3);
+    TEST_EQUALS(memcmp(buffer, "few", 3), 0);
+
+    ring_free(&ring);
+}
+
+// Numbers at the end of the buffer are written or truncated like static text
+static void test_html_template_render_number_truncated() {
+    RingMemory ring = {};
+    ring_alloc(&ring, 64 * KILOBYTE, 64 * KILOBYTE, 64);
+
+    const char* tpl = "<b><?= n ?></b>";
+    byte* out = memory_get(&ring, html_template_program_size_max((int32) str_length(tpl)), sizeof(size_t));
+    HtmlTemplateProgram* program = html_template_compile(tpl, (int32) str_length(tpl), out, &ring);
+
+    TEST_TRUE(program != NULL);
+
+    HtmlTemplateValue slots[1] = {};
+    slots[0].type = VALUE_INTEGER64;
+    slots[0].int64Value = 12345;
+
+    char buffer[10];
+    TEST_EQUALS(html_template_render(program, slots, buffer, sizeof(buffer)), 10);
+    TEST_EQUALS(memcmp(buffer, "<b>12345</", 10), 0);
+
+    TEST_EQUALS(html_template_render(program, slots, buffer, 5), 5);
+    TEST_EQUALS(memcmp(buffer, "<b>12", 5), 0);
+
+    ring_free(&ring);
+}
+
+// Builds "<?= (1 + (1 + ... 1)) ?>", every nesting level needs one more value on the stack
+static int32 html_template_test_nested(char* tpl, int32 depth) {
+    char* pos = tpl;
+    pos += str_copy(pos, "<?= ");
+    for (int32 i = 1; i < depth; ++i) {
+        pos += str_copy(pos, "(1 + ");
+    }
+
+    *pos++ = '1';
+    for (int32 i = 1; i < depth; ++i) {
+        *pos++ = ')';
+    }
+
+    pos += str_copy(pos, " ?>");
+
+    return (int32) (pos - tpl);
+}
+
+static void test_html_template_compile_stack_size() {
+    RingMemory ring = {};
+    ring_alloc(&ring, 64 * KILOBYTE, 64 * KILOBYTE, 64);
+
+    char tpl[512];
+    char buffer[64];
+
+    // The deepest expression the renderer supports
+    int32 length = html_template_test_nested(tpl, HTML_TEMPLATE_VM_STACK_SIZE);
+    byte* out = memory_get(&ring, html_template_program_size_max(length), sizeof(size_t));
+    HtmlTemplateProgram* program = html_template_compile(tpl, length, out, &ring);
+
+    TEST_TRUE(program != NULL);
+    TEST_EQUALS(program->stack_size, HTML_TEMPLATE_VM_STACK_SIZE);
+    TEST_EQUALS(html_template_render(program, NULL, buffer, sizeof(buffer)), 2);
+    TEST_EQUALS(memcmp(buffer, "32", 2), 0);
+
+    // One level deeper would overflow the value stack of the renderer
+    length = html_template_test_nested(tpl, HTML_TEMPLATE_VM_STACK_SIZE + 1);
+    out = memory_get(&ring, html_template_program_size_max(length), sizeof(size_t));
+    TEST_TRUE(html_template_compile(tpl, length, out, &ring) == NULL);
+
+    ring_free(&ring);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main HtmlTemplateCompilerTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_html_template_compile_text);
+    TEST_RUN(test_html_template_render_loop);
+    TEST_RUN(test_html_template_render_if);
+    TEST_RUN(test_html_template_render_number_truncated);
+    TEST_RUN(test_html_template_compile_stack_size);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "../TestFramework.h"
+#include "../../memory/BufferMemory.cpp"
+#include "../../http/HttpRouter.h"
+
+// root -> "^[a-z0-9_]{1,32}$"
+static void http_router_test_create(HttpRouter* router, BufferMemory* buf) {
+    http_router_init(router, 4, buf);
+
+    HttpRouteNode* root = &router->nodes[0];
+    root->children_count = 1;
+    root->children_offset = 1;
+
+    HttpRouteNode* node = &router->nodes[1];
+    memcpy(node->segment, "^[a-z0-9_]{1,32}$", sizeof("^[a-z0-9_]{1,32}$"));
+    node->is_regex = true;
+    node->detail_offset = 0;
+    node->detail_count = 1;
+
+    router->node_count = 2;
+
+    router->route_details[0].func_id = 7;
+    router->route_details[0].method = HTTP_METHOD_GET;
+    router->route_details[0].flags = HTTP_ROUTE_FLAG_ACTUVE;
+    router->route_detail_count = 1;
+}
+
+// Regex segments are compiled once and afterwards only taken from the cache
+static void test_http_router_regex_cache() {
+    BufferMemory buf = {};
+    buffer_alloc(&buf, 512 * KILOBYTE, 512 * KILOBYTE);
+
+    HttpRouter router;
+    http_router_test_create(&router, &buf);
+
+    TEST_TRUE(router.regex_cache != NULL);
+    TEST_EQUALS(router.regex_cache->count, 0);
+
+    HttpRouteDetails* matches[4];
+    int32 match_count;
+
+    http_router_route(&router, "user_1", false, HTTP_METHOD_GET, matches, &match_count);
+    TEST_EQUALS(match_count, 1);
+    TEST_EQUALS(matches[0]->func_id, 7);
+    TEST_EQUALS(router.regex_cache->count, 1);
+
+    const RegexDfa* dfa = regex_cache_get(router.regex_cache, router.nodes[1].segment);
+
+    http_router_route(&router, "other", false, HTTP_METHOD_GET, matches, &match_count);
+    TEST_EQUALS(match_count, 1);
+
+    http_router_route(&router, "Not-Valid", false, HTTP_METHOD_GET, matches, &match_count);
+    TEST_EQUALS(match_count, 0);
+
+    // Still the same compiled pattern
+    TEST_EQUALS(router.regex_cache->count, 1);
+    TEST_EQUALS(regex_cache_get(router.regex_cache, router.nodes[1].segment), dfa);
+
+    buffer_free(&buf);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main HttpRouterTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_http_router_regex_cache);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include "../TestFramework.h"
+#include "../../input/InputRecording.h"
+
+#define INPUT_RECORDING_TEST_KEY_A (INPUT_KEYBOARD_PREFIX | 0x1E)
+#define INPUT_RECORDING_TEST_KEY_CTRL (INPUT_KEYBOARD_PREFIX | 0x1D)
+
+struct InputRecordingTestFrame {
+    uint64 time;
+    uint16 active_hotkeys[MAX_KEY_PRESSES];
+    int16 x;
+    int16 dx;
+};
+
+struct InputRecordingTestData {
+    InputRecordingTestFrame frames[16];
+    int32 frame_count;
+
+    int32 commands[8];
+    int32 command_count;
+};
+
+static void input_recording_test_frame(void* data, Input* input, uint64 time) {
+    InputRecordingTestData* test = (InputRecordingTestData *) data;
+    InputRecordingTestFrame* frame = &test->frames[test->frame_count++];
+
+    frame->time = time;
+    memcpy(frame->active_hotkeys, input->state.active_hotkeys, sizeof(frame->active_hotkeys));
+    frame->x = input->state.x[0];
+    frame->dx = input->state.dx[0];
+}
+
+static void input_recording_test_command(void* data, uint8 type, const byte* payload, uint16 size) {
+    InputRecordingTestData* test = (InputRecordingTestData *) data;
+
+    int32 value = 0;
+    if (size == sizeof(int32)) {
+        read_le(payload, &value);
+    }
+
+    test->commands[test->command_count++] = type * 1000 + value;
+}
+
+static void input_recording_test_init(Input* input, BufferMemory* buf) {
+    memset(input, 0, sizeof(*input));
+    buffer_alloc(buf, 4096, 4096);
+    input_init(input, 2, buf);
+
+    input_add_hotkey(input->input_mapping1, 1, INPUT_RECORDING_TEST_KEY_A);
+    input_add_hotkey(input->input_mapping1, 2, INPUT_RECORDING_TEST_KEY_CTRL, INPUT_RECORDING_TEST_KEY_A);
+    input_hotkey_index_build(input);
+}
+
+static void input_recording_test_key(Input* input, InputRecorder* rec, uint16 scan_code, KeyPressType key_state, uint64 time) {
+    InputKey key = {};
+    key.scan_code = scan_code;
+    key.key_state = key_state;
+    key.time = time;
+
+    input_set_state(input->state.active_keys, &key);
+    input_record_key(rec, &key);
+}
+
+static void test_input_recording_replay() {
+    BufferMemory buf;
+    Input input;
+    input_recording_test_init(&input, &buf);
+
+    InputRecorder rec;
+    input_recorder_alloc(&rec, 1024, 1000000);
+
+    // Live session
+    InputRecordingTestData live = {};
+    uint64 time = 1000000;
+
+    for (int32 frame = 0; frame < 10; ++frame) {
+        time += 16000 + frame * 100;
+
+        if (frame == 1) {
+            input_recording_test_key(&input, &rec, INPUT_RECORDING_TEST_KEY_A, KEY_PRESS_TYPE_PRESSED, time - 5000);
+        } else if (frame == 3) {
+            input_recording_test_key(&input, &rec, INPUT_RECORDING_TEST_KEY_CTRL, KEY_PRESS_TYPE_PRESSED, time - 1000);
+            input_record_command(&rec, 7, &frame, sizeof(frame));
+        } else if (frame == 6) {
+            input_recording_test_key(&input, &rec, INPUT_RECORDING_TEST_KEY_CTRL, KEY_PRESS_TYPE_RELEASED, time - 2000);
+            input_recording_test_key(&input, &rec, INPUT_RECORDING_TEST_KEY_A, KEY_PRESS_TYPE_RELEASED, time - 1000);
+        }
+
+        input.state.x[0] = (int16) (frame * 3);
+        input.state.dx[0] = frame & 1 ? 3 : 0;
+
+        input_record_frame(&rec, &input, time);
+        input_hotkey_state(&input, time);
+        input_recording_test_frame(&live, &input, time);
+    }
+
+    TEST_FALSE(rec.is_full);
+
+    // Replay in a fresh input
+    BufferMemory buf2;
+    Input replay_input;
+    input_recording_test_init(&replay_input, &buf2);
+
+    InputReplay replay;
+    TEST_TRUE(input_replay_init(&replay, rec.data, input_recording_size(&rec)));
+
+    InputRecordingTestData replayed = {};
+    InputReplayStats stats;
+    input_replay_run(&replay, &replay_input, input_recording_test_frame, input_recording_test_command, &replayed, &stats);
+
+    TEST_EQUALS(stats.frame_count, 10);
+    TEST_EQUALS(replayed.frame_count, live.frame_count);
+    TEST_TRUE(stats.time_min <= stats.time_max);
+
+    for (int32 i = 0; i < live.frame_count; ++i) {
+        TEST_EQUALS(replayed.frames[i].time, live.frames[i].time);
+        TEST_EQUALS(replayed.frames[i].x, live.frames[i].x);
+        TEST_EQUALS(replayed.frames[i].dx, live.frames[i].dx);
+        TEST_MEMORY_EQUALS(replayed.frames[i].active_hotkeys, live.frames[i].active_hotkeys, sizeof(live.frames[i].active_hotkeys));
+    }
+
+    // The chord suppresses the single key while ctrl is down
+    TEST_EQUALS(live.frames[2].active_hotkeys[0], 1);
+    TEST_EQUALS(live.frames[4].active_hotkeys[0], 2);
+    TEST_EQUALS(live.frames[4].active_hotkeys[1], 0);
+
+    TEST_EQUALS(replayed.command_count, 1);
+    TEST_EQUALS(replayed.commands[0], 7003);
+
+    buffer_free(&buf2);
+    buffer_free(&buf);
+    input_recorder_free(&rec);
+}
+
+static void test_input_recording_invalid() {
+    BufferMemory buf;
+    Input input;
+    input_recording_test_init(&input, &buf);
+
+    InputRecorder rec;
+    input_recorder_alloc(&rec, 64, 0);
+
+    // Full recorder only contains complete records
+    for (int32 i = 0; i < 10; ++i) {
+        input_recording_test_key(&input, &rec, INPUT_RECORDING_TEST_KEY_A, KEY_PRESS_TYPE_PRESSED, i);
+        input_record_frame(&rec, &input, i * 1000);
+    }
+
+    TEST_TRUE(rec.is_full);
+    TEST_TRUE(input_recording_size(&rec) <= 64);
+
+    InputReplay replay;
+    TEST_TRUE(input_replay_init(&replay, rec.data, input_recording_size(&rec)));
+
+    uint64 time;
+    int32 frames = 0;
+    while (input_replay_frame(&replay, &input, &time)) {
+        ++frames;
+    }
+
+    TEST_TRUE(frames > 0 && frames < 10);
+
+    // Truncated data
+    TEST_TRUE(input_replay_init(&replay, rec.data, INPUT_RECORDING_HEADER_SIZE + 5));
+    TEST_FALSE(input_replay_frame(&replay, &input, &time));
+
+    // Wrong magic
+    byte invalid[INPUT_RECORDING_HEADER_SIZE + 1] = {0};
+    TEST_FALSE(input_replay_init(&replay, invalid, sizeof(invalid)));
+
+    buffer_free(&buf);
+    input_recorder_free(&rec);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main InputRecordingTest
+#endif
+
+int main() {
+    TEST_INIT(75);
+
+    TEST_RUN(test_input_recording_replay);
+    TEST_RUN(test_input_recording_invalid);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include "../TestFramework.h"
+#include "../../input/Input.cpp"
+
+enum InputTestHotkey {
+    INPUT_TEST_HOTKEY_1 = 1,
+    INPUT_TEST_HOTKEY_ALT_1,
+    INPUT_TEST_HOTKEY_RUN,
+    INPUT_TEST_HOTKEY_DODGE,
+    INPUT_TEST_HOTKEY_JUMP,
+};
+
+#define INPUT_TEST_KEY_1 (INPUT_KEYBOARD_PREFIX | 0x02)
+#define INPUT_TEST_KEY_ALT (INPUT_KEYBOARD_PREFIX | 0x38)
+#define INPUT_TEST_KEY_W (INPUT_KEYBOARD_PREFIX | 0x11)
+#define INPUT_TEST_KEY_SPACE (INPUT_KEYBOARD_PREFIX | 0x39)
+#define INPUT_TEST_KEY_MOUSE (INPUT_MOUSE_PREFIX | INPUT_MOUSE_BUTTON_1)
+
+static void input_test_key(Input* input, uint16 scan_code, KeyPressType key_state, uint64 time) {
+    InputKey key = {};
+    key.scan_code = scan_code;
+    key.key_state = key_state;
+    key.time = time;
+
+    input_set_state(input->state.active_keys, &key);
+}
+
+static void input_test_init(Input* input, BufferMemory* buf) {
+    memset(input, 0, sizeof(*input));
+    input_init(input, 5, buf);
+
+    input_add_hotkey(input->input_mapping1, INPUT_TEST_HOTKEY_1, INPUT_TEST_KEY_1);
+    input_add_hotkey(input->input_mapping1, INPUT_TEST_HOTKEY_ALT_1, INPUT_TEST_KEY_ALT, INPUT_TEST_KEY_1);
+    input_add_hotkey(input->input_mapping1, INPUT_TEST_HOTKEY_RUN, INPUT_TEST_KEY_W, 0, 0, KEY_PRESS_TYPE_HELD);
+    input_add_hotkey(input->input_mapping1, INPUT_TEST_HOTKEY_DODGE, INPUT_TEST_KEY_W, 0, 0, KEY_PRESS_TYPE_DOUBLE_TAPPED);
+    input_add_hotkey(input->input_mapping1, INPUT_TEST_HOTKEY_JUMP, INPUT_TEST_KEY_SPACE);
+    input_add_hotkey(input->input_mapping2, INPUT_TEST_HOTKEY_JUMP, INPUT_TEST_KEY_MOUSE);
+
+    input_hotkey_index_build(input);
+}
+
+static void test_input_hotkey_index() {
+    BufferMemory buf = {};
+    buffer_alloc(&buf, 4096, 4096);
+
+    Input input;
+    input_test_init(&input, &buf);
+
+    const HotkeyIndex* index = &input.hotkey_index;
+
+    // Every hotkey is only indexed under its first key
+    const int32 bit_1 = input_key_bit(INPUT_TEST_KEY_1);
+    const int32 bit_alt = input_key_bit(INPUT_TEST_KEY_ALT);
+    const int32 bit_w = input_key_bit(INPUT_TEST_KEY_W);
+    const int32 bit_mouse = input_key_bit(INPUT_TEST_KEY_MOUSE);
+
+    TEST_EQUALS(index->key_offsets[bit_1 + 1] - index->key_offsets[bit_1], 1);
+    TEST_EQUALS(index->key_offsets[bit_alt + 1] - index->key_offsets[bit_alt], 1);
+    TEST_EQUALS(index->key_offsets[bit_w + 1] - index->key_offsets[bit_w], 2);
+    TEST_EQUALS(index->key_offsets[bit_mouse + 1] - index->key_offsets[bit_mouse], 1);
+    TEST_EQUALS(index->key_offsets[INPUT_KEY_BITS], 6);
+
+    // The mouse and keyboard bits don't overlap
+    TEST_TRUE(bit_mouse >= 256 && bit_mouse < 384);
+    TEST_TRUE(bit_1 < 256);
+
+    buffer_free(&buf);
+}
+
+static void test_input_hotkey_longest_chord() {
+    BufferMemory buf = {};
+    buffer_alloc(&buf, 4096, 4096);
+
+    Input input;
+    input_test_init(&input, &buf);
+
+    // Only 1 -> hotkey 1
+    input_test_key(&input, INPUT_TEST_KEY_1, KEY_PRESS_TYPE_PRESSED, 1000);
+    input_hotkey_state(&input, 1000);
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_1));
+    TEST_FALSE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_ALT_1));
+
+    // Alt + 1 -> only hotkey alt+1
+    input_test_key(&input, INPUT_TEST_KEY_ALT, KEY_PRESS_TYPE_PRESSED, 2000);
+    input_hotkey_state(&input, 2000);
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_ALT_1));
+    TEST_FALSE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_1));
+
+    // Independent hotkeys are still active at the same time, mapping2 works as well
+    input_test_key(&input, INPUT_TEST_KEY_MOUSE, KEY_PRESS_TYPE_PRESSED, 3000);
+    input_hotkey_state(&input, 3000);
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_ALT_1));
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_JUMP));
+
+    // Released keys are removed
+    input_test_key(&input, INPUT_TEST_KEY_ALT, KEY_PRESS_TYPE_RELEASED, 4000);
+    input_test_key(&input, INPUT_TEST_KEY_MOUSE, KEY_PRESS_TYPE_RELEASED, 4000);
+    input_hotkey_state(&input, 4000);
+    input_hotkey_state(&input, 5000);
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_1));
+    TEST_FALSE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_JUMP));
+
+    buffer_free(&buf);
+}
+
+static void test_input_hotkey_held() {
+    BufferMemory buf = {};
+    buffer_alloc(&buf, 4096, 4096);
+
+    Input input;
+    input_test_init(&input, &buf);
+
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_PRESSED, 1000000);
+    input_hotkey_state(&input, 1000000);
+    TEST_FALSE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_RUN));
+
+    // Repeated key events don't reset the press time
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_PRESSED, 1100000);
+    input_hotkey_state(&input, 1100000);
+    TEST_FALSE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_RUN));
+
+    input_hotkey_state(&input, 1000000 + INPUT_LONG_PRESS_DURATION * 1000);
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_RUN));
+    TEST_TRUE(input_is_held(input.state.active_keys, INPUT_TEST_KEY_W));
+
+    // Pressed hotkeys remain active while the key is held
+    input_test_key(&input, INPUT_TEST_KEY_1, KEY_PRESS_TYPE_PRESSED, 1000000);
+    input_hotkey_state(&input, 1500000);
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_1));
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_RUN));
+
+    buffer_free(&buf);
+}
+
+static void test_input_hotkey_double_tap() {
+    BufferMemory buf = {};
+    buffer_alloc(&buf, 4096, 4096);
+
+    Input input;
+    input_test_init(&input, &buf);
+
+    // Tap in separate frames
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_PRESSED, 1000000);
+    input_hotkey_state(&input, 1000000);
+    TEST_FALSE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_DODGE));
+
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_RELEASED, 1050000);
+    input_hotkey_state(&input, 1050000);
+
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_PRESSED, 1150000);
+    input_hotkey_state(&input, 1150000);
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_DODGE));
+
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_RELEASED, 1200000);
+    input_hotkey_state(&input, 1200000);
+
+    // A third tap is not another double tap
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_PRESSED, 1250000);
+    input_hotkey_state(&input, 1250000);
+    TEST_FALSE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_DODGE));
+
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_RELEASED, 1300000);
+    input_hotkey_state(&input, 1300000);
+
+    // Too slow
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_PRESSED, 2000000);
+    input_hotkey_state(&input, 2000000);
+    TEST_FALSE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_DODGE));
+
+    // Release and press within the same frame
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_RELEASED, 2050000);
+    input_test_key(&input, INPUT_TEST_KEY_W, KEY_PRESS_TYPE_PRESSED, 2100000);
+    input_hotkey_state(&input, 2100000);
+    TEST_TRUE(hotkey_is_active(input.state.active_hotkeys, INPUT_TEST_HOTKEY_DODGE));
+
+    buffer_free(&buf);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main InputTest
+#endif
+
+int main() {
+    TEST_INIT(50);
+
+    TEST_RUN(test_input_hotkey_index);
+    TEST_RUN(test_input_hotkey_longest_chord);
+    TEST_RUN(test_input_hotkey_held);
+    TEST_RUN(test_input_hotkey_double_tap);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
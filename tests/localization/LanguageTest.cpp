@@ -0,0 +1,127 @@
+#include "../TestFramework.h"
+#include "../../localization/Language.cpp"
+
+static const char _language_test_en[] = "Start\n\nOptions\n\nQuit\ngame\n\nOptions\n";
+static const char _language_test_de[] = "Starten\n\nOptionen\n\nSpiel\nbeenden\n\nOptionen\n";
+
+static void test_language_from_txt() {
+    RingMemory ring = {};
+    ring_alloc(&ring, 1024, 1024);
+
+    alignas(4) byte data[256];
+    Language language = {};
+    language.data = data;
+
+    language_from_txt(&language, _language_test_en, sizeof(_language_test_en) - 1, &ring);
+
+    TEST_EQUALS(language.count, 4);
+    TEST_TRUE(language_data_size(&language) <= language_data_size_max(language.count, sizeof(_language_test_en) - 1));
+    TEST_EQUALS(strcmp(language_string(&language, 0), "Start"), 0);
+    TEST_EQUALS(strcmp(language_string(&language, 1), "Options"), 0);
+
+    // A single \n is part of the text
+    TEST_EQUALS(strcmp(language_string(&language, 2), "Quit\ngame"), 0);
+
+    // Identical strings are only stored once
+    TEST_EQUALS(language_string(&language, 3), language_string(&language, 1));
+    TEST_EQUALS(language.size, (int32) sizeof("Start" "Options" "Quit\ngame") + 2);
+
+    ring_free(&ring);
+}
+
+static void test_language_map() {
+    RingMemory ring = {};
+    ring_alloc(&ring, 1024, 1024);
+
+    alignas(4) byte data[256];
+    Language language = {};
+    language.data = data;
+    language_from_txt(&language, _language_test_en, sizeof(_language_test_en) - 1, &ring);
+
+    alignas(4) byte file[256];
+    const int32 size = language_to_data(&language, file);
+    TEST_EQUALS(size, language_data_size(&language));
+
+    // Zero copy, the strings point into the file data
+    Language mapped = {};
+    TEST_EQUALS(language_map(file, size, &mapped), size);
+    TEST_EQUALS(mapped.count, 4);
+    TEST_TRUE((const byte *) language_string(&mapped, 0) > file);
+    TEST_TRUE((const byte *) language_string(&mapped, 0) < file + size);
+    TEST_EQUALS(strcmp(language_string(&mapped, 2), "Quit\ngame"), 0);
+
+    // Truncated data
+    TEST_EQUALS(language_map(file, size - 1, &mapped), 0);
+
+    // Offset outside of the string data
+    alignas(4) byte corrupt[256];
+    memcpy(corrupt, file, size);
+    ((uint32 *) (corrupt + LANGUAGE_HEADER_SIZE))[1] = (uint32) mapped.size + 10;
+    TEST_EQUALS(language_map(corrupt, size, &mapped), 0);
+
+    // Last string isn't terminated
+    memcpy(corrupt, file, size);
+    corrupt[size - 1] = 'x';
+    TEST_EQUALS(language_map(corrupt, size, &mapped), 0);
+
+    // Copy
+    alignas(4) byte copy_data[256];
+    Language copy = {};
+    copy.data = copy_data;
+    TEST_EQUALS(language_from_data(file, &copy), size);
+    TEST_EQUALS(strcmp(language_string(&copy, 1), "Options"), 0);
+
+    ring_free(&ring);
+}
+
+static void test_language_switch() {
+    RingMemory ring = {};
+    ring_alloc(&ring, 1024, 1024);
+
+    alignas(4) byte data_en[256];
+    alignas(4) byte data_de[256];
+    Language en = {};
+    Language de = {};
+    en.data = data_en;
+    de.data = data_de;
+    language_from_txt(&en, _language_test_en, sizeof(_language_test_en) - 1, &ring);
+    language_from_txt(&de, _language_test_de, sizeof(_language_test_de) - 1, &ring);
+
+    LanguageState state = {};
+    TEST_EQUALS(strcmp(language_text(&state, 0), ""), 0);
+
+    language_activate(&state, &en);
+    const uint32 version = state.version;
+
+    // The ui only keeps the id
+    const int32 quit_id = 2;
+    TEST_EQUALS(strcmp(language_text(&state, quit_id), "Quit\ngame"), 0);
+
+    language_activate(&state, &de);
+    TEST_NOT_EQUALS(state.version, version);
+    TEST_EQUALS(strcmp(language_text(&state, quit_id), "Spiel\nbeenden"), 0);
+
+    // Unknown id
+    TEST_EQUALS(strcmp(language_text(&state, 100), ""), 0);
+
+    ring_free(&ring);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main LanguageTest
+#endif
+
+int main() {
+    TEST_INIT(50);
+
+    TEST_RUN(test_language_from_txt);
+    TEST_RUN(test_language_map);
+    TEST_RUN(test_language_switch);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -37,6 +37,98 @@ static void test_evaluator_evaluate_function() {
     TEST_EQUALS(evaluator_evaluate(expr, 1, (const EvaluatorVariable *) &variables), 5);
 }
 
+static void test_evaluator_compile() {
+    EvaluatorProgram program;
+
+    // Constants are folded
+    TEST_TRUE(evaluator_compile(&program, "(2 * 4 - 1 + 3) / 2"));
+    TEST_EQUALS(program.code_length, 1);
+    TEST_EQUALS(evaluator_run(&program), 5);
+
+    const char* slots[] = {"level", "str"};
+    TEST_TRUE(evaluator_compile(&program, "level * 2 + max(str, 10) - -sqrt(16)", ARRAY_COUNT(slots), slots));
+    TEST_EQUALS(program.slot_count, 2);
+
+    f32 values[] = {10, 12};
+    TEST_EQUALS(evaluator_run(&program, values), 36);
+
+    values[1] = 3;
+    TEST_EQUALS(evaluator_run(&program, values), 34);
+
+    // Unary minus binds stronger than *
+    TEST_TRUE(evaluator_compile(&program, "-level * 2 + abs(-str)", ARRAY_COUNT(slots), slots));
+    TEST_EQUALS(evaluator_run(&program, values), -17);
+
+    // Errors
+    TEST_FALSE(evaluator_compile(&program, "unknown + 1", ARRAY_COUNT(slots), slots));
+    TEST_FALSE(evaluator_compile(&program, "levels + 1", ARRAY_COUNT(slots), slots));
+    TEST_FALSE(evaluator_compile(&program, "foo(1)"));
+    TEST_FALSE(evaluator_compile(&program, "(1 + 2"));
+    TEST_FALSE(evaluator_compile(&program, "1 + 2)"));
+    TEST_FALSE(evaluator_compile(&program, "min(1)"));
+    TEST_FALSE(evaluator_compile(&program, "1 +"));
+}
+
+static void test_evaluator_run_batch() {
+    const char* slots[] = {"a", "b"};
+    EvaluatorProgram program;
+    TEST_TRUE(evaluator_compile(&program, "min(a * 1.5, b) + sqrt(abs(b)) / 2 - -a", ARRAY_COUNT(slots), slots));
+
+    // Not a multiple of the block size or simd width
+    f32 a[203];
+    f32 b[203];
+    f32 out[203];
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(a); ++i) {
+        a[i] = (f32) i * 0.25f;
+        b[i] = 50.0f - (f32) i;
+    }
+
+    const f32* inputs[] = {a, b};
+    evaluator_run_batch(&program, inputs, out, ARRAY_COUNT(out));
+
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(out); ++i) {
+        const f32 values[] = {a[i], b[i]};
+        TEST_TRUE(fabsf(out[i] - evaluator_run(&program, values)) < 0.0001f);
+    }
+}
+
+#if PERFORMANCE_TEST
+#define EVALUATOR_BENCH_COUNT 4096
+
+static f32 _evaluator_bench_a[EVALUATOR_BENCH_COUNT];
+static f32 _evaluator_bench_b[EVALUATOR_BENCH_COUNT];
+static f32 _evaluator_bench_out[EVALUATOR_BENCH_COUNT];
+static EvaluatorProgram _evaluator_bench_program;
+
+static void _evaluator_batch(MAYBE_UNUSED volatile void* val) {
+    const f32* inputs[] = {_evaluator_bench_a, _evaluator_bench_b};
+    evaluator_run_batch(&_evaluator_bench_program, inputs, _evaluator_bench_out, EVALUATOR_BENCH_COUNT);
+
+    *((volatile f32 *) val) = _evaluator_bench_out[EVALUATOR_BENCH_COUNT - 1];
+}
+
+static void _evaluator_single(MAYBE_UNUSED volatile void* val) {
+    for (int32 i = 0; i < EVALUATOR_BENCH_COUNT; ++i) {
+        const f32 values[] = {_evaluator_bench_a[i], _evaluator_bench_b[i]};
+        _evaluator_bench_out[i] = evaluator_run(&_evaluator_bench_program, values);
+    }
+
+    *((volatile f32 *) val) = _evaluator_bench_out[EVALUATOR_BENCH_COUNT - 1];
+}
+
+static void test_evaluator_performance() {
+    const char* slots[] = {"a", "b"};
+    evaluator_compile(&_evaluator_bench_program, "min(a * 1.5, b) + sqrt(abs(b)) / 2 - a * a", ARRAY_COUNT(slots), slots);
+
+    for (int32 i = 0; i < EVALUATOR_BENCH_COUNT; ++i) {
+        _evaluator_bench_a[i] = (f32) i;
+        _evaluator_bench_b[i] = (f32) (EVALUATOR_BENCH_COUNT - i);
+    }
+
+    COMPARE_FUNCTION_TEST_TIME(_evaluator_batch, _evaluator_single, 50.0);
+}
+#endif
+
 #ifdef UBER_TEST
     #ifdef main
         #undef main
@@ -45,11 +137,17 @@ static void test_evaluator_evaluate_function() {
 #endif
 
 int main() {
-    TEST_INIT(10);
+    TEST_INIT(250);
 
     TEST_RUN(test_evaluator_evaluate);
     TEST_RUN(test_evaluator_evaluate_variables);
     TEST_RUN(test_evaluator_evaluate_function);
+    TEST_RUN(test_evaluator_compile);
+    TEST_RUN(test_evaluator_run_batch);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_evaluator_performance);
+    #endif
 
     TEST_FINALIZE();
 
@@ -0,0 +1,241 @@
+#include "../../TestFramework.h"
+#include "../../../models/mob/MobStore.h"
+
+#define MOB_STORE_TEST_COUNT 61
+
+static void mob_store_test_state(MobState* state, uint32 i, f32 t) {
+    *state = {};
+    state->t = t;
+    state->location.position = {(f32) i, (f32) (i * 2) - 30.0f, t * 3.0f};
+
+    // Random-ish unit quaternion, every 3rd mob flips the sign (same rotation, opposite hemisphere)
+    f32 qx = (f32) ((i * 7 + (uint32) t) % 11) - 5.0f;
+    f32 qy = (f32) ((i * 3) % 5) - 2.0f;
+    f32 qz = (f32) ((i * 5) % 7) - 3.0f;
+    f32 qw = 4.0f;
+    const f32 len = sqrtf(qx * qx + qy * qy + qz * qz + qw * qw);
+    const f32 sign = (i % 3 == 0 && t > 1.0f) ? -1.0f : 1.0f;
+
+    state->location.orientation = {qx / len * sign, qy / len * sign, qz / len * sign, qw / len * sign};
+}
+
+// AoS reference, same as mob_interpolate()
+struct MobStoreTestMob {
+    MobState state;
+    MobState state1;
+    MobState state2;
+};
+
+static void mob_store_test_interpolate(MobStoreTestMob* mob, f32 time) {
+    const MobState* s1 = &mob->state1;
+    const MobState* s2 = &mob->state2;
+
+    const f32 t1 = oms_clamp(s2->t - s1->t, 0.1f, 1.0f);
+    const f32 p = oms_min((time - s2->t) / t1, 1.0f);
+
+    mob->state.location.position.x = s1->location.position.x + (s2->location.position.x - s1->location.position.x) * p;
+    mob->state.location.position.y = s1->location.position.y + (s2->location.position.y - s1->location.position.y) * p;
+    mob->state.location.position.z = s1->location.position.z + (s2->location.position.z - s1->location.position.z) * p;
+
+    mob->state.location.orientation.x = s1->location.orientation.x + (s2->location.orientation.x - s1->location.orientation.x) * p;
+    mob->state.location.orientation.y = s1->location.orientation.y + (s2->location.orientation.y - s1->location.orientation.y) * p;
+    mob->state.location.orientation.z = s1->location.orientation.z + (s2->location.orientation.z - s1->location.orientation.z) * p;
+    mob->state.location.orientation.w = s1->location.orientation.w + (s2->location.orientation.w - s1->location.orientation.w) * p;
+}
+
+static void mob_store_test_create(MobStore* store, byte* buf) {
+    mob_store_init(store, MOB_STORE_TEST_COUNT, buf);
+
+    MobState state;
+    for (uint32 i = 0; i < MOB_STORE_TEST_COUNT; ++i) {
+        mob_store_test_state(&state, i, 1.0f);
+        mob_store_add(store, 1000 + i, &state, 1.0f);
+
+        // Different snapshot distances per mob
+        mob_store_test_state(&state, i, 1.0f + 0.05f * (f32) (i % 30));
+        mob_store_push(store, i, &state, 1.0f + 0.01f * (f32) i);
+    }
+}
+
+static void test_mob_store_add_remove() {
+    MobStore store;
+    byte* buf = (byte *) malloc(mob_store_size(MOB_STORE_TEST_COUNT));
+    mob_store_test_create(&store, buf);
+
+    TEST_EQUALS(store.capacity, 64);
+    TEST_EQUALS(store.count, MOB_STORE_TEST_COUNT);
+
+    MobState state;
+    mob_store_test_state(&state, 0, 1.0f);
+    for (int32 i = store.count; i < store.capacity; ++i) {
+        TEST_EQUALS(mob_store_add(&store, 0, &state), i);
+    }
+    TEST_EQUALS(mob_store_add(&store, 0, &state), -1);
+
+    // The last mob takes the place of the removed one
+    store.count = MOB_STORE_TEST_COUNT;
+    mob_store_remove(&store, 5);
+    TEST_EQUALS(store.count, MOB_STORE_TEST_COUNT - 1);
+    TEST_EQUALS(store.ids[5], 1000 + MOB_STORE_TEST_COUNT - 1);
+    TEST_EQUALS(store.state2.x[5], (f32) (MOB_STORE_TEST_COUNT - 1));
+    TEST_EQUALS_WITH_DELTA(store.state2.scale[5], 1.0f + 0.01f * (MOB_STORE_TEST_COUNT - 1), 0.0001f);
+
+    free(buf);
+}
+
+// Same result as the AoS interpolation
+static void test_mob_store_interpolate_matches_mob() {
+    MobStore store;
+    byte* buf = (byte *) malloc(mob_store_size(MOB_STORE_TEST_COUNT));
+    mob_store_test_create(&store, buf);
+
+    MobStoreTestMob mob = {};
+    mob_store_test_state(&mob.state1, 4, 1.0f);
+    mob_store_test_state(&mob.state2, 4, 1.0f + 0.05f * 4);
+
+    const f32 time = 2.0f;
+    mob_store_test_interpolate(&mob, time);
+
+    MobRenderInstance instance;
+    const int32 index = 4;
+    mob_store_interpolate(&store, time, &index, 1, &instance, 1);
+
+    TEST_EQUALS_WITH_DELTA(instance.model[3], mob.state.location.position.x, 0.0001f);
+    TEST_EQUALS_WITH_DELTA(instance.model[7], mob.state.location.position.y, 0.0001f);
+    TEST_EQUALS_WITH_DELTA(instance.model[11], mob.state.location.position.z, 0.0001f);
+
+    // The rotation matrix is orthogonal and scaled
+    const f32 scale = 1.0f + 0.01f * 4;
+    const f32* m = instance.model;
+    TEST_EQUALS_WITH_DELTA(m[0] * m[0] + m[4] * m[4] + m[8] * m[8], scale * scale, 0.0001f);
+    TEST_EQUALS_WITH_DELTA(m[0] * m[1] + m[4] * m[5] + m[8] * m[9], 0.0f, 0.0001f);
+
+    free(buf);
+}
+
+static void test_mob_store_interpolate_simd() {
+    MobStore store;
+    byte* buf = (byte *) malloc(mob_store_size(MOB_STORE_TEST_COUNT));
+    mob_store_test_create(&store, buf);
+
+    // Visible mobs in random order
+    int32 visible[MOB_STORE_TEST_COUNT - 4];
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(visible); ++i) {
+        visible[i] = (i * 17 + 3) % MOB_STORE_TEST_COUNT;
+    }
+
+    MobRenderInstance expected[MOB_STORE_TEST_COUNT];
+    MobRenderInstance result[MOB_STORE_TEST_COUNT];
+
+    const int32 steps[] = {4, 8};
+    const f32 times[] = {1.5f, 2.0f, 3.0f, 0.5f};
+
+    f32 max_diff = 0.0f;
+    for (int32 t = 0; t < (int32) ARRAY_COUNT(times); ++t) {
+        for (int32 s = 0; s < (int32) ARRAY_COUNT(steps); ++s) {
+            mob_store_interpolate(&store, times[t], NULL, MOB_STORE_TEST_COUNT, expected, 1);
+            mob_store_interpolate(&store, times[t], NULL, MOB_STORE_TEST_COUNT, result, steps[s]);
+
+            for (int32 i = 0; i < MOB_STORE_TEST_COUNT; ++i) {
+                for (int32 j = 0; j < 12; ++j) {
+                    max_diff = oms_max(max_diff, fabsf(expected[i].model[j] - result[i].model[j]));
+                }
+            }
+
+            mob_store_interpolate(&store, times[t], visible, ARRAY_COUNT(visible), result, steps[s]);
+
+            for (int32 i = 0; i < (int32) ARRAY_COUNT(visible); ++i) {
+                for (int32 j = 0; j < 12; ++j) {
+                    max_diff = oms_max(max_diff, fabsf(expected[visible[i]].model[j] - result[i].model[j]));
+                }
+            }
+        }
+    }
+
+    TEST_LESSER_THAN(max_diff, 0.00001f);
+
+    free(buf);
+}
+
+#if PERFORMANCE_TEST
+#define MOB_STORE_TEST_PERF_COUNT 1024
+
+static MobStoreTestMob _mob_store_perf_mobs[MOB_STORE_TEST_PERF_COUNT];
+static MobStore _mob_store_perf_store;
+static MobRenderInstance _mob_store_perf_instances[MOB_STORE_TEST_PERF_COUNT];
+
+static void _mob_store_perf_init() {
+    static byte* buf = NULL;
+    if (buf) {
+        return;
+    }
+
+    buf = (byte *) malloc(mob_store_size(MOB_STORE_TEST_PERF_COUNT));
+    mob_store_init(&_mob_store_perf_store, MOB_STORE_TEST_PERF_COUNT, buf);
+
+    for (uint32 i = 0; i < MOB_STORE_TEST_PERF_COUNT; ++i) {
+        MobStoreTestMob* mob = &_mob_store_perf_mobs[i];
+        mob_store_test_state(&mob->state1, i, 1.0f);
+        mob_store_test_state(&mob->state2, i, 1.0f + 0.05f * (f32) (i % 30));
+
+        mob_store_add(&_mob_store_perf_store, i, &mob->state1);
+        mob_store_push(&_mob_store_perf_store, i, &mob->state2);
+    }
+}
+
+static void _mob_store_interpolate_soa(volatile void* val) {
+    _mob_store_perf_init();
+    mob_store_interpolate(&_mob_store_perf_store, 1.7f, NULL, MOB_STORE_TEST_PERF_COUNT, _mob_store_perf_instances);
+
+    *((volatile f32 *) val) += _mob_store_perf_instances[MOB_STORE_TEST_PERF_COUNT - 1].model[3];
+}
+
+// The AoS interpolation + building the instance matrix from the interpolated state
+static void _mob_store_interpolate_aos(volatile void* val) {
+    _mob_store_perf_init();
+
+    for (int32 i = 0; i < MOB_STORE_TEST_PERF_COUNT; ++i) {
+        MobStoreTestMob* mob = &_mob_store_perf_mobs[i];
+        mob_store_test_interpolate(mob, 1.7f);
+
+        const v3_f32* pos = &mob->state.location.position;
+        const v4_f32* q = &mob->state.location.orientation;
+        const f32 len = sqrtf(q->x * q->x + q->y * q->y + q->z * q->z + q->w * q->w);
+        const f32 qx = q->x / len; const f32 qy = q->y / len; const f32 qz = q->z / len; const f32 qw = q->w / len;
+
+        f32* m = _mob_store_perf_instances[i].model;
+        m[0] = 1.0f - 2.0f * (qy * qy + qz * qz); m[1] = 2.0f * (qx * qy - qw * qz); m[2] = 2.0f * (qx * qz + qw * qy); m[3] = pos->x;
+        m[4] = 2.0f * (qx * qy + qw * qz); m[5] = 1.0f - 2.0f * (qx * qx + qz * qz); m[6] = 2.0f * (qy * qz - qw * qx); m[7] = pos->y;
+        m[8] = 2.0f * (qx * qz - qw * qy); m[9] = 2.0f * (qy * qz + qw * qx); m[10] = 1.0f - 2.0f * (qx * qx + qy * qy); m[11] = pos->z;
+    }
+
+    *((volatile f32 *) val) += _mob_store_perf_instances[MOB_STORE_TEST_PERF_COUNT - 1].model[3];
+}
+
+static void test_mob_store_interpolate_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_mob_store_interpolate_soa, _mob_store_interpolate_aos, -50.0);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main MobStoreTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_mob_store_add_remove);
+    TEST_RUN(test_mob_store_interpolate_matches_mob);
+    TEST_RUN(test_mob_store_interpolate_simd);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_mob_store_interpolate_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
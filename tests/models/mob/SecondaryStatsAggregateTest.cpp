@@ -0,0 +1,254 @@
+#include "../../TestFramework.h"
+#include "../../../models/mob/SecondaryStatsAggregate.h"
+
+#define SECONDARY_STATS_TEST_SOURCES 8
+
+static void secondary_stats_test_points(SecondaryStatsPoints* points, uint32 seed, int32 modulo) {
+    uint16* stats = (uint16 *) points;
+    for (int32 i = 0; i < SECONDARY_STAT_SIZE; ++i) {
+        seed = seed * 1664525U + 1013904223U;
+        // Only some stats are modified
+        stats[i] = (seed >> 28) < 4 ? (uint16) ((seed >> 8) % modulo) : 0;
+    }
+}
+
+// Field by field reference
+static void secondary_stats_test_reference(
+    SecondaryStatsPoints* result, const SecondaryStatsPoints* base,
+    const SecondaryStatsPoints* add, const SecondaryStatsPoints* mul, const bool* active, int32 count,
+    const SecondaryStatsVector* caps
+) {
+    for (int32 i = 0; i < SECONDARY_STAT_SIZE; ++i) {
+        uint32 sum_add = ((const uint16 *) base)[i];
+        uint32 sum_mul = 0;
+
+        for (int32 j = 0; j < count; ++j) {
+            if (active[j]) {
+                sum_add += ((const uint16 *) &add[j])[i];
+                sum_mul += ((const uint16 *) &mul[j])[i];
+            }
+        }
+
+        sum_add = oms_min(sum_add, 0xFFFFU);
+        const uint64 value = (uint64) sum_add * oms_min(sum_mul + 100, 0xFFFFU) / 100;
+
+        ((uint16 *) result)[i] = (uint16) oms_min(oms_min(value, (uint64) 0xFFFF), (uint64) (caps ? caps->stats[i] : 0xFFFF));
+    }
+}
+
+static void test_secondary_stats_vector() {
+    SecondaryStatsPoints points = {};
+    SecondaryStatsVector vec;
+
+    TEST_EQUALS(secondary_stats_vector(&vec, &points), 0);
+    TEST_EQUALS(secondary_stats_vector(&vec, NULL), 0);
+
+    points.dmg[0] = 5;
+    points.aggro_range = 7;
+    TEST_EQUALS(secondary_stats_vector(&vec, &points), (1U << 0) | (1U << ((SECONDARY_STAT_SIZE - 1) / 16)));
+    TEST_EQUALS(vec.stats[SECONDARY_STAT_SIZE - 1], 7);
+    TEST_EQUALS(vec.stats[SECONDARY_STATS_LANES - 1], 0);
+}
+
+static void test_secondary_stats_update() {
+    SecondaryStatsPoints base;
+    SecondaryStatsPoints add[SECONDARY_STATS_TEST_SOURCES];
+    SecondaryStatsPoints mul[SECONDARY_STATS_TEST_SOURCES];
+    bool active[SECONDARY_STATS_TEST_SOURCES] = {};
+
+    secondary_stats_test_points(&base, 1, 1000);
+    for (int32 i = 0; i < SECONDARY_STATS_TEST_SOURCES; ++i) {
+        // The last source saturates
+        secondary_stats_test_points(&add[i], 10 + i, i == SECONDARY_STATS_TEST_SOURCES - 1 ? 0xFFFF : 500);
+        secondary_stats_test_points(&mul[i], 100 + i, 50);
+    }
+
+    SecondaryStatsVector caps;
+    for (int32 i = 0; i < SECONDARY_STATS_LANES; ++i) {
+        caps.stats[i] = i % 5 == 0 ? 300 : 0xFFFF;
+    }
+
+    const int32 steps[] = {1, 4, 8};
+    bool is_valid = true;
+
+    for (int32 s = 0; s < (int32) ARRAY_COUNT(steps); ++s) {
+        byte buf[SECONDARY_STATS_TEST_SOURCES * sizeof(SecondaryStatsSource)];
+        SecondaryStatsAggregate agg;
+        secondary_stats_aggregate_init(&agg, &base, SECONDARY_STATS_TEST_SOURCES, buf);
+
+        SecondaryStatsPoints expected;
+        memset(active, 0, sizeof(active));
+
+        for (int32 i = 0; i < SECONDARY_STATS_TEST_SOURCES; ++i) {
+            secondary_stats_source_set(&agg, i, &add[i], &mul[i]);
+            active[i] = true;
+
+            secondary_stats_update(&agg, &caps, steps[s]);
+            secondary_stats_test_reference(&expected, &base, add, mul, active, SECONDARY_STATS_TEST_SOURCES, &caps);
+            is_valid &= memcmp(secondary_stats_points(&agg), &expected, sizeof(expected)) == 0;
+        }
+
+        // Buffs expire
+        for (int32 i = 0; i < SECONDARY_STATS_TEST_SOURCES; i += 3) {
+            secondary_stats_source_remove(&agg, i);
+            active[i] = false;
+
+            secondary_stats_update(&agg, &caps, steps[s]);
+            secondary_stats_test_reference(&expected, &base, add, mul, active, SECONDARY_STATS_TEST_SOURCES, &caps);
+            is_valid &= memcmp(secondary_stats_points(&agg), &expected, sizeof(expected)) == 0;
+        }
+
+        // Base stats change (e.g. level up) without caps
+        secondary_stats_test_points(&base, 2, 0xFFFF);
+        secondary_stats_base_set(&agg, &base);
+
+        secondary_stats_update(&agg, NULL, steps[s]);
+        secondary_stats_test_reference(&expected, &base, add, mul, active, SECONDARY_STATS_TEST_SOURCES, NULL);
+        is_valid &= memcmp(secondary_stats_points(&agg), &expected, sizeof(expected)) == 0;
+
+        secondary_stats_test_points(&base, 1, 1000);
+    }
+
+    TEST_TRUE(is_valid);
+}
+
+static void test_secondary_stats_update_dirty() {
+    SecondaryStatsPoints base = {};
+    base.health = 100;
+    base.dodge_chance = 10;
+
+    SecondaryStatsAggregate aggs[3];
+    byte buf[3][2 * sizeof(SecondaryStatsSource)];
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(aggs); ++i) {
+        secondary_stats_aggregate_init(&aggs[i], &base, 2, buf[i]);
+    }
+
+    TEST_EQUALS(secondary_stats_update_all(aggs, ARRAY_COUNT(aggs)), 3);
+    TEST_EQUALS(secondary_stats_update_all(aggs, ARRAY_COUNT(aggs)), 0);
+    TEST_EQUALS(secondary_stats_points(&aggs[1])->health, 100);
+
+    SecondaryStatsPoints buff_add = {};
+    buff_add.dodge_chance = 5;
+    SecondaryStatsPoints buff_mul = {};
+    buff_mul.dodge_chance = 50;
+
+    secondary_stats_source_set(&aggs[1], 0, &buff_add, &buff_mul);
+
+    // Only the block of dodge_chance on the buffed mob is recomputed
+    const int32 dodge_block = (int32) (offsetof(SecondaryStatsPoints, dodge_chance) / sizeof(uint16)) / SECONDARY_STATS_BLOCK_SIZE;
+    TEST_EQUALS(aggs[1].dirty, 1U << dodge_block);
+
+    TEST_EQUALS(secondary_stats_update_all(aggs, ARRAY_COUNT(aggs)), 1);
+    TEST_EQUALS(secondary_stats_points(&aggs[1])->dodge_chance, (10 + 5) * 150 / 100);
+    TEST_EQUALS(secondary_stats_points(&aggs[0])->dodge_chance, 10);
+
+    secondary_stats_source_remove(&aggs[1], 0);
+    TEST_EQUALS(aggs[1].dirty, 1U << dodge_block);
+
+    TEST_EQUALS(secondary_stats_update_all(aggs, ARRAY_COUNT(aggs)), 1);
+    TEST_EQUALS(secondary_stats_points(&aggs[1])->dodge_chance, 10);
+
+    // Removing an inactive source changes nothing
+    secondary_stats_source_remove(&aggs[1], 0);
+    TEST_EQUALS(secondary_stats_update_all(aggs, ARRAY_COUNT(aggs)), 0);
+}
+
+#if PERFORMANCE_TEST
+#define SECONDARY_STATS_TEST_PERF_MOBS 1024
+
+static SecondaryStatsAggregate _secondary_stats_perf_aggs[SECONDARY_STATS_TEST_PERF_MOBS];
+static SecondaryStatsPoints _secondary_stats_perf_base;
+static SecondaryStatsPoints _secondary_stats_perf_add[SECONDARY_STATS_TEST_SOURCES];
+static SecondaryStatsPoints _secondary_stats_perf_mul[SECONDARY_STATS_TEST_SOURCES];
+static SecondaryStatsPoints _secondary_stats_perf_result[SECONDARY_STATS_TEST_PERF_MOBS];
+static bool _secondary_stats_perf_active[SECONDARY_STATS_TEST_SOURCES];
+
+static void _secondary_stats_perf_init() {
+    static byte* buf = NULL;
+    if (buf) {
+        return;
+    }
+
+    secondary_stats_test_points(&_secondary_stats_perf_base, 1, 1000);
+    for (int32 i = 0; i < SECONDARY_STATS_TEST_SOURCES; ++i) {
+        secondary_stats_test_points(&_secondary_stats_perf_add[i], 10 + i, 500);
+        secondary_stats_test_points(&_secondary_stats_perf_mul[i], 100 + i, 50);
+        _secondary_stats_perf_active[i] = true;
+    }
+
+    buf = (byte *) malloc(SECONDARY_STATS_TEST_PERF_MOBS * secondary_stats_aggregate_size(SECONDARY_STATS_TEST_SOURCES));
+    for (int32 i = 0; i < SECONDARY_STATS_TEST_PERF_MOBS; ++i) {
+        SecondaryStatsAggregate* agg = &_secondary_stats_perf_aggs[i];
+        secondary_stats_aggregate_init(
+            agg, &_secondary_stats_perf_base, SECONDARY_STATS_TEST_SOURCES,
+            buf + i * secondary_stats_aggregate_size(SECONDARY_STATS_TEST_SOURCES)
+        );
+
+        for (int32 j = 0; j < SECONDARY_STATS_TEST_SOURCES; ++j) {
+            secondary_stats_source_set(agg, j, &_secondary_stats_perf_add[j], &_secondary_stats_perf_mul[j]);
+        }
+
+        secondary_stats_update(agg);
+    }
+}
+
+// A buff changes on a few mobs per frame
+static void _secondary_stats_update_incremental(volatile void* val) {
+    _secondary_stats_perf_init();
+
+    static int32 frame = 0;
+    ++frame;
+
+    for (int32 i = frame % 64; i < SECONDARY_STATS_TEST_PERF_MOBS; i += 64) {
+        if (frame & 1) {
+            secondary_stats_source_remove(&_secondary_stats_perf_aggs[i], 3);
+        } else {
+            secondary_stats_source_set(&_secondary_stats_perf_aggs[i], 3, &_secondary_stats_perf_add[3], &_secondary_stats_perf_mul[3]);
+        }
+    }
+
+    *((volatile int64 *) val) += secondary_stats_update_all(_secondary_stats_perf_aggs, SECONDARY_STATS_TEST_PERF_MOBS);
+}
+
+// The previous approach, every mob is recomputed field by field
+static void _secondary_stats_update_full(volatile void* val) {
+    _secondary_stats_perf_init();
+
+    for (int32 i = 0; i < SECONDARY_STATS_TEST_PERF_MOBS; ++i) {
+        secondary_stats_test_reference(
+            &_secondary_stats_perf_result[i], &_secondary_stats_perf_base,
+            _secondary_stats_perf_add, _secondary_stats_perf_mul, _secondary_stats_perf_active,
+            SECONDARY_STATS_TEST_SOURCES, NULL
+        );
+    }
+
+    *((volatile int64 *) val) += _secondary_stats_perf_result[SECONDARY_STATS_TEST_PERF_MOBS - 1].health;
+}
+
+static void test_secondary_stats_update_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_secondary_stats_update_incremental, _secondary_stats_update_full, -50.0);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main SecondaryStatsAggregateTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_secondary_stats_vector);
+    TEST_RUN(test_secondary_stats_update);
+    TEST_RUN(test_secondary_stats_update_dirty);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_secondary_stats_update_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include "../../../TestFramework.h"
+#include "../../../../models/mob/monster/LootTable.h"
+
+#define LOOT_TABLE_TEST_SEED 0x1234567890ABCDEFULL
+
+static uint64 _loot_test_items[] = {100, 200, 300};
+static f32 _loot_test_chances[] = {0.5f, 0.2f, 0.1f};
+static v2_int32 _loot_test_quantities[] = {{1, 1}, {2, 5}, {10, 10}};
+
+static void loot_table_test_create(LootTable* table, byte* buf) {
+    *table = {};
+    table->items = _loot_test_items;
+    table->item_count = ARRAY_COUNT(_loot_test_items);
+    table->item_chances = _loot_test_chances;
+    table->item_quantities = _loot_test_quantities;
+    table->table_chance = 1.0f;
+
+    loot_table_compile(table, buf);
+}
+
+static void test_loot_alias_create() {
+    LootTable table;
+    byte buf[64];
+    TEST_TRUE(loot_table_alias_size(3) <= (int64) sizeof(buf));
+    loot_table_test_create(&table, buf);
+
+    // 3 items + no drop
+    TEST_EQUALS(table.alias.column_count, 4);
+
+    const f64 weights[] = {1.0, 0.0, 3.0};
+    LootAliasTable alias;
+    loot_alias_create(&alias, weights, ARRAY_COUNT(weights), buf);
+
+    // The padding column and the column without weight are never returned
+    int32 counts[4] = {};
+    for (uint32 i = 0; i < 100000; ++i) {
+        ++counts[loot_alias_sample(&alias, loot_rand(i, 0), loot_rand(i, 1))];
+    }
+
+    TEST_EQUALS(counts[1], 0);
+    TEST_EQUALS(counts[3], 0);
+    TEST_TRUE(counts[0] > 24000 && counts[0] < 26000);
+}
+
+static void test_loot_table_distribution() {
+    LootTable table;
+    byte buf[64];
+    loot_table_test_create(&table, buf);
+
+    const int32 kill_count = 100000;
+    Drop* drops = (Drop *) malloc(kill_count * sizeof(Drop));
+
+    const int32 drop_count = loot_table_roll_batch(&table, LOOT_TABLE_TEST_SEED, 0, kill_count, 1, drops);
+
+    int32 counts[3] = {};
+    bool is_valid = true;
+    for (int32 i = 0; i < kill_count; ++i) {
+        if (drops[i].quantity == 0) {
+            continue;
+        }
+
+        const int32 index = (int32) (drops[i].item / 100 - 1);
+        ++counts[index];
+
+        is_valid &= drops[i].quantity >= (uint32) _loot_test_quantities[index].x
+            && drops[i].quantity <= (uint32) _loot_test_quantities[index].y;
+    }
+
+    TEST_TRUE(is_valid);
+
+    // 80% drop chance
+    TEST_TRUE(drop_count > 79000 && drop_count < 81000);
+    TEST_TRUE(counts[0] > 49000 && counts[0] < 51000);
+    TEST_TRUE(counts[1] > 19300 && counts[1] < 20700);
+    TEST_TRUE(counts[2] > 9500 && counts[2] < 10500);
+
+    // The table doesn't come into effect
+    table.table_chance = 0.0f;
+    TEST_EQUALS(loot_table_roll_batch(&table, LOOT_TABLE_TEST_SEED, 0, kill_count, 1, drops), 0);
+
+    free(drops);
+}
+
+// Drop has padding -> no memcmp
+static bool loot_table_test_equals(const Drop* a, const Drop* b, int32 count) {
+    for (int32 i = 0; i < count; ++i) {
+        if (a[i].item != b[i].item || a[i].quantity != b[i].quantity) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void test_loot_table_reproducible() {
+    LootTable table;
+    byte buf[64];
+    loot_table_test_create(&table, buf);
+    table.table_chance = 0.7f;
+
+    const int32 kill_count = 103;
+    const int32 roll_counts[] = {1, 3, 8, 13};
+    const int32 steps[] = {1, 4, 8};
+
+    Drop expected[kill_count * 13];
+    Drop drops[kill_count * 13];
+
+    // The batched rolls are identical to the single kill rolls independent of the SIMD width
+    bool is_valid = true;
+    for (int32 r = 0; r < (int32) ARRAY_COUNT(roll_counts); ++r) {
+        const int32 roll_count = roll_counts[r];
+
+        for (int32 k = 0; k < kill_count; ++k) {
+            loot_table_roll(&table, LOOT_TABLE_TEST_SEED, 5000 + k, roll_count, expected + k * roll_count);
+        }
+
+        for (int32 s = 0; s < (int32) ARRAY_COUNT(steps); ++s) {
+            loot_table_roll_batch(&table, LOOT_TABLE_TEST_SEED, 5000, kill_count, roll_count, drops, steps[s]);
+            is_valid &= loot_table_test_equals(drops, expected, kill_count * roll_count);
+        }
+    }
+
+    TEST_TRUE(is_valid);
+
+    // Different seed -> different drops
+    loot_table_roll_batch(&table, LOOT_TABLE_TEST_SEED + 1, 5000, kill_count, 13, drops);
+    TEST_FALSE(loot_table_test_equals(drops, expected, kill_count * 13));
+}
+
+#if PERFORMANCE_TEST
+#define LOOT_TABLE_TEST_PERF_ITEMS 64
+#define LOOT_TABLE_TEST_PERF_KILLS 64
+#define LOOT_TABLE_TEST_PERF_ROLLS 8
+
+static LootTable _loot_perf_table;
+static uint64 _loot_perf_items[LOOT_TABLE_TEST_PERF_ITEMS];
+static f32 _loot_perf_chances[LOOT_TABLE_TEST_PERF_ITEMS];
+static Drop _loot_perf_drops[LOOT_TABLE_TEST_PERF_KILLS * LOOT_TABLE_TEST_PERF_ROLLS];
+
+static void _loot_perf_init() {
+    static byte buf[1024];
+    if (_loot_perf_table.items) {
+        return;
+    }
+
+    for (int32 i = 0; i < LOOT_TABLE_TEST_PERF_ITEMS; ++i) {
+        _loot_perf_items[i] = i + 1;
+        _loot_perf_chances[i] = 0.9f / LOOT_TABLE_TEST_PERF_ITEMS;
+    }
+
+    _loot_perf_table.items = _loot_perf_items;
+    _loot_perf_table.item_count = LOOT_TABLE_TEST_PERF_ITEMS;
+    _loot_perf_table.item_chances = _loot_perf_chances;
+    _loot_perf_table.table_chance = 1.0f;
+
+    loot_table_compile(&_loot_perf_table, buf);
+}
+
+static void _loot_table_roll_alias(volatile void* val) {
+    _loot_perf_init();
+
+    *((volatile int64 *) val) += loot_table_roll_batch(
+        &_loot_perf_table, LOOT_TABLE_TEST_SEED, 0,
+        LOOT_TABLE_TEST_PERF_KILLS, LOOT_TABLE_TEST_PERF_ROLLS, _loot_perf_drops
+    );
+}
+
+// The previous implementation walked the cumulative probabilities
+static void _loot_table_roll_linear(volatile void* val) {
+    _loot_perf_init();
+
+    int32 drop_count = 0;
+    for (int32 k = 0; k < LOOT_TABLE_TEST_PERF_KILLS; ++k) {
+        const uint32 base = loot_kill_base(LOOT_TABLE_TEST_SEED, k);
+
+        for (int32 r = 0; r < LOOT_TABLE_TEST_PERF_ROLLS; ++r) {
+            const f32 rand = (f32) loot_rand(base, r) / (f32) MAX_UINT32;
+
+            f32 range_value = 0;
+            for (int32 i = 0; i < _loot_perf_table.item_count; ++i) {
+                range_value += _loot_perf_table.item_chances[i];
+
+                if (rand < range_value) {
+                    _loot_perf_drops[k * LOOT_TABLE_TEST_PERF_ROLLS + r].item = _loot_perf_table.items[i];
+                    _loot_perf_drops[k * LOOT_TABLE_TEST_PERF_ROLLS + r].quantity = 1;
+                    ++drop_count;
+
+                    break;
+                }
+            }
+        }
+    }
+
+    *((volatile int64 *) val) += drop_count;
+}
+
+static void test_loot_table_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_loot_table_roll_alias, _loot_table_roll_linear, -50.0);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main LootTableTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_loot_alias_create);
+    TEST_RUN(test_loot_table_distribution);
+    TEST_RUN(test_loot_table_reproducible);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_loot_table_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include "../../../TestFramework.h"
+#include "../../../../models/sampling/poisson/PoissonDisk.h"
+
+#define POISSON_DISK_TEST_SIZE 100.0f
+#define POISSON_DISK_TEST_R 2.0f
+
+static bool poisson_disk_test_min_distance(const v2_f32* points, int32 count, f32 r) {
+    for (int32 i = 0; i < count; ++i) {
+        for (int32 j = i + 1; j < count; ++j) {
+            const f32 dx = points[i].x - points[j].x;
+            const f32 dy = points[i].y - points[j].y;
+
+            if (dx * dx + dy * dy < r * r * 0.9999f) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Every position must be close to a point, otherwise there is a hole (e.g. at a tile border)
+static bool poisson_disk_test_coverage(const v2_f32* points, int32 count, f32 size, f32 r) {
+    for (f32 y = 0.5f; y < size; y += 1.0f) {
+        for (f32 x = 0.5f; x < size; x += 1.0f) {
+            bool is_covered = false;
+            for (int32 i = 0; i < count && !is_covered; ++i) {
+                const f32 dx = points[i].x - x;
+                const f32 dy = points[i].y - y;
+                is_covered = dx * dx + dy * dy < 4.0f * r * r;
+            }
+
+            if (!is_covered) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void test_poisson_disk_bridson() {
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    const int32 cap = poisson_disk_bridson_cap(POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_R);
+    v2_f32* points = (v2_f32 *) memory_get(&ring, cap * sizeof(v2_f32));
+
+    const int32 count = poisson_disk_bridson(
+        POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_R, 30, 1234,
+        cap, points, &ring
+    );
+
+    // The domain is larger than a tile -> tests the tile borders
+    TEST_TRUE(count > 1000);
+    TEST_TRUE(count < cap);
+
+    bool is_inside = true;
+    for (int32 i = 0; i < count; ++i) {
+        is_inside &= points[i].x >= 0.0f && points[i].x < POISSON_DISK_TEST_SIZE
+            && points[i].y >= 0.0f && points[i].y < POISSON_DISK_TEST_SIZE;
+    }
+
+    TEST_TRUE(is_inside);
+    TEST_TRUE(poisson_disk_test_min_distance(points, count, POISSON_DISK_TEST_R));
+    TEST_TRUE(poisson_disk_test_coverage(points, count, POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_R));
+
+    // Same seed -> same points
+    v2_f32* points2 = (v2_f32 *) memory_get(&ring, cap * sizeof(v2_f32));
+    const int32 count2 = poisson_disk_bridson(
+        POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_R, 30, 1234,
+        cap, points2, &ring
+    );
+
+    TEST_EQUALS(count, count2);
+    TEST_EQUALS(memcmp(points, points2, count * sizeof(v2_f32)), 0);
+
+    poisson_disk_bridson(
+        POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_R, 30, 4321,
+        cap, points2, &ring
+    );
+    TEST_NOT_EQUALS(memcmp(points, points2, 16 * sizeof(v2_f32)), 0);
+
+    // The output is truncated to the capacity
+    TEST_EQUALS(poisson_disk_bridson(10.0f, 10.0f, 1.0f, 30, 1, 5, points2, &ring), 5);
+
+    ring_free(&ring);
+}
+
+static f32 poisson_disk_test_importance(f32 x, f32, void*) {
+    return x / POISSON_DISK_TEST_SIZE;
+}
+
+static void test_poisson_disk_bridson_importance() {
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    const int32 cap = poisson_disk_bridson_cap(POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, 1.0f);
+    v2_f32* points = (v2_f32 *) memory_get(&ring, cap * sizeof(v2_f32));
+
+    const int32 count = poisson_disk_bridson_importance(
+        POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, 1.0f, 4.0f, 30, 99,
+        cap, points, &ring,
+        poisson_disk_test_importance, NULL
+    );
+
+    // Minimum distance is the larger radius of both points
+    bool is_valid = true;
+    int32 left = 0;
+    for (int32 i = 0; i < count; ++i) {
+        const f32 ri = 4.0f - 3.0f * poisson_disk_test_importance(points[i].x, 0.0f, NULL);
+        left += points[i].x < POISSON_DISK_TEST_SIZE * 0.5f;
+
+        for (int32 j = i + 1; j < count; ++j) {
+            const f32 rj = 4.0f - 3.0f * poisson_disk_test_importance(points[j].x, 0.0f, NULL);
+            const f32 r = oms_max(ri, rj);
+
+            const f32 dx = points[i].x - points[j].x;
+            const f32 dy = points[i].y - points[j].y;
+            is_valid &= dx * dx + dy * dy >= r * r * 0.9999f;
+        }
+    }
+
+    TEST_TRUE(is_valid);
+
+    // Higher importance -> more points
+    TEST_TRUE(count - left > 2 * left);
+
+    ring_free(&ring);
+}
+
+static void test_poisson_disk_bridson_sphere() {
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    const f32 r = 0.1f;
+    const int32 cap = 4096;
+    v3_f32* points = (v3_f32 *) memory_get(&ring, cap * sizeof(v3_f32));
+
+    const int32 count = poisson_disk_bridson_sphere(r, 30, 7, cap, points, &ring);
+
+    // Sphere area / disk area of radius r/2 is the upper bound for non-overlapping disks
+    TEST_TRUE(count > 700);
+    TEST_TRUE(count < (int32) (4.0f / (0.25f * r * r)));
+
+    const f32 chord = 2.0f * sinf(r * 0.5f);
+
+    bool is_valid = true;
+    for (int32 i = 0; i < count; ++i) {
+        const f32 length = points[i].x * points[i].x + points[i].y * points[i].y + points[i].z * points[i].z;
+        is_valid &= fabsf(length - 1.0f) < 0.001f;
+
+        for (int32 j = i + 1; j < count; ++j) {
+            const f32 dx = points[i].x - points[j].x;
+            const f32 dy = points[i].y - points[j].y;
+            const f32 dz = points[i].z - points[j].z;
+            is_valid &= dx * dx + dy * dy + dz * dz >= chord * chord * 0.9999f;
+        }
+    }
+
+    TEST_TRUE(is_valid);
+
+    ring_free(&ring);
+}
+
+// The tiles of a phase run in parallel, the result must still be identical to the single threaded one
+static void test_poisson_disk_bridson_thread_pool() {
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    const int32 cap = poisson_disk_bridson_cap(POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, 1.0f);
+    v2_f32* expected = (v2_f32 *) memory_get(&ring, cap * sizeof(v2_f32));
+    v2_f32* expected_importance = (v2_f32 *) memory_get(&ring, cap * sizeof(v2_f32));
+    v2_f32* points = (v2_f32 *) memory_get(&ring, cap * sizeof(v2_f32));
+
+    const int32 count = poisson_disk_bridson(
+        POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_R, 30, 1234,
+        cap, expected, &ring
+    );
+
+    const int32 count_importance = poisson_disk_bridson_importance(
+        POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, 1.0f, 4.0f, 30, 99,
+        cap, expected_importance, &ring,
+        poisson_disk_test_importance, NULL
+    );
+
+    const int32 thread_counts[] = {1, 4};
+    for (int32 t = 0; t < (int32) ARRAY_COUNT(thread_counts); ++t) {
+        ThreadPool pool = {};
+        thread_pool_alloc(&pool, thread_counts[t], 128);
+
+        memset(points, 0, cap * sizeof(v2_f32));
+        TEST_EQUALS(
+            poisson_disk_bridson(
+                POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_R, 30, 1234,
+                cap, points, &ring, &pool
+            ),
+            count
+        );
+        TEST_EQUALS(memcmp(points, expected, count * sizeof(v2_f32)), 0);
+
+        memset(points, 0, cap * sizeof(v2_f32));
+        TEST_EQUALS(
+            poisson_disk_bridson_importance(
+                POISSON_DISK_TEST_SIZE, POISSON_DISK_TEST_SIZE, 1.0f, 4.0f, 30, 99,
+                cap, points, &ring,
+                poisson_disk_test_importance, NULL, &pool
+            ),
+            count_importance
+        );
+        TEST_EQUALS(memcmp(points, expected_importance, count_importance * sizeof(v2_f32)), 0);
+
+        thread_pool_destroy(&pool);
+    }
+
+    ring_free(&ring);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main PoissonDiskTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_poisson_disk_bridson);
+    TEST_RUN(test_poisson_disk_bridson_importance);
+    TEST_RUN(test_poisson_disk_bridson_sphere);
+    TEST_RUN(test_poisson_disk_bridson_thread_pool);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include "../TestFramework.h"
+#include "../../network/AreaOfInterest.h"
+
+static int32 aoi_test_count_events(const AoiEvent* events, int32 count, AoiEventType type, int32 entity) {
+    int32 found = 0;
+    for (int32 i = 0; i < count; ++i) {
+        if (events[i].type == type && events[i].entity == entity) {
+            ++found;
+        }
+    }
+
+    return found;
+}
+
+static void test_aoi_enter_leave() {
+    AreaOfInterest aoi;
+    aoi_alloc(&aoi, {0.0f, 0.0f, 0.0f}, 32.0f, 16, 16, 128, 2);
+
+    AoiEvent events[256];
+
+    aoi_entity_add(&aoi, 0, {10.0f, 0.0f, 10.0f});
+    aoi_entity_add(&aoi, 1, {60.0f, 0.0f, 10.0f});
+    aoi_entity_add(&aoi, 2, {500.0f, 0.0f, 500.0f});
+
+    aoi_client_set(&aoi, 0, {0.0f, 0.0f, 0.0f}, 64.0f, 8.0f);
+
+    int32 count = aoi_client_update(&aoi, 0, events);
+    TEST_EQUALS(count, 2);
+    TEST_EQUALS(aoi_test_count_events(events, count, AOI_EVENT_ENTER, 0), 1);
+    TEST_EQUALS(aoi_test_count_events(events, count, AOI_EVENT_ENTER, 1), 1);
+    TEST_TRUE(aoi_client_is_relevant(&aoi, 0, 0));
+    TEST_TRUE(aoi_client_is_relevant(&aoi, 0, 1));
+    TEST_FALSE(aoi_client_is_relevant(&aoi, 0, 2));
+    TEST_EQUALS(aoi.clients[0].relevant_count, 2);
+
+    // Nothing changed -> no events
+    TEST_EQUALS(aoi_client_update(&aoi, 0, events), 0);
+
+    // Inside of the hysteresis -> stays relevant
+    aoi_entity_move(&aoi, 1, {68.0f, 0.0f, 10.0f});
+    TEST_EQUALS(aoi_client_update(&aoi, 0, events), 0);
+    TEST_TRUE(aoi_client_is_relevant(&aoi, 0, 1));
+
+    // Outside of view radius + hysteresis -> leave
+    aoi_entity_move(&aoi, 1, {80.0f, 0.0f, 10.0f});
+    count = aoi_client_update(&aoi, 0, events);
+    TEST_EQUALS(count, 1);
+    TEST_EQUALS(aoi_test_count_events(events, count, AOI_EVENT_LEAVE, 1), 1);
+    TEST_FALSE(aoi_client_is_relevant(&aoi, 0, 1));
+
+    // Inside of the hysteresis but not relevant before -> doesn't enter
+    aoi_entity_move(&aoi, 1, {68.0f, 0.0f, 10.0f});
+    TEST_EQUALS(aoi_client_update(&aoi, 0, events), 0);
+
+    // Removed entity -> leave
+    aoi_entity_remove(&aoi, 0);
+    count = aoi_client_update(&aoi, 0, events);
+    TEST_EQUALS(count, 1);
+    TEST_EQUALS(aoi_test_count_events(events, count, AOI_EVENT_LEAVE, 0), 1);
+
+    // Client moves to the far entity
+    aoi_client_set(&aoi, 0, {490.0f, 0.0f, 490.0f}, 64.0f, 8.0f);
+    count = aoi_client_update(&aoi, 0, events);
+    TEST_EQUALS(count, 1);
+    TEST_EQUALS(aoi_test_count_events(events, count, AOI_EVENT_ENTER, 2), 1);
+
+    // The second client is independent
+    aoi_client_set(&aoi, 1, {60.0f, 0.0f, 0.0f}, 16.0f);
+    count = aoi_client_update(&aoi, 1, events);
+    TEST_EQUALS(count, 1);
+    TEST_EQUALS(aoi_test_count_events(events, count, AOI_EVENT_ENTER, 1), 1);
+    TEST_TRUE(aoi_client_is_relevant(&aoi, 0, 2));
+
+    aoi_client_reset(&aoi, 1);
+    TEST_FALSE(aoi_client_is_relevant(&aoi, 1, 1));
+    TEST_EQUALS(aoi.clients[1].relevant_count, 0);
+
+    aoi_free(&aoi);
+}
+
+// Moving an entity that isn't in the grid must not touch the cell lists
+static void test_aoi_move_invalid_entity() {
+    AreaOfInterest aoi;
+    aoi_alloc(&aoi, {0.0f, 0.0f, 0.0f}, 32.0f, 16, 16, 128, 1);
+
+    AoiEvent events[256];
+
+    aoi_entity_add(&aoi, 0, {10.0f, 0.0f, 10.0f});
+    aoi_entity_add(&aoi, 1, {12.0f, 0.0f, 10.0f});
+    aoi_entity_remove(&aoi, 0);
+
+    // Already removed and never added
+    aoi_entity_move(&aoi, 0, {300.0f, 0.0f, 300.0f});
+    aoi_entity_move(&aoi, 5, {300.0f, 0.0f, 300.0f});
+    TEST_EQUALS(aoi.entity_cell[0], AOI_INVALID_CELL);
+    TEST_EQUALS(aoi.entity_cell[5], AOI_INVALID_CELL);
+
+    aoi_client_set(&aoi, 0, {300.0f, 0.0f, 300.0f}, 64.0f);
+    TEST_EQUALS(aoi_client_update(&aoi, 0, events), 0);
+
+    // The remaining entity is still linked correctly
+    aoi_client_set(&aoi, 0, {0.0f, 0.0f, 0.0f}, 64.0f);
+    const int32 count = aoi_client_update(&aoi, 0, events);
+    TEST_EQUALS(count, 1);
+    TEST_EQUALS(aoi_test_count_events(events, count, AOI_EVENT_ENTER, 1), 1);
+
+    aoi_free(&aoi);
+}
+
+static void test_aoi_matches_brute_force() {
+    AreaOfInterest aoi;
+    aoi_alloc(&aoi, {-512.0f, 0.0f, -512.0f}, 64.0f, 16, 16, 1000, 1);
+
+    AoiEvent events[2000];
+    v3_f32 positions[1000];
+
+    uint32 seed = 12345;
+    for (int32 i = 0; i < 1000; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        positions[i].x = (f32) ((seed >> 8) % 1024) - 512.0f;
+        seed = seed * 1664525 + 1013904223;
+        positions[i].z = (f32) ((seed >> 8) % 1024) - 512.0f;
+        positions[i].y = 0.0f;
+
+        aoi_entity_add(&aoi, i, positions[i]);
+    }
+
+    aoi_client_set(&aoi, 0, {0.0f, 0.0f, 0.0f}, 100.0f);
+
+    for (int32 tick = 0; tick < 10; ++tick) {
+        // Everything moves, also across cell borders and outside of the grid (= clamped)
+        for (int32 i = 0; i < 1000; ++i) {
+            positions[i].x += (f32) ((i * 7 + tick * 13) % 41) - 20.0f;
+            positions[i].z += (f32) ((i * 11 + tick * 3) % 41) - 20.0f;
+            aoi_entity_move(&aoi, i, positions[i]);
+        }
+
+        aoi_client_update(&aoi, 0, events);
+
+        int32 expected = 0;
+        for (int32 i = 0; i < 1000; ++i) {
+            const bool in_range = positions[i].x * positions[i].x + positions[i].z * positions[i].z <= 100.0f * 100.0f;
+            expected += in_range;
+
+            TEST_EQUALS(aoi_client_is_relevant(&aoi, 0, i), in_range);
+        }
+
+        TEST_EQUALS(aoi.clients[0].relevant_count, expected);
+
+        int32 found[1000];
+        TEST_EQUALS(aoi_query(&aoi, {0.0f, 0.0f, 0.0f}, 100.0f, found, ARRAY_COUNT(found)), expected);
+    }
+
+    aoi_free(&aoi);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main AreaOfInterestTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_aoi_enter_leave);
+    TEST_RUN(test_aoi_move_invalid_entity);
+    TEST_RUN(test_aoi_matches_brute_force);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
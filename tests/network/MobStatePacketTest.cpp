@@ -0,0 +1,228 @@
+#include "../TestFramework.h"
+#include "../../network/packet/mob/MobStatePacket.h"
+
+#define MOB_STATE_TEST_COUNT 200
+
+static const MobStateQuantization _mob_state_test_quant = {
+    0.0f, 256.0f, // chunk local position
+    18, // ~1 mm precision
+    7,
+    10,
+    8,
+};
+
+static void mob_state_test_states(MobStatePacketSnapshotUnpacked* states, int32 count) {
+    for (int32 i = 0; i < count; ++i) {
+        states[i].mob_id = 10 + i * ((i % 7) == 0 ? 3 : 1);
+        states[i].mob_type = (byte) (i % 5);
+        states[i].chunk = 1000 + i / 50;
+        states[i].x = (f32) (i % 256);
+        states[i].y = 64.0f + (i % 3) * 0.25f;
+        states[i].z = 128.0f - (f32) (i % 100);
+        states[i].roll = 0.0f;
+        states[i].pitch = 0.1f * (i % 4);
+        states[i].yaw = -1.0f + 0.01f * i;
+        states[i].state_flag = i % 3;
+    }
+
+    // Mob ids must be sorted
+    for (int32 i = 1; i < count; ++i) {
+        if (states[i].mob_id <= states[i - 1].mob_id) {
+            states[i].mob_id = states[i - 1].mob_id + 1;
+        }
+    }
+}
+
+static void test_mob_state_quantize() {
+    MobStatePacketSnapshotUnpacked state = {};
+    state.x = 12.345f;
+    state.y = 300.0f; // out of range -> clamped
+    state.z = -1.0f;
+    state.yaw = -OMS_PI_OVER_TWO_F32;
+    state.state_flag = 0x1FF;
+
+    MobStateQuantized quantized;
+    mob_state_quantize(&state, &quantized, &_mob_state_test_quant);
+
+    MobStatePacketSnapshotUnpacked result;
+    mob_state_dequantize(&quantized, &result, &_mob_state_test_quant);
+
+    TEST_TRUE(fabsf(result.x - 12.345f) < 0.001f);
+    TEST_TRUE(fabsf(result.y - 256.0f) < 0.001f);
+    TEST_TRUE(fabsf(result.z) < 0.001f);
+
+    // -pi/2 == 3pi/2
+    TEST_TRUE(fabsf(result.yaw - 3.0f * OMS_PI_OVER_TWO_F32) < 0.01f);
+    TEST_EQUALS(result.state_flag, 0xFF);
+}
+
+static void test_mob_state_quantization_valid() {
+    MobStateQuantization quant;
+    mob_state_quantization_init(&quant, 0.0f, 256.0f, 18, 7, 10, 8);
+    TEST_TRUE(mob_state_quantization_is_valid(&quant));
+    TEST_TRUE(mob_state_quantization_is_valid(&_mob_state_test_quant));
+
+    // Would be undefined shifts
+    quant.position_delta_bits = 0;
+    TEST_FALSE(mob_state_quantization_is_valid(&quant));
+
+    quant.position_delta_bits = 7;
+    quant.position_bits = 32;
+    TEST_FALSE(mob_state_quantization_is_valid(&quant));
+}
+
+static void test_mob_state_varbits() {
+    const uint32 values[] = {0, 1, 2, 3, 255, 256, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF};
+
+    byte buf[128];
+    BitWriter writer;
+    bits_writer_init(&writer, buf, sizeof(buf));
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(values); ++i) {
+        mob_state_write_varbits(&writer, values[i]);
+    }
+
+    // 6 bits length + the significant bits
+    TEST_EQUALS(bits_write_flush(&writer), (9 * 6 + 0 + 1 + 2 + 2 + 8 + 9 + 31 + 32 + 32 + 7) / 8);
+
+    BitReader reader;
+    bits_reader_init(&reader, buf, sizeof(buf));
+
+    bool is_valid = true;
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(values); ++i) {
+        is_valid &= mob_state_read_varbits(&reader) == values[i];
+    }
+
+    TEST_TRUE(is_valid);
+}
+
+static void test_mob_state_delta_roundtrip() {
+    MobStatePacketSnapshotUnpacked states[MOB_STATE_TEST_COUNT];
+    MobStateQuantized quantized[MOB_STATE_TEST_COUNT];
+    mob_state_test_states(states, MOB_STATE_TEST_COUNT);
+
+    // The states are compared with memcmp -> padding must be 0
+    memset(quantized, 0, sizeof(quantized));
+
+    MobStateHistory server;
+    MobStateHistory client;
+    mob_state_history_alloc(&server, MOB_STATE_TEST_COUNT);
+    mob_state_history_alloc(&client, MOB_STATE_TEST_COUNT);
+
+    byte packet[8192];
+    const int32 raw_size = MOB_STATE_TEST_COUNT * (int32) sizeof(MobStatePacketSnapshotUnpacked);
+
+    // Full snapshot, the client didn't ack anything yet
+    for (int32 i = 0; i < MOB_STATE_TEST_COUNT; ++i) {
+        mob_state_quantize(&states[i], &quantized[i], &_mob_state_test_quant);
+    }
+
+    TEST_EQUALS(mob_state_history_baseline(&server), NULL);
+    int32 full_size = mob_state_encode(quantized, MOB_STATE_TEST_COUNT, NULL, 1, &_mob_state_test_quant, packet, sizeof(packet));
+    mob_state_history_store(&server, 1, quantized, MOB_STATE_TEST_COUNT);
+    TEST_TRUE(full_size > 0 && full_size < raw_size / 2);
+
+    uint16 sequence;
+    uint16 baseline_sequence;
+    bool has_baseline;
+    mob_state_decode_header(packet, full_size, &sequence, &has_baseline, &baseline_sequence);
+    TEST_EQUALS(sequence, 1);
+    TEST_FALSE(has_baseline);
+
+    MobStateSnapshotRecord* record = mob_state_history_push(&client, sequence);
+    TEST_EQUALS(mob_state_decode(packet, full_size, NULL, &_mob_state_test_quant, record, client.capacity), MOB_STATE_TEST_COUNT);
+    TEST_EQUALS(memcmp(record->states, quantized, sizeof(quantized)), 0);
+
+    // Client acks -> next snapshot is a delta, only a few mobs move
+    mob_state_history_ack(&server, 1);
+    mob_state_history_ack(&server, 0); // older ack is ignored
+    TEST_EQUALS(server.acked_sequence, 1);
+
+    for (int32 i = 0; i < MOB_STATE_TEST_COUNT; i += 10) {
+        states[i].x += 0.01f;
+        states[i].yaw += 0.1f;
+    }
+    states[5].state_flag = 2;
+    states[7].chunk += 1;
+    states[9].z = 0.0f;
+
+    for (int32 i = 0; i < MOB_STATE_TEST_COUNT; ++i) {
+        mob_state_quantize(&states[i], &quantized[i], &_mob_state_test_quant);
+    }
+
+    // Remove the mob at index 3 from the snapshot
+    MobStateQuantized current[MOB_STATE_TEST_COUNT];
+    memcpy(current, quantized, 3 * sizeof(MobStateQuantized));
+    memcpy(current + 3, quantized + 4, (MOB_STATE_TEST_COUNT - 4) * sizeof(MobStateQuantized));
+    const int32 current_count = MOB_STATE_TEST_COUNT - 1;
+
+    const MobStateSnapshotRecord* baseline = mob_state_history_baseline(&server);
+    TEST_TRUE(baseline != NULL);
+
+    int32 delta_size = mob_state_encode(current, current_count, baseline, 2, &_mob_state_test_quant, packet, sizeof(packet));
+    mob_state_history_store(&server, 2, current, current_count);
+
+    // Unchanged mobs cost ~2 bits
+    TEST_TRUE(delta_size > 0 && delta_size * 10 < full_size);
+    TEST_TRUE(delta_size * 10 < raw_size);
+
+    mob_state_decode_header(packet, delta_size, &sequence, &has_baseline, &baseline_sequence);
+    TEST_TRUE(has_baseline);
+    TEST_EQUALS(baseline_sequence, 1);
+
+    record = mob_state_history_push(&client, sequence);
+    TEST_EQUALS(
+        mob_state_decode(
+            packet, delta_size,
+            mob_state_history_get(&client, baseline_sequence),
+            &_mob_state_test_quant, record, client.capacity
+        ),
+        current_count
+    );
+    TEST_EQUALS(memcmp(record->states, current, current_count * sizeof(MobStateQuantized)), 0);
+
+    // Decoding with the wrong baseline fails
+    TEST_EQUALS(mob_state_decode(packet, delta_size, NULL, &_mob_state_test_quant, record, client.capacity), -1);
+
+    // Too small output buffer
+    TEST_EQUALS(mob_state_encode(current, current_count, NULL, 3, &_mob_state_test_quant, packet, 64), -1);
+
+    mob_state_history_free(&server);
+    mob_state_history_free(&client);
+}
+
+static void test_mob_state_history_overwrite() {
+    MobStateHistory server;
+    mob_state_history_alloc(&server, 4);
+
+    MobStateQuantized state = {};
+    mob_state_history_store(&server, 5, &state, 1);
+    mob_state_history_ack(&server, 5);
+    TEST_TRUE(mob_state_history_baseline(&server) != NULL);
+
+    // The acked snapshot gets overwritten -> full snapshot required
+    mob_state_history_store(&server, 5 + MOB_STATE_HISTORY, &state, 1);
+    TEST_EQUALS(mob_state_history_baseline(&server), NULL);
+
+    mob_state_history_free(&server);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main MobStatePacketTest
+#endif
+
+int main() {
+    TEST_INIT(50);
+
+    TEST_RUN(test_mob_state_quantize);
+    TEST_RUN(test_mob_state_quantization_valid);
+    TEST_RUN(test_mob_state_varbits);
+    TEST_RUN(test_mob_state_delta_roundtrip);
+    TEST_RUN(test_mob_state_history_overwrite);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
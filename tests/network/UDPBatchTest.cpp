@@ -0,0 +1,209 @@
+#include "../TestFramework.h"
+#include "../../network/Server.h"
+#include "../../network/UDPBatch.h"
+
+static void udp_batch_test_sockets(SocketConnection* server, SocketConnection* client, sockaddr_in6* server_addr) {
+    memset(server, 0, sizeof(SocketConnection));
+    memset(client, 0, sizeof(SocketConnection));
+
+    // Port 0 = let the os choose a free port
+    TEST_EQUALS(socket_server_udp_create(server), 0);
+    TEST_EQUALS(socket_server_udp_create(client), 0);
+
+    socklen_t addr_length = sizeof(sockaddr_in6);
+    getsockname(server->sd, (sockaddr *) server_addr, &addr_length);
+    server_addr->sin6_addr = in6addr_loopback;
+}
+
+static void test_udp_batch_loopback() {
+    SocketConnection server;
+    SocketConnection client;
+    sockaddr_in6 server_addr;
+    udp_batch_test_sockets(&server, &client, &server_addr);
+
+    UDPBatch tx;
+    UDPBatch rx;
+    udp_batch_alloc(&tx, 32, 4, 1200);
+    udp_batch_alloc(&rx, 32, 4, 1200);
+
+    for (int32 i = 0; i < 100; ++i) {
+        byte* packet = udp_batch_send_get(&tx, &server_addr);
+        *((int32 *) packet) = i;
+        udp_batch_send_commit(&tx, sizeof(int32) + i);
+    }
+
+    TEST_EQUALS(tx.length, 100);
+    TEST_EQUALS(udp_batch_send_flush(&client, &tx), 100);
+    TEST_EQUALS(tx.length, 0);
+
+    int32 received = 0;
+    const byte* first_packet = NULL;
+    for (int32 tries = 0; received < 100 && tries < 1000; ++tries) {
+        const int32 count = udp_batch_receive(&server, &rx);
+        TEST_TRUE(count >= 0 && count <= 32);
+
+        for (int32 i = 0; i < count; ++i) {
+            TEST_EQUALS(*((int32 *) udp_batch_packet(&rx, i)), received);
+            TEST_EQUALS(udp_batch_packet_length(&rx, i), (int32) sizeof(int32) + received);
+            TEST_EQUALS(udp_batch_packet_addr(&rx, i)->sin6_family, AF_INET6);
+
+            if (received == 0) {
+                first_packet = udp_batch_packet(&rx, i);
+            }
+
+            ++received;
+        }
+    }
+
+    TEST_EQUALS(received, 100);
+
+    // The ring has 4 batches -> the first batch is still valid after the next batch was received
+    TEST_EQUALS(*((int32 *) first_packet), 0);
+
+    udp_batch_free(&tx);
+    udp_batch_free(&rx);
+    close(server.sd);
+    close(client.sd);
+}
+
+static void test_udp_batch_gso() {
+    SocketConnection server;
+    SocketConnection client;
+    sockaddr_in6 server_addr;
+    udp_batch_test_sockets(&server, &client, &server_addr);
+
+    if (!socket_udp_gso_supported(&client)) {
+        close(server.sd);
+        close(client.sd);
+
+        return;
+    }
+
+    UDPBatch tx;
+    UDPBatch rx;
+    udp_batch_alloc(&tx, 32, 1, 1200, UDP_BATCH_FLAG_GSO);
+    udp_batch_alloc(&rx, 32, 2, 1200);
+
+    // 10 full segments and one shorter segment -> merged into a single message
+    for (int32 i = 0; i < 11; ++i) {
+        byte* packet = udp_batch_send_get(&tx, &server_addr);
+        memset(packet, i, 100);
+        udp_batch_send_commit(&tx, i < 10 ? 100 : 50);
+    }
+
+    TEST_EQUALS(udp_batch_send_flush(&client, &tx), 11);
+
+    // The receiver doesn't use GRO -> the kernel splits the message again
+    int32 received = 0;
+    for (int32 tries = 0; received < 11 && tries < 1000; ++tries) {
+        const int32 count = udp_batch_receive(&server, &rx);
+        for (int32 i = 0; i < count; ++i) {
+            TEST_EQUALS(udp_batch_packet_length(&rx, i), received < 10 ? 100 : 50);
+            TEST_EQUALS(udp_batch_packet(&rx, i)[0], received);
+            ++received;
+        }
+    }
+
+    TEST_EQUALS(received, 11);
+
+    udp_batch_free(&tx);
+    udp_batch_free(&rx);
+    close(server.sd);
+    close(client.sd);
+}
+
+#if PERFORMANCE_TEST
+#define UDP_BATCH_BENCH_PACKETS 64
+#define UDP_BATCH_BENCH_ROUNDS 64
+
+static SocketConnection _udp_bench_server;
+static SocketConnection _udp_bench_client;
+static sockaddr_in6 _udp_bench_addr;
+static UDPBatch _udp_bench_tx;
+static UDPBatch _udp_bench_rx;
+
+static void _udp_batched(MAYBE_UNUSED volatile void* val) {
+    int32 total = 0;
+    for (int32 round = 0; round < UDP_BATCH_BENCH_ROUNDS; ++round) {
+        for (int32 i = 0; i < UDP_BATCH_BENCH_PACKETS; ++i) {
+            byte* packet = udp_batch_send_get(&_udp_bench_tx, &_udp_bench_addr);
+            *((int32 *) packet) = i;
+            udp_batch_send_commit(&_udp_bench_tx, 64);
+        }
+        udp_batch_send_flush(&_udp_bench_client, &_udp_bench_tx);
+
+        int32 received = 0;
+        int32 count;
+        while (received < UDP_BATCH_BENCH_PACKETS
+            && (count = udp_batch_receive(&_udp_bench_server, &_udp_bench_rx)) > 0
+        ) {
+            received += count;
+        }
+
+        total += received;
+    }
+
+    *((volatile int32 *) val) = total;
+}
+
+static void _udp_single(MAYBE_UNUSED volatile void* val) {
+    byte packet[1200];
+    int32 total = 0;
+    for (int32 round = 0; round < UDP_BATCH_BENCH_ROUNDS; ++round) {
+        for (int32 i = 0; i < UDP_BATCH_BENCH_PACKETS; ++i) {
+            *((int32 *) packet) = i;
+            sendto(_udp_bench_client.sd, packet, 64, 0, (sockaddr *) &_udp_bench_addr, sizeof(_udp_bench_addr));
+        }
+
+        for (int32 i = 0; i < UDP_BATCH_BENCH_PACKETS; ++i) {
+            if (recv(_udp_bench_server.sd, packet, sizeof(packet), MSG_DONTWAIT) <= 0) {
+                break;
+            }
+
+            ++total;
+        }
+    }
+
+    *((volatile int32 *) val) = total;
+}
+
+static void test_udp_batch_performance() {
+    udp_batch_test_sockets(&_udp_bench_server, &_udp_bench_client, &_udp_bench_addr);
+    udp_batch_alloc(&_udp_bench_tx, UDP_BATCH_BENCH_PACKETS, 1, 1200);
+    udp_batch_alloc(&_udp_bench_rx, UDP_BATCH_BENCH_PACKETS, 4, 1200);
+
+    // Packets per second on a single core (send + receive of every packet)
+    volatile int32 packets = 0;
+    const f64 seconds = test_measure_func_time_ns(_udp_batched, &packets, 1) / 1000000000.0;
+    printf("UDPBatch loopback: %.0f packets/s/core\n", packets / seconds);
+
+    COMPARE_FUNCTION_TEST_TIME(_udp_batched, _udp_single, 0.0);
+
+    udp_batch_free(&_udp_bench_tx);
+    udp_batch_free(&_udp_bench_rx);
+    close(_udp_bench_server.sd);
+    close(_udp_bench_client.sd);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main UDPBatchTest
+#endif
+
+int main() {
+    TEST_INIT(250);
+
+    TEST_RUN(test_udp_batch_loopback);
+    TEST_RUN(test_udp_batch_gso);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_udp_batch_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
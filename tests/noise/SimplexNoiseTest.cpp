@@ -0,0 +1,138 @@
+#include "../TestFramework.h"
+#include "../../noise/SimplexNoise.h"
+
+#define SIMPLEX_NOISE_TEST_WIDTH 37
+#define SIMPLEX_NOISE_TEST_HEIGHT 11
+#define SIMPLEX_NOISE_TEST_DEPTH 5
+
+static double simplex_noise_test_2d(f32* out, const NoiseFractal* fractal) {
+    const f32 x = -3.7f;
+    const f32 y = 12.1f;
+    const f32 step = 0.173f;
+
+    simplex_noise_2d_grid(out, SIMPLEX_NOISE_TEST_WIDTH, SIMPLEX_NOISE_TEST_HEIGHT, x, y, step, fractal);
+
+    double max_diff = 0.0;
+    for (int32 row = 0; row < SIMPLEX_NOISE_TEST_HEIGHT; ++row) {
+        for (int32 col = 0; col < SIMPLEX_NOISE_TEST_WIDTH; ++col) {
+            // Same position calculation as the grid fill
+            const f32 px = x + ((f32) col) * step;
+            const f32 py = y + (f32) row * step;
+
+            const double expected = fractal
+                ? fractal_noise_2d(simplex_noise_2d, px, py, fractal)
+                : simplex_noise_2d(px, py);
+
+            max_diff = oms_max(max_diff, fabs(expected - out[row * SIMPLEX_NOISE_TEST_WIDTH + col]));
+        }
+    }
+
+    return max_diff;
+}
+
+static void test_simplex_noise_2d_grid() {
+    f32 out[SIMPLEX_NOISE_TEST_WIDTH * SIMPLEX_NOISE_TEST_HEIGHT + 1];
+    out[SIMPLEX_NOISE_TEST_WIDTH * SIMPLEX_NOISE_TEST_HEIGHT] = 123.0f;
+
+    TEST_TRUE(simplex_noise_test_2d(out, NULL) < 0.002);
+
+    // The remainder of the last row must not write outside of the output
+    TEST_EQUALS(out[SIMPLEX_NOISE_TEST_WIDTH * SIMPLEX_NOISE_TEST_HEIGHT], 123.0f);
+
+    const NoiseFractal fractal = {5, 0.5f, 2.0f, 0.5f};
+    TEST_TRUE(simplex_noise_test_2d(out, &fractal) < 0.002);
+
+    bool is_in_range = true;
+    for (int32 i = 0; i < SIMPLEX_NOISE_TEST_WIDTH * SIMPLEX_NOISE_TEST_HEIGHT; ++i) {
+        is_in_range &= out[i] >= -1.0f && out[i] <= 1.0f;
+    }
+
+    TEST_TRUE(is_in_range);
+}
+
+static void test_simplex_noise_3d_grid() {
+    f32 out[SIMPLEX_NOISE_TEST_WIDTH * SIMPLEX_NOISE_TEST_HEIGHT * SIMPLEX_NOISE_TEST_DEPTH];
+
+    const f32 x = 5.3f;
+    const f32 y = -2.9f;
+    const f32 z = 0.45f;
+    const f32 step = 0.211f;
+    const NoiseFractal fractal = {3, 1.0f, 2.0f, 0.5f};
+
+    simplex_noise_3d_grid(
+        out, SIMPLEX_NOISE_TEST_WIDTH, SIMPLEX_NOISE_TEST_HEIGHT, SIMPLEX_NOISE_TEST_DEPTH,
+        x, y, z, step, &fractal
+    );
+
+    double max_diff = 0.0;
+    for (int32 layer = 0; layer < SIMPLEX_NOISE_TEST_DEPTH; ++layer) {
+        for (int32 row = 0; row < SIMPLEX_NOISE_TEST_HEIGHT; ++row) {
+            for (int32 col = 0; col < SIMPLEX_NOISE_TEST_WIDTH; ++col) {
+                const f32 px = x + ((f32) col) * step;
+                const f32 py = y + (f32) row * step;
+                const f32 pz = z + (f32) layer * step;
+
+                const double expected = fractal_noise_3d(simplex_noise_3d, px, py, pz, &fractal);
+                const f32 actual = out[(layer * SIMPLEX_NOISE_TEST_HEIGHT + row) * SIMPLEX_NOISE_TEST_WIDTH + col];
+
+                max_diff = oms_max(max_diff, fabs(expected - actual));
+            }
+        }
+    }
+
+    TEST_TRUE(max_diff < 0.002);
+}
+
+#if PERFORMANCE_TEST
+#define SIMPLEX_NOISE_BENCH_SIZE 128
+
+static f32 _simplex_noise_bench_out[SIMPLEX_NOISE_BENCH_SIZE * SIMPLEX_NOISE_BENCH_SIZE];
+static const NoiseFractal _simplex_noise_bench_fractal = {4, 0.05f, 2.0f, 0.5f};
+
+static void _simplex_noise_grid(MAYBE_UNUSED volatile void* val) {
+    simplex_noise_2d_grid(
+        _simplex_noise_bench_out, SIMPLEX_NOISE_BENCH_SIZE, SIMPLEX_NOISE_BENCH_SIZE,
+        0.0f, 0.0f, 1.0f, &_simplex_noise_bench_fractal
+    );
+
+    *((volatile f32 *) val) = _simplex_noise_bench_out[SIMPLEX_NOISE_BENCH_SIZE * SIMPLEX_NOISE_BENCH_SIZE - 1];
+}
+
+static void _simplex_noise_scalar(MAYBE_UNUSED volatile void* val) {
+    for (int32 y = 0; y < SIMPLEX_NOISE_BENCH_SIZE; ++y) {
+        for (int32 x = 0; x < SIMPLEX_NOISE_BENCH_SIZE; ++x) {
+            _simplex_noise_bench_out[y * SIMPLEX_NOISE_BENCH_SIZE + x] = (f32) fractal_noise_2d(
+                simplex_noise_2d, x, y, &_simplex_noise_bench_fractal
+            );
+        }
+    }
+
+    *((volatile f32 *) val) = _simplex_noise_bench_out[SIMPLEX_NOISE_BENCH_SIZE * SIMPLEX_NOISE_BENCH_SIZE - 1];
+}
+
+static void test_simplex_noise_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_simplex_noise_grid, _simplex_noise_scalar, 50.0);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main SimplexNoiseTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_simplex_noise_2d_grid);
+    TEST_RUN(test_simplex_noise_3d_grid);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_simplex_noise_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
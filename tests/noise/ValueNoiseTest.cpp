@@ -0,0 +1,78 @@
+#include "../TestFramework.h"
+#include "../../noise/ValueNoise.h"
+
+#define VALUE_NOISE_TEST_ROWS 7
+#define VALUE_NOISE_TEST_COLS 13
+
+static void test_value_noise_2d_wrap() {
+    f32 grid[VALUE_NOISE_TEST_ROWS * VALUE_NOISE_TEST_COLS];
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(grid); ++i) {
+        grid[i] = (f32) i;
+    }
+
+    // Integer positions return the grid value
+    TEST_EQUALS(value_noise_2d(grid, 3.0f, 2.0f, VALUE_NOISE_TEST_ROWS, VALUE_NOISE_TEST_COLS), grid[2 * VALUE_NOISE_TEST_COLS + 3]);
+
+    // The grid repeats in both directions
+    TEST_EQUALS(
+        value_noise_2d(grid, 3.25f - VALUE_NOISE_TEST_COLS, 2.5f + VALUE_NOISE_TEST_ROWS, VALUE_NOISE_TEST_ROWS, VALUE_NOISE_TEST_COLS),
+        value_noise_2d(grid, 3.25f, 2.5f, VALUE_NOISE_TEST_ROWS, VALUE_NOISE_TEST_COLS)
+    );
+}
+
+static void test_value_noise_2d_grid() {
+    f32 grid[VALUE_NOISE_TEST_ROWS * VALUE_NOISE_TEST_COLS];
+    srand(42);
+    initialize_value_noise_3d(grid, VALUE_NOISE_TEST_ROWS, VALUE_NOISE_TEST_COLS, 1);
+
+    const int32 width = 29;
+    const int32 height = 9;
+    const f32 x = -6.3f;
+    const f32 y = 1.7f;
+    const f32 step = 0.37f;
+    const NoiseFractal fractal = {3, 1.0f, 2.0f, 0.5f};
+
+    f32 out[29 * 9];
+    value_noise_2d_grid(out, width, height, grid, VALUE_NOISE_TEST_ROWS, VALUE_NOISE_TEST_COLS, x, y, step, &fractal);
+
+    f32 amplitude_start = noise_fractal_amplitude(&fractal);
+
+    f32 max_diff = 0.0f;
+    for (int32 row = 0; row < height; ++row) {
+        for (int32 col = 0; col < width; ++col) {
+            const f32 px = x + ((f32) col) * step;
+            const f32 py = y + (f32) row * step;
+
+            f32 expected = 0.0f;
+            f32 frequency = fractal.frequency;
+            f32 amplitude = amplitude_start;
+            for (int32 octave = 0; octave < fractal.octaves; ++octave) {
+                expected += amplitude * value_noise_2d(grid, px * frequency, py * frequency, VALUE_NOISE_TEST_ROWS, VALUE_NOISE_TEST_COLS);
+                frequency *= fractal.lacunarity;
+                amplitude *= fractal.gain;
+            }
+
+            max_diff = oms_max(max_diff, fabsf(expected - out[row * width + col]));
+        }
+    }
+
+    TEST_TRUE(max_diff < 0.0001f);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main ValueNoiseTest
+#endif
+
+int main() {
+    TEST_INIT(10);
+
+    TEST_RUN(test_value_noise_2d_wrap);
+    TEST_RUN(test_value_noise_2d_grid);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
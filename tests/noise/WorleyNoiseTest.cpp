@@ -0,0 +1,183 @@
+#include "../TestFramework.h"
+#include "../../noise/WorleyNoise.h"
+
+#define WORLEY_NOISE_TEST_WIDTH 37
+#define WORLEY_NOISE_TEST_HEIGHT 11
+#define WORLEY_NOISE_TEST_DEPTH 5
+
+static void test_worley_noise_2d() {
+    // Brute force over a larger neighborhood, F1 must be exact
+    f32 max_diff = 0.0f;
+    for (int32 s = 0; s < 200; ++s) {
+        const f32 x = -7.3f + (f32) s * 0.137f;
+        const f32 y = 3.6f + (f32) s * 0.291f;
+        const int32 cell_x = (int32) floorf(x);
+        const int32 cell_y = (int32) floorf(y);
+
+        f32 f1 = INFINITY;
+        for (int32 j = -3; j <= 3; ++j) {
+            for (int32 i = -3; i <= 3; ++i) {
+                const v2_f32 p = worley_noise_point_2d(cell_x + i, cell_y + j, 17);
+                const f32 d = distance_squared_2d(x, y, (f32) (cell_x + i) + p.x, (f32) (cell_y + j) + p.y);
+                f1 = d < f1 ? d : f1;
+            }
+        }
+
+        const WorleyNoiseDistance dist = worley_noise_2d(x, y, 17);
+        max_diff = oms_max(max_diff, fabsf(dist.f1 - sqrtf(f1)));
+        TEST_TRUE(dist.f1 <= dist.f2);
+    }
+
+    TEST_TRUE(max_diff < 0.0001f);
+
+    // Different seeds result in different points
+    TEST_TRUE(worley_noise_2d(0.5f, 0.5f, 18).f1 != worley_noise_2d(0.5f, 0.5f, 17).f1);
+}
+
+static void test_worley_noise_3d() {
+    f32 max_diff = 0.0f;
+    for (int32 s = 0; s < 100; ++s) {
+        const f32 x = -2.3f + (f32) s * 0.137f;
+        const f32 y = 1.6f - (f32) s * 0.291f;
+        const f32 z = 0.1f + (f32) s * 0.077f;
+        const int32 cell_x = (int32) floorf(x);
+        const int32 cell_y = (int32) floorf(y);
+        const int32 cell_z = (int32) floorf(z);
+
+        f32 f1 = INFINITY;
+        for (int32 k = -2; k <= 2; ++k) {
+            for (int32 j = -2; j <= 2; ++j) {
+                for (int32 i = -2; i <= 2; ++i) {
+                    const v3_f32 p = worley_noise_point_3d(cell_x + i, cell_y + j, cell_z + k, 3);
+                    const f32 d = distance_squared_3d(
+                        x, y, z,
+                        (f32) (cell_x + i) + p.x, (f32) (cell_y + j) + p.y, (f32) (cell_z + k) + p.z
+                    );
+                    f1 = d < f1 ? d : f1;
+                }
+            }
+        }
+
+        max_diff = oms_max(max_diff, fabsf(worley_noise_3d(x, y, z, 3).f1 - sqrtf(f1)));
+    }
+
+    TEST_TRUE(max_diff < 0.0001f);
+}
+
+static void test_worley_noise_2d_grid() {
+    f32 out[WORLEY_NOISE_TEST_WIDTH * WORLEY_NOISE_TEST_HEIGHT + 1];
+    out[WORLEY_NOISE_TEST_WIDTH * WORLEY_NOISE_TEST_HEIGHT] = 123.0f;
+
+    const f32 x = -3.7f;
+    const f32 y = 12.1f;
+    const f32 step = 0.173f;
+
+    const WorleyNoiseOutput outputs[] = {WORLEY_NOISE_F1, WORLEY_NOISE_F2, WORLEY_NOISE_F2_F1};
+    for (int32 o = 0; o < (int32) ARRAY_COUNT(outputs); ++o) {
+        worley_noise_2d_grid(out, WORLEY_NOISE_TEST_WIDTH, WORLEY_NOISE_TEST_HEIGHT, x, y, step, 42, outputs[o]);
+
+        f32 max_diff = 0.0f;
+        for (int32 row = 0; row < WORLEY_NOISE_TEST_HEIGHT; ++row) {
+            for (int32 col = 0; col < WORLEY_NOISE_TEST_WIDTH; ++col) {
+                // Same position calculation as the grid fill
+                const f32 px = x + ((f32) col) * step;
+                const f32 py = y + (f32) row * step;
+
+                const WorleyNoiseDistance dist = worley_noise_2d(px, py, 42);
+                const f32 expected = worley_noise_output(&dist, outputs[o]);
+
+                max_diff = oms_max(max_diff, fabsf(expected - out[row * WORLEY_NOISE_TEST_WIDTH + col]));
+            }
+        }
+
+        TEST_TRUE(max_diff < 0.0001f);
+    }
+
+    // The remainder of the last row must not write outside of the output
+    TEST_EQUALS(out[WORLEY_NOISE_TEST_WIDTH * WORLEY_NOISE_TEST_HEIGHT], 123.0f);
+}
+
+static void test_worley_noise_3d_grid() {
+    f32 out[WORLEY_NOISE_TEST_WIDTH * WORLEY_NOISE_TEST_HEIGHT * WORLEY_NOISE_TEST_DEPTH];
+
+    const f32 x = 5.3f;
+    const f32 y = -2.9f;
+    const f32 z = -0.45f;
+    const f32 step = 0.211f;
+
+    worley_noise_3d_grid(
+        out, WORLEY_NOISE_TEST_WIDTH, WORLEY_NOISE_TEST_HEIGHT, WORLEY_NOISE_TEST_DEPTH,
+        x, y, z, step, 7, WORLEY_NOISE_F2_F1
+    );
+
+    f32 max_diff = 0.0f;
+    for (int32 layer = 0; layer < WORLEY_NOISE_TEST_DEPTH; ++layer) {
+        for (int32 row = 0; row < WORLEY_NOISE_TEST_HEIGHT; ++row) {
+            for (int32 col = 0; col < WORLEY_NOISE_TEST_WIDTH; ++col) {
+                const f32 px = x + ((f32) col) * step;
+                const f32 py = y + (f32) row * step;
+                const f32 pz = z + (f32) layer * step;
+
+                const WorleyNoiseDistance dist = worley_noise_3d(px, py, pz, 7);
+                const f32 actual = out[(layer * WORLEY_NOISE_TEST_HEIGHT + row) * WORLEY_NOISE_TEST_WIDTH + col];
+
+                max_diff = oms_max(max_diff, fabsf(dist.f2 - dist.f1 - actual));
+            }
+        }
+    }
+
+    TEST_TRUE(max_diff < 0.0001f);
+}
+
+#if PERFORMANCE_TEST
+#define WORLEY_NOISE_BENCH_SIZE 128
+
+static f32 _worley_noise_bench_out[WORLEY_NOISE_BENCH_SIZE * WORLEY_NOISE_BENCH_SIZE];
+
+static void _worley_noise_grid(MAYBE_UNUSED volatile void* val) {
+    worley_noise_2d_grid(
+        _worley_noise_bench_out, WORLEY_NOISE_BENCH_SIZE, WORLEY_NOISE_BENCH_SIZE,
+        0.0f, 0.0f, 0.1f, 1, WORLEY_NOISE_F1
+    );
+
+    *((volatile f32 *) val) = _worley_noise_bench_out[WORLEY_NOISE_BENCH_SIZE * WORLEY_NOISE_BENCH_SIZE - 1];
+}
+
+static void _worley_noise_scalar(MAYBE_UNUSED volatile void* val) {
+    for (int32 y = 0; y < WORLEY_NOISE_BENCH_SIZE; ++y) {
+        for (int32 x = 0; x < WORLEY_NOISE_BENCH_SIZE; ++x) {
+            _worley_noise_bench_out[y * WORLEY_NOISE_BENCH_SIZE + x] = worley_noise_2d(x * 0.1f, y * 0.1f, 1).f1;
+        }
+    }
+
+    *((volatile f32 *) val) = _worley_noise_bench_out[WORLEY_NOISE_BENCH_SIZE * WORLEY_NOISE_BENCH_SIZE - 1];
+}
+
+static void test_worley_noise_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_worley_noise_grid, _worley_noise_scalar, 50.0);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main WorleyNoiseTest
+#endif
+
+int main() {
+    TEST_INIT(250);
+
+    TEST_RUN(test_worley_noise_2d);
+    TEST_RUN(test_worley_noise_3d);
+    TEST_RUN(test_worley_noise_2d_grid);
+    TEST_RUN(test_worley_noise_3d_grid);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_worley_noise_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -0,0 +1,466 @@
+#include "../TestFramework.h"
+#include "../../object/Mesh.cpp"
+#include "../../object/MeshOptimizer.h"
+
+#define MESH_TEST_GRID 32
+#define MESH_TEST_VERTEX_SIZE 8
+
+// Flat (unindexed) grid with position, normal and texture coordinates
+static uint32 mesh_test_grid(f32* vertices, bool shuffle) {
+    int32 quads[MESH_TEST_GRID * MESH_TEST_GRID];
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(quads); ++i) {
+        quads[i] = i;
+    }
+
+    if (shuffle) {
+        uint32 seed = 1234;
+        for (int32 i = ARRAY_COUNT(quads) - 1; i > 0; --i) {
+            seed = seed * 1664525 + 1013904223;
+            const int32 j = (int32) ((seed >> 8) % (uint32) (i + 1));
+            const int32 tmp = quads[i];
+            quads[i] = quads[j];
+            quads[j] = tmp;
+        }
+    }
+
+    const int32 corners[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+
+    uint32 count = 0;
+    for (int32 q = 0; q < (int32) ARRAY_COUNT(quads); ++q) {
+        const int32 x = quads[q] % MESH_TEST_GRID;
+        const int32 z = quads[q] / MESH_TEST_GRID;
+
+        for (int32 c = 0; c < 6; ++c) {
+            f32* v = vertices + count * MESH_TEST_VERTEX_SIZE;
+            const f32 px = (f32) (x + corners[c][0]);
+            const f32 pz = (f32) (z + corners[c][1]);
+
+            v[0] = px * 0.5f - 3.0f;
+            v[1] = sinf(px * 0.3f) * cosf(pz * 0.2f);
+            v[2] = pz * 0.5f + 1.0f;
+
+            const f32 nx = -0.3f * cosf(px * 0.3f) * cosf(pz * 0.2f);
+            const f32 nz = 0.2f * sinf(px * 0.3f) * sinf(pz * 0.2f);
+            const f32 inv = 1.0f / sqrtf(nx * nx + 1.0f + nz * nz);
+            v[3] = nx * inv;
+            v[4] = inv;
+            v[5] = nz * inv;
+
+            v[6] = px / MESH_TEST_GRID;
+            v[7] = pz / MESH_TEST_GRID;
+
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+static void mesh_test_init(Mesh* mesh, byte* data, f32* source, bool shuffle) {
+    memset(mesh, 0, sizeof(*mesh));
+    mesh->data = data;
+    mesh->vertex_type = VERTEX_TYPE_POSITION | VERTEX_TYPE_NORMAL | VERTEX_TYPE_TEXTURE_COORD;
+    mesh->vertex_count = mesh_test_grid(source, shuffle);
+    memcpy(mesh->data, source, mesh->vertex_count * MESH_TEST_VERTEX_SIZE * sizeof(f32));
+    mesh->vertices = (f32 *) mesh->data;
+}
+
+static void test_mesh_half_float() {
+    const f32 values[] = {0.0f, 1.0f, -2.0f, 0.5f, 0.25f, 65504.0f, 0.0009765625f, -0.125f};
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(values); ++i) {
+        TEST_EQUALS(mesh_f16_to_f32(mesh_f32_to_f16(values[i])), values[i]);
+    }
+
+    TEST_EQUALS(mesh_f32_to_f16(1.0f), 0x3C00);
+    TEST_EQUALS(mesh_f32_to_f16(-2.0f), 0xC000);
+
+    // Subnormal
+    TEST_EQUALS(mesh_f16_to_f32(mesh_f32_to_f16(0.00001f)), mesh_f16_to_f32(0x00A8));
+    TEST_EQUALS(mesh_f16_to_f32(0x0001), 5.9604645e-8f);
+
+    // Rounding
+    TEST_EQUALS_WITH_DELTA(mesh_f16_to_f32(mesh_f32_to_f16(0.3333f)), 0.3333f, 0.0002f);
+    TEST_EQUALS_WITH_DELTA(mesh_f16_to_f32(mesh_f32_to_f16(7.77f)), 7.77f, 0.004f);
+}
+
+static void test_mesh_octahedral_normal() {
+    const f32 normals[][3] = {
+        {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f},
+        {0.57735f, 0.57735f, 0.57735f}, {-0.57735f, 0.57735f, -0.57735f}, {0.6f, -0.8f, 0.0f},
+    };
+
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(normals); ++i) {
+        int8 encoded[2];
+        f32 decoded[3];
+        mesh_normal_encode(normals[i], encoded);
+        mesh_normal_decode(encoded, decoded);
+
+        const f32 dot = decoded[0] * normals[i][0] + decoded[1] * normals[i][1] + decoded[2] * normals[i][2];
+        TEST_TRUE(dot > 0.999f);
+    }
+}
+
+static void test_mesh_optimize() {
+    static f32 source[MESH_TEST_GRID * MESH_TEST_GRID * 6 * MESH_TEST_VERTEX_SIZE];
+    static byte data[sizeof(source) + MESH_TEST_GRID * MESH_TEST_GRID * 6 * sizeof(uint32)];
+
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    Mesh mesh;
+    mesh_test_init(&mesh, data, source, true);
+
+    const uint32 flat_count = mesh.vertex_count;
+
+    // Reference: only indexed, original (shuffled) order
+    static f32 indexed_vertices[MESH_TEST_GRID * MESH_TEST_GRID * 6 * MESH_TEST_VERTEX_SIZE];
+    static uint32 indexed[MESH_TEST_GRID * MESH_TEST_GRID * 6];
+    memcpy(indexed_vertices, source, sizeof(source));
+
+    const uint32 unique = mesh_index_vertices(indexed_vertices, flat_count, MESH_TEST_VERTEX_SIZE, indexed, &ring);
+    TEST_EQUALS(unique, (MESH_TEST_GRID + 1) * (MESH_TEST_GRID + 1));
+
+    const f32 acmr_before = mesh_vertex_cache_acmr(indexed, flat_count, unique, 16, &ring);
+
+    mesh_optimize(&mesh, &ring);
+
+    TEST_EQUALS(mesh.vertex_count, unique);
+    TEST_EQUALS(mesh.index_count, flat_count);
+
+    const f32 acmr_after = mesh_vertex_cache_acmr(mesh.indices, mesh.index_count, mesh.vertex_count, 16, &ring);
+    TEST_TRUE(acmr_before > 1.5f);
+    TEST_TRUE(acmr_after < 0.9f);
+
+    // Every triangle still exists (the vertex fetch order is the order of first use)
+    uint32 max_index = 0;
+    f64 sum_flat = 0.0;
+    f64 sum_optimized = 0.0;
+
+    for (uint32 i = 0; i < flat_count; ++i) {
+        sum_flat += source[i * MESH_TEST_VERTEX_SIZE] + source[i * MESH_TEST_VERTEX_SIZE + 2] * 3.0f;
+
+        const f32* v = mesh.vertices + mesh.indices[i] * MESH_TEST_VERTEX_SIZE;
+        sum_optimized += v[0] + v[2] * 3.0f;
+
+        TEST_TRUE(mesh.indices[i] <= max_index + 1 || i == 0);
+        max_index = OMS_MAX(max_index, mesh.indices[i]);
+    }
+
+    TEST_EQUALS_WITH_DELTA(sum_optimized, sum_flat, 0.01);
+
+    ring_free(&ring);
+}
+
+static void test_mesh_quantized_data() {
+    static f32 source[MESH_TEST_GRID * MESH_TEST_GRID * 6 * MESH_TEST_VERTEX_SIZE];
+    static byte data[sizeof(source) + MESH_TEST_GRID * MESH_TEST_GRID * 6 * sizeof(uint32)];
+    static byte file[sizeof(data)];
+    static byte loaded[sizeof(data)];
+
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    Mesh mesh;
+    mesh_test_init(&mesh, data, source, false);
+    mesh_optimize(&mesh, &ring);
+
+    const int32 size = mesh_to_data(&mesh, file);
+    TEST_EQUALS(size, mesh_data_size(&mesh));
+
+    // 12 bytes per vertex + 2 bytes per index vs. 32 bytes per flat vertex (~7.7x smaller)
+    TEST_TRUE(size * 6 < (int32) (MESH_TEST_GRID * MESH_TEST_GRID * 6 * MESH_TEST_VERTEX_SIZE * sizeof(f32)));
+
+    Mesh full = {};
+    full.data = loaded;
+    const int32 memory = mesh_from_data(file, &full);
+
+    TEST_EQUALS(memory, (int32) mesh_memory_size(mesh.vertex_type, mesh.vertex_count, mesh.index_count));
+
+    // The asset archive reserves the memory based on the header
+    TEST_EQUALS((int32) mesh_data_memory_size(file), memory);
+    TEST_TRUE(memory > size);
+    TEST_EQUALS(full.vertex_type, mesh.vertex_type);
+    TEST_EQUALS(full.vertex_count, mesh.vertex_count);
+    TEST_EQUALS(full.index_count, mesh.index_count);
+    TEST_MEMORY_EQUALS(full.indices, mesh.indices, mesh.index_count * sizeof(uint32));
+
+    // Position extent is 16 x 2 x 16 -> max error = extent / 65535 / 2
+    bool is_close = true;
+    for (uint32 i = 0; i < mesh.vertex_count; ++i) {
+        const f32* a = mesh.vertices + i * MESH_TEST_VERTEX_SIZE;
+        const f32* b = full.vertices + i * MESH_TEST_VERTEX_SIZE;
+
+        is_close &= fabsf(a[0] - b[0]) < 0.0002f && fabsf(a[1] - b[1]) < 0.0002f && fabsf(a[2] - b[2]) < 0.0002f;
+        is_close &= a[3] * b[3] + a[4] * b[4] + a[5] * b[5] > 0.999f;
+        is_close &= fabsf(a[6] - b[6]) < 0.001f && fabsf(a[7] - b[7]) < 0.001f;
+    }
+
+    TEST_TRUE(is_close);
+
+    // Server side: positions only
+    Mesh positions = {};
+    positions.data = loaded;
+    const int32 position_memory = mesh_from_data(file, &positions, MESH_LOADING_RESTRICTION_POSITION | MESH_LOADING_RESTRICTION_FACES);
+
+    TEST_EQUALS(positions.vertex_type, VERTEX_TYPE_POSITION);
+    TEST_EQUALS((int32) mesh_data_memory_size(file, MESH_LOADING_RESTRICTION_POSITION | MESH_LOADING_RESTRICTION_FACES), position_memory);
+    TEST_EQUALS(position_memory, (int32) (mesh.vertex_count * 3 * sizeof(f32) + mesh.index_count * sizeof(uint32)));
+    TEST_MEMORY_EQUALS(positions.indices, mesh.indices, mesh.index_count * sizeof(uint32));
+    TEST_EQUALS_WITH_DELTA(positions.vertices[5 * 3 + 2], mesh.vertices[5 * MESH_TEST_VERTEX_SIZE + 2], 0.0002f);
+
+    ring_free(&ring);
+}
+
+static void test_mesh_legacy_data() {
+    // Version 1 = flat f32 vertices
+    byte file[3 * sizeof(int32) + 3 * 3 * sizeof(f32)];
+    byte* pos = file;
+    pos = write_le(pos, (int32) 1);
+    pos = write_le(pos, (uint32) VERTEX_TYPE_POSITION);
+    pos = write_le(pos, (uint32) 3);
+    for (int32 i = 0; i < 9; ++i) {
+        pos = write_le(pos, (f32) i);
+    }
+
+    f32 loaded[9];
+    Mesh mesh = {};
+    mesh.data = (byte *) loaded;
+
+    TEST_EQUALS(mesh_from_data(file, &mesh), (int32) (9 * sizeof(f32)));
+    TEST_EQUALS((int32) mesh_data_memory_size(file), (int32) (9 * sizeof(f32)));
+    TEST_EQUALS(mesh.vertex_count, 3);
+    TEST_EQUALS(mesh.index_count, 0);
+    TEST_EQUALS(mesh.vertices[7], 7.0f);
+}
+
+static void test_mesh_lod_generate() {
+    static f32 source[MESH_TEST_GRID * MESH_TEST_GRID * 6 * MESH_TEST_VERTEX_SIZE];
+    static byte data[sizeof(source) + MESH_TEST_GRID * MESH_TEST_GRID * 6 * sizeof(uint32)];
+    static byte file[sizeof(data)];
+    static byte loaded[sizeof(data)];
+
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    Mesh mesh;
+    mesh_test_init(&mesh, data, source, false);
+    mesh_optimize(&mesh, &ring);
+
+    TEST_EQUALS(mesh.lod_count, 1);
+    TEST_EQUALS(mesh.lods[0].index_count, mesh.index_count);
+
+    mesh_lod_generate(&mesh, 4, 0.5f, 1.0f, &ring);
+
+    TEST_EQUALS(mesh.lod_count, 4);
+    TEST_EQUALS(mesh.lods[0].error, 0.0f);
+
+    uint32 index_count = 0;
+    for (uint32 i = 1; i < mesh.lod_count; ++i) {
+        const MeshLod* lod = &mesh.lods[i];
+
+        TEST_EQUALS(lod->index_offset, mesh.lods[i - 1].index_offset + mesh.lods[i - 1].index_count);
+        TEST_TRUE(lod->index_count <= mesh.lods[i - 1].index_count / 2 + 3);
+        TEST_TRUE(lod->error >= mesh.lods[i - 1].error);
+        TEST_TRUE(lod->error <= 1.0f);
+
+        index_count = lod->index_offset + lod->index_count;
+    }
+
+    TEST_EQUALS(mesh.index_count, index_count);
+
+    // The surface is a height field, all triangles face down (-y), no triangle may flip
+    bool is_valid = true;
+    for (uint32 i = 0; i < mesh.index_count; i += 3) {
+        const uint32* tri = mesh.indices + i;
+        is_valid &= tri[0] < mesh.vertex_count && tri[1] < mesh.vertex_count && tri[2] < mesh.vertex_count;
+
+        f32 n[3];
+        mesh_triangle_normal(
+            mesh.vertices + tri[0] * MESH_TEST_VERTEX_SIZE,
+            mesh.vertices + tri[1] * MESH_TEST_VERTEX_SIZE,
+            mesh.vertices + tri[2] * MESH_TEST_VERTEX_SIZE,
+            n
+        );
+
+        is_valid &= n[1] < 0.0f;
+    }
+
+    TEST_TRUE(is_valid);
+
+    // The border is locked -> the bounds remain the same
+    const uint32* coarse = mesh.indices + mesh.lods[3].index_offset;
+    f32 min_x = 1000.0f;
+    f32 max_z = -1000.0f;
+    for (uint32 i = 0; i < mesh.lods[3].index_count; ++i) {
+        min_x = oms_min(min_x, mesh.vertices[coarse[i] * MESH_TEST_VERTEX_SIZE]);
+        max_z = oms_max(max_z, mesh.vertices[coarse[i] * MESH_TEST_VERTEX_SIZE + 2]);
+    }
+
+    TEST_EQUALS(min_x, -3.0f);
+    TEST_EQUALS(max_z, MESH_TEST_GRID * 0.5f + 1.0f);
+
+    // The LODs are part of the binary data
+    mesh_to_data(&mesh, file);
+
+    Mesh copy = {};
+    copy.data = loaded;
+    mesh_from_data(file, &copy);
+
+    TEST_EQUALS(copy.lod_count, mesh.lod_count);
+    TEST_MEMORY_EQUALS(copy.lods, mesh.lods, mesh.lod_count * sizeof(MeshLod));
+    TEST_MEMORY_EQUALS(copy.indices, mesh.indices, mesh.index_count * sizeof(uint32));
+
+    ring_free(&ring);
+}
+
+// Degenerated input triangles must not shift the compaction beyond the input indices
+static void test_mesh_simplify_degenerate() {
+    static f32 source[MESH_TEST_GRID * MESH_TEST_GRID * 6 * MESH_TEST_VERTEX_SIZE];
+    static byte data[sizeof(source) + MESH_TEST_GRID * MESH_TEST_GRID * 6 * sizeof(uint32)];
+    static uint32 indices[MESH_TEST_GRID * MESH_TEST_GRID * 6 + 9];
+    static uint32 destination[MESH_TEST_GRID * MESH_TEST_GRID * 6 + 9 + 30];
+
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    Mesh mesh;
+    mesh_test_init(&mesh, data, source, false);
+    mesh_optimize(&mesh, &ring);
+
+    memcpy(indices, mesh.indices, mesh.index_count * sizeof(uint32));
+    const uint32 index_count = mesh.index_count + 9;
+    for (uint32 i = mesh.index_count; i < index_count; ++i) {
+        indices[i] = 0;
+    }
+
+    // Guard behind the input, invalid but not degenerated triangles
+    for (uint32 i = index_count; i < (uint32) ARRAY_COUNT(destination); ++i) {
+        destination[i] = mesh.vertex_count + i % 3;
+    }
+
+    f32 error;
+    const uint32 count = mesh_simplify(
+        destination, indices, index_count,
+        mesh.vertices, mesh.vertex_count, MESH_TEST_VERTEX_SIZE,
+        mesh.index_count / 2, 1.0f, &error, &ring
+    );
+
+    TEST_TRUE(count < mesh.index_count);
+    TEST_EQUALS(count % 3, 0);
+
+    bool is_valid = true;
+    for (uint32 i = 0; i < count; i += 3) {
+        const uint32* tri = destination + i;
+        is_valid &= tri[0] < mesh.vertex_count && tri[1] < mesh.vertex_count && tri[2] < mesh.vertex_count;
+        is_valid &= tri[0] != tri[1] && tri[1] != tri[2] && tri[0] != tri[2];
+    }
+
+    TEST_TRUE(is_valid);
+
+    ring_free(&ring);
+}
+
+static void test_mesh_lod_select() {
+    Mesh mesh = {};
+    mesh.lod_count = 4;
+    mesh.lods[0].error = 0.0f;
+    mesh.lods[1].error = 0.01f;
+    mesh.lods[2].error = 0.04f;
+    mesh.lods[3].error = 0.16f;
+
+    const f32 scale = 1000.0f;
+
+    // Projected errors: 2px, 8px, 32px
+    TEST_EQUALS(mesh_lod_select(&mesh, 5.0f, scale, 1.0f, 0), 0);
+    TEST_EQUALS(mesh_lod_select(&mesh, 5.0f, scale, 1.0f, 3), 0);
+
+    // Projected errors: 0.5px, 2px, 8px
+    TEST_EQUALS(mesh_lod_select(&mesh, 20.0f, scale, 1.0f, 0), 1);
+    TEST_EQUALS(mesh_lod_select(&mesh, 20.0f, scale, 1.0f, 3), 1);
+
+    // Far away
+    TEST_EQUALS(mesh_lod_select(&mesh, 1000.0f, scale, 1.0f, 0), 3);
+
+    // Hysteresis: LOD 1 has 0.83px, this is below the threshold but not clearly below it
+    TEST_EQUALS(mesh_lod_select(&mesh, 12.0f, scale, 1.0f, 0), 0);
+    TEST_EQUALS(mesh_lod_select(&mesh, 12.0f, scale, 1.0f, 1), 1);
+
+    // Not simplified
+    mesh.lod_count = 1;
+    TEST_EQUALS(mesh_lod_select(&mesh, 1000.0f, scale, 1.0f, 0), 0);
+
+    TEST_EQUALS_WITH_DELTA(mesh_lod_projection_scale(OMS_PI_OVER_TWO_F32, 1080.0f), 540.0f, 0.01f);
+}
+
+#if PERFORMANCE_TEST
+static byte _mesh_perf_flat[3 * sizeof(int32) + sizeof(f32) * MESH_TEST_GRID * MESH_TEST_GRID * 6 * MESH_TEST_VERTEX_SIZE];
+static byte _mesh_perf_quantized[sizeof(_mesh_perf_flat)];
+static byte _mesh_perf_memory[sizeof(_mesh_perf_flat) * 2];
+
+static void _mesh_load_flat(MAYBE_UNUSED volatile void* val) {
+    Mesh mesh = {};
+    mesh.data = _mesh_perf_memory;
+    *((volatile int32 *) val) = mesh_from_data(_mesh_perf_flat, &mesh);
+}
+
+static void _mesh_load_positions(MAYBE_UNUSED volatile void* val) {
+    Mesh mesh = {};
+    mesh.data = _mesh_perf_memory;
+    *((volatile int32 *) val) = mesh_from_data(
+        _mesh_perf_quantized, &mesh,
+        MESH_LOADING_RESTRICTION_POSITION | MESH_LOADING_RESTRICTION_FACES
+    );
+}
+
+static void test_mesh_load_performance() {
+    static f32 source[MESH_TEST_GRID * MESH_TEST_GRID * 6 * MESH_TEST_VERTEX_SIZE];
+    static byte data[sizeof(source) + MESH_TEST_GRID * MESH_TEST_GRID * 6 * sizeof(uint32)];
+
+    RingMemory ring;
+    ring_alloc(&ring, 16 * MEGABYTE, 16 * MEGABYTE, 64);
+
+    Mesh mesh;
+    mesh_test_init(&mesh, data, source, false);
+
+    byte* pos = _mesh_perf_flat;
+    pos = write_le(pos, (int32) 1);
+    pos = write_le(pos, mesh.vertex_type);
+    pos = write_le(pos, mesh.vertex_count);
+    memcpy(pos, source, mesh.vertex_count * MESH_TEST_VERTEX_SIZE * sizeof(f32));
+
+    mesh_optimize(&mesh, &ring);
+    mesh_to_data(&mesh, _mesh_perf_quantized);
+
+    COMPARE_FUNCTION_TEST_TIME(_mesh_load_positions, _mesh_load_flat, 0.0);
+
+    ring_free(&ring);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main MeshTest
+#endif
+
+int main() {
+    TEST_INIT(100);
+
+    TEST_RUN(test_mesh_half_float);
+    TEST_RUN(test_mesh_octahedral_normal);
+    TEST_RUN(test_mesh_optimize);
+    TEST_RUN(test_mesh_quantized_data);
+    TEST_RUN(test_mesh_legacy_data);
+    TEST_RUN(test_mesh_lod_generate);
+    TEST_RUN(test_mesh_simplify_degenerate);
+    TEST_RUN(test_mesh_lod_select);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_mesh_load_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
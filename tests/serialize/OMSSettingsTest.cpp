@@ -0,0 +1,260 @@
+#include "../TestFramework.h"
+#include "../../serialize/OMSSettings.h"
+
+struct SettingsTestData {
+    bool is_fullscreen;
+    int32 window_width;
+    int32 window_height;
+    uint8 volume;
+    f32 gamma;
+    f64 sensitivity;
+    int32 ids[4];
+    char name[32];
+};
+
+static const SettingsMatch SETTINGS_TEST_MATCH[] = {
+    {"is_fullscreen", DATA_TYPE_BOOL, offsetof(SettingsTestData, is_fullscreen), 1},
+    {"window_width", DATA_TYPE_INT32, offsetof(SettingsTestData, window_width), 1},
+    {"window_height", DATA_TYPE_INT32, offsetof(SettingsTestData, window_height), 1},
+    {"window", DATA_TYPE_UINT8, offsetof(SettingsTestData, volume), 1},
+    {"gamma", DATA_TYPE_F32, offsetof(SettingsTestData, gamma), 1},
+    {"sensitivity", DATA_TYPE_F64, offsetof(SettingsTestData, sensitivity), 1},
+    {"ids", DATA_TYPE_INT32_ARRAY, offsetof(SettingsTestData, ids), 4},
+    {"name", DATA_TYPE_CHAR_STR, offsetof(SettingsTestData, name), 1},
+};
+
+static const char SETTINGS_TEST_FILE[] =
+    "// Video\n"
+    "is_fullscreen 1\n"
+    "window_width 1920\n"
+    "window_height 1080\n"
+    "window 7\n"
+    "unknown_setting 5\n"
+    "gamma 2.2\n"
+    "sensitivity 0.5\n"
+    "ids[] 4 3 2 1\n"
+    "name Player One\n";
+
+static void test_settings_hash_create() {
+    SettingsHashMap hm;
+    byte buf[256];
+    TEST_TRUE(settings_hash_size(ARRAY_COUNT(SETTINGS_TEST_MATCH)) <= (int64) sizeof(buf));
+    TEST_TRUE(settings_hash_create(&hm, SETTINGS_TEST_MATCH, ARRAY_COUNT(SETTINGS_TEST_MATCH), buf));
+
+    // Every name is found, even if it is only a prefix of another name
+    bool is_valid = true;
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(SETTINGS_TEST_MATCH); ++i) {
+        const char* name = SETTINGS_TEST_MATCH[i].name;
+        is_valid &= settings_hash_find(&hm, name, (int32) strlen(name)) == i;
+    }
+
+    TEST_TRUE(is_valid);
+
+    TEST_EQUALS(settings_hash_find(&hm, "windo", 5), -1);
+    TEST_EQUALS(settings_hash_find(&hm, "window_widthx", 13), -1);
+    TEST_EQUALS(settings_hash_find(&hm, "unknown_setting", 15), -1);
+    TEST_EQUALS(settings_hash_find(&hm, "", 0), -1);
+}
+
+static void test_settings_hash_create_large() {
+    static char names[SETTINGS_HASH_MAX_COUNT][16];
+    static SettingsMatch match[SETTINGS_HASH_MAX_COUNT];
+
+    for (int32 i = 0; i < SETTINGS_HASH_MAX_COUNT; ++i) {
+        sprintf_fast(names[i], 16, "setting_%d", i);
+        match[i] = {names[i], DATA_TYPE_INT32, 0, 1};
+    }
+
+    SettingsHashMap hm;
+    byte* buf = (byte *) malloc(settings_hash_size(SETTINGS_HASH_MAX_COUNT));
+    TEST_TRUE(settings_hash_create(&hm, match, SETTINGS_HASH_MAX_COUNT, buf));
+
+    bool is_valid = true;
+    for (int32 i = 0; i < SETTINGS_HASH_MAX_COUNT; ++i) {
+        is_valid &= settings_hash_find(&hm, names[i], (int32) strlen(names[i])) == i;
+    }
+
+    TEST_TRUE(is_valid);
+
+    free(buf);
+}
+
+static void test_settings_load() {
+    SettingsHashMap hm;
+    byte buf[256];
+    settings_hash_create(&hm, SETTINGS_TEST_MATCH, ARRAY_COUNT(SETTINGS_TEST_MATCH), buf);
+
+    SettingsTestData settings = {};
+    settings_load(&settings, SETTINGS_TEST_FILE, &hm);
+
+    TEST_TRUE(settings.is_fullscreen);
+    TEST_EQUALS(settings.window_width, 1920);
+    TEST_EQUALS(settings.window_height, 1080);
+    TEST_EQUALS(settings.volume, 7);
+    TEST_EQUALS(settings.gamma, 2.2f);
+    TEST_EQUALS(settings.sensitivity, (f64) 0.5f);
+    TEST_EQUALS(settings.ids[0], 4);
+    TEST_EQUALS(settings.ids[3], 1);
+    TEST_EQUALS(strcmp(settings.name, "Player One"), 0);
+}
+
+static void test_settings_save() {
+    SettingsHashMap hm;
+    byte buf[256];
+    settings_hash_create(&hm, SETTINGS_TEST_MATCH, ARRAY_COUNT(SETTINGS_TEST_MATCH), buf);
+
+    SettingsTestData settings = {};
+    settings_load(&settings, SETTINGS_TEST_FILE, &hm);
+
+    settings.window_width = 2560;
+    settings.volume = 3;
+    settings.ids[0] = 10;
+    settings.ids[1] = -20;
+    settings.ids[2] = 30;
+    settings.ids[3] = 40;
+
+    char out[1024];
+    const size_t length = settings_save(&settings, SETTINGS_TEST_FILE, out, sizeof(out), &hm);
+    out[length] = '\0';
+
+    // Comments and unknown settings are kept
+    TEST_TRUE(str_contains(out, "// Video\n"));
+    TEST_TRUE(str_contains(out, "unknown_setting 5\n"));
+    TEST_TRUE(str_contains(out, "window_width 2560\n"));
+    TEST_TRUE(str_contains(out, "window 3\n"));
+    TEST_TRUE(str_contains(out, "ids[] 10 -20 30 40\n"));
+
+    // Loading the saved file returns the same settings
+    SettingsTestData loaded = {};
+    settings_load(&loaded, out, &hm);
+
+    TEST_EQUALS(loaded.window_width, 2560);
+    TEST_EQUALS(loaded.window_height, 1080);
+    TEST_EQUALS(loaded.volume, 3);
+    TEST_EQUALS(loaded.gamma, settings.gamma);
+    TEST_EQUALS(strcmp(loaded.name, "Player One"), 0);
+
+    bool is_same = true;
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(loaded.ids); ++i) {
+        is_same &= loaded.ids[i] == settings.ids[i];
+    }
+
+    TEST_TRUE(is_same);
+}
+
+// Unknown lines are copied as is and may be longer than the output buffer
+static void test_settings_save_overflow() {
+    SettingsHashMap hm;
+    byte buf[256];
+    settings_hash_create(&hm, SETTINGS_TEST_MATCH, ARRAY_COUNT(SETTINGS_TEST_MATCH), buf);
+
+    char file[512];
+    char* pos = file;
+    pos += str_copy(pos, "window_width 1920\n// ");
+    memset(pos, 'a', 300);
+    pos += 300;
+    str_copy(pos, "\nwindow_height 1080\n");
+
+    SettingsTestData settings = {};
+    settings_load(&settings, file, &hm);
+
+    char* out = (char *) malloc(256);
+    const size_t length = settings_save(&settings, file, out, 256, &hm);
+
+    // Only the first line fits
+    TEST_EQUALS(length, sizeof("window_width 1920\n") - 1);
+    TEST_EQUALS(memcmp(out, "window_width 1920\n", length), 0);
+
+    free(out);
+}
+
+#if PERFORMANCE_TEST
+#define SETTINGS_TEST_PERF_COUNT 256
+
+static SettingsMatch _settings_perf_match[SETTINGS_TEST_PERF_COUNT];
+static SettingsHashMap _settings_perf_hm;
+static char _settings_perf_file[SETTINGS_TEST_PERF_COUNT * 32];
+static int32 _settings_perf_data[SETTINGS_TEST_PERF_COUNT];
+
+static void _settings_perf_init() {
+    static char names[SETTINGS_TEST_PERF_COUNT][24];
+    static byte buf[4096];
+
+    if (_settings_perf_file[0]) {
+        return;
+    }
+
+    char* pos = _settings_perf_file;
+    for (int32 i = 0; i < SETTINGS_TEST_PERF_COUNT; ++i) {
+        // The linear search matches prefixes -> the names must not be prefixes of each other
+        sprintf_fast(names[i], 24, "setting_%d_value", i);
+        _settings_perf_match[i] = {names[i], DATA_TYPE_INT32, i * sizeof(int32), 1};
+
+        pos += sprintf_fast(pos, "%s %d\n", names[i], i);
+    }
+
+    settings_hash_create(&_settings_perf_hm, _settings_perf_match, SETTINGS_TEST_PERF_COUNT, buf);
+}
+
+static void _settings_load_hash(volatile void* val) {
+    _settings_perf_init();
+    settings_load(_settings_perf_data, _settings_perf_file, &_settings_perf_hm);
+
+    *((volatile int64 *) val) += _settings_perf_data[SETTINGS_TEST_PERF_COUNT - 1];
+}
+
+// The previous implementation
+static void _settings_load_linear(volatile void* val) {
+    _settings_perf_init();
+
+    const char* data = _settings_perf_file;
+    while (*data != '\0') {
+        str_skip_empty(&data);
+
+        const char* name = data;
+        str_move_to(&data, SETTINGS_NAME_DELIMITER);
+        str_skip_whitespace(&data);
+
+        for (int32 i = 0; i < SETTINGS_TEST_PERF_COUNT; ++i) {
+            if (strncmp(name, _settings_perf_match[i].name, strlen(_settings_perf_match[i].name)) == 0) {
+                data = settings_load_value((byte *) _settings_perf_data, data, _settings_perf_match, i);
+
+                break;
+            }
+        }
+
+        str_move_to(&data, '\n');
+    }
+
+    *((volatile int64 *) val) += _settings_perf_data[SETTINGS_TEST_PERF_COUNT - 1];
+}
+
+static void test_settings_load_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_settings_load_hash, _settings_load_linear, -50.0);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main OMSSettingsTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_settings_hash_create);
+    TEST_RUN(test_settings_hash_create_large);
+    TEST_RUN(test_settings_load);
+    TEST_RUN(test_settings_save);
+    TEST_RUN(test_settings_save_overflow);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_settings_load_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
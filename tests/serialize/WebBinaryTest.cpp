@@ -0,0 +1,181 @@
+#include "../TestFramework.h"
+#include "../../serialize/WebBinary.h"
+#include "../../models/base/Address.h"
+
+struct WebBinaryTestPosition {
+    f32 x;
+    f32 y;
+    f32 z;
+};
+
+CONSTEXPR WebBinaryValue WebBinaryTestPositionSchema[] = {
+    WEB_BINARY_FIELD(WebBinaryTestPosition, x),
+    WEB_BINARY_FIELD(WebBinaryTestPosition, y),
+    WEB_BINARY_FIELD(WebBinaryTestPosition, z),
+};
+
+struct WebBinaryTestPacket {
+    uint16 type;
+    bool is_visible;
+    WebBinaryTestPosition pos;
+    uint64 id;
+    int32 health;
+    uint32 tick;
+    char name[12];
+};
+
+CONSTEXPR WebBinaryValue WebBinaryTestPacketSchema[] = {
+    WEB_BINARY_FIELD(WebBinaryTestPacket, type),
+    WEB_BINARY_FIELD(WebBinaryTestPacket, is_visible),
+    WEB_BINARY_FIELD_WITH_SCHEMA(WebBinaryTestPacket, pos, WebBinaryTestPositionSchema),
+    WEB_BINARY_FIELD_ENCODED(WebBinaryTestPacket, id, WEB_BINARY_ENCODING_VARINT),
+    WEB_BINARY_FIELD_ENCODED(WebBinaryTestPacket, health, WEB_BINARY_ENCODING_VARINT),
+    WEB_BINARY_FIELD_ENCODED(WebBinaryTestPacket, tick, WEB_BINARY_ENCODING_DELTA),
+    WEB_BINARY_FIELD(WebBinaryTestPacket, name),
+};
+
+// Same as above but health is fixed
+CONSTEXPR WebBinaryValue WebBinaryTestPacketSchemaV2[] = {
+    WEB_BINARY_FIELD(WebBinaryTestPacket, type),
+    WEB_BINARY_FIELD(WebBinaryTestPacket, is_visible),
+    WEB_BINARY_FIELD_WITH_SCHEMA(WebBinaryTestPacket, pos, WebBinaryTestPositionSchema),
+    WEB_BINARY_FIELD_ENCODED(WebBinaryTestPacket, id, WEB_BINARY_ENCODING_VARINT),
+    WEB_BINARY_FIELD(WebBinaryTestPacket, health),
+    WEB_BINARY_FIELD_ENCODED(WebBinaryTestPacket, tick, WEB_BINARY_ENCODING_DELTA),
+    WEB_BINARY_FIELD(WebBinaryTestPacket, name),
+};
+
+static void test_web_binary_schema() {
+    static_assert(WebBinaryType<uint16>::type == DATA_TYPE_UINT16);
+    static_assert(WebBinaryType<int32[4]>::type == DATA_TYPE_INT32_ARRAY);
+    static_assert(WebBinaryType<char[12]>::type == DATA_TYPE_CHAR_STR);
+    static_assert(WebBinaryType<WebBinaryTestPosition>::type == DATA_TYPE_STRUCT);
+
+    // Everything up to the first varint field can be read in place
+    static_assert(web_binary_wire_offset(WebBinaryTestPacketSchema, 2) == 3);
+    static_assert(web_binary_wire_offset(WebBinaryTestPacketSchema, 3) == 15);
+    static_assert(web_binary_wire_offset(WebBinaryTestPacketSchema, 4) == -1);
+
+    static_assert(web_binary_is_memory_layout(
+        WebBinaryTestPositionSchema, ARRAY_COUNT(WebBinaryTestPositionSchema), sizeof(WebBinaryTestPosition)
+    ));
+    static_assert(!web_binary_is_memory_layout(
+        WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema), sizeof(WebBinaryTestPacket)
+    ));
+
+    // Any change of the wire format changes the hash
+    CONSTEXPR uint64 hash = web_binary_schema_hash(WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema));
+    CONSTEXPR uint64 hash_v2 = web_binary_schema_hash(WebBinaryTestPacketSchemaV2, ARRAY_COUNT(WebBinaryTestPacketSchemaV2));
+    TEST_NOT_EQUALS(hash, hash_v2);
+    TEST_NOT_EQUALS(hash, web_binary_schema_hash(WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema) - 1));
+
+    // Existing schemas compile and contain the hash
+    CONSTEXPR auto schema = web_binary_schema<LocationSchemaStruct, ARRAY_COUNT(LocationSchemaStruct)>();
+    uint64 schema_hash;
+    memcpy(&schema_hash, schema.c_str(), sizeof(schema_hash));
+    TEST_EQUALS(schema_hash, web_binary_schema_hash(LocationSchemaStruct, ARRAY_COUNT(LocationSchemaStruct)));
+    TEST_EQUALS(strcmp(schema.c_str() + sizeof(uint64) + sizeof(int32), "id"), 0);
+    TEST_EQUALS(LocationSchema.size(), schema.size());
+}
+
+static void test_web_binary_roundtrip() {
+    WebBinaryTestPacket prev = {};
+    prev.tick = 1000;
+
+    WebBinaryTestPacket packet = {};
+    packet.type = 0x1234;
+    packet.is_visible = true;
+    packet.pos = {1.5f, -2.0f, 3.25f};
+    packet.id = 300;
+    packet.health = -5;
+    packet.tick = 1003;
+    str_copy(packet.name, "Goblin");
+
+    byte buffer[web_binary_max_size(WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema))];
+    const int32 length = web_binary_write<WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema)>(
+        buffer, &packet, &prev
+    );
+
+    // 15 fixed bytes + 2 byte id + 1 byte health + 1 byte tick delta + name
+    TEST_EQUALS(length, 15 + 2 + 1 + 1 + 12);
+
+    // Fixed fields are read in place
+    TEST_EQUALS((web_binary_get<WebBinaryTestPacketSchema, 0, uint16>(buffer)), 0x1234);
+    TEST_EQUALS((web_binary_get<WebBinaryTestPositionSchema, 2, f32>(
+        web_binary_field<WebBinaryTestPacketSchema, 2>(buffer)
+    )), 3.25f);
+
+    WebBinaryTestPacket result = {};
+    TEST_EQUALS((web_binary_read<WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema)>(
+        buffer, length, &result, &prev
+    )), length);
+
+    TEST_EQUALS(result.type, packet.type);
+    TEST_TRUE(result.is_visible);
+    TEST_EQUALS(result.pos.y, -2.0f);
+    TEST_EQUALS(result.id, 300);
+    TEST_EQUALS(result.health, -5);
+    TEST_EQUALS(result.tick, 1003);
+    TEST_EQUALS(strcmp(result.name, "Goblin"), 0);
+
+    // Extreme values survive the varint/delta encoding
+    packet.id = 0xFFFFFFFFFFFFFFFFULL;
+    packet.health = INT32_MIN;
+    packet.tick = 0;
+    prev.tick = 0xFFFFFFFF;
+
+    const int32 length2 = web_binary_write<WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema)>(
+        buffer, &packet, &prev
+    );
+    // The tick wraps around -> delta of 1
+    TEST_EQUALS(length2, (int32) sizeof(buffer) - 4);
+
+    web_binary_read<WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema)>(buffer, length2, &result, &prev);
+    TEST_EQUALS(result.id, 0xFFFFFFFFFFFFFFFFULL);
+    TEST_EQUALS(result.health, INT32_MIN);
+    TEST_EQUALS(result.tick, 0);
+
+    // Truncated data
+    TEST_EQUALS((web_binary_read<WebBinaryTestPacketSchema, ARRAY_COUNT(WebBinaryTestPacketSchema)>(
+        buffer, length2 - 1, &result, &prev
+    )), -1);
+}
+
+static void test_web_binary_memory_layout() {
+    WebBinaryTestPosition pos = {1.0f, 2.0f, 3.0f};
+
+    byte buffer[sizeof(WebBinaryTestPosition)];
+    TEST_EQUALS((web_binary_write<WebBinaryTestPositionSchema, ARRAY_COUNT(WebBinaryTestPositionSchema)>(buffer, &pos)),
+        (int32) sizeof(WebBinaryTestPosition)
+    );
+    TEST_EQUALS(memcmp(buffer, &pos, sizeof(pos)), 0);
+
+    WebBinaryTestPosition result;
+    TEST_EQUALS((web_binary_read<WebBinaryTestPositionSchema, ARRAY_COUNT(WebBinaryTestPositionSchema)>(
+        buffer, sizeof(buffer), &result
+    )), (int32) sizeof(WebBinaryTestPosition));
+    TEST_EQUALS(result.z, 3.0f);
+
+    TEST_EQUALS((web_binary_read<WebBinaryTestPositionSchema, ARRAY_COUNT(WebBinaryTestPositionSchema)>(
+        buffer, sizeof(buffer) - 1, &result
+    )), -1);
+}
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main WebBinaryTest
+#endif
+
+int main() {
+    TEST_INIT(25);
+
+    TEST_RUN(test_web_binary_schema);
+    TEST_RUN(test_web_binary_roundtrip);
+    TEST_RUN(test_web_binary_memory_layout);
+
+    TEST_FINALIZE();
+
+    return 0;
+}
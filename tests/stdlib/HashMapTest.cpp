@@ -67,6 +67,41 @@ static void test_hashmap_remove() {
     hashmap_free(&hm);
 }
 
+// All keys end up in the same chain
+static void test_hashmap_remove_int64_chain() {
+    HashMap hm = {0};
+    hashmap_alloc(&hm, 8, 8, sizeof(HashEntryInt64KeyInt64));
+    hm.hash_function = hash_int64;
+
+    const uint64 key = 1;
+    const uint64 capacity = (uint64) hm.buf.capacity;
+
+    hashmap_insert(&hm, key, (int64) 1);
+    hashmap_insert(&hm, key + capacity, (int64) 2);
+    hashmap_insert(&hm, key + 2 * capacity, (int64) 3);
+
+    // Not in the chain
+    TEST_EQUALS(hashmap_get_entry(&hm, key + 3 * capacity), NULL);
+
+    // Remove the chain start
+    hashmap_remove(&hm, key);
+    TEST_EQUALS(hashmap_get_entry(&hm, key), NULL);
+    TEST_EQUALS(((HashEntryInt64KeyInt64 *) hashmap_get_entry(&hm, key + capacity))->value, 2);
+    TEST_EQUALS(((HashEntryInt64KeyInt64 *) hashmap_get_entry(&hm, key + 2 * capacity))->value, 3);
+
+    // Remove the chain end
+    hashmap_remove(&hm, key + 2 * capacity);
+    TEST_EQUALS(hashmap_get_entry(&hm, key + 2 * capacity), NULL);
+    TEST_EQUALS(((HashEntryInt64KeyInt64 *) hashmap_get_entry(&hm, key + capacity))->value, 2);
+
+    // The freed elements can be reused
+    hashmap_insert(&hm, key, (int64) 4);
+    TEST_EQUALS(((HashEntryInt64KeyInt64 *) hashmap_get_entry(&hm, key))->value, 4);
+    TEST_EQUALS(((HashEntryInt64KeyInt64 *) hashmap_get_entry(&hm, key + capacity))->value, 2);
+
+    hashmap_free(&hm);
+}
+
 static void test_hashmap_dump_load() {
     RingMemory ring;
     ring_alloc(&ring, 10 * MEGABYTE, 10 * MEGABYTE, ASSUMED_CACHE_LINE_SIZE);
@@ -422,6 +457,7 @@ int main() {
     TEST_RUN(test_hashmap_alloc);
     TEST_RUN(test_hashmap_insert_int32);
     TEST_RUN(test_hashmap_remove);
+    TEST_RUN(test_hashmap_remove_int64_chain);
     TEST_RUN(test_hashmap_dump_load);
 
     #if PERFORMANCE_TEST
@@ -0,0 +1,150 @@
+#include "../TestFramework.h"
+#include "../../utils/RegexSimplified.h"
+
+static void test_regex_simplified_validate() {
+    TEST_TRUE(regex_simplified_validate("abc", "abc"));
+    TEST_TRUE(regex_simplified_validate("abc", "xxabcxx"));
+    TEST_TRUE(regex_simplified_validate("^abc$", "abc"));
+    TEST_FALSE(regex_simplified_validate("^abc$", "abcd"));
+    TEST_FALSE(regex_simplified_validate("^abc", "xabc"));
+    TEST_TRUE(regex_simplified_validate("abc$", "xabc"));
+    TEST_FALSE(regex_simplified_validate("abc$", "abcx"));
+
+    // Character classes
+    TEST_TRUE(regex_simplified_validate("a-z", "a"));
+    TEST_TRUE(regex_simplified_validate("a-z", "z"));
+    TEST_FALSE(regex_simplified_validate("a-z", "A"));
+    TEST_TRUE(regex_simplified_validate("A-Z", "Z"));
+    TEST_FALSE(regex_simplified_validate("A-Z", "a"));
+    TEST_TRUE(regex_simplified_validate("0-9", "5"));
+    TEST_FALSE(regex_simplified_validate("0-9", "a"));
+    TEST_TRUE(regex_simplified_validate("\\d", "5"));
+    TEST_FALSE(regex_simplified_validate("\\d", "a"));
+    TEST_TRUE(regex_simplified_validate("^[a-f0-9_]+$", "ab09_f"));
+    TEST_FALSE(regex_simplified_validate("^[a-f0-9_]+$", "ab09g"));
+    TEST_TRUE(regex_simplified_validate("^[^/]+$", "segment"));
+    TEST_FALSE(regex_simplified_validate("^[^/]+$", "seg/ment"));
+    TEST_TRUE(regex_simplified_validate("^\\w+\\s\\w+$", "hello world"));
+
+    // Quantifiers
+    TEST_TRUE(regex_simplified_validate("^a*$", ""));
+    TEST_TRUE(regex_simplified_validate("^a*$", "aaa"));
+    TEST_FALSE(regex_simplified_validate("^a+$", ""));
+    TEST_TRUE(regex_simplified_validate("^a+$", "aaa"));
+    TEST_TRUE(regex_simplified_validate("^a?b$", "b"));
+    TEST_TRUE(regex_simplified_validate("^a?b$", "ab"));
+    TEST_FALSE(regex_simplified_validate("^a?b$", "aab"));
+
+    // Groups and alternation
+    TEST_TRUE(regex_simplified_validate("^(a|b)c$", "ac"));
+    TEST_TRUE(regex_simplified_validate("^(a|b)c$", "bc"));
+    TEST_FALSE(regex_simplified_validate("^(a|b)c$", "cc"));
+    TEST_TRUE(regex_simplified_validate("^(a-z)+$", "abc"));
+    TEST_TRUE(regex_simplified_validate("^(0-9)+$", "123"));
+    TEST_TRUE(regex_simplified_validate("^(get|post|put)$", "post"));
+    TEST_FALSE(regex_simplified_validate("^(get|post|put)$", "pos"));
+
+    // Escape sequences
+    TEST_TRUE(regex_simplified_validate("\\.", "."));
+    TEST_FALSE(regex_simplified_validate("\\.", "a"));
+    TEST_TRUE(regex_simplified_validate("a\\db", "a0b"));
+    TEST_FALSE(regex_simplified_validate("a\\db", "aab"));
+
+    // Any character
+    TEST_TRUE(regex_simplified_validate("a.b", "a b"));
+    TEST_TRUE(regex_simplified_validate("a.b", "a\nb"));
+    TEST_FALSE(regex_simplified_validate("a.b", "ab"));
+
+    // Repetitions
+    TEST_TRUE(regex_simplified_validate("^a{2}$", "aa"));
+    TEST_FALSE(regex_simplified_validate("^a{2}$", "a"));
+    TEST_FALSE(regex_simplified_validate("^a{2}$", "aaa"));
+    TEST_TRUE(regex_simplified_validate("^a{2,4}$", "aaaa"));
+    TEST_FALSE(regex_simplified_validate("^a{2,4}$", "aaaaa"));
+    TEST_TRUE(regex_simplified_validate("^a{2,}$", "aaaaa"));
+    TEST_FALSE(regex_simplified_validate("^a{2,}$", "a"));
+    TEST_TRUE(regex_simplified_validate("^(a-z){2,4}$", "abcd"));
+    TEST_FALSE(regex_simplified_validate("^(a-z){2,4}$", "abcde"));
+    TEST_TRUE(regex_simplified_validate("^\\d{3}-\\d{2}$", "123-45"));
+    TEST_FALSE(regex_simplified_validate("^\\d{3}-\\d{2}$", "12-345"));
+    TEST_TRUE(regex_simplified_validate("^a{2}b{1,3}c$", "aabbbc"));
+    TEST_FALSE(regex_simplified_validate("^a{2}b{1,3}c$", "aabbbbc"));
+    TEST_FALSE(regex_simplified_validate("^a{2}b{1,3}c$", "abbc"));
+
+    // Invalid patterns never match
+    TEST_FALSE(regex_simplified_validate("(abc", "abc"));
+    TEST_FALSE(regex_simplified_validate("abc)", "abc"));
+    TEST_FALSE(regex_simplified_validate("a{3,1}", "aaa"));
+    TEST_FALSE(regex_simplified_validate("*a", "a"));
+    TEST_FALSE(regex_simplified_validate("[a-z", "a"));
+}
+
+static void test_regex_cache() {
+    RegexCache cache;
+    regex_cache_alloc(&cache, 8);
+
+    const RegexDfa* dfa = regex_cache_get(&cache, "^\\d+$");
+    TEST_TRUE(dfa != NULL);
+    TEST_EQUALS(regex_cache_get(&cache, "^\\d+$"), dfa);
+    TEST_EQUALS(cache.count, 1);
+
+    TEST_TRUE(regex_simplified_validate("^\\d+$", "1234", &cache));
+    TEST_FALSE(regex_simplified_validate("^\\d+$", "12a4", &cache));
+    TEST_EQUALS(cache.count, 1);
+
+    // Invalid patterns are cached as well
+    TEST_FALSE(regex_simplified_validate("(a", "a", &cache));
+    TEST_EQUALS(cache.count, 2);
+
+    // The cache is never filled more than 3/4, after that the patterns are compiled on every call
+    TEST_TRUE(regex_simplified_validate("b", "b", &cache));
+    TEST_TRUE(regex_simplified_validate("c", "c", &cache));
+    TEST_TRUE(regex_simplified_validate("d", "d", &cache));
+    TEST_TRUE(regex_simplified_validate("e", "e", &cache));
+    TEST_EQUALS(cache.count, 6);
+    TEST_EQUALS(regex_cache_get(&cache, "f"), NULL);
+    TEST_TRUE(regex_simplified_validate("f", "f", &cache));
+
+    regex_cache_free(&cache);
+}
+
+#if PERFORMANCE_TEST
+static const char _regex_bench_text[] = "user_name-with_some-length_0123456789";
+
+static void _regex_compiled(MAYBE_UNUSED volatile void* val) {
+    static RegexDfa dfa;
+    static bool compiled = regex_compile(&dfa, "^[a-z_-]+\\d{10}$");
+
+    *((volatile bool *) val) = regex_match(&dfa, _regex_bench_text);
+}
+
+static void _regex_uncompiled(MAYBE_UNUSED volatile void* val) {
+    *((volatile bool *) val) = regex_simplified_validate("^[a-z_-]+\\d{10}$", _regex_bench_text);
+}
+
+static void test_regex_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_regex_compiled, _regex_uncompiled, 90.0);
+}
+#endif
+
+#ifdef UBER_TEST
+    #ifdef main
+        #undef main
+    #endif
+    #define main UtilsRegexSimplifiedTest
+#endif
+
+int main() {
+    TEST_INIT(100);
+
+    TEST_RUN(test_regex_simplified_validate);
+    TEST_RUN(test_regex_cache);
+
+    #if PERFORMANCE_TEST
+        TEST_RUN(test_regex_performance);
+    #endif
+
+    TEST_FINALIZE();
+
+    return 0;
+}
@@ -34,6 +34,169 @@ static void test_utf8_strlen()
     TEST_EQUALS(utf8_strlen(in), 21);
 }
 
+// Mixed ASCII, 2-, 3- and 4-byte sequences
+static const char _utf8_test_text[] = "Foo \xC2\xA9 bar \xF0\x9D\x8C\x86 baz \xE2\x98\x83 qux \xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 \xF4\x8F\xBF\xBF\xEF\xBF\xBF";
+
+static const char* _utf8_test_invalid[] = {
+    "\x80", // continuation without lead
+    "\xC3", // truncated
+    "\xE2\x82", // truncated
+    "\xF0\x9D\x8C", // truncated
+    "\xC3\x28", // missing continuation
+    "\xC0\xAF", // overlong 2-byte
+    "\xE0\x80\xAF", // overlong 3-byte
+    "\xF0\x80\x80\xAF", // overlong 4-byte
+    "\xED\xA0\x80", // surrogate
+    "\xF4\x90\x80\x80", // > U+10FFFF
+    "\xF5\x80\x80\x80", // > U+10FFFF
+    "\xC2\xA9\x80", // too many continuations
+};
+
+static void test_utf8_is_valid()
+{
+    const int32 steps[] = {16, 4, 1};
+
+    for (int32 s = 0; s < (int32) ARRAY_COUNT(steps); ++s) {
+        TEST_TRUE(utf8_is_valid("", 0, steps[s]));
+        TEST_TRUE(utf8_is_valid(_utf8_test_text, sizeof(_utf8_test_text) - 1, steps[s]));
+
+        // Every invalid sequence at every position of the SIMD blocks
+        bool is_invalid = true;
+        for (int32 i = 0; i < (int32) ARRAY_COUNT(_utf8_test_invalid); ++i) {
+            const size_t length = strlen(_utf8_test_invalid[i]);
+
+            for (int32 pos = 0; pos < 70; ++pos) {
+                char buffer[128];
+                memset(buffer, 'a', sizeof(buffer));
+                memcpy(buffer + pos, _utf8_test_invalid[i], length);
+
+                is_invalid &= !utf8_is_valid(buffer, pos + length, steps[s]);
+                is_invalid &= !utf8_is_valid(buffer, sizeof(buffer), steps[s]);
+            }
+        }
+
+        TEST_TRUE(is_invalid);
+    }
+
+    // Random data, SIMD and scalar must agree
+    srand(0);
+    bool is_equal = true;
+    int32 valid_count = 0;
+    for (int32 i = 0; i < 2000; ++i) {
+        char buffer[100];
+        const size_t length = (size_t) (rand() % (int32) sizeof(buffer));
+
+        // Mostly valid text with a few random bytes
+        for (size_t j = 0; j < length; ++j) {
+            buffer[j] = _utf8_test_text[rand() % (sizeof(_utf8_test_text) - 1)];
+        }
+
+        if (i & 1) {
+            buffer[rand() % (length + 1)] = (char) rand();
+        }
+
+        const bool is_valid = utf8_is_valid(buffer, length, 1);
+        valid_count += is_valid;
+        is_equal &= utf8_is_valid(buffer, length, 16) == is_valid;
+        is_equal &= utf8_is_valid(buffer, length, 4) == is_valid;
+    }
+
+    TEST_TRUE(is_equal);
+    TEST_TRUE(valid_count > 0 && valid_count < 2000);
+}
+
+static void test_utf8_to_utf32()
+{
+    const int32 steps[] = {16, 4, 1};
+
+    for (int32 s = 0; s < (int32) ARRAY_COUNT(steps); ++s) {
+        uint32 out[128];
+        const char in[] = "Foo \xC2\xA9 bar \xF0\x9D\x8C\x86 baz \xE2\x98\x83 qux";
+
+        TEST_EQUALS(utf8_to_utf32(in, sizeof(in) - 1, out, steps[s]), 21);
+        TEST_EQUALS(out[0], 'F');
+        TEST_EQUALS(out[4], 0xA9);
+        TEST_EQUALS(out[10], 0x1D306);
+        TEST_EQUALS(out[16], 0x2603);
+        TEST_EQUALS(out[20], 'x');
+
+        // Invalid bytes are replaced
+        TEST_EQUALS(utf8_to_utf32("a\x80" "b", 3, out, steps[s]), 3);
+        TEST_EQUALS(out[1], 0xFFFD);
+        TEST_EQUALS(out[2], 'b');
+    }
+
+    // Long text crossing the SIMD blocks
+    char text[1024];
+    size_t length = 0;
+    while (length + sizeof(_utf8_test_text) < sizeof(text)) {
+        memcpy(text + length, _utf8_test_text, sizeof(_utf8_test_text) - 1);
+        length += sizeof(_utf8_test_text) - 1;
+        memset(text + length, 'a', length % 37);
+        length += length % 37;
+    }
+
+    uint32 expected[1024];
+    int32 expected_count = 0;
+    for (size_t i = 0; i < length;) {
+        i += utf8_decode(text + i, &expected[expected_count++]);
+    }
+
+    uint32 out[1024];
+    TEST_EQUALS(utf8_to_utf32(text, length, out, 16), expected_count);
+    TEST_EQUALS(memcmp(out, expected, expected_count * sizeof(uint32)), 0);
+
+    TEST_EQUALS(utf8_to_utf32(text, length, out, 4), expected_count);
+    TEST_EQUALS(memcmp(out, expected, expected_count * sizeof(uint32)), 0);
+}
+
+static void test_str_move_to_delim()
+{
+    const char* str = "key = value;\nnext";
+    const char* tmp = str;
+
+    str_move_to(&tmp, "=;");
+    TEST_EQUALS(*tmp, '=');
+
+    ++tmp;
+    str_move_to(&tmp, "=;");
+    TEST_EQUALS(*tmp, ';');
+
+    // The terminator is always a delimiter
+    tmp = str;
+    str_move_to(&tmp, "#");
+    TEST_EQUALS(tmp, str + strlen(str));
+
+    // Every start offset and every delimiter position inside the SIMD blocks
+    alignas(64) char buffer[160];
+    bool is_equal = true;
+    for (int32 start = 0; start < 40; ++start) {
+        for (int32 pos = start; pos < 100; ++pos) {
+            memset(buffer, 'a', sizeof(buffer));
+            buffer[pos] = (pos & 1) ? '\t' : '\xC3';
+            buffer[120] = '\0';
+
+            const char* simd = buffer + start;
+            str_move_to(&simd, "\t\n \xC3");
+
+            const char* scalar = buffer + start;
+            str_move_to(&scalar, "\t\n \xC3", 1);
+
+            is_equal &= simd == buffer + pos && scalar == simd;
+        }
+    }
+
+    TEST_TRUE(is_equal);
+
+    // More than 8 different high nibbles uses the scalar version
+    StrByteSet set;
+    TEST_FALSE(str_byte_set_create(&set, "\x10\x20\x30\x40\x50\x60\x70\x80\x90"));
+
+    tmp = "abc\x90";
+    str_move_to(&tmp, "\x10\x20\x30\x40\x50\x60\x70\x80\x90");
+    TEST_EQUALS(*tmp, '\x90');
+}
+
 static void test_str_is_float()
 {
     TEST_TRUE(str_is_float("1.234"));
@@ -236,6 +399,9 @@ static void test_sprintf_fast()
     char buffer[256];
     sprintf_fast(buffer, "This %d is a %s with %f values", 1337, "test", 3.0f);
     TEST_TRUE(strcmp(buffer, "This 1337 is a test with 3.00000 values") == 0);
+
+    sprintf_fast(buffer, "%g %g", 0.1f, 1e-7f);
+    TEST_TRUE(strcmp(buffer, "0.1 1e-7") == 0);
 }
 
 #if PERFORMANCE_TEST
@@ -261,13 +427,304 @@ static void test_sprintf_fast_performance() {
 }
 #endif
 
+#if PERFORMANCE_TEST
+static char* _utf8_test_text_long() {
+    static char text[64 * 1024 + 1];
+    if (!text[0]) {
+        for (size_t i = 0; i < sizeof(text) - 1; ++i) {
+            // Mostly ASCII with some multi-byte sequences (e.g. localization files)
+            text[i] = (i % 61) < 59 ? (char) ('a' + i % 26) : (char) ((i % 61) == 59 ? 0xC3 : 0xA9);
+        }
+    }
+
+    return text;
+}
+
+static void _utf8_is_valid_simd(volatile void* val) {
+    *((volatile int64 *) val) += utf8_is_valid(_utf8_test_text_long(), 64 * 1024, 16);
+}
+
+static void _utf8_is_valid_scalar(volatile void* val) {
+    *((volatile int64 *) val) += utf8_is_valid(_utf8_test_text_long(), 64 * 1024, 1);
+}
+
+static void _utf8_to_utf32_simd(volatile void* val) {
+    static uint32 out[64 * 1024];
+    *((volatile int64 *) val) += utf8_to_utf32(_utf8_test_text_long(), 64 * 1024, out, 16);
+}
+
+static void _utf8_to_utf32_scalar(volatile void* val) {
+    static uint32 out[64 * 1024];
+    *((volatile int64 *) val) += utf8_to_utf32(_utf8_test_text_long(), 64 * 1024, out, 1);
+}
+
+static void _str_move_to_delim_simd(volatile void* val) {
+    const char* text = _utf8_test_text_long();
+    str_move_to(&text, "\n\t;=", 16);
+    *((volatile int64 *) val) += (int64) (uintptr_t) text;
+}
+
+static void _str_move_to_delim_scalar(volatile void* val) {
+    const char* text = _utf8_test_text_long();
+    str_move_to(&text, "\n\t;=", 1);
+    *((volatile int64 *) val) += (int64) (uintptr_t) text;
+}
+
+static void test_utf8_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_utf8_is_valid_simd, _utf8_is_valid_scalar, -50.0);
+    COMPARE_FUNCTION_TEST_TIME(_utf8_to_utf32_simd, _utf8_to_utf32_scalar, -50.0);
+    COMPARE_FUNCTION_TEST_TIME(_str_move_to_delim_simd, _str_move_to_delim_scalar, -50.0);
+}
+#endif
+
 static void test_str_to_float()
 {
     TEST_EQUALS(str_to_float("1.000000"), 1.0f);
     TEST_EQUALS(str_to_float("+1.000000"), 1.0f);
     TEST_EQUALS(str_to_float("-1.000000"), -1.0f);
+    TEST_EQUALS(str_to_float("  .25"), 0.25f);
+    TEST_EQUALS(str_to_float("1.5e-3"), 1.5e-3f);
+    TEST_EQUALS(str_to_float("-2E+2"), -200.0f);
+    TEST_EQUALS(str_to_float("3.4028235e38"), 3.4028235e38f);
+    TEST_EQUALS(str_to_float("1.4e-45"), 1.4e-45f);
+    TEST_EQUALS(str_to_float("1e-46"), 0.0f);
+    TEST_TRUE(isinf(str_to_float("1e39")));
+
+    const char* pos;
+    str_to_float("12.5e ", &pos);
+    TEST_EQUALS(*pos, 'e');
+
+    str_to_float("0.123456789012 1", &pos);
+    TEST_EQUALS(*pos, ' ');
+
+    // Must be bit identical to the correctly rounded stdlib result
+    // Includes halfway cases, subnormals and mantissas with more than 19 digits
+    const char* tests[] = {
+        "0.1", "0.3", "16777217", "16777219", "1.00000005960464477539",
+        "1.0000000596046447753906250000000001", "3.1415926535897932384626",
+        "1.17549435e-38", "1.1754942e-38", "7.0064923e-46", "0.000000000000000000000000000000000000000000001",
+        "123456789012345678901234567890", "9007199254740993", "340282356779733661637539395458142568448",
+        "0.00000000000000000000000000000000000001175494280757364291727882991035766513322858992758990427682963118425003064965173038558",
+    };
+
+    bool is_valid = true;
+    for (int32 i = 0; i < (int32) ARRAY_COUNT(tests); ++i) {
+        const f32 expected = strtof(tests[i], NULL);
+        const f32 result = str_to_float(tests[i]);
+        is_valid &= memcmp(&expected, &result, sizeof(f32)) == 0;
+    }
+
+    TEST_TRUE(is_valid);
+
+    // Random bit patterns printed with different precisions
+    char buffer[64];
+    srand(0);
+
+    is_valid = true;
+    for (int32 i = 0; i < 10000; ++i) {
+        const uint32 bits = ((uint32) rand() << 16) ^ (uint32) rand();
+
+        f32 value;
+        memcpy(&value, &bits, sizeof(value));
+        if (isnan(value) || isinf(value)) {
+            continue;
+        }
+
+        snprintf(buffer, sizeof(buffer), "%.*g", 1 + i % 12, value);
+
+        const f32 expected = strtof(buffer, NULL);
+        const f32 result = str_to_float(buffer);
+        is_valid &= memcmp(&expected, &result, sizeof(f32)) == 0;
+    }
+
+    TEST_TRUE(is_valid);
+}
+
+static void test_str_to_int()
+{
+    TEST_EQUALS(str_to_int("0"), 0);
+    TEST_EQUALS(str_to_int("-7"), -7);
+    TEST_EQUALS(str_to_int("12345678"), 12345678);
+    TEST_EQUALS(str_to_int("-1234567890123"), -1234567890123LL);
+    TEST_EQUALS(str_to_int("9223372036854775807"), 9223372036854775807LL);
+
+    const char* pos;
+    TEST_EQUALS(str_to_int("123456789/2/3", &pos), 123456789);
+    TEST_EQUALS(*pos, '/');
+}
+
+static void test_float_to_str_shortest()
+{
+    char buffer[32];
+
+    float_to_str_shortest(0.1f, buffer);
+    TEST_EQUALS(strcmp(buffer, "0.1"), 0);
+
+    float_to_str_shortest(-2.5f, buffer);
+    TEST_EQUALS(strcmp(buffer, "-2.5"), 0);
+
+    float_to_str_shortest(100.0f, buffer);
+    TEST_EQUALS(strcmp(buffer, "100"), 0);
+
+    float_to_str_shortest(1.5e-7f, buffer);
+    TEST_EQUALS(strcmp(buffer, "1.5e-7"), 0);
+
+    float_to_str_shortest(3.4028235e38f, buffer);
+    TEST_EQUALS(strcmp(buffer, "3.4028235e38"), 0);
+
+    // Every float must survive the text round trip
+    srand(1);
+
+    bool is_valid = true;
+    for (int32 i = 0; i < 10000; ++i) {
+        // Include subnormals
+        const uint32 bits = (i & 1)
+            ? ((uint32) rand() << 16) ^ (uint32) rand()
+            : (uint32) rand() & 0x7FFFFF;
+
+        f32 value;
+        memcpy(&value, &bits, sizeof(value));
+        if (isnan(value) || isinf(value)) {
+            continue;
+        }
+
+        float_to_str_shortest(value, buffer);
+
+        const f32 result = str_to_float(buffer);
+        is_valid &= memcmp(&value, &result, sizeof(f32)) == 0;
+    }
+
+    TEST_TRUE(is_valid);
+}
+
+// Significant digits without leading and trailing zeros (e.g. 0.0120 -> 2)
+static int32 float_test_significant_digits(const char* str)
+{
+    int32 count = 0;
+    int32 zeros = 0;
+    for (; *str && *str != 'e'; ++str) {
+        if (*str < '0' || *str > '9' || (*str == '0' && count == 0)) {
+            continue;
+        }
+
+        ++count;
+        zeros = *str == '0' ? zeros + 1 : 0;
+    }
+
+    return count - zeros;
+}
+
+// The output must not be longer than the shortest correctly rounded printf output that round trips
+static void test_float_to_str_shortest_digit_count()
+{
+    char buffer[32];
+
+    // Rounding the 9 digit value 10.4770575 again would round up twice
+    float_to_str_shortest(10.477057456970215f, buffer);
+    TEST_EQUALS(strcmp(buffer, "10.477057"), 0);
+
+    srand(2);
+
+    bool is_shortest = true;
+    for (int32 i = 0; i < 10000; ++i) {
+        const uint32 bits = ((uint32) rand() << 16) ^ (uint32) rand();
+
+        f32 value;
+        memcpy(&value, &bits, sizeof(value));
+        if (isnan(value) || isinf(value) || value == 0.0f) {
+            continue;
+        }
+
+        int32 expected = 1;
+        char reference[32];
+        for (; expected < 9; ++expected) {
+            snprintf(reference, sizeof(reference), "%.*g", expected, (f64) value);
+            if (strtof(reference, NULL) == value) {
+                break;
+            }
+        }
+
+        float_to_str_shortest(value, buffer);
+        is_shortest &= float_test_significant_digits(buffer) <= expected;
+    }
+
+    TEST_TRUE(is_shortest);
+}
+
+#if PERFORMANCE_TEST
+// Similar to the vertex lines of a mesh text file
+static char* _float_test_text() {
+    static char text[16 * 1024];
+    if (!text[0]) {
+        srand(0);
+
+        char* pos = text;
+        while (pos - text < (int64) sizeof(text) - 32) {
+            pos += sprintf(pos, "%f ", ((f32) rand() / (f32) RAND_MAX - 0.5f) * 200.0f);
+        }
+    }
+
+    return text;
 }
 
+static void _str_to_float(volatile void* val) {
+    const char* pos = _float_test_text();
+
+    f32 sum = 0.0f;
+    while (*pos) {
+        sum += str_to_float(pos, &pos);
+        ++pos;
+    }
+
+    *((volatile f32 *) val) += sum;
+}
+
+static void _strtof(volatile void* val) {
+    const char* pos = _float_test_text();
+
+    f32 sum = 0.0f;
+    while (*pos) {
+        char* end;
+        sum += strtof(pos, &end);
+        pos = end + 1;
+    }
+
+    *((volatile f32 *) val) += sum;
+}
+
+static void _str_to_int(volatile void* val) {
+    const char* pos = "123456789012 4294967295 1234 99999999 7 18446744 123456789";
+
+    int64 sum = 0;
+    while (*pos) {
+        sum += str_to_int(pos, &pos);
+        if (*pos) {
+            ++pos;
+        }
+    }
+
+    *((volatile int64 *) val) += sum;
+}
+
+static void _strtoll(volatile void* val) {
+    const char* pos = "123456789012 4294967295 1234 99999999 7 18446744 123456789";
+
+    int64 sum = 0;
+    while (*pos) {
+        char* end;
+        sum += strtoll(pos, &end, 10);
+        pos = *end ? end + 1 : end;
+    }
+
+    *((volatile int64 *) val) += sum;
+}
+
+static void test_str_to_number_performance() {
+    COMPARE_FUNCTION_TEST_TIME(_str_to_float, _strtof, -50.0);
+    COMPARE_FUNCTION_TEST_TIME(_str_to_int, _strtoll, -30.0);
+}
+#endif
+
 #ifdef UBER_TEST
     #ifdef main
         #undef main
@@ -281,6 +738,8 @@ int main() {
     TEST_RUN(test_utf8_encode);
     TEST_RUN(test_utf8_decode);
     TEST_RUN(test_utf8_strlen);
+    TEST_RUN(test_utf8_is_valid);
+    TEST_RUN(test_utf8_to_utf32);
     TEST_RUN(test_str_is_float);
     TEST_RUN(test_str_is_integer);
     TEST_RUN(test_sprintf_fast);
@@ -288,8 +747,12 @@ int main() {
     TEST_RUN(test_str_is_num);
     TEST_RUN(test_str_is_alphanum);
     TEST_RUN(test_str_to_float);
+    TEST_RUN(test_str_to_int);
+    TEST_RUN(test_float_to_str_shortest);
+    TEST_RUN(test_float_to_str_shortest_digit_count);
     TEST_RUN(test_str_move_past);
     TEST_RUN(test_str_move_to);
+    TEST_RUN(test_str_move_to_delim);
     TEST_RUN(test_str_move_to_pos);
     TEST_RUN(test_strlen);
     TEST_RUN(test_str_contains);
@@ -306,6 +769,8 @@ int main() {
         TEST_RUN(test_str_length_performance);
         TEST_RUN(test_str_is_alphanum_performance);
         TEST_RUN(test_sprintf_fast_performance);
+        TEST_RUN(test_utf8_performance);
+        TEST_RUN(test_str_to_number_performance);
     #endif
 
     TEST_FINALIZE();
@@ -430,7 +430,7 @@ bool thread_pool_join(const PoolWorker* const jobs, int32 count, uint64 sleep_ti
             }
 
             if (!jobs[i].id
-                || atomic_get_relaxed((int32 *) jobs[i].state) == POOL_WORKER_STATE_COMPLETED
+                || atomic_get_relaxed((int32 *) &jobs[i].state) == POOL_WORKER_STATE_COMPLETED
             ) {
                 completed_mask |= bit;
             }
@@ -473,7 +473,7 @@ bool thread_pool_join(
             }
 
             if (!jobs[i] || !jobs[i]->id
-                || atomic_get_relaxed((int32 *) jobs[i]->state) == POOL_WORKER_STATE_COMPLETED
+                || atomic_get_relaxed((int32 *) &jobs[i]->state) == POOL_WORKER_STATE_COMPLETED
             ) {
                 completed_mask |= bit;
             }
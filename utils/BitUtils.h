@@ -108,6 +108,148 @@ void bits_flush(BitWalk* stream) NO_EXCEPT
     }
 }
 
+// Bit packing of runtime data (e.g. network packets)
+// The bits are written R2L into a 64 bit scratch value which gets stored in little endian 32 bit blocks
+// If the buffer is too small the writer/reader stops and sets overflow
+struct BitWriter {
+    byte* start;
+    byte* pos;
+    byte* end;
+
+    uint64 scratch;
+    int32 scratch_bits;
+
+    bool overflow;
+};
+
+inline
+void bits_writer_init(BitWriter* writer, byte* buffer, int32 size) NO_EXCEPT
+{
+    writer->start = buffer;
+    writer->pos = buffer;
+    writer->end = buffer + size;
+    writer->scratch = 0;
+    writer->scratch_bits = 0;
+    writer->overflow = false;
+}
+
+// WARNING: bits must be <= 32
+inline
+void bits_write(BitWriter* writer, uint32 value, int32 bits) NO_EXCEPT
+{
+    ASSERT_TRUE(bits <= 32);
+
+    writer->scratch |= ((uint64) value & ((1ULL << bits) - 1)) << writer->scratch_bits;
+    writer->scratch_bits += bits;
+
+    if (writer->scratch_bits < 32) {
+        return;
+    }
+
+    if (writer->pos + sizeof(uint32) > writer->end) {
+        writer->overflow = true;
+        writer->scratch_bits -= 32;
+        writer->scratch >>= 32;
+
+        return;
+    }
+
+    uint32 block = SWAP_ENDIAN_LITTLE((uint32) writer->scratch);
+    memcpy(writer->pos, &block, sizeof(block));
+    writer->pos += sizeof(uint32);
+
+    writer->scratch >>= 32;
+    writer->scratch_bits -= 32;
+}
+
+FORCE_INLINE
+void bits_write_bool(BitWriter* writer, bool value) NO_EXCEPT
+{
+    bits_write(writer, (uint32) value, 1);
+}
+
+// Writes the remaining bits, returns the total amount of bytes written
+inline
+int32 bits_write_flush(BitWriter* writer) NO_EXCEPT
+{
+    while (writer->scratch_bits > 0) {
+        if (writer->pos >= writer->end) {
+            writer->overflow = true;
+            break;
+        }
+
+        *writer->pos++ = (byte) writer->scratch;
+        writer->scratch >>= 8;
+        writer->scratch_bits -= 8;
+    }
+
+    writer->scratch = 0;
+    writer->scratch_bits = 0;
+
+    return (int32) (writer->pos - writer->start);
+}
+
+struct BitReader {
+    const byte* pos;
+    const byte* end;
+
+    uint64 scratch;
+    int32 scratch_bits;
+
+    bool overflow;
+};
+
+inline
+void bits_reader_init(BitReader* reader, const byte* buffer, int32 size) NO_EXCEPT
+{
+    reader->pos = buffer;
+    reader->end = buffer + size;
+    reader->scratch = 0;
+    reader->scratch_bits = 0;
+    reader->overflow = false;
+}
+
+// WARNING: bits must be <= 32
+inline
+uint32 bits_read(BitReader* reader, int32 bits) NO_EXCEPT
+{
+    ASSERT_TRUE(bits <= 32);
+
+    if (reader->scratch_bits < bits) {
+        if (reader->pos + sizeof(uint32) <= reader->end) {
+            uint32 block;
+            memcpy(&block, reader->pos, sizeof(block));
+            reader->pos += sizeof(uint32);
+
+            reader->scratch |= (uint64) SWAP_ENDIAN_LITTLE(block) << reader->scratch_bits;
+            reader->scratch_bits += 32;
+        } else {
+            // The tail of the buffer is not a full block
+            while (reader->pos < reader->end && reader->scratch_bits <= 56) {
+                reader->scratch |= (uint64) *reader->pos++ << reader->scratch_bits;
+                reader->scratch_bits += 8;
+            }
+
+            if (reader->scratch_bits < bits) {
+                reader->overflow = true;
+                reader->scratch_bits = bits;
+            }
+        }
+    }
+
+    const uint32 value = (uint32) (reader->scratch & ((1ULL << bits) - 1));
+    reader->scratch >>= bits;
+    reader->scratch_bits -= bits;
+
+    return value;
+}
+
+FORCE_INLINE
+bool bits_read_bool(BitReader* reader) NO_EXCEPT
+{
+    return bits_read(reader, 1) != 0;
+}
+
 // inline
 // uint8 bits_consume_8(BitWalk* stream, uint32 bits_to_consume)
 // {
@@ -11,376 +11,794 @@
 #define COMS_UTILS_REGEX_SIMPLIFIED_H
 
 #include "../stdlib/Stdlib.h"
+#include "../system/Allocator.h"
+#include "../hash/GeneralHash.h"
 #include "StringUtils.h"
 
-struct SimplifiedRegexParser {
-    const char *pattern;
+// Simplified regex, the pattern is compiled to a DFA -> matching is a single table lookup per character
+//
+// Supported:
+//      abc         literals (whitespaces in the pattern are ignored, use "\ " to match a whitespace)
+//      .           any character
+//      \d \w \s    digit, word character, whitespace
+//      \x          escaped character
+//      a-z         character range (both sides must be alphanumeric)
+//      [a-z_.]     character class, [^...] negated character class
+//      ( ) |       group, alternative
+//      * + ?       quantifiers
+//      {n} {n,} {n,m}
+//      ^ $         anchors, without anchors the pattern may match anywhere in the text
+//
+// Patterns that need more than REGEX_MAX_DFA_STATES states or REGEX_MAX_BYTE_CLASSES byte classes fail to compile
+
+#define REGEX_MAX_NFA_STATES 256
+#define REGEX_MAX_DFA_STATES 128
+#define REGEX_MAX_BYTE_CLASSES 32
+
+// The dead state, once reached the text can't match anymore
+#define REGEX_DFA_DEAD 0
+
+enum RegexNfaStateType : byte {
+    REGEX_NFA_CHAR,
+    REGEX_NFA_SPLIT,
+    REGEX_NFA_EPSILON,
+    REGEX_NFA_MATCH,
+};
+
+struct RegexNfaState {
+    RegexNfaStateType type;
+    int16 out;
+    int16 out1;
+
+    // Only used by REGEX_NFA_CHAR
+    uint64 chars[4];
+};
+
+// Fragment of the nfa, the end state has a single unconnected out
+struct RegexNfaFragment {
+    int16 start;
+    int16 end;
+};
+
+struct RegexCompiler {
+    const char* pattern;
     int32 pos;
+
+    RegexNfaState states[REGEX_MAX_NFA_STATES];
+    int32 state_count;
+
+    bool error;
 };
 
-struct MatchResult {
-    bool matched;
-    int32 length;
+struct RegexDfa {
+    // Maps every byte to its equivalence class (bytes that behave the same in every state)
+    byte byte_class[256];
+
+    byte transitions[REGEX_MAX_DFA_STATES * REGEX_MAX_BYTE_CLASSES];
+    uint64 accepting[REGEX_MAX_DFA_STATES / 64];
+
+    int32 state_count;
+    int32 class_count;
+    byte start;
 };
 
-static
-void regex_skip_whitespace(SimplifiedRegexParser *parser) {
-    while (parser->pattern[parser->pos] == ' ') {
-        parser->pos++;
-    }
+FORCE_INLINE
+void regex_chars_set(uint64* chars, byte c) NO_EXCEPT
+{
+    chars[c / 64] |= 1ULL << (c & 63);
 }
 
-MatchResult regex_match_char(SimplifiedRegexParser *parser, const char *text) {
-    regex_skip_whitespace(parser);
-    MatchResult result = {false, 0};
+FORCE_INLINE
+bool regex_chars_has(const uint64* chars, byte c) NO_EXCEPT
+{
+    return chars[c / 64] & (1ULL << (c & 63));
+}
 
-    if (parser->pattern[parser->pos] == '\0' || *text == '\0') {
-        return result;
+static inline
+void regex_chars_set_range(uint64* chars, byte from, byte to) NO_EXCEPT
+{
+    for (int32 c = from; c <= to; ++c) {
+        regex_chars_set(chars, (byte) c);
     }
+}
 
-    if (parser->pattern[parser->pos] == '\\') {
-        // Handle escape sequences
-        parser->pos++;
-        if (parser->pattern[parser->pos] == 'd') {
-            if (str_is_num(*text)) {
-                result.matched = true;
-                result.length = 1;
-                parser->pos++;
-            }
-        } else if (parser->pattern[parser->pos] == *text) {
-            result.matched = true;
-            result.length = 1;
-            parser->pos++;
-        }
-    } else if (parser->pattern[parser->pos] == '.') {
-        // Match any character
-        result.matched = true;
-        result.length = 1;
-        parser->pos++;
-    } else if (parser->pattern[parser->pos] == *text) {
-        // Match literal character
-        result.matched = true;
-        result.length = 1;
-        parser->pos++;
-    } else if (parser->pattern[parser->pos] == 'a' &&
-               parser->pattern[parser->pos+1] == '-' &&
-               parser->pattern[parser->pos+2] == 'z') {
-        // Match a-z range
-        if (*text >= 'a' && *text <= 'z') {
-            result.matched = true;
-            result.length = 1;
-            parser->pos += 3;
-        }
-    } else if (parser->pattern[parser->pos] == 'A' &&
-               parser->pattern[parser->pos+1] == '-' &&
-               parser->pattern[parser->pos+2] == 'Z') {
-        // Match A-Z range
-        if (*text >= 'A' && *text <= 'Z') {
-            result.matched = true;
-            result.length = 1;
-            parser->pos += 3;
-        }
-    } else if (parser->pattern[parser->pos] == '0' &&
-               parser->pattern[parser->pos+1] == '-' &&
-               parser->pattern[parser->pos+2] == '9') {
-        // Match 0-9 range
-        if (str_is_num(*text)) {
-            result.matched = true;
-            result.length = 1;
-            parser->pos += 3;
-        }
+static inline
+int16 regex_nfa_state(RegexCompiler* compiler, RegexNfaStateType type, int16 out = -1, int16 out1 = -1) NO_EXCEPT
+{
+    if (compiler->state_count >= REGEX_MAX_NFA_STATES) {
+        compiler->error = true;
+
+        // Continue with a dummy state, the result is discarded anyway
+        return 0;
     }
 
-    return result;
+    RegexNfaState* state = &compiler->states[compiler->state_count];
+    memset(state, 0, sizeof(RegexNfaState));
+    state->type = type;
+    state->out = out;
+    state->out1 = out1;
+
+    return (int16) compiler->state_count++;
+}
+
+FORCE_INLINE
+void regex_nfa_patch(RegexCompiler* compiler, int16 end, int16 target) NO_EXCEPT
+{
+    compiler->states[end].out = target;
+}
+
+static inline
+RegexNfaFragment regex_nfa_empty(RegexCompiler* compiler) NO_EXCEPT
+{
+    const int16 state = regex_nfa_state(compiler, REGEX_NFA_EPSILON);
+
+    return {state, state};
+}
+
+static inline
+RegexNfaFragment regex_nfa_concat(RegexCompiler* compiler, RegexNfaFragment a, RegexNfaFragment b) NO_EXCEPT
+{
+    regex_nfa_patch(compiler, a.end, b.start);
+
+    return {a.start, b.end};
+}
+
+static inline
+RegexNfaFragment regex_nfa_alternative(RegexCompiler* compiler, RegexNfaFragment a, RegexNfaFragment b) NO_EXCEPT
+{
+    const int16 split = regex_nfa_state(compiler, REGEX_NFA_SPLIT, a.start, b.start);
+    const int16 end = regex_nfa_state(compiler, REGEX_NFA_EPSILON);
+    regex_nfa_patch(compiler, a.end, end);
+    regex_nfa_patch(compiler, b.end, end);
+
+    return {split, end};
+}
+
+// a*
+static inline
+RegexNfaFragment regex_nfa_star(RegexCompiler* compiler, RegexNfaFragment a) NO_EXCEPT
+{
+    const int16 end = regex_nfa_state(compiler, REGEX_NFA_EPSILON);
+    const int16 split = regex_nfa_state(compiler, REGEX_NFA_SPLIT, a.start, end);
+    regex_nfa_patch(compiler, a.end, split);
+
+    return {split, end};
+}
+
+// a+
+static inline
+RegexNfaFragment regex_nfa_plus(RegexCompiler* compiler, RegexNfaFragment a) NO_EXCEPT
+{
+    const int16 end = regex_nfa_state(compiler, REGEX_NFA_EPSILON);
+    const int16 split = regex_nfa_state(compiler, REGEX_NFA_SPLIT, a.start, end);
+    regex_nfa_patch(compiler, a.end, split);
+
+    return {a.start, end};
+}
+
+// a?
+static inline
+RegexNfaFragment regex_nfa_optional(RegexCompiler* compiler, RegexNfaFragment a) NO_EXCEPT
+{
+    const int16 end = regex_nfa_state(compiler, REGEX_NFA_EPSILON);
+    const int16 split = regex_nfa_state(compiler, REGEX_NFA_SPLIT, a.start, end);
+    regex_nfa_patch(compiler, a.end, end);
+
+    return {split, end};
+}
+
+static inline
+void regex_skip_whitespace(RegexCompiler* compiler) NO_EXCEPT
+{
+    while (compiler->pattern[compiler->pos] == ' ') {
+        ++compiler->pos;
+    }
 }
 
-int regex_parse_number(SimplifiedRegexParser *parser) {
+static inline
+int32 regex_parse_number(RegexCompiler* compiler) NO_EXCEPT
+{
+    if (!isdigit(compiler->pattern[compiler->pos])) {
+        compiler->error = true;
+
+        return 0;
+    }
+
     int32 num = 0;
-    while (str_is_num(parser->pattern[parser->pos])) {
-        num = num * 10 + (parser->pattern[parser->pos] - '0');
-        parser->pos++;
+    while (isdigit(compiler->pattern[compiler->pos]) && num < 1000) {
+        num = num * 10 + (compiler->pattern[compiler->pos] - '0');
+        ++compiler->pos;
     }
+
     return num;
 }
 
-MatchResult regex_match_pattern(SimplifiedRegexParser *parser, const char *text);
-MatchResult regex_match_atom(SimplifiedRegexParser *parser, const char *text) {
-    regex_skip_whitespace(parser);
-    MatchResult result = {false, 0};
-
-    if (parser->pattern[parser->pos] == '(') {
-        // Handle group
-        int32 saved_pos = parser->pos;
-        parser->pos++;
-        result = regex_match_pattern(parser, text);
-        if (parser->pattern[parser->pos] == ')') {
-            parser->pos++;
+// Handles \d, \w, \s and escaped characters
+static
+void regex_parse_escape(RegexCompiler* compiler, uint64* chars) NO_EXCEPT
+{
+    const char c = compiler->pattern[compiler->pos];
+    if (c == '\0') {
+        compiler->error = true;
+
+        return;
+    }
+
+    ++compiler->pos;
+
+    switch (c) {
+        case 'd':
+            regex_chars_set_range(chars, '0', '9');
+            break;
+        case 'w':
+            regex_chars_set_range(chars, 'a', 'z');
+            regex_chars_set_range(chars, 'A', 'Z');
+            regex_chars_set_range(chars, '0', '9');
+            regex_chars_set(chars, '_');
+            break;
+        case 's':
+            regex_chars_set(chars, ' ');
+            regex_chars_set_range(chars, '\t', '\r');
+            break;
+        default:
+            regex_chars_set(chars, (byte) c);
+    }
+}
+
+// [abc], [a-z0-9_], [^/]
+static
+void regex_parse_class(RegexCompiler* compiler, uint64* chars) NO_EXCEPT
+{
+    const char* pattern = compiler->pattern;
+
+    bool negate = false;
+    if (pattern[compiler->pos] == '^') {
+        negate = true;
+        ++compiler->pos;
+    }
+
+    while (pattern[compiler->pos] != ']') {
+        const char c = pattern[compiler->pos];
+        if (c == '\0') {
+            compiler->error = true;
+
+            return;
+        }
+
+        ++compiler->pos;
+
+        if (c == '\\') {
+            regex_parse_escape(compiler, chars);
+        } else if (pattern[compiler->pos] == '-'
+            && pattern[compiler->pos + 1] != ']'
+            && pattern[compiler->pos + 1] != '\0'
+        ) {
+            const byte to = (byte) pattern[compiler->pos + 1];
+            if (to < (byte) c) {
+                compiler->error = true;
+
+                return;
+            }
+
+            regex_chars_set_range(chars, (byte) c, to);
+            compiler->pos += 2;
         } else {
-            // Group not properly closed, backtrack
-            parser->pos = saved_pos;
-            result = regex_match_char(parser, text);
+            regex_chars_set(chars, (byte) c);
         }
-    } else {
-        // Handle single character
-        result = regex_match_char(parser, text);
     }
 
-    return result;
+    ++compiler->pos; // Skip ']'
+
+    if (negate) {
+        for (int32 i = 0; i < 4; ++i) {
+            chars[i] = ~chars[i];
+        }
+
+        // '\0' terminates the text and can never match
+        chars[0] &= ~1ULL;
+    }
 }
 
-MatchResult regex_match_repetition(SimplifiedRegexParser *parser, const char *text, MatchResult atom_result) {
-    MatchResult result = {false, 0};
+static RegexNfaFragment regex_parse_alternative(RegexCompiler* compiler) NO_EXCEPT;
 
-    parser->pos++; // Skip '{'
-    regex_skip_whitespace(parser);
+static
+RegexNfaFragment regex_parse_atom(RegexCompiler* compiler) NO_EXCEPT
+{
+    regex_skip_whitespace(compiler);
 
-    int32 min = regex_parse_number(parser);
-    regex_skip_whitespace(parser);
+    const char* pattern = compiler->pattern;
+    const char c = pattern[compiler->pos];
 
-    int32 max = min;
-    if (parser->pattern[parser->pos] == ',') {
-        parser->pos++;
-        regex_skip_whitespace(parser);
-        if (parser->pattern[parser->pos] == '}') {
-            // {x,} means x or more (no max)
-            max = -1;
-        } else {
-            max = regex_parse_number(parser);
+    if (c == '(') {
+        ++compiler->pos;
+        RegexNfaFragment group = regex_parse_alternative(compiler);
+
+        regex_skip_whitespace(compiler);
+        if (pattern[compiler->pos] != ')') {
+            compiler->error = true;
+
+            return group;
         }
+
+        ++compiler->pos;
+
+        return group;
     }
 
-    regex_skip_whitespace(parser);
-    if (parser->pattern[parser->pos] != '}') {
-        // Invalid repetition syntax
-        return result;
+    if (c == '\0' || c == ')' || c == '|' || c == '*' || c == '+' || c == '?' || c == '{') {
+        compiler->error = true;
+
+        return regex_nfa_empty(compiler);
     }
-    parser->pos++; // Skip '}'
 
-    if (min < 0 || (max != -1 && max < min)) {
-        // Invalid range
-        return result;
+    const int16 state = regex_nfa_state(compiler, REGEX_NFA_CHAR);
+    uint64* chars = compiler->states[state].chars;
+
+    ++compiler->pos;
+
+    if (c == '\\') {
+        regex_parse_escape(compiler, chars);
+    } else if (c == '[') {
+        regex_parse_class(compiler, chars);
+    } else if (c == '.') {
+        regex_chars_set_range(chars, 1, 255);
+    } else if (isalnum(c)
+        && pattern[compiler->pos] == '-'
+        && isalnum(pattern[compiler->pos + 1])
+        && pattern[compiler->pos + 1] >= c
+    ) {
+        // a-z
+        regex_chars_set_range(chars, (byte) c, (byte) pattern[compiler->pos + 1]);
+        compiler->pos += 2;
+    } else {
+        regex_chars_set(chars, (byte) c);
     }
 
-    // Try to match exactly min times first
-    int32 count = 0;
-    int32 total_length = 0;
-    const char *current_text = text;
+    return {state, state};
+}
 
-    while (true) {
-        if (max != -1 && count >= max) break;
+// {n}, {n,}, {n,m}
+// The atom is parsed again for every copy, this way every copy gets its own nfa states
+static
+RegexNfaFragment regex_parse_repetition(RegexCompiler* compiler, int32 atom_pos) NO_EXCEPT
+{
+    ++compiler->pos; // Skip '{'
+    regex_skip_whitespace(compiler);
 
-        MatchResult next_result = regex_match_atom(parser, current_text);
-        if (!next_result.matched) break;
+    const int32 min = regex_parse_number(compiler);
+    int32 max = min;
 
-        count++;
-        total_length += next_result.length;
-        current_text += next_result.length;
+    regex_skip_whitespace(compiler);
+    if (compiler->pattern[compiler->pos] == ',') {
+        ++compiler->pos;
+        regex_skip_whitespace(compiler);
+
+        // -1 = no max
+        max = compiler->pattern[compiler->pos] == '}' ? -1 : regex_parse_number(compiler);
     }
 
-    if (count >= min && (max == -1 || count <= max)) {
-        result.matched = true;
-        result.length = total_length;
+    regex_skip_whitespace(compiler);
+    if (compiler->pattern[compiler->pos] != '}' || (max != -1 && max < min)) {
+        compiler->error = true;
+
+        return regex_nfa_empty(compiler);
     }
 
-    return result;
-}
+    const int32 end_pos = compiler->pos + 1;
+    RegexNfaFragment result = regex_nfa_empty(compiler);
 
-MatchResult regex_match_element(SimplifiedRegexParser *parser, const char *text) {
-    MatchResult atom_result = regex_match_atom(parser, text);
+    for (int32 i = 0; i < min && !compiler->error; ++i) {
+        compiler->pos = atom_pos;
+        result = regex_nfa_concat(compiler, result, regex_parse_atom(compiler));
+    }
 
-    if (!atom_result.matched) {
-        return atom_result;
+    if (max == -1) {
+        compiler->pos = atom_pos;
+        result = regex_nfa_concat(compiler, result, regex_nfa_star(compiler, regex_parse_atom(compiler)));
+    } else {
+        for (int32 i = min; i < max && !compiler->error; ++i) {
+            compiler->pos = atom_pos;
+            result = regex_nfa_concat(compiler, result, regex_nfa_optional(compiler, regex_parse_atom(compiler)));
+        }
     }
 
-    regex_skip_whitespace(parser);
-    char quantifier = parser->pattern[parser->pos];
+    compiler->pos = end_pos;
 
-    if (quantifier == '*') {
-        // Zero or more
-        parser->pos++;
-        int32 consumed = atom_result.length;
-        const char *remaining_text = text + consumed;
-        MatchResult star_result = {true, consumed};
+    return result;
+}
 
-        while (true) {
-            MatchResult next_result = regex_match_atom(parser, remaining_text);
-            if (!next_result.matched) break;
-            consumed += next_result.length;
-            remaining_text += next_result.length;
-            star_result.length = consumed;
+static
+RegexNfaFragment regex_parse_element(RegexCompiler* compiler) NO_EXCEPT
+{
+    regex_skip_whitespace(compiler);
+
+    const int32 atom_pos = compiler->pos;
+    RegexNfaFragment atom = regex_parse_atom(compiler);
+
+    while (!compiler->error) {
+        regex_skip_whitespace(compiler);
+
+        switch (compiler->pattern[compiler->pos]) {
+            case '*':
+                ++compiler->pos;
+                atom = regex_nfa_star(compiler, atom);
+                break;
+            case '+':
+                ++compiler->pos;
+                atom = regex_nfa_plus(compiler, atom);
+                break;
+            case '?':
+                ++compiler->pos;
+                atom = regex_nfa_optional(compiler, atom);
+                break;
+            case '{':
+                // The already parsed atom is simply not used
+                atom = regex_parse_repetition(compiler, atom_pos);
+                break;
+            default:
+                return atom;
         }
+    }
+
+    return atom;
+}
 
-        return star_result;
-    } else if (quantifier == '+') {
-        // One or more
-        parser->pos++;
-        int32 consumed = atom_result.length;
-        const char *remaining_text = text + consumed;
-        MatchResult plus_result = {true, consumed};
-
-        while (true) {
-            MatchResult next_result = regex_match_atom(parser, remaining_text);
-            if (!next_result.matched) break;
-            consumed += next_result.length;
-            remaining_text += next_result.length;
-            plus_result.length = consumed;
+static
+RegexNfaFragment regex_parse_sequence(RegexCompiler* compiler) NO_EXCEPT
+{
+    RegexNfaFragment sequence = regex_nfa_empty(compiler);
+
+    while (!compiler->error) {
+        regex_skip_whitespace(compiler);
+
+        const char c = compiler->pattern[compiler->pos];
+        if (c == '\0' || c == '|' || c == ')'
+            || (c == '$' && compiler->pattern[compiler->pos + 1] == '\0')
+        ) {
+            break;
         }
 
-        return plus_result;
-    } else if (quantifier == '?') {
-        // Zero or one
-        parser->pos++;
-        return atom_result;
-    } else if (quantifier == '{') {
-        // Min/max repetition {x,y}
-        return regex_match_repetition(parser, text, atom_result);
-    } else {
-        // No quantifier
-        return atom_result;
+        sequence = regex_nfa_concat(compiler, sequence, regex_parse_element(compiler));
     }
+
+    return sequence;
 }
 
-MatchResult regex_match_pattern(SimplifiedRegexParser *parser, const char *text) {
-    MatchResult result = regex_match_element(parser, text);
+static
+RegexNfaFragment regex_parse_alternative(RegexCompiler* compiler) NO_EXCEPT
+{
+    RegexNfaFragment result = regex_parse_sequence(compiler);
 
-    regex_skip_whitespace(parser);
-    if (parser->pattern[parser->pos] == '|') {
-        parser->pos++;
-        MatchResult alternative = regex_match_pattern(parser, text);
-        if (alternative.matched) {
-            return alternative;
-        }
+    while (!compiler->error && compiler->pattern[compiler->pos] == '|') {
+        ++compiler->pos;
+        result = regex_nfa_alternative(compiler, result, regex_parse_sequence(compiler));
     }
 
     return result;
 }
 
-bool regex_simplified_validate(const char* pattern, const char* text) {
-    SimplifiedRegexParser parser = {pattern, 0};
-    bool starts_with = false;
-    bool ends_with = false;
+// Adds a state and all states reachable through epsilon transitions
+static
+void regex_nfa_closure(const RegexCompiler* compiler, int16 state, uint64* set) NO_EXCEPT
+{
+    int16 stack[REGEX_MAX_NFA_STATES];
+    int32 top = 0;
+    stack[top++] = state;
+
+    while (top > 0) {
+        const int16 s = stack[--top];
+        if (s < 0 || (set[s / 64] & (1ULL << (s & 63)))) {
+            continue;
+        }
+
+        set[s / 64] |= 1ULL << (s & 63);
 
-    // Check for ^ and $ anchors
-    if (parser.pattern[parser.pos] == '^') {
-        starts_with = true;
-        parser.pos++;
+        const RegexNfaState* nfa_state = &compiler->states[s];
+        if (nfa_state->type == REGEX_NFA_SPLIT) {
+            stack[top++] = nfa_state->out;
+            stack[top++] = nfa_state->out1;
+        } else if (nfa_state->type == REGEX_NFA_EPSILON) {
+            stack[top++] = nfa_state->out;
+        }
     }
+}
 
-    MatchResult result = regex_match_pattern(&parser, text);
+/**
+ * Compiles a pattern
+ *
+ * @param dfa       Compiled pattern
+ * @param pattern   Pattern
+ *
+ * @return false if the pattern is invalid or too complex
+ */
+bool regex_compile(RegexDfa* dfa, const char* pattern) NO_EXCEPT
+{
+    // ~8 KB, the compiler is only needed during the compilation
+    RegexCompiler compiler;
+    compiler.pattern = pattern;
+    compiler.pos = 0;
+    compiler.state_count = 0;
+    compiler.error = false;
+
+    dfa->state_count = 0;
+
+    bool anchored_start = false;
+    if (pattern[0] == '^') {
+        anchored_start = true;
+        compiler.pos = 1;
+    }
+
+    RegexNfaFragment fragment = regex_parse_alternative(&compiler);
 
-    if (parser.pattern[parser.pos] == '$') {
-        ends_with = true;
-        parser.pos++;
+    bool anchored_end = false;
+    if (pattern[compiler.pos] == '$') {
+        anchored_end = true;
+        ++compiler.pos;
     }
 
-    // Check if we consumed the entire pattern
-    if (parser.pattern[parser.pos] != '\0') {
+    if (compiler.error || pattern[compiler.pos] != '\0') {
         return false;
     }
 
-    // Check anchors
-    if (starts_with && ends_with) {
-        return result.matched && (result.length == strlen(text));
-    } else if (starts_with) {
-        return result.matched && (result.length > 0);
-    } else if (ends_with) {
-        return result.matched && (text[result.length] == '\0');
-    } else {
-        return result.matched;
+    const int16 match = regex_nfa_state(&compiler, REGEX_NFA_MATCH);
+    regex_nfa_patch(&compiler, fragment.end, match);
+
+    int16 nfa_start = fragment.start;
+    if (!anchored_start) {
+        // Unanchored = .* in front of the pattern
+        const int16 any = regex_nfa_state(&compiler, REGEX_NFA_CHAR);
+        regex_chars_set_range(compiler.states[any].chars, 1, 255);
+
+        nfa_start = regex_nfa_state(&compiler, REGEX_NFA_SPLIT, fragment.start, any);
+        regex_nfa_patch(&compiler, any, nfa_start);
+    }
+
+    if (compiler.error) {
+        return false;
+    }
+
+    // Byte classes, every character set splits the existing classes
+    memset(dfa->byte_class, 0, sizeof(dfa->byte_class));
+    int32 class_count = 1;
+
+    for (int32 i = 0; i < compiler.state_count; ++i) {
+        if (compiler.states[i].type != REGEX_NFA_CHAR) {
+            continue;
+        }
+
+        int16 remap[256][2];
+        memset(remap, -1, sizeof(remap));
+        int32 new_count = 0;
+
+        for (int32 c = 0; c < 256; ++c) {
+            const int32 in_set = regex_chars_has(compiler.states[i].chars, (byte) c);
+            int16* id = &remap[dfa->byte_class[c]][in_set];
+
+            if (*id < 0) {
+                *id = (int16) new_count++;
+            }
+
+            dfa->byte_class[c] = (byte) *id;
+        }
+
+        class_count = new_count;
+        if (class_count > REGEX_MAX_BYTE_CLASSES) {
+            return false;
+        }
+    }
+
+    dfa->class_count = class_count;
+
+    byte class_representative[REGEX_MAX_BYTE_CLASSES];
+    for (int32 c = 255; c >= 0; --c) {
+        class_representative[dfa->byte_class[c]] = (byte) c;
+    }
+
+    // Subset construction, every dfa state is a set of nfa states
+    uint64 sets[REGEX_MAX_DFA_STATES][REGEX_MAX_NFA_STATES / 64];
+    memset(sets[REGEX_DFA_DEAD], 0, sizeof(sets[REGEX_DFA_DEAD]));
+    memset(dfa->accepting, 0, sizeof(dfa->accepting));
+
+    memset(sets[1], 0, sizeof(sets[1]));
+    regex_nfa_closure(&compiler, nfa_start, sets[1]);
+
+    dfa->start = 1;
+    int32 state_count = 2;
+
+    for (int32 state = 0; state < state_count; ++state) {
+        byte* row = &dfa->transitions[state * class_count];
+        const bool is_accepting = sets[state][match / 64] & (1ULL << (match & 63));
+
+        if (is_accepting) {
+            dfa->accepting[state / 64] |= 1ULL << (state & 63);
+
+            // Without $ the text matches once an accepting state is reached
+            // -> the accepting state never needs to be left and we don't need an early exit in the matching loop
+            if (!anchored_end) {
+                memset(row, state, class_count);
+
+                continue;
+            }
+        }
+
+        for (int32 k = 0; k < class_count; ++k) {
+            const byte c = class_representative[k];
+
+            uint64 next[REGEX_MAX_NFA_STATES / 64] = {};
+            for (int32 s = 0; s < compiler.state_count; ++s) {
+                if ((sets[state][s / 64] & (1ULL << (s & 63)))
+                    && compiler.states[s].type == REGEX_NFA_CHAR
+                    && regex_chars_has(compiler.states[s].chars, c)
+                ) {
+                    regex_nfa_closure(&compiler, compiler.states[s].out, next);
+                }
+            }
+
+            int32 target = 0;
+            while (target < state_count && memcmp(sets[target], next, sizeof(next)) != 0) {
+                ++target;
+            }
+
+            if (target == state_count) {
+                if (state_count >= REGEX_MAX_DFA_STATES) {
+                    return false;
+                }
+
+                memcpy(sets[state_count++], next, sizeof(next));
+            }
+
+            row[k] = (byte) target;
+        }
     }
+
+    dfa->state_count = state_count;
+
+    return true;
 }
 
-/*
-// Test function
-void test_regex(const char *pattern, const char *text, bool expected) {
-    bool result = regex_simplified_validate(pattern, text);
-    printf("Pattern: '%-10s'\tText: '%-6s'\tExpected: %-5s\tActual: %-5s\t%s\n",
-           pattern, text, expected ? "true" : "false", result ? "true" : "false",
-           (result == expected) ? "✓" : "✗");
+/**
+ * Checks if a text matches a compiled pattern
+ *
+ * The cost only depends on the text length (1 table lookup per character)
+ */
+inline
+bool regex_match(const RegexDfa* dfa, const char* text) NO_EXCEPT
+{
+    if (!dfa->state_count) {
+        return false;
+    }
+
+    const byte* transitions = dfa->transitions;
+    const byte* byte_class = dfa->byte_class;
+    const int32 class_count = dfa->class_count;
+
+    int32 state = dfa->start;
+    while (*text) {
+        state = transitions[state * class_count + byte_class[(byte) *text++]];
+    }
+
+    return dfa->accepting[state / 64] & (1ULL << (state & 63));
+}
+
+#define REGEX_CACHE_PATTERN_LENGTH 64
+
+struct RegexCacheEntry {
+    uint64 hash;
+    char pattern[REGEX_CACHE_PATTERN_LENGTH];
+    RegexDfa dfa;
+};
+
+// Compiled patterns by pattern string
+// The cache is not thread safe, use one cache per thread
+struct RegexCache {
+    RegexCacheEntry* entries;
+
+    // Power of 2
+    int32 capacity;
+    int32 count;
+};
+
+FORCE_INLINE
+size_t regex_cache_size(int32 capacity) NO_EXCEPT
+{
+    return capacity * sizeof(RegexCacheEntry);
+}
+
+// The buffer must be zero initialized and regex_cache_size() large
+inline
+void regex_cache_init(RegexCache* cache, int32 capacity, byte* buf) NO_EXCEPT
+{
+    ASSERT_TRUE(OMS_IS_POW2(capacity));
+
+    cache->entries = (RegexCacheEntry *) buf;
+    cache->capacity = capacity;
+    cache->count = 0;
+}
+
+inline
+void regex_cache_alloc(RegexCache* cache, int32 capacity) NO_EXCEPT
+{
+    ASSERT_TRUE(OMS_IS_POW2(capacity));
+
+    cache->entries = (RegexCacheEntry *) platform_alloc_aligned(
+        capacity * sizeof(RegexCacheEntry),
+        capacity * sizeof(RegexCacheEntry),
+        ASSUMED_CACHE_LINE_SIZE
+    );
+    memset(cache->entries, 0, capacity * sizeof(RegexCacheEntry));
+
+    cache->capacity = capacity;
+    cache->count = 0;
+}
+
+inline
+void regex_cache_free(RegexCache* cache) NO_EXCEPT
+{
+    platform_aligned_free((void **) &cache->entries);
+    cache->capacity = 0;
+    cache->count = 0;
 }
 
-int main() {
-    // Test cases
-    printf("Enhanced Regex Validator Tests\n");
-    printf("=============================\n");
-
-    // Basic tests
-    test_regex("abc", "abc", true);
-    test_regex("^abc$", "abc", true);
-    test_regex("^abc$", "abcd", false);
-
-    // Character classes
-    test_regex("a-z", "a", true);
-    test_regex("a-z", "z", true);
-    test_regex("a-z", "A", false);
-    test_regex("A-Z", "Z", true);
-    test_regex("A-Z", "a", false);
-    test_regex("0-9", "5", true);
-    test_regex("0-9", "a", false);
-    test_regex("\\d", "5", true);
-    test_regex("\\d", "a", false);
-
-    // Quantifiers
-    test_regex("a*", "", true);
-    test_regex("a*", "a", true);
-    test_regex("a*", "aaa", true);
-    test_regex("a+", "", false);
-    test_regex("a+", "a", true);
-    test_regex("a+", "aaa", true);
-    test_regex("a?b", "b", true);
-    test_regex("a?b", "ab", true);
-    test_regex("a?b", "aab", false);
-
-    // Groups and alternation
-    test_regex("(a|b)c", "ac", true);
-    test_regex("(a|b)c", "bc", true);
-    test_regex("(a|b)c", "cc", false);
-    test_regex("(a-z)+", "abc", true);
-    test_regex("(A-Z)+", "ABC", true);
-    test_regex("(0-9)+", "123", true);
-
-    // Escape sequences
-    test_regex("\\.", ".", true);
-    test_regex("\\.", "a", false);
-    test_regex("a\\db", "a0b", true);
-    test_regex("a\\db", "a9b", true);
-    test_regex("a\\db", "aab", false);
-
-    // Any character
-    test_regex("a.b", "a b", true);
-    test_regex("a.b", "a0b", true);
-    test_regex("a.b", "a\nb", true);
-    test_regex("a.b", "ab", false);
-
-    // Repetition tests
-    test_regex("a{2}", "aa", true);
-    test_regex("a{2}", "a", false);
-    test_regex("a{2}", "aaa", true);  // More than min is allowed
-    test_regex("a{2,4}", "aa", true);
-    test_regex("a{2,4}", "aaa", true);
-    test_regex("a{2,4}", "aaaa", true);
-    test_regex("a{2,4}", "a", false);
-    test_regex("a{2,4}", "aaaaa", false);
-    test_regex("a{2,}", "aa", true);
-    test_regex("a{2,}", "aaaaa", true);
-    test_regex("a{2,}", "a", false);
-    test_regex("(a-z){3}", "abc", true);
-    test_regex("(a-z){3}", "ab", false);
-    test_regex("(a-z){2,4}", "ab", true);
-    test_regex("(a-z){2,4}", "abcd", true);
-    test_regex("(a-z){2,4}", "abcde", false);
-    test_regex("\\d{3}-\\d{2}", "123-45", true);
-    test_regex("\\d{3}-\\d{2}", "12-345", false);
-
-    // Combined tests
-    test_regex("^a{2}b{1,3}c$", "aabbc", true);
-    test_regex("^a{2}b{1,3}c$", "aabbbc", true);
-    test_regex("^a{2}b{1,3}c$", "aabc", true);
-    test_regex("^a{2}b{1,3}c$", "aabbbbc", false);
-    test_regex("^a{2}b{1,3}c$", "abbc", false);
-
-    return 0;
+/**
+ * Returns the compiled pattern, the pattern is compiled on the first use
+ *
+ * Invalid patterns are also cached (regex_match() always returns false for them)
+ *
+ * @return NULL if the pattern can't be cached (empty, too long or cache full)
+ */
+const RegexDfa* regex_cache_get(RegexCache* cache, const char* pattern) NO_EXCEPT
+{
+    const size_t length = str_length(pattern);
+    if (length == 0 || length >= REGEX_CACHE_PATTERN_LENGTH) {
+        return NULL;
+    }
+
+    const uint64 hash = hash_fnv1a(pattern);
+    const int32 mask = cache->capacity - 1;
+
+    // Linear probing, the cache is never more than 3/4 full
+    for (int32 i = (int32) (hash & mask);; i = (i + 1) & mask) {
+        RegexCacheEntry* entry = &cache->entries[i];
+
+        if (entry->pattern[0] == '\0') {
+            if ((cache->count + 1) * 4 > cache->capacity * 3) {
+                return NULL;
+            }
+
+            entry->hash = hash;
+            memcpy(entry->pattern, pattern, length + 1);
+            regex_compile(&entry->dfa, pattern);
+            ++cache->count;
+
+            return &entry->dfa;
+        }
+
+        if (entry->hash == hash && strcmp(entry->pattern, pattern) == 0) {
+            return &entry->dfa;
+        }
+    }
+}
+
+/**
+ * Checks if a text matches a pattern
+ *
+ * @param pattern   Pattern
+ * @param text      Text
+ * @param cache     Compiled pattern cache, without a cache the pattern is compiled on every call
+ */
+bool regex_simplified_validate(const char* pattern, const char* text, RegexCache* cache = NULL) NO_EXCEPT
+{
+    const RegexDfa* cached = cache ? regex_cache_get(cache, pattern) : NULL;
+    if (cached) {
+        return regex_match(cached, text);
+    }
+
+    RegexDfa dfa;
+    if (!regex_compile(&dfa, pattern)) {
+        return false;
+    }
+
+    return regex_match(&dfa, text);
 }
-*/
 
-#endif
\ No newline at end of file
+#endif
@@ -184,6 +184,426 @@ int32 utf8_get_char_at(const char* in, int32 index) NO_EXCEPT
     return -1;
 }
 
+// Length of the UTF-8 sequence at in or 0 if the sequence is invalid
+// Overlong encodings, surrogates, code points > U+10FFFF and truncated sequences are invalid
+static inline
+int32 utf8_sequence_length(const byte* in, size_t length) NO_EXCEPT
+{
+    const byte ch = in[0];
+
+    if (ch < 0x80) {
+        return 1;
+    } else if (ch < 0xC2) {
+        // Continuation byte or overlong 2-byte sequence
+        return 0;
+    } else if (ch < 0xE0) {
+        return length >= 2 && (in[1] & 0xC0) == 0x80 ? 2 : 0;
+    } else if (ch < 0xF0) {
+        if (length < 3 || (in[1] & 0xC0) != 0x80 || (in[2] & 0xC0) != 0x80
+            || (ch == 0xE0 && in[1] < 0xA0) // overlong
+            || (ch == 0xED && in[1] >= 0xA0) // surrogate
+        ) {
+            return 0;
+        }
+
+        return 3;
+    } else if (ch < 0xF5) {
+        if (length < 4 || (in[1] & 0xC0) != 0x80 || (in[2] & 0xC0) != 0x80 || (in[3] & 0xC0) != 0x80
+            || (ch == 0xF0 && in[1] < 0x90) // overlong
+            || (ch == 0xF4 && in[1] >= 0x90) // > U+10FFFF
+        ) {
+            return 0;
+        }
+
+        return 4;
+    }
+
+    return 0;
+}
+
+#if defined(__SSE4_2__) || defined(__AVX2__)
+    // Error classes of 2 consecutive bytes, see "Validating UTF-8 In Less Than One Instruction Per Byte" (Keiser, Lemire)
+    // The error is the AND of the classes of the high nibble of byte 1, the low nibble of byte 1 and the high nibble of byte 2
+    #define UTF8_ERROR_TOO_SHORT (1 << 0) // 11______ 0_______ or 11______ 11______
+    #define UTF8_ERROR_TOO_LONG (1 << 1) // 0_______ 10______
+    #define UTF8_ERROR_OVERLONG_3 (1 << 2) // 11100000 100_____
+    #define UTF8_ERROR_TOO_LARGE (1 << 3) // 11110100 1001____ and larger
+    #define UTF8_ERROR_SURROGATE (1 << 4) // 11101101 101_____
+    #define UTF8_ERROR_OVERLONG_2 (1 << 5) // 1100000_ 10______
+    #define UTF8_ERROR_TOO_LARGE_1000 (1 << 6) // 11110101 1000____ and larger
+    #define UTF8_ERROR_OVERLONG_4 (1 << 6) // 11110000 1000____
+    #define UTF8_ERROR_TWO_CONTS (1 << 7) // 10______ 10______
+    #define UTF8_ERROR_CARRY (UTF8_ERROR_TOO_SHORT | UTF8_ERROR_TOO_LONG | UTF8_ERROR_TWO_CONTS)
+
+    static const byte UTF8_ERROR_BYTE_1_HIGH[16] = {
+        // 0_______ ASCII
+        UTF8_ERROR_TOO_LONG, UTF8_ERROR_TOO_LONG, UTF8_ERROR_TOO_LONG, UTF8_ERROR_TOO_LONG,
+        UTF8_ERROR_TOO_LONG, UTF8_ERROR_TOO_LONG, UTF8_ERROR_TOO_LONG, UTF8_ERROR_TOO_LONG,
+        // 10______ continuation
+        UTF8_ERROR_TWO_CONTS, UTF8_ERROR_TWO_CONTS, UTF8_ERROR_TWO_CONTS, UTF8_ERROR_TWO_CONTS,
+        // 1100____ 2-byte lead
+        UTF8_ERROR_TOO_SHORT | UTF8_ERROR_OVERLONG_2,
+        // 1101____ 2-byte lead
+        UTF8_ERROR_TOO_SHORT,
+        // 1110____ 3-byte lead
+        UTF8_ERROR_TOO_SHORT | UTF8_ERROR_OVERLONG_3 | UTF8_ERROR_SURROGATE,
+        // 1111____ 4-byte lead
+        UTF8_ERROR_TOO_SHORT | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000 | UTF8_ERROR_OVERLONG_4
+    };
+
+    static const byte UTF8_ERROR_BYTE_1_LOW[16] = {
+        // ____0000
+        UTF8_ERROR_CARRY | UTF8_ERROR_OVERLONG_3 | UTF8_ERROR_OVERLONG_2 | UTF8_ERROR_OVERLONG_4,
+        // ____0001
+        UTF8_ERROR_CARRY | UTF8_ERROR_OVERLONG_2,
+        // ____001_
+        UTF8_ERROR_CARRY,
+        UTF8_ERROR_CARRY,
+        // ____0100
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE,
+        // ____0101 - ____1100
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        // ____1101
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000 | UTF8_ERROR_SURROGATE,
+        // ____111_
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000,
+        UTF8_ERROR_CARRY | UTF8_ERROR_TOO_LARGE | UTF8_ERROR_TOO_LARGE_1000
+    };
+
+    static const byte UTF8_ERROR_BYTE_2_HIGH[16] = {
+        // 0_______ ASCII
+        UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT,
+        UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT,
+        // 1000____
+        UTF8_ERROR_TOO_LONG | UTF8_ERROR_OVERLONG_2 | UTF8_ERROR_TWO_CONTS | UTF8_ERROR_OVERLONG_3 | UTF8_ERROR_TOO_LARGE_1000 | UTF8_ERROR_OVERLONG_4,
+        // 1001____
+        UTF8_ERROR_TOO_LONG | UTF8_ERROR_OVERLONG_2 | UTF8_ERROR_TWO_CONTS | UTF8_ERROR_OVERLONG_3 | UTF8_ERROR_TOO_LARGE,
+        // 101_____
+        UTF8_ERROR_TOO_LONG | UTF8_ERROR_OVERLONG_2 | UTF8_ERROR_TWO_CONTS | UTF8_ERROR_SURROGATE | UTF8_ERROR_TOO_LARGE,
+        UTF8_ERROR_TOO_LONG | UTF8_ERROR_OVERLONG_2 | UTF8_ERROR_TWO_CONTS | UTF8_ERROR_SURROGATE | UTF8_ERROR_TOO_LARGE,
+        // 11______ lead
+        UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT, UTF8_ERROR_TOO_SHORT
+    };
+
+    // Bytes larger than this at the end of a block start a sequence that continues in the next block
+    static const byte UTF8_INCOMPLETE_MAX[32] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+    };
+#endif
+
+#ifdef __SSE4_2__
+    // prev1-3 are the input shifted by 1-3 bytes, filled with the end of the previous block
+    static FORCE_INLINE
+    __m128i utf8_validate_block(__m128i input, __m128i prev_input) NO_EXCEPT
+    {
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+
+        const __m128i byte_1_high = _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i *) UTF8_ERROR_BYTE_1_HIGH),
+            _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)
+        );
+        const __m128i byte_1_low = _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i *) UTF8_ERROR_BYTE_1_LOW),
+            _mm_and_si128(prev1, nibble)
+        );
+        const __m128i byte_2_high = _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i *) UTF8_ERROR_BYTE_2_HIGH),
+            _mm_and_si128(_mm_srli_epi16(input, 4), nibble)
+        );
+
+        const __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+        // The 3rd and 4th byte of a sequence must be continuations (= the two continuations error is expected)
+        const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+        const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+        const __m128i must_be_continuation = _mm_and_si128(
+            _mm_or_si128(
+                _mm_subs_epu8(prev2, _mm_set1_epi8((char) (0xE0 - 0x80))),
+                _mm_subs_epu8(prev3, _mm_set1_epi8((char) (0xF0 - 0x80)))
+            ),
+            _mm_set1_epi8((char) 0x80)
+        );
+
+        return _mm_xor_si128(must_be_continuation, special);
+    }
+#endif
+
+#ifdef __AVX2__
+    static FORCE_INLINE
+    __m256i utf8_validate_block(__m256i input, __m256i prev_input) NO_EXCEPT
+    {
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+        // Combines the upper half of the previous block with the lower half of the current block
+        const __m256i prev_shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+        const __m256i prev1 = _mm256_alignr_epi8(input, prev_shifted, 15);
+
+        const __m256i byte_1_high = _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) UTF8_ERROR_BYTE_1_HIGH)),
+            _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)
+        );
+        const __m256i byte_1_low = _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) UTF8_ERROR_BYTE_1_LOW)),
+            _mm256_and_si256(prev1, nibble)
+        );
+        const __m256i byte_2_high = _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) UTF8_ERROR_BYTE_2_HIGH)),
+            _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)
+        );
+
+        const __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+        const __m256i prev2 = _mm256_alignr_epi8(input, prev_shifted, 14);
+        const __m256i prev3 = _mm256_alignr_epi8(input, prev_shifted, 13);
+        const __m256i must_be_continuation = _mm256_and_si256(
+            _mm256_or_si256(
+                _mm256_subs_epu8(prev2, _mm256_set1_epi8((char) (0xE0 - 0x80))),
+                _mm256_subs_epu8(prev3, _mm256_set1_epi8((char) (0xF0 - 0x80)))
+            ),
+            _mm256_set1_epi8((char) 0x80)
+        );
+
+        return _mm256_xor_si256(must_be_continuation, special);
+    }
+#endif
+
+/**
+ * Strict UTF-8 validation
+ *
+ * Overlong encodings, surrogates, code points > U+10FFFF and truncated sequences are invalid
+ *
+ * @param steps Max SIMD width (1 = scalar)
+ */
+inline
+bool utf8_is_valid(const char* in, size_t length, int32 steps = 16) NO_EXCEPT
+{
+    const byte* data = (const byte *) in;
+    PSEUDO_USE(steps);
+
+    #ifdef __AVX2__
+        if (steps >= 8) {
+            __m256i error = _mm256_setzero_si256();
+            __m256i prev_input = _mm256_setzero_si256();
+            __m256i prev_incomplete = _mm256_setzero_si256();
+            const __m256i incomplete_max = _mm256_loadu_si256((const __m256i *) UTF8_INCOMPLETE_MAX);
+
+            size_t i = 0;
+            alignas(32) byte tail[32];
+
+            while (i < length) {
+                __m256i input;
+                if (i + 32 <= length) {
+                    input = _mm256_loadu_si256((const __m256i *) (data + i));
+                } else {
+                    // The zero padding is ASCII, which also detects truncated sequences at the end
+                    memset(tail, 0, sizeof(tail));
+                    memcpy(tail, data + i, length - i);
+                    input = _mm256_load_si256((const __m256i *) tail);
+                }
+
+                if (_mm256_movemask_epi8(input) == 0) {
+                    // ASCII only, only the last sequence of the previous block can be invalid
+                    error = _mm256_or_si256(error, prev_incomplete);
+                } else {
+                    error = _mm256_or_si256(error, utf8_validate_block(input, prev_input));
+                    prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+                }
+
+                prev_input = input;
+                i += 32;
+            }
+
+            error = _mm256_or_si256(error, prev_incomplete);
+
+            return _mm256_testz_si256(error, error);
+        }
+    #endif
+
+    #ifdef __SSE4_2__
+        if (steps >= 4) {
+            __m128i error = _mm_setzero_si128();
+            __m128i prev_input = _mm_setzero_si128();
+            __m128i prev_incomplete = _mm_setzero_si128();
+            const __m128i incomplete_max = _mm_loadu_si128((const __m128i *) (UTF8_INCOMPLETE_MAX + 16));
+
+            size_t i = 0;
+            alignas(16) byte tail[16];
+
+            while (i < length) {
+                __m128i input;
+                if (i + 16 <= length) {
+                    input = _mm_loadu_si128((const __m128i *) (data + i));
+                } else {
+                    memset(tail, 0, sizeof(tail));
+                    memcpy(tail, data + i, length - i);
+                    input = _mm_load_si128((const __m128i *) tail);
+                }
+
+                if (_mm_movemask_epi8(input) == 0) {
+                    error = _mm_or_si128(error, prev_incomplete);
+                } else {
+                    error = _mm_or_si128(error, utf8_validate_block(input, prev_input));
+                    prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+                }
+
+                prev_input = input;
+                i += 16;
+            }
+
+            error = _mm_or_si128(error, prev_incomplete);
+
+            return _mm_testz_si128(error, error);
+        }
+    #endif
+
+    size_t i = 0;
+    while (i < length) {
+        // ASCII fast path
+        if (i + 8 <= length) {
+            uint64 chunk;
+            memcpy(&chunk, data + i, sizeof(chunk));
+
+            if (!(chunk & 0x8080808080808080ULL)) {
+                i += 8;
+                continue;
+            }
+        }
+
+        const int32 bytes = utf8_sequence_length(data + i, length - i);
+        if (!bytes) {
+            return false;
+        }
+
+        i += bytes;
+    }
+
+    return true;
+}
+
+// Decodes a single sequence, invalid sequences are decoded as U+FFFD and consume 1 byte
+static FORCE_INLINE
+int32 utf8_decode_replace(const byte* in, size_t length, uint32* codepoint) NO_EXCEPT
+{
+    const int32 bytes = utf8_sequence_length(in, length);
+
+    switch (bytes) {
+        case 1:
+            *codepoint = in[0];
+            return 1;
+        case 2:
+            *codepoint = ((in[0] & 0x1F) << 6) | (in[1] & 0x3F);
+            return 2;
+        case 3:
+            *codepoint = ((in[0] & 0x0F) << 12) | ((in[1] & 0x3F) << 6) | (in[2] & 0x3F);
+            return 3;
+        case 4:
+            *codepoint = ((in[0] & 0x07) << 18) | ((in[1] & 0x3F) << 12) | ((in[2] & 0x3F) << 6) | (in[3] & 0x3F);
+            return 4;
+        default:
+            *codepoint = 0xFFFD;
+            return 1;
+    }
+}
+
+/**
+ * Transcodes UTF-8 to UTF-32 (e.g. for the glyph lookup)
+ *
+ * Invalid sequences are decoded as U+FFFD, use utf8_is_valid() if they should be rejected instead.
+ * ASCII runs are widened with SIMD, other sequences are decoded one at a time.
+ *
+ * @param out   Must have space for length code points
+ * @param steps Max SIMD width (1 = scalar)
+ *
+ * @return Number of code points
+ */
+inline
+int32 utf8_to_utf32(const char* __restrict in, size_t length, uint32* __restrict out, int32 steps = 16) NO_EXCEPT
+{
+    const byte* data = (const byte *) in;
+    size_t i = 0;
+    int32 count = 0;
+    PSEUDO_USE(steps);
+
+    // Every code point consumes at least 1 byte -> count <= i
+    // This is why the SIMD loops can always store a full block in out
+    while (i < length) {
+        #ifdef __AVX2__
+            if (steps >= 8) {
+                while (i + 32 <= length) {
+                    const __m256i input = _mm256_loadu_si256((const __m256i *) (data + i));
+                    const uint32 mask = (uint32) _mm256_movemask_epi8(input);
+
+                    __m256i* dst = (__m256i *) (out + count);
+                    _mm256_storeu_si256(dst + 0, _mm256_cvtepu8_epi32(_mm256_castsi256_si128(input)));
+                    _mm256_storeu_si256(dst + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(_mm256_castsi256_si128(input), 8)));
+                    _mm256_storeu_si256(dst + 2, _mm256_cvtepu8_epi32(_mm256_extracti128_si256(input, 1)));
+                    _mm256_storeu_si256(dst + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(_mm256_extracti128_si256(input, 1), 8)));
+
+                    if (!mask) {
+                        i += 32;
+                        count += 32;
+
+                        continue;
+                    }
+
+                    // Only the ASCII prefix is valid
+                    const int32 ascii = compiler_find_first_bit_r2l(mask);
+                    i += ascii;
+                    count += ascii;
+
+                    break;
+                }
+            }
+        #endif
+
+        #ifdef __SSE4_2__
+            if (steps >= 4) {
+                while (i + 16 <= length) {
+                    const __m128i input = _mm_loadu_si128((const __m128i *) (data + i));
+                    const uint32 mask = (uint32) _mm_movemask_epi8(input);
+
+                    __m128i* dst = (__m128i *) (out + count);
+                    _mm_storeu_si128(dst + 0, _mm_cvtepu8_epi32(input));
+                    _mm_storeu_si128(dst + 1, _mm_cvtepu8_epi32(_mm_srli_si128(input, 4)));
+                    _mm_storeu_si128(dst + 2, _mm_cvtepu8_epi32(_mm_srli_si128(input, 8)));
+                    _mm_storeu_si128(dst + 3, _mm_cvtepu8_epi32(_mm_srli_si128(input, 12)));
+
+                    if (!mask) {
+                        i += 16;
+                        count += 16;
+
+                        continue;
+                    }
+
+                    const int32 ascii = compiler_find_first_bit_r2l(mask);
+                    i += ascii;
+                    count += ascii;
+
+                    break;
+                }
+            }
+        #endif
+
+        if (i >= length) {
+            break;
+        }
+
+        i += utf8_decode_replace(data + i, length - i, out + count);
+        ++count;
+    }
+
+    return count;
+}
+
 inline CONSTEXPR
 int32 char_to_wchar(
     wchar_t* __restrict dest,
@@ -505,28 +925,82 @@ bool str_is_integer(const char* str) NO_EXCEPT
     return is_int;
 }
 
-inline
-int64 str_to_int(const char* str, const char** pos = NULL) NO_EXCEPT
+// Combines 8 digit values (0-9, the first digit in the lowest byte) to one number
+// Adjacent digits are combined to 2, 4 and finally 8 digit values with only 3 multiplications
+FORCE_INLINE CONSTEXPR
+uint32 str_combine_8_digits(uint64 val) NO_EXCEPT
 {
-    int64 sign = 1;
-    if (*str == '-') {
-        sign = -1;
-        ++str;
+    const uint64 mask = 0x000000FF000000FFULL;
+    const uint64 mul1 = 100 + (1000000ULL << 32);
+    const uint64 mul2 = 1 + (10000ULL << 32);
+
+    val = (val * 10) + (val >> 8);
+    val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+
+    return (uint32) val;
+}
+
+// Loads the next 8 characters and checks if they are all digits
+// The load may read past the string terminator but never across a page boundary
+// Callers must also be NO_SANITIZE_ADDRESS since the function gets inlined
+FORCE_INLINE NO_SANITIZE_ADDRESS
+bool str_load_8_digits(const char* str, uint64* val) NO_EXCEPT
+{
+    if (((uintptr_t) str & 4095) > 4096 - 8) {
+        return false;
     }
 
-    int64 result = 0;
-    while (isdigit(*str)) {
-        result *= 10;
-        result += (*str - '0');
+    memcpy(val, str, sizeof(uint64));
+
+    #if !_WIN32 && !__LITTLE_ENDIAN__
+        *val = SWAP_ENDIAN_64(*val);
+    #endif
 
+    return ((*val & 0xF0F0F0F0F0F0F0F0ULL)
+        | (((*val + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)
+    ) == 0x3333333333333333ULL;
+}
+
+// Appends the leading digits of a string to result, moves str past the digits
+// Long digit runs (ids, timestamps, high precision floats) are parsed 8 digits at a time (SWAR)
+// Short runs are faster with the plain loop since the branches are well predicted
+FORCE_INLINE NO_SANITIZE_ADDRESS
+uint64 str_parse_digits(const char** str, uint64 result = 0) NO_EXCEPT
+{
+    const char* p = *str;
+
+    uint64 val;
+    while (str_load_8_digits(p, &val)) {
+        result = result * 100000000 + str_combine_8_digits(val - 0x3030303030303030ULL);
+        p += 8;
+    }
+
+    while (isdigit(*p)) {
+        result = result * 10 + (*p - '0');
+        ++p;
+    }
+
+    *str = p;
+
+    return result;
+}
+
+inline NO_SANITIZE_ADDRESS
+int64 str_to_int(const char* str, const char** pos = NULL) NO_EXCEPT
+{
+    bool is_negative = false;
+    if (*str == '-') {
+        is_negative = true;
         ++str;
     }
 
+    const uint64 result = str_parse_digits(&str);
+
     if (pos) {
         *pos = str;
     }
 
-    return result * sign;
+    return is_negative ? (int64) (0 - result) : (int64) result;
 }
 
 inline
@@ -967,8 +1441,9 @@ void str_copy(C* __restrict destination, const SimpleString<const C>& str) NO_EX
     memcpy(destination, str.str, sizeof(C) * str.length);
 }
 
-// Similar to wcscpy but returns length instead of pointer to the beginning
-inline
+// Similar to wcscpy but returns length (without the null terminator) instead of pointer to the beginning
+// The aligned word loads may read past the terminator but never across a page boundary
+inline NO_SANITIZE_ADDRESS
 int32 str_copy(char* __restrict dest, const char* __restrict src) NO_EXCEPT
 {
     const char* start = dest;
@@ -978,7 +1453,7 @@ int32 str_copy(char* __restrict dest, const char* __restrict src) NO_EXCEPT
         const char c = *src++;
         *dest++ = c;
         if (c == '\0') {
-            return -1;
+            return (int32) (dest - start - 1);
         }
     }
 
@@ -1006,11 +1481,12 @@ int32 str_copy(char* __restrict dest, const char* __restrict src) NO_EXCEPT
         }
     }
 
-    return (int32) (dest - start);
+    return (int32) (dest - start - 1);
 }
 
-// Similar to wcscpy but returns length instead of pointer to the beginning
-inline
+// Similar to wcscpy but returns length (without the null terminator) instead of pointer to the beginning
+// The aligned word loads may read past the terminator but never across a page boundary
+inline NO_SANITIZE_ADDRESS
 int32 str_copy(
     wchar_t* __restrict dest,
     const wchar_t* __restrict src
@@ -1023,7 +1499,7 @@ int32 str_copy(
         const wchar_t c = *src++;
         *dest++ = c;
         if (c == L'\0') {
-            return -1;
+            return (int32) (dest - start - 1);
         }
     }
 
@@ -1052,7 +1528,7 @@ int32 str_copy(
         }
     }
 
-    return (int32)(dest - start);
+    return (int32) (dest - start - 1);
 }
 
 inline
@@ -1561,7 +2037,7 @@ bool str_contains(const char* __restrict haystack, const char* __restrict needle
         const size_t* wptr = (const size_t *) ptr;
         while (true) {
             const size_t v = *wptr;
-            if (OMS_HAS_CHAR(v, first)) {
+            if (OMS_HAS_ZERO(v) || OMS_HAS_CHAR(v, first)) {
                 break;
             }
 
@@ -1859,7 +2335,8 @@ int32 str_to_eol(const char* str) NO_EXCEPT
     }
 }
 
-inline
+// The aligned word loads may read past the terminator but never across a page boundary
+inline NO_SANITIZE_ADDRESS
 void str_move_to(const char** str, char delim) NO_EXCEPT
 {
     const char* s = *str;
@@ -2102,9 +2579,146 @@ void str_skip_list(const char** __restrict str, const char* __restrict delim, in
     }
 }
 
+// Set of bytes for the SIMD classification (pshufb nibble lookup)
+// A byte c is part of the set if (low[c & 0x0F] & high[c >> 4]) != 0
+// Every high nibble used by the set gets its own bit -> at most 8 different high nibbles are supported
+struct StrByteSet {
+    alignas(16) byte low[16];
+    alignas(16) byte high[16];
+};
+
+/**
+ * Creates a byte set of the delimiters, the string terminator is always part of the set
+ *
+ * @return false if the delimiters use more than 8 different high nibbles (e.g. many different non-ASCII bytes)
+ */
 inline
-void str_move_to(const char** __restrict str, const char* __restrict delim) NO_EXCEPT
+bool str_byte_set_create(StrByteSet* __restrict set, const char* __restrict delim) NO_EXCEPT
+{
+    memset(set, 0, sizeof(*set));
+
+    // The terminator is part of the set
+    set->high[0] = 1;
+    set->low[0] = 1;
+    int32 bit_count = 1;
+
+    for (; *delim; ++delim) {
+        const byte c = (byte) *delim;
+        const int32 high = c >> 4;
+
+        if (!set->high[high]) {
+            if (bit_count == 8) {
+                return false;
+            }
+
+            set->high[high] = (byte) (1 << bit_count++);
+        }
+
+        set->low[c & 0x0F] |= set->high[high];
+    }
+
+    return true;
+}
+
+FORCE_INLINE
+bool str_byte_set_contains(const StrByteSet* set, char c) NO_EXCEPT
 {
+    return (set->low[(byte) c & 0x0F] & set->high[(byte) c >> 4]) != 0;
+}
+
+// Moves str to the first byte that is part of the set (or the string terminator)
+// The SIMD loads are aligned and never cross a page boundary -> reading past the terminator is safe
+inline NO_SANITIZE_ADDRESS
+void str_move_to(const char** __restrict str, const StrByteSet* __restrict set) NO_EXCEPT
+{
+    const char* s = *str;
+
+    #ifdef __AVX2__
+        {
+            const __m256i low = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *) set->low));
+            const __m256i high = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *) set->high));
+            const __m256i nibble = _mm256_set1_epi8(0x0F);
+            const __m256i zero = _mm256_setzero_si256();
+
+            const char* block = (const char *) ((uintptr_t) s & ~((uintptr_t) 31));
+
+            // Ignore the bytes before the start of the string in the first block
+            uint32 skip = ~0U << (uint32) (s - block);
+
+            while (true) {
+                const __m256i input = _mm256_load_si256((const __m256i *) block);
+                const __m256i classes = _mm256_and_si256(
+                    _mm256_shuffle_epi8(low, _mm256_and_si256(input, nibble)),
+                    _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble))
+                );
+
+                const uint32 mask = ~((uint32) _mm256_movemask_epi8(_mm256_cmpeq_epi8(classes, zero))) & skip;
+                if (mask) {
+                    *str = block + compiler_find_first_bit_r2l(mask);
+
+                    return;
+                }
+
+                block += 32;
+                skip = ~0U;
+            }
+        }
+    #elif defined(__SSE4_2__)
+        {
+            const __m128i low = _mm_load_si128((const __m128i *) set->low);
+            const __m128i high = _mm_load_si128((const __m128i *) set->high);
+            const __m128i nibble = _mm_set1_epi8(0x0F);
+            const __m128i zero = _mm_setzero_si128();
+
+            const char* block = (const char *) ((uintptr_t) s & ~((uintptr_t) 15));
+            uint32 skip = (0xFFFFU << (uint32) (s - block)) & 0xFFFFU;
+
+            while (true) {
+                const __m128i input = _mm_load_si128((const __m128i *) block);
+                const __m128i classes = _mm_and_si128(
+                    _mm_shuffle_epi8(low, _mm_and_si128(input, nibble)),
+                    _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble))
+                );
+
+                const uint32 mask = ~((uint32) _mm_movemask_epi8(_mm_cmpeq_epi8(classes, zero))) & skip;
+                if (mask) {
+                    *str = block + compiler_find_first_bit_r2l(mask);
+
+                    return;
+                }
+
+                block += 16;
+                skip = 0xFFFFU;
+            }
+        }
+    #else
+        while (!str_byte_set_contains(set, *s)) {
+            ++s;
+        }
+
+        *str = s;
+    #endif
+}
+
+/**
+ * Moves str to the first occurrence of any of the delimiters (or the string terminator)
+ *
+ * @param steps Max SIMD width (1 = scalar)
+ */
+inline
+void str_move_to(const char** __restrict str, const char* __restrict delim, int32 steps = 16) NO_EXCEPT
+{
+    #if defined(__AVX2__) || defined(__SSE4_2__)
+        StrByteSet set;
+        if (steps >= 4 && str_byte_set_create(&set, delim)) {
+            str_move_to(str, &set);
+
+            return;
+        }
+    #else
+        PSEUDO_USE(steps);
+    #endif
+
     while (**str != '\0') {
         const char* delim_temp = delim;
         while (*delim_temp) {
@@ -2161,12 +2775,260 @@ void str_pad_left(const char* __restrict input, char* __restrict output, char pa
     }
 }
 
+// Truncated 128 bit representation of 5^q for q in [-65, 38] (normalized, high bit set)
+// This covers every decimal exponent that can result in a finite non-zero f32 for a 19 digit mantissa
+#define STR_POWER_OF_FIVE_MIN -65
+#define STR_POWER_OF_FIVE_MAX 38
+static const uint64 STR_POWER_OF_FIVE_128[2 * (STR_POWER_OF_FIVE_MAX - STR_POWER_OF_FIVE_MIN + 1)] = {
+    0x86CCBB52EA94BAEAULL, 0x98E947129FC2B4E9ULL, // 5^-65
+    0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL, // 5^-64
+    0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL, // 5^-63
+    0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL, // 5^-62
+    0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL, // 5^-61
+    0xCDB02555653131B6ULL, 0x3792F412CB06794DULL, // 5^-60
+    0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL, // 5^-59
+    0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL, // 5^-58
+    0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL, // 5^-57
+    0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL, // 5^-56
+    0x9CED737BB6C4183DULL, 0x55464DD69685606BULL, // 5^-55
+    0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL, // 5^-54
+    0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL, // 5^-53
+    0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL, // 5^-52
+    0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL, // 5^-51
+    0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL, // 5^-50
+    0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL, // 5^-49
+    0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL, // 5^-48
+    0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL, // 5^-47
+    0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL, // 5^-46
+    0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL, // 5^-45
+    0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL, // 5^-44
+    0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL, // 5^-43
+    0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL, // 5^-42
+    0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL, // 5^-41
+    0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL, // 5^-40
+    0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL, // 5^-39
+    0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL, // 5^-38
+    0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL, // 5^-37
+    0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL, // 5^-36
+    0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL, // 5^-35
+    0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL, // 5^-34
+    0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL, // 5^-33
+    0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL, // 5^-32
+    0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL, // 5^-31
+    0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL, // 5^-30
+    0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL, // 5^-29
+    0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL, // 5^-28
+    0x9E74D1B791E07E48ULL, 0x775EA264CF55347EULL, // 5^-27
+    0xC612062576589DDAULL, 0x95364AFE032A819EULL, // 5^-26
+    0xF79687AED3EEC551ULL, 0x3A83DDBD83F52205ULL, // 5^-25
+    0x9ABE14CD44753B52ULL, 0xC4926A9672793543ULL, // 5^-24
+    0xC16D9A0095928A27ULL, 0x75B7053C0F178294ULL, // 5^-23
+    0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6339ULL, // 5^-22
+    0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E04ULL, // 5^-21
+    0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF585ULL, // 5^-20
+    0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E6ULL, // 5^-19
+    0x9392EE8E921D5D07ULL, 0x3AFF322E62439FD0ULL, // 5^-18
+    0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C3ULL, // 5^-17
+    0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B4ULL, // 5^-16
+    0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A11ULL, // 5^-15
+    0xB424DC35095CD80FULL, 0x538484C19EF38C95ULL, // 5^-14
+    0xE12E13424BB40E13ULL, 0x2865A5F206B06FBAULL, // 5^-13
+    0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D4ULL, // 5^-12
+    0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D749ULL, // 5^-11
+    0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1CULL, // 5^-10
+    0x89705F4136B4A597ULL, 0x31680A88F8953031ULL, // 5^-9
+    0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3EULL, // 5^-8
+    0xD6BF94D5E57A42BCULL, 0x3D32907604691B4DULL, // 5^-7
+    0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B110ULL, // 5^-6
+    0xA7C5AC471B478423ULL, 0x0FCF80DC33721D54ULL, // 5^-5
+    0xD1B71758E219652BULL, 0xD3C36113404EA4A9ULL, // 5^-4
+    0x83126E978D4FDF3BULL, 0x645A1CAC083126EAULL, // 5^-3
+    0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A4ULL, // 5^-2
+    0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCDULL, // 5^-1
+    0x8000000000000000ULL, 0x0000000000000000ULL, // 5^0
+    0xA000000000000000ULL, 0x0000000000000000ULL, // 5^1
+    0xC800000000000000ULL, 0x0000000000000000ULL, // 5^2
+    0xFA00000000000000ULL, 0x0000000000000000ULL, // 5^3
+    0x9C40000000000000ULL, 0x0000000000000000ULL, // 5^4
+    0xC350000000000000ULL, 0x0000000000000000ULL, // 5^5
+    0xF424000000000000ULL, 0x0000000000000000ULL, // 5^6
+    0x9896800000000000ULL, 0x0000000000000000ULL, // 5^7
+    0xBEBC200000000000ULL, 0x0000000000000000ULL, // 5^8
+    0xEE6B280000000000ULL, 0x0000000000000000ULL, // 5^9
+    0x9502F90000000000ULL, 0x0000000000000000ULL, // 5^10
+    0xBA43B74000000000ULL, 0x0000000000000000ULL, // 5^11
+    0xE8D4A51000000000ULL, 0x0000000000000000ULL, // 5^12
+    0x9184E72A00000000ULL, 0x0000000000000000ULL, // 5^13
+    0xB5E620F480000000ULL, 0x0000000000000000ULL, // 5^14
+    0xE35FA931A0000000ULL, 0x0000000000000000ULL, // 5^15
+    0x8E1BC9BF04000000ULL, 0x0000000000000000ULL, // 5^16
+    0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL, // 5^17
+    0xDE0B6B3A76400000ULL, 0x0000000000000000ULL, // 5^18
+    0x8AC7230489E80000ULL, 0x0000000000000000ULL, // 5^19
+    0xAD78EBC5AC620000ULL, 0x0000000000000000ULL, // 5^20
+    0xD8D726B7177A8000ULL, 0x0000000000000000ULL, // 5^21
+    0x878678326EAC9000ULL, 0x0000000000000000ULL, // 5^22
+    0xA968163F0A57B400ULL, 0x0000000000000000ULL, // 5^23
+    0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL, // 5^24
+    0x84595161401484A0ULL, 0x0000000000000000ULL, // 5^25
+    0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL, // 5^26
+    0xCECB8F27F4200F3AULL, 0x0000000000000000ULL, // 5^27
+    0x813F3978F8940984ULL, 0x4000000000000000ULL, // 5^28
+    0xA18F07D736B90BE5ULL, 0x5000000000000000ULL, // 5^29
+    0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL, // 5^30
+    0xFC6F7C4045812296ULL, 0x4D00000000000000ULL, // 5^31
+    0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL, // 5^32
+    0xC5371912364CE305ULL, 0x6C28000000000000ULL, // 5^33
+    0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL, // 5^34
+    0x9A130B963A6C115CULL, 0x3C7F400000000000ULL, // 5^35
+    0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL, // 5^36
+    0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL, // 5^37
+    0x96769950B50D88F4ULL, 0x1314448000000000ULL, // 5^38
+};
+
+/**
+ * Converts the decimal number w * 10^q to the closest f32 (round to nearest, ties to even)
+ *
+ * Uses the exact float arithmetic if w and 10^q are exactly representable (Clinger)
+ * and otherwise the 128 bit power of five approximation (Eisel-Lemire).
+ * Results are identical to strtof().
+ *
+ * @param w Decimal mantissa (at most 19 digits)
+ * @param q Decimal exponent
+ *
+ * @return Unsigned f32 bit pattern
+ */
 inline
+uint32 str_decimal_to_float_bits(uint64 w, int64 q) NO_EXCEPT
+{
+    static const f32 powers_of_ten[] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+
+    static const f64 powers_of_ten_f64[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    if (w == 0 || q < STR_POWER_OF_FIVE_MIN) {
+        return 0;
+    }
+
+    if (q > STR_POWER_OF_FIVE_MAX) {
+        // Infinity
+        return 0xFF << 23;
+    }
+
+    if (w <= (1ULL << 24) && q >= -10 && q <= 10) {
+        const f32 result = q < 0
+            ? (f32) w / powers_of_ten[-q]
+            : (f32) w * powers_of_ten[q];
+
+        uint32 bits;
+        memcpy(&bits, &result, sizeof(bits));
+
+        return bits;
+    }
+
+    // Most asset values have more than 7 digits (e.g. %f output) but still fit into a f64
+    // The f64 result is correctly rounded and so is the conversion to f32,
+    // unless the f64 lies exactly on the midpoint between two floats (double rounding)
+    if (w <= (1ULL << 53) && q >= -22 && q <= 22) {
+        const f64 result = q < 0
+            ? (f64) w / powers_of_ten_f64[-q]
+            : (f64) w * powers_of_ten_f64[q];
+
+        uint64 bits;
+        memcpy(&bits, &result, sizeof(bits));
+
+        if ((bits & 0x1FFFFFFF) != 0x10000000) {
+            const f32 result_f32 = (f32) result;
+
+            uint32 bits_f32;
+            memcpy(&bits_f32, &result_f32, sizeof(bits_f32));
+
+            return bits_f32;
+        }
+    }
+
+    // Normalize the mantissa so the highest bit is set
+    const int32 lz = 63 - compiler_find_first_bit_l2r(w);
+    w <<= lz;
+
+    // We only need the upper 23 + 3 bits of the product to be exact.
+    // Only if the bits below them are all 1 the lower half of 5^q can change the result
+    const int32 index = 2 * (int32) (q - STR_POWER_OF_FIVE_MIN);
+    uint64 high;
+    uint64 low = compiler_mul_128(w, STR_POWER_OF_FIVE_128[index], &high);
+
+    const uint64 precision_mask = 0xFFFFFFFFFFFFFFFFULL >> (23 + 3);
+    if ((high & precision_mask) == precision_mask) {
+        uint64 high2;
+        compiler_mul_128(w, STR_POWER_OF_FIVE_128[index + 1], &high2);
+
+        low += high2;
+        high += high2 > low;
+    }
+
+    const int32 upper_bit = (int32) (high >> 63);
+    const int32 shift = upper_bit + 64 - 23 - 3;
+    uint64 mantissa = high >> shift;
+
+    // floor(log2(10^q)) + 63 + normalization - f32 exponent bias
+    int32 power2 = (int32) (((152170 + 65536) * q) >> 16) + 63 + upper_bit - lz + 127;
+
+    if (power2 <= 0) {
+        // Subnormal
+        if (-power2 + 1 >= 64) {
+            return 0;
+        }
+
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+
+        // Rounding may have turned the subnormal into the smallest normal number
+        // In that case the mantissa already has the implicit bit at the exponent position
+        return (uint32) mantissa;
+    }
+
+    // The product is exact and lies exactly between two floats -> round to even
+    // This can only happen for small exponents since 5^q must fit into 64 bits
+    if (low <= 1 && q >= -17 && q <= 10
+        && (mantissa & 3) == 1 && (mantissa << shift) == high
+    ) {
+        mantissa &= ~1ULL;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+
+    if (mantissa >= (2ULL << 23)) {
+        mantissa = 1ULL << 23;
+        ++power2;
+    }
+
+    if (power2 >= 0xFF) {
+        return 0xFF << 23;
+    }
+
+    return (uint32) ((mantissa & ~(1ULL << 23)) | ((uint64) power2 << 23));
+}
+
+/**
+ * Parses a decimal float (e.g. "-12.5", "3", ".25", "1.5e-3")
+ *
+ * The result is correctly rounded, parsing the output of float_to_str_shortest() returns the identical float.
+ *
+ * @param str Input string, leading whitespace is skipped
+ * @param pos End of the parsed number
+ *
+ * @return Parsed value
+ */
+inline NO_SANITIZE_ADDRESS
 f32 str_to_float(const char* str, const char** pos = NULL) NO_EXCEPT
 {
-    const char *p = str;
-    f32 result = 0.0f;
-    int32 sign = 1;
+    const char* p = str;
 
     // Skip leading whitespace
     while (is_whitespace(*p)) {
@@ -2174,34 +3036,53 @@ f32 str_to_float(const char* str, const char** pos = NULL) NO_EXCEPT
     }
 
     // Handle optional sign
+    bool is_negative = false;
     if (*p == '+' || *p == '-') {
-        sign = (*p == '-') ? -1 : 1;
+        is_negative = *p == '-';
         ++p;
     }
 
-    // Parse integer part
-    while (isdigit(*p)) {
-        result = result * 10.0f + (*p - '0');
-        ++p;
-    }
+    // Parse all digits into one integer, the decimal point only changes the exponent
+    const char* start = p;
+    uint64 mantissa = str_parse_digits(&p);
+
+    int64 digit_count = p - start;
+    int64 exponent = 0;
 
-    // Parse fractional part
     if (*p == '.') {
-        int32 decimals = 0;
         ++p;
 
-        while (isdigit(*p)) {
-            result = result * 10.0f + (*p - '0');
-            ++decimals;
-            ++p;
+        const char* fraction = p;
+        mantissa = str_parse_digits(&p, mantissa);
+
+        exponent = fraction - p;
+        digit_count -= exponent;
+    }
+
+    // Optional exponent, only consumed if followed by digits
+    if ((*p == 'e' || *p == 'E') && digit_count > 0) {
+        const char* e = p + 1;
+
+        bool is_negative_exponent = false;
+        if (*e == '+' || *e == '-') {
+            is_negative_exponent = *e == '-';
+            ++e;
         }
 
-        // Adjust for decimal places and exponent
-        static const float powers_of_ten[] = {
-            1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f, 1000000.0f
-        };
+        if (isdigit(*e)) {
+            int64 exponent_value = 0;
+            while (isdigit(*e)) {
+                // Prevent overflow, anything this large is 0 or infinity anyways
+                if (exponent_value < 0x10000) {
+                    exponent_value = exponent_value * 10 + (*e - '0');
+                }
+
+                ++e;
+            }
 
-        result /= powers_of_ten[decimals];
+            exponent += is_negative_exponent ? -exponent_value : exponent_value;
+            p = e;
+        }
     }
 
     // Set end pointer
@@ -2211,7 +3092,25 @@ f32 str_to_float(const char* str, const char** pos = NULL) NO_EXCEPT
         *pos = (char *) p;
     }
 
-    return sign * result;
+    // More than 19 significant digits may overflow the mantissa
+    // Leading zeros are not significant (e.g. 0.000000000000000000001)
+    if (digit_count > 19) { UNLIKELY
+        for (const char* c = start; *c == '0' || *c == '.'; ++c) {
+            digit_count -= *c == '0';
+        }
+
+        if (digit_count > 19) {
+            // Such numbers don't occur in our asset files -> use the slow but exact stdlib
+            return strtof(str, NULL);
+        }
+    }
+
+    const uint32 bits = str_decimal_to_float_bits(mantissa, exponent) | ((uint32) is_negative << 31);
+
+    f32 result;
+    memcpy(&result, &bits, sizeof(result));
+
+    return result;
 }
 
 template <typename T>
@@ -2266,6 +3165,195 @@ int32 float_to_str(f64 value, T* buffer, int32 precision = 5) NO_EXCEPT
     return (int32) (buffer - start);
 }
 
+/**
+ * Writes the shortest decimal representation of a f32 that parses back to the identical float
+ *
+ * Small and large values use the exponent notation (e.g. 1.5e-7, 3.4028235e38)
+ *
+ * @param value  Value to write
+ * @param buffer Output buffer (at least 16 characters)
+ *
+ * @return Length of the output (without the null terminator)
+ */
+template <typename T>
+inline
+int32 float_to_str_shortest(f32 value, T* buffer) NO_EXCEPT
+{
+    static const f64 powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const T* start = buffer;
+
+    uint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    if (bits >> 31) {
+        *buffer++ = T('-');
+        bits &= 0x7FFFFFFF;
+    }
+
+    if (bits >= 0x7F800000) {
+        const char* special = bits == 0x7F800000 ? "inf" : "nan";
+        while (*special) {
+            *buffer++ = T(*special++);
+        }
+
+        *buffer = T('\0');
+
+        return (int32) (buffer - start);
+    }
+
+    if (bits == 0) {
+        *buffer++ = T('0');
+        *buffer = T('\0');
+
+        return (int32) (buffer - start);
+    }
+
+    f64 v;
+    {
+        f32 tmp;
+        memcpy(&tmp, &bits, sizeof(tmp));
+        v = (f64) tmp;
+    }
+
+    // Estimate the decimal exponent from the binary exponent: floor(e2 * log10(2))
+    int32 e2 = (int32) (bits >> 23) - 127;
+    if (e2 == -127) {
+        // Subnormal
+        e2 = compiler_find_first_bit_l2r((uint64) bits) - 149;
+    }
+
+    int32 exponent = (e2 * 78913) >> 18;
+
+    // 9 significant digits always round trip for f32.
+    // The f64 scaling error is far below half a f32 ulp so these digits are good enough.
+    const int32 scale = 8 - exponent;
+
+    f64 scaled = v;
+    for (int32 s = scale; s > 0; s -= 22) {
+        scaled *= powers_of_ten[s > 22 ? 22 : s];
+    }
+
+    for (int32 s = -scale; s > 0; s -= 22) {
+        scaled /= powers_of_ten[s > 22 ? 22 : s];
+    }
+
+    // The estimate may be one too small
+    if (scaled + 0.5 >= 1000000000.0) {
+        scaled /= 10.0;
+        ++exponent;
+    } else if (scaled + 0.5 < 100000000.0) {
+        scaled *= 10.0;
+        --exponent;
+    }
+
+    // Find the shortest prefix that parses back to the same float
+    // Every length is rounded from scaled directly, rounding the already rounded 9 digits again may round up twice.
+    // The round trip interval isn't symmetric at powers of 2 -> the other neighbor may round trip although the nearest doesn't
+    int32 digit_count = 1;
+    uint64 candidate = 0;
+    int32 candidate_exponent = exponent;
+
+    for (; digit_count <= 9; ++digit_count) {
+        const f64 prefix = scaled / powers_of_ten[9 - digit_count];
+        const uint64 lower = (uint64) prefix;
+
+        // The nearest neighbor is tested first
+        const bool is_lower_first = prefix - (f64) lower < 0.5;
+        const uint64 neighbors[2] = {
+            is_lower_first ? lower : lower + 1,
+            is_lower_first ? lower + 1 : lower
+        };
+
+        bool is_found = false;
+        for (int32 n = 0; n < 2; ++n) {
+            candidate = neighbors[n];
+            candidate_exponent = exponent;
+
+            // Rounding up may add a digit (e.g. 9.96 -> 10)
+            if (candidate >= (uint64) powers_of_ten[digit_count]) {
+                candidate /= 10;
+                ++candidate_exponent;
+            }
+
+            // The nearest 9 digits always round trip
+            if (digit_count == 9
+                || (candidate && str_decimal_to_float_bits(candidate, candidate_exponent - digit_count + 1) == bits)
+            ) {
+                is_found = true;
+                break;
+            }
+        }
+
+        if (is_found) {
+            break;
+        }
+    }
+
+    // Remove trailing zeros
+    while (digit_count > 1 && candidate % 10 == 0) {
+        candidate /= 10;
+        --digit_count;
+    }
+
+    T temp[10];
+    for (int32 i = digit_count - 1; i >= 0; --i) {
+        temp[i] = T('0' + (candidate % 10));
+        candidate /= 10;
+    }
+
+    if (candidate_exponent >= -5 && candidate_exponent < 9) {
+        if (candidate_exponent < 0) {
+            *buffer++ = T('0');
+            *buffer++ = T('.');
+
+            for (int32 i = -1; i > candidate_exponent; --i) {
+                *buffer++ = T('0');
+            }
+
+            for (int32 i = 0; i < digit_count; ++i) {
+                *buffer++ = temp[i];
+            }
+        } else {
+            for (int32 i = 0; i <= candidate_exponent || i < digit_count; ++i) {
+                if (i == candidate_exponent + 1) {
+                    *buffer++ = T('.');
+                }
+
+                *buffer++ = i < digit_count ? temp[i] : T('0');
+            }
+        }
+    } else {
+        *buffer++ = temp[0];
+        if (digit_count > 1) {
+            *buffer++ = T('.');
+
+            for (int32 i = 1; i < digit_count; ++i) {
+                *buffer++ = temp[i];
+            }
+        }
+
+        *buffer++ = T('e');
+        if (candidate_exponent < 0) {
+            *buffer++ = T('-');
+            candidate_exponent = -candidate_exponent;
+        }
+
+        if (candidate_exponent >= 10) {
+            *buffer++ = T('0' + candidate_exponent / 10);
+        }
+
+        *buffer++ = T('0' + candidate_exponent % 10);
+    }
+
+    *buffer = T('\0');
+
+    return (int32) (buffer - start);
+}
+
 template <typename T>
 inline
 void format_time_hh_mm_ss_ms(T time_str[13], int32 hours, int32 minutes, int32 secs, int32 ms) NO_EXCEPT
@@ -2464,6 +3552,11 @@ int32 sprintf_fast(T* __restrict buffer, const T* __restrict format, ...) NO_EXC
 
                     buffer += float_to_str(val, buffer, precision);
                 } break;
+                case T('g'): {
+                    // Shortest round trip representation
+                    const f64 val = va_arg(args, f64);
+                    buffer += float_to_str_shortest((f32) val, buffer);
+                } break;
                 case T('T'): {
                     const int64 time = va_arg(args, int64);
                     format_time_hh_mm_ss(buffer, time);
@@ -2612,6 +3705,11 @@ int32 sprintf_fast(T* __restrict buffer, int32 buffer_length, const T* __restric
 
                     buffer += offset = float_to_str(val, buffer, precision);
                 } break;
+                case T('g'): {
+                    // Shortest round trip representation
+                    const f64 val = va_arg(args, f64);
+                    buffer += offset = float_to_str_shortest((f32) val, buffer);
+                } break;
                 case T('T'): {
                     const int64 time = va_arg(args, int64);
                     format_time_hh_mm_ss(buffer, time);
@@ -2698,6 +3796,11 @@ void sprintf_fast_iter(char* __restrict buffer, const char* __restrict format, .
 
                     buffer += float_to_str(val, buffer, precision);
                 } break;
+                case 'g': {
+                    // Shortest round trip representation
+                    const f64 val = va_arg(args, f64);
+                    buffer += float_to_str_shortest((f32) val, buffer);
+                } break;
                 case 'T': {
                     const int64 time = va_arg(args, int64);
                     format_time_hh_mm_ss(buffer, time);